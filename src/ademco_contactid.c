@@ -453,9 +453,18 @@ static const struct ademco_code_s ademco_codes[] =
 #define TONE_TO_TOTAL_ENERGY        45.2233f        /* -0.85dB [GOERTZEL_SAMPLES_PER_BLOCK*10^(-0.85/10.0)] */
 #endif
 
-static int tone_rx_init = false;
-static goertzel_descriptor_t tone_1400_desc;
-static goertzel_descriptor_t tone_2300_desc;
+/* The Goertzel descriptors are fixed, so they are built at compile time, and shared by every
+   sender. The values are those make_goertzel_descriptor() would produce, and
+   ademco_contactid_tests checks they still do:
+        [Floating point] 2.0f*cosf(2.0f*M_PI*(freq/(float) SAMPLE_RATE))
+        [Fixed point] (int16_t) (16383.0f*2.0f*cosf(2.0f*M_PI*(freq/(float) SAMPLE_RATE))) */
+#if defined(SPANDSP_USE_FIXED_POINT)
+static const goertzel_descriptor_t tone_1400_desc = {14875, GOERTZEL_SAMPLES_PER_BLOCK};
+static const goertzel_descriptor_t tone_2300_desc = {-7649, GOERTZEL_SAMPLES_PER_BLOCK};
+#else
+static const goertzel_descriptor_t tone_1400_desc = {0.907980859f, GOERTZEL_SAMPLES_PER_BLOCK};
+static const goertzel_descriptor_t tone_2300_desc = {-0.466890991f, GOERTZEL_SAMPLES_PER_BLOCK};
+#endif
 
 SPAN_DECLARE(int) encode_msg(char buf[], const ademco_contactid_report_t *report)
 {
@@ -612,6 +621,38 @@ SPAN_DECLARE(int) ademco_contactid_receiver_log_msg(ademco_contactid_receiver_st
 }
 /*- End of function --------------------------------------------------------*/
 
+static void update_stats(ademco_contactid_receiver_stats_t *stats, int latency)
+{
+    if (stats->messages == 0  ||  latency < stats->min_latency)
+        stats->min_latency = latency;
+    if (latency > stats->max_latency)
+        stats->max_latency = latency;
+    stats->total_latency += latency;
+    stats->messages++;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void merge_stats(ademco_contactid_receiver_stats_t *stats, const ademco_contactid_receiver_stats_t *x)
+{
+    if (x->messages == 0)
+        return;
+    if (stats->messages == 0  ||  x->min_latency < stats->min_latency)
+        stats->min_latency = x->min_latency;
+    if (x->max_latency > stats->max_latency)
+        stats->max_latency = x->max_latency;
+    stats->total_latency += x->total_latency;
+    stats->messages += x->messages;
+}
+/*- End of function --------------------------------------------------------*/
+
+static __inline__ void update_latency(ademco_contactid_receiver_state_t *s, int samples)
+{
+    /* Time the wait for a message, and the gap before its kissoff */
+    if ((s->step == 4  ||  s->step == 5)  &&  s->latency < INT_MAX - samples)
+        s->latency += samples;
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE(int) ademco_contactid_receiver_tx(ademco_contactid_receiver_state_t *s, int16_t amp[], int max_samples)
 {
     int i;
@@ -666,6 +707,7 @@ SPAN_DECLARE(int) ademco_contactid_receiver_tx(ademco_contactid_receiver_state_t
         span_log(&s->logging, SPAN_LOG_FLOW, "2300Hz tone finished\n");
         s->step++;
         s->remaining_samples = ms_to_samples(100);
+        s->latency = 0;
         return samples;
     case 4:
         /* Idle here, waiting for a response */
@@ -677,6 +719,7 @@ SPAN_DECLARE(int) ademco_contactid_receiver_tx(ademco_contactid_receiver_state_t
         if (s->remaining_samples > 0)
             return samples;
         span_log(&s->logging, SPAN_LOG_FLOW, "Sending kissoff\n");
+        update_stats(&s->stats, s->latency);
         s->step++;
         s->tone_phase_rate = dds_phase_rate(1400.0);
         s->tone_level = dds_scaling_dbm0(-11);
@@ -693,6 +736,7 @@ SPAN_DECLARE(int) ademco_contactid_receiver_tx(ademco_contactid_receiver_state_t
         span_log(&s->logging, SPAN_LOG_FLOW, "1400Hz tone finished\n");
         s->step = 4;
         s->remaining_samples = ms_to_samples(100);
+        s->latency = 0;
         return samples;
     }
     return max_samples;
@@ -701,16 +745,24 @@ SPAN_DECLARE(int) ademco_contactid_receiver_tx(ademco_contactid_receiver_state_t
 
 SPAN_DECLARE(int) ademco_contactid_receiver_rx(ademco_contactid_receiver_state_t *s, const int16_t amp[], int samples)
 {
+    update_latency(s, samples);
     return dtmf_rx(&s->dtmf, amp, samples);
 }
 /*- End of function --------------------------------------------------------*/
 
 SPAN_DECLARE(int) ademco_contactid_receiver_fillin(ademco_contactid_receiver_state_t *s, int samples)
 {
+    update_latency(s, samples);
     return dtmf_rx_fillin(&s->dtmf, samples);
 }
 /*- End of function --------------------------------------------------------*/
 
+SPAN_DECLARE(void) ademco_contactid_receiver_get_stats(ademco_contactid_receiver_state_t *s, ademco_contactid_receiver_stats_t *stats)
+{
+    *stats = s->stats;
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE(logging_state_t *) ademco_contactid_receiver_get_logging_state(ademco_contactid_receiver_state_t *s)
 {
     return &s->logging;
@@ -787,6 +839,96 @@ SPAN_DECLARE(int) ademco_contactid_receiver_free(ademco_contactid_receiver_state
 }
 /*- End of function --------------------------------------------------------*/
 
+SPAN_DECLARE(int) ademco_contactid_receiver_bank_rx(ademco_contactid_receiver_bank_state_t *s, const int16_t *amp[], int samples)
+{
+    int i;
+
+    for (i = 0;  i < s->lines;  i++)
+    {
+        if (amp[i])
+            update_latency(&s->line[i], samples);
+    }
+    return dtmf_rx_bank(s->dtmf, amp, s->lines, samples);
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(ademco_contactid_receiver_state_t *) ademco_contactid_receiver_bank_get_line(ademco_contactid_receiver_bank_state_t *s, int line)
+{
+    if (line < 0  ||  line >= s->lines)
+        return NULL;
+    return &s->line[line];
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(void) ademco_contactid_receiver_bank_get_stats(ademco_contactid_receiver_bank_state_t *s, ademco_contactid_receiver_stats_t *stats)
+{
+    int i;
+
+    memset(stats, 0, sizeof(*stats));
+    for (i = 0;  i < s->lines;  i++)
+        merge_stats(stats, &s->line[i].stats);
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(ademco_contactid_receiver_bank_state_t *) ademco_contactid_receiver_bank_init(ademco_contactid_receiver_bank_state_t *s,
+                                                                                           int lines,
+                                                                                           ademco_contactid_report_func_t callback,
+                                                                                           void *user_data[])
+{
+    ademco_contactid_receiver_state_t *line;
+    dtmf_rx_state_t **dtmf;
+    int i;
+
+    if (lines <= 0)
+        return NULL;
+    if ((line = (ademco_contactid_receiver_state_t *) span_alloc(lines*sizeof(*line))) == NULL)
+        return NULL;
+    if ((dtmf = (dtmf_rx_state_t **) span_alloc(lines*sizeof(*dtmf))) == NULL)
+    {
+        span_free(line);
+        return NULL;
+    }
+    if (s == NULL)
+    {
+        if ((s = (ademco_contactid_receiver_bank_state_t *) span_alloc(sizeof(*s))) == NULL)
+        {
+            span_free(dtmf);
+            span_free(line);
+            return NULL;
+        }
+    }
+    memset(s, 0, sizeof(*s));
+    s->lines = lines;
+    s->line = line;
+    s->dtmf = dtmf;
+    for (i = 0;  i < lines;  i++)
+    {
+        ademco_contactid_receiver_init(&s->line[i], callback, (user_data)  ?  user_data[i]  :  NULL);
+        s->dtmf[i] = &s->line[i].dtmf;
+    }
+    return s;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) ademco_contactid_receiver_bank_release(ademco_contactid_receiver_bank_state_t *s)
+{
+    span_free(s->dtmf);
+    span_free(s->line);
+    s->dtmf = NULL;
+    s->line = NULL;
+    s->lines = 0;
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) ademco_contactid_receiver_bank_free(ademco_contactid_receiver_bank_state_t *s)
+{
+    ademco_contactid_receiver_bank_release(s);
+    span_free(s);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE(int) ademco_contactid_sender_tx(ademco_contactid_sender_state_t *s, int16_t amp[], int max_samples)
 {
     int sample;
@@ -1097,12 +1239,6 @@ SPAN_DECLARE(ademco_contactid_sender_state_t *) ademco_contactid_sender_init(ade
     span_log_init(&s->logging, SPAN_LOG_NONE, NULL);
     span_log_set_protocol(&s->logging, "Ademco");
 
-    if (!tone_rx_init)
-    {
-        make_goertzel_descriptor(&tone_1400_desc, 1400.0f, GOERTZEL_SAMPLES_PER_BLOCK);
-        make_goertzel_descriptor(&tone_2300_desc, 2300.0f, GOERTZEL_SAMPLES_PER_BLOCK);
-        tone_rx_init = true;
-    }
     goertzel_init(&s->tone_1400, &tone_1400_desc);
     goertzel_init(&s->tone_2300, &tone_2300_desc);
     s->current_sample = 0;
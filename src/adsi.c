@@ -477,6 +477,116 @@ SPAN_DECLARE(int) adsi_rx_free(adsi_rx_state_t *s)
 }
 /*- End of function --------------------------------------------------------*/
 
+static void adsi_rx_put_bit_chunk(adsi_rx_state_t *s, const int bits[], int len)
+{
+    int i;
+
+    if (s->standard == ADSI_STANDARD_TDD)
+    {
+        for (i = 0;  i < len;  i++)
+            adsi_tdd_put_async_byte(s, bits[i]);
+    }
+    else
+    {
+        for (i = 0;  i < len;  i++)
+            adsi_rx_put_bit(s, bits[i]);
+    }
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) adsi_rx_bank(adsi_rx_bank_state_t *s, const int16_t *amp[], int len)
+{
+    int i;
+    int j;
+    int n;
+    int nbits;
+
+    if (s->standard == ADSI_STANDARD_CLIP_DTMF)
+    {
+        /* There is nothing to share between DTMF receivers */
+        for (j = 0;  j < s->channels;  j++)
+        {
+            if (amp[j])
+                adsi_rx(&s->chan[j], amp[j], len);
+        }
+        return 0;
+    }
+    for (i = 0;  i < len;  i += n)
+    {
+        n = len - i;
+        if (n > ADSI_RX_BANK_BLOCK_LEN)
+            n = ADSI_RX_BANK_BLOCK_LEN;
+        /* All the channels use the same tones, so the local oscillators used to correlate
+           against them need only be generated once for the whole bank. */
+        fsk_rx_shared_lo(&s->chan[0].fskrx, s->phase_acc, s->lo, n);
+        for (j = 0;  j < s->channels;  j++)
+        {
+            if (amp[j] == NULL)
+                continue;
+            if ((nbits = fsk_rx_block(&s->chan[j].fskrx, &amp[j][i], (const complexi_t (*)[2]) s->lo, n, s->bits)) > 0)
+                adsi_rx_put_bit_chunk(&s->chan[j], s->bits, nbits);
+        }
+    }
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(adsi_rx_state_t *) adsi_rx_bank_get_channel(adsi_rx_bank_state_t *s, int channel)
+{
+    if (channel < 0  ||  channel >= s->channels)
+        return NULL;
+    return &s->chan[channel];
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(adsi_rx_bank_state_t *) adsi_rx_bank_init(adsi_rx_bank_state_t *s,
+                                                       int standard,
+                                                       int channels,
+                                                       put_msg_func_t put_msg,
+                                                       void *user_data[])
+{
+    adsi_rx_state_t *chan;
+    int i;
+
+    if (channels <= 0)
+        return NULL;
+    if ((chan = (adsi_rx_state_t *) span_alloc(channels*sizeof(*chan))) == NULL)
+        return NULL;
+    if (s == NULL)
+    {
+        if ((s = (adsi_rx_bank_state_t *) span_alloc(sizeof(*s))) == NULL)
+        {
+            span_free(chan);
+            return NULL;
+        }
+    }
+    memset(s, 0, sizeof(*s));
+    s->standard = standard;
+    s->channels = channels;
+    s->chan = chan;
+    for (i = 0;  i < channels;  i++)
+        adsi_rx_init(&s->chan[i], standard, put_msg, (user_data)  ?  user_data[i]  :  NULL);
+    return s;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) adsi_rx_bank_release(adsi_rx_bank_state_t *s)
+{
+    span_free(s->chan);
+    s->chan = NULL;
+    s->channels = 0;
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) adsi_rx_bank_free(adsi_rx_bank_state_t *s)
+{
+    adsi_rx_bank_release(s);
+    span_free(s);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE(int) adsi_tx(adsi_tx_state_t *s, int16_t amp[], int max_len)
 {
     int len;
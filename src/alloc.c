@@ -47,13 +47,32 @@
 #include <inttypes.h>
 #include <string.h>
 #include <errno.h>
+#if defined(HAVE_STDBOOL_H)
+#include <stdbool.h>
+#else
+#include "spandsp/stdbool.h"
+#endif
 #include <signal.h>
 #include <sys/time.h>
 #include <time.h>
+#if defined(HAVE_UNISTD_H)
+#include <unistd.h>
+#endif
+#if defined(HAVE_SYS_MMAN_H)
+#include <sys/mman.h>
+#endif
+#if defined(HAVE_SYS_SYSCALL_H)
+#include <sys/syscall.h>
+#endif
+#if defined(HAVE_PTHREAD_H)
+#include <pthread.h>
+#endif
 
 #include "spandsp/telephony.h"
 #include "spandsp/alloc.h"
 
+#include "atomic_ops.h"
+
 #if defined(_MSC_VER)
 #pragma warning(push)
 #pragma warning(disable:4232)	/* address of dllimport is not static, identity not guaranteed */
@@ -82,6 +101,112 @@ static span_free_t __span_free = free;
 #pragma warning(pop)
 #endif
 
+#if defined(_MSC_VER)
+#define SPAN_THREAD_LOCAL __declspec(thread)
+#elif defined(__GNUC__)
+#define SPAN_THREAD_LOCAL __thread
+#else
+#define SPAN_THREAD_LOCAL /**/
+#endif
+
+/* The allocation context of each thread. These are plain data, so they need no
+   cleanup when a thread exits. */
+static SPAN_THREAD_LOCAL span_alloc_context_t __span_context;
+static SPAN_THREAD_LOCAL int __span_context_in_use = 0;
+
+/* The kernel's mbind() parameters. We use the raw system call, so we don't need
+   libnuma. */
+#define SPAN_MPOL_PREFERRED     1
+#define SPAN_MPOL_MF_MOVE       (1 << 1)
+#define SPAN_MAX_NUMA_NODES     1024
+
+#if defined(HAVE_SYS_MMAN_H)  &&  defined(_SC_PAGESIZE)  &&  defined(MAP_ANONYMOUS)
+/* Memory allocated under an allocation context comes from a pool kept for that
+   context's placement. A pool is a list of chunks, mapped straight from the OS, and
+   placed once, when each is mapped. Placing each block as it was allocated would
+   split the heap's mappings into many small regions, could never get huge pages for
+   blocks smaller than a huge page, and would leave the placement on memory malloc
+   later handed to other users. Freed blocks go back to their pool, still placed. */
+#define SPAN_MEM_POOLS
+
+/*! The size, and alignment, of a pool chunk. This is the usual huge page size. */
+#define SPAN_POOL_CHUNK_SIZE    (2*1024*1024)
+/*! The space at the start of each chunk for the chunk's header */
+#define SPAN_POOL_CHUNK_HEADER  64
+/*! The granularity of blocks in a pool, and the minimum alignment of memory from one */
+#define SPAN_POOL_GRAIN         16
+/*! The smallest free block worth splitting off an allocation */
+#define SPAN_POOL_MIN_SPLIT     64
+/*! The largest alignment a pool serves. Larger ones use the normal allocator. */
+#define SPAN_POOL_MAX_ALIGNMENT 4096
+/*! The number of entries in the table of chunk slots. This is a power of 2, and
+    allows for up to 8GB of pools. */
+#define SPAN_POOL_TABLE_SIZE    4096
+/*! A table entry which has never been used */
+#define SPAN_POOL_SLOT_EMPTY    0
+/*! A table entry whose chunk has been returned to the OS */
+#define SPAN_POOL_SLOT_DELETED  1
+
+typedef struct span_pool_block_s
+{
+    /*! \brief The size of the block, in bytes, including this header. */
+    size_t size;
+    /*! \brief The next free block, in address order, while the block is free. */
+    struct span_pool_block_s *next;
+} span_pool_block_t;
+
+typedef struct span_mem_pool_s span_mem_pool_t;
+
+typedef struct span_pool_chunk_s
+{
+    /*! \brief The next chunk in the same pool. */
+    struct span_pool_chunk_s *next;
+    /*! \brief The pool which owns the chunk. */
+    span_mem_pool_t *pool;
+    /*! \brief The size of the chunk, in bytes, including this header. */
+    size_t size;
+} span_pool_chunk_t;
+
+struct span_mem_pool_s
+{
+    /*! \brief The placement of all the memory in the pool. */
+    span_alloc_context_t context;
+    /*! \brief The chunks of memory the pool holds. */
+    span_pool_chunk_t *chunks;
+    /*! \brief The number of chunks in the pool. */
+    int n_chunks;
+    /*! \brief The free blocks across all the chunks, in address order. */
+    span_pool_block_t *free_list;
+    /*! \brief The next pool. */
+    span_mem_pool_t *next;
+};
+
+/* The pools are shared by all threads. A block may be freed by a thread other than
+   the one which allocated it, and threads with the same placement use the same pool.
+   A single lock is enough, as allocation happens when channels are set up, rather
+   than while they run. */
+static span_mem_pool_t *__span_pools = NULL;
+
+/* span_free() must tell blocks from a pool from any other memory, and most frees are
+   of other memory. Each chunk-sized, chunk-aligned slot of address space a chunk
+   covers has an entry in this open addressed hash table, giving the chunk. A block
+   is found by the slot holding its address, without taking the lock. Entries are
+   only added and removed with the lock held. The chunk is set before the slot is
+   published, so a reader which finds the slot also sees the chunk. */
+typedef struct
+{
+    /*! \brief The address of the slot, or one of the SPAN_POOL_SLOT_xxx markers. */
+    volatile uintptr_t slot;
+    /*! \brief The chunk covering the slot. */
+    span_pool_chunk_t *chunk;
+} span_pool_slot_t;
+
+static span_pool_slot_t __span_pool_table[SPAN_POOL_TABLE_SIZE];
+#if defined(HAVE_PTHREAD_H)
+static pthread_mutex_t __span_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+#endif
+
 #if defined(HAVE_ALIGNED_ALLOC)
 #elif defined(HAVE_MEMALIGN)
 #elif defined(__MSVC__)
@@ -109,32 +234,522 @@ static void *fake_aligned_alloc(size_t alignment, size_t size)
 /*- End of function --------------------------------------------------------*/
 #endif
 
+SPAN_DECLARE(int) span_mem_place(void *ptr, size_t size, const span_alloc_context_t *context)
+{
+#if defined(HAVE_SYS_MMAN_H)  &&  defined(_SC_PAGESIZE)
+    uintptr_t page_size;
+    uintptr_t start;
+    uintptr_t end;
+    int res;
+#if defined(__linux__)  &&  defined(SYS_mbind)
+    unsigned long int node_mask[SPAN_MAX_NUMA_NODES/(8*sizeof(unsigned long int))];
+    int bits;
+#endif
+
+    if (ptr == NULL  ||  context == NULL)
+        return -1;
+    /*endif*/
+    /* Only whole pages can be placed. The partial pages at the ends of a block may be
+       shared with other blocks, so they are left alone. */
+    page_size = (uintptr_t) sysconf(_SC_PAGESIZE);
+    start = ((uintptr_t) ptr + page_size - 1) & ~(page_size - 1);
+    end = ((uintptr_t) ptr + size) & ~(page_size - 1);
+    if (end <= start)
+        return 0;
+    /*endif*/
+    res = 0;
+#if defined(MADV_HUGEPAGE)
+    if (context->huge_pages)
+    {
+        if (madvise((void *) start, end - start, MADV_HUGEPAGE))
+            res = -1;
+        /*endif*/
+    }
+    /*endif*/
+#endif
+#if defined(__linux__)  &&  defined(SYS_mbind)
+    if (context->numa_node >= 0)
+    {
+        if (context->numa_node >= SPAN_MAX_NUMA_NODES)
+            return -1;
+        /*endif*/
+        /* A preferred node, rather than a binding, so a full node doesn't cause
+           allocations to fail. */
+        bits = 8*sizeof(node_mask[0]);
+        memset(node_mask, 0, sizeof(node_mask));
+        node_mask[context->numa_node/bits] = 1UL << (context->numa_node%bits);
+        if (syscall(SYS_mbind, start, end - start, SPAN_MPOL_PREFERRED, node_mask, SPAN_MAX_NUMA_NODES + 1, SPAN_MPOL_MF_MOVE))
+            res = -1;
+        /*endif*/
+    }
+    /*endif*/
+#endif
+    return res;
+#else
+    if (ptr == NULL  ||  context == NULL)
+        return -1;
+    /*endif*/
+    /* We have no way to place memory on this platform */
+    return (context->numa_node < 0  &&  !context->huge_pages)  ?  0  :  -1;
+#endif
+}
+/*- End of function --------------------------------------------------------*/
+
+#if defined(SPAN_MEM_POOLS)
+static int pool_lock(void)
+{
+#if defined(HAVE_PTHREAD_H)
+    return pthread_mutex_lock(&__span_pool_mutex);
+#else
+    return 0;
+#endif
+}
+/*- End of function --------------------------------------------------------*/
+
+static int pool_unlock(void)
+{
+#if defined(HAVE_PTHREAD_H)
+    return pthread_mutex_unlock(&__span_pool_mutex);
+#else
+    return 0;
+#endif
+}
+/*- End of function --------------------------------------------------------*/
+
+static span_mem_pool_t *get_pool(const span_alloc_context_t *context)
+{
+    span_mem_pool_t *pool;
+
+    for (pool = __span_pools;  pool;  pool = pool->next)
+    {
+        if (pool->context.numa_node == context->numa_node  &&  pool->context.huge_pages == context->huge_pages)
+            return pool;
+        /*endif*/
+    }
+    /*endfor*/
+    if ((pool = (span_mem_pool_t *) malloc(sizeof(*pool))) == NULL)
+        return NULL;
+    /*endif*/
+    memset(pool, 0, sizeof(*pool));
+    pool->context = *context;
+    pool->next = __span_pools;
+    __span_pools = pool;
+    return pool;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int slot_hash(uintptr_t slot)
+{
+    return (int) (((slot/SPAN_POOL_CHUNK_SIZE)*2654435761U) & (SPAN_POOL_TABLE_SIZE - 1));
+}
+/*- End of function --------------------------------------------------------*/
+
+static span_pool_chunk_t *find_chunk(const void *ptr)
+{
+    uintptr_t slot;
+    uintptr_t entry;
+    int i;
+    int j;
+
+    slot = (uintptr_t) ptr & ~((uintptr_t) SPAN_POOL_CHUNK_SIZE - 1);
+    i = slot_hash(slot);
+    for (j = 0;  j < SPAN_POOL_TABLE_SIZE;  j++)
+    {
+        if ((entry = span_load_acquire(&__span_pool_table[i].slot)) == slot)
+            return __span_pool_table[i].chunk;
+        /*endif*/
+        if (entry == SPAN_POOL_SLOT_EMPTY)
+            break;
+        /*endif*/
+        i = (i + 1) & (SPAN_POOL_TABLE_SIZE - 1);
+    }
+    /*endfor*/
+    return NULL;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void unregister_chunk(span_pool_chunk_t *chunk, size_t len)
+{
+    uintptr_t slot;
+    int i;
+
+    for (slot = (uintptr_t) chunk;  slot < (uintptr_t) chunk + len;  slot += SPAN_POOL_CHUNK_SIZE)
+    {
+        for (i = slot_hash(slot);  __span_pool_table[i].slot != slot;  i = (i + 1) & (SPAN_POOL_TABLE_SIZE - 1))
+            ;
+        /*endfor*/
+        span_store_release(&__span_pool_table[i].slot, (uintptr_t) SPAN_POOL_SLOT_DELETED);
+    }
+    /*endfor*/
+}
+/*- End of function --------------------------------------------------------*/
+
+static int register_chunk(span_pool_chunk_t *chunk)
+{
+    uintptr_t slot;
+    int i;
+    int j;
+
+    for (slot = (uintptr_t) chunk;  slot < (uintptr_t) chunk + chunk->size;  slot += SPAN_POOL_CHUNK_SIZE)
+    {
+        i = slot_hash(slot);
+        for (j = 0;  j < SPAN_POOL_TABLE_SIZE;  j++)
+        {
+            if (__span_pool_table[i].slot == SPAN_POOL_SLOT_EMPTY  ||  __span_pool_table[i].slot == SPAN_POOL_SLOT_DELETED)
+                break;
+            /*endif*/
+            i = (i + 1) & (SPAN_POOL_TABLE_SIZE - 1);
+        }
+        /*endfor*/
+        if (j >= SPAN_POOL_TABLE_SIZE)
+        {
+            /* The table is full, so the chunk cannot be used */
+            unregister_chunk(chunk, slot - (uintptr_t) chunk);
+            return -1;
+        }
+        /*endif*/
+        __span_pool_table[i].chunk = chunk;
+        span_store_release(&__span_pool_table[i].slot, slot);
+    }
+    /*endfor*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void insert_free_block(span_mem_pool_t *pool, span_pool_block_t *block)
+{
+    span_pool_block_t *prev;
+    span_pool_block_t *next;
+
+    /* The free list is kept in address order, so neighbouring free blocks can be
+       merged. Blocks in different chunks never touch, as each chunk starts with its
+       header. */
+    prev = NULL;
+    for (next = pool->free_list;  next  &&  next < block;  next = next->next)
+        prev = next;
+    /*endfor*/
+    if (next  &&  (uint8_t *) block + block->size == (uint8_t *) next)
+    {
+        block->size += next->size;
+        block->next = next->next;
+    }
+    else
+    {
+        block->next = next;
+    }
+    /*endif*/
+    if (prev  &&  (uint8_t *) prev + prev->size == (uint8_t *) block)
+    {
+        prev->size += block->size;
+        prev->next = block->next;
+    }
+    else if (prev)
+    {
+        prev->next = block;
+    }
+    else
+    {
+        pool->free_list = block;
+    }
+    /*endif*/
+}
+/*- End of function --------------------------------------------------------*/
+
+static int add_chunk(span_mem_pool_t *pool, size_t size)
+{
+    span_pool_chunk_t *chunk;
+    span_pool_block_t *block;
+    uint8_t *map;
+    uintptr_t start;
+
+    /* Chunks are aligned to, and a multiple of, the huge page size, so the kernel can
+       back them with huge pages. mmap() only promises page alignment, so map more
+       than is needed and trim the ends. */
+    size = (size + SPAN_POOL_CHUNK_SIZE - 1) & ~((size_t) SPAN_POOL_CHUNK_SIZE - 1);
+    map = (uint8_t *) mmap(NULL, size + SPAN_POOL_CHUNK_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (map == (uint8_t *) MAP_FAILED)
+        return -1;
+    /*endif*/
+    start = ((uintptr_t) map + SPAN_POOL_CHUNK_SIZE - 1) & ~((uintptr_t) SPAN_POOL_CHUNK_SIZE - 1);
+    if (start > (uintptr_t) map)
+        munmap(map, start - (uintptr_t) map);
+    /*endif*/
+    munmap((void *) (start + size), (uintptr_t) map + SPAN_POOL_CHUNK_SIZE - start);
+    /* Placement is a hint, so a chunk which cannot be placed is still used */
+    span_mem_place((void *) start, size, &pool->context);
+
+    chunk = (span_pool_chunk_t *) start;
+    chunk->size = size;
+    chunk->pool = pool;
+    if (register_chunk(chunk))
+    {
+        munmap(chunk, size);
+        return -1;
+    }
+    /*endif*/
+    chunk->next = pool->chunks;
+    pool->chunks = chunk;
+    pool->n_chunks++;
+    block = (span_pool_block_t *) (start + SPAN_POOL_CHUNK_HEADER);
+    block->size = size - SPAN_POOL_CHUNK_HEADER;
+    insert_free_block(pool, block);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void release_chunk(span_mem_pool_t *pool, span_pool_chunk_t *chunk)
+{
+    span_pool_chunk_t **link;
+
+    for (link = &pool->chunks;  *link != chunk;  link = &(*link)->next)
+        ;
+    /*endfor*/
+    *link = chunk->next;
+    pool->n_chunks--;
+    unregister_chunk(chunk, chunk->size);
+    munmap(chunk, chunk->size);
+}
+/*- End of function --------------------------------------------------------*/
+
+static void *pool_alloc(span_mem_pool_t *pool, size_t alignment, size_t size)
+{
+    span_pool_block_t *block;
+    span_pool_block_t *prev;
+    span_pool_block_t *rest;
+    uintptr_t user;
+    size_t need;
+
+    /* Each block starts with its size. The pointer returned is aligned after that,
+       and the word before it points back to the start of the block. */
+    if (alignment < SPAN_POOL_GRAIN)
+        alignment = SPAN_POOL_GRAIN;
+    /*endif*/
+    need = alignment + ((size)  ?  size  :  1);
+    need = (need + SPAN_POOL_GRAIN - 1) & ~((size_t) SPAN_POOL_GRAIN - 1);
+    for (;;)
+    {
+        prev = NULL;
+        for (block = pool->free_list;  block;  block = block->next)
+        {
+            if (block->size >= need)
+                break;
+            /*endif*/
+            prev = block;
+        }
+        /*endfor*/
+        if (block)
+            break;
+        /*endif*/
+        if (add_chunk(pool, need + SPAN_POOL_CHUNK_HEADER))
+            return NULL;
+        /*endif*/
+    }
+    /*endfor*/
+    /* Split the block, unless what is left would be too small to be useful */
+    if (block->size - need >= SPAN_POOL_MIN_SPLIT)
+    {
+        rest = (span_pool_block_t *) ((uint8_t *) block + need);
+        rest->size = block->size - need;
+        rest->next = block->next;
+        block->size = need;
+    }
+    else
+    {
+        rest = block->next;
+    }
+    /*endif*/
+    if (prev)
+        prev->next = rest;
+    else
+        pool->free_list = rest;
+    /*endif*/
+    user = ((uintptr_t) block + SPAN_POOL_GRAIN + alignment - 1) & ~((uintptr_t) alignment - 1);
+    ((span_pool_block_t **) user)[-1] = block;
+    return (void *) user;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void pool_free(span_pool_chunk_t *chunk, void *ptr)
+{
+    span_mem_pool_t *pool;
+    span_pool_block_t *block;
+    span_pool_block_t *prev;
+
+    pool = chunk->pool;
+    insert_free_block(pool, ((span_pool_block_t **) ptr)[-1]);
+    /* A chunk which is completely free is returned to the OS, unless it is the last
+       one, which is kept to avoid remapping and placing memory for a pool which goes
+       repeatedly from empty to in use. */
+    if (pool->n_chunks <= 1)
+        return;
+    /*endif*/
+    prev = NULL;
+    for (block = pool->free_list;  block;  block = block->next)
+    {
+        if ((uint8_t *) block == (uint8_t *) chunk + SPAN_POOL_CHUNK_HEADER)
+        {
+            if (block->size == chunk->size - SPAN_POOL_CHUNK_HEADER)
+            {
+                if (prev)
+                    prev->next = block->next;
+                else
+                    pool->free_list = block->next;
+                /*endif*/
+                release_chunk(pool, chunk);
+            }
+            /*endif*/
+            break;
+        }
+        /*endif*/
+        prev = block;
+    }
+    /*endfor*/
+}
+/*- End of function --------------------------------------------------------*/
+
+static void *context_alloc(size_t alignment, size_t size)
+{
+    span_mem_pool_t *pool;
+    void *ptr;
+
+    ptr = NULL;
+    pool_lock();
+    if ((pool = get_pool(&__span_context)))
+        ptr = pool_alloc(pool, alignment, size);
+    /*endif*/
+    pool_unlock();
+    return ptr;
+}
+/*- End of function --------------------------------------------------------*/
+
+static size_t context_size(void *ptr)
+{
+    span_pool_block_t *block;
+
+    /* The usable size of a block from a pool, or zero for any other block */
+    if (ptr == NULL  ||  find_chunk(ptr) == NULL)
+        return 0;
+    /*endif*/
+    block = ((span_pool_block_t **) ptr)[-1];
+    return block->size - ((uint8_t *) ptr - (uint8_t *) block);
+}
+/*- End of function --------------------------------------------------------*/
+
+static int context_free(void *ptr)
+{
+    span_pool_chunk_t *chunk;
+
+    /* Most blocks are not from a pool, and are found not to be without taking the lock */
+    if (ptr == NULL  ||  (chunk = find_chunk(ptr)) == NULL)
+        return false;
+    /*endif*/
+    pool_lock();
+    pool_free(chunk, ptr);
+    pool_unlock();
+    return true;
+}
+/*- End of function --------------------------------------------------------*/
+#endif
+
+SPAN_DECLARE(int) span_mem_set_context(const span_alloc_context_t *context)
+{
+    if (context)
+    {
+        __span_context = *context;
+        __span_context_in_use = (context->numa_node >= 0  ||  context->huge_pages);
+    }
+    else
+    {
+        __span_context_in_use = 0;
+    }
+    /*endif*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(const span_alloc_context_t *) span_mem_get_context(void)
+{
+    return (__span_context_in_use)  ?  &__span_context  :  NULL;
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE(void *) span_alloc(size_t size)
 {
+#if defined(SPAN_MEM_POOLS)
+    void *ptr;
+
+    /* If the pool cannot grow, the memory still comes from the normal allocator,
+       as placement is only a hint. */
+    if (__span_context_in_use  &&  (ptr = context_alloc(SPAN_POOL_GRAIN, size)))
+        return ptr;
+    /*endif*/
+#endif
     return __span_alloc(size);
 }
 /*- End of function --------------------------------------------------------*/
 
 SPAN_DECLARE(void *) span_realloc(void *ptr, size_t size)
 {
+#if defined(SPAN_MEM_POOLS)
+    void *new_ptr;
+    size_t old_size;
+
+    if (ptr == NULL)
+        return span_alloc(size);
+    /*endif*/
+    /* A block from a pool moves to wherever new memory currently goes. A block from
+       the normal allocator stays with it. */
+    if ((old_size = context_size(ptr)) > 0)
+    {
+        new_ptr = NULL;
+        if (size > 0)
+        {
+            if ((new_ptr = span_alloc(size)) == NULL)
+                return NULL;
+            /*endif*/
+            memcpy(new_ptr, ptr, (old_size < size)  ?  old_size  :  size);
+        }
+        /*endif*/
+        context_free(ptr);
+        return new_ptr;
+    }
+    /*endif*/
+#endif
     return __span_realloc(ptr, size);
 }
 /*- End of function --------------------------------------------------------*/
 
 SPAN_DECLARE(void) span_free(void *ptr)
 {
+#if defined(SPAN_MEM_POOLS)
+    if (context_free(ptr))
+        return;
+    /*endif*/
+#endif
     __span_free(ptr);
 }
 /*- End of function --------------------------------------------------------*/
 
 SPAN_DECLARE(void *) span_aligned_alloc(size_t alignment, size_t size)
 {
+#if defined(SPAN_MEM_POOLS)
+    void *ptr;
+
+    if (__span_context_in_use  &&  alignment <= SPAN_POOL_MAX_ALIGNMENT  &&  (ptr = context_alloc(alignment, size)))
+        return ptr;
+    /*endif*/
+#endif
     return __span_aligned_alloc(alignment, size);
 }
 /*- End of function --------------------------------------------------------*/
 
 SPAN_DECLARE(void) span_aligned_free(void *ptr)
 {
+#if defined(SPAN_MEM_POOLS)
+    if (context_free(ptr))
+        return;
+    /*endif*/
+#endif
     __span_aligned_free(ptr);
 }
 /*- End of function --------------------------------------------------------*/
@@ -41,6 +41,7 @@
 
 #include "spandsp/telephony.h"
 #include "spandsp/alloc.h"
+#include "spandsp/bit_operations.h"
 #include "spandsp/async.h"
 
 #include "spandsp/private/async.h"
@@ -89,6 +90,48 @@ SPAN_DECLARE(const char *) signal_status_to_str(int status)
 }
 /*- End of function --------------------------------------------------------*/
 
+static __inline__ uint32_t get_packed_bits(const uint8_t bits[], int pos, int len)
+{
+    uint32_t word;
+    int shift;
+    int i;
+
+    /* Bits are packed LSB first, so the first bit in the stream is bit 0 of bits[0] */
+    shift = pos & 7;
+    word = 0;
+    for (i = 0;  8*i < shift + len;  i++)
+        word |= (uint32_t) bits[(pos >> 3) + i] << (8*i);
+    /*endfor*/
+    return (word >> shift) & ((1U << len) - 1);
+}
+/*- End of function --------------------------------------------------------*/
+
+static __inline__ void put_packed_bits(uint8_t bits[], int pos, uint32_t word, int len)
+{
+    int shift;
+    int chunk;
+
+    while (len > 0)
+    {
+        shift = pos & 7;
+        chunk = 8 - shift;
+        if (chunk > len)
+            chunk = len;
+        /*endif*/
+        /* The first write to each byte clears it, so the caller need not */
+        if (shift == 0)
+            bits[pos >> 3] = (uint8_t) (word & ((1U << chunk) - 1));
+        else
+            bits[pos >> 3] |= (uint8_t) ((word & ((1U << chunk) - 1)) << shift);
+        /*endif*/
+        word >>= chunk;
+        pos += chunk;
+        len -= chunk;
+    }
+    /*endwhile*/
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE_NONSTD(void) async_rx_put_bit(void *user_data, int bit)
 {
     async_rx_state_t *s;
@@ -170,6 +213,79 @@ SPAN_DECLARE_NONSTD(void) async_rx_put_bit(void *user_data, int bit)
 }
 /*- End of function --------------------------------------------------------*/
 
+SPAN_DECLARE(int) async_rx_put_bits(async_rx_state_t *s, const uint8_t bits[], int len)
+{
+    uint32_t frame;
+    int byte;
+    int parity_bit;
+    int i;
+
+    for (i = 0;  i < len;  )
+    {
+        if (s->bitpos == 0)
+        {
+            /* Skip idle marking a byte at a time */
+            if ((i & 7) == 0  &&  len - i >= 8  &&  bits[i >> 3] == 0xFF)
+            {
+                i += 8;
+                continue;
+            }
+            /*endif*/
+            if (len - i >= s->frame_bits)
+            {
+                /* A whole character is available, so deframe it in one go */
+                frame = get_packed_bits(bits, i, s->frame_bits);
+                if ((frame & 1))
+                {
+                    /* Not a start bit */
+                    i++;
+                    continue;
+                }
+                /*endif*/
+                byte = (frame >> 1) & ((1 << s->data_bits) - 1);
+                if (s->parity)
+                {
+                    parity_bit = parity8((uint8_t) byte);
+                    if (s->parity == ASYNC_PARITY_ODD)
+                        parity_bit ^= 1;
+                    /*endif*/
+                    if (parity_bit != ((frame >> (s->data_bits + 1)) & 1))
+                        s->parity_errors++;
+                    /*endif*/
+                }
+                /*endif*/
+                if ((frame >> (s->frame_bits - 1)) & 1)
+                {
+                    s->put_byte(s->user_data, byte);
+                    i += s->frame_bits;
+                }
+                else if (s->use_v14)
+                {
+                    /* The stop bit was dropped, and this is the start bit of the
+                       next character. */
+                    s->put_byte(s->user_data, byte);
+                    i += s->frame_bits - 1;
+                }
+                else
+                {
+                    s->framing_errors++;
+                    i += s->frame_bits;
+                }
+                /*endif*/
+                continue;
+            }
+            /*endif*/
+        }
+        /*endif*/
+        /* Part of a character, at either end of the block */
+        async_rx_put_bit(s, (bits[i >> 3] >> (i & 7)) & 1);
+        i++;
+    }
+    /*endfor*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE(async_rx_state_t *) async_rx_init(async_rx_state_t *s,
                                                int data_bits,
                                                int parity,
@@ -187,6 +303,7 @@ SPAN_DECLARE(async_rx_state_t *) async_rx_init(async_rx_state_t *s,
     s->parity = parity;
     s->stop_bits = stop_bits;
     s->use_v14 = use_v14;
+    s->frame_bits = 1 + data_bits + ((parity != ASYNC_PARITY_NONE)  ?  1  :  0) + 1;
 
     s->put_byte = put_byte;
     s->user_data = user_data;
@@ -214,15 +331,31 @@ SPAN_DECLARE(int) async_rx_free(async_rx_state_t *s)
 }
 /*- End of function --------------------------------------------------------*/
 
+static __inline__ uint32_t async_tx_frame_byte(async_tx_state_t *s, int byte)
+{
+    uint32_t frame;
+
+    /* The start bit is the zero in bit 0 */
+    byte &= (1 << s->data_bits) - 1;
+    frame = s->frame_stop_bits | ((uint32_t) byte << 1);
+    if (s->parity)
+        frame |= (uint32_t) (parity8((uint8_t) byte) ^ ((s->parity == ASYNC_PARITY_ODD)  ?  1  :  0)) << (s->data_bits + 1);
+    /*endif*/
+    return frame;
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE_NONSTD(int) async_tx_get_bit(void *user_data)
 {
     async_tx_state_t *s;
+    int byte;
     int bit;
 
     s = (async_tx_state_t *) user_data;
     if (s->bitpos == 0)
     {
-        if ((s->byte_in_progress = s->get_byte(s->user_data)) < 0)
+        /* byte_in_progress is unsigned, so test the byte before storing it */
+        if ((byte = s->get_byte(s->user_data)) < 0)
         {
             /* No more data */
             bit = SIG_STATUS_END_OF_DATA;
@@ -230,6 +363,7 @@ SPAN_DECLARE_NONSTD(int) async_tx_get_bit(void *user_data)
         else
         {
             /* Start bit */
+            s->byte_in_progress = byte;
             bit = 0;
             s->parity_bit = 0;
             s->bitpos++;
@@ -260,6 +394,52 @@ SPAN_DECLARE_NONSTD(int) async_tx_get_bit(void *user_data)
 }
 /*- End of function --------------------------------------------------------*/
 
+SPAN_DECLARE(int) async_tx_get_bits(async_tx_state_t *s, uint8_t bits[], int max_bits)
+{
+    uint32_t frame;
+    int byte;
+    int bit;
+    int i;
+
+    for (i = 0;  i < max_bits;  )
+    {
+        if (s->bitpos == 0  &&  max_bits - i >= s->frame_bits)
+        {
+            /* Send a whole character in one go */
+            if ((byte = s->get_byte(s->user_data)) < 0)
+                break;
+            /*endif*/
+            frame = async_tx_frame_byte(s, byte);
+            put_packed_bits(bits, i, frame, s->frame_bits);
+            i += s->frame_bits;
+        }
+        else
+        {
+            /* Part of a character, at either end of the block */
+            if ((bit = async_tx_get_bit(s)) < 0)
+                break;
+            /*endif*/
+            put_packed_bits(bits, i, bit, 1);
+            i++;
+        }
+        /*endif*/
+    }
+    /*endfor*/
+    return i;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) async_tx_frame_bytes(async_tx_state_t *s, uint8_t bits[], const uint8_t buf[], int len)
+{
+    int i;
+
+    for (i = 0;  i < len;  i++)
+        put_packed_bits(bits, i*s->frame_bits, async_tx_frame_byte(s, buf[i]), s->frame_bits);
+    /*endfor*/
+    return len*s->frame_bits;
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE(async_tx_state_t *) async_tx_init(async_tx_state_t *s,
                                                int data_bits,
                                                int parity,
@@ -268,6 +448,8 @@ SPAN_DECLARE(async_tx_state_t *) async_tx_init(async_tx_state_t *s,
                                                get_byte_func_t get_byte,
                                                void *user_data)
 {
+    int i;
+
     if (s == NULL)
     {
         if ((s = (async_tx_state_t *) span_alloc(sizeof(*s))) == NULL)
@@ -281,6 +463,11 @@ SPAN_DECLARE(async_tx_state_t *) async_tx_init(async_tx_state_t *s,
     s->stop_bits = stop_bits;
     if (parity != ASYNC_PARITY_NONE)
         s->stop_bits++;
+    /* A framed character is the start bit, the data bits, any parity bit, and
+       the stop bits, sent from bit 0 upwards */
+    s->frame_bits = 1 + data_bits + s->stop_bits;
+    i = 1 + data_bits + ((parity != ASYNC_PARITY_NONE)  ?  1  :  0);
+    s->frame_stop_bits = ((1U << s->frame_bits) - 1) & ~((1U << i) - 1);
 
     s->get_byte = get_byte;
     s->user_data = user_data;
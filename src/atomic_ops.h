@@ -0,0 +1,50 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * atomic_ops.h - Acquire and release access to words shared between threads.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2014 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 2.1,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/* A word one thread publishes, and another reads without a lock, must be stored with
+   release ordering, so everything written before it is visible first, and loaded with
+   acquire ordering, so nothing read after it can be seen stale. Plain accesses, even
+   to volatile words, give neither on weakly ordered CPUs, such as ARM.
+
+   The shared words stay plain (volatile) integers and pointers in the structures, as
+   those structures are in installed headers, which must also build as C++. */
+
+#if !defined(_SPANDSP_ATOMIC_OPS_H_)
+#define _SPANDSP_ATOMIC_OPS_H_
+
+#if defined(__GNUC__)  ||  defined(__clang__)
+#define span_load_acquire(p)        __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define span_store_release(p, v)    __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#elif defined(_MSC_VER)
+/* Microsoft's compilers give volatile accesses acquire and release semantics with
+   /volatile:ms, which is the default for x86 and x64 targets. */
+#define span_load_acquire(p)        (*(p))
+#define span_store_release(p, v)    (*(p) = (v))
+#else
+#error No acquire and release operations are known for this compiler
+#endif
+
+#endif
+/*- End of file ------------------------------------------------------------*/
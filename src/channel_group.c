@@ -0,0 +1,258 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * channel_group.c - Process a group of channels together, in a cache friendly way.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2013 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 2.1,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \file */
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#if defined(HAVE_STDBOOL_H)
+#include <stdbool.h>
+#else
+#include "spandsp/stdbool.h"
+#endif
+
+#include "spandsp/telephony.h"
+#include "spandsp/alloc.h"
+#include "spandsp/channel_group.h"
+
+#include "spandsp/private/channel_group.h"
+
+/* The prefetches step through memory a cache line at a time */
+#define CACHE_LINE_BYTES    64
+
+#if defined(__GNUC__)
+#define prefetch_read(p)    __builtin_prefetch((p), 0)
+#define prefetch_write(p)   __builtin_prefetch((p), 1)
+#else
+#define prefetch_read(p)    /**/
+#define prefetch_write(p)   /**/
+#endif
+
+static __inline__ void prefetch_channel(const channel_group_channel_t *c, int len)
+{
+    const uint8_t *p;
+    int i;
+
+    p = (const uint8_t *) c->user_data;
+    for (i = 0;  i < c->prefetch_len;  i += CACHE_LINE_BYTES)
+        prefetch_read(p + i);
+    /*endfor*/
+    if (c->rx_handler)
+    {
+        p = (const uint8_t *) c->rx_buf;
+        for (i = 0;  i < len*(int) sizeof(int16_t);  i += CACHE_LINE_BYTES)
+            prefetch_read(p + i);
+        /*endfor*/
+    }
+    /*endif*/
+    if (c->tx_handler)
+    {
+        p = (const uint8_t *) c->tx_buf;
+        for (i = 0;  i < len*(int) sizeof(int16_t);  i += CACHE_LINE_BYTES)
+            prefetch_write(p + i);
+        /*endfor*/
+    }
+    /*endif*/
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) channel_group_process(channel_group_state_t *s, int len)
+{
+    channel_group_channel_t *c;
+    int i;
+
+    if (s->channels > 0)
+        prefetch_channel(&s->chan[s->order[0]], len);
+    /*endif*/
+    for (i = 0;  i < s->channels;  i++)
+    {
+        c = &s->chan[s->order[i]];
+        /* Bring in the next channel while this one is being processed */
+        if (i + 1 < s->channels)
+            prefetch_channel(&s->chan[s->order[i + 1]], len);
+        /*endif*/
+        if (c->rx_handler)
+            c->rx_handler(c->user_data, c->rx_buf, len);
+        /*endif*/
+        if (c->tx_handler)
+            c->tx_len = c->tx_handler(c->user_data, c->tx_buf, len);
+        /*endif*/
+    }
+    /*endfor*/
+    return s->channels;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) channel_group_add(channel_group_state_t *s,
+                                    span_rx_handler_t *rx_handler,
+                                    span_tx_handler_t *tx_handler,
+                                    void *user_data,
+                                    int prefetch_len,
+                                    int16_t rx_buf[],
+                                    int16_t tx_buf[])
+{
+    int handle;
+    int i;
+
+    if (user_data == NULL  ||  s->channels >= s->max_channels)
+        return -1;
+    /*endif*/
+    for (handle = 0;  handle < s->max_channels;  handle++)
+    {
+        if (s->chan[handle].user_data == NULL)
+            break;
+        /*endif*/
+    }
+    /*endfor*/
+    if (prefetch_len > CHANNEL_GROUP_MAX_PREFETCH)
+        prefetch_len = CHANNEL_GROUP_MAX_PREFETCH;
+    else if (prefetch_len < 0)
+        prefetch_len = 0;
+    /*endif*/
+    s->chan[handle].rx_handler = rx_handler;
+    s->chan[handle].tx_handler = tx_handler;
+    s->chan[handle].user_data = user_data;
+    s->chan[handle].prefetch_len = prefetch_len;
+    s->chan[handle].rx_buf = rx_buf;
+    s->chan[handle].tx_buf = tx_buf;
+    s->chan[handle].tx_len = 0;
+    /* Keep the processing order sorted by the address of the contexts */
+    for (i = s->channels;  i > 0;  i--)
+    {
+        if ((uintptr_t) s->chan[s->order[i - 1]].user_data <= (uintptr_t) user_data)
+            break;
+        /*endif*/
+        s->order[i] = s->order[i - 1];
+    }
+    /*endfor*/
+    s->order[i] = handle;
+    s->channels++;
+    return handle;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) channel_group_remove(channel_group_state_t *s, int handle)
+{
+    int i;
+
+    if (handle < 0  ||  handle >= s->max_channels  ||  s->chan[handle].user_data == NULL)
+        return -1;
+    /*endif*/
+    for (i = 0;  s->order[i] != handle;  i++)
+        ;
+    /*endfor*/
+    memmove(&s->order[i], &s->order[i + 1], (s->channels - i - 1)*sizeof(s->order[0]));
+    s->channels--;
+    memset(&s->chan[handle], 0, sizeof(s->chan[handle]));
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) channel_group_get_tx_len(channel_group_state_t *s, int handle)
+{
+    if (handle < 0  ||  handle >= s->max_channels  ||  s->chan[handle].user_data == NULL)
+        return -1;
+    /*endif*/
+    return s->chan[handle].tx_len;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) channel_group_get_channels(channel_group_state_t *s)
+{
+    return s->channels;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(channel_group_state_t *) channel_group_init(channel_group_state_t *s, int max_channels)
+{
+    channel_group_state_t *t;
+
+    if (max_channels <= 0)
+        return NULL;
+    /*endif*/
+    t = s;
+    if (t == NULL)
+    {
+        if ((t = (channel_group_state_t *) span_alloc(sizeof(*t))) == NULL)
+            return NULL;
+        /*endif*/
+    }
+    /*endif*/
+    memset(t, 0, sizeof(*t));
+    t->chan = (channel_group_channel_t *) span_alloc(max_channels*sizeof(t->chan[0]));
+    t->order = (int *) span_alloc(max_channels*sizeof(t->order[0]));
+    if (t->chan == NULL  ||  t->order == NULL)
+    {
+        channel_group_release(t);
+        if (s == NULL)
+            span_free(t);
+        /*endif*/
+        return NULL;
+    }
+    /*endif*/
+    memset(t->chan, 0, max_channels*sizeof(t->chan[0]));
+    t->max_channels = max_channels;
+    return t;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) channel_group_release(channel_group_state_t *s)
+{
+    if (s->chan)
+    {
+        span_free(s->chan);
+        s->chan = NULL;
+    }
+    /*endif*/
+    if (s->order)
+    {
+        span_free(s->order);
+        s->order = NULL;
+    }
+    /*endif*/
+    s->channels = 0;
+    s->max_channels = 0;
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) channel_group_free(channel_group_state_t *s)
+{
+    if (s)
+    {
+        channel_group_release(s);
+        span_free(s);
+    }
+    /*endif*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+/*- End of file ------------------------------------------------------------*/
@@ -128,6 +128,48 @@ SPAN_DECLARE(void) cvec_mull(complexl_t z[], const complexl_t x[], const complex
 /*- End of function --------------------------------------------------------*/
 #endif
 
+#if defined(__GNUC__)  &&  defined(SPANDSP_USE_SSE3)
+SPAN_DECLARE(complexf_t) cvec_dot_prodf(const complexf_t x[], const complexf_t y[], int n)
+{
+    int i;
+    complexf_t z;
+    __m128 n0;
+    __m128 n1;
+    __m128 n2;
+    __m128 n3;
+    __m128 n4;
+
+    z = complex_setf(0.0f, 0.0f);
+    if ((i = n & ~1))
+    {
+        n4 = _mm_setzero_ps();
+        i <<= 1;
+        for (i -= 4;  i >= 0;  i -= 4)
+        {
+            n3 = _mm_loadu_ps((float *) x + i);
+            n0 = _mm_moveldup_ps(n3);
+            n1 = _mm_loadu_ps((float *) y + i);
+            n0 = _mm_mul_ps(n0, n1);
+            n1 = _mm_shuffle_ps(n1, n1, 0xB1);
+            n2 = _mm_movehdup_ps(n3);
+            n2 = _mm_mul_ps(n2, n1);
+            n0 = _mm_addsub_ps(n0, n2);
+            n4 = _mm_add_ps(n4, n0);
+        }
+        /* Add the two complex partial sums */
+        n4 = _mm_add_ps(_mm_movehl_ps(n4, n4), n4);
+        _mm_storel_pi((__m64 *) &z, n4);
+    }
+    /* Now deal with the last element, which doesn't fill an SSE2 register */
+    switch (n & 1)
+    {
+    case 1:
+        z.re += (x[n - 1].re*y[n - 1].re - x[n - 1].im*y[n - 1].im);
+        z.im += (x[n - 1].re*y[n - 1].im + x[n - 1].im*y[n - 1].re);
+    }
+    return z;
+}
+#else
 SPAN_DECLARE(complexf_t) cvec_dot_prodf(const complexf_t x[], const complexf_t y[], int n)
 {
     int i;
@@ -141,6 +183,7 @@ SPAN_DECLARE(complexf_t) cvec_dot_prodf(const complexf_t x[], const complexf_t y
     }
     return z;
 }
+#endif
 /*- End of function --------------------------------------------------------*/
 
 SPAN_DECLARE(complex_t) cvec_dot_prod(const complex_t x[], const complex_t y[], int n)
@@ -189,6 +232,50 @@ SPAN_DECLARE(complexf_t) cvec_circular_dot_prodf(const complexf_t x[], const com
 
 #define LMS_LEAK_RATE   0.9999f
 
+#if defined(__GNUC__)  &&  defined(SPANDSP_USE_SSE3)
+SPAN_DECLARE(void) cvec_lmsf(const complexf_t x[], complexf_t y[], int n, const complexf_t *error)
+{
+    int i;
+    __m128 n0;
+    __m128 n1;
+    __m128 n2;
+    __m128 n3;
+    __m128 err;
+    __m128 nerr_swapped;
+    __m128 leak;
+
+    if ((i = n & ~1))
+    {
+        /* err = {e.re, e.im, e.re, e.im}, nerr_swapped = {-e.im, -e.re, -e.im, -e.re} */
+        err = _mm_setr_ps(error->re, error->im, error->re, error->im);
+        nerr_swapped = _mm_setr_ps(-error->im, -error->re, -error->im, -error->re);
+        leak = _mm_set1_ps(LMS_LEAK_RATE);
+        i <<= 1;
+        for (i -= 4;  i >= 0;  i -= 4)
+        {
+            n3 = _mm_loadu_ps((float *) x + i);
+            n0 = _mm_moveldup_ps(n3);
+            n0 = _mm_mul_ps(n0, err);
+            n2 = _mm_movehdup_ps(n3);
+            n2 = _mm_mul_ps(n2, nerr_swapped);
+            /* n0 = {x.re*e.re + x.im*e.im, x.re*e.im - x.im*e.re, ...} */
+            n0 = _mm_addsub_ps(n0, n2);
+            /* Leak a little to tame uncontrolled wandering */
+            n1 = _mm_loadu_ps((float *) y + i);
+            n1 = _mm_mul_ps(n1, leak);
+            n1 = _mm_add_ps(n1, n0);
+            _mm_storeu_ps((float *) y + i, n1);
+        }
+    }
+    /* Now deal with the last element, which doesn't fill an SSE2 register */
+    switch (n & 1)
+    {
+    case 1:
+        y[n - 1].re = y[n - 1].re*LMS_LEAK_RATE + (x[n - 1].im*error->im + x[n - 1].re*error->re);
+        y[n - 1].im = y[n - 1].im*LMS_LEAK_RATE + (x[n - 1].re*error->im - x[n - 1].im*error->re);
+    }
+}
+#else
 SPAN_DECLARE(void) cvec_lmsf(const complexf_t x[], complexf_t y[], int n, const complexf_t *error)
 {
     int i;
@@ -200,6 +287,7 @@ SPAN_DECLARE(void) cvec_lmsf(const complexf_t x[], complexf_t y[], int n, const
         y[i].im = y[i].im*LMS_LEAK_RATE + (x[i].re*error->im - x[i].im*error->re);
     }
 }
+#endif
 /*- End of function --------------------------------------------------------*/
 
 SPAN_DECLARE(void) cvec_circular_lmsf(const complexf_t x[], complexf_t y[], int n, int pos, const complexf_t *error)
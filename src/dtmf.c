@@ -46,6 +46,7 @@
 #include "spandsp/stdbool.h"
 #endif
 #include "floating_fudge.h"
+#include "mmx_sse_decs.h"
 
 #include "spandsp/telephony.h"
 #include "spandsp/alloc.h"
@@ -101,35 +102,275 @@ static const float dtmf_col[] =
 };
 
 static const char dtmf_positions[] = "123A" "456B" "789C" "*0#D";
-static int dtmf_rx_inited = false;
 
-static goertzel_descriptor_t dtmf_detect_row[4];
-static goertzel_descriptor_t dtmf_detect_col[4];
+/* The Goertzel descriptors are fixed, so they are built at compile time, and shared by every
+   receiver. This avoids racing on a lazily initialised table when receivers are started from
+   several threads. The values are those make_goertzel_descriptor() would produce for the
+   frequencies in dtmf_row[] and dtmf_col[], and dtmf_rx_tests checks they still do:
+        [Floating point] 2.0f*cosf(2.0f*M_PI*(freq/(float) SAMPLE_RATE))
+        [Fixed point] (int16_t) (16383.0f*2.0f*cosf(2.0f*M_PI*(freq/(float) SAMPLE_RATE))) */
+#if defined(SPANDSP_USE_FIXED_POINT)
+static const goertzel_descriptor_t dtmf_detect_row[4] =
+{
+    {27977, DTMF_SAMPLES_PER_BLOCK},
+    {26954, DTMF_SAMPLES_PER_BLOCK},
+    {25699, DTMF_SAMPLES_PER_BLOCK},
+    {24217, DTMF_SAMPLES_PER_BLOCK}
+};
+static const goertzel_descriptor_t dtmf_detect_col[4] =
+{
+    {19071, DTMF_SAMPLES_PER_BLOCK},
+    {16323, DTMF_SAMPLES_PER_BLOCK},
+    {13083, DTMF_SAMPLES_PER_BLOCK},
+    { 9314, DTMF_SAMPLES_PER_BLOCK}
+};
+#else
+static const goertzel_descriptor_t dtmf_detect_row[4] =
+{
+    {1.7077378f, DTMF_SAMPLES_PER_BLOCK},
+    {1.64528108f, DTMF_SAMPLES_PER_BLOCK},
+    {1.56868696f, DTMF_SAMPLES_PER_BLOCK},
+    {1.47820449f, DTMF_SAMPLES_PER_BLOCK}
+};
+static const goertzel_descriptor_t dtmf_detect_col[4] =
+{
+    {1.16410387f, DTMF_SAMPLES_PER_BLOCK},
+    {0.996370196f, DTMF_SAMPLES_PER_BLOCK},
+    {0.798618138f, DTMF_SAMPLES_PER_BLOCK},
+    {0.568532467f, DTMF_SAMPLES_PER_BLOCK}
+};
+#endif
 
 static int dtmf_tx_inited = false;
 static tone_gen_descriptor_t dtmf_digit_tones[16];
 
-SPAN_DECLARE(int) dtmf_rx(dtmf_rx_state_t *s, const int16_t amp[], int samples)
+#if defined(SPANDSP_USE_FIXED_POINT)
+static uint8_t analyse_block(dtmf_rx_state_t *s, goertzel_state_t row_out[4], goertzel_state_t col_out[4], int32_t energy)
+#else
+static uint8_t analyse_block(dtmf_rx_state_t *s, goertzel_state_t row_out[4], goertzel_state_t col_out[4], float energy)
+#endif
 {
 #if defined(SPANDSP_USE_FIXED_POINT)
     int32_t row_energy[4];
     int32_t col_energy[4];
-    int16_t xamp;
-    float famp;
 #else
     float row_energy[4];
     float col_energy[4];
+#endif
+    int i;
+    int best_row;
+    int best_col;
+    uint8_t hit;
+
+    /* We are at the end of a DTMF detection block */
+    /* Find the peak row and the peak column */
+    row_energy[0] = goertzel_result(&row_out[0]);
+    best_row = 0;
+    col_energy[0] = goertzel_result(&col_out[0]);
+    best_col = 0;
+    for (i = 1;  i < 4;  i++)
+    {
+        row_energy[i] = goertzel_result(&row_out[i]);
+        if (row_energy[i] > row_energy[best_row])
+            best_row = i;
+        col_energy[i] = goertzel_result(&col_out[i]);
+        if (col_energy[i] > col_energy[best_col])
+            best_col = i;
+    }
+    hit = 0;
+    /* Basic signal level test and the twist test */
+    if (row_energy[best_row] >= s->threshold
+        &&
+        col_energy[best_col] >= s->threshold)
+    {
+        if (col_energy[best_col] < row_energy[best_row]*s->reverse_twist
+            &&
+            col_energy[best_col]*s->normal_twist > row_energy[best_row])
+        {
+            /* Relative peak test ... */
+            for (i = 0;  i < 4;  i++)
+            {
+                if ((i != best_col  &&  col_energy[i]*DTMF_RELATIVE_PEAK_COL > col_energy[best_col])
+                    ||
+                    (i != best_row  &&  row_energy[i]*DTMF_RELATIVE_PEAK_ROW > row_energy[best_row]))
+                {
+                    break;
+                }
+            }
+            /* ... and fraction of total energy test */
+            if (i >= 4
+                &&
+                (row_energy[best_row] + col_energy[best_col]) > DTMF_TO_TOTAL_ENERGY*energy)
+            {
+                /* Got a hit */
+                hit = dtmf_positions[(best_row << 2) + best_col];
+            }
+        }
+        if (span_log_test(&s->logging, SPAN_LOG_FLOW))
+        {
+            /* Log information about the quality of the signal, to aid analysis of detection problems */
+            /* Logging at this point filters the total no-hoper frames out of the log, and leaves
+               anything which might feasibly be a DTMF digit. The log will then contain a list of the
+               total, row and coloumn power levels for detailed analysis of detection problems. */
+            span_log(&s->logging,
+                     SPAN_LOG_FLOW,
+                     "Potentially '%c' - total %.2fdB, row %.2fdB, col %.2fdB, duration %d - %s\n",
+                     dtmf_positions[(best_row << 2) + best_col],
+                     log10f(energy)*10.0f - DTMF_POWER_OFFSET + DBM0_MAX_POWER,
+                     log10f(row_energy[best_row]/DTMF_TO_TOTAL_ENERGY)*10.0f - DTMF_POWER_OFFSET + DBM0_MAX_POWER,
+                     log10f(col_energy[best_col]/DTMF_TO_TOTAL_ENERGY)*10.0f - DTMF_POWER_OFFSET + DBM0_MAX_POWER,
+                     s->duration,
+                     (hit)  ?  "hit"  :  "miss");
+        }
+    }
+    return hit;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void early_report(dtmf_rx_state_t *s, uint8_t hit, float energy)
+{
+    /* The main and staggered blocks start a quarter of a block apart, so two successive
+       hits for the same digit span only one and a quarter blocks. A digit is reported early when two
+       successive blocks, of either kind, agree on a digit other than the one the main
+       logic is already in. It is withdrawn if two successive blocks then fail to find it,
+       before the main logic confirms it. */
+    if (s->early_digit)
+    {
+        if (hit != s->early_digit  &&  s->early_last_hit != s->early_digit)
+        {
+            s->early_digit = 0;
+            s->early_callback(s->early_callback_data, 0, -99, 0);
+        }
+    }
+    else if (hit  &&  hit == s->early_last_hit  &&  hit != s->in_digit)
+    {
+        s->early_digit = hit;
+        s->early_callback(s->early_callback_data, hit, lfastrintf(log10f(energy)*10.0f - DTMF_POWER_OFFSET + DBM0_MAX_POWER), 0);
+    }
+    s->early_last_hit = hit;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void process_early_block(dtmf_rx_state_t *s, int k)
+{
+    uint8_t hit;
+
+    hit = analyse_block(s, s->early_row_out[k], s->early_col_out[k], s->early_energy[k]);
+    early_report(s, hit, s->early_energy[k]);
+    s->early_energy[k] = FP_SCALE(0.0f);
+    s->early_current_sample[k] = 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void process_block(dtmf_rx_state_t *s)
+{
+    int i;
+    uint8_t hit;
+
+    hit = analyse_block(s, s->row_out, s->col_out, s->energy);
+    /* The logic in the next test should ensure the following for different successive hit patterns:
+            -----ABB = start of digit B.
+            ----B-BB = start of digit B
+            ----A-BB = start of digit B
+            BBBBBABB = still in digit B.
+            BBBBBB-- = end of digit B
+            BBBBBBC- = end of digit B
+            BBBBACBB = B ends, then B starts again.
+            BBBBBBCC = B ends, then C starts.
+            BBBBBCDD = B ends, then D starts.
+       This can work with:
+            - Back to back differing digits. Back-to-back digits should
+              not happen. The spec. says there should be a gap between digits.
+              However, many real phones do not impose a gap, and rolling across
+              the keypad can produce little or no gap.
+            - It tolerates nasty phones that give a very wobbly start to a digit.
+            - VoIP can give sample slips. The phase jumps that produces will cause
+              the block it is in to give no detection. This logic will ride over a
+              single missed block, and not falsely declare a second digit. If the
+              hiccup happens in the wrong place on a minimum length digit, however
+              we would still fail to detect that digit. Could anything be done to
+              deal with that? Packet loss is clearly a no-go zone.
+              Note this is only relevant to VoIP using A-law, u-law or similar.
+              Low bit rate codecs scramble DTMF too much for it to be recognised,
+              and often slip in units larger than a sample. */
+    if (hit != s->in_digit  &&  s->last_hit != s->in_digit)
+    {
+        /* We have two successive indications that something has changed. */
+        /* To declare digit on, the hits must agree. Otherwise we declare tone off. */
+        hit = (hit  &&  hit == s->last_hit)  ?  hit   :  0;
+        if (s->realtime_callback)
+        {
+            /* Avoid reporting multiple no digit conditions on flaky hits */
+            if (s->in_digit  ||  hit)
+            {
+                i = (s->in_digit  &&  !hit)  ?  -99  :  lfastrintf(log10f(s->energy)*10.0f - DTMF_POWER_OFFSET + DBM0_MAX_POWER);
+                s->realtime_callback(s->realtime_callback_data, hit, i, s->duration);
+                s->duration = 0;
+            }
+        }
+        else
+        {
+            if (hit)
+            {
+                if (s->current_digits < MAX_DTMF_DIGITS)
+                {
+                    s->digits[s->current_digits++] = (char) hit;
+                    s->digits[s->current_digits] = '\0';
+                    if (s->digits_callback)
+                    {
+                        s->digits_callback(s->digits_callback_data, s->digits, s->current_digits);
+                        s->current_digits = 0;
+                    }
+                }
+                else
+                {
+                    s->lost_digits++;
+                }
+            }
+        }
+        s->in_digit = hit;
+        if (s->early_digit  &&  hit)
+        {
+            /* The main logic has confirmed a digit, while one reported early was pending.
+               If it confirmed some other digit, the early report is withdrawn. */
+            if (hit != s->early_digit)
+                s->early_callback(s->early_callback_data, 0, -99, 0);
+            s->early_digit = 0;
+        }
+    }
+    s->last_hit = hit;
+    if (s->early_callback)
+        early_report(s, hit, s->energy);
+    s->energy = FP_SCALE(0.0f);
+    s->current_sample = 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void flush_digits(dtmf_rx_state_t *s)
+{
+    if (s->current_digits  &&  s->digits_callback)
+    {
+        s->digits_callback(s->digits_callback_data, s->digits, s->current_digits);
+        s->digits[0] = '\0';
+        s->current_digits = 0;
+    }
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) dtmf_rx(dtmf_rx_state_t *s, const int16_t amp[], int samples)
+{
+#if defined(SPANDSP_USE_FIXED_POINT)
+    int16_t xamp;
+    float famp;
+#else
     float xamp;
     float famp;
 #endif
     float v1;
-    int i;
     int j;
+    int k;
     int sample;
-    int best_row;
-    int best_col;
     int limit;
-    uint8_t hit;
 
     for (sample = 0;  sample < samples;  sample = limit)
     {
@@ -138,6 +379,15 @@ SPAN_DECLARE(int) dtmf_rx(dtmf_rx_state_t *s, const int16_t amp[], int samples)
             limit = sample + (DTMF_SAMPLES_PER_BLOCK - s->current_sample);
         else
             limit = samples;
+        /* With early reporting, the staggered blocks must end at the right point too */
+        if (s->early_callback)
+        {
+            for (k = 0;  k < DTMF_EARLY_BLOCKS;  k++)
+            {
+                if ((limit - sample) > (DTMF_SAMPLES_PER_BLOCK - s->early_current_sample[k]))
+                    limit = sample + (DTMF_SAMPLES_PER_BLOCK - s->early_current_sample[k]);
+            }
+        }
         /* The following unrolled loop takes only 35% (rough estimate) of the
            time of a rolled loop on the machine on which it was developed */
         for (j = sample;  j < limit;  j++)
@@ -174,146 +424,168 @@ SPAN_DECLARE(int) dtmf_rx(dtmf_rx_state_t *s, const int16_t amp[], int samples)
             goertzel_samplex(&s->col_out[2], xamp);
             goertzel_samplex(&s->row_out[3], xamp);
             goertzel_samplex(&s->col_out[3], xamp);
+            if (s->early_callback)
+            {
+                for (k = 0;  k < DTMF_EARLY_BLOCKS;  k++)
+                {
+#if defined(SPANDSP_USE_FIXED_POINT)
+                    s->early_energy[k] += ((int32_t) xamp*xamp);
+#else
+                    s->early_energy[k] += xamp*xamp;
+#endif
+                    goertzel_samplex(&s->early_row_out[k][0], xamp);
+                    goertzel_samplex(&s->early_col_out[k][0], xamp);
+                    goertzel_samplex(&s->early_row_out[k][1], xamp);
+                    goertzel_samplex(&s->early_col_out[k][1], xamp);
+                    goertzel_samplex(&s->early_row_out[k][2], xamp);
+                    goertzel_samplex(&s->early_col_out[k][2], xamp);
+                    goertzel_samplex(&s->early_row_out[k][3], xamp);
+                    goertzel_samplex(&s->early_col_out[k][3], xamp);
+                }
+            }
         }
         if (s->duration < INT_MAX - (limit - sample))
             s->duration += (limit - sample);
+        if (s->early_callback)
+        {
+            /* The blocks all end at different points, so at most one of them ends here */
+            for (k = 0;  k < DTMF_EARLY_BLOCKS;  k++)
+            {
+                s->early_current_sample[k] += (limit - sample);
+                if (s->early_current_sample[k] >= DTMF_SAMPLES_PER_BLOCK)
+                    process_early_block(s, k);
+            }
+        }
         s->current_sample += (limit - sample);
         if (s->current_sample < DTMF_SAMPLES_PER_BLOCK)
             continue;
 
-        /* We are at the end of a DTMF detection block */
-        /* Find the peak row and the peak column */
-        row_energy[0] = goertzel_result(&s->row_out[0]);
-        best_row = 0;
-        col_energy[0] = goertzel_result(&s->col_out[0]);
-        best_col = 0;
-        for (i = 1;  i < 4;  i++)
-        {
-            row_energy[i] = goertzel_result(&s->row_out[i]);
-            if (row_energy[i] > row_energy[best_row])
-                best_row = i;
-            col_energy[i] = goertzel_result(&s->col_out[i]);
-            if (col_energy[i] > col_energy[best_col])
-                best_col = i;
-        }
-        hit = 0;
-        /* Basic signal level test and the twist test */
-        if (row_energy[best_row] >= s->threshold
-            &&
-            col_energy[best_col] >= s->threshold)
+        process_block(s);
+    }
+    flush_digits(s);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+#if defined(__GNUC__)  &&  defined(SPANDSP_USE_SSE2)  &&  !defined(SPANDSP_USE_FIXED_POINT)
+/* Run four receivers, which are at the same point in their detection blocks, in the four
+   lanes of the SSE registers. Each lane performs exactly the same arithmetic, in the same
+   order, as dtmf_rx(), so the results are identical to processing the lines one at a time. */
+static void rx_lanes(dtmf_rx_state_t *s[4], const int16_t *amp[4], int samples)
+{
+    __m128 fac[8];
+    __m128 v2[8];
+    __m128 v3[8];
+    __m128 v1;
+    __m128 xamp;
+    __m128 energy;
+    float buf[2][8][4];
+    float ebuf[4];
+    goertzel_state_t *g;
+    int i;
+    int k;
+    int j;
+    int sample;
+    int limit;
+
+    for (k = 0;  k < 4;  k++)
+        fac[k] = _mm_set1_ps(dtmf_detect_row[k].fac);
+    for (k = 0;  k < 4;  k++)
+        fac[k + 4] = _mm_set1_ps(dtmf_detect_col[k].fac);
+    for (sample = 0;  sample < samples;  sample = limit)
+    {
+        if ((samples - sample) >= (DTMF_SAMPLES_PER_BLOCK - s[0]->current_sample))
+            limit = sample + (DTMF_SAMPLES_PER_BLOCK - s[0]->current_sample);
+        else
+            limit = samples;
+        for (k = 0;  k < 8;  k++)
         {
-            if (col_energy[best_col] < row_energy[best_row]*s->reverse_twist
-                &&
-                col_energy[best_col]*s->normal_twist > row_energy[best_row])
+            for (i = 0;  i < 4;  i++)
             {
-                /* Relative peak test ... */
-                for (i = 0;  i < 4;  i++)
-                {
-                    if ((i != best_col  &&  col_energy[i]*DTMF_RELATIVE_PEAK_COL > col_energy[best_col])
-                        ||
-                        (i != best_row  &&  row_energy[i]*DTMF_RELATIVE_PEAK_ROW > row_energy[best_row]))
-                    {
-                        break;
-                    }
-                }
-                /* ... and fraction of total energy test */
-                if (i >= 4
-                    &&
-                    (row_energy[best_row] + col_energy[best_col]) > DTMF_TO_TOTAL_ENERGY*s->energy)
-                {
-                    /* Got a hit */
-                    hit = dtmf_positions[(best_row << 2) + best_col];
-                }
-            }
-            if (span_log_test(&s->logging, SPAN_LOG_FLOW))
-            {
-                /* Log information about the quality of the signal, to aid analysis of detection problems */
-                /* Logging at this point filters the total no-hoper frames out of the log, and leaves
-                   anything which might feasibly be a DTMF digit. The log will then contain a list of the
-                   total, row and coloumn power levels for detailed analysis of detection problems. */
-                span_log(&s->logging,
-                         SPAN_LOG_FLOW,
-                         "Potentially '%c' - total %.2fdB, row %.2fdB, col %.2fdB, duration %d - %s\n",
-                         dtmf_positions[(best_row << 2) + best_col],
-                         log10f(s->energy)*10.0f - DTMF_POWER_OFFSET + DBM0_MAX_POWER,
-                         log10f(row_energy[best_row]/DTMF_TO_TOTAL_ENERGY)*10.0f - DTMF_POWER_OFFSET + DBM0_MAX_POWER,
-                         log10f(col_energy[best_col]/DTMF_TO_TOTAL_ENERGY)*10.0f - DTMF_POWER_OFFSET + DBM0_MAX_POWER,
-                         s->duration,
-                         (hit)  ?  "hit"  :  "miss");
+                g = (k < 4)  ?  &s[i]->row_out[k]  :  &s[i]->col_out[k - 4];
+                buf[0][k][i] = g->v2;
+                buf[1][k][i] = g->v3;
             }
+            v2[k] = _mm_loadu_ps(buf[0][k]);
+            v3[k] = _mm_loadu_ps(buf[1][k]);
         }
-        /* The logic in the next test should ensure the following for different successive hit patterns:
-                -----ABB = start of digit B.
-                ----B-BB = start of digit B
-                ----A-BB = start of digit B
-                BBBBBABB = still in digit B.
-                BBBBBB-- = end of digit B
-                BBBBBBC- = end of digit B
-                BBBBACBB = B ends, then B starts again.
-                BBBBBBCC = B ends, then C starts.
-                BBBBBCDD = B ends, then D starts.
-           This can work with:
-                - Back to back differing digits. Back-to-back digits should
-                  not happen. The spec. says there should be a gap between digits.
-                  However, many real phones do not impose a gap, and rolling across
-                  the keypad can produce little or no gap.
-                - It tolerates nasty phones that give a very wobbly start to a digit.
-                - VoIP can give sample slips. The phase jumps that produces will cause
-                  the block it is in to give no detection. This logic will ride over a
-                  single missed block, and not falsely declare a second digit. If the
-                  hiccup happens in the wrong place on a minimum length digit, however
-                  we would still fail to detect that digit. Could anything be done to
-                  deal with that? Packet loss is clearly a no-go zone.
-                  Note this is only relevant to VoIP using A-law, u-law or similar.
-                  Low bit rate codecs scramble DTMF too much for it to be recognised,
-                  and often slip in units larger than a sample. */
-        if (hit != s->in_digit  &&  s->last_hit != s->in_digit)
+        energy = _mm_setr_ps(s[0]->energy, s[1]->energy, s[2]->energy, s[3]->energy);
+        for (j = sample;  j < limit;  j++)
         {
-            /* We have two successive indications that something has changed. */
-            /* To declare digit on, the hits must agree. Otherwise we declare tone off. */
-            hit = (hit  &&  hit == s->last_hit)  ?  hit   :  0;
-            if (s->realtime_callback)
+            xamp = _mm_setr_ps(amp[0][j], amp[1][j], amp[2][j], amp[3][j]);
+            energy = _mm_add_ps(energy, _mm_mul_ps(xamp, xamp));
+            for (k = 0;  k < 8;  k++)
             {
-                /* Avoid reporting multiple no digit conditions on flaky hits */
-                if (s->in_digit  ||  hit)
-                {
-                    i = (s->in_digit  &&  !hit)  ?  -99  :  lfastrintf(log10f(s->energy)*10.0f - DTMF_POWER_OFFSET + DBM0_MAX_POWER);
-                    s->realtime_callback(s->realtime_callback_data, hit, i, s->duration);
-                    s->duration = 0;
-                }
+                v1 = v2[k];
+                v2[k] = v3[k];
+                v3[k] = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(fac[k], v2[k]), v1), xamp);
             }
-            else
+        }
+        for (k = 0;  k < 8;  k++)
+        {
+            _mm_storeu_ps(buf[0][k], v2[k]);
+            _mm_storeu_ps(buf[1][k], v3[k]);
+        }
+        _mm_storeu_ps(ebuf, energy);
+        for (i = 0;  i < 4;  i++)
+        {
+            for (k = 0;  k < 8;  k++)
             {
-                if (hit)
-                {
-                    if (s->current_digits < MAX_DTMF_DIGITS)
-                    {
-                        s->digits[s->current_digits++] = (char) hit;
-                        s->digits[s->current_digits] = '\0';
-                        if (s->digits_callback)
-                        {
-                            s->digits_callback(s->digits_callback_data, s->digits, s->current_digits);
-                            s->current_digits = 0;
-                        }
-                    }
-                    else
-                    {
-                        s->lost_digits++;
-                    }
-                }
+                g = (k < 4)  ?  &s[i]->row_out[k]  :  &s[i]->col_out[k - 4];
+                g->v2 = buf[0][k][i];
+                g->v3 = buf[1][k][i];
             }
-            s->in_digit = hit;
+            s[i]->energy = ebuf[i];
+            if (s[i]->duration < INT_MAX - (limit - sample))
+                s[i]->duration += (limit - sample);
+            s[i]->current_sample += (limit - sample);
+            if (s[i]->current_sample >= DTMF_SAMPLES_PER_BLOCK)
+                process_block(s[i]);
         }
-        s->last_hit = hit;
-        s->energy = FP_SCALE(0.0f);
-        s->current_sample = 0;
     }
-    if (s->current_digits  &&  s->digits_callback)
+}
+/*- End of function --------------------------------------------------------*/
+#endif
+
+SPAN_DECLARE(int) dtmf_rx_bank(dtmf_rx_state_t *s[], const int16_t *amp[], int channels, int samples)
+{
+    int i;
+#if defined(__GNUC__)  &&  defined(SPANDSP_USE_SSE2)  &&  !defined(SPANDSP_USE_FIXED_POINT)
+    dtmf_rx_state_t *lane_s[4];
+    const int16_t *lane_amp[4];
+    int lanes;
+
+    lanes = 0;
+    for (i = 0;  i < channels;  i++)
     {
-        s->digits_callback(s->digits_callback_data, s->digits, s->current_digits);
-        s->digits[0] = '\0';
-        s->current_digits = 0;
+        if (amp[i] == NULL)
+            continue;
+        /* Lines are packed into the SSE lanes when they are at the same point in their
+           detection blocks. Lines which are out of step, or which are filtering dialtone,
+           or reporting digits early, are processed on their own. */
+        if (s[i]->filter_dialtone  ||  s[i]->early_callback  ||  (lanes  &&  s[i]->current_sample != lane_s[0]->current_sample))
+        {
+            dtmf_rx(s[i], amp[i], samples);
+            continue;
+        }
+        lane_s[lanes] = s[i];
+        lane_amp[lanes] = amp[i];
+        if (++lanes < 4)
+            continue;
+        rx_lanes(lane_s, lane_amp, samples);
+        for (lanes = 0;  lanes < 4;  lanes++)
+            flush_digits(lane_s[lanes]);
+        lanes = 0;
+    }
+    for (i = 0;  i < lanes;  i++)
+        dtmf_rx(lane_s[i], lane_amp[i], samples);
+#else
+    for (i = 0;  i < channels;  i++)
+    {
+        if (amp[i])
+            dtmf_rx(s[i], amp[i], samples);
     }
+#endif
     return 0;
 }
 /*- End of function --------------------------------------------------------*/
@@ -321,6 +593,7 @@ SPAN_DECLARE(int) dtmf_rx(dtmf_rx_state_t *s, const int16_t amp[], int samples)
 SPAN_DECLARE(int) dtmf_rx_fillin(dtmf_rx_state_t *s, int samples)
 {
     int i;
+    int k;
 
     /* Restart any Goertzel and energy gathering operation we might be in the middle of. */
     for (i = 0;  i < 4;  i++)
@@ -330,6 +603,16 @@ SPAN_DECLARE(int) dtmf_rx_fillin(dtmf_rx_state_t *s, int samples)
     }
     s->energy = FP_SCALE(0.0f);
     s->current_sample = 0;
+    for (k = 0;  k < DTMF_EARLY_BLOCKS;  k++)
+    {
+        for (i = 0;  i < 4;  i++)
+        {
+            goertzel_reset(&s->early_row_out[k][i]);
+            goertzel_reset(&s->early_col_out[k][i]);
+        }
+        s->early_energy[k] = FP_SCALE(0.0f);
+        s->early_current_sample[k] = (k + 1)*DTMF_SAMPLES_PER_BLOCK/4;
+    }
     /* Don't update the hit detection. Pretend it never happened. */
     /* TODO: Surely we can be cleverer than this. */
     return 0;
@@ -371,6 +654,36 @@ SPAN_DECLARE(void) dtmf_rx_set_realtime_callback(dtmf_rx_state_t *s,
 }
 /*- End of function --------------------------------------------------------*/
 
+SPAN_DECLARE(void) dtmf_rx_set_early_callback(dtmf_rx_state_t *s,
+                                              tone_report_func_t callback,
+                                              void *user_data)
+{
+    int i;
+    int k;
+
+    /* A pending early report must not be left hanging, when early reporting stops, or
+       moves to another callback */
+    if (s->early_digit  &&  s->early_callback)
+        s->early_callback(s->early_callback_data, 0, -99, 0);
+    /* Start the staggered blocks one, two and three quarters of a block out of step with
+       the main ones. The first staggered blocks will be short. */
+    for (k = 0;  k < DTMF_EARLY_BLOCKS;  k++)
+    {
+        for (i = 0;  i < 4;  i++)
+        {
+            goertzel_init(&s->early_row_out[k][i], &dtmf_detect_row[i]);
+            goertzel_init(&s->early_col_out[k][i], &dtmf_detect_col[i]);
+        }
+        s->early_energy[k] = FP_SCALE(0.0f);
+        s->early_current_sample[k] = (s->current_sample + (k + 1)*DTMF_SAMPLES_PER_BLOCK/4)%DTMF_SAMPLES_PER_BLOCK;
+    }
+    s->early_last_hit = 0;
+    s->early_digit = 0;
+    s->early_callback = callback;
+    s->early_callback_data = user_data;
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE(void) dtmf_rx_parms(dtmf_rx_state_t *s,
                                  int filter_dialtone,
                                  int twist,
@@ -431,15 +744,6 @@ SPAN_DECLARE(dtmf_rx_state_t *) dtmf_rx_init(dtmf_rx_state_t *s,
     s->in_digit = 0;
     s->last_hit = 0;
 
-    if (!dtmf_rx_inited)
-    {
-        for (i = 0;  i < 4;  i++)
-        {
-            make_goertzel_descriptor(&dtmf_detect_row[i], dtmf_row[i], DTMF_SAMPLES_PER_BLOCK);
-            make_goertzel_descriptor(&dtmf_detect_col[i], dtmf_col[i], DTMF_SAMPLES_PER_BLOCK);
-        }
-        dtmf_rx_inited = true;
-    }
     for (i = 0;  i < 4;  i++)
     {
         goertzel_init(&s->row_out[i], &dtmf_detect_row[i]);
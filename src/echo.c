@@ -104,6 +104,7 @@
 #include "spandsp/saturated.h"
 #include "spandsp/dc_restore.h"
 #include "spandsp/bit_operations.h"
+#include "spandsp/vector_int.h"
 #include "spandsp/echo.h"
 
 #include "spandsp/private/echo.h"
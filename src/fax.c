@@ -58,6 +58,7 @@
 #include "spandsp/alloc.h"
 #include "spandsp/logging.h"
 #include "spandsp/queue.h"
+#include "spandsp/media_tap.h"
 #include "spandsp/dc_restore.h"
 #include "spandsp/vector_int.h"
 #include "spandsp/power_meter.h"
@@ -320,6 +321,18 @@ static int v29_v21_rx_fillin(void *user_data, int len)
 }
 /*- End of function --------------------------------------------------------*/
 
+static void header_time_from_tap(fax_state_t *s)
+{
+    time_t when;
+
+    /* A tap recording the call holds the time for the page headers, so a replay can
+       send the same headers */
+    if ((when = media_tap_get_header_time(s->modems.tap)) >= 0)
+        t30_set_tx_page_header_time(&s->t30, when);
+    /*endif*/
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE_NONSTD(int) fax_rx(fax_state_t *s, int16_t *amp, int len)
 {
     int i;
@@ -329,10 +342,19 @@ SPAN_DECLARE_NONSTD(int) fax_rx(fax_state_t *s, int16_t *amp, int len)
         write(s->modems.audio_rx_log, amp, len*sizeof(int16_t));
     /*endif*/
 #endif
+    if (s->modems.tap)
+    {
+        media_tap_audio(s->modems.tap, MEDIA_TAP_RX_AUDIO, amp, len);
+        header_time_from_tap(s);
+    }
+    /*endif*/
     for (i = 0;  i < len;  i++)
         amp[i] = dc_restore(&s->modems.dc_restore, amp[i]);
     /*endfor*/
-    s->modems.rx_handler(s->modems.rx_user_data, amp, len);
+    /* While no signal is present, an idle line need only advance the timers */
+    if (!fax_modems_rx_idle(&s->modems, amp, len)  ||  s->t30.rx_signal_present)
+        s->modems.rx_handler(s->modems.rx_user_data, amp, len);
+    /*endif*/
     t30_timer_update(&s->t30, len);
     return 0;
 }
@@ -360,6 +382,12 @@ SPAN_DECLARE_NONSTD(int) fax_rx_fillin(fax_state_t *s, int len)
     }
     /*endif*/
 #endif
+    if (s->modems.tap)
+    {
+        media_tap_audio_fillin(s->modems.tap, MEDIA_TAP_RX_AUDIO, len);
+        header_time_from_tap(s);
+    }
+    /*endif*/
     /* Call the fillin function of the current modem (if there is one). */
     s->modems.rx_fillin_handler(s->modems.rx_user_data, len);
     t30_timer_update(&s->t30, len);
@@ -396,6 +424,12 @@ SPAN_DECLARE_NONSTD(int) fax_tx(fax_state_t *s, int16_t *amp, int max_len)
 
     required_len = max_len;
 #endif
+    if (s->modems.tap)
+    {
+        media_tap_tx_request(s->modems.tap, max_len);
+        header_time_from_tap(s);
+    }
+    /*endif*/
     len = 0;
     if (s->modems.transmit)
     {
@@ -441,6 +475,9 @@ SPAN_DECLARE_NONSTD(int) fax_tx(fax_state_t *s, int16_t *amp, int max_len)
     }
     /*endif*/
 #endif
+    if (s->modems.tap)
+        media_tap_audio(s->modems.tap, MEDIA_TAP_TX_AUDIO, amp, len);
+    /*endif*/
     return len;
 }
 /*- End of function --------------------------------------------------------*/
@@ -620,6 +657,63 @@ SPAN_DECLARE(void) fax_set_tep_mode(fax_state_t *s, int use_tep)
 }
 /*- End of function --------------------------------------------------------*/
 
+SPAN_DECLARE(void) fax_set_rx_idle_cutoff(fax_state_t *s, float cutoff)
+{
+    fax_modems_set_rx_idle_cutoff(&s->modems, cutoff);
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(void) fax_set_tap(fax_state_t *s, media_tap_state_t *tap)
+{
+    /* Go back to the system clock for the page headers, if the old tap was setting them */
+    if (s->modems.tap  &&  media_tap_get_header_time(s->modems.tap) >= 0)
+        t30_set_tx_page_header_time(&s->t30, -1);
+    /*endif*/
+    s->modems.tap = tap;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) fax_checkpoint(fax_state_t *s, uint8_t buf[], int max_len)
+{
+    int len;
+
+    /* The checkpoint is the V.17 receiver's saved training, which the next page may be
+       received with, followed by the T.30 engine's checkpoint. Nothing else in the modems
+       needs to be moved, at the points where the T.30 engine permits a checkpoint. */
+    if (max_len < 4 + V17_RX_TRAINING_STATE_LEN)
+        return -1;
+    /*endif*/
+    memcpy(buf, "FAXC", 4);
+    v17_rx_get_training_state(&s->modems.fast_modems.v17_rx, &buf[4], V17_RX_TRAINING_STATE_LEN);
+    if ((len = t30_checkpoint(&s->t30, &buf[4 + V17_RX_TRAINING_STATE_LEN], max_len - 4 - V17_RX_TRAINING_STATE_LEN)) < 0)
+        return -1;
+    /*endif*/
+    return 4 + V17_RX_TRAINING_STATE_LEN + len;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) fax_restore(fax_state_t *s, const uint8_t buf[], int len)
+{
+    uint8_t training[V17_RX_TRAINING_STATE_LEN];
+
+    if (len < 4 + V17_RX_TRAINING_STATE_LEN  ||  memcmp(buf, "FAXC", 4) != 0)
+        return -1;
+    /*endif*/
+    /* The training must be in place before the T.30 engine restarts the modems. If the
+       T.30 engine rejects the checkpoint, the original training is put back, so a failed
+       restore leaves the context as it was. */
+    v17_rx_get_training_state(&s->modems.fast_modems.v17_rx, training, V17_RX_TRAINING_STATE_LEN);
+    v17_rx_set_training_state(&s->modems.fast_modems.v17_rx, &buf[4], V17_RX_TRAINING_STATE_LEN);
+    if (t30_restore(&s->t30, &buf[4 + V17_RX_TRAINING_STATE_LEN], len - 4 - V17_RX_TRAINING_STATE_LEN))
+    {
+        v17_rx_set_training_state(&s->modems.fast_modems.v17_rx, training, V17_RX_TRAINING_STATE_LEN);
+        return -1;
+    }
+    /*endif*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE(t30_state_t *) fax_get_t30_state(fax_state_t *s)
 {
     return &s->t30;
@@ -58,6 +58,8 @@
 #include "spandsp/bit_operations.h"
 #include "spandsp/dc_restore.h"
 #include "spandsp/queue.h"
+#include "spandsp/media_tap.h"
+#include "spandsp/vector_int.h"
 #include "spandsp/power_meter.h"
 #include "spandsp/complex.h"
 #include "spandsp/tone_detect.h"
@@ -92,6 +94,9 @@
 #include "spandsp/private/fax_modems.h"
 
 #define HDLC_FRAMING_OK_THRESHOLD               5
+/* The amount of idle line the receivers must process before the rest can be skipped.
+   This gives them time to see any carrier fall, and their power meters time to settle. */
+#define RX_IDLE_HANGOVER                        ms_to_samples(100)
 
 SPAN_DECLARE(const char *) fax_modem_to_str(int modem)
 {
@@ -325,6 +330,31 @@ SPAN_DECLARE(void) fax_modems_set_tep_mode(fax_modems_state_t *s, int use_tep)
 }
 /*- End of function --------------------------------------------------------*/
 
+SPAN_DECLARE(void) fax_modems_set_rx_idle_cutoff(fax_modems_state_t *s, float cutoff)
+{
+    /* A block whose peak is below this has a power below the cutoff, whatever its shape */
+    s->rx_idle_peak = (int32_t) (32767.0f*powf(10.0f, (cutoff - DBM0_MAX_POWER)/20.0f));
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) fax_modems_rx_idle(fax_modems_state_t *s, const int16_t amp[], int len)
+{
+    if (vec_min_maxi16(amp, len, NULL) > s->rx_idle_peak)
+    {
+        s->rx_idle_samples = 0;
+        return false;
+    }
+    /*endif*/
+    if (s->rx_idle_samples < RX_IDLE_HANGOVER)
+    {
+        s->rx_idle_samples += len;
+        return false;
+    }
+    /*endif*/
+    return true;
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE(logging_state_t *) fax_modems_get_logging_state(fax_modems_state_t *s)
 {
     return &s->logging;
@@ -334,6 +364,7 @@ SPAN_DECLARE(logging_state_t *) fax_modems_get_logging_state(fax_modems_state_t
 SPAN_DECLARE(int) fax_modems_restart(fax_modems_state_t *s)
 {
     s->current_tx_type = -1;
+    s->rx_idle_samples = 0;
     return 0;
 }
 /*- End of function --------------------------------------------------------*/
@@ -370,6 +401,7 @@ SPAN_DECLARE(fax_modems_state_t *) fax_modems_init(fax_modems_state_t *s,
     span_log_set_protocol(&s->logging, "FAX modems");
 
     dc_restore_init(&s->dc_restore);
+    fax_modems_set_rx_idle_cutoff(s, -50.0f);
 
     hdlc_rx_init(&s->hdlc_rx, false, false, HDLC_FRAMING_OK_THRESHOLD, hdlc_accept, user_data);
     hdlc_tx_init(&s->hdlc_tx, false, 2, false, hdlc_tx_underflow, user_data);
@@ -374,8 +374,29 @@ static void report_status_change(fsk_rx_state_t *s, int status)
 }
 /*- End of function --------------------------------------------------------*/
 
-SPAN_DECLARE_NONSTD(int) fsk_rx(fsk_rx_state_t *s, const int16_t *amp, int len)
+static __inline__ void rx_put_status(fsk_rx_state_t *s, int bits[], int *nbits, int status)
+{
+    if (bits)
+        bits[(*nbits)++] = status;
+    else
+        report_status_change(s, status);
+    /*endif*/
+}
+/*- End of function --------------------------------------------------------*/
+
+static __inline__ void rx_put_bit(fsk_rx_state_t *s, int bits[], int *nbits, int bit)
 {
+    if (bits)
+        bits[(*nbits)++] = bit;
+    else
+        s->put_bit(s->put_bit_user_data, bit);
+    /*endif*/
+}
+/*- End of function --------------------------------------------------------*/
+
+static __inline__ int rx_core(fsk_rx_state_t *s, const int16_t *amp, const complexi_t lo[][2], int len, int bits[])
+{
+    int nbits;
     int buf_ptr;
     int baudstate;
     int i;
@@ -386,6 +407,7 @@ SPAN_DECLARE_NONSTD(int) fsk_rx(fsk_rx_state_t *s, const int16_t *amp, int len)
     int32_t power;
     complexi_t ph;
 
+    nbits = 0;
     buf_ptr = s->buf_ptr;
 
     for (i = 0;  i < len;  i++)
@@ -398,7 +420,7 @@ SPAN_DECLARE_NONSTD(int) fsk_rx(fsk_rx_state_t *s, const int16_t *amp, int len)
             s->dot[j].re -= s->window[j][buf_ptr].re;
             s->dot[j].im -= s->window[j][buf_ptr].im;
 
-            ph = dds_complexi(&s->phase_acc[j], s->phase_rate[j]);
+            ph = (lo)  ?  lo[i][j]  :  dds_complexi(&s->phase_acc[j], s->phase_rate[j]);
             s->window[j][buf_ptr].re = (ph.re*amp[i]) >> s->scaling_shift;
             s->window[j][buf_ptr].im = (ph.im*amp[i]) >> s->scaling_shift;
 
@@ -428,7 +450,7 @@ SPAN_DECLARE_NONSTD(int) fsk_rx(fsk_rx_state_t *s, const int16_t *amp, int len)
                 {
                     /* Count down a short delay, to ensure we push the last
                        few bits through the filters before stopping. */
-                    report_status_change(s, SIG_STATUS_CARRIER_DOWN);
+                    rx_put_status(s, bits, &nbits, SIG_STATUS_CARRIER_DOWN);
                     s->baud_phase = 0;
                     continue;
                 }
@@ -457,7 +479,7 @@ SPAN_DECLARE_NONSTD(int) fsk_rx(fsk_rx_state_t *s, const int16_t *amp, int len)
             s->frame_state = 0;
             s->frame_bits = 0;
             s->last_bit = 0;
-            report_status_change(s, SIG_STATUS_CARRIER_UP);
+            rx_put_status(s, bits, &nbits, SIG_STATUS_CARRIER_UP);
         }
         /*endif*/
         /* Non-coherent FSK demodulation by correlation with the target tones
@@ -488,7 +510,7 @@ SPAN_DECLARE_NONSTD(int) fsk_rx(fsk_rx_state_t *s, const int16_t *amp, int len)
                 /* We should be in the middle of a baud now, so report the current
                    state as the next bit */
                 s->baud_phase -= (SAMPLE_RATE*100);
-                s->put_bit(s->put_bit_user_data, baudstate);
+                rx_put_bit(s, bits, &nbits, baudstate);
             }
             /*endif*/
             break;
@@ -512,7 +534,7 @@ SPAN_DECLARE_NONSTD(int) fsk_rx(fsk_rx_state_t *s, const int16_t *amp, int len)
                 /* We should be in the middle of a baud now, so report the current
                    state as the next bit */
                 s->baud_phase -= (SAMPLE_RATE*100);
-                s->put_bit(s->put_bit_user_data, baudstate);
+                rx_put_bit(s, bits, &nbits, baudstate);
             }
             /*endif*/
             break;
@@ -581,7 +603,7 @@ SPAN_DECLARE_NONSTD(int) fsk_rx(fsk_rx_state_t *s, const int16_t *amp, int len)
                                 if (baudstate == 1  &&  (s->frame_bits & 0x02) == 0)
                                 {
                                     /* Drop the start bit, and pass the rest back */
-                                    s->put_bit(s->put_bit_user_data, s->frame_bits >> 2);
+                                    rx_put_bit(s, bits, &nbits, s->frame_bits >> 2);
                                 }
                                 /*endif*/
                                 s->frame_state = 0;
@@ -615,10 +637,36 @@ SPAN_DECLARE_NONSTD(int) fsk_rx(fsk_rx_state_t *s, const int16_t *amp, int len)
     }
     /*endfor*/
     s->buf_ptr = buf_ptr;
+    return nbits;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE_NONSTD(int) fsk_rx(fsk_rx_state_t *s, const int16_t *amp, int len)
+{
+    rx_core(s, amp, NULL, len, NULL);
     return 0;
 }
 /*- End of function --------------------------------------------------------*/
 
+SPAN_DECLARE(int) fsk_rx_block(fsk_rx_state_t *s, const int16_t amp[], const complexi_t lo[][2], int len, int bits[])
+{
+    return rx_core(s, amp, lo, len, bits);
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(void) fsk_rx_shared_lo(fsk_rx_state_t *s, uint32_t phase_acc[2], complexi_t lo[][2], int len)
+{
+    int i;
+
+    for (i = 0;  i < len;  i++)
+    {
+        lo[i][0] = dds_complexi(&phase_acc[0], s->phase_rate[0]);
+        lo[i][1] = dds_complexi(&phase_acc[1], s->phase_rate[1]);
+    }
+    /*endfor*/
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE_NONSTD(int) fsk_rx_fillin(fsk_rx_state_t *s, int len)
 {
     int buf_ptr;
@@ -52,6 +52,10 @@
 
 #include "spandsp/private/logging.h"
 
+/* This is where the real functions live, behind the inline level tests */
+#undef span_log
+#undef span_log_buf
+
 static void default_message_handler(int level, const char *text);
 
 static message_handler_func_t __span_message = &default_message_handler;
@@ -81,9 +85,7 @@ static void default_message_handler(int level, const char *text)
 
 SPAN_DECLARE(int) span_log_test(logging_state_t *s, int level)
 {
-    if (s  &&  (s->level & SPAN_LOG_SEVERITY_MASK) >= (level & SPAN_LOG_SEVERITY_MASK))
-        return true;
-    return false;
+    return span_log_enabled(s, level);
 }
 /*- End of function --------------------------------------------------------*/
 
@@ -0,0 +1,183 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * make_fir_kernels.c - Generate fully unrolled FIR dot product kernels, for
+ *                      filters of fixed length.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2013 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/* The modem receivers apply their pulse shaping filters, whose lengths are fixed
+   when the library is built, to a history buffer which holds each sample twice. Any
+   window of the history is then contiguous, so the filter is a plain dot product of
+   a known length. For each length given on the command line, this program generates
+   a floating point and a 16 bit integer kernel for that dot product. They are fully
+   unrolled, with no loop overhead or tail handling at run time, and are written
+   against simd.h, so they use whatever SIMD instructions the build selects. A filter
+   of any length can be handled, without padding the coefficients. The kernel for a length is selected with the FIR_KERNEL_DOT_PRODF()
+   and FIR_KERNEL_DOT_PRODI16() macros, e.g.
+
+       v = FIR_KERNEL_DOT_PRODF(V17_RX_FILTER_STEPS)(&s->rrc_filter[s->rrc_filter_step], coeffs);
+ */
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#define MAX_TAPS    1024
+
+static void make_float_kernel(int taps, int lanes)
+{
+    int blocks;
+    int i;
+
+    blocks = taps/lanes;
+    printf("static __inline__ float fir_kernel_dot_prodf_%d(const float x[], const float y[])\n", taps);
+    printf("{\n");
+    printf("    float z;\n");
+    if (blocks > 0)
+    {
+        printf("    simd_f32_t n0;\n");
+        if (blocks > 1)
+            printf("    simd_f32_t n1;\n");
+        printf("\n");
+        /* Two accumulators, so the multiplies and adds of alternate blocks can overlap */
+        for (i = 0;  i < blocks;  i++)
+        {
+            if (i < 2)
+                printf("    n%d = simd_mul_f32(simd_loadu_f32(x + %d), simd_loadu_f32(y + %d));\n", i, lanes*i, lanes*i);
+            else
+                printf("    n%d = simd_add_f32(n%d, simd_mul_f32(simd_loadu_f32(x + %d), simd_loadu_f32(y + %d)));\n", i & 1, i & 1, lanes*i, lanes*i);
+        }
+        if (blocks > 1)
+            printf("    n0 = simd_add_f32(n0, n1);\n");
+        printf("    z = simd_hsum_f32(n0);\n");
+    }
+    else
+    {
+        printf("\n");
+        printf("    z = 0.0f;\n");
+    }
+    for (i = lanes*blocks;  i < taps;  i++)
+        printf("    z += x[%d]*y[%d];\n", i, i);
+    printf("    return z;\n");
+    printf("}\n");
+    printf("/*- End of function --------------------------------------------------------*/\n\n");
+}
+/*- End of function --------------------------------------------------------*/
+
+static void make_int16_kernel(int taps, int lanes)
+{
+    int blocks;
+    int i;
+
+    blocks = taps/lanes;
+    printf("static __inline__ int32_t fir_kernel_dot_prodi16_%d(const int16_t x[], const int16_t y[])\n", taps);
+    printf("{\n");
+    printf("    int32_t z;\n");
+    if (blocks > 0)
+    {
+        printf("    simd_i32_t n0;\n");
+        printf("\n");
+        printf("    n0 = simd_zero_i32();\n");
+        for (i = 0;  i < blocks;  i++)
+            printf("    n0 = simd_madd_i16(n0, simd_loadu_i16(x + %d), simd_loadu_i16(y + %d));\n", lanes*i, lanes*i);
+        printf("    z = simd_hsum_i32(n0);\n");
+    }
+    else
+    {
+        printf("\n");
+        printf("    z = 0;\n");
+    }
+    for (i = lanes*blocks;  i < taps;  i++)
+        printf("    z += (int32_t) x[%d]*y[%d];\n", i, i);
+    printf("    return z;\n");
+    printf("}\n");
+    printf("/*- End of function --------------------------------------------------------*/\n\n");
+}
+/*- End of function --------------------------------------------------------*/
+
+static void usage(void)
+{
+    fprintf(stderr, "Usage: make_fir_kernels <taps> [<taps> ...]\n");
+}
+/*- End of function --------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    int taps[MAX_TAPS + 1];
+    int done[MAX_TAPS + 1];
+    int lengths;
+    int i;
+
+    if (argc < 2)
+    {
+        usage();
+        exit(2);
+    }
+    memset(done, 0, sizeof(done));
+    lengths = 0;
+    for (i = 1;  i < argc;  i++)
+    {
+        taps[lengths] = atoi(argv[i]);
+        if (taps[lengths] < 1  ||  taps[lengths] > MAX_TAPS)
+        {
+            usage();
+            exit(2);
+        }
+        /* Ignore repeats, so the callers can simply list the lengths they use */
+        if (!done[taps[lengths]])
+        {
+            done[taps[lengths]] = 1;
+            lengths++;
+        }
+    }
+
+    printf("/* This file was generated by make_fir_kernels. Do not edit it. */\n\n");
+    printf("#define FIR_KERNEL_PASTE(name, taps) FIR_KERNEL_PASTE2(name, taps)\n");
+    printf("#define FIR_KERNEL_PASTE2(name, taps) name##taps\n");
+    printf("#define FIR_KERNEL_DOT_PRODF(taps) FIR_KERNEL_PASTE(fir_kernel_dot_prodf_, taps)\n");
+    printf("#define FIR_KERNEL_DOT_PRODI16(taps) FIR_KERNEL_PASTE(fir_kernel_dot_prodi16_, taps)\n\n");
+
+    /* The register width is only known when the kernels are compiled, so each kernel is
+       generated for each width simd.h might select. */
+    printf("#include \"simd.h\"\n\n");
+    printf("#if SIMD_F32_LANES == 8\n\n");
+    for (i = 0;  i < lengths;  i++)
+    {
+        make_float_kernel(taps[i], 8);
+        make_int16_kernel(taps[i], 16);
+    }
+    printf("#else\n\n");
+    for (i = 0;  i < lengths;  i++)
+    {
+        make_float_kernel(taps[i], 4);
+        make_int16_kernel(taps[i], 8);
+    }
+    printf("#endif\n");
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+/*- End of file ------------------------------------------------------------*/
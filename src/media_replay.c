@@ -0,0 +1,441 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * media_replay.c - Replay a call recorded by a media tap, through a fresh context.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2013 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 2.1,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \file */
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <string.h>
+#if defined(HAVE_STDBOOL_H)
+#include <stdbool.h>
+#else
+#include "spandsp/stdbool.h"
+#endif
+#include <tiffio.h>
+
+#include "spandsp/telephony.h"
+#include "spandsp/alloc.h"
+#include "spandsp/logging.h"
+#include "spandsp/media_tap.h"
+#include "spandsp/timezone.h"
+#include "spandsp/t4_rx.h"
+#include "spandsp/t4_tx.h"
+#include "spandsp/t30.h"
+#include "spandsp/fax.h"
+#include "spandsp/t38_core.h"
+#include "spandsp/t38_terminal.h"
+#include "spandsp/at_interpreter.h"
+#include "spandsp/t31.h"
+#include "spandsp/t38_non_ecm_buffer.h"
+#include "spandsp/t38_gateway.h"
+#include "spandsp/media_replay.h"
+
+#include "spandsp/private/logging.h"
+#include "spandsp/private/media_replay.h"
+
+/* The replayer's tap must hold all the output from one input record - up to
+   MEDIA_REPLAY_MAX_BLOCK samples of audio, and a few IFP packets. */
+#define REPLAY_TAP_BUFFER_LEN   65536
+
+static void set_tap(media_replay_state_t *s, media_tap_state_t *tap)
+{
+    switch (s->type)
+    {
+    case MEDIA_REPLAY_FAX:
+        fax_set_tap((fax_state_t *) s->context, tap);
+        break;
+    case MEDIA_REPLAY_T38_TERMINAL:
+        t38_terminal_set_tap((t38_terminal_state_t *) s->context, tap);
+        break;
+    case MEDIA_REPLAY_T31:
+        t31_set_tap((t31_state_t *) s->context, tap);
+        break;
+    case MEDIA_REPLAY_T38_GATEWAY:
+        t38_gateway_set_tap((t38_gateway_state_t *) s->context, tap);
+        break;
+    }
+    /*endswitch*/
+}
+/*- End of function --------------------------------------------------------*/
+
+static int mismatch(media_replay_state_t *s, const media_tap_record_t *rec, const char *why)
+{
+    span_log(&s->logging, SPAN_LOG_WARNING, "Record %u (type %d, time %u): %s\n", rec->seq_no, rec->type, rec->sample_time, why);
+    s->mismatches++;
+    return -1;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int check_no_output(media_replay_state_t *s, const media_tap_record_t *rec)
+{
+    media_tap_record_t out;
+    int ret;
+
+    /* Output from the previous input which the recording does not have */
+    ret = 0;
+    while (media_tap_read(s->tap, &out, s->out_buf, sizeof(s->out_buf)) >= 0)
+        ret = mismatch(s, rec, "replay sent more than the recording");
+    /*endwhile*/
+    return ret;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int check_output(media_replay_state_t *s, const media_tap_record_t *rec, const uint8_t buf[], int len)
+{
+    media_tap_record_t out;
+    int out_len;
+
+    if ((out_len = media_tap_read(s->tap, &out, s->out_buf, sizeof(s->out_buf))) < 0)
+        return mismatch(s, rec, "replay did not send this");
+    /*endif*/
+    if (out.type != rec->type
+        ||
+        out.sample_time != rec->sample_time
+        ||
+        out.continues != rec->continues
+        ||
+        (rec->type == MEDIA_TAP_TX_IFP  &&  out.t38_seq_no != rec->t38_seq_no))
+    {
+        return mismatch(s, rec, "replay sent something different at this point");
+    }
+    /*endif*/
+    if (out_len != len  ||  memcmp(s->out_buf, buf, len))
+        return mismatch(s, rec, "replay sent different content");
+    /*endif*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int get_int_payload(const uint8_t buf[], int len)
+{
+    int32_t value;
+
+    if (len != sizeof(value))
+        return -1;
+    /*endif*/
+    memcpy(&value, buf, sizeof(value));
+    return value;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int replay_rx_audio(media_replay_state_t *s, const media_tap_record_t *rec, const uint8_t buf[], int len)
+{
+    int samples;
+
+    samples = len/sizeof(int16_t);
+    if (s->rx_len + samples > MEDIA_REPLAY_MAX_BLOCK)
+    {
+        s->rx_len = 0;
+        return mismatch(s, rec, "received block too long to replay");
+    }
+    /*endif*/
+    memcpy(&s->rx_amp[s->rx_len], buf, samples*sizeof(int16_t));
+    s->rx_len += samples;
+    /* A long block was split over several records, but must be received in one go,
+       or the replay may not follow the same path */
+    if (rec->continues)
+        return 0;
+    /*endif*/
+    samples = s->rx_len;
+    s->rx_len = 0;
+    switch (s->type)
+    {
+    case MEDIA_REPLAY_FAX:
+        fax_rx((fax_state_t *) s->context, s->rx_amp, samples);
+        break;
+    case MEDIA_REPLAY_T31:
+        t31_rx((t31_state_t *) s->context, s->rx_amp, samples);
+        break;
+    case MEDIA_REPLAY_T38_GATEWAY:
+        t38_gateway_rx((t38_gateway_state_t *) s->context, s->rx_amp, samples);
+        break;
+    default:
+        return mismatch(s, rec, "audio for a context with no audio");
+    }
+    /*endswitch*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int replay_rx_fillin(media_replay_state_t *s, const media_tap_record_t *rec, int samples)
+{
+    if (samples < 0)
+        return mismatch(s, rec, "bad fill-in");
+    /*endif*/
+    switch (s->type)
+    {
+    case MEDIA_REPLAY_FAX:
+        fax_rx_fillin((fax_state_t *) s->context, samples);
+        break;
+    case MEDIA_REPLAY_T31:
+        t31_rx_fillin((t31_state_t *) s->context, samples);
+        break;
+    case MEDIA_REPLAY_T38_GATEWAY:
+        t38_gateway_rx_fillin((t38_gateway_state_t *) s->context, samples);
+        break;
+    default:
+        return mismatch(s, rec, "fill-in for a context with no audio");
+    }
+    /*endswitch*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int replay_tx_request(media_replay_state_t *s, const media_tap_record_t *rec, int samples)
+{
+    if (samples < 0  ||  samples > MEDIA_REPLAY_MAX_BLOCK)
+        return mismatch(s, rec, "bad transmit request");
+    /*endif*/
+    switch (s->type)
+    {
+    case MEDIA_REPLAY_FAX:
+        fax_tx((fax_state_t *) s->context, s->tx_amp, samples);
+        break;
+    case MEDIA_REPLAY_T31:
+        t31_tx((t31_state_t *) s->context, s->tx_amp, samples);
+        break;
+    case MEDIA_REPLAY_T38_GATEWAY:
+        t38_gateway_tx((t38_gateway_state_t *) s->context, s->tx_amp, samples);
+        break;
+    default:
+        return mismatch(s, rec, "transmit request for a context with no audio");
+    }
+    /*endswitch*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int replay_rx_ifp(media_replay_state_t *s, const media_tap_record_t *rec, const uint8_t buf[], int len)
+{
+    t38_core_state_t *t38;
+
+    switch (s->type)
+    {
+    case MEDIA_REPLAY_T38_TERMINAL:
+        t38 = t38_terminal_get_t38_core_state((t38_terminal_state_t *) s->context);
+        break;
+    case MEDIA_REPLAY_T31:
+        t38 = t31_get_t38_core_state((t31_state_t *) s->context);
+        break;
+    case MEDIA_REPLAY_T38_GATEWAY:
+        t38 = t38_gateway_get_t38_core_state((t38_gateway_state_t *) s->context);
+        break;
+    default:
+        return mismatch(s, rec, "IFP packet for a context with no T.38");
+    }
+    /*endswitch*/
+    t38_core_rx_ifp_packet(t38, buf, len, (uint16_t) rec->t38_seq_no);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int replay_timer(media_replay_state_t *s, const media_tap_record_t *rec, int samples)
+{
+    if (samples < 0)
+        return mismatch(s, rec, "bad timer tick");
+    /*endif*/
+    switch (s->type)
+    {
+    case MEDIA_REPLAY_T38_TERMINAL:
+        t38_terminal_send_timeout((t38_terminal_state_t *) s->context, samples);
+        break;
+    case MEDIA_REPLAY_T31:
+        t31_t38_send_timeout((t31_state_t *) s->context, samples);
+        break;
+    default:
+        return mismatch(s, rec, "timer tick for a context with no T.38 timer");
+    }
+    /*endswitch*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int replay_header_time(media_replay_state_t *s, const media_tap_record_t *rec, const uint8_t buf[], int len)
+{
+    int64_t when;
+
+    if (len != sizeof(when))
+        return mismatch(s, rec, "bad header time");
+    /*endif*/
+    memcpy(&when, buf, sizeof(when));
+    /* The replayed context takes the time for its page headers from our tap, at its
+       next input */
+    media_tap_set_header_time(s->tap, (time_t) when);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) media_replay_record(media_replay_state_t *s, const media_tap_record_t *rec, const uint8_t buf[], int len)
+{
+    if (s->started  &&  rec->seq_no != s->next_seq_no)
+    {
+        span_log(&s->logging, SPAN_LOG_WARNING, "Records %u to %u are missing\n", s->next_seq_no, rec->seq_no - 1);
+        s->missing += rec->seq_no - s->next_seq_no;
+    }
+    /*endif*/
+    s->started = true;
+    s->next_seq_no = rec->seq_no + 1;
+
+    switch (rec->type)
+    {
+    case MEDIA_TAP_TX_AUDIO:
+    case MEDIA_TAP_TX_IFP:
+        return check_output(s, rec, buf, len);
+    case MEDIA_TAP_NOTE:
+        if (s->note_handler  &&  s->note_handler(s->note_user_data, buf, len) < 0)
+            return mismatch(s, rec, "note not accepted");
+        /*endif*/
+        return 0;
+    case MEDIA_TAP_HEADER_TIME:
+        return replay_header_time(s, rec, buf, len);
+    }
+    /*endswitch*/
+
+    /* Everything the replay sent after the last input should have been matched by now */
+    if (check_no_output(s, rec))
+        return -1;
+    /*endif*/
+    if (s->rx_len  &&  rec->type != MEDIA_TAP_RX_AUDIO)
+    {
+        s->rx_len = 0;
+        return mismatch(s, rec, "the end of a received block is missing");
+    }
+    /*endif*/
+    switch (rec->type)
+    {
+    case MEDIA_TAP_RX_AUDIO:
+        return replay_rx_audio(s, rec, buf, len);
+    case MEDIA_TAP_RX_FILLIN:
+        return replay_rx_fillin(s, rec, get_int_payload(buf, len));
+    case MEDIA_TAP_TX_REQUEST:
+        return replay_tx_request(s, rec, get_int_payload(buf, len));
+    case MEDIA_TAP_RX_IFP:
+        return replay_rx_ifp(s, rec, buf, len);
+    case MEDIA_TAP_TIMER:
+        return replay_timer(s, rec, get_int_payload(buf, len));
+    case MEDIA_TAP_RX_AT:
+        if (s->type != MEDIA_REPLAY_T31)
+            return mismatch(s, rec, "AT commands for a context which is not T.31");
+        /*endif*/
+        t31_at_rx((t31_state_t *) s->context, (const char *) buf, len);
+        return 0;
+    }
+    /*endswitch*/
+    return mismatch(s, rec, "unknown record type");
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(void) media_replay_set_note_handler(media_replay_state_t *s, media_replay_note_handler_t *handler, void *user_data)
+{
+    s->note_handler = handler;
+    s->note_user_data = user_data;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) media_replay_get_mismatches(media_replay_state_t *s)
+{
+    return s->mismatches;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) media_replay_get_missing(media_replay_state_t *s)
+{
+    return s->missing;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(logging_state_t *) media_replay_get_logging_state(media_replay_state_t *s)
+{
+    return &s->logging;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(media_replay_state_t *) media_replay_init(media_replay_state_t *s, int type, void *context)
+{
+    media_replay_state_t *t;
+
+    if (context == NULL  ||  type < MEDIA_REPLAY_FAX  ||  type > MEDIA_REPLAY_T38_GATEWAY)
+        return NULL;
+    /*endif*/
+    t = s;
+    if (t == NULL)
+    {
+        if ((t = (media_replay_state_t *) span_alloc(sizeof(*t))) == NULL)
+            return NULL;
+        /*endif*/
+    }
+    /*endif*/
+    memset(t, 0, sizeof(*t));
+    span_log_init(&t->logging, SPAN_LOG_NONE, NULL);
+    span_log_set_protocol(&t->logging, "REPLAY");
+    if ((t->tap = media_tap_init(NULL, REPLAY_TAP_BUFFER_LEN)) == NULL)
+    {
+        if (s == NULL)
+            span_free(t);
+        /*endif*/
+        return NULL;
+    }
+    /*endif*/
+    /* Only the output is needed for comparison, though the tap must still see the
+       input, to keep the same time as the recording */
+    media_tap_set_mask(t->tap, (1 << MEDIA_TAP_TX_AUDIO) | (1 << MEDIA_TAP_TX_IFP));
+    t->type = type;
+    t->context = context;
+    set_tap(t, t->tap);
+    return t;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) media_replay_release(media_replay_state_t *s)
+{
+    if (s->tap)
+    {
+        set_tap(s, NULL);
+        media_tap_free(s->tap);
+        s->tap = NULL;
+    }
+    /*endif*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) media_replay_free(media_replay_state_t *s)
+{
+    if (s)
+    {
+        media_replay_release(s);
+        span_free(s);
+    }
+    /*endif*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+/*- End of file ------------------------------------------------------------*/
@@ -0,0 +1,394 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * media_tap.c - Non-blocking capture of audio and T.38 IFP packets, for debugging.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2013 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 2.1,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \file */
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#if defined(HAVE_STDBOOL_H)
+#include <stdbool.h>
+#else
+#include "spandsp/stdbool.h"
+#endif
+
+#include "spandsp/telephony.h"
+#include "spandsp/alloc.h"
+#include "spandsp/queue.h"
+#include "spandsp/media_tap.h"
+
+#include "spandsp/private/queue.h"
+#include "spandsp/private/media_tap.h"
+
+/* The header which precedes the payload of each record in the queue */
+typedef struct
+{
+    uint8_t type;
+    uint8_t continues;
+    uint16_t t38_seq_no;
+    uint32_t seq_no;
+    uint32_t sample_time;
+} media_tap_header_t;
+
+static int put_record(media_tap_state_t *s, int type, uint32_t sample_time, int t38_seq_no, int continues, const void *payload, int len)
+{
+    uint8_t buf[sizeof(media_tap_header_t) + MEDIA_TAP_MAX_PAYLOAD];
+    media_tap_header_t hdr;
+
+    hdr.type = (uint8_t) type;
+    hdr.continues = (uint8_t) continues;
+    hdr.t38_seq_no = (uint16_t) t38_seq_no;
+    hdr.seq_no = s->seq_no++;
+    hdr.sample_time = sample_time;
+    /* The header and payload must go into the queue as one message, so the reader
+       never sees half a record */
+    memcpy(buf, &hdr, sizeof(hdr));
+    memcpy(buf + sizeof(hdr), payload, len);
+    if (queue_write_msg(s->queue, buf, sizeof(hdr) + len) < 0)
+    {
+        s->dropped++;
+        return -1;
+    }
+    /*endif*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void check_header_time(media_tap_state_t *s)
+{
+    time_t now;
+    int64_t payload;
+
+    /* Called before each input is recorded, so a replay can apply the new time before
+       the input which might send a page with it */
+    if (!(s->mask & (1 << MEDIA_TAP_HEADER_TIME)))
+        return;
+    /*endif*/
+    time(&now);
+    if (s->header_time >= 0  &&  now/60 == s->header_time/60)
+        return;
+    /*endif*/
+    s->header_time = now;
+    payload = now;
+    put_record(s, MEDIA_TAP_HEADER_TIME, s->rx_samples, 0, false, &payload, sizeof(payload));
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) media_tap_audio(media_tap_state_t *s, int type, const int16_t amp[], int len)
+{
+    uint32_t *samples;
+    int chunk;
+    int ret;
+    int i;
+
+    if (type == MEDIA_TAP_TX_AUDIO)
+    {
+        samples = &s->tx_samples;
+    }
+    else
+    {
+        samples = &s->rx_samples;
+        check_header_time(s);
+    }
+    /*endif*/
+    ret = 0;
+    if ((s->mask & (1 << type)))
+    {
+        for (i = 0;  i < len;  i += chunk)
+        {
+            chunk = len - i;
+            if (chunk > MEDIA_TAP_MAX_PAYLOAD/(int) sizeof(int16_t))
+                chunk = MEDIA_TAP_MAX_PAYLOAD/(int) sizeof(int16_t);
+            /*endif*/
+            if (put_record(s, type, *samples + i, 0, (i + chunk < len), &amp[i], chunk*sizeof(int16_t)) < 0)
+                ret = -1;
+            /*endif*/
+        }
+        /*endfor*/
+    }
+    /*endif*/
+    *samples += len;
+    return ret;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int put_int_record(media_tap_state_t *s, int type, int value)
+{
+    int32_t payload;
+
+    /* All the records with an integer payload are inputs */
+    check_header_time(s);
+    if (!(s->mask & (1 << type)))
+        return 0;
+    /*endif*/
+    payload = value;
+    return put_record(s, type, s->rx_samples, 0, false, &payload, sizeof(payload));
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(void) media_tap_audio_fillin(media_tap_state_t *s, int type, int len)
+{
+    if (type == MEDIA_TAP_TX_AUDIO)
+    {
+        s->tx_samples += len;
+    }
+    else
+    {
+        put_int_record(s, MEDIA_TAP_RX_FILLIN, len);
+        s->rx_samples += len;
+    }
+    /*endif*/
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) media_tap_ifp(media_tap_state_t *s, int type, const uint8_t buf[], int len, int seq_no)
+{
+    if (type == MEDIA_TAP_RX_IFP)
+        check_header_time(s);
+    /*endif*/
+    if (!(s->mask & (1 << type)))
+        return 0;
+    /*endif*/
+    if (len > MEDIA_TAP_MAX_PAYLOAD)
+        len = MEDIA_TAP_MAX_PAYLOAD;
+    /*endif*/
+    return put_record(s, type, s->rx_samples, seq_no, false, buf, len);
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) media_tap_tx_request(media_tap_state_t *s, int max_len)
+{
+    return put_int_record(s, MEDIA_TAP_TX_REQUEST, max_len);
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) media_tap_timer(media_tap_state_t *s, int samples)
+{
+    int ret;
+
+    ret = put_int_record(s, MEDIA_TAP_TIMER, samples);
+    /* A T.38 terminal has no audio, so its timer is the only clock there is */
+    s->rx_samples += samples;
+    return ret;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) media_tap_at(media_tap_state_t *s, const char buf[], int len)
+{
+    int chunk;
+    int ret;
+    int i;
+
+    check_header_time(s);
+    if (!(s->mask & (1 << MEDIA_TAP_RX_AT)))
+        return 0;
+    /*endif*/
+    ret = 0;
+    for (i = 0;  i < len;  i += chunk)
+    {
+        chunk = len - i;
+        if (chunk > MEDIA_TAP_MAX_PAYLOAD)
+            chunk = MEDIA_TAP_MAX_PAYLOAD;
+        /*endif*/
+        if (put_record(s, MEDIA_TAP_RX_AT, s->rx_samples, 0, (i + chunk < len), &buf[i], chunk) < 0)
+            ret = -1;
+        /*endif*/
+    }
+    /*endfor*/
+    return ret;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) media_tap_note(media_tap_state_t *s, const uint8_t buf[], int len)
+{
+    if (!(s->mask & (1 << MEDIA_TAP_NOTE)))
+        return 0;
+    /*endif*/
+    if (len > MEDIA_TAP_MAX_PAYLOAD)
+        return -1;
+    /*endif*/
+    return put_record(s, MEDIA_TAP_NOTE, s->rx_samples, 0, false, buf, len);
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(time_t) media_tap_get_header_time(media_tap_state_t *s)
+{
+    return s->header_time;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(void) media_tap_set_header_time(media_tap_state_t *s, time_t when)
+{
+    s->header_time = when;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) media_tap_read(media_tap_state_t *s, media_tap_record_t *rec, uint8_t buf[], int max_len)
+{
+    uint8_t msg[sizeof(media_tap_header_t) + MEDIA_TAP_MAX_PAYLOAD];
+    media_tap_header_t hdr;
+    int len;
+
+    if ((len = queue_read_msg(s->queue, msg, sizeof(msg))) < (int) sizeof(hdr))
+        return -1;
+    /*endif*/
+    memcpy(&hdr, msg, sizeof(hdr));
+    rec->type = hdr.type;
+    rec->seq_no = hdr.seq_no;
+    rec->sample_time = hdr.sample_time;
+    rec->t38_seq_no = hdr.t38_seq_no;
+    rec->continues = hdr.continues;
+    len -= sizeof(hdr);
+    if (len > max_len)
+        len = max_len;
+    /*endif*/
+    memcpy(buf, msg + sizeof(hdr), len);
+    return len;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void put_le32(uint8_t buf[], uint32_t x)
+{
+    buf[0] = (uint8_t) x;
+    buf[1] = (uint8_t) (x >> 8);
+    buf[2] = (uint8_t) (x >> 16);
+    buf[3] = (uint8_t) (x >> 24);
+}
+/*- End of function --------------------------------------------------------*/
+
+static uint32_t get_le32(const uint8_t buf[])
+{
+    return (uint32_t) buf[0]
+         | ((uint32_t) buf[1] << 8)
+         | ((uint32_t) buf[2] << 16)
+         | ((uint32_t) buf[3] << 24);
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) media_tap_pack_header(uint8_t buf[], const media_tap_record_t *rec, int len)
+{
+    /* All fields are little endian:
+        type (1 byte), continues (1 byte), T.38 sequence number (2 bytes),
+        sequence number (4 bytes), sample time (4 bytes), payload length (4 bytes) */
+    buf[0] = (uint8_t) rec->type;
+    buf[1] = (uint8_t) rec->continues;
+    buf[2] = (uint8_t) rec->t38_seq_no;
+    buf[3] = (uint8_t) (rec->t38_seq_no >> 8);
+    put_le32(&buf[4], rec->seq_no);
+    put_le32(&buf[8], rec->sample_time);
+    put_le32(&buf[12], (uint32_t) len);
+    return MEDIA_TAP_PACKED_HEADER_LEN;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) media_tap_unpack_header(media_tap_record_t *rec, const uint8_t buf[])
+{
+    uint32_t len;
+
+    rec->type = buf[0];
+    rec->continues = buf[1];
+    rec->t38_seq_no = buf[2] | (buf[3] << 8);
+    rec->seq_no = get_le32(&buf[4]);
+    rec->sample_time = get_le32(&buf[8]);
+    len = get_le32(&buf[12]);
+    if (rec->type < MEDIA_TAP_RX_AUDIO  ||  rec->type > MEDIA_TAP_HEADER_TIME  ||  len > MEDIA_TAP_MAX_PAYLOAD)
+        return -1;
+    /*endif*/
+    return (int) len;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(void) media_tap_set_mask(media_tap_state_t *s, int mask)
+{
+    s->mask = mask;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) media_tap_get_dropped(media_tap_state_t *s)
+{
+    return s->dropped;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(media_tap_state_t *) media_tap_init(media_tap_state_t *s, int buffer_len)
+{
+    media_tap_state_t *t;
+
+    if (buffer_len < (int) sizeof(media_tap_header_t) + MEDIA_TAP_MAX_PAYLOAD + (int) sizeof(uint16_t))
+        return NULL;
+    /*endif*/
+    t = s;
+    if (t == NULL)
+    {
+        if ((t = (media_tap_state_t *) span_alloc(sizeof(*t))) == NULL)
+            return NULL;
+        /*endif*/
+    }
+    /*endif*/
+    memset(t, 0, sizeof(*t));
+    if ((t->queue = queue_init(NULL, buffer_len, QUEUE_READ_ATOMIC | QUEUE_WRITE_ATOMIC)) == NULL)
+    {
+        if (s == NULL)
+            span_free(t);
+        /*endif*/
+        return NULL;
+    }
+    /*endif*/
+    t->mask = MEDIA_TAP_MASK_CAPTURE;
+    t->header_time = -1;
+    return t;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) media_tap_release(media_tap_state_t *s)
+{
+    if (s->queue)
+    {
+        queue_free(s->queue);
+        s->queue = NULL;
+    }
+    /*endif*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) media_tap_free(media_tap_state_t *s)
+{
+    if (s)
+    {
+        media_tap_release(s);
+        span_free(s);
+    }
+    /*endif*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+/*- End of file ------------------------------------------------------------*/
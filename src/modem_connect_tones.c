@@ -59,6 +59,7 @@
 #include "spandsp/stdbool.h"
 #endif
 #include "floating_fudge.h"
+#include "mmx_sse_decs.h"
 #include <stdio.h>
 
 #include "spandsp/telephony.h"
@@ -456,6 +457,154 @@ static void v21_put_bit(void *user_data, int bit)
 }
 /*- End of function --------------------------------------------------------*/
 
+static __inline__ int tone_level_dbm0(modem_connect_tones_rx_state_t *s)
+{
+    return lfastrintf(log10f(s->channel_level/32768.0f)*20.0f + DBM0_MAX_POWER + 0.8f);
+}
+/*- End of function --------------------------------------------------------*/
+
+/* The decision logic for a simple tone, given the input sample and the output of a notch
+   filter centred on the tone. */
+static __inline__ void simple_tone_decision(modem_connect_tones_rx_state_t *s, int tone, int16_t amp, int16_t notched)
+{
+    /* Estimate the overall energy in the channel, and the energy in
+       the notch (i.e. overall channel energy - tone energy => noise).
+       Use abs instead of multiply for speed (is it really faster?). */
+    s->channel_level += ((abs(amp) - s->channel_level) >> 5);
+    s->notch_level += ((abs(notched) - s->notch_level) >> 5);
+    if (s->channel_level > 70  &&  s->notch_level*6 < s->channel_level)
+    {
+        /* There is adequate energy in the channel, and it is mostly at the tone frequency. */
+        if (s->tone_present != tone)
+        {
+            if (++s->tone_cycle_duration >= ms_to_samples(415))
+                report_tone_state(s, tone, tone_level_dbm0(s));
+        }
+    }
+    else
+    {
+        /* If the signal looks wrong, even for a moment, we consider this the
+           end of the tone. */
+        if (s->tone_present == tone)
+            report_tone_state(s, MODEM_CONNECT_TONES_NONE, -99);
+        s->tone_cycle_duration = 0;
+    }
+}
+/*- End of function --------------------------------------------------------*/
+
+/* The decision logic for ANS, ANS/, ANSam and ANSam/, given the input sample, the output
+   of a notch filter centred on 2100Hz, and the output of the 15Hz AM demodulator. */
+static __inline__ void ans_tone_decision(modem_connect_tones_rx_state_t *s, int16_t amp, int16_t notched, float filtered)
+{
+    s->am_level += abs(lfastrintf(filtered)) - (s->am_level >> 8);
+    /* Estimate the overall energy in the channel, and the energy in
+       the notch (i.e. overall channel energy - tone energy => noise).
+       Use abs instead of multiply for speed (is it really faster?).
+       Damp the overall energy a little more for a stable result.
+       Damp the notch energy a little less, so we don't damp out the
+       blip every time the phase reverses. */
+    s->channel_level += ((abs(amp) - s->channel_level) >> 5);
+    s->notch_level += ((abs(notched) - s->notch_level) >> 4);
+    /* This should cut off at about -43dBm0 */
+    if (s->channel_level <= 70)
+    {
+        /* If the energy level is low, even for a moment, we consider this the
+           end of the tone. */
+        if (s->tone_present != MODEM_CONNECT_TONES_NONE)
+            report_tone_state(s, MODEM_CONNECT_TONES_NONE, -99);
+        s->tone_cycle_duration = 0;
+        s->good_cycles = 0;
+        s->tone_on = false;
+        return;
+    }
+    /* There is adequate energy in the channel. Is it mostly at 2100Hz? */
+    s->tone_cycle_duration++;
+    if (s->notch_level*6 < s->channel_level)
+    {
+        /* The notch test says yes, so we have the tone. */
+        /* We should get a kick from the notch filter every 450+-25ms, as the phase reverses, for an
+           EC disable tone. For a simple answer tone, the tone should persist unbroken for longer. */
+        if (!s->tone_on)
+        {
+            if (s->tone_cycle_duration >= ms_to_samples(450 - 25))
+            {
+                if (++s->good_cycles == 3)
+                {
+                    report_tone_state(s,
+                                      (s->am_level*15/256 > s->channel_level)  ?  MODEM_CONNECT_TONES_ANSAM_PR  :  MODEM_CONNECT_TONES_ANS_PR,
+                                      tone_level_dbm0(s));
+                }
+            }
+            else
+            {
+                s->good_cycles = 0;
+            }
+            /* Cycles are timed from rising edge to rising edge */
+            s->tone_cycle_duration = 0;
+        }
+        else
+        {
+            if (s->tone_cycle_duration >= ms_to_samples(450 + 100))
+            {
+                if (s->tone_present == MODEM_CONNECT_TONES_NONE)
+                {
+                    report_tone_state(s,
+                                      (s->am_level*15/256 > s->channel_level)  ?  MODEM_CONNECT_TONES_ANSAM  :  MODEM_CONNECT_TONES_ANS,
+                                      tone_level_dbm0(s));
+                }
+                s->good_cycles = 0;
+                s->tone_cycle_duration = ms_to_samples(450 + 100);
+            }
+        }
+        s->tone_on = true;
+    }
+    else if (s->notch_level*5 > s->channel_level)
+    {
+        if (s->tone_present == MODEM_CONNECT_TONES_ANS)
+        {
+            report_tone_state(s, MODEM_CONNECT_TONES_NONE, -99);
+            s->good_cycles = 0;
+        }
+        else
+        {
+            if (s->tone_cycle_duration >= ms_to_samples(450 + 25))
+            {
+                /* The change came too late for a cycle of ANS_PR tone */
+                if (s->tone_present == MODEM_CONNECT_TONES_ANS_PR  ||  s->tone_present == MODEM_CONNECT_TONES_ANSAM_PR)
+                    report_tone_state(s, MODEM_CONNECT_TONES_NONE, -99);
+                s->good_cycles = 0;
+            }
+        }
+        s->tone_on = false;
+    }
+}
+/*- End of function --------------------------------------------------------*/
+
+/* A Cauer notch at 1100Hz, spread just wide enough to meet our detection bandwidth
+   criteria. */
+/* Poles 0.736618498*exp(+-1047/4000 * PI * j)
+   Zeroes exp(+-1099.5/4000 * PI * j) */
+#define CNG_NOTCH_GAIN      0.792928f
+#define CNG_NOTCH_P1        1.0018744927985f
+#define CNG_NOTCH_P2        -0.54196833412465f
+#define CNG_NOTCH_Z1        -1.2994747954630f
+
+/* A Cauer notch at 2100Hz, spread just wide enough to meet our detection bandwidth
+   criteria. */
+/* Poles 0.7144255*exp(+-2105.612/4000 * PI * j)
+   Zeroes exp(+-2099.9/4000 * PI * j) */
+#define ANS_NOTCH_GAIN      0.7552f
+#define ANS_NOTCH_P1        -0.1183852f
+#define ANS_NOTCH_P2        -0.5104039f
+#define ANS_NOTCH_Z1        0.1567596f
+
+/* A Cauer bandpass at 15Hz, with which we demodulate the AM signal. */
+/* Poles 0.9983989*exp(+-15/4000 * PI * j)
+   Zeroes exp(0/4000 * PI * j) */
+#define AM_15HZ_P1          1.996667f
+#define AM_15HZ_P2          -0.9968004f
+#define AM_15HZ_GAIN        0.001599787f
+
 SPAN_DECLARE_NONSTD(int) modem_connect_tones_rx(modem_connect_tones_rx_state_t *s,
                                                 const int16_t amp[],
                                                 int len)
@@ -472,38 +621,12 @@ SPAN_DECLARE_NONSTD(int) modem_connect_tones_rx(modem_connect_tones_rx_state_t *
         for (i = 0;  i < len;  i++)
         {
             famp = amp[i];
-            /* A Cauer notch at 1100Hz, spread just wide enough to meet our detection bandwidth
-               criteria. */
-            /* Poles 0.736618498*exp(+-1047/4000 * PI * j)
-               Zeroes exp(+-1099.5/4000 * PI * j) */
-            v1 = 0.792928f*famp + 1.0018744927985f*s->znotch_1 - 0.54196833412465f*s->znotch_2;
-            famp = v1 - 1.2994747954630f*s->znotch_1 + s->znotch_2;
+            v1 = CNG_NOTCH_GAIN*famp + CNG_NOTCH_P1*s->znotch_1 + CNG_NOTCH_P2*s->znotch_2;
+            famp = v1 + CNG_NOTCH_Z1*s->znotch_1 + s->znotch_2;
             s->znotch_2 = s->znotch_1;
             s->znotch_1 = v1;
             notched = (int16_t) lfastrintf(famp);
-
-            /* Estimate the overall energy in the channel, and the energy in
-               the notch (i.e. overall channel energy - tone energy => noise).
-               Use abs instead of multiply for speed (is it really faster?). */
-            s->channel_level += ((abs(amp[i]) - s->channel_level) >> 5);
-            s->notch_level += ((abs(notched) - s->notch_level) >> 5);
-            if (s->channel_level > 70  &&  s->notch_level*6 < s->channel_level)
-            {
-                /* There is adequate energy in the channel, and it is mostly at 1100Hz. */
-                if (s->tone_present != MODEM_CONNECT_TONES_FAX_CNG)
-                {
-                    if (++s->tone_cycle_duration >= ms_to_samples(415))
-                        report_tone_state(s, MODEM_CONNECT_TONES_FAX_CNG, lfastrintf(log10f(s->channel_level/32768.0f)*20.0f + DBM0_MAX_POWER + 0.8f));
-                }
-            }
-            else
-            {
-                /* If the signal looks wrong, even for a moment, we consider this the
-                   end of the tone. */
-                if (s->tone_present == MODEM_CONNECT_TONES_FAX_CNG)
-                    report_tone_state(s, MODEM_CONNECT_TONES_NONE, -99);
-                s->tone_cycle_duration = 0;
-            }
+            simple_tone_decision(s, MODEM_CONNECT_TONES_FAX_CNG, amp[i], notched);
         }
         break;
     case MODEM_CONNECT_TONES_FAX_PREAMBLE:
@@ -519,104 +642,16 @@ SPAN_DECLARE_NONSTD(int) modem_connect_tones_rx(modem_connect_tones_rx_state_t *
         for (i = 0;  i < len;  i++)
         {
             famp = amp[i];
-            /* A Cauer bandpass at 15Hz, with which we demodulate the AM signal. */
-            /* Poles 0.9983989*exp(+-15/4000 * PI * j)
-               Zeroes exp(0/4000 * PI * j) */
-            v1 = fabs(famp) + 1.996667f*s->z15hz_1 - 0.9968004f*s->z15hz_2;
-            filtered = 0.001599787f*(v1 - s->z15hz_2);
+            v1 = fabsf(famp) + AM_15HZ_P1*s->z15hz_1 + AM_15HZ_P2*s->z15hz_2;
+            filtered = AM_15HZ_GAIN*(v1 - s->z15hz_2);
             s->z15hz_2 = s->z15hz_1;
             s->z15hz_1 = v1;
-            s->am_level += abs(lfastrintf(filtered)) - (s->am_level >> 8);
-            //printf("%9.1f %10.4f %9d %9d\n", famp, filtered, s->am_level, s->channel_level);
-            /* A Cauer notch at 2100Hz, spread just wide enough to meet our detection bandwidth
-               criteria. */
-            /* Poles 0.7144255*exp(+-2105.612/4000 * PI * j)
-               Zeroes exp(+-2099.9/4000 * PI * j) */
-            v1 = 0.7552f*famp - 0.1183852f*s->znotch_1 - 0.5104039f*s->znotch_2;
-            famp = v1 + 0.1567596f*s->znotch_1 + s->znotch_2;
+            v1 = ANS_NOTCH_GAIN*famp + ANS_NOTCH_P1*s->znotch_1 + ANS_NOTCH_P2*s->znotch_2;
+            famp = v1 + ANS_NOTCH_Z1*s->znotch_1 + s->znotch_2;
             s->znotch_2 = s->znotch_1;
             s->znotch_1 = v1;
             notched = (int16_t) lfastrintf(famp);
-            /* Estimate the overall energy in the channel, and the energy in
-               the notch (i.e. overall channel energy - tone energy => noise).
-               Use abs instead of multiply for speed (is it really faster?).
-               Damp the overall energy a little more for a stable result.
-               Damp the notch energy a little less, so we don't damp out the
-               blip every time the phase reverses. */
-            s->channel_level += ((abs(amp[i]) - s->channel_level) >> 5);
-            s->notch_level += ((abs(notched) - s->notch_level) >> 4);
-            /* This should cut off at about -43dBm0 */
-            if (s->channel_level <= 70)
-            {
-                /* If the energy level is low, even for a moment, we consider this the
-                   end of the tone. */
-                if (s->tone_present != MODEM_CONNECT_TONES_NONE)
-                    report_tone_state(s, MODEM_CONNECT_TONES_NONE, -99);
-                s->tone_cycle_duration = 0;
-                s->good_cycles = 0;
-                s->tone_on = false;
-                continue;
-            }
-            /* There is adequate energy in the channel. Is it mostly at 2100Hz? */
-            s->tone_cycle_duration++;
-            if (s->notch_level*6 < s->channel_level)
-            {
-                /* The notch test says yes, so we have the tone. */
-                /* We should get a kick from the notch filter every 450+-25ms, as the phase reverses, for an
-                   EC disable tone. For a simple answer tone, the tone should persist unbroken for longer. */
-                if (!s->tone_on)
-                {
-                    if (s->tone_cycle_duration >= ms_to_samples(450 - 25))
-                    {
-                        if (++s->good_cycles == 3)
-                        {
-                            report_tone_state(s,
-                                              (s->am_level*15/256 > s->channel_level)  ?  MODEM_CONNECT_TONES_ANSAM_PR  :  MODEM_CONNECT_TONES_ANS_PR,
-                                              lfastrintf(log10f(s->channel_level/32768.0f)*20.0f + DBM0_MAX_POWER + 0.8f));
-                        }
-                    }
-                    else
-                    {
-                        s->good_cycles = 0;
-                    }
-                    /* Cycles are timed from rising edge to rising edge */
-                    s->tone_cycle_duration = 0;
-                }
-                else
-                {
-                    if (s->tone_cycle_duration >= ms_to_samples(450 + 100))
-                    {
-                        if (s->tone_present == MODEM_CONNECT_TONES_NONE)
-                        {
-                            report_tone_state(s,
-                                              (s->am_level*15/256 > s->channel_level)  ?  MODEM_CONNECT_TONES_ANSAM  :  MODEM_CONNECT_TONES_ANS,
-                                              lfastrintf(log10f(s->channel_level/32768.0f)*20.0f + DBM0_MAX_POWER + 0.8f));
-                        }
-                        s->good_cycles = 0;
-                        s->tone_cycle_duration = ms_to_samples(450 + 100);
-                    }
-                }
-                s->tone_on = true;
-            }
-            else if (s->notch_level*5 > s->channel_level)
-            {
-                if (s->tone_present == MODEM_CONNECT_TONES_ANS)
-                {
-                    report_tone_state(s, MODEM_CONNECT_TONES_NONE, -99);
-                    s->good_cycles = 0;
-                }
-                else
-                {
-                    if (s->tone_cycle_duration >= ms_to_samples(450 + 25))
-                    {
-                        /* The change came too late for a cycle of ANS_PR tone */
-                        if (s->tone_present == MODEM_CONNECT_TONES_ANS_PR  ||  s->tone_present == MODEM_CONNECT_TONES_ANSAM_PR)
-                            report_tone_state(s, MODEM_CONNECT_TONES_NONE, -99);
-                        s->good_cycles = 0;
-                    }
-                }
-                s->tone_on = false;
-            }
+            ans_tone_decision(s, amp[i], notched, filtered);
         }
         break;
     case MODEM_CONNECT_TONES_BELL_ANS:
@@ -632,29 +667,7 @@ SPAN_DECLARE_NONSTD(int) modem_connect_tones_rx(modem_connect_tones_rx_state_t *
             s->znotch_2 = s->znotch_1;
             s->znotch_1 = v1;
             notched = (int16_t) lfastrintf(famp);
-
-            /* Estimate the overall energy in the channel, and the energy in
-               the notch (i.e. overall channel energy - tone energy => noise).
-               Use abs instead of multiply for speed (is it really faster?). */
-            s->channel_level += ((abs(amp[i]) - s->channel_level) >> 5);
-            s->notch_level += ((abs(notched) - s->notch_level) >> 5);
-            if (s->channel_level > 70  &&  s->notch_level*6 < s->channel_level)
-            {
-                /* There is adequate energy in the channel, and it is mostly at 2225Hz. */
-                if (s->tone_present != MODEM_CONNECT_TONES_BELL_ANS)
-                {
-                    if (++s->tone_cycle_duration >= ms_to_samples(415))
-                        report_tone_state(s, MODEM_CONNECT_TONES_BELL_ANS, lfastrintf(log10f(s->channel_level/32768.0f)*20.0f + DBM0_MAX_POWER + 0.8f));
-                }
-            }
-            else
-            {
-                /* If the signal looks wrong, even for a moment, we consider this the
-                   end of the tone. */
-                if (s->tone_present == MODEM_CONNECT_TONES_BELL_ANS)
-                    report_tone_state(s, MODEM_CONNECT_TONES_NONE, -99);
-                s->tone_cycle_duration = 0;
-            }
+            simple_tone_decision(s, MODEM_CONNECT_TONES_BELL_ANS, amp[i], notched);
         }
         break;
     case MODEM_CONNECT_TONES_CALLING_TONE:
@@ -670,29 +683,7 @@ SPAN_DECLARE_NONSTD(int) modem_connect_tones_rx(modem_connect_tones_rx_state_t *
             s->znotch_2 = s->znotch_1;
             s->znotch_1 = v1;
             notched = (int16_t) lfastrintf(famp);
-
-            /* Estimate the overall energy in the channel, and the energy in
-               the notch (i.e. overall channel energy - tone energy => noise).
-               Use abs instead of multiply for speed (is it really faster?). */
-            s->channel_level += ((abs(amp[i]) - s->channel_level) >> 5);
-            s->notch_level += ((abs(notched) - s->notch_level) >> 5);
-            if (s->channel_level > 70  &&  s->notch_level*6 < s->channel_level)
-            {
-                /* There is adequate energy in the channel, and it is mostly at 1300Hz. */
-                if (s->tone_present != MODEM_CONNECT_TONES_CALLING_TONE)
-                {
-                    if (++s->tone_cycle_duration >= ms_to_samples(415))
-                        report_tone_state(s, MODEM_CONNECT_TONES_CALLING_TONE, lfastrintf(log10f(s->channel_level/32768.0f)*20.0f + DBM0_MAX_POWER + 0.8f));
-                }
-            }
-            else
-            {
-                /* If the signal looks wrong, even for a moment, we consider this the
-                   end of the tone. */
-                if (s->tone_present == MODEM_CONNECT_TONES_CALLING_TONE)
-                    report_tone_state(s, MODEM_CONNECT_TONES_NONE, -99);
-                s->tone_cycle_duration = 0;
-            }
+            simple_tone_decision(s, MODEM_CONNECT_TONES_CALLING_TONE, amp[i], notched);
         }
         break;
     }
@@ -776,4 +767,269 @@ SPAN_DECLARE(int) modem_connect_tones_rx_free(modem_connect_tones_rx_state_t *s)
     return 0;
 }
 /*- End of function --------------------------------------------------------*/
+
+static void bank_tone_report(void *user_data, int tone, int level, int delay)
+{
+    modem_connect_tones_rx_bank_channel_t *chan;
+
+    chan = (modem_connect_tones_rx_bank_channel_t *) user_data;
+    /* Only the first tone found is of interest. Once a channel is classified it is no
+       longer processed, so its tone can never be reported as ending. */
+    if (tone == MODEM_CONNECT_TONES_NONE  ||  chan->tone != MODEM_CONNECT_TONES_NONE)
+        return;
+    chan->tone = tone;
+    if (chan->bank->callback)
+        chan->bank->callback(chan->bank->user_data, chan->channel, tone, level);
+}
+/*- End of function --------------------------------------------------------*/
+
+/* Run the CNG notch, 2100Hz notch and 15Hz AM filters for one channel. */
+static void bank_filters(modem_connect_tones_rx_bank_state_t *s, modem_connect_tones_rx_bank_channel_t *chan, int lane, const int16_t amp[], int len)
+{
+    int i;
+    float v1;
+    float famp;
+
+    for (i = 0;  i < len;  i++)
+    {
+        famp = amp[i];
+        v1 = CNG_NOTCH_GAIN*famp + CNG_NOTCH_P1*chan->cng.znotch_1 + CNG_NOTCH_P2*chan->cng.znotch_2;
+        s->cng_notched[i][lane] = v1 + CNG_NOTCH_Z1*chan->cng.znotch_1 + chan->cng.znotch_2;
+        chan->cng.znotch_2 = chan->cng.znotch_1;
+        chan->cng.znotch_1 = v1;
+
+        v1 = fabsf(famp) + AM_15HZ_P1*chan->ans.z15hz_1 + AM_15HZ_P2*chan->ans.z15hz_2;
+        s->am_filtered[i][lane] = AM_15HZ_GAIN*(v1 - chan->ans.z15hz_2);
+        chan->ans.z15hz_2 = chan->ans.z15hz_1;
+        chan->ans.z15hz_1 = v1;
+
+        v1 = ANS_NOTCH_GAIN*famp + ANS_NOTCH_P1*chan->ans.znotch_1 + ANS_NOTCH_P2*chan->ans.znotch_2;
+        s->ans_notched[i][lane] = v1 + ANS_NOTCH_Z1*chan->ans.znotch_1 + chan->ans.znotch_2;
+        chan->ans.znotch_2 = chan->ans.znotch_1;
+        chan->ans.znotch_1 = v1;
+    }
+}
+/*- End of function --------------------------------------------------------*/
+
+#if defined(__GNUC__)  &&  defined(SPANDSP_USE_SSE2)
+/* Run the filters of bank_filters() for four channels at once, one per SSE lane. The
+   arithmetic in each lane is exactly that of bank_filters(). */
+static void bank_filters_sse2(modem_connect_tones_rx_bank_state_t *s, modem_connect_tones_rx_bank_channel_t *chan[4], const int16_t *amp[4], int len)
+{
+    __m128 cng_z1;
+    __m128 cng_z2;
+    __m128 ans_z1;
+    __m128 ans_z2;
+    __m128 am_z1;
+    __m128 am_z2;
+    __m128 famp;
+    __m128 v1;
+    __m128 mask;
+    float buf[4];
+    int i;
+    int j;
+
+    mask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    cng_z1 = _mm_setr_ps(chan[0]->cng.znotch_1, chan[1]->cng.znotch_1, chan[2]->cng.znotch_1, chan[3]->cng.znotch_1);
+    cng_z2 = _mm_setr_ps(chan[0]->cng.znotch_2, chan[1]->cng.znotch_2, chan[2]->cng.znotch_2, chan[3]->cng.znotch_2);
+    ans_z1 = _mm_setr_ps(chan[0]->ans.znotch_1, chan[1]->ans.znotch_1, chan[2]->ans.znotch_1, chan[3]->ans.znotch_1);
+    ans_z2 = _mm_setr_ps(chan[0]->ans.znotch_2, chan[1]->ans.znotch_2, chan[2]->ans.znotch_2, chan[3]->ans.znotch_2);
+    am_z1 = _mm_setr_ps(chan[0]->ans.z15hz_1, chan[1]->ans.z15hz_1, chan[2]->ans.z15hz_1, chan[3]->ans.z15hz_1);
+    am_z2 = _mm_setr_ps(chan[0]->ans.z15hz_2, chan[1]->ans.z15hz_2, chan[2]->ans.z15hz_2, chan[3]->ans.z15hz_2);
+    for (i = 0;  i < len;  i++)
+    {
+        famp = _mm_setr_ps(amp[0][i], amp[1][i], amp[2][i], amp[3][i]);
+
+        v1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(CNG_NOTCH_GAIN), famp),
+                                   _mm_mul_ps(_mm_set1_ps(CNG_NOTCH_P1), cng_z1)),
+                        _mm_mul_ps(_mm_set1_ps(CNG_NOTCH_P2), cng_z2));
+        _mm_storeu_ps(s->cng_notched[i], _mm_add_ps(_mm_add_ps(v1, _mm_mul_ps(_mm_set1_ps(CNG_NOTCH_Z1), cng_z1)), cng_z2));
+        cng_z2 = cng_z1;
+        cng_z1 = v1;
+
+        v1 = _mm_add_ps(_mm_add_ps(_mm_and_ps(famp, mask),
+                                   _mm_mul_ps(_mm_set1_ps(AM_15HZ_P1), am_z1)),
+                        _mm_mul_ps(_mm_set1_ps(AM_15HZ_P2), am_z2));
+        _mm_storeu_ps(s->am_filtered[i], _mm_mul_ps(_mm_set1_ps(AM_15HZ_GAIN), _mm_sub_ps(v1, am_z2)));
+        am_z2 = am_z1;
+        am_z1 = v1;
+
+        v1 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_set1_ps(ANS_NOTCH_GAIN), famp),
+                                   _mm_mul_ps(_mm_set1_ps(ANS_NOTCH_P1), ans_z1)),
+                        _mm_mul_ps(_mm_set1_ps(ANS_NOTCH_P2), ans_z2));
+        _mm_storeu_ps(s->ans_notched[i], _mm_add_ps(_mm_add_ps(v1, _mm_mul_ps(_mm_set1_ps(ANS_NOTCH_Z1), ans_z1)), ans_z2));
+        ans_z2 = ans_z1;
+        ans_z1 = v1;
+    }
+    _mm_storeu_ps(buf, cng_z1);
+    for (j = 0;  j < 4;  j++)
+        chan[j]->cng.znotch_1 = buf[j];
+    _mm_storeu_ps(buf, cng_z2);
+    for (j = 0;  j < 4;  j++)
+        chan[j]->cng.znotch_2 = buf[j];
+    _mm_storeu_ps(buf, ans_z1);
+    for (j = 0;  j < 4;  j++)
+        chan[j]->ans.znotch_1 = buf[j];
+    _mm_storeu_ps(buf, ans_z2);
+    for (j = 0;  j < 4;  j++)
+        chan[j]->ans.znotch_2 = buf[j];
+    _mm_storeu_ps(buf, am_z1);
+    for (j = 0;  j < 4;  j++)
+        chan[j]->ans.z15hz_1 = buf[j];
+    _mm_storeu_ps(buf, am_z2);
+    for (j = 0;  j < 4;  j++)
+        chan[j]->ans.z15hz_2 = buf[j];
+}
+/*- End of function --------------------------------------------------------*/
+#endif
+
+/* Apply the tone decision logic, and look for V.21 preamble, on one channel, using the
+   filter outputs for the specified lane. */
+static void bank_decisions(modem_connect_tones_rx_bank_state_t *s, modem_connect_tones_rx_bank_channel_t *chan, int lane, const int16_t amp[], int len)
+{
+    int i;
+    int nbits;
+
+    for (i = 0;  i < len  &&  chan->tone == MODEM_CONNECT_TONES_NONE;  i++)
+    {
+        simple_tone_decision(&chan->cng, MODEM_CONNECT_TONES_FAX_CNG, amp[i], (int16_t) lfastrintf(s->cng_notched[i][lane]));
+        ans_tone_decision(&chan->ans, amp[i], (int16_t) lfastrintf(s->ans_notched[i][lane]), s->am_filtered[i][lane]);
+    }
+    if (chan->tone != MODEM_CONNECT_TONES_NONE)
+        return;
+    nbits = fsk_rx_block(&chan->ans.v21rx, amp, (const complexi_t (*)[2]) s->lo, len, s->bits);
+    for (i = 0;  i < nbits  &&  chan->tone == MODEM_CONNECT_TONES_NONE;  i++)
+        v21_put_bit(&chan->ans, s->bits[i]);
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) modem_connect_tones_rx_bank(modem_connect_tones_rx_bank_state_t *s, const int16_t *amp[], int len)
+{
+    modem_connect_tones_rx_bank_channel_t *chan;
+    int i;
+    int j;
+    int n;
+#if defined(__GNUC__)  &&  defined(SPANDSP_USE_SSE2)
+    modem_connect_tones_rx_bank_channel_t *lane_chan[4];
+    const int16_t *lane_amp[4];
+    int lanes;
+#endif
+
+    for (i = 0;  i < len;  i += n)
+    {
+        n = len - i;
+        if (n > MODEM_CONNECT_TONES_RX_BANK_BLOCK_LEN)
+            n = MODEM_CONNECT_TONES_RX_BANK_BLOCK_LEN;
+        /* All the V.21 receivers use the same tones, so the local oscillators used to
+           correlate against them need only be generated once for the whole bank. */
+        fsk_rx_shared_lo(&s->chan[0].ans.v21rx, s->phase_acc, s->lo, n);
+#if defined(__GNUC__)  &&  defined(SPANDSP_USE_SSE2)
+        lanes = 0;
+        for (j = 0;  j < s->channels;  j++)
+        {
+            chan = &s->chan[j];
+            if (amp[j] == NULL  ||  chan->tone != MODEM_CONNECT_TONES_NONE)
+                continue;
+            lane_chan[lanes] = chan;
+            lane_amp[lanes] = &amp[j][i];
+            if (++lanes < 4)
+                continue;
+            bank_filters_sse2(s, lane_chan, lane_amp, n);
+            for (lanes = 0;  lanes < 4;  lanes++)
+                bank_decisions(s, lane_chan[lanes], lanes, lane_amp[lanes], n);
+            lanes = 0;
+        }
+        for (j = 0;  j < lanes;  j++)
+        {
+            bank_filters(s, lane_chan[j], 0, lane_amp[j], n);
+            bank_decisions(s, lane_chan[j], 0, lane_amp[j], n);
+        }
+#else
+        for (j = 0;  j < s->channels;  j++)
+        {
+            chan = &s->chan[j];
+            if (amp[j] == NULL  ||  chan->tone != MODEM_CONNECT_TONES_NONE)
+                continue;
+            bank_filters(s, chan, 0, &amp[j][i], n);
+            bank_decisions(s, chan, 0, &amp[j][i], n);
+        }
+#endif
+    }
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) modem_connect_tones_rx_bank_get(modem_connect_tones_rx_bank_state_t *s, int channel)
+{
+    if (channel < 0  ||  channel >= s->channels)
+        return MODEM_CONNECT_TONES_NONE;
+    return s->chan[channel].tone;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) modem_connect_tones_rx_bank_restart(modem_connect_tones_rx_bank_state_t *s, int channel)
+{
+    modem_connect_tones_rx_bank_channel_t *chan;
+
+    if (channel < 0  ||  channel >= s->channels)
+        return -1;
+    chan = &s->chan[channel];
+    modem_connect_tones_rx_init(&chan->cng, MODEM_CONNECT_TONES_FAX_CNG, bank_tone_report, chan);
+    modem_connect_tones_rx_init(&chan->ans, MODEM_CONNECT_TONES_FAX_CED_OR_PREAMBLE, bank_tone_report, chan);
+    chan->tone = MODEM_CONNECT_TONES_NONE;
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(modem_connect_tones_rx_bank_state_t *) modem_connect_tones_rx_bank_init(modem_connect_tones_rx_bank_state_t *s,
+                                                                                     int channels,
+                                                                                     modem_connect_tones_rx_bank_report_func_t callback,
+                                                                                     void *user_data)
+{
+    modem_connect_tones_rx_bank_channel_t *chan;
+    int i;
+
+    if (channels <= 0)
+        return NULL;
+    if ((chan = (modem_connect_tones_rx_bank_channel_t *) span_alloc(channels*sizeof(*chan))) == NULL)
+        return NULL;
+    if (s == NULL)
+    {
+        if ((s = (modem_connect_tones_rx_bank_state_t *) span_alloc(sizeof(*s))) == NULL)
+        {
+            span_free(chan);
+            return NULL;
+        }
+    }
+    memset(s, 0, sizeof(*s));
+    s->channels = channels;
+    s->callback = callback;
+    s->user_data = user_data;
+    s->chan = chan;
+    for (i = 0;  i < channels;  i++)
+    {
+        s->chan[i].bank = s;
+        s->chan[i].channel = i;
+        modem_connect_tones_rx_bank_restart(s, i);
+    }
+    return s;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) modem_connect_tones_rx_bank_release(modem_connect_tones_rx_bank_state_t *s)
+{
+    span_free(s->chan);
+    s->chan = NULL;
+    s->channels = 0;
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) modem_connect_tones_rx_bank_free(modem_connect_tones_rx_bank_state_t *s)
+{
+    modem_connect_tones_rx_bank_release(s);
+    span_free(s);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
 /*- End of file ------------------------------------------------------------*/
@@ -50,6 +50,7 @@
 #include "spandsp/alloc.h"
 #include "spandsp/bit_operations.h"
 #include "spandsp/dc_restore.h"
+#include "spandsp/vector_int.h"
 #include "spandsp/modem_echo.h"
 
 #include "spandsp/private/modem_echo.h"
@@ -59,6 +60,7 @@ SPAN_DECLARE(void) modem_echo_can_free(modem_echo_can_state_t *ec)
     fir16_free(&ec->fir_state);
     span_free(ec->fir_taps32);
     span_free(ec->fir_taps16);
+    span_free(ec->block_history);
     span_free(ec);
 }
 /*- End of function --------------------------------------------------------*/
@@ -85,8 +87,16 @@ SPAN_DECLARE(modem_echo_can_state_t *) modem_echo_can_init(int len)
         return NULL;
     }
     memset(ec->fir_taps16, 0, ec->taps*sizeof(int16_t));
+    if ((ec->block_history = (int16_t *) span_alloc((ec->taps + MODEM_ECHO_CAN_BLOCK_LEN)*sizeof(int16_t))) == NULL)
+    {
+        span_free(ec->fir_taps16);
+        span_free(ec->fir_taps32);
+        span_free(ec);
+        return NULL;
+    }
     if (fir16_create(&ec->fir_state, ec->fir_taps16, ec->taps) == NULL)
     {
+        span_free(ec->block_history);
         span_free(ec->fir_taps16);
         span_free(ec->fir_taps32);
         span_free(ec);
@@ -174,4 +184,80 @@ SPAN_DECLARE(int16_t) modem_echo_can_update(modem_echo_can_state_t *ec, int16_t
     return (int16_t) clean_rx;
 }
 /*- End of function --------------------------------------------------------*/
+
+static int update_block(modem_echo_can_state_t *ec, int16_t clean_rx[], const int16_t tx[], const int16_t rx[], int len)
+{
+    int16_t clean[MODEM_ECHO_CAN_BLOCK_LEN];
+    int16_t *buf;
+    int32_t echo_value;
+    int32_t grad;
+    int clean_value;
+    int pos;
+    int i;
+    int j;
+
+    /* Build a linear copy of the transmit history, newest first, with the new block in
+       front of the history from the FIR's circular buffer. In this order the taps apply
+       directly to each sample's span of the buffer. */
+    buf = ec->block_history;
+    if ((pos = ec->curr_pos + 1) >= ec->taps)
+        pos = 0;
+    memcpy(&buf[len], &ec->fir_state.history[pos], (ec->taps - pos)*sizeof(int16_t));
+    memcpy(&buf[len + ec->taps - pos], ec->fir_state.history, pos*sizeof(int16_t));
+    for (j = 0;  j < len;  j++)
+        buf[len - 1 - j] = tx[j];
+
+    for (j = 0;  j < len;  j++)
+    {
+        /* Evaluate the echo, using the taps as they stood at the start of the block. The
+           same disregard for overflows applies as in modem_echo_can_update(). */
+        echo_value = vec_dot_prodi16(&buf[len - 1 - j], ec->fir_taps16, ec->taps) >> 15;
+        clean_value = rx[j] - (int16_t) echo_value;
+        clean_rx[j] = (int16_t) clean_value;
+        /* Store the error in the same order as the history, so the correlation with
+           each tap's span of the history is a simple dot product. */
+        clean[len - 1 - j] = (int16_t) ((clean_value + (1 << (MODEM_ECHO_CAN_BLOCK_SHIFT - 1))) >> MODEM_ECHO_CAN_BLOCK_SHIFT);
+        if (ec->adapt)
+            ec->tx_power += ((tx[j]*tx[j] - ec->tx_power) >> 5);
+    }
+
+    if (ec->adapt)
+    {
+        /* Update the FIR taps with the gradient for the whole block */
+        for (i = 0;  i < ec->taps;  i++)
+        {
+            grad = vec_dot_prodi16(&buf[i], clean, len);
+            /* Leak to avoid the coefficients drifting beyond the ability of the
+               adaption process to bring them back under control. */
+            ec->fir_taps32[i] -= (ec->fir_taps32[i] >> 23)*len;
+            ec->fir_taps32[i] += grad*(1 << (MODEM_ECHO_CAN_BLOCK_SHIFT - 1));
+            ec->fir_taps16[i] = (int16_t) (ec->fir_taps32[i] >> 15);
+        }
+    }
+
+    /* Put the newest history back in the FIR's circular buffer, so the per-sample
+       and block paths can be mixed. */
+    memcpy(ec->fir_state.history, buf, ec->taps*sizeof(int16_t));
+    memcpy(&ec->fir_state.history[ec->taps], buf, ec->taps*sizeof(int16_t));
+    ec->fir_state.curr_pos = ec->taps - 1;
+    ec->curr_pos = ec->taps - 1;
+    return len;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) modem_echo_can_update_block(modem_echo_can_state_t *ec, int16_t clean_rx[], const int16_t tx[], const int16_t rx[], int len)
+{
+    int i;
+    int n;
+
+    for (i = 0;  i < len;  i += n)
+    {
+        n = len - i;
+        if (n > MODEM_ECHO_CAN_BLOCK_LEN)
+            n = MODEM_ECHO_CAN_BLOCK_LEN;
+        update_block(ec, &clean_rx[i], &tx[i], &rx[i], n);
+    }
+    return len;
+}
+/*- End of function --------------------------------------------------------*/
 /*- End of file ------------------------------------------------------------*/
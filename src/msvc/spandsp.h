@@ -53,6 +53,9 @@
 #include <spandsp/bit_operations.h>
 #include <spandsp/bitstream.h>
 #include <spandsp/queue.h>
+#include <spandsp/media_tap.h>
+#include <spandsp/media_replay.h>
+#include <spandsp/channel_group.h>
 #include <spandsp/schedule.h>
 #include <spandsp/g711.h>
 #include <spandsp/timing.h>
@@ -67,6 +70,7 @@
 #include <spandsp/awgn.h>
 #include <spandsp/bert.h>
 #include <spandsp/power_meter.h>
+#include <spandsp/resampler.h>
 #include <spandsp/complex_filters.h>
 #include <spandsp/dc_restore.h>
 #include <spandsp/dds.h>
@@ -108,8 +112,8 @@
 #include <spandsp/image_translate.h>
 #include <spandsp/t4_t6_decode.h>
 #include <spandsp/t4_t6_encode.h>
-/*#include <spandsp/t81_t82_arith_coding.h>*/
-/*#include <spandsp/t85.h>*/
+#include <spandsp/t81_t82_arith_coding.h>
+#include <spandsp/t85.h>
 #include <spandsp/t30.h>
 #include <spandsp/t30_api.h>
 #include <spandsp/t30_fcf.h>
@@ -133,6 +137,8 @@
 #include <spandsp/gsm0610.h>
 #include <spandsp/plc.h>
 #include <spandsp/playout.h>
+#include <spandsp/playout_rx.h>
+#include <spandsp/state_sizes.h>
 
 #endif
 
@@ -0,0 +1,257 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * playout_rx.c - A receive pipeline, from a play-out buffer of coded frames to
+ *                concealed and time scaled linear audio.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2013 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 2.1,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \file */
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <string.h>
+#include <limits.h>
+#if defined(HAVE_STDBOOL_H)
+#include <stdbool.h>
+#else
+#include "spandsp/stdbool.h"
+#endif
+
+#include "spandsp/telephony.h"
+#include "spandsp/alloc.h"
+#include "spandsp/logging.h"
+#include "spandsp/bitstream.h"
+#include "spandsp/bit_operations.h"
+#include "spandsp/g711.h"
+#include "spandsp/g726.h"
+#include "spandsp/plc.h"
+#include "spandsp/time_scale.h"
+#include "spandsp/playout.h"
+#include "spandsp/playout_rx.h"
+
+#include "spandsp/private/logging.h"
+#include "spandsp/private/bitstream.h"
+#include "spandsp/private/g726.h"
+#include "spandsp/private/plc.h"
+#include "spandsp/private/time_scale.h"
+#include "spandsp/private/playout.h"
+#include "spandsp/private/playout_rx.h"
+
+static void finished_with_frame(playout_rx_state_t *s, playout_frame_t *frame)
+{
+    if (s->frame_handler)
+        s->frame_handler(s->frame_user_data, frame->data, frame->type);
+    /*endif*/
+}
+/*- End of function --------------------------------------------------------*/
+
+static int decode_frame(playout_rx_state_t *s, int16_t amp[], const playout_frame_t *frame)
+{
+    const uint8_t *data;
+    int len;
+    int i;
+
+    data = (const uint8_t *) frame->data;
+    len = frame->sender_len;
+    switch (s->coding)
+    {
+    case PLAYOUT_RX_LINEAR:
+        memcpy(amp, data, len*sizeof(int16_t));
+        break;
+    case PLAYOUT_RX_ALAW:
+        for (i = 0;  i < len;  i++)
+            amp[i] = alaw_to_linear(data[i]);
+        /*endfor*/
+        break;
+    case PLAYOUT_RX_ULAW:
+        for (i = 0;  i < len;  i++)
+            amp[i] = ulaw_to_linear(data[i]);
+        /*endfor*/
+        break;
+    case PLAYOUT_RX_G726:
+        len = g726_decode(&s->g726, amp, data, len*s->bits_per_sample/8);
+        break;
+    }
+    /*endswitch*/
+    return len;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) playout_rx(playout_rx_state_t *s, int16_t amp[], timestamp_t now)
+{
+    playout_frame_t frame;
+    int16_t *buf;
+    int out_len;
+    int len;
+    int ret;
+
+    out_len = 0;
+    if (s->scaling  &&  s->rate == 1.0f)
+    {
+        /* Time scaling has finished. Output what the time scaler was holding, and go
+           back to decoding directly into the output buffer. */
+        out_len = time_scale_flush(&s->time_scale, amp);
+        s->scaling = false;
+    }
+    /*endif*/
+    buf = (s->scaling)  ?  s->frame  :  &amp[out_len];
+    for (;;)
+    {
+        ret = playout_get(s->playout, &frame, now);
+        if (ret == PLAYOUT_OK  &&  frame.type == PLAYOUT_TYPE_SPEECH)
+        {
+            if (frame.sender_len <= PLAYOUT_RX_MAX_FRAME)
+            {
+                len = decode_frame(s, buf, &frame);
+                finished_with_frame(s, &frame);
+                plc_rx(&s->plc, buf, len);
+                s->frames_played++;
+                break;
+            }
+            /*endif*/
+            span_log(&s->logging, SPAN_LOG_WARNING, "Frame of %d samples is too long\n", frame.sender_len);
+            finished_with_frame(s, &frame);
+            s->frames_discarded++;
+            ret = PLAYOUT_FILLIN;
+        }
+        /*endif*/
+        if (ret != PLAYOUT_OK  &&  ret != PLAYOUT_DROP)
+        {
+            /* Nothing is available for this frame period, so conceal the gap. The
+               length of the gap is the length of the last frame. */
+            if ((len = s->playout->last_speech_sender_len) > PLAYOUT_RX_MAX_FRAME)
+                len = PLAYOUT_RX_MAX_FRAME;
+            /*endif*/
+            if (len > 0)
+            {
+                plc_fillin(&s->plc, buf, len);
+                s->frames_concealed++;
+            }
+            /*endif*/
+            break;
+        }
+        /*endif*/
+        /* A frame which arrived too late, or which is not speech. Either way, the
+           play-out buffer wants the same frame period asked for again. */
+        finished_with_frame(s, &frame);
+        s->frames_discarded++;
+    }
+    /*endfor*/
+    if (s->scaling)
+        return out_len + time_scale(&s->time_scale, &amp[out_len], s->frame, len);
+    /*endif*/
+    return out_len + len;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) playout_rx_set_rate(playout_rx_state_t *s, float rate)
+{
+    if (rate < 0.5f  ||  rate > 2.0f)
+        return -1;
+    /*endif*/
+    time_scale_rate(&s->time_scale, rate);
+    /* The time scaler treats rates very close to 1.0 as exactly 1.0 */
+    s->rate = s->time_scale.playout_rate;
+    if (s->rate != 1.0f)
+        s->scaling = true;
+    /*endif*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(void) playout_rx_set_frame_handler(playout_rx_state_t *s, playout_rx_frame_handler_t handler, void *user_data)
+{
+    s->frame_handler = handler;
+    s->frame_user_data = user_data;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(logging_state_t *) playout_rx_get_logging_state(playout_rx_state_t *s)
+{
+    return &s->logging;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(playout_rx_state_t *) playout_rx_init(playout_rx_state_t *s,
+                                                   playout_state_t *playout,
+                                                   int coding,
+                                                   int bit_rate,
+                                                   int packing)
+{
+    int alloced;
+
+    if (coding < PLAYOUT_RX_LINEAR  ||  coding > PLAYOUT_RX_G726)
+        return NULL;
+    /*endif*/
+    alloced = false;
+    if (s == NULL)
+    {
+        if ((s = (playout_rx_state_t *) span_alloc(sizeof(*s))) == NULL)
+            return NULL;
+        /*endif*/
+        alloced = true;
+    }
+    /*endif*/
+    memset(s, 0, sizeof(*s));
+    span_log_init(&s->logging, SPAN_LOG_NONE, NULL);
+    span_log_set_protocol(&s->logging, "Playout");
+    s->playout = playout;
+    s->coding = coding;
+    if (coding == PLAYOUT_RX_G726)
+    {
+        if (g726_init(&s->g726, bit_rate, G726_ENCODING_LINEAR, packing) == NULL)
+        {
+            if (alloced)
+                span_free(s);
+            /*endif*/
+            return NULL;
+        }
+        /*endif*/
+        /* Unpacked codes take an octet each */
+        s->bits_per_sample = (packing == G726_PACKING_NONE)  ?  8  :  bit_rate/8000;
+    }
+    /*endif*/
+    plc_init(&s->plc);
+    time_scale_init(&s->time_scale, SAMPLE_RATE, 1.0f);
+    s->rate = 1.0f;
+    s->scaling = false;
+    return s;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) playout_rx_release(playout_rx_state_t *s)
+{
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) playout_rx_free(playout_rx_state_t *s)
+{
+    span_free(s);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+/*- End of file ------------------------------------------------------------*/
@@ -44,9 +44,17 @@
 
 #include "spandsp/private/queue.h"
 
+#include "atomic_ops.h"
+
+/* The queue is lock free for one writing thread and one reading thread. Each side
+   publishes its own pointer with a release store, once it has finished with the data,
+   and loads the other side's pointer with an acquire, so the writer's data is visible
+   to the reader before iptr moves past it, and the reader is done with the space
+   before optr frees it for the writer. */
+
 SPAN_DECLARE(int) queue_empty(queue_state_t *s)
 {
-    return (s->iptr == s->optr);
+    return (span_load_acquire(&s->iptr) == span_load_acquire(&s->optr));
 }
 /*- End of function --------------------------------------------------------*/
 
@@ -54,7 +62,7 @@ SPAN_DECLARE(int) queue_free_space(queue_state_t *s)
 {
     int len;
 
-    if ((len = s->optr - s->iptr - 1) < 0)
+    if ((len = span_load_acquire(&s->optr) - span_load_acquire(&s->iptr) - 1) < 0)
         len += s->len;
     /*endif*/
     return len;
@@ -65,7 +73,7 @@ SPAN_DECLARE(int) queue_contents(queue_state_t *s)
 {
     int len;
 
-    if ((len = s->iptr - s->optr) < 0)
+    if ((len = span_load_acquire(&s->iptr) - span_load_acquire(&s->optr)) < 0)
         len += s->len;
     /*endif*/
     return len;
@@ -74,7 +82,7 @@ SPAN_DECLARE(int) queue_contents(queue_state_t *s)
 
 SPAN_DECLARE(void) queue_flush(queue_state_t *s)
 {
-    s->optr = s->iptr;
+    span_store_release(&s->optr, span_load_acquire(&s->iptr));
 }
 /*- End of function --------------------------------------------------------*/
 
@@ -86,7 +94,7 @@ SPAN_DECLARE(int) queue_view(queue_state_t *s, uint8_t *buf, int len)
     int optr;
 
     /* Snapshot the values (although only iptr should be changeable during this processing) */
-    iptr = s->iptr;
+    iptr = span_load_acquire(&s->iptr);
     optr = s->optr;
     if ((real_len = iptr - optr) < 0)
         real_len += s->len;
@@ -137,7 +145,7 @@ SPAN_DECLARE(int) queue_read(queue_state_t *s, uint8_t *buf, int len)
     int optr;
 
     /* Snapshot the values (although only iptr should be changeable during this processing) */
-    iptr = s->iptr;
+    iptr = span_load_acquire(&s->iptr);
     optr = s->optr;
     if ((real_len = iptr - optr) < 0)
         real_len += s->len;
@@ -181,7 +189,7 @@ SPAN_DECLARE(int) queue_read(queue_state_t *s, uint8_t *buf, int len)
     }
     /*endif*/
     /* Only change the pointer now we have really finished */
-    s->optr = new_optr;
+    span_store_release(&s->optr, new_optr);
     return real_len;
 }
 /*- End of function --------------------------------------------------------*/
@@ -194,7 +202,7 @@ SPAN_DECLARE(int) queue_read_byte(queue_state_t *s)
     int byte;
 
     /* Snapshot the values (although only iptr should be changeable during this processing) */
-    iptr = s->iptr;
+    iptr = span_load_acquire(&s->iptr);
     optr = s->optr;
     if ((real_len = iptr - optr) < 0)
         real_len += s->len;
@@ -207,7 +215,7 @@ SPAN_DECLARE(int) queue_read_byte(queue_state_t *s)
         optr = 0;
     /*endif*/
     /* Only change the pointer now we have really finished */
-    s->optr = optr;
+    span_store_release(&s->optr, optr);
     return byte;
 }
 /*- End of function --------------------------------------------------------*/
@@ -222,7 +230,7 @@ SPAN_DECLARE(int) queue_write(queue_state_t *s, const uint8_t *buf, int len)
 
     /* Snapshot the values (although only optr should be changeable during this processing) */
     iptr = s->iptr;
-    optr = s->optr;
+    optr = span_load_acquire(&s->optr);
 
     if ((real_len = optr - iptr - 1) < 0)
         real_len += s->len;
@@ -260,7 +268,7 @@ SPAN_DECLARE(int) queue_write(queue_state_t *s, const uint8_t *buf, int len)
     }
     /*endif*/
     /* Only change the pointer now we have really finished */
-    s->iptr = new_iptr;
+    span_store_release(&s->iptr, new_iptr);
     return real_len;
 }
 /*- End of function --------------------------------------------------------*/
@@ -273,7 +281,7 @@ SPAN_DECLARE(int) queue_write_byte(queue_state_t *s, uint8_t byte)
 
     /* Snapshot the values (although only optr should be changeable during this processing) */
     iptr = s->iptr;
-    optr = s->optr;
+    optr = span_load_acquire(&s->optr);
 
     if ((real_len = optr - iptr - 1) < 0)
         real_len += s->len;
@@ -291,7 +299,7 @@ SPAN_DECLARE(int) queue_write_byte(queue_state_t *s, uint8_t byte)
         iptr = 0;
     /*endif*/
     /* Only change the pointer now we have really finished */
-    s->iptr = iptr;
+    span_store_release(&s->iptr, iptr);
     return 1;
 }
 /*- End of function --------------------------------------------------------*/
@@ -344,7 +352,7 @@ SPAN_DECLARE(int) queue_write_msg(queue_state_t *s, const uint8_t *buf, int len)
 
     /* Snapshot the values (although only optr should be changeable during this processing) */
     iptr = s->iptr;
-    optr = s->optr;
+    optr = span_load_acquire(&s->optr);
 
     if ((real_len = optr - iptr - 1) < 0)
         real_len += s->len;
@@ -387,7 +395,7 @@ SPAN_DECLARE(int) queue_write_msg(queue_state_t *s, const uint8_t *buf, int len)
     }
     /*endif*/
     /* Only change the pointer now we have really finished */
-    s->iptr = new_iptr;
+    span_store_release(&s->iptr, new_iptr);
     return len;
 }
 /*- End of function --------------------------------------------------------*/
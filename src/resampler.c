@@ -0,0 +1,298 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * resampler.c - Polyphase sample rate conversion.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2013 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 2.1,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \file */
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#if defined(HAVE_TGMATH_H)
+#include <tgmath.h>
+#endif
+#if defined(HAVE_MATH_H)
+#include <math.h>
+#endif
+#if defined(HAVE_STDBOOL_H)
+#include <stdbool.h>
+#else
+#include "spandsp/stdbool.h"
+#endif
+#include "floating_fudge.h"
+
+#include "spandsp/telephony.h"
+#include "spandsp/alloc.h"
+#include "spandsp/fast_convert.h"
+#include "spandsp/saturated.h"
+#include "spandsp/vector_int.h"
+#include "spandsp/resampler.h"
+
+#include "spandsp/private/resampler.h"
+
+/* The Kaiser window beta, giving about 70dB of stopband rejection */
+#define KAISER_BETA         7.0
+/* The filter cutoff, as a fraction of the lower of the two sample rates */
+#define CUTOFF_FRACTION     0.475
+/* The coefficients are Q14. The sum of the magnitudes of a phase's coefficients can be
+   as much as 2.5, so Q15 could overflow the dot product with full scale input. */
+#define COEFF_SHIFT         14
+/* Rounding to Q14 alone limits the stopband rejection of the longer filters to about
+   60dB. The rounding error of each coefficient is kept as a second coefficient, in
+   units of 2^-7 of the Q14 step, and applied by a second dot product. These are no
+   more than 64 in magnitude, so that dot product cannot overflow either. */
+#define COEFF_FINE_SHIFT    7
+
+static int gcd(int a, int b)
+{
+    int c;
+
+    while (b)
+    {
+        c = a%b;
+        a = b;
+        b = c;
+    }
+    /*endwhile*/
+    return a;
+}
+/*- End of function --------------------------------------------------------*/
+
+static double bessel_i0(double x)
+{
+    double sum;
+    double term;
+    int k;
+
+    sum = 1.0;
+    term = 1.0;
+    for (k = 1;  k < 50;  k++)
+    {
+        term *= (x/(2.0*k))*(x/(2.0*k));
+        sum += term;
+        if (term < sum*1.0e-12)
+            break;
+        /*endif*/
+    }
+    /*endfor*/
+    return sum;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void make_filter(resampler_state_t *s)
+{
+    double proto[RESAMPLER_MAX_COEFFS];
+    double cutoff;
+    double centre;
+    double x;
+    double w;
+    double sum;
+    double coeff;
+    int min_rate;
+    int len;
+    int phase;
+    int i;
+
+    /* Design the prototype lowpass filter at the interpolated rate */
+    len = s->interpolation*s->taps;
+    min_rate = (s->in_rate < s->out_rate)  ?  s->in_rate  :  s->out_rate;
+    cutoff = CUTOFF_FRACTION*min_rate/((double) s->in_rate*s->interpolation);
+    centre = (len - 1)/2.0;
+    for (i = 0;  i < len;  i++)
+    {
+        x = i - centre;
+        proto[i] = (x == 0.0)  ?  2.0*cutoff  :  sin(2.0*3.1415926535897932*cutoff*x)/(3.1415926535897932*x);
+        w = 2.0*x/(len - 1);
+        proto[i] *= bessel_i0(KAISER_BETA*sqrt(1.0 - w*w))/bessel_i0(KAISER_BETA);
+    }
+    /*endfor*/
+    /* Split it into its phases, scaling each phase for unity gain at DC. Each phase is
+       reversed, so it can be applied to the history with a plain dot product. */
+    for (phase = 0;  phase < s->interpolation;  phase++)
+    {
+        sum = 0.0;
+        for (i = 0;  i < s->taps;  i++)
+            sum += proto[phase + i*s->interpolation];
+        /*endfor*/
+        for (i = 0;  i < s->taps;  i++)
+        {
+            coeff = (1 << COEFF_SHIFT)*proto[phase + i*s->interpolation]/sum;
+            s->coeffs[phase*s->taps + s->taps - 1 - i] = (int16_t) lrint(coeff);
+            s->fine_coeffs[phase*s->taps + s->taps - 1 - i] = (int16_t) lrint((coeff - lrint(coeff))*(1 << COEFF_FINE_SHIFT));
+        }
+        /*endfor*/
+    }
+    /*endfor*/
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) resampler(resampler_state_t *s, int16_t out[], const int16_t amp[], int len)
+{
+    int64_t acc;
+    int chunk;
+    int limit;
+    int outputs;
+    int i;
+
+    if (s->interpolation == s->decimation)
+    {
+        /* The rates are the same */
+        memcpy(out, amp, len*sizeof(int16_t));
+        return len;
+    }
+    /*endif*/
+    outputs = 0;
+    for (i = 0;  i < len;  i += chunk)
+    {
+        chunk = len - i;
+        if (chunk > RESAMPLER_BLOCK_LEN)
+            chunk = RESAMPLER_BLOCK_LEN;
+        /*endif*/
+        memcpy(&s->history[s->taps - 1], &amp[i], chunk*sizeof(int16_t));
+        limit = s->taps - 1 + chunk;
+        while (s->pos < limit)
+        {
+            acc = (int64_t) vec_dot_prodi16(&s->history[s->pos - s->taps + 1], &s->coeffs[s->phase*s->taps], s->taps) << COEFF_FINE_SHIFT;
+            acc += vec_dot_prodi16(&s->history[s->pos - s->taps + 1], &s->fine_coeffs[s->phase*s->taps], s->taps);
+            out[outputs++] = saturate16((int32_t) ((acc + (1 << (COEFF_SHIFT + COEFF_FINE_SHIFT - 1))) >> (COEFF_SHIFT + COEFF_FINE_SHIFT)));
+            s->phase += s->decimation;
+            s->pos += s->phase/s->interpolation;
+            s->phase %= s->interpolation;
+        }
+        /*endwhile*/
+        memmove(s->history, &s->history[chunk], (s->taps - 1)*sizeof(int16_t));
+        s->pos -= chunk;
+    }
+    /*endfor*/
+    return outputs;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) resampler_rx(resampler_state_t *s, span_rx_handler_t handler, void *user_data, const int16_t amp[], int len)
+{
+    int16_t buf[RESAMPLER_BLOCK_LEN];
+    int chunk;
+    int max_chunk;
+    int outputs;
+    int i;
+
+    /* Take the input in pieces which cannot produce more than a buffer full of output */
+    max_chunk = RESAMPLER_BLOCK_LEN*s->decimation/s->interpolation;
+    for (i = 0;  i < len;  i += chunk)
+    {
+        chunk = len - i;
+        if (chunk > max_chunk)
+            chunk = max_chunk;
+        /*endif*/
+        if ((outputs = resampler(s, buf, &amp[i], chunk)) > 0)
+            handler(user_data, buf, outputs);
+        /*endif*/
+    }
+    /*endfor*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) resampler_max_output(resampler_state_t *s, int len)
+{
+    return (len*s->interpolation + s->decimation - 1)/s->decimation;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) resampler_get_delay(resampler_state_t *s)
+{
+    if (s->interpolation == s->decimation)
+        return 0;
+    /*endif*/
+    /* Half the prototype filter, which runs at the interpolated rate */
+    return (s->interpolation*s->taps/2 + s->decimation/2)/s->decimation;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) resampler_restart(resampler_state_t *s)
+{
+    memset(s->history, 0, sizeof(s->history));
+    s->phase = 0;
+    s->pos = s->taps - 1;
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(resampler_state_t *) resampler_init(resampler_state_t *s, int in_rate, int out_rate)
+{
+    int interpolation;
+    int decimation;
+    int factor;
+    int i;
+
+    if (in_rate <= 0  ||  out_rate <= 0)
+        return NULL;
+    /*endif*/
+    i = gcd(in_rate, out_rate);
+    interpolation = out_rate/i;
+    decimation = in_rate/i;
+    if (interpolation > RESAMPLER_MAX_FACTOR  ||  decimation > RESAMPLER_MAX_FACTOR)
+        return NULL;
+    /*endif*/
+    if (s == NULL)
+    {
+        if ((s = (resampler_state_t *) span_alloc(sizeof(*s))) == NULL)
+            return NULL;
+        /*endif*/
+    }
+    /*endif*/
+    memset(s, 0, sizeof(*s));
+    s->in_rate = in_rate;
+    s->out_rate = out_rate;
+    s->interpolation = interpolation;
+    s->decimation = decimation;
+    factor = (interpolation > decimation)  ?  interpolation  :  decimation;
+    s->taps = (RESAMPLER_FILTER_SPAN*factor + interpolation - 1)/interpolation;
+    if (interpolation != decimation)
+        make_filter(s);
+    /*endif*/
+    resampler_restart(s);
+    return s;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) resampler_release(resampler_state_t *s)
+{
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) resampler_free(resampler_state_t *s)
+{
+    if (s)
+        span_free(s);
+    /*endif*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+/*- End of file ------------------------------------------------------------*/
@@ -54,7 +54,7 @@ SPAN_DECLARE(int) span_schedule_event(span_sched_state_t *s, int us, span_sched_
     if (i >= s->allocated)
     {
         s->allocated += 5;
-        s->sched = (span_sched_t *) realloc(s->sched, sizeof(span_sched_t)*s->allocated);
+        s->sched = (span_sched_t *) span_realloc(s->sched, sizeof(span_sched_t)*s->allocated);
     }
     /*endif*/
     if (i >= s->max_to_date)
@@ -0,0 +1,420 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * simd.h - A thin portable layer over the SIMD instruction sets, for the DSP kernels.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2014 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 2.1,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/* The vectorised kernels are written once, against the types and operations below,
+   rather than against any one instruction set. A register holds SIMD_F32_LANES floats,
+   or SIMD_I16_LANES 16 bit integers, or half that many 32 bit integers, and a kernel
+   steps through its data by that many elements, finishing any remainder with plain C.
+   The loads and stores do not need aligned data.
+
+   The backend is chosen from the configure settings:
+
+       AVX2        8 floats, 16 int16s     SPANDSP_USE_AVX2
+       SSE2        4 floats, 8 int16s      SPANDSP_USE_SSE2
+       scalar      4 floats, 8 int16s      anything else
+
+   The scalar backend is plain C on small arrays, which a compiler will often vectorise
+   by itself. It gives the same results as the others, so defining SPANDSP_SIMD_SCALAR
+   when building lets the kernels be checked on any machine. The floating point sums
+   are formed in lane order, so they can differ from a serial sum in the last few bits,
+   and between backends of different widths. */
+
+#if !defined(_SPANDSP_SIMD_H_)
+#define _SPANDSP_SIMD_H_
+
+#if defined(SPANDSP_SIMD_SCALAR)
+#define SPANDSP_SIMD_BACKEND_SCALAR
+#elif defined(__GNUC__)  &&  defined(SPANDSP_USE_AVX2)  &&  defined(__AVX2__)
+#define SPANDSP_SIMD_BACKEND_AVX2
+#elif defined(__GNUC__)  &&  defined(SPANDSP_USE_SSE2)
+#define SPANDSP_SIMD_BACKEND_SSE2
+#else
+#define SPANDSP_SIMD_BACKEND_SCALAR
+#endif
+
+#if defined(SPANDSP_SIMD_BACKEND_AVX2)
+
+#include <immintrin.h>
+
+#define SIMD_BACKEND_NAME   "AVX2"
+#define SIMD_F32_LANES      8
+#define SIMD_I16_LANES      16
+
+typedef __m256 simd_f32_t;
+typedef __m256i simd_i16_t;
+typedef __m256i simd_i32_t;
+
+static __inline__ simd_f32_t simd_loadu_f32(const float x[])
+{
+    return _mm256_loadu_ps(x);
+}
+
+static __inline__ void simd_storeu_f32(float z[], simd_f32_t a)
+{
+    _mm256_storeu_ps(z, a);
+}
+
+static __inline__ simd_f32_t simd_set1_f32(float x)
+{
+    return _mm256_set1_ps(x);
+}
+
+static __inline__ simd_f32_t simd_zero_f32(void)
+{
+    return _mm256_setzero_ps();
+}
+
+static __inline__ simd_f32_t simd_add_f32(simd_f32_t a, simd_f32_t b)
+{
+    return _mm256_add_ps(a, b);
+}
+
+static __inline__ simd_f32_t simd_sub_f32(simd_f32_t a, simd_f32_t b)
+{
+    return _mm256_sub_ps(a, b);
+}
+
+static __inline__ simd_f32_t simd_mul_f32(simd_f32_t a, simd_f32_t b)
+{
+    return _mm256_mul_ps(a, b);
+}
+
+static __inline__ simd_f32_t simd_neg_f32(simd_f32_t a)
+{
+    return _mm256_xor_ps(a, _mm256_set1_ps(-0.0f));
+}
+
+static __inline__ float simd_hsum_f32(simd_f32_t a)
+{
+    __m128 b;
+
+    b = _mm_add_ps(_mm256_castps256_ps128(a), _mm256_extractf128_ps(a, 1));
+    b = _mm_add_ps(_mm_movehl_ps(b, b), b);
+    b = _mm_add_ss(_mm_shuffle_ps(b, b, 1), b);
+    return _mm_cvtss_f32(b);
+}
+
+static __inline__ simd_i16_t simd_loadu_i16(const int16_t x[])
+{
+    return _mm256_loadu_si256((const __m256i *) x);
+}
+
+static __inline__ simd_i16_t simd_min_i16(simd_i16_t a, simd_i16_t b)
+{
+    return _mm256_min_epi16(a, b);
+}
+
+static __inline__ simd_i16_t simd_max_i16(simd_i16_t a, simd_i16_t b)
+{
+    return _mm256_max_epi16(a, b);
+}
+
+static __inline__ void simd_storeu_i16(int16_t z[], simd_i16_t a)
+{
+    _mm256_storeu_si256((__m256i *) z, a);
+}
+
+static __inline__ simd_i32_t simd_zero_i32(void)
+{
+    return _mm256_setzero_si256();
+}
+
+static __inline__ simd_i32_t simd_madd_i16(simd_i32_t acc, simd_i16_t a, simd_i16_t b)
+{
+    return _mm256_add_epi32(acc, _mm256_madd_epi16(a, b));
+}
+
+static __inline__ int32_t simd_hsum_i32(simd_i32_t a)
+{
+    __m128i b;
+
+    b = _mm_add_epi32(_mm256_castsi256_si128(a), _mm256_extracti128_si256(a, 1));
+    b = _mm_add_epi32(b, _mm_srli_si128(b, 8));
+    b = _mm_add_epi32(b, _mm_srli_si128(b, 4));
+    return _mm_cvtsi128_si32(b);
+}
+
+#elif defined(SPANDSP_SIMD_BACKEND_SSE2)
+
+#include "mmx_sse_decs.h"
+
+#define SIMD_BACKEND_NAME   "SSE2"
+#define SIMD_F32_LANES      4
+#define SIMD_I16_LANES      8
+
+typedef __m128 simd_f32_t;
+typedef __m128i simd_i16_t;
+typedef __m128i simd_i32_t;
+
+static __inline__ simd_f32_t simd_loadu_f32(const float x[])
+{
+    return _mm_loadu_ps(x);
+}
+
+static __inline__ void simd_storeu_f32(float z[], simd_f32_t a)
+{
+    _mm_storeu_ps(z, a);
+}
+
+static __inline__ simd_f32_t simd_set1_f32(float x)
+{
+    return _mm_set1_ps(x);
+}
+
+static __inline__ simd_f32_t simd_zero_f32(void)
+{
+    return _mm_setzero_ps();
+}
+
+static __inline__ simd_f32_t simd_add_f32(simd_f32_t a, simd_f32_t b)
+{
+    return _mm_add_ps(a, b);
+}
+
+static __inline__ simd_f32_t simd_sub_f32(simd_f32_t a, simd_f32_t b)
+{
+    return _mm_sub_ps(a, b);
+}
+
+static __inline__ simd_f32_t simd_mul_f32(simd_f32_t a, simd_f32_t b)
+{
+    return _mm_mul_ps(a, b);
+}
+
+static __inline__ simd_f32_t simd_neg_f32(simd_f32_t a)
+{
+    return _mm_xor_ps(a, _mm_set1_ps(-0.0f));
+}
+
+static __inline__ float simd_hsum_f32(simd_f32_t a)
+{
+    a = _mm_add_ps(_mm_movehl_ps(a, a), a);
+    a = _mm_add_ss(_mm_shuffle_ps(a, a, 1), a);
+    return _mm_cvtss_f32(a);
+}
+
+static __inline__ simd_i16_t simd_loadu_i16(const int16_t x[])
+{
+    return _mm_loadu_si128((const __m128i *) x);
+}
+
+static __inline__ void simd_storeu_i16(int16_t z[], simd_i16_t a)
+{
+    _mm_storeu_si128((__m128i *) z, a);
+}
+
+static __inline__ simd_i16_t simd_min_i16(simd_i16_t a, simd_i16_t b)
+{
+    return _mm_min_epi16(a, b);
+}
+
+static __inline__ simd_i16_t simd_max_i16(simd_i16_t a, simd_i16_t b)
+{
+    return _mm_max_epi16(a, b);
+}
+
+static __inline__ simd_i32_t simd_zero_i32(void)
+{
+    return _mm_setzero_si128();
+}
+
+static __inline__ simd_i32_t simd_madd_i16(simd_i32_t acc, simd_i16_t a, simd_i16_t b)
+{
+    return _mm_add_epi32(acc, _mm_madd_epi16(a, b));
+}
+
+static __inline__ int32_t simd_hsum_i32(simd_i32_t a)
+{
+    a = _mm_add_epi32(a, _mm_srli_si128(a, 8));
+    a = _mm_add_epi32(a, _mm_srli_si128(a, 4));
+    return _mm_cvtsi128_si32(a);
+}
+
+#else
+
+#define SIMD_BACKEND_NAME   "scalar"
+#define SIMD_F32_LANES      4
+#define SIMD_I16_LANES      8
+
+typedef struct
+{
+    float v[SIMD_F32_LANES];
+} simd_f32_t;
+
+typedef struct
+{
+    int16_t v[SIMD_I16_LANES];
+} simd_i16_t;
+
+typedef struct
+{
+    int32_t v[SIMD_I16_LANES/2];
+} simd_i32_t;
+
+static __inline__ simd_f32_t simd_loadu_f32(const float x[])
+{
+    simd_f32_t z;
+    int i;
+
+    for (i = 0;  i < SIMD_F32_LANES;  i++)
+        z.v[i] = x[i];
+    return z;
+}
+
+static __inline__ void simd_storeu_f32(float z[], simd_f32_t a)
+{
+    int i;
+
+    for (i = 0;  i < SIMD_F32_LANES;  i++)
+        z[i] = a.v[i];
+}
+
+static __inline__ simd_f32_t simd_set1_f32(float x)
+{
+    simd_f32_t z;
+    int i;
+
+    for (i = 0;  i < SIMD_F32_LANES;  i++)
+        z.v[i] = x;
+    return z;
+}
+
+static __inline__ simd_f32_t simd_zero_f32(void)
+{
+    return simd_set1_f32(0.0f);
+}
+
+static __inline__ simd_f32_t simd_add_f32(simd_f32_t a, simd_f32_t b)
+{
+    int i;
+
+    for (i = 0;  i < SIMD_F32_LANES;  i++)
+        a.v[i] += b.v[i];
+    return a;
+}
+
+static __inline__ simd_f32_t simd_sub_f32(simd_f32_t a, simd_f32_t b)
+{
+    int i;
+
+    for (i = 0;  i < SIMD_F32_LANES;  i++)
+        a.v[i] -= b.v[i];
+    return a;
+}
+
+static __inline__ simd_f32_t simd_mul_f32(simd_f32_t a, simd_f32_t b)
+{
+    int i;
+
+    for (i = 0;  i < SIMD_F32_LANES;  i++)
+        a.v[i] *= b.v[i];
+    return a;
+}
+
+static __inline__ simd_f32_t simd_neg_f32(simd_f32_t a)
+{
+    int i;
+
+    for (i = 0;  i < SIMD_F32_LANES;  i++)
+        a.v[i] = -a.v[i];
+    return a;
+}
+
+static __inline__ float simd_hsum_f32(simd_f32_t a)
+{
+    /* Pairwise, in the same order as the SSE2 backend */
+    return (a.v[0] + a.v[2]) + (a.v[1] + a.v[3]);
+}
+
+static __inline__ simd_i16_t simd_loadu_i16(const int16_t x[])
+{
+    simd_i16_t z;
+    int i;
+
+    for (i = 0;  i < SIMD_I16_LANES;  i++)
+        z.v[i] = x[i];
+    return z;
+}
+
+static __inline__ void simd_storeu_i16(int16_t z[], simd_i16_t a)
+{
+    int i;
+
+    for (i = 0;  i < SIMD_I16_LANES;  i++)
+        z[i] = a.v[i];
+}
+
+static __inline__ simd_i16_t simd_min_i16(simd_i16_t a, simd_i16_t b)
+{
+    int i;
+
+    for (i = 0;  i < SIMD_I16_LANES;  i++)
+    {
+        if (b.v[i] < a.v[i])
+            a.v[i] = b.v[i];
+    }
+    return a;
+}
+
+static __inline__ simd_i16_t simd_max_i16(simd_i16_t a, simd_i16_t b)
+{
+    int i;
+
+    for (i = 0;  i < SIMD_I16_LANES;  i++)
+    {
+        if (b.v[i] > a.v[i])
+            a.v[i] = b.v[i];
+    }
+    return a;
+}
+
+static __inline__ simd_i32_t simd_zero_i32(void)
+{
+    simd_i32_t z;
+    int i;
+
+    for (i = 0;  i < SIMD_I16_LANES/2;  i++)
+        z.v[i] = 0;
+    return z;
+}
+
+static __inline__ simd_i32_t simd_madd_i16(simd_i32_t acc, simd_i16_t a, simd_i16_t b)
+{
+    int i;
+
+    for (i = 0;  i < SIMD_I16_LANES/2;  i++)
+        acc.v[i] += (int32_t) a.v[2*i]*b.v[2*i] + (int32_t) a.v[2*i + 1]*b.v[2*i + 1];
+    return acc;
+}
+
+static __inline__ int32_t simd_hsum_i32(simd_i32_t a)
+{
+    return (a.v[0] + a.v[2]) + (a.v[1] + a.v[3]);
+}
+
+#endif
+
+#endif
+/*- End of include ---------------------------------------------------------*/
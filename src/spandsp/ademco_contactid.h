@@ -286,6 +286,25 @@ typedef struct ademco_contactid_sender_state_s ademco_contactid_sender_state_t;
 
 typedef struct ademco_contactid_receiver_state_s ademco_contactid_receiver_state_t;
 
+typedef struct ademco_contactid_receiver_bank_state_s ademco_contactid_receiver_bank_state_t;
+
+/*!
+    Ademco ContactID receiver statistics. The latency of a message is the time from the
+    receiver being ready for it (i.e. the end of the handshake, or of the previous kissoff)
+    to the start of the kissoff which acknowledges it.
+*/
+typedef struct
+{
+    /*! \brief The number of messages acknowledged with a kissoff. */
+    int messages;
+    /*! \brief The shortest message latency, in samples. */
+    int min_latency;
+    /*! \brief The longest message latency, in samples. */
+    int max_latency;
+    /*! \brief The total of the message latencies, in samples. */
+    int64_t total_latency;
+} ademco_contactid_receiver_stats_t;
+
 typedef struct
 {
     int acct;
@@ -333,6 +352,54 @@ SPAN_DECLARE(int) ademco_contactid_receiver_release(ademco_contactid_receiver_st
 
 SPAN_DECLARE(int) ademco_contactid_receiver_free(ademco_contactid_receiver_state_t *s);
 
+/*! Get the latency statistics of an Ademco ContactID receiver.
+    \brief Get the latency statistics of an Ademco ContactID receiver.
+    \param s The receiver context.
+    \param stats The statistics. */
+SPAN_DECLARE(void) ademco_contactid_receiver_get_stats(ademco_contactid_receiver_state_t *s, ademco_contactid_receiver_stats_t *stats);
+
+/*! Process a block of received audio samples for each line of a bank of Ademco ContactID
+    receivers. The DTMF detection for the lines is batched, which is considerably faster
+    than calling ademco_contactid_receiver_rx() for each line.
+    \brief Process a block of received audio samples for a bank of receivers.
+    \param s The receiver bank context.
+    \param amp An array of audio sample buffers, one per line. A NULL entry skips that line.
+    \param samples The number of samples in each buffer.
+    \return The number of samples unprocessed. */
+SPAN_DECLARE(int) ademco_contactid_receiver_bank_rx(ademco_contactid_receiver_bank_state_t *s, const int16_t *amp[], int samples);
+
+/*! Get the receiver context for one line of a bank of Ademco ContactID receivers. This
+    should be used to generate the line's transmitted audio, with ademco_contactid_receiver_tx(),
+    and to adjust its logging and callbacks.
+    \brief Get the receiver context for one line of a receiver bank.
+    \param s The receiver bank context.
+    \param line The line number, starting from zero.
+    \return A pointer to the receiver context, or NULL for an invalid line number. */
+SPAN_DECLARE(ademco_contactid_receiver_state_t *) ademco_contactid_receiver_bank_get_line(ademco_contactid_receiver_bank_state_t *s, int line);
+
+/*! Get the aggregated latency statistics of all the lines in a bank of Ademco ContactID receivers.
+    \brief Get the aggregated latency statistics of a receiver bank.
+    \param s The receiver bank context.
+    \param stats The statistics. */
+SPAN_DECLARE(void) ademco_contactid_receiver_bank_get_stats(ademco_contactid_receiver_bank_state_t *s, ademco_contactid_receiver_stats_t *stats);
+
+/*! Initialise a bank of Ademco ContactID receivers, such as those of an alarm receiving centre
+    with many incoming lines.
+    \brief Initialise a bank of Ademco ContactID receivers.
+    \param s The receiver bank context.
+    \param lines The number of lines.
+    \param callback The function called for each received report.
+    \param user_data An array of opaque pointers, one per line, passed to the callback. This may be NULL.
+    \return A pointer to the receiver bank context, or NULL if there was a problem. */
+SPAN_DECLARE(ademco_contactid_receiver_bank_state_t *) ademco_contactid_receiver_bank_init(ademco_contactid_receiver_bank_state_t *s,
+                                                                                           int lines,
+                                                                                           ademco_contactid_report_func_t callback,
+                                                                                           void *user_data[]);
+
+SPAN_DECLARE(int) ademco_contactid_receiver_bank_release(ademco_contactid_receiver_bank_state_t *s);
+
+SPAN_DECLARE(int) ademco_contactid_receiver_bank_free(ademco_contactid_receiver_bank_state_t *s);
+
 
 
 SPAN_DECLARE(int) ademco_contactid_sender_tx(ademco_contactid_sender_state_t *s, int16_t amp[], int max_samples);
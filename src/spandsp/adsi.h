@@ -67,6 +67,11 @@ in various formats. Currently, the supported formats are:
 
     - TDD (Telecommunications Device for the Deaf).
 
+Where many lines must be monitored at once, as in a subscriber line gateway, a bank of
+receivers can be used. All the channels in a bank use the same standard. For the FSK
+standards the channels share the tone generators used by the FSK correlators, and the
+received bits are handled a block at a time, rather than through a callback per bit.
+
 \section adsi_page_sec_2 How does it work?
 
 \section adsi_page_sec_2a The Bellcore CLASS specification
@@ -385,6 +390,12 @@ typedef struct adsi_tx_state_s adsi_tx_state_t;
  */
 typedef struct adsi_rx_state_s adsi_rx_state_t;
 
+/*!
+    ADSI receiver bank descriptor. This contains all the state information for a bank
+    of ADSI receive channels, all using the same standard.
+ */
+typedef struct adsi_rx_bank_state_s adsi_rx_bank_state_t;
+
 #if defined(__cplusplus)
 extern "C"
 {
@@ -429,6 +440,52 @@ SPAN_DECLARE(int) adsi_rx_free(adsi_rx_state_t *s);
 */
 SPAN_DECLARE(int) adsi_rx(adsi_rx_state_t *s, const int16_t amp[], int len);
 
+/*! \brief Initialise a bank of ADSI receive channels.
+    \param s The ADSI receive bank context.
+    \param standard The code for the ADSI standard to be used by all the channels.
+    \param channels The number of channels in the bank.
+    \param put_msg A callback routine called to deliver the received messages
+           to the application.
+    \param user_data An array of opaque pointers for the callback routine, one per
+           channel. This may be NULL.
+    \return A pointer to the initialised context, or NULL if there was a problem.
+*/
+SPAN_DECLARE(adsi_rx_bank_state_t *) adsi_rx_bank_init(adsi_rx_bank_state_t *s,
+                                                       int standard,
+                                                       int channels,
+                                                       put_msg_func_t put_msg,
+                                                       void *user_data[]);
+
+/*! \brief Release a bank of ADSI receive channels.
+    \param s The ADSI receive bank context.
+    \return 0 for OK.
+*/
+SPAN_DECLARE(int) adsi_rx_bank_release(adsi_rx_bank_state_t *s);
+
+/*! \brief Free a bank of ADSI receive channels.
+    \param s The ADSI receive bank context.
+    \return 0 for OK.
+*/
+SPAN_DECLARE(int) adsi_rx_bank_free(adsi_rx_bank_state_t *s);
+
+/*! \brief Get the receive context of one channel of an ADSI receive bank. This may
+           be used with adsi_next_field() to break down the received messages, or to
+           access the channel's logging.
+    \param s The ADSI receive bank context.
+    \param channel The channel number.
+    \return A pointer to the channel's receive context, or NULL for a bad channel number.
+*/
+SPAN_DECLARE(adsi_rx_state_t *) adsi_rx_bank_get_channel(adsi_rx_bank_state_t *s, int channel);
+
+/*! \brief Receive a chunk of ADSI audio on every channel of an ADSI receive bank.
+    \param s The ADSI receive bank context.
+    \param amp An array of audio sample buffers, one per channel. A NULL entry means the
+           channel is not receiving, and it is skipped.
+    \param len The number of samples in each buffer.
+    \return The number of samples unprocessed.
+*/
+SPAN_DECLARE(int) adsi_rx_bank(adsi_rx_bank_state_t *s, const int16_t *amp[], int len);
+
 /*! Get the logging context associated with an ADSI transmit context.
     \brief Get the logging context associated with an ADSI transmit context.
     \param s The ADSI transmit context.
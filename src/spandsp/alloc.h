@@ -35,6 +35,18 @@
       by alligned allocation functions. We use a separate aligned_free function
       on all platforms, for compatibility, even though it may simply reduce to
       free().
+    - An allocation context may be set for each thread. Memory allocated by that
+      thread through span_alloc(), span_realloc() or span_aligned_alloc() is then
+      placed according to the context - on a chosen NUMA node, and/or in huge
+      pages. A worker thread which sets its context before creating its channels
+      keeps the state of those channels, and the buffers their init functions
+      allocate (e.g. echo canceller history), local to the node it runs on. The
+      placement is only a hint. The memory is still freed in the usual way, and
+      placement is quietly skipped where the OS does not support it.
+    - Memory allocated under a context comes from a pool kept for that placement,
+      made of large chunks which are placed as a whole when the pool grows. Freed
+      blocks go back to their pool, rather than to the normal allocator. The pools
+      bypass any custom allocators set with span_mem_allocators().
  */
   
 typedef void *(*span_aligned_alloc_t)(size_t alignment, size_t size);
@@ -43,6 +55,15 @@ typedef void *(*span_alloc_t)(size_t size);
 typedef void *(*span_realloc_t)(void *ptr, size_t size);
 typedef void (*span_free_t)(void *ptr);
 
+/*! Memory placement preferences for an allocation context. */
+typedef struct
+{
+    /*! \brief The NUMA node on which memory should be placed, or -1 for no preference. */
+    int numa_node;
+    /*! \brief Non-zero if memory should be placed in huge pages, where possible. */
+    int huge_pages;
+} span_alloc_context_t;
+
 #if defined(__cplusplus)
 extern "C"
 {
@@ -68,7 +89,25 @@ SPAN_DECLARE(int) span_mem_allocators(span_alloc_t custom_alloc,
                                       span_free_t custom_free,
                                       span_aligned_alloc_t custom_aligned_alloc,
                                       span_aligned_free_t custom_aligned_free);
-                                      
+
+/*! \brief Set the allocation context for memory allocated by the calling thread.
+    \param context The placement preferences. NULL restores the default placement.
+    \return 0 for OK. */
+SPAN_DECLARE(int) span_mem_set_context(const span_alloc_context_t *context);
+
+/*! \brief Get the allocation context for memory allocated by the calling thread.
+    \return The placement preferences, or NULL if the default placement is in use. */
+SPAN_DECLARE(const span_alloc_context_t *) span_mem_get_context(void);
+
+/*! \brief Apply placement preferences to an existing block of memory. Only the whole
+           pages within the block are affected. This may be used for memory an
+           application allocates itself, such as an array of channel states.
+    \param ptr The start of the block.
+    \param size The size of the block, in bytes.
+    \param context The placement preferences.
+    \return 0 for OK, or -1 if the placement could not be applied. */
+SPAN_DECLARE(int) span_mem_place(void *ptr, size_t size, const span_alloc_context_t *context);
+
 #if defined(__cplusplus)
 }
 #endif
@@ -37,6 +37,11 @@ formats. It supports:
 The input to this module is a bit stream. This means any symbol synchronisation
 and decoding must occur before data is fed to this module.
 
+Bits may be handled one at a time, through callbacks which plug directly into
+the modems, or in blocks of bits packed into bytes. The block functions frame or
+deframe each whole character in a single step, so they are much cheaper per bit.
+The two styles may be mixed freely on one bit stream.
+
 \section async_page_sec_2 The transmitter
 ???.
 
@@ -161,6 +166,16 @@ SPAN_DECLARE(const char *) signal_status_to_str(int status);
         - SIG_STATUS_END_OF_DATA */
 SPAN_DECLARE_NONSTD(void) async_rx_put_bit(void *user_data, int bit);
 
+/*! Accept a block of bits from a received serial bit stream. The result is the same
+    as passing each bit to async_rx_put_bit(), but whole characters are deframed in
+    one step, and idle marking is skipped a byte at a time.
+    \brief Accept a block of bits from a received serial bit stream.
+    \param s The receiver context.
+    \param bits The bits, packed LSB first, so the first bit received is bit 0 of bits[0].
+    \param len The number of bits.
+    \return 0. */
+SPAN_DECLARE(int) async_rx_put_bits(async_rx_state_t *s, const uint8_t bits[], int len);
+
 /*! Initialise an asynchronous data receiver context.
     \brief Initialise an asynchronous data receiver context.
     \param s The receiver context.
@@ -189,6 +204,28 @@ SPAN_DECLARE(int) async_rx_free(async_rx_state_t *s);
     \return the next bit, or PUTBIT_END_OF_DATA to indicate the data stream has ended. */
 SPAN_DECLARE_NONSTD(int) async_tx_get_bit(void *user_data);
 
+/*! Get a block of bits of a transmitted serial bit stream. The result is the same as
+    calling async_tx_get_bit() for each bit, but whole characters are framed in one step.
+    \brief Get a block of bits of a transmitted serial bit stream.
+    \param s The transmitter context.
+    \param bits The buffer for the bits, which are packed LSB first, so the first bit to
+           be sent is bit 0 of bits[0].
+    \param max_bits The maximum number of bits to get.
+    \return The number of bits placed in bits. This is less than max_bits if the data
+            stream has ended. */
+SPAN_DECLARE(int) async_tx_get_bits(async_tx_state_t *s, uint8_t bits[], int max_bits);
+
+/*! Frame a buffer of characters, as a block of serial bits. The state of the bit stream
+    from async_tx_get_bit() and async_tx_get_bits() is not affected.
+    \brief Frame a buffer of characters, as a block of serial bits.
+    \param s The transmitter context, which defines the character format.
+    \param bits The buffer for the bits, which are packed LSB first. This must have room
+           for len times the number of bits in a framed character.
+    \param buf The characters.
+    \param len The number of characters.
+    \return The number of bits placed in bits. */
+SPAN_DECLARE(int) async_tx_frame_bytes(async_tx_state_t *s, uint8_t bits[], const uint8_t buf[], int len);
+
 /*! Initialise an asynchronous data transmit context.
     \brief Initialise an asynchronous data transmit context.
     \param s The transmitter context.
@@ -0,0 +1,133 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * channel_group.h - Process a group of channels together, in a cache friendly way.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2013 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 2.1,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \file */
+
+#if !defined(_SPANDSP_CHANNEL_GROUP_H_)
+#define _SPANDSP_CHANNEL_GROUP_H_
+
+/*! \page channel_group_page Channel groups
+\section channel_group_page_sec_1 What does it do?
+A busy media server runs many channels, each with a spandsp context of several
+kilobytes, such as a FAX context or a DTMF receiver. When the application calls
+fax_rx(), fax_tx(), dtmf_rx(), and so on, channel by channel, in whatever order
+the packets arrive, each context is usually cold in the cache by the time it is
+used. A channel group holds the contexts, handlers and audio buffers for a set
+of channels, and processes all of them, one tick at a time, with a single call.
+
+\section channel_group_page_sec_2 How does it work?
+The channels are processed in the order of the addresses of their contexts, so
+contexts allocated together are visited in the order they lie in memory. While
+one channel's handlers run, the start of the next channel's context, and its
+audio buffers, are prefetched into the cache. Each channel's receive handler is
+followed immediately by its transmit handler, while its context is still in the
+cache.
+
+The application fills the receive buffers, calls channel_group_process(), and
+then collects the audio from the transmit buffers. The number of samples each
+transmit handler produced may be found with channel_group_get_tx_len().
+*/
+
+/*! The largest number of bytes of each context which is prefetched. */
+#define CHANNEL_GROUP_MAX_PREFETCH      4096
+
+/*!
+    Channel group descriptor. This defines the working state for a single instance of
+    a group of channels.
+*/
+typedef struct channel_group_state_s channel_group_state_t;
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+/*! \brief Add a channel to a channel group.
+    \param s The channel group context.
+    \param rx_handler The receive handler, e.g. fax_rx() or dtmf_rx(), or NULL for none.
+    \param tx_handler The transmit handler, e.g. fax_tx() or dtmf_tx(), or NULL for none.
+    \param user_data The context for the handlers.
+    \param prefetch_len The number of bytes at the start of the context which are worth
+           prefetching. This is normally the size of the context, and is limited to
+           CHANNEL_GROUP_MAX_PREFETCH. Zero stops the context being prefetched.
+    \param rx_buf The buffer the receive handler takes its audio from. Some receive
+           handlers, such as fax_rx() and t38_gateway_rx(), change the audio in place.
+    \param tx_buf The buffer the transmit handler puts its audio in.
+    \return A handle for the channel, or -1 if the group is full. */
+SPAN_DECLARE(int) channel_group_add(channel_group_state_t *s,
+                                    span_rx_handler_t *rx_handler,
+                                    span_tx_handler_t *tx_handler,
+                                    void *user_data,
+                                    int prefetch_len,
+                                    int16_t rx_buf[],
+                                    int16_t tx_buf[]);
+
+/*! \brief Remove a channel from a channel group.
+    \param s The channel group context.
+    \param handle The handle of the channel.
+    \return 0 for OK, or -1 if the handle is not in use. */
+SPAN_DECLARE(int) channel_group_remove(channel_group_state_t *s, int handle);
+
+/*! \brief Process one tick of audio for all the channels in a channel group.
+    \param s The channel group context.
+    \param len The number of samples in each channel's receive buffer, and the
+           number of samples wanted in each channel's transmit buffer.
+    \return The number of channels processed. */
+SPAN_DECLARE(int) channel_group_process(channel_group_state_t *s, int len);
+
+/*! \brief Get the number of samples a channel's transmit handler produced, in the
+           last tick.
+    \param s The channel group context.
+    \param handle The handle of the channel.
+    \return The number of samples, or -1 if the handle is not in use. */
+SPAN_DECLARE(int) channel_group_get_tx_len(channel_group_state_t *s, int handle);
+
+/*! \brief Get the number of channels in a channel group.
+    \param s The channel group context.
+    \return The number of channels. */
+SPAN_DECLARE(int) channel_group_get_channels(channel_group_state_t *s);
+
+/*! \brief Initialise a channel group context.
+    \param s The channel group context.
+    \param max_channels The largest number of channels the group may hold.
+    \return A pointer to the channel group context, or NULL if there was a problem. */
+SPAN_DECLARE(channel_group_state_t *) channel_group_init(channel_group_state_t *s, int max_channels);
+
+/*! \brief Release a channel group context.
+    \param s The channel group context.
+    \return 0 for OK. */
+SPAN_DECLARE(int) channel_group_release(channel_group_state_t *s);
+
+/*! \brief Free a channel group context.
+    \param s The channel group context.
+    \return 0 for OK. */
+SPAN_DECLARE(int) channel_group_free(channel_group_state_t *s);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
+/*- End of file ------------------------------------------------------------*/
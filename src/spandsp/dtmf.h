@@ -59,6 +59,19 @@ Basic DTMF specs:
     - Attenuation <= 26dB will detect OK
     - Frequency tolerance +- 1.5% will detect, +-3.5% will reject
 
+The signal is analysed in blocks of 102 samples, and a digit is only confirmed
+when two successive blocks agree. Depending on where the digit starts within a
+block, that takes from 23ms to 36ms, before any delay in delivering the audio
+to the detector. Applications which relay digits, for example as RFC2833 events,
+and need to suppress the in-band tones quickly, may ask for early reports. Three
+more sets of Goertzel filters then analyse blocks staggered by one, two and three
+quarters of a block from the main ones, and a probable digit is reported as soon
+as two successive overlapping blocks agree on it, which takes no more than 20ms.
+An early report is later confirmed, in the usual way, or withdrawn. The confirmed
+results are exactly the same whether early reporting is used or not, so it adds
+no false detections. Early reporting roughly quadruples the work the detector
+does.
+
 TODO:
 */
 
@@ -148,6 +161,25 @@ SPAN_DECLARE(void) dtmf_rx_set_realtime_callback(dtmf_rx_state_t *s,
                                                  tone_report_func_t callback,
                                                  void *user_data);
 
+/*! Set an optional callback for early reports of digits from a DTMF receiver context.
+    This function is called with the ASCII value for a DTMF tone pair as soon as that
+    digit is probably present, before the receiver confirms it. If the receiver goes on
+    to confirm the digit, it is reported through the realtime callback, or added to the
+    received digits, in the usual way, and the early callback is not called again for
+    it. If the digit is not confirmed, the early callback is called with zero, to
+    withdraw the report. A report still pending when early reporting is stopped, or
+    moved to another callback, is withdrawn in the same way. The level is in dBm0, and
+    the delay is always zero.
+    \brief Set a callback for early reports of digits from a DTMF receiver context.
+    \param s The DTMF receiver context.
+    \param callback Callback routine used to report probable digits, or NULL to stop
+           early reporting.
+    \param user_data An opaque pointer which is associated with the context,
+           and supplied in callbacks. */
+SPAN_DECLARE(void) dtmf_rx_set_early_callback(dtmf_rx_state_t *s,
+                                              tone_report_func_t callback,
+                                              void *user_data);
+
 /*! \brief Adjust a DTMF receiver context.
     \param s The DTMF receiver context.
     \param filter_dialtone True to enable filtering of dialtone, false
@@ -170,6 +202,19 @@ SPAN_DECLARE(void) dtmf_rx_parms(dtmf_rx_state_t *s,
     \return The number of samples unprocessed. */
 SPAN_DECLARE(int) dtmf_rx(dtmf_rx_state_t *s, const int16_t amp[], int samples);
 
+/*! Process a block of received DTMF audio samples for each of a group of receivers, such
+    as the lines of a high density receiver. Where possible, several lines are processed
+    together, which is considerably faster than calling dtmf_rx() for each line. The
+    results are the same as calling dtmf_rx() for each line in turn, although the order
+    in which the lines' callbacks are invoked may differ.
+    \brief Process a block of received DTMF audio samples for a group of receivers.
+    \param s An array of DTMF receiver contexts.
+    \param amp An array of audio sample buffers, one per receiver. A NULL entry skips that receiver.
+    \param channels The number of receivers.
+    \param samples The number of samples in each buffer.
+    \return The number of samples unprocessed. */
+SPAN_DECLARE(int) dtmf_rx_bank(dtmf_rx_state_t *s[], const int16_t *amp[], int channels, int samples);
+
 /*! Fake processing of a missing block of received DTMF audio samples.
     (e.g due to packet loss).
     \brief Fake processing of a missing block of received DTMF audio samples.
@@ -35,10 +35,14 @@
 #include <spandsp/private/schedule.h>
 #include <spandsp/private/bitstream.h>
 #include <spandsp/private/queue.h>
+#include <spandsp/private/media_tap.h>
+#include <spandsp/private/media_replay.h>
+#include <spandsp/private/channel_group.h>
 #include <spandsp/private/awgn.h>
 #include <spandsp/private/noise.h>
 #include <spandsp/private/bert.h>
 #include <spandsp/private/power_meter.h>
+#include <spandsp/private/resampler.h>
 #include <spandsp/private/tone_generate.h>
 #include <spandsp/private/bell_r2_mf.h>
 #include <spandsp/private/sig_tone.h>
@@ -54,6 +58,7 @@
 #include <spandsp/private/ima_adpcm.h>
 #include <spandsp/private/hdlc.h>
 #include <spandsp/private/time_scale.h>
+#include <spandsp/private/playout_rx.h>
 #include <spandsp/private/super_tone_tx.h>
 #include <spandsp/private/super_tone_rx.h>
 #include <spandsp/private/silence_gen.h>
@@ -81,8 +86,8 @@
 #include <spandsp/private/image_translate.h>
 #include <spandsp/private/t4_t6_decode.h>
 #include <spandsp/private/t4_t6_encode.h>
-/*#include <spandsp/private/t81_t82_arith_coding.h>*/
-/*#include <spandsp/private/t85.h>*/
+#include <spandsp/private/t81_t82_arith_coding.h>
+#include <spandsp/private/t85.h>
 #include <spandsp/private/t4_rx.h>
 #include <spandsp/private/t4_tx.h>
 #include <spandsp/private/t30.h>
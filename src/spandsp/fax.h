@@ -35,6 +35,9 @@
 \section fax_page_sec_2 How does it work?
 */
 
+/*! The maximum length of a checkpoint of a FAX context */
+#define FAX_MAX_CHECKPOINT_LEN      (4 + V17_RX_TRAINING_STATE_LEN + T30_MAX_CHECKPOINT_LEN)
+
 typedef struct fax_state_s fax_state_t;
 
 #if defined(__cplusplus)
@@ -88,6 +91,44 @@ SPAN_DECLARE(void) fax_set_transmit_on_idle(fax_state_t *s, int transmit_on_idle
 */
 SPAN_DECLARE(void) fax_set_tep_mode(fax_state_t *s, int use_tep);
 
+/*! Set the level below which received audio is treated as an idle line. While no
+    signal is present, idle line is not passed to the receive modems.
+    \brief Set the idle line cutoff level.
+    \param s The FAX context.
+    \param cutoff The cutoff level, in dBm0. The default is -50dBm0.
+*/
+SPAN_DECLARE(void) fax_set_rx_idle_cutoff(fax_state_t *s, float cutoff);
+
+/*! Attach a media tap to a FAX context, to capture the audio it sends and receives.
+    This may be done at any point in a call.
+    \brief Attach a media tap to a FAX context.
+    \param s The FAX context.
+    \param tap The media tap, or NULL to stop capturing.
+*/
+SPAN_DECLARE(void) fax_set_tap(fax_state_t *s, media_tap_state_t *tap);
+
+/*! Checkpoint a FAX context, so the call can be moved to another FAX context. See
+    t30_checkpoint() for when this is possible. The V.17 receiver's training is included,
+    so a following page sent with short training can still be received.
+    \brief Checkpoint a FAX context.
+    \param s The FAX context.
+    \param buf The buffer for the checkpoint.
+    \param max_len The length of buf. FAX_MAX_CHECKPOINT_LEN is always enough.
+    \return The length of the checkpoint, or -1 if the call cannot be checkpointed at
+            present, or buf is too small.
+*/
+SPAN_DECLARE(int) fax_checkpoint(fax_state_t *s, uint8_t buf[], int max_len);
+
+/*! Restore a FAX context from a checkpoint made by fax_checkpoint(). See t30_restore()
+    for how the context must be prepared.
+    \brief Restore a FAX context from a checkpoint.
+    \param s The FAX context.
+    \param buf The checkpoint.
+    \param len The length of the checkpoint.
+    \return 0 for OK, else -1. If this fails, the context is left as it was.
+*/
+SPAN_DECLARE(int) fax_restore(fax_state_t *s, const uint8_t buf[], int len);
+
 /*! Get a pointer to the T.30 engine associated with a FAX context.
     \brief Get a pointer to the T.30 engine associated with a FAX context.
     \param s The FAX context.
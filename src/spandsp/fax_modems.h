@@ -77,6 +77,26 @@ SPAN_DECLARE(void) fax_modems_start_rx_modem(fax_modems_state_t *s, int which);
 
 SPAN_DECLARE(void) fax_modems_set_tep_mode(fax_modems_state_t *s, int use_tep);
 
+/*! Set the level below which received audio is treated as an idle line, which the
+    receivers need not process while no signal is present.
+    \brief Set the idle line cutoff level.
+    \param s The FAX modems context.
+    \param cutoff The cutoff level, in dBm0. This should be below the carrier detection
+           level of all the receivers. The default is -50dBm0. */
+SPAN_DECLARE(void) fax_modems_set_rx_idle_cutoff(fax_modems_state_t *s, float cutoff);
+
+/*! Check whether a block of received audio is idle line, which the receivers need not
+    process. A block is idle when its peak amplitude is below the cutoff level, and
+    enough idle line has already been fed to the receivers for them to settle, and
+    report any loss of carrier. This must be called for every received block, including
+    those which go on to be processed.
+    \brief Check whether a block of received audio can skip the receivers.
+    \param s The FAX modems context.
+    \param amp The received audio.
+    \param len The number of samples in amp.
+    \return True if the receivers need not process the block. */
+SPAN_DECLARE(int) fax_modems_rx_idle(fax_modems_state_t *s, const int16_t amp[], int len);
+
 SPAN_DECLARE(int) fax_modems_restart(fax_modems_state_t *s);
 
 /*! Get a pointer to the logging context associated with a FAX modems context.
@@ -229,6 +229,34 @@ SPAN_DECLARE(int) fsk_rx_free(fsk_rx_state_t *s);
 */
 SPAN_DECLARE_NONSTD(int) fsk_rx(fsk_rx_state_t *s, const int16_t *amp, int len);
 
+/*! Process a block of received FSK modem audio samples, using local oscillator values
+    shared between a number of receivers which use the same FSK spec, and returning the
+    received bits in a buffer, rather than through the put_bit callback. Status changes
+    are returned in the same buffer, as negative values, in the order they occur. Since
+    non-coherent demodulation is used, the shared oscillators need not be in any
+    particular phase relationship with the receiver's signal.
+    \brief Process a block of received FSK modem audio samples, with shared local oscillators.
+    \param s The modem context.
+    \param amp The audio sample buffer.
+    \param lo The local oscillator values for the two tones, for each sample, as
+           generated by fsk_rx_shared_lo().
+    \param len The number of samples in the buffer.
+    \param bits The buffer for the received bits and status changes. This must have room
+           for 2*len entries.
+    \return The number of entries placed in bits.
+*/
+SPAN_DECLARE(int) fsk_rx_block(fsk_rx_state_t *s, const int16_t amp[], const complexi_t lo[][2], int len, int bits[]);
+
+/*! Generate a block of local oscillator values for use by fsk_rx_block(), with any
+    receiver using the same FSK spec as the one specified.
+    \brief Generate a block of shared local oscillator values for FSK receivers.
+    \param s The modem context.
+    \param phase_acc The phase accumulators for the two tones, which are updated.
+    \param lo The local oscillator values for the two tones, for each sample.
+    \param len The number of samples to generate.
+*/
+SPAN_DECLARE(void) fsk_rx_shared_lo(fsk_rx_state_t *s, uint32_t phase_acc[2], complexi_t lo[][2], int len);
+
 /*! Fake processing of a missing block of received FSK modem audio samples
     (e.g due to packet loss).
     \brief Fake processing of a missing block of received FSK modem audio samples.
@@ -0,0 +1,152 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * media_replay.h - Replay a call recorded by a media tap, through a fresh context.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2013 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 2.1,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \file */
+
+#if !defined(_SPANDSP_MEDIA_REPLAY_H_)
+#define _SPANDSP_MEDIA_REPLAY_H_
+
+/*! \page media_replay_page Replaying recorded calls
+\section media_replay_page_sec_1 What does it do?
+A call recorded by a media tap with the MEDIA_TAP_MASK_RECORD mask (see
+\ref media_tap_page) holds every input which drove the context - received
+audio, requests for transmitted audio, received IFP packets, T.38 timer ticks,
+AT commands, and the time for the FAX page headers. The replayer feeds those inputs, in their original order, to a
+fresh context of the same kind, so a call which misbehaved, or ran slowly, in
+production can be repeated offline, as often as needed, under a debugger, a
+profiler or valgrind. Time in the replay is purely the count of samples in the
+recording, so the replay runs as fast as the context can process it, and
+behaves the same every time.
+
+\section media_replay_page_sec_2 How does it work?
+The application creates the fresh context, with the settings of the recorded
+one, and passes each record to media_replay_record(), in order. Notes the
+application added to the recording with media_tap_note(), such as its T.30
+settings, are passed back to a handler, so the application can repeat the same
+calls at the same points in the call. The page header time zone is not part of
+the recording, so it must be set in the same way, perhaps from a note.
+
+The replayer attaches a tap of its own to the context, and compares each block
+of audio and each IFP packet the context sends with the one in the recording.
+Any difference is counted as a mismatch, so the point where a replay first
+departs from the original call is easily found. A replay which departs from the
+original usually means the context was not set up in the same way, or records
+were dropped from the recording. Dropped records are found from gaps in the
+records' sequence numbers, and are counted separately.
+*/
+
+/*! The types of context a call may be replayed through. */
+enum
+{
+    /*! A FAX context - fax_state_t. */
+    MEDIA_REPLAY_FAX = 1,
+    /*! A termination mode T.38 context - t38_terminal_state_t. */
+    MEDIA_REPLAY_T38_TERMINAL = 2,
+    /*! A T.31 context - t31_state_t. */
+    MEDIA_REPLAY_T31 = 3,
+    /*! A T.38 gateway context - t38_gateway_state_t. */
+    MEDIA_REPLAY_T38_GATEWAY = 4
+};
+
+/*! The longest block of audio which may be received, or requested for transmission,
+    in one call to the replayed context. */
+#define MEDIA_REPLAY_MAX_BLOCK      8000
+
+/*! Media replay descriptor. This defines the working state for a single instance of
+    a media replayer.
+*/
+typedef struct media_replay_state_s media_replay_state_t;
+
+/*! The handler for the notes in a recording.
+    \param user_data An opaque pointer.
+    \param buf The note.
+    \param len The length of the note, in bytes.
+    \return 0 for OK, or -1 if the note could not be acted on. */
+typedef int (media_replay_note_handler_t)(void *user_data, const uint8_t buf[], int len);
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+/*! \brief Apply the next record of a recorded call to the replayed context.
+    \param s The media replay context.
+    \param rec The description of the record, as from media_tap_read() or
+           media_tap_unpack_header().
+    \param buf The record's payload.
+    \param len The length of the payload, in bytes.
+    \return 0 for OK, or -1 if the record could not be applied, or the replayed context's
+            output did not match it. */
+SPAN_DECLARE(int) media_replay_record(media_replay_state_t *s, const media_tap_record_t *rec, const uint8_t buf[], int len);
+
+/*! \brief Set the handler for the notes in a recording.
+    \param s The media replay context.
+    \param handler The handler.
+    \param user_data An opaque pointer passed to the handler. */
+SPAN_DECLARE(void) media_replay_set_note_handler(media_replay_state_t *s, media_replay_note_handler_t *handler, void *user_data);
+
+/*! \brief Get the number of records for which the replayed context's output differed
+           from the recording, or which could not be applied.
+    \param s The media replay context.
+    \return The number of mismatches. */
+SPAN_DECLARE(int) media_replay_get_mismatches(media_replay_state_t *s);
+
+/*! \brief Get the number of records missing from the recording, from the gaps in their
+           sequence numbers.
+    \param s The media replay context.
+    \return The number of missing records. */
+SPAN_DECLARE(int) media_replay_get_missing(media_replay_state_t *s);
+
+/*! \brief Get a pointer to the logging context associated with a media replay context.
+    \param s The media replay context.
+    \return A pointer to the logging context, or NULL. */
+SPAN_DECLARE(logging_state_t *) media_replay_get_logging_state(media_replay_state_t *s);
+
+/*! \brief Initialise a media replay context. The replayed context must be freshly
+           initialised, with the same settings as the recorded one, and must not have
+           a tap of its own attached, as the replayer attaches one.
+    \param s The media replay context.
+    \param type The type of the replayed context - MEDIA_REPLAY_FAX, etc.
+    \param context The replayed context.
+    \return A pointer to the media replay context, or NULL if there was a problem. */
+SPAN_DECLARE(media_replay_state_t *) media_replay_init(media_replay_state_t *s, int type, void *context);
+
+/*! \brief Release a media replay context. The replayer's tap is detached from the
+           replayed context.
+    \param s The media replay context.
+    \return 0 for OK. */
+SPAN_DECLARE(int) media_replay_release(media_replay_state_t *s);
+
+/*! \brief Free a media replay context.
+    \param s The media replay context.
+    \return 0 for OK. */
+SPAN_DECLARE(int) media_replay_free(media_replay_state_t *s);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
+/*- End of file ------------------------------------------------------------*/
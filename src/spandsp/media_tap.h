@@ -0,0 +1,283 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * media_tap.h - Non-blocking capture of audio and T.38 IFP packets, for debugging.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2013 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 2.1,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \file */
+
+#if !defined(_SPANDSP_MEDIA_TAP_H_)
+#define _SPANDSP_MEDIA_TAP_H_
+
+/*! \page media_tap_page Media capture taps
+\section media_tap_page_sec_1 What does it do?
+A media tap captures the audio sent and received by a FAX context, a T.31 context
+or a T.38 gateway, and the T.38 IFP packets sent and received by a T.38 context,
+while the call is in progress. A tap can be attached to a running call, and removed
+again, at any time, so a problem call can be captured in a production system,
+without rebuilding the library with LOG_FAX_AUDIO defined.
+
+\section media_tap_page_sec_2 How does it work?
+The tap never blocks the media processing, and never does any I/O of its own. Each
+block of audio, and each IFP packet, is copied as one record into a lock free queue
+belonging to the tap. The application drains the queue from a thread of its own,
+with media_tap_read(), and writes the records wherever it likes. If the writer falls
+behind, and the queue fills, new records are dropped and counted, rather than making
+the media thread wait. Every record carries a sequence number, so any gaps are
+visible in the capture.
+
+The queue is lock free for one writing thread and one reading thread. All the
+contexts sharing a tap must, therefore, feed it from a single thread, which is
+normally the media thread that calls fax_rx(), fax_tx(), and so on. Both the
+received and the transmitted media are written to the tap, so while a tap is
+attached, fax_rx() and fax_tx(), or the equivalent calls for other contexts, must
+not be called from different threads. The thread which drains the tap may only
+call media_tap_read() and media_tap_get_dropped().
+
+\section media_tap_page_sec_3 Recording a call for replay
+By default a tap captures the media, which is enough to listen to a call, or to
+examine its T.38 exchange. With the mask set to MEDIA_TAP_MASK_RECORD, a tap also
+captures every other input which drives the context - the length of each request
+for transmitted audio, each fill-in of missing audio, each T.38 timer tick, and
+each block of AT commands given to a T.31 context. Such a recording holds all a
+fresh context needs to repeat the call exactly, and the transmitted media, against
+which the repeat can be checked (see \ref media_replay_page). The application may
+add calls it makes to the context itself, such as the T.30 settings, as notes,
+with media_tap_note(). To be replayed, a recording must start when the context is
+initialised.
+
+The page headers a FAX context sends hold the time, so the clock is an input too.
+While a tap records MEDIA_TAP_HEADER_TIME, it reads the clock at each input, and
+records the time whenever the minute changes. The context takes the header time from
+the tap, rather than the system clock, until the tap is detached. The time zone for
+the headers is not recorded, and should be added as a note, if it was set.
+
+For storage, each record may be turned into a fixed length header, in a portable
+byte order, by media_tap_pack_header(), followed by its payload.
+*/
+
+/*! The types of the records a media tap captures. */
+enum
+{
+    /*! A block of received audio. */
+    MEDIA_TAP_RX_AUDIO = 1,
+    /*! A block of transmitted audio. */
+    MEDIA_TAP_TX_AUDIO = 2,
+    /*! A received T.38 IFP packet. */
+    MEDIA_TAP_RX_IFP = 3,
+    /*! A transmitted T.38 IFP packet. */
+    MEDIA_TAP_TX_IFP = 4,
+    /*! A request for a block of transmitted audio. The payload is the requested
+        number of samples, as a native int32_t. */
+    MEDIA_TAP_TX_REQUEST = 5,
+    /*! A block of missing received audio, as for fax_rx_fillin(). The payload is
+        the number of samples, as a native int32_t. */
+    MEDIA_TAP_RX_FILLIN = 6,
+    /*! A T.38 timer tick. The payload is the number of samples of time which have
+        passed since the last tick, as a native int32_t. */
+    MEDIA_TAP_TIMER = 7,
+    /*! A block of AT commands, or data, from the DTE of a T.31 context. */
+    MEDIA_TAP_RX_AT = 8,
+    /*! A note added by the application, with media_tap_note(). */
+    MEDIA_TAP_NOTE = 9,
+    /*! The time for the time stamp in FAX page headers, which comes before the first
+        input record of each new minute. The payload is the time, as a native int64_t. */
+    MEDIA_TAP_HEADER_TIME = 10
+};
+
+/*! The mask of the record types captured by default - the media itself. */
+#define MEDIA_TAP_MASK_CAPTURE      ((1 << MEDIA_TAP_RX_AUDIO) \
+                                     | (1 << MEDIA_TAP_TX_AUDIO) \
+                                     | (1 << MEDIA_TAP_RX_IFP) \
+                                     | (1 << MEDIA_TAP_TX_IFP))
+
+/*! The mask of the record types needed to replay a call. */
+#define MEDIA_TAP_MASK_RECORD       (MEDIA_TAP_MASK_CAPTURE \
+                                     | (1 << MEDIA_TAP_TX_REQUEST) \
+                                     | (1 << MEDIA_TAP_RX_FILLIN) \
+                                     | (1 << MEDIA_TAP_TIMER) \
+                                     | (1 << MEDIA_TAP_RX_AT) \
+                                     | (1 << MEDIA_TAP_NOTE) \
+                                     | (1 << MEDIA_TAP_HEADER_TIME))
+
+/*! The largest payload in one record. Longer blocks of audio are split over
+    several records. */
+#define MEDIA_TAP_MAX_PAYLOAD       2048
+
+/*! The length of the header media_tap_pack_header() makes for each record. */
+#define MEDIA_TAP_PACKED_HEADER_LEN 16
+
+/*! The description of a record read from a media tap. */
+typedef struct
+{
+    /*! \brief The type of the record - MEDIA_TAP_RX_AUDIO, etc. */
+    int type;
+    /*! \brief The sequence number of the record. This counts every record offered to
+               the tap, including those dropped because the queue was full. */
+    uint32_t seq_no;
+    /*! \brief For audio, the position of the first sample in its direction's audio
+               stream. For IFP packets, the position of the received audio stream when
+               the packet passed, as a rough time reference. */
+    uint32_t sample_time;
+    /*! \brief For IFP packets, the T.38 sequence number of the packet. */
+    int t38_seq_no;
+    /*! \brief For audio, true if the block the record belongs to continues in the next
+               record, because it was longer than MEDIA_TAP_MAX_PAYLOAD. */
+    int continues;
+} media_tap_record_t;
+
+/*!
+    Media tap descriptor. This defines the working state for a single instance of
+    a media capture tap.
+*/
+typedef struct media_tap_state_s media_tap_state_t;
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+/*! \brief Offer a block of audio to a media tap.
+    \param s The media tap context.
+    \param type MEDIA_TAP_RX_AUDIO or MEDIA_TAP_TX_AUDIO.
+    \param amp The audio.
+    \param len The number of samples in amp.
+    \return 0 if the audio was captured, or -1 if some of it was dropped. */
+SPAN_DECLARE(int) media_tap_audio(media_tap_state_t *s, int type, const int16_t amp[], int len);
+
+/*! \brief Tell a media tap that a block of audio was missing, as for fax_rx_fillin().
+           No audio is captured, but the stream's sample time moves on, so the gap is
+           visible in the capture. A MEDIA_TAP_RX_FILLIN record is captured, if it is
+           in the tap's mask.
+    \param s The media tap context.
+    \param type MEDIA_TAP_RX_AUDIO or MEDIA_TAP_TX_AUDIO.
+    \param len The number of samples missing. */
+SPAN_DECLARE(void) media_tap_audio_fillin(media_tap_state_t *s, int type, int len);
+
+/*! \brief Offer a T.38 IFP packet to a media tap.
+    \param s The media tap context.
+    \param type MEDIA_TAP_RX_IFP or MEDIA_TAP_TX_IFP.
+    \param buf The packet.
+    \param len The length of the packet, in bytes.
+    \param seq_no The T.38 sequence number of the packet.
+    \return 0 if the packet was captured, or -1 if it was dropped. */
+SPAN_DECLARE(int) media_tap_ifp(media_tap_state_t *s, int type, const uint8_t buf[], int len, int seq_no);
+
+/*! \brief Offer a request for a block of transmitted audio to a media tap.
+    \param s The media tap context.
+    \param max_len The number of samples requested.
+    \return 0 if the request was captured, or -1 if it was dropped. */
+SPAN_DECLARE(int) media_tap_tx_request(media_tap_state_t *s, int max_len);
+
+/*! \brief Offer a T.38 timer tick to a media tap. The tick also serves as the tap's
+           clock, for contexts with no audio.
+    \param s The media tap context.
+    \param samples The time since the last tick, in samples.
+    \return 0 if the tick was captured, or -1 if it was dropped. */
+SPAN_DECLARE(int) media_tap_timer(media_tap_state_t *s, int samples);
+
+/*! \brief Offer a block of AT commands, or data, from a T.31 DTE to a media tap.
+    \param s The media tap context.
+    \param buf The commands or data.
+    \param len The length of buf, in bytes. Longer blocks are split over several records.
+    \return 0 if the block was captured, or -1 if some of it was dropped. */
+SPAN_DECLARE(int) media_tap_at(media_tap_state_t *s, const char buf[], int len);
+
+/*! \brief Add a note to a media tap's capture. This lets an application record the
+           calls it makes to a context, such as its T.30 settings, in step with the
+           media, so they can be repeated when the call is replayed.
+    \param s The media tap context.
+    \param buf The note.
+    \param len The length of the note, in bytes.
+    \return 0 if the note was captured, or -1 if it was dropped or is too long. */
+SPAN_DECLARE(int) media_tap_note(media_tap_state_t *s, const uint8_t buf[], int len);
+
+/*! \brief Get the time a media tap holds for FAX page headers. This is the time last
+           recorded as a MEDIA_TAP_HEADER_TIME record, or applied from one in a replay.
+    \param s The media tap context.
+    \return The time, or -1 if the tap holds no time, and the system clock should be used. */
+SPAN_DECLARE(time_t) media_tap_get_header_time(media_tap_state_t *s);
+
+/*! \brief Set the time a media tap holds for FAX page headers, as when a MEDIA_TAP_HEADER_TIME
+           record is replayed.
+    \param s The media tap context.
+    \param when The time, or -1 for none. */
+SPAN_DECLARE(void) media_tap_set_header_time(media_tap_state_t *s, time_t when);
+
+/*! \brief Read the next record from a media tap. This is intended to be called from
+           the application's writer thread.
+    \param s The media tap context.
+    \param rec The description of the record.
+    \param buf The buffer for the record's payload. Audio is in native byte order.
+    \param max_len The length of buf, in bytes. A longer payload is truncated.
+    \return The length of the payload, in bytes, or -1 if the tap is empty. */
+SPAN_DECLARE(int) media_tap_read(media_tap_state_t *s, media_tap_record_t *rec, uint8_t buf[], int max_len);
+
+/*! \brief Pack the description of a record into a portable header, for storage.
+    \param buf The buffer for the header, which must be at least MEDIA_TAP_PACKED_HEADER_LEN
+           bytes long.
+    \param rec The description of the record.
+    \param len The length of the record's payload, in bytes.
+    \return The length of the header, in bytes. */
+SPAN_DECLARE(int) media_tap_pack_header(uint8_t buf[], const media_tap_record_t *rec, int len);
+
+/*! \brief Unpack a header made by media_tap_pack_header().
+    \param rec The description of the record.
+    \param buf The header.
+    \return The length of the record's payload, in bytes, or -1 if the header is invalid. */
+SPAN_DECLARE(int) media_tap_unpack_header(media_tap_record_t *rec, const uint8_t buf[]);
+
+/*! \brief Select the types of record a media tap captures.
+    \param s The media tap context.
+    \param mask A mask of the types to be captured, with bit (1 << type) set for each
+           type. This is MEDIA_TAP_MASK_CAPTURE when the tap is initialised. */
+SPAN_DECLARE(void) media_tap_set_mask(media_tap_state_t *s, int mask);
+
+/*! \brief Get the number of records a media tap has dropped, because its queue was full.
+    \param s The media tap context.
+    \return The number of records dropped. */
+SPAN_DECLARE(int) media_tap_get_dropped(media_tap_state_t *s);
+
+/*! \brief Initialise a media tap context.
+    \param s The media tap context.
+    \param buffer_len The length of the tap's queue, in bytes. About 20000 bytes are
+           needed for each second of audio in each direction, so this should cover
+           the longest stall the writer thread may suffer.
+    \return A pointer to the media tap context, or NULL if there was a problem. */
+SPAN_DECLARE(media_tap_state_t *) media_tap_init(media_tap_state_t *s, int buffer_len);
+
+/*! \brief Release a media tap context.
+    \param s The media tap context.
+    \return 0 for OK. */
+SPAN_DECLARE(int) media_tap_release(media_tap_state_t *s);
+
+/*! \brief Free a media tap context.
+    \param s The media tap context.
+    \return 0 for OK. */
+SPAN_DECLARE(int) media_tap_free(media_tap_state_t *s);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
+/*- End of file ------------------------------------------------------------*/
@@ -98,6 +98,21 @@ typedef struct modem_connect_tones_tx_state_s modem_connect_tones_tx_state_t;
 */
 typedef struct modem_connect_tones_rx_state_s modem_connect_tones_rx_state_t;
 
+/*!
+    Modem connect tones receiver bank descriptor. This defines the state of a
+    bank of tone detectors, used to classify many channels at once.
+*/
+typedef struct modem_connect_tones_rx_bank_state_s modem_connect_tones_rx_bank_state_t;
+
+/*! \brief The callback used to report the classification of a channel in a modem
+           connect tones receiver bank.
+    \param user_data An opaque pointer.
+    \param channel The channel number, starting from zero.
+    \param tone The tone found on the channel.
+    \param level The level of the tone, in dBm0.
+*/
+typedef void (*modem_connect_tones_rx_bank_report_func_t)(void *user_data, int channel, int tone, int level);
+
 #if defined(__cplusplus)
 extern "C"
 {
@@ -179,6 +194,56 @@ SPAN_DECLARE(int) modem_connect_tones_rx_release(modem_connect_tones_rx_state_t
     \return 0 for OK, else -1. */
 SPAN_DECLARE(int) modem_connect_tones_rx_free(modem_connect_tones_rx_state_t *s);
 
+/*! \brief Initialise a modem connect tones receiver bank. Each channel is searched for CNG,
+           ANS, ANS/, ANSam, ANSam/ (which includes CED) and V.21 FAX preamble, all at once.
+           The first of these found classifies the channel, which is reported through the
+           callback. A classified channel is no longer processed, so the bank costs little
+           once calls have been classified, and the application can start full V.8 or FAX
+           processing for just those channels which need it.
+    \param s The context.
+    \param channels The number of channels.
+    \param callback An optional callback routine, used to report classifications.
+    \param user_data An opaque pointer passed to the callback routine.
+    \return A pointer to the context, or NULL if there was a problem.
+*/
+SPAN_DECLARE(modem_connect_tones_rx_bank_state_t *) modem_connect_tones_rx_bank_init(modem_connect_tones_rx_bank_state_t *s,
+                                                                                     int channels,
+                                                                                     modem_connect_tones_rx_bank_report_func_t callback,
+                                                                                     void *user_data);
+
+/*! \brief Release a modem connect tones receiver bank.
+    \param s The context.
+    \return 0 for OK, else -1. */
+SPAN_DECLARE(int) modem_connect_tones_rx_bank_release(modem_connect_tones_rx_bank_state_t *s);
+
+/*! \brief Free a modem connect tones receiver bank.
+    \param s The context.
+    \return 0 for OK, else -1. */
+SPAN_DECLARE(int) modem_connect_tones_rx_bank_free(modem_connect_tones_rx_bank_state_t *s);
+
+/*! \brief Process a block of samples for each channel of a modem connect tones receiver bank.
+    \param s The context.
+    \param amp An array of signal sample buffers, one per channel. A NULL entry skips that channel.
+    \param len The number of samples in each buffer.
+    \return The number of unprocessed samples.
+*/
+SPAN_DECLARE(int) modem_connect_tones_rx_bank(modem_connect_tones_rx_bank_state_t *s, const int16_t *amp[], int len);
+
+/*! \brief Get the classification of a channel in a modem connect tones receiver bank.
+    \param s The context.
+    \param channel The channel number, starting from zero.
+    \return The tone which classified the channel, or MODEM_CONNECT_TONES_NONE.
+*/
+SPAN_DECLARE(int) modem_connect_tones_rx_bank_get(modem_connect_tones_rx_bank_state_t *s, int channel);
+
+/*! \brief Restart the classification of a channel in a modem connect tones receiver bank,
+           e.g. for a new call.
+    \param s The context.
+    \param channel The channel number, starting from zero.
+    \return 0 for OK, else -1.
+*/
+SPAN_DECLARE(int) modem_connect_tones_rx_bank_restart(modem_connect_tones_rx_bank_state_t *s, int channel);
+
 SPAN_DECLARE(const char *) modem_connect_tone_to_str(int tone);
 
 #if defined(__cplusplus)
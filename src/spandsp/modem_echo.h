@@ -74,6 +74,13 @@ The echo cancellor processes both the transmit and receive streams sample by
 sample. The processing function is not declared inline. Unfortunately,
 cancellation requires many operations per sample, so the call overhead is only a
 minor burden.
+
+Where the transmit and receive streams are available as blocks of samples, as
+they usually are in a full duplex modem, modem_echo_can_update_block() is much
+cheaper. It filters each short internal block with the taps frozen, and then
+adapts the taps once for the whole block (block LMS). Both the filtering and
+the adaption are then simple vector operations, over contiguous memory. The
+per-sample and block functions may be freely mixed on the same canceller.
 */
 
 #include "fir.h"
@@ -119,6 +126,16 @@ SPAN_DECLARE(void) modem_echo_can_adaption_mode(modem_echo_can_state_t *ec, int
 */
 SPAN_DECLARE(int16_t) modem_echo_can_update(modem_echo_can_state_t *ec, int16_t tx, int16_t rx);
 
+/*! Process a block of samples through a modem echo canceller.
+    \param ec The echo canceller context.
+    \param clean_rx The clean (echo cancelled) received samples.
+    \param tx The transmitted audio samples.
+    \param rx The received audio samples.
+    \param len The number of samples to process.
+    \return The number of samples processed.
+*/
+SPAN_DECLARE(int) modem_echo_can_update_block(modem_echo_can_state_t *ec, int16_t clean_rx[], const int16_t tx[], const int16_t rx[], int len);
+
 #if defined(__cplusplus)
 }
 #endif
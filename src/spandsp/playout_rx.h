@@ -0,0 +1,162 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * playout_rx.h - A receive pipeline, from a play-out buffer of coded frames to
+ *                concealed and time scaled linear audio.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2013 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 2.1,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \file */
+
+#if !defined(_SPANDSP_PLAYOUT_RX_H_)
+#define _SPANDSP_PLAYOUT_RX_H_
+
+/*! \page playout_rx_page Play-out receive pipeline
+\section playout_rx_page_sec_1 What does it do?
+A VoIP receiver normally takes each frame due from a play-out buffer (see
+\ref playout_page), decodes it, passes it through a packet loss concealer (see
+\ref plc_page), or has the concealer make up a frame which is missing, and may
+then time scale the result (see \ref time_scale_page). The play-out receive
+pipeline does all of that with one call per frame period, writing the final
+audio straight into the caller's buffer.
+
+\section playout_rx_page_sec_2 How does it work?
+The frames in the play-out buffer hold G.711 A-law or u-law octets, G.726 codes,
+or 16 bit linear samples, as selected when the pipeline is initialised. Each
+call to playout_rx() takes the frame which is due, skipping any which arrived
+too late, and decodes it directly into the output buffer. The concealer records
+its history from the decoded samples there, and smooths the join after any
+concealed frames, in place. A frame which never arrived is concealed directly
+into the output buffer. No intermediate copies are made.
+
+Time scaling, to play out faster or slower than the frames arrive, is used only
+while the application has set a rate other than 1.0, for example to trim or grow
+the buffered delay. Then the frame is decoded into a buffer of the pipeline's
+own, and time scaled into the output buffer. When the rate returns to 1.0, the
+samples held by the time scaler are output, and the pipeline goes back to
+decoding directly into the output buffer. The number of samples produced by each
+call therefore varies while time scaling is in use, or changing.
+
+Every frame the pipeline takes from the play-out buffer, including late frames,
+and frames which are not speech, is passed to an optional handler once the
+pipeline has finished with it, so the application can free its data, or act on
+control frames.
+*/
+
+/*! The coding of the frames in the play-out buffer */
+enum
+{
+    /*! 16 bit linear samples, in the machine's byte order. */
+    PLAYOUT_RX_LINEAR = 0,
+    /*! G.711 A-law octets. */
+    PLAYOUT_RX_ALAW = 1,
+    /*! G.711 u-law octets. */
+    PLAYOUT_RX_ULAW = 2,
+    /*! G.726 codes, at the bit rate and with the packing given at initialisation. */
+    PLAYOUT_RX_G726 = 3
+};
+
+/*! The longest frame the pipeline will handle, in samples. Longer frames are treated
+    as lost. */
+#define PLAYOUT_RX_MAX_FRAME        480
+
+/*! The most samples one call to playout_rx() can produce. This allows for the longest
+    frame being stretched to twice its length, plus the samples held by the time scaler. */
+#define PLAYOUT_RX_MAX_OUTPUT       (2*PLAYOUT_RX_MAX_FRAME + 320)
+
+/*!
+    Play-out receive pipeline descriptor. This defines the working state for a single
+    instance of a play-out receive pipeline.
+*/
+typedef struct playout_rx_state_s playout_rx_state_t;
+
+/*! The handler for frames the pipeline has finished with.
+    \param user_data An opaque pointer.
+    \param data The frame's data, as given to playout_put().
+    \param type The frame's type - PLAYOUT_TYPE_SPEECH, etc. */
+typedef void (*playout_rx_frame_handler_t)(void *user_data, void *data, int type);
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+/*! Produce the audio for the next frame period, from the frame due in the play-out
+    buffer, or by concealing its loss.
+    \brief Produce the audio for the next frame period.
+    \param s The play-out receive pipeline context.
+    \param amp The buffer for the audio. This must have room for PLAYOUT_RX_MAX_OUTPUT samples.
+    \param now The current time, in timestamp units.
+    \return The number of samples produced. This is zero until the first frame has been
+            put in the play-out buffer. */
+SPAN_DECLARE(int) playout_rx(playout_rx_state_t *s, int16_t amp[], timestamp_t now);
+
+/*! Set the rate at which a play-out receive pipeline plays out its audio, relative to the
+    rate at which it arrives.
+    \brief Set the rate at which a play-out receive pipeline plays out its audio.
+    \param s The play-out receive pipeline context.
+    \param rate The ratio between the output speed and the input speed, from 0.5 to 2.0,
+           as for time_scale_rate(). Each frame produces about rate times its own length
+           of audio. 1.0 turns off time scaling.
+    \return 0 for OK, or -1 if the rate is out of range. */
+SPAN_DECLARE(int) playout_rx_set_rate(playout_rx_state_t *s, float rate);
+
+/*! \brief Set the handler for frames a play-out receive pipeline has finished with.
+    \param s The play-out receive pipeline context.
+    \param handler The handler.
+    \param user_data An opaque pointer passed to the handler. */
+SPAN_DECLARE(void) playout_rx_set_frame_handler(playout_rx_state_t *s, playout_rx_frame_handler_t handler, void *user_data);
+
+/*! \brief Get a pointer to the logging context associated with a play-out receive
+           pipeline context.
+    \param s The play-out receive pipeline context.
+    \return A pointer to the logging context, or NULL. */
+SPAN_DECLARE(logging_state_t *) playout_rx_get_logging_state(playout_rx_state_t *s);
+
+/*! \brief Initialise a play-out receive pipeline context.
+    \param s The play-out receive pipeline context.
+    \param playout The play-out buffer the frames are taken from.
+    \param coding The coding of the frames - PLAYOUT_RX_LINEAR, etc.
+    \param bit_rate The bit rate, for G.726. Otherwise, this is ignored.
+    \param packing The packing, for G.726 - G726_PACKING_NONE, etc. Otherwise, this is ignored.
+    \return A pointer to the play-out receive pipeline context, or NULL if there was a problem. */
+SPAN_DECLARE(playout_rx_state_t *) playout_rx_init(playout_rx_state_t *s,
+                                                   playout_state_t *playout,
+                                                   int coding,
+                                                   int bit_rate,
+                                                   int packing);
+
+/*! \brief Release a play-out receive pipeline context. The play-out buffer is not released.
+    \param s The play-out receive pipeline context.
+    \return 0 for OK. */
+SPAN_DECLARE(int) playout_rx_release(playout_rx_state_t *s);
+
+/*! \brief Free a play-out receive pipeline context. The play-out buffer is not freed.
+    \param s The play-out receive pipeline context.
+    \return 0 for OK. */
+SPAN_DECLARE(int) playout_rx_free(playout_rx_state_t *s);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
+/*- End of file ------------------------------------------------------------*/
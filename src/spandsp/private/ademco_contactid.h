@@ -43,10 +43,28 @@ struct ademco_contactid_receiver_state_s
     char rx_digits[16 + 1];
     int rx_digits_len;
 
+    /*! \brief The time since the receiver became ready for the current message, in samples. */
+    int latency;
+    /*! \brief Message latency statistics. */
+    ademco_contactid_receiver_stats_t stats;
+
     /*! \brief Error and flow logging control */
     logging_state_t logging;
 };
 
+/*!
+    Ademco ContactID receiver bank descriptor.
+*/
+struct ademco_contactid_receiver_bank_state_s
+{
+    /*! \brief The number of lines. */
+    int lines;
+    /*! \brief The receivers for the lines. */
+    ademco_contactid_receiver_state_t *line;
+    /*! \brief The DTMF receivers of the lines, in the form needed for batched detection. */
+    dtmf_rx_state_t **dtmf;
+};
+
 struct ademco_contactid_sender_state_s
 {
     tone_report_func_t callback;
@@ -114,5 +114,28 @@ struct adsi_rx_state_s
     logging_state_t logging;
 };
 
+/*! The maximum number of samples an ADSI receive bank processes as one block */
+#define ADSI_RX_BANK_BLOCK_LEN          160
+
+/*!
+    ADSI receiver bank descriptor. This contains all the state information for a bank
+    of ADSI receive channels, all using the same standard.
+ */
+struct adsi_rx_bank_state_s
+{
+    /*! The ADSI standard used by all the channels */
+    int standard;
+    /*! The number of channels */
+    int channels;
+    /*! The phase accumulators of the local oscillators shared by the FSK receivers */
+    uint32_t phase_acc[2];
+    /*! The local oscillator values for the current block */
+    complexi_t lo[ADSI_RX_BANK_BLOCK_LEN][2];
+    /*! The bits, and status changes, received by one channel in the current block */
+    int bits[2*ADSI_RX_BANK_BLOCK_LEN];
+    /*! The receive channels */
+    adsi_rx_state_t *chan;
+};
+
 #endif
 /*- End of file ------------------------------------------------------------*/
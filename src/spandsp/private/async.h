@@ -50,6 +50,11 @@ struct async_tx_state_s
     int bitpos;
     /*! \brief Parity bit. */
     int parity_bit;
+
+    /*! \brief The total number of bits in a framed character. */
+    int frame_bits;
+    /*! \brief The stop bits of a framed character, in their final positions. */
+    uint32_t frame_stop_bits;
 };
 
 /*!
@@ -78,6 +83,8 @@ struct async_rx_state_s
     int bitpos;
     /*! \brief Parity bit. */
     int parity_bit;
+    /*! \brief The number of bits from a start bit to the first stop bit, inclusive. */
+    int frame_bits;
 
     /*! A count of the number of parity errors seen. */
     int parity_errors;
@@ -0,0 +1,66 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * private/channel_group.h - Process a group of channels together, in a cache
+ *                           friendly way.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2013 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 2.1,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(_SPANDSP_PRIVATE_CHANNEL_GROUP_H_)
+#define _SPANDSP_PRIVATE_CHANNEL_GROUP_H_
+
+/*! The description of one channel in a channel group. */
+typedef struct
+{
+    /*! \brief The receive handler, or NULL. */
+    span_rx_handler_t *rx_handler;
+    /*! \brief The transmit handler, or NULL. */
+    span_tx_handler_t *tx_handler;
+    /*! \brief The context for the handlers. NULL for an unused slot. */
+    void *user_data;
+    /*! \brief The number of bytes of the context to prefetch. */
+    int prefetch_len;
+    /*! \brief The receive audio buffer. The receive handler may change it. */
+    int16_t *rx_buf;
+    /*! \brief The transmit audio buffer. */
+    int16_t *tx_buf;
+    /*! \brief The number of samples produced by the transmit handler in the last tick. */
+    int tx_len;
+} channel_group_channel_t;
+
+/*!
+    Channel group descriptor. This defines the working state for a single instance of
+    a group of channels.
+*/
+struct channel_group_state_s
+{
+    /*! \brief The number of slots for channels. */
+    int max_channels;
+    /*! \brief The number of channels in use. */
+    int channels;
+    /*! \brief The channel slots, indexed by handle. */
+    channel_group_channel_t *chan;
+    /*! \brief The handles of the channels in use, in the order they are processed. */
+    int *order;
+};
+
+#endif
+/*- End of file ------------------------------------------------------------*/
@@ -26,6 +26,10 @@
 #if !defined(_SPANDSP_PRIVATE_DTMF_H_)
 #define _SPANDSP_PRIVATE_DTMF_H_
 
+/*! The number of sets of blocks, staggered from the main ones by successive quarters of
+    a block, which are analysed for early reports of digits. */
+#define DTMF_EARLY_BLOCKS   3
+
 /*!
     DTMF generator state descriptor. This defines the state of a single
     working instance of a DTMF generator.
@@ -57,6 +61,10 @@ struct dtmf_rx_state_s
     tone_report_func_t realtime_callback;
     /*! An opaque pointer passed to the real time callback function. */
     void *realtime_callback_data;
+    /*! Optional callback function to deliver early, unconfirmed, reports of digits. */
+    tone_report_func_t early_callback;
+    /*! An opaque pointer passed to the early callback function. */
+    void *early_callback_data;
     /*! True if dialtone should be filtered before processing */
     int filter_dialtone;
 #if defined(SPANDSP_USE_FIXED_POINT)
@@ -72,6 +80,8 @@ struct dtmf_rx_state_s
     int32_t threshold;
     /*! The accumlating total energy on the same period over which the Goertzels work. */
     int32_t energy;
+    /*! The accumlating total energies for the staggered Goertzels. */
+    int32_t early_energy[DTMF_EARLY_BLOCKS];
 #else
     /*! 350Hz filter state for the optional dialtone filter. */
     float z350[2];
@@ -85,6 +95,8 @@ struct dtmf_rx_state_s
     float threshold;
     /*! The accumlating total energy on the same period over which the Goertzels work. */
     float energy;
+    /*! The accumlating total energies for the staggered Goertzels. */
+    float early_energy[DTMF_EARLY_BLOCKS];
 #endif
     /*! Tone detector working states for the row tones. */
     goertzel_state_t row_out[4];
@@ -97,6 +109,19 @@ struct dtmf_rx_state_s
     /*! The current sample number within a processing block. */
     int current_sample;
 
+    /*! Tone detector working states for the row tones, on blocks staggered by one, two
+        and three quarters of a block from the main ones. These are only used when early
+        reporting is enabled. */
+    goertzel_state_t early_row_out[DTMF_EARLY_BLOCKS][4];
+    /*! Tone detector working states for the column tones, on the staggered blocks. */
+    goertzel_state_t early_col_out[DTMF_EARLY_BLOCKS][4];
+    /*! The current sample numbers within the staggered processing blocks. */
+    int early_current_sample[DTMF_EARLY_BLOCKS];
+    /*! The result of the last tone analysis, of either a main or a staggered block. */
+    uint8_t early_last_hit;
+    /*! The digit reported early, which has not yet been confirmed or withdrawn. */
+    uint8_t early_digit;
+
     /*! Tone state duration */
     int duration;
 
@@ -93,6 +93,10 @@ struct fax_modems_state_s
     int rx_trained;
     /*! \brief True if an HDLC frame has been received correctly. */
     int rx_frame_received;
+    /*! \brief The peak amplitude at or below which received audio is treated as an idle line. */
+    int32_t rx_idle_peak;
+    /*! \brief The number of consecutive samples of idle line received. */
+    int rx_idle_samples;
 
     /*! \brief The current receive signal handler */
     span_rx_handler_t *rx_handler;
@@ -120,6 +124,8 @@ struct fax_modems_state_s
     int audio_rx_log;
     /*! \brief Audio logging file handle for transmitted audio. */
     int audio_tx_log;
+    /*! \brief The media tap capturing the audio, or NULL. */
+    media_tap_state_t *tap;
     /*! \brief Error and flow logging control */
     logging_state_t logging;
 };
@@ -42,5 +42,30 @@ struct logging_state_s
     error_handler_func_t span_error;
 };
 
+#if defined(LIBSPANDSP_EXPORTS)
+/* Logging calls are frequent in the protocol engines and the modems, and most of them
+   are dropped, as logging is usually off. Test the level inline, so a dropped entry
+   costs a single branch, rather than a function call and its variable arguments. If
+   SPANDSP_LOG_MAX_LEVEL is defined at build time, entries above that severity level
+   are removed at compile time. Note that the arguments for an entry are not evaluated
+   when the entry is dropped. This header is installed, and applications which expose
+   the internal structures include it, so this only applies while building the library
+   itself. Applications always get the real functions. */
+static __inline__ int span_log_enabled(const logging_state_t *s, int level)
+{
+#if defined(SPANDSP_LOG_MAX_LEVEL)
+    if ((level & SPAN_LOG_SEVERITY_MASK) > SPANDSP_LOG_MAX_LEVEL)
+        return 0;
+    /*endif*/
+#endif
+    return (s  &&  (s->level & SPAN_LOG_SEVERITY_MASK) >= (level & SPAN_LOG_SEVERITY_MASK));
+}
+/*- End of function --------------------------------------------------------*/
+
+#define span_log(s, level, ...) (span_log_enabled((s), (level))  ?  span_log((s), (level), __VA_ARGS__)  :  0)
+
+#define span_log_buf(s, level, tag, buf, len) (span_log_enabled((s), (level))  ?  span_log_buf((s), (level), (tag), (buf), (len))  :  0)
+#endif
+
 #endif
 /*- End of file ------------------------------------------------------------*/
@@ -0,0 +1,72 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * private/media_replay.h - Replay a call recorded by a media tap, through a
+ *                          fresh context.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2013 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 2.1,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(_SPANDSP_PRIVATE_MEDIA_REPLAY_H_)
+#define _SPANDSP_PRIVATE_MEDIA_REPLAY_H_
+
+/*!
+    Media replay descriptor. This defines the working state for a single instance of
+    a media replayer.
+*/
+struct media_replay_state_s
+{
+    /*! \brief The type of the replayed context - MEDIA_REPLAY_FAX, etc. */
+    int type;
+    /*! \brief The replayed context. */
+    void *context;
+    /*! \brief The tap which captures the replayed context's output, for comparison
+               with the recording. */
+    media_tap_state_t *tap;
+    /*! \brief The handler for notes in the recording. */
+    media_replay_note_handler_t *note_handler;
+    /*! \brief An opaque pointer passed to the note handler. */
+    void *note_user_data;
+
+    /*! \brief True once the first record has been seen. */
+    int started;
+    /*! \brief The sequence number expected for the next record. */
+    uint32_t next_seq_no;
+    /*! \brief The number of records which did not match the replay. */
+    int mismatches;
+    /*! \brief The number of records missing from the recording. */
+    int missing;
+
+    /*! \brief The number of samples of a received block of audio, split over several
+               records, gathered so far. */
+    int rx_len;
+    /*! \brief The received audio being gathered. */
+    int16_t rx_amp[MEDIA_REPLAY_MAX_BLOCK];
+    /*! \brief The buffer for transmitted audio. */
+    int16_t tx_amp[MEDIA_REPLAY_MAX_BLOCK];
+    /*! \brief The buffer for the replayed context's output records. */
+    uint8_t out_buf[MEDIA_TAP_MAX_PAYLOAD];
+
+    /*! \brief Error and flow logging control */
+    logging_state_t logging;
+};
+
+#endif
+/*- End of file ------------------------------------------------------------*/
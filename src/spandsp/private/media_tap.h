@@ -0,0 +1,55 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * private/media_tap.h - Non-blocking capture of audio and T.38 IFP packets, for
+ *                       debugging.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2013 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 2.1,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(_SPANDSP_PRIVATE_MEDIA_TAP_H_)
+#define _SPANDSP_PRIVATE_MEDIA_TAP_H_
+
+/*!
+    Media tap descriptor. This defines the working state for a single instance of
+    a media capture tap.
+*/
+struct media_tap_state_s
+{
+    /*! \brief The types of record being captured, as a mask of (1 << type). */
+    int mask;
+    /*! \brief The sequence number for the next record. */
+    uint32_t seq_no;
+    /*! \brief The position in the received audio stream. */
+    uint32_t rx_samples;
+    /*! \brief The position in the transmitted audio stream. */
+    uint32_t tx_samples;
+    /*! \brief The time for FAX page headers, or -1 for none. */
+    time_t header_time;
+    /*! \brief The number of records dropped because the queue was full. This is
+               written by the media thread, and may be read by any thread. */
+    volatile int dropped;
+    /*! \brief The queue of captured records, between the media thread and the
+               writer thread. */
+    queue_state_t *queue;
+};
+
+#endif
+/*- End of file ------------------------------------------------------------*/
@@ -99,5 +99,53 @@ struct modem_connect_tones_rx_state_s
     int framing_ok_announced;
 };
 
+/*! The maximum number of samples a modem connect tones receiver bank processes as one block */
+#define MODEM_CONNECT_TONES_RX_BANK_BLOCK_LEN   160
+
+/*!
+    The detectors for one channel of a modem connect tones receiver bank.
+*/
+typedef struct
+{
+    /*! \brief The CNG detector. */
+    modem_connect_tones_rx_state_t cng;
+    /*! \brief The ANS, ANSam, CED and V.21 preamble detector. */
+    modem_connect_tones_rx_state_t ans;
+    /*! \brief The tone which classified the channel, or MODEM_CONNECT_TONES_NONE. */
+    int tone;
+    /*! \brief The bank this channel belongs to. */
+    modem_connect_tones_rx_bank_state_t *bank;
+    /*! \brief The number of this channel within the bank. */
+    int channel;
+} modem_connect_tones_rx_bank_channel_t;
+
+/*!
+    Modem connect tones receiver bank descriptor. This contains all the state information
+    for a bank of channels, which are being classified by the connect tones they carry.
+*/
+struct modem_connect_tones_rx_bank_state_s
+{
+    /*! \brief The number of channels. */
+    int channels;
+    /*! \brief Callback routine, used to report the classification of a channel. */
+    modem_connect_tones_rx_bank_report_func_t callback;
+    /*! \brief An opaque pointer passed to callback. */
+    void *user_data;
+    /*! \brief The phase accumulators of the local oscillators shared by the V.21 receivers. */
+    uint32_t phase_acc[2];
+    /*! \brief The local oscillator values for the current block. */
+    complexi_t lo[MODEM_CONNECT_TONES_RX_BANK_BLOCK_LEN][2];
+    /*! \brief The bits, and status changes, received by one channel in the current block. */
+    int bits[2*MODEM_CONNECT_TONES_RX_BANK_BLOCK_LEN];
+    /*! \brief The CNG notch filter outputs for the current block, for up to four channels. */
+    float cng_notched[MODEM_CONNECT_TONES_RX_BANK_BLOCK_LEN][4];
+    /*! \brief The ANS notch filter outputs for the current block, for up to four channels. */
+    float ans_notched[MODEM_CONNECT_TONES_RX_BANK_BLOCK_LEN][4];
+    /*! \brief The 15Hz AM filter outputs for the current block, for up to four channels. */
+    float am_filtered[MODEM_CONNECT_TONES_RX_BANK_BLOCK_LEN][4];
+    /*! \brief The channels. */
+    modem_connect_tones_rx_bank_channel_t *chan;
+};
+
 #endif
 /*- End of file ------------------------------------------------------------*/
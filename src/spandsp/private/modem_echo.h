@@ -31,6 +31,14 @@
 #if !defined(_SPANDSP_PRIVATE_MODEM_ECHO_H_)
 #define _SPANDSP_PRIVATE_MODEM_ECHO_H_
 
+/*! The number of samples processed as one block by modem_echo_can_update_block(). The
+    filter taps are adapted once per block. */
+#define MODEM_ECHO_CAN_BLOCK_LEN        32
+/*! The amount the cleaned signal is scaled down by before it is correlated with a block of
+    the transmitted signal. This keeps the block's tap updates within 32 bits at normal modem
+    signal levels, while losing little of the finesse of the adaption. */
+#define MODEM_ECHO_CAN_BLOCK_SHIFT      2
+
 /*!
     Modem line echo canceller descriptor. This defines the working state for a line
     echo canceller.
@@ -50,6 +58,10 @@ struct modem_echo_can_state_s
     int rx_power;
 
     int curr_pos;
+
+    /*! A linear copy of the transmitted signal history, newest first, used by the block
+        processing path. This is MODEM_ECHO_CAN_BLOCK_LEN + taps samples long. */
+    int16_t *block_history;
 };
 
 #endif
@@ -0,0 +1,74 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * private/playout_rx.h - A receive pipeline, from a play-out buffer of coded
+ *                        frames to concealed and time scaled linear audio.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2013 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 2.1,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(_SPANDSP_PRIVATE_PLAYOUT_RX_H_)
+#define _SPANDSP_PRIVATE_PLAYOUT_RX_H_
+
+/*!
+    Play-out receive pipeline descriptor. This defines the working state for a single
+    instance of a play-out receive pipeline.
+*/
+struct playout_rx_state_s
+{
+    /*! \brief The play-out buffer the frames are taken from. */
+    playout_state_t *playout;
+    /*! \brief The coding of the frames - PLAYOUT_RX_LINEAR, etc. */
+    int coding;
+    /*! \brief The number of bits each sample takes in a G.726 frame. This is 8 if the
+               codes are not packed. */
+    int bits_per_sample;
+    /*! \brief The handler for frames the pipeline has finished with. */
+    playout_rx_frame_handler_t frame_handler;
+    /*! \brief An opaque pointer passed to the frame handler. */
+    void *frame_user_data;
+
+    /*! \brief The play-out rate, relative to the arrival rate. */
+    float rate;
+    /*! \brief True while the audio is passing through the time scaler. */
+    int scaling;
+
+    /*! \brief The G.726 decoder. */
+    g726_state_t g726;
+    /*! \brief The packet loss concealer. */
+    plc_state_t plc;
+    /*! \brief The time scaler. */
+    time_scale_state_t time_scale;
+    /*! \brief The buffer for decoded audio, while it is being time scaled. */
+    int16_t frame[PLAYOUT_RX_MAX_FRAME];
+
+    /*! \brief The number of frames played. */
+    int frames_played;
+    /*! \brief The number of frames concealed. */
+    int frames_concealed;
+    /*! \brief The number of frames discarded, as late, too long, or not speech. */
+    int frames_discarded;
+
+    /*! \brief Error and flow logging control */
+    logging_state_t logging;
+};
+
+#endif
+/*- End of file ------------------------------------------------------------*/
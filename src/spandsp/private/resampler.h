@@ -0,0 +1,72 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * private/resampler.h - Polyphase sample rate conversion.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2013 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 2.1,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(_SPANDSP_PRIVATE_RESAMPLER_H_)
+#define _SPANDSP_PRIVATE_RESAMPLER_H_
+
+/*! The length of the prototype filter, in samples at the higher of the two rates, for
+    each unit of the larger of the interpolation and decimation factors. This keeps the
+    length of the filter, in time, the same for all ratios. */
+#define RESAMPLER_FILTER_SPAN       64
+/*! The maximum length of each phase of the filter. */
+#define RESAMPLER_MAX_TAPS          (RESAMPLER_FILTER_SPAN*RESAMPLER_MAX_FACTOR)
+/*! The maximum number of coefficients, for all phases. */
+#define RESAMPLER_MAX_COEFFS        (RESAMPLER_MAX_TAPS + RESAMPLER_MAX_FACTOR)
+/*! The number of input samples processed in one pass. */
+#define RESAMPLER_BLOCK_LEN         256
+
+/*!
+    Resampler descriptor. This defines the working state for a single instance of
+    a sample rate converter.
+*/
+struct resampler_state_s
+{
+    /*! \brief The input sample rate. */
+    int in_rate;
+    /*! \brief The output sample rate. */
+    int out_rate;
+    /*! \brief The interpolation factor, L. */
+    int interpolation;
+    /*! \brief The decimation factor, M. */
+    int decimation;
+    /*! \brief The number of taps in each phase of the filter. */
+    int taps;
+    /*! \brief The filter phase for the next output sample. */
+    int phase;
+    /*! \brief The position in the history of the newest input sample used by the next
+               output sample. */
+    int pos;
+    /*! \brief The filter coefficients, in Q14 format. Each phase is stored in reverse
+               order, so it runs forwards through the history. */
+    int16_t coeffs[RESAMPLER_MAX_COEFFS];
+    /*! \brief The rounding errors of the coefficients, in units of 2^-7 of their least
+               significant bit, stored in the same order. */
+    int16_t fine_coeffs[RESAMPLER_MAX_COEFFS];
+    /*! \brief The last taps - 1 input samples, followed by the block being processed. */
+    int16_t history[RESAMPLER_MAX_TAPS - 1 + RESAMPLER_BLOCK_LEN];
+};
+
+#endif
+/*- End of file ------------------------------------------------------------*/
@@ -77,6 +77,8 @@ struct t30_state_s
     int use_own_tz;
     /*! \brief Optional per instance time zone for the FAX page header timestamp. */
     tz_t tz;
+    /*! \brief The time for the FAX page header timestamp, or -1 to use the system clock. */
+    time_t header_time;
 
     /*! \brief True if remote T.30 procedural interrupts are allowed. */
     int remote_interrupts_allowed;
@@ -312,6 +314,14 @@ struct t30_state_s
     /*! \brief The number of RTN events */
     int rtn_events;
 
+    /*! \brief The block of counters being updated. This is local_counters, unless the
+               application has given a block of its own. */
+    t30_counters_t *counters;
+    /*! \brief The context's own block of counters. */
+    t30_counters_t local_counters;
+    /*! \brief The number of non-ECM image bits passed, towards the next whole octet. */
+    int image_bits;
+
     /*! \brief Error and flow logging control */
     logging_state_t logging;
 };
@@ -128,6 +128,9 @@ struct t38_core_state_s
         received packet numbers jump wildly. */
     int missing_packets;
 
+    /*! \brief The media tap capturing the IFP packets, or NULL. */
+    media_tap_state_t *tap;
+
     /*! \brief Error and flow logging control */
     logging_state_t logging;
 };
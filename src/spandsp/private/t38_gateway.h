@@ -200,6 +200,12 @@ struct t38_gateway_state_s
     /*! T.38 core state */
     t38_gateway_core_state_t core;
 
+    /*! \brief The block of counters being updated. This is local_counters, unless the
+               application has given a block of its own. */
+    t30_counters_t *counters;
+    /*! \brief The context's own block of counters. */
+    t30_counters_t local_counters;
+
     /*! \brief Error and flow logging control */
     logging_state_t logging;
 };
@@ -49,6 +49,20 @@ struct t4_state_s
     const char *header_info;
     /*! \brief Optional per instance time zone for the FAX page header timestamp. */
     struct tz_s *tz;
+    /*! \brief The time for the FAX page header timestamp, or -1 to use the system clock. */
+    time_t header_time;
+    /*! \brief The minute (time/60) for which header_tm is valid, or -1 if it is not
+               valid. */
+    time_t header_minute;
+    /*! \brief The broken down local time used for the current minute's headers. */
+    struct tm header_tm;
+    /*! \brief The text currently rendered into header_bitmap, zero padded. */
+    char header_text[132 + 1];
+    /*! \brief The 16 pixel rows of the rendered FAX page header. */
+    uint8_t *header_bitmap;
+    /*! \brief The bytes per row for which header_bitmap was rendered, or zero if
+               there is no rendered header. */
+    int header_bytes_per_row;
 
     /*! \brief The size of the compressed image on the line side, in bits. */
     int line_image_size;
@@ -107,6 +121,12 @@ struct t4_state_s
     t4_tiff_state_t tiff;
     t4_t6_decode_state_t t4_t6_rx;
     t4_t6_encode_state_t t4_t6_tx;
+#if defined(SPANDSP_SUPPORT_T85)
+    /*! \brief The T.85 decoder, used when receiving T.85 coded pages. */
+    t85_decode_state_t t85_rx;
+    /*! \brief The T.85 encoder, used when sending T.85 coded pages. */
+    t85_encode_state_t t85_tx;
+#endif
 };
 
 #endif
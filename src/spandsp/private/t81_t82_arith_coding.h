@@ -0,0 +1,85 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * private/t81_t82_arith_coding.h - ITU T.81 and T.82 QM-coder arithmetic
+ *                                  encoding and decoding
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2009 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 2.1,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(_SPANDSP_PRIVATE_T81_T82_ARITH_CODING_H_)
+#define _SPANDSP_PRIVATE_T81_T82_ARITH_CODING_H_
+
+/*! The number of contexts the coders can handle */
+#define T81_T82_ARITH_CONTEXTS          4096
+
+/*!
+    T.81/T.82 QM-coder arithmetic encoder state.
+*/
+struct t81_t82_arith_encode_state_s
+{
+    /*! \brief The A register - see T.82 */
+    uint32_t a;
+    /*! \brief The C register - see T.82 */
+    uint32_t c;
+    /*! \brief The number of buffered 0xFF values that might still overflow */
+    int32_t sc;
+    /*! \brief The bit shift counter. This determines when the next byte will be written */
+    int ct;
+    /*! \brief The most recent output byte which is not 0xFF, or -1 for none */
+    int buffer;
+    /*! \brief Callback function to deliver the encoded data, byte by byte */
+    void (*output_byte_handler)(void *, int);
+    /*! \brief Opaque pointer passed to output_byte_handler */
+    void *user_data;
+    /*! \brief The probability status of each context. The MSB is the current more
+               probable symbol. The rest is an index into the probability table. */
+    uint8_t st[T81_T82_ARITH_CONTEXTS];
+};
+
+/*!
+    T.81/T.82 QM-coder arithmetic decoder state.
+*/
+struct t81_t82_arith_decode_state_s
+{
+    /*! \brief The A register - see T.82 */
+    uint32_t a;
+    /*! \brief The C register - see T.82 */
+    uint32_t c;
+    /*! \brief The bit shift counter, or -1 when padding with zeros at a marker */
+    int ct;
+    /*! \brief True while the A and C registers are still being primed at the start
+               of a stripe */
+    int startup;
+    /*! \brief True if the decoder should stop, rather than pad, at a marker */
+    int nopadding;
+    /*! \brief The start of the block of data being decoded */
+    const uint8_t *pscd_start;
+    /*! \brief The next byte of data to be decoded */
+    const uint8_t *pscd_ptr;
+    /*! \brief The end of the block of data being decoded */
+    const uint8_t *pscd_end;
+    /*! \brief The probability status of each context. The MSB is the current more
+               probable symbol. The rest is an index into the probability table. */
+    uint8_t st[T81_T82_ARITH_CONTEXTS];
+};
+
+#endif
+/*- End of file ------------------------------------------------------------*/
@@ -0,0 +1,202 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * private/t85.h - ITU T.85 JBIG for FAX image processing
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2008, 2009 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 2.1,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(_SPANDSP_PRIVATE_T85_H_)
+#define _SPANDSP_PRIVATE_T85_H_
+
+/* T.82 marker codes, which follow an ESC (0xFF) byte */
+enum
+{
+    T82_RESERVE = 0x01,
+    T82_SDNORM = 0x02,
+    T82_SDRST = 0x03,
+    T82_ABORT = 0x04,
+    T82_NEWLEN = 0x05,
+    T82_ATMOVE = 0x06,
+    T82_COMMENT = 0x07
+};
+
+/*! The length of the T.82 bi-level image header, in bytes */
+#define T85_BIH_LEN                 20
+
+/*! The most AT movements the decoder will queue for one stripe */
+#define T85_ATMOVES_MAX             8
+
+/*!
+    T.85 encoder state.
+*/
+struct t85_encode_state_s
+{
+    /*! \brief The arithmetic encoder. */
+    t81_t82_arith_encode_state_t s;
+
+    /*! \brief Callback function to read a row of pixels from the image source. */
+    t4_row_read_handler_t row_read_handler;
+    /*! \brief Opaque pointer passed to row_read_handler. */
+    void *row_read_user_data;
+
+    /*! \brief The image width, in pixels */
+    uint32_t xd;
+    /*! \brief The image length declared in the BIH, in pixels */
+    uint32_t yd;
+    /*! \brief The image length the application has asked for, which may be less than
+               yd, if a NEWLEN is needed */
+    uint32_t yd_new;
+    /*! \brief The number of rows per stripe */
+    uint32_t l0;
+    /*! \brief The maximum horizontal offset of the adaptive template pixel */
+    int mx;
+    /*! \brief The BIH option flags */
+    int options;
+
+    /*! \brief The number of rows encoded so far */
+    uint32_t y;
+    /*! \brief The row number within the current stripe */
+    uint32_t i;
+    /*! \brief True if the previous row was typical, in the TPB sense */
+    int prev_ltp;
+    /*! \brief True once the BIH has been sent */
+    int bih_sent;
+    /*! \brief True once the image is complete, or aborted */
+    int completed;
+
+    /*! \brief The number of bytes per row of the image */
+    int bytes_per_row;
+    /*! \brief Buffer for the current row and the two rows above it */
+    uint8_t *row_buf;
+    /*! \brief The current row */
+    uint8_t *row_h1;
+    /*! \brief The row above the current row */
+    uint8_t *row_h2;
+    /*! \brief The row two above the current row */
+    uint8_t *row_h3;
+
+    /*! \brief Buffer for the compressed data waiting to be collected */
+    uint8_t *bitstream;
+    /*! \brief The allocated length of bitstream */
+    int bitstream_len;
+    /*! \brief The point at which new compressed data is written to bitstream */
+    int bitstream_iptr;
+    /*! \brief The point at which compressed data is read from bitstream */
+    int bitstream_optr;
+
+    /*! \brief The size of the compressed image produced so far, in bytes */
+    int compressed_image_size;
+
+    /*! \brief Error and flow logging control */
+    logging_state_t logging;
+};
+
+/*!
+    T.85 decoder state.
+*/
+struct t85_decode_state_s
+{
+    /*! \brief The arithmetic decoder. */
+    t81_t82_arith_decode_state_t s;
+
+    /*! \brief Callback function to write a row of pixels to the image destination. */
+    t4_row_write_handler_t row_write_handler;
+    /*! \brief Opaque pointer passed to row_write_handler. */
+    void *row_write_user_data;
+
+    /*! \brief The largest image width accepted, or 0 for no limit */
+    uint32_t max_xd;
+    /*! \brief The largest image length accepted, or 0 for no limit */
+    uint32_t max_yd;
+
+    /*! \brief The image width, in pixels */
+    uint32_t xd;
+    /*! \brief The image length, in pixels, as adjusted by any NEWLEN */
+    uint32_t yd;
+    /*! \brief The number of rows per stripe */
+    uint32_t l0;
+    /*! \brief The maximum horizontal offset of the adaptive template pixel */
+    int mx;
+    /*! \brief The BIH option flags */
+    int options;
+
+    /*! \brief The current position of the adaptive template pixel, or 0 for default */
+    int tx;
+    /*! \brief The rows at which queued AT movements take effect */
+    uint32_t at_row[T85_ATMOVES_MAX];
+    /*! \brief The queued AT movements */
+    int at_tx[T85_ATMOVES_MAX];
+    /*! \brief The number of queued AT movements */
+    int at_moves;
+
+    /*! \brief The current phase of the decoding process */
+    int state;
+    /*! \brief The reason decoding failed, as a T4_DECODE_xxx value */
+    int failure;
+    /*! \brief The number of rows decoded so far */
+    uint32_t y;
+    /*! \brief The row number within the current stripe */
+    uint32_t i;
+    /*! \brief The pixel number within the current row */
+    uint32_t x;
+    /*! \brief True if the TPB pseudo pixel of the current row is still to be decoded */
+    int pseudo;
+    /*! \brief True if the previous row was typical, in the TPB sense */
+    int prev_ltp;
+    /*! \brief True if the next stripe starts with reset probabilities */
+    int reset;
+    /*! \brief True if the arithmetic decoder has stopped at a marker, which must be
+               examined before decoding continues */
+    int marker_check;
+    /*! \brief The number of bytes of comment still to be skipped */
+    uint32_t comment_len;
+    /*! \brief Context registers for the current row, and the two rows above it */
+    uint32_t line_h1;
+    uint32_t line_h2;
+    uint32_t line_h3;
+
+    /*! \brief The number of bytes per row of the image */
+    int bytes_per_row;
+    /*! \brief Buffer for the current row and the two rows above it */
+    uint8_t *row_buf;
+    /*! \brief The current row */
+    uint8_t *row_h1;
+    /*! \brief The row above the current row */
+    uint8_t *row_h2;
+    /*! \brief The row two above the current row */
+    uint8_t *row_h3;
+
+    /*! \brief Buffer for incoming data which has not yet been fully processed */
+    uint8_t *buffer;
+    /*! \brief The allocated length of buffer */
+    size_t buffer_len;
+    /*! \brief The number of bytes in buffer */
+    size_t buffer_fill;
+
+    /*! \brief The size of the compressed image received so far, in bytes */
+    int compressed_image_size;
+
+    /*! \brief Error and flow logging control */
+    logging_state_t logging;
+};
+
+#endif
+/*- End of file ------------------------------------------------------------*/
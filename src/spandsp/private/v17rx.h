@@ -111,8 +111,9 @@ struct v17_rx_state_s
     float carrier_track_p;
     /*! \brief The integral part of the carrier tracking filter. */
     float carrier_track_i;
-    /*! \brief The root raised cosine (RRC) pulse shaping filter buffer. */
-    int16_t rrc_filter[V17_RX_FILTER_STEPS];
+    /*! \brief The root raised cosine (RRC) pulse shaping filter buffer. Each sample is
+               stored twice, so the filter's window is always contiguous. */
+    int16_t rrc_filter[2*V17_RX_FILTER_STEPS];
 
     /*! \brief A pointer to the current constellation. */
     const complexi16_t *constellation;
@@ -148,8 +149,9 @@ struct v17_rx_state_s
     float carrier_track_p;
     /*! \brief The integral part of the carrier tracking filter. */
     float carrier_track_i;
-    /*! \brief The root raised cosine (RRC) pulse shaping filter buffer. */
-    float rrc_filter[V17_RX_FILTER_STEPS];
+    /*! \brief The root raised cosine (RRC) pulse shaping filter buffer. Each sample is
+               stored twice, so the filter's window is always contiguous. */
+    float rrc_filter[2*V17_RX_FILTER_STEPS];
 
     /*! \brief A pointer to the current constellation. */
     const complexf_t *constellation;
@@ -31,6 +31,12 @@
 /*! The number of taps in the pulse shaping/bandpass filter */
 #define V17_TX_FILTER_STEPS     9
 
+/*! The length of the modulated pulse of one symbol, in samples. A symbol stays in
+    the pulse shaping filter for V17_TX_FILTER_STEPS bauds of 10/3 samples. */
+#define V17_TX_PULSE_LEN        32
+/*! The number of samples synthesised as a block, from the modulated pulses. */
+#define V17_TX_BLOCK_LEN        64
+
 /*!
     V.17 modem transmit side descriptor. This defines the working state for a
     single instance of a V.17 modem transmitter.
@@ -61,8 +67,15 @@ struct v17_tx_state_s
     float gain;
     /*! \brief A pointer to the constellation currently in use. */
     const complexf_t *constellation;
-    /*! \brief The root raised cosine (RRC) pulse shaping filter buffer. */
-    complexf_t rrc_filter[2*V17_TX_FILTER_STEPS];
+    /*! \brief The pulse shaped and modulated response to a symbol of 1+0j, for
+               each of the 3 baud phases at which a symbol can start. */
+    float pulse_re[3][V17_TX_PULSE_LEN];
+    /*! \brief The pulse shaped and modulated response to a symbol of 0+1j, for
+               each of the 3 baud phases at which a symbol can start. */
+    float pulse_im[3][V17_TX_PULSE_LEN];
+    /*! \brief The sum of the modulated pulses of the symbols sent so far, over the
+               current block and the following V17_TX_PULSE_LEN samples. */
+    float synth[V17_TX_BLOCK_LEN + V17_TX_PULSE_LEN];
 #endif
 
     /*! \brief Current offset into the RRC pulse shaping filter buffer. */
@@ -26,11 +26,41 @@
 #if !defined(_SPANDSP_PRIVATE_V18_H_)
 #define _SPANDSP_PRIVATE_V18_H_
 
+/*! The number of Goertzel filters in the automoding probe. This is a mark and space
+    pair for each FSK receive channel, the eight DTMF frequencies, and three guard
+    frequencies for the network tones close to the V.23 backward channel. */
+#define V18_PROBE_BINS              19
+
+/*!
+    V.18 automoding probe. This looks for the signatures of all the modes at once,
+    with a single bank of Goertzel filters, so no demodulator need run until a mode
+    has been chosen.
+*/
+typedef struct
+{
+    /*! \brief The Goertzel filters. */
+    goertzel_state_t bins[V18_PROBE_BINS];
+    /*! \brief The total energy in the current block. */
+#if defined(SPANDSP_USE_FIXED_POINT)
+    int32_t energy;
+#else
+    float energy;
+#endif
+    /*! \brief The number of samples so far in the current block. */
+    int current_sample;
+    /*! \brief The mode whose signature was seen in the last block. */
+    int candidate;
+    /*! \brief The number of consecutive blocks in which the candidate has been seen. */
+    int hits;
+} v18_probe_state_t;
+
 struct v18_state_s
 {
     /*! \brief True if we are the calling modem */
     int calling_party;
     int mode;
+    /*! \brief The V18_AUTOMODING options, if automoding is in progress, or zero. */
+    int automoding;
     put_msg_func_t put_msg;
     void *user_data;
 
@@ -56,6 +86,8 @@ struct v18_state_s
     int rx_msg_len;
     int bit_pos;
     int in_progress;
+    /*! \brief The automoding probe, used until a mode has been chosen. */
+    v18_probe_state_t probe;
 
     /*! \brief Error and flow logging control */
     logging_state_t logging;
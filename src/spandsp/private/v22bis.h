@@ -37,6 +37,9 @@
 /*! The number of taps in the receive pulse shaping/bandpass filter */
 #define V22BIS_RX_FILTER_STEPS      27
 
+/*! The maximum number of samples the receiver's front end processes in one block */
+#define V22BIS_RX_BLOCK_LEN         40
+
 /*! Segments of the training sequence on the receive side */
 enum
 {
@@ -93,9 +96,6 @@ struct v22bis_state_s
     /* Receive section */
     struct
     {
-        /*! \brief Current offset into the RRC pulse shaping filter buffer. */
-        int rrc_filter_step;
-
         /*! \brief The register for the data scrambler. */
         uint32_t scramble_reg;
         /*! \brief A counter for the number of consecutive bits of repeating pattern through
@@ -131,31 +131,33 @@ struct v22bis_state_s
 
         int constellation_state;
 
-#if defined(SPANDSP_USE_FIXED_POINTx)
+#if defined(SPANDSP_USE_FIXED_POINT)
         /*! \brief The scaling factor assessed by the AGC algorithm. */
-        float agc_scaling;
-        /*! \brief The root raised cosine (RRC) pulse shaping filter buffer. */
-        int16_t rrc_filter[V22BIS_RX_FILTER_STEPS];
+        int32_t agc_scaling;
+        /*! \brief The root raised cosine (RRC) pulse shaping filter buffer. The first
+                   V22BIS_RX_FILTER_STEPS - 1 entries hold the tail of the previous block. */
+        int16_t rrc_filter[V22BIS_RX_FILTER_STEPS - 1 + V22BIS_RX_BLOCK_LEN];
 
         /*! \brief The current delta factor for updating the equalizer coefficients. */
-        float eq_delta;
+        int16_t eq_delta;
         /*! \brief The adaptive equalizer coefficients. */
-        complexi_t eq_coeff[2*V22BIS_EQUALIZER_LEN + 1];
+        complexi16_t eq_coeff[2*V22BIS_EQUALIZER_LEN + 1];
         /*! \brief The equalizer signal buffer. */
-        complexi_t eq_buf[V22BIS_EQUALIZER_MASK + 1];
+        complexi16_t eq_buf[V22BIS_EQUALIZER_MASK + 1];
 
         /*! \brief A measure of how much mismatch there is between the real constellation,
                    and the decoded symbol positions. */
         float training_error;
         /*! \brief The proportional part of the carrier tracking filter. */
-        float carrier_track_p;
+        int32_t carrier_track_p;
         /*! \brief The integral part of the carrier tracking filter. */
-        float carrier_track_i;
+        int32_t carrier_track_i;
 #else
         /*! \brief The scaling factor assessed by the AGC algorithm. */
         float agc_scaling;
-        /*! \brief The root raised cosine (RRC) pulse shaping filter buffer. */
-        float rrc_filter[V22BIS_RX_FILTER_STEPS];
+        /*! \brief The root raised cosine (RRC) pulse shaping filter buffer. The first
+                   V22BIS_RX_FILTER_STEPS - 1 entries hold the tail of the previous block. */
+        float rrc_filter[V22BIS_RX_FILTER_STEPS - 1 + V22BIS_RX_BLOCK_LEN];
 
         /*! \brief The current delta factor for updating the equalizer coefficients. */
         float eq_delta;
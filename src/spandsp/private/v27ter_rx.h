@@ -92,8 +92,9 @@ struct v27ter_rx_state_s
     float carrier_track_p;
     /*! \brief The integral part of the carrier tracking filter. */
     float carrier_track_i;
-    /*! \brief The root raised cosine (RRC) pulse shaping filter buffer. */
-    int16_t rrc_filter[V27TER_RX_FILTER_STEPS];
+    /*! \brief The root raised cosine (RRC) pulse shaping filter buffer. Each sample is
+               stored twice, so the filter's window is always contiguous. */
+    int16_t rrc_filter[2*V27TER_RX_FILTER_STEPS];
 #else
     /*! \brief The scaling factor assessed by the AGC algorithm. */
     float agc_scaling;
@@ -117,8 +118,9 @@ struct v27ter_rx_state_s
     float carrier_track_p;
     /*! \brief The integral part of the carrier tracking filter. */
     float carrier_track_i;
-    /*! \brief The root raised cosine (RRC) pulse shaping filter buffer. */
-    float rrc_filter[V27TER_RX_FILTER_STEPS];
+    /*! \brief The root raised cosine (RRC) pulse shaping filter buffer. Each sample is
+               stored twice, so the filter's window is always contiguous. */
+    float rrc_filter[2*V27TER_RX_FILTER_STEPS];
 #endif
     /*! \brief Current offset into the RRC pulse shaping filter buffer. */
     int rrc_filter_step;
@@ -29,6 +29,15 @@
 /*! The number of taps in the pulse shaping/bandpass filter */
 #define V27TER_TX_FILTER_STEPS      9
 
+/*! The length of the modulated pulse of one symbol at 4800bps, in samples. A symbol
+    stays in the pulse shaping filter for V27TER_TX_FILTER_STEPS bauds of 5 samples. */
+#define V27TER_TX_PULSE_LEN_4800    48
+/*! The length of the modulated pulse of one symbol at 2400bps, in samples. A symbol
+    stays in the pulse shaping filter for V27TER_TX_FILTER_STEPS bauds of 20/3 samples. */
+#define V27TER_TX_PULSE_LEN_2400    64
+/*! The number of samples synthesised as a block, from the modulated pulses. */
+#define V27TER_TX_BLOCK_LEN         64
+
 /*!
     V.27ter modem transmit side descriptor. This defines the working state for a
     single instance of a V.27ter modem transmitter.
@@ -59,8 +68,15 @@ struct v27ter_tx_state_s
     float gain_2400;
     /*! \brief The gain factor needed to achieve the specified output power at 4800bps. */
     float gain_4800;
-    /*! \brief The root raised cosine (RRC) pulse shaping filter buffer. */
-    complexf_t rrc_filter[2*V27TER_TX_FILTER_STEPS];
+    /*! \brief The pulse shaped and modulated response to a symbol of 1+0j, for
+               each of the baud phases at which a symbol can start. */
+    float pulse_re[3][V27TER_TX_PULSE_LEN_2400];
+    /*! \brief The pulse shaped and modulated response to a symbol of 0+1j, for
+               each of the baud phases at which a symbol can start. */
+    float pulse_im[3][V27TER_TX_PULSE_LEN_2400];
+    /*! \brief The sum of the modulated pulses of the symbols sent so far, over the
+               current block and the following V27TER_TX_PULSE_LEN_2400 samples. */
+    float synth[V27TER_TX_BLOCK_LEN + V27TER_TX_PULSE_LEN_2400];
 #endif
     /*! \brief Current offset into the RRC pulse shaping filter buffer. */
     int rrc_filter_step;
@@ -0,0 +1,128 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * resampler.h - Polyphase sample rate conversion.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2013 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 2.1,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \file */
+
+#if !defined(_SPANDSP_RESAMPLER_H_)
+#define _SPANDSP_RESAMPLER_H_
+
+/*! \page resampler_page Sample rate conversion
+\section resampler_page_sec_1 What does it do?
+The spandsp detectors and modems work at 8000 samples/second. The resampler
+converts audio between 8000 samples/second and the rates used by wideband
+legs, such as 16000 samples/second for G.722, and 48000 samples/second for
+Opus. It can convert between any pair of rates whose ratio, in its lowest
+terms, is L/M with neither L nor M greater than RESAMPLER_MAX_FACTOR. So 8000,
+16000, 24000, 32000 and 48000 samples/second may be freely mixed.
+
+\section resampler_page_sec_2 How does it work?
+The conversion is a classic polyphase interpolate by L, filter, and decimate by
+M. The lowpass filter is a Kaiser windowed sinc, with a cutoff just below half
+the lower of the two rates. It is split into L phases, so only the outputs which
+survive decimation are ever calculated, and each of those costs a single dot
+product over a contiguous run of the input history, using vec_dot_prodi16().
+The filter is the same length, in time, for all ratios, so the delay through the
+resampler is always about 4ms.
+
+Audio is processed in blocks of any length. Each block produces as many output
+samples as are ready. There is no buffering beyond the filter's own history,
+so the output for an input sample appears as soon as the filter allows.
+resampler_rx() feeds the converted audio straight to a receive handler, such as
+fax_rx(), a block at a time, so the converted audio never needs a buffer of its
+own.
+*/
+
+/*! The largest interpolation or decimation factor which the resampler supports. */
+#define RESAMPLER_MAX_FACTOR        6
+
+/*!
+    Resampler descriptor. This defines the working state for a single instance of
+    a sample rate converter.
+*/
+typedef struct resampler_state_s resampler_state_t;
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+/*! \brief Convert a block of audio to the output sample rate.
+    \param s The resampler context.
+    \param out The buffer for the converted audio. This must have room for at least
+           len*L/M samples, rounded up, where L/M is the conversion ratio.
+    \param amp The audio to be converted.
+    \param len The number of samples in amp.
+    \return The number of samples placed in out. */
+SPAN_DECLARE(int) resampler(resampler_state_t *s, int16_t out[], const int16_t amp[], int len);
+
+/*! \brief Convert a block of audio to the output sample rate, and pass it on to a
+           receive handler.
+    \param s The resampler context.
+    \param handler The receive handler, e.g. fax_rx() or dtmf_rx().
+    \param user_data The context for the receive handler.
+    \param amp The audio to be converted.
+    \param len The number of samples in amp.
+    \return The number of samples in amp which have not been processed. */
+SPAN_DECLARE(int) resampler_rx(resampler_state_t *s, span_rx_handler_t handler, void *user_data, const int16_t amp[], int len);
+
+/*! \brief Get the maximum number of output samples a block of input could produce.
+    \param s The resampler context.
+    \param len The number of samples in the input block.
+    \return The maximum number of output samples. */
+SPAN_DECLARE(int) resampler_max_output(resampler_state_t *s, int len);
+
+/*! \brief Get the delay through a resampler.
+    \param s The resampler context.
+    \return The delay, in output samples. */
+SPAN_DECLARE(int) resampler_get_delay(resampler_state_t *s);
+
+/*! \brief Reset a resampler, clearing its history.
+    \param s The resampler context.
+    \return 0 for OK. */
+SPAN_DECLARE(int) resampler_restart(resampler_state_t *s);
+
+/*! \brief Initialise a resampler context.
+    \param s The resampler context.
+    \param in_rate The input sample rate, in samples/second.
+    \param out_rate The output sample rate, in samples/second.
+    \return A pointer to the resampler context, or NULL if the rates are not supported. */
+SPAN_DECLARE(resampler_state_t *) resampler_init(resampler_state_t *s, int in_rate, int out_rate);
+
+/*! \brief Release a resampler context.
+    \param s The resampler context.
+    \return 0 for OK. */
+SPAN_DECLARE(int) resampler_release(resampler_state_t *s);
+
+/*! \brief Free a resampler context.
+    \param s The resampler context.
+    \return 0 for OK. */
+SPAN_DECLARE(int) resampler_free(resampler_state_t *s);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
+/*- End of file ------------------------------------------------------------*/
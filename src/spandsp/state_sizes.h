@@ -0,0 +1,76 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * state_sizes.h - A register of the sizes of the spandsp state structures.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2013 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 2.1,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \file */
+
+#if !defined(_SPANDSP_STATE_SIZES_H_)
+#define _SPANDSP_STATE_SIZES_H_
+
+/*! \page state_sizes_page State size register
+\section state_sizes_page_sec_1 What does it do?
+The state structures of the spandsp modules are opaque to applications, so
+applications cannot use sizeof() to plan their memory use. This register
+reports the size of each module's state structure, as built into the library.
+
+\section state_sizes_page_sec_2 How does it work?
+The sizes are the static part of each instance - the memory allocated by a
+module's init function when it is passed a NULL state pointer. A few modules,
+such as the echo cancellers and the T.4 image handlers, allocate further
+buffers whose sizes depend on their configuration. Those can be measured by
+installing counting allocators with span_mem_allocators() around the module's
+init function. The memory_footprint program in the tests directory does this for
+some typical configurations.
+*/
+
+/*! The size of one type of state structure. */
+typedef struct
+{
+    /*! \brief The name of the state type, e.g. "v17_rx_state_t". */
+    const char *name;
+    /*! \brief The size of the state structure, in bytes. */
+    size_t size;
+} span_state_size_t;
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+/*! \brief Get the register of state structure sizes.
+    \param entries Set to the number of entries in the register.
+    \return A pointer to the register. */
+SPAN_DECLARE(const span_state_size_t *) span_state_sizes(int *entries);
+
+/*! \brief Get the size of one type of state structure.
+    \param name The name of the state type, e.g. "v17_rx_state_t".
+    \return The size of the state structure, in bytes, or -1 if the name is not known. */
+SPAN_DECLARE(int) span_state_size(const char *name);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
+/*- End of file ------------------------------------------------------------*/
@@ -144,6 +144,8 @@ There are many other commonly encountered variations between machines, including
 #define T30_MAX_IDENT_LEN           20
 /*! The maximum length of the user string to insert in page headers */
 #define T30_MAX_PAGE_HEADER_INFO    50
+/*! The maximum length of a checkpoint of a T.30 context */
+#define T30_MAX_CHECKPOINT_LEN      (256*265 + 1024)
 
 typedef struct t30_state_s t30_state_t;
 
@@ -577,6 +579,46 @@ typedef struct
 #endif
 } t30_stats_t;
 
+/*!
+    A block of counters, kept up to date by a T.30 context, or a T.38 gateway, as its
+    calls proceed. Each counter is only ever written by the thread running the context,
+    and is a naturally aligned 32 bit word, so any other thread may read the counters at
+    any time, without locks, and without calling into the context. The counters wrap, so
+    readers should work with the differences between successive readings, modulo 2^32.
+    Many contexts may share one block, if they are all run from the same thread.
+*/
+typedef struct
+{
+    /*! \brief The number of calls ended. */
+    volatile uint32_t calls;
+    /*! \brief The number of calls ended with a status other than T30_ERR_OK. */
+    volatile uint32_t calls_failed;
+    /*! \brief The number of pages sent and confirmed. */
+    volatile uint32_t pages_tx;
+    /*! \brief The number of pages received. */
+    volatile uint32_t pages_rx;
+    /*! \brief The number of pages relayed and confirmed, by a T.38 gateway. */
+    volatile uint32_t pages_relayed;
+    /*! \brief The number of bad pixel rows in received non-ECM pages. */
+    volatile uint32_t bad_rows;
+    /*! \brief The number of retrains - FTT, RTN and RTP responses, sent or received. */
+    volatile uint32_t retrains;
+    /*! \brief The number of PPR responses sent. */
+    volatile uint32_t pprs_tx;
+    /*! \brief The number of PPR responses received. */
+    volatile uint32_t pprs_rx;
+    /*! \brief The number of ECM frames sent again, after a PPR. */
+    volatile uint32_t ecm_frames_resent;
+    /*! \brief The number of falls back to a lower bit rate. */
+    volatile uint32_t fallbacks;
+    /*! \brief The time for which a fast modem receiver was trained, in samples. */
+    volatile uint32_t modem_lock_samples;
+    /*! \brief The number of image octets sent, including ECM frames sent again. */
+    volatile uint32_t image_octets_tx;
+    /*! \brief The number of image octets received. */
+    volatile uint32_t image_octets_rx;
+} t30_counters_t;
+
 #if defined(__cplusplus)
 extern "C"
 {
@@ -698,6 +740,30 @@ SPAN_DECLARE(void) t30_timer_update(t30_state_t *s, int samples);
     \param t A pointer to a buffer for the statistics. */
 SPAN_DECLARE(void) t30_get_transfer_statistics(t30_state_t *s, t30_stats_t *t);
 
+/*! Select the block of counters a T.30 context updates as its calls proceed. A context
+    starts with a block of its own. An application monitoring many contexts will usually
+    give each one a block in an array it owns, so the blocks remain readable when a
+    context is freed, and can be scanned quickly by a monitoring thread.
+    \brief Select the block of counters a T.30 context updates.
+    \param s The T.30 context.
+    \param counters The block of counters, or NULL to return to the context's own block.
+           The block is not cleared. */
+SPAN_DECLARE(void) t30_set_counters(t30_state_t *s, t30_counters_t *counters);
+
+/*! Get a pointer to the block of counters a T.30 context updates. The counters may be
+    read from any thread, through this pointer, for as long as the context exists.
+    \brief Get a pointer to the block of counters a T.30 context updates.
+    \param s The T.30 context.
+    \return A pointer to the block of counters. */
+SPAN_DECLARE(t30_counters_t *) t30_get_counters(t30_state_t *s);
+
+/*! Add one block of counters to a running total. This may be called from any thread,
+    while the block is being updated. Each counter is read once.
+    \brief Add one block of counters to a running total.
+    \param total The running total.
+    \param counters The block of counters to be added. */
+SPAN_DECLARE(void) t30_counters_accumulate(t30_counters_t *total, const t30_counters_t *counters);
+
 /*! Request a local interrupt of FAX exchange.
     \brief Request a local interrupt of FAX exchange.
     \param s The T.30 context.
@@ -710,6 +776,33 @@ SPAN_DECLARE(void) t30_local_interrupt_request(t30_state_t *s, int state);
     \param state True to allow interruptd, else false. */
 SPAN_DECLARE(void) t30_remote_interrupts_allowed(t30_state_t *s, int state);
 
+/*! Checkpoint a T.30 context, so the call can be moved to another context, which may be
+    in another process or on another machine. A checkpoint can only be made while the T.30
+    engine is waiting to hear from the far end, with nothing being sent or received, and
+    with no image data received for the current page. Such a point occurs at least once
+    in each phase of the call.
+    \brief Checkpoint a T.30 context.
+    \param s The T.30 context.
+    \param buf The buffer for the checkpoint.
+    \param max_len The length of buf. T30_MAX_CHECKPOINT_LEN is always enough.
+    \return The length of the checkpoint, or -1 if the call cannot be checkpointed at
+            present, or buf is too small. */
+SPAN_DECLARE(int) t30_checkpoint(t30_state_t *s, uint8_t buf[], int max_len);
+
+/*! Restore a T.30 context from a checkpoint. The context must be freshly initialised, for the
+    same calling or answering role, and have the same settings, callbacks and files as the
+    checkpointed one. A document being sent is reopened, and positioned at the page, and
+    the point in that page, where the checkpoint was made. Pages received after the restore
+    go to the receive file of the new context, and joining them to the pages received
+    before the checkpoint is up to the application. The modems, which have no state to
+    move at a checkpoint, are restarted for the current phase of the call.
+    \brief Restore a T.30 context from a checkpoint.
+    \param s The T.30 context.
+    \param buf The checkpoint.
+    \param len The length of the checkpoint.
+    \return 0 for OK, else -1. If this fails, the context is left as it was. */
+SPAN_DECLARE(int) t30_restore(t30_state_t *s, const uint8_t buf[], int len);
+
 #if defined(__cplusplus)
 }
 #endif
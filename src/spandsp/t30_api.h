@@ -402,6 +402,14 @@ SPAN_DECLARE(int) t30_set_tx_page_header_info(t30_state_t *s, const char *info);
     \return 0 for OK, else -1. */
 SPAN_DECLARE(int) t30_set_tx_page_header_tz(t30_state_t *s, const char *tzstring);
 
+/*! Set the time for the transmitted header timestamp, in place of the system clock.
+    This takes effect from the start of the next page sent.
+    \brief Set the transmitted header timestamp time associated with a T.30 context.
+    \param s The T.30 context.
+    \param when The time, or -1 to use the system clock.
+    \return 0 for OK, else -1. */
+SPAN_DECLARE(int) t30_set_tx_page_header_time(t30_state_t *s, time_t when);
+
 /*! Get the header information associated with a T.30 context.
     \brief Get the header information associated with a T.30 context.
     \param s The T.30 context.
@@ -102,6 +102,22 @@ SPAN_DECLARE(void) t31_set_transmit_on_idle(t31_state_t *s, int transmit_on_idle
 */
 SPAN_DECLARE(void) t31_set_tep_mode(t31_state_t *s, int use_tep);
 
+/*! Set the level below which received audio is treated as an idle line. While no
+    signal is present, idle line is not passed to the receive modems.
+    \brief Set the idle line cutoff level.
+    \param s The T.31 modem context.
+    \param cutoff The cutoff level, in dBm0. The default is -50dBm0.
+*/
+SPAN_DECLARE(void) t31_set_rx_idle_cutoff(t31_state_t *s, float cutoff);
+
+/*! Attach a media tap to a T.31 context, to capture the audio and the T.38 IFP packets
+    it sends and receives. This may be done at any point in a call.
+    \brief Attach a media tap to a T.31 context.
+    \param s The T.31 modem context.
+    \param tap The media tap, or NULL to stop capturing.
+*/
+SPAN_DECLARE(void) t31_set_tap(t31_state_t *s, media_tap_state_t *tap);
+
 /*! Select whether T.38 data will be paced as it is transmitted.
     \brief Select whether T.38 data will be paced.
     \param s The T.31 modem context.
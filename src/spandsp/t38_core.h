@@ -374,6 +374,14 @@ SPAN_DECLARE(void) t38_set_sequence_number_handling(t38_core_state_t *s, int che
 */
 SPAN_DECLARE(void) t38_set_tep_handling(t38_core_state_t *s, int allow_for_tep);
 
+/*! Attach a media tap to a T.38 context, to capture the IFP packets it sends and
+    receives. This may be done at any point in a call.
+    \brief Attach a media tap to a T.38 context.
+    \param s The T.38 context.
+    \param tap The media tap, or NULL to stop capturing.
+*/
+SPAN_DECLARE(void) t38_core_set_tap(t38_core_state_t *s, media_tap_state_t *tap);
+
 /*! Get a pointer to the logging context associated with a T.38 context.
     \brief Get a pointer to the logging context associated with a T.38 context.
     \param s The T.38 context.
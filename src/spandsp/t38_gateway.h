@@ -176,6 +176,22 @@ SPAN_DECLARE(void) t38_gateway_set_nsx_suppression(t38_gateway_state_t *s,
 */
 SPAN_DECLARE(void) t38_gateway_set_tep_mode(t38_gateway_state_t *s, int use_tep);
 
+/*! Set the level below which received audio is treated as an idle line. While no
+    signal is present, idle line is not passed to the receive modems.
+    \brief Set the idle line cutoff level.
+    \param s The T.38 context.
+    \param cutoff The cutoff level, in dBm0. The default is -50dBm0.
+*/
+SPAN_DECLARE(void) t38_gateway_set_rx_idle_cutoff(t38_gateway_state_t *s, float cutoff);
+
+/*! Attach a media tap to a T.38 gateway, to capture the audio and the T.38 IFP packets
+    it sends and receives. This may be done at any point in a call.
+    \brief Attach a media tap to a T.38 gateway.
+    \param s The T.38 context.
+    \param tap The media tap, or NULL to stop capturing.
+*/
+SPAN_DECLARE(void) t38_gateway_set_tap(t38_gateway_state_t *s, media_tap_state_t *tap);
+
 /*! Select whether non-ECM fill bits are to be removed during transmission.
     \brief Select whether non-ECM fill bits are to be removed during transmission.
     \param s The T.38 context.
@@ -189,6 +205,21 @@ SPAN_DECLARE(void) t38_gateway_set_fill_bit_removal(t38_gateway_state_t *s, int
     \param t A pointer to a buffer for the statistics. */
 SPAN_DECLARE(void) t38_gateway_get_transfer_statistics(t38_gateway_state_t *s, t38_stats_t *t);
 
+/*! Select the block of counters a T.38 gateway updates as its calls proceed. A gateway
+    counts the pages it relays, and the time its fast modem receiver is trained. See
+    t30_set_counters().
+    \brief Select the block of counters a T.38 gateway updates.
+    \param s The T.38 context.
+    \param counters The block of counters, or NULL to return to the context's own block. */
+SPAN_DECLARE(void) t38_gateway_set_counters(t38_gateway_state_t *s, t30_counters_t *counters);
+
+/*! Get a pointer to the block of counters a T.38 gateway updates. The counters may be
+    read from any thread, through this pointer, for as long as the context exists.
+    \brief Get a pointer to the block of counters a T.38 gateway updates.
+    \param s The T.38 context.
+    \return A pointer to the block of counters. */
+SPAN_DECLARE(t30_counters_t *) t38_gateway_get_counters(t38_gateway_state_t *s);
+
 /*! Get a pointer to the T.38 core IFP packet engine associated with a
     gateway mode T.38 context.
     \brief Get a pointer to the T.38 core IFP packet engine associated
@@ -37,6 +37,11 @@
 /* Make sure the HDLC frame buffers are big enough for ECM frames. */
 #define T38_MAX_HDLC_LEN        260
 
+/*! The length of the T.38 part of a checkpoint, which precedes the T.30 engine's checkpoint */
+#define T38_TERMINAL_CHECKPOINT_HEADER_LEN      24
+/*! The maximum length of a checkpoint of a T.38 terminal context */
+#define T38_TERMINAL_MAX_CHECKPOINT_LEN         (T38_TERMINAL_CHECKPOINT_HEADER_LEN + T30_MAX_CHECKPOINT_LEN)
+
 enum
 {
     /*! This option enables the continuous streaming of FAX data, with no allowance for
@@ -83,6 +88,37 @@ SPAN_DECLARE(void) t38_terminal_set_tep_mode(t38_terminal_state_t *s, int use_te
 */
 SPAN_DECLARE(void) t38_terminal_set_fill_bit_removal(t38_terminal_state_t *s, int remove);
 
+/*! Attach a media tap to a termination mode T.38 context, to capture the IFP packets it
+    sends and receives, and its timer ticks. This may be done at any point in a call.
+    \brief Attach a media tap to a termination mode T.38 context.
+    \param s The T.38 context.
+    \param tap The media tap, or NULL to stop capturing.
+*/
+SPAN_DECLARE(void) t38_terminal_set_tap(t38_terminal_state_t *s, media_tap_state_t *tap);
+
+/*! Checkpoint a termination mode T.38 context, so the call can be moved to another
+    T.38 context. See t30_checkpoint() for when this is possible. Any timed transmission,
+    such as a trailing no-signal indicator, must also be complete.
+    \brief Checkpoint a T.38 context.
+    \param s The T.38 context.
+    \param buf The buffer for the checkpoint.
+    \param max_len The length of buf. T38_TERMINAL_MAX_CHECKPOINT_LEN is always enough.
+    \return The length of the checkpoint, or -1 if the call cannot be checkpointed at
+            present, or buf is too small.
+*/
+SPAN_DECLARE(int) t38_terminal_checkpoint(t38_terminal_state_t *s, uint8_t buf[], int max_len);
+
+/*! Restore a termination mode T.38 context from a checkpoint made by
+    t38_terminal_checkpoint(). The IFP packet sequence numbers continue from where they
+    were. See t30_restore() for how the context must be prepared.
+    \brief Restore a T.38 context from a checkpoint.
+    \param s The T.38 context.
+    \param buf The checkpoint.
+    \param len The length of the checkpoint.
+    \return 0 for OK, else -1.
+*/
+SPAN_DECLARE(int) t38_terminal_restore(t38_terminal_state_t *s, const uint8_t buf[], int len);
+
 /*! Get a pointer to the T.30 engine associated with a termination mode T.38 context.
     \brief Get a pointer to the T.30 engine associated with a T.38 context.
     \param s The T.38 context.
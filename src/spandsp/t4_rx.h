@@ -45,6 +45,21 @@ for FAX transmission.
     \return 0 for OK, or non-zero for a problem that requires the image be interrupted. */
 typedef int (*t4_row_write_handler_t)(void *user_data, const uint8_t buf[], size_t len);
 
+/*! Return values from the streaming image decoders */
+enum
+{
+    /*! More data is needed before the image is complete */
+    T4_DECODE_MORE_DATA = 0,
+    /*! The image is complete */
+    T4_DECODE_OK = -1,
+    /*! The sender aborted the image */
+    T4_DECODE_ABORTED = -2,
+    /*! Memory could not be allocated */
+    T4_DECODE_NOMEM = -3,
+    /*! The data is not a valid image */
+    T4_DECODE_INVALID_DATA = -4
+};
+
 /*! Supported compression modes. */
 typedef enum
 {
@@ -297,6 +297,14 @@ SPAN_DECLARE(void) t4_tx_set_header_info(t4_tx_state_t *s, const char *info);
     \param tz A time zone descriptor. */
 SPAN_DECLARE(void) t4_tx_set_header_tz(t4_tx_state_t *s, tz_t *tz);
 
+/*! Set the time for the time stamp in page header lines, in place of the system clock.
+    This lets a page be sent with the same header at a later time, as when a recorded
+    call is replayed.
+    \brief Set the header time.
+    \param s The T.4 context.
+    \param when The time, or -1 to use the system clock. */
+SPAN_DECLARE(void) t4_tx_set_header_time(t4_tx_state_t *s, time_t when);
+
 /*! \brief Set the row read handler for a T.4 transmit context.
     \param s The T.4 transmit context.
     \param handler A pointer to the handler routine.
@@ -0,0 +1,147 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * t81_t82_arith_coding.h - ITU T.81 and T.82 QM-coder arithmetic encoding
+ *                          and decoding
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2009 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 2.1,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \file */
+
+#if !defined(_SPANDSP_T81_T82_ARITH_CODING_H_)
+#define _SPANDSP_T81_T82_ARITH_CODING_H_
+
+/*! \page t81_t82_arith_coding_page T.81 and T.82 QM-coder arithmetic encoding and decoding
+
+\section t81_t82_arith_coding_page_sec_1 What does it do?
+A similar arithmetic coder, called the QM-coder, is used by several image compression
+schemes. These routines implement this coder in a (hopefully) reusable way. They are
+used by the T.85 (JBIG for FAX) codec.
+
+\section t81_t82_arith_coding_page_sec_2 How does it work?
+The coder is an adaptive binary arithmetic coder, with one 7 bit probability state
+and one "more probable symbol" bit held for each of up to 4096 contexts, as per
+T.82 section 6.8. The encoder hands its output to a callback, one byte at a time,
+with 0xFF bytes already followed by a stuffed 0x00. The decoder works from a block
+of bytes provided by the caller, and stops, without losing any state, when it runs
+out of input, so it can be driven from a data stream arriving in fragments.
+*/
+
+/*! State of a working instance of the QM-coder arithmetic encoder */
+typedef struct t81_t82_arith_encode_state_s t81_t82_arith_encode_state_t;
+
+/*! State of a working instance of the QM-coder arithmetic decoder */
+typedef struct t81_t82_arith_decode_state_s t81_t82_arith_decode_state_t;
+
+/*! The T.82 escape byte, which introduces all marker codes in a JBIG data stream. */
+#define T81_T82_ARITH_MARKER_ESC        0xFF
+/*! The T.82 stuffing byte, which follows a data byte of 0xFF. */
+#define T81_T82_ARITH_MARKER_STUFF      0x00
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+/*! \brief Encode one pixel (binary decision).
+    \param s The encoder context.
+    \param cx The context number, in the range 0 to 4095.
+    \param bit The value to be encoded - 0 or 1. */
+SPAN_DECLARE(void) t81_t82_arith_encode(t81_t82_arith_encode_state_t *s, int cx, int bit);
+
+/*! \brief Flush the encoder at the end of a stripe. This emits the shortest sequence
+           of bytes which allows the decoder to reproduce every symbol coded so far.
+    \param s The encoder context. */
+SPAN_DECLARE(void) t81_t82_arith_encode_flush(t81_t82_arith_encode_state_t *s);
+
+/*! \brief Restart the encoder, ready for a new stripe.
+    \param s The encoder context.
+    \param reuse_st True to keep the adapted probability states of all the contexts, as
+           happens at an SDNORM stripe boundary, or false to reset them, as at the start
+           of an image or after an SDRST.
+    \return 0 for OK. */
+SPAN_DECLARE(int) t81_t82_arith_encode_restart(t81_t82_arith_encode_state_t *s, int reuse_st);
+
+/*! \brief Initialise an arithmetic encoder context.
+    \param s The encoder context. If NULL, a context will be allocated.
+    \param output_byte_handler The callback which receives each encoded byte.
+    \param user_data An opaque pointer passed to the callback.
+    \return A pointer to the context, or NULL for failure. */
+SPAN_DECLARE(t81_t82_arith_encode_state_t *) t81_t82_arith_encode_init(t81_t82_arith_encode_state_t *s,
+                                                                       void (*output_byte_handler)(void *, int),
+                                                                       void *user_data);
+
+SPAN_DECLARE(int) t81_t82_arith_encode_release(t81_t82_arith_encode_state_t *s);
+
+SPAN_DECLARE(int) t81_t82_arith_encode_free(t81_t82_arith_encode_state_t *s);
+
+/*! \brief Decode one pixel (binary decision).
+    \param s The decoder context.
+    \param cx The context number, in the range 0 to 4095.
+    \return The decoded pixel value, 0 or 1. -1 means the decoder needs more data,
+            before it can proceed. -2 means the decoder has reached a marker, and
+            was asked not to pad with zeros, by t81_t82_arith_decode_set_nopadding(). */
+SPAN_DECLARE(int) t81_t82_arith_decode(t81_t82_arith_decode_state_t *s, int cx);
+
+/*! \brief Give the decoder a new block of data to work on.
+    \param s The decoder context.
+    \param data The data.
+    \param len The length of the data, in bytes. */
+SPAN_DECLARE(void) t81_t82_arith_decode_set_data(t81_t82_arith_decode_state_t *s, const uint8_t data[], size_t len);
+
+/*! \brief Find how many bytes of the current block of data the decoder has consumed.
+    \param s The decoder context.
+    \return The number of bytes consumed. */
+SPAN_DECLARE(size_t) t81_t82_arith_decode_get_consumed(t81_t82_arith_decode_state_t *s);
+
+/*! \brief Ask the decoder to stop, rather than start padding with zeros, if the next
+           byte it needs turns out to be a marker. This is used to detect the early end
+           of a stripe, signalled by a NEWLEN marker segment.
+    \param s The decoder context. */
+SPAN_DECLARE(void) t81_t82_arith_decode_set_nopadding(t81_t82_arith_decode_state_t *s);
+
+/*! \brief Check if the decoder has reached the end of the stripe's coded data, and
+           is now padding with zeros.
+    \param s The decoder context.
+    \return True if padding. */
+SPAN_DECLARE(int) t81_t82_arith_decode_padding(t81_t82_arith_decode_state_t *s);
+
+/*! \brief Restart the decoder, ready for a new stripe.
+    \param s The decoder context.
+    \param reuse_st True to keep the adapted probability states of all the contexts.
+    \return 0 for OK. */
+SPAN_DECLARE(int) t81_t82_arith_decode_restart(t81_t82_arith_decode_state_t *s, int reuse_st);
+
+/*! \brief Initialise an arithmetic decoder context.
+    \param s The decoder context. If NULL, a context will be allocated.
+    \return A pointer to the context, or NULL for failure. */
+SPAN_DECLARE(t81_t82_arith_decode_state_t *) t81_t82_arith_decode_init(t81_t82_arith_decode_state_t *s);
+
+SPAN_DECLARE(int) t81_t82_arith_decode_release(t81_t82_arith_decode_state_t *s);
+
+SPAN_DECLARE(int) t81_t82_arith_decode_free(t81_t82_arith_decode_state_t *s);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
+/*- End of file ------------------------------------------------------------*/
@@ -0,0 +1,267 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * t85.h - ITU T.85 JBIG for FAX image processing
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2008, 2009 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 2.1,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \file */
+
+#if !defined(_SPANDSP_T85_H_)
+#define _SPANDSP_T85_H_
+
+/*! \page t85_page T.85 (JBIG for FAX) image compression and decompression
+
+\section t85_page_sec_1 What does it do?
+The T.85 image compression and decompression routines implement the single bit per
+pixel, single resolution layer profile of T.82 (JBIG) which T.85 specifies for FAX.
+For typical text pages this gives substantially smaller images than T.6 (MMR), so
+pages go down the line faster.
+
+\section t85_page_sec_2 How does it work?
+The encoder uses the three line template, with typical prediction, and no adaptive
+template movement. The decoder accepts anything T.85 allows - either template,
+typical prediction, AT movement, variable length images signalled with NEWLEN, any
+stripe length (the T.85 "L0" option) and comments.
+
+Both directions work as streams, holding only the three image rows the context
+template needs, plus the arithmetic coder state. The encoder can be fed rows one at a
+time, with t85_encode_put_row(), or can pull them from a row read handler as
+t85_encode_get() asks for more output. The decoder accepts data in fragments of any
+size, and delivers each image row to a row write handler as soon as it is complete.
+*/
+
+/*! Bits in the option byte of the T.82 BIH, which are meaningful for T.85 */
+enum
+{
+    /*! Enable typical prediction (bit 3) */
+    T85_TPBON = 0x08,
+    /*! Variable length image (bit 5) */
+    T85_VLENGTH = 0x20,
+    /*! Lowest-resolution-layer is a two-line template (bit 6) */
+    T85_LRLTWO = 0x40
+};
+
+/*! The stripe length T.85 uses, unless the far end supports the L0 option */
+#define T85_DEFAULT_L0              128
+
+/*! State of a working instance of the T.85 encoder */
+typedef struct t85_encode_state_s t85_encode_state_t;
+
+/*! State of a working instance of the T.85 decoder */
+typedef struct t85_decode_state_s t85_decode_state_t;
+
+#if defined(__cplusplus)
+extern "C"
+{
+#endif
+
+/*! \brief Set the T.85 options.
+    \param s The T.85 context.
+    \param l0 The number of rows per stripe, or 0 for the default of 128.
+    \param mx The maximum horizontal adaptive template offset to declare, or -1 for the default.
+    \param options Any combination of T85_LRLTWO, T85_TPBON and T85_VLENGTH, or -1 for the default. */
+SPAN_DECLARE(void) t85_encode_set_options(t85_encode_state_t *s, uint32_t l0, int mx, int options);
+
+/*! \brief Set the width of the image. This can only be done before the first row is encoded.
+    \param s The T.85 context.
+    \param image_width The width of the image, in pixels.
+    \return 0 for OK, or -1 for failure. */
+SPAN_DECLARE(int) t85_encode_set_image_width(t85_encode_state_t *s, uint32_t image_width);
+
+/*! \brief Set the length of the image. Before the first row is encoded this sets the length
+           declared in the image header. Later it can only be used to shorten the image,
+           which is signalled to the decoder with a NEWLEN marker.
+    \param s The T.85 context.
+    \param image_length The length of the image, in pixels, or 0 if it is not yet known.
+    \return 0 for OK, or -1 for failure. */
+SPAN_DECLARE(int) t85_encode_set_image_length(t85_encode_state_t *s, uint32_t image_length);
+
+/*! \brief Get the width of the image.
+    \param s The T.85 context.
+    \return The width of the image, in pixels. */
+SPAN_DECLARE(uint32_t) t85_encode_get_image_width(t85_encode_state_t *s);
+
+/*! \brief Get the number of rows encoded so far.
+    \param s The T.85 context.
+    \return The number of rows. */
+SPAN_DECLARE(uint32_t) t85_encode_get_image_length(t85_encode_state_t *s);
+
+/*! \brief Get the size of the compressed image produced so far.
+    \param s The T.85 context.
+    \return The size of the image, in bytes. */
+SPAN_DECLARE(int) t85_encode_get_compressed_image_size(t85_encode_state_t *s);
+
+/*! \brief Set the row read handler, which t85_encode_get() uses to pull image rows as it
+           needs them.
+    \param s The T.85 context.
+    \param handler The callback function. It should return the number of bytes in the row,
+           0 at the end of the image, or -1 for an error.
+    \param user_data An opaque pointer passed to the callback function.
+    \return 0 for OK. */
+SPAN_DECLARE(int) t85_encode_set_row_read_handler(t85_encode_state_t *s,
+                                                  t4_row_read_handler_t handler,
+                                                  void *user_data);
+
+/*! \brief Encode one row of the image.
+    \param s The T.85 context.
+    \param row The row, as packed pixels, 1 meaning black, with the leftmost pixel in the
+           MSB of the first byte.
+    \return 0 for OK, or -1 for failure. */
+SPAN_DECLARE(int) t85_encode_put_row(t85_encode_state_t *s, const uint8_t row[]);
+
+/*! \brief Finish encoding the image, after the last row has been put.
+    \param s The T.85 context.
+    \return 0 for OK, or -1 for failure. */
+SPAN_DECLARE(int) t85_encode_image_complete(t85_encode_state_t *s);
+
+/*! \brief Abort the encoding of the image, sending an ABORT marker to the decoder.
+    \param s The T.85 context. */
+SPAN_DECLARE(void) t85_encode_abort(t85_encode_state_t *s);
+
+/*! \brief Get the next chunk of the compressed image. If a row read handler is set, rows
+           are pulled from it as needed, so only about one row of compressed data is ever
+           held by the encoder.
+    \param s The T.85 context.
+    \param buf The buffer for the compressed data.
+    \param max_len The length of buf.
+    \return The number of bytes returned. 0 means the compressed image is complete, or no
+            more data is available until more rows are put. */
+SPAN_DECLARE(int) t85_encode_get(t85_encode_state_t *s, uint8_t buf[], size_t max_len);
+
+/*! \brief Check if the compressed image is complete, and has all been collected by
+           t85_encode_get().
+    \param s The T.85 context.
+    \return True if complete. */
+SPAN_DECLARE(int) t85_encode_image_finished(t85_encode_state_t *s);
+
+/*! \brief Prepare to encode a new image.
+    \param s The T.85 context.
+    \param image_width The width of the image, in pixels.
+    \param image_length The length of the image, in pixels, or 0 if not yet known.
+    \return 0 for OK, or -1 for failure. */
+SPAN_DECLARE(int) t85_encode_restart(t85_encode_state_t *s, uint32_t image_width, uint32_t image_length);
+
+/*! \brief Get the logging context associated with a T.85 encoder context.
+    \param s The T.85 context.
+    \return A pointer to the logging context */
+SPAN_DECLARE(logging_state_t *) t85_encode_get_logging_state(t85_encode_state_t *s);
+
+/*! \brief Initialise a T.85 encoder context.
+    \param s The T.85 context. If NULL, a context will be allocated.
+    \param image_width The width of the image, in pixels.
+    \param image_length The length of the image, in pixels, or 0 if not yet known.
+    \param handler An optional row read handler, used by t85_encode_get().
+    \param user_data An opaque pointer passed to the handler.
+    \return A pointer to the context, or NULL for failure. */
+SPAN_DECLARE(t85_encode_state_t *) t85_encode_init(t85_encode_state_t *s,
+                                                   uint32_t image_width,
+                                                   uint32_t image_length,
+                                                   t4_row_read_handler_t handler,
+                                                   void *user_data);
+
+/*! \brief Release a T.85 encoder context.
+    \param s The T.85 context.
+    \return 0 for OK */
+SPAN_DECLARE(int) t85_encode_release(t85_encode_state_t *s);
+
+/*! \brief Free a T.85 encoder context.
+    \param s The T.85 context.
+    \return 0 for OK */
+SPAN_DECLARE(int) t85_encode_free(t85_encode_state_t *s);
+
+/*! \brief Set the row write handler, which receives each row as it is decoded.
+    \param s The T.85 context.
+    \param handler The callback function.
+    \param user_data An opaque pointer passed to the callback function.
+    \return 0 for OK. */
+SPAN_DECLARE(int) t85_decode_set_row_write_handler(t85_decode_state_t *s,
+                                                   t4_row_write_handler_t handler,
+                                                   void *user_data);
+
+/*! \brief Set the largest image the decoder will accept. Images declaring a larger size
+           in their header are rejected.
+    \param s The T.85 context.
+    \param max_xd The maximum width, in pixels. 0 for no limit.
+    \param max_yd The maximum length, in pixels. 0 for no limit.
+    \return 0 for OK. */
+SPAN_DECLARE(int) t85_decode_set_image_size_constraints(t85_decode_state_t *s,
+                                                        uint32_t max_xd,
+                                                        uint32_t max_yd);
+
+/*! \brief Get the width of the image.
+    \param s The T.85 context.
+    \return The width of the image, in pixels, or 0 if the image header has not arrived yet. */
+SPAN_DECLARE(uint32_t) t85_decode_get_image_width(t85_decode_state_t *s);
+
+/*! \brief Get the number of rows decoded so far.
+    \param s The T.85 context.
+    \return The number of rows. */
+SPAN_DECLARE(uint32_t) t85_decode_get_image_length(t85_decode_state_t *s);
+
+/*! \brief Get the size of the compressed image received so far.
+    \param s The T.85 context.
+    \return The size of the image, in bytes. */
+SPAN_DECLARE(int) t85_decode_get_compressed_image_size(t85_decode_state_t *s);
+
+/*! \brief Decode a chunk of T.85 data.
+    \param s The T.85 context.
+    \param data The data to be decoded.
+    \param len The length of the data. A length of zero indicates the end of the data.
+    \return T4_DECODE_MORE_DATA when more data is needed, T4_DECODE_OK when the image is
+            complete, or one of the other T4_DECODE_xxx values for a failure. */
+SPAN_DECLARE(int) t85_decode_put(t85_decode_state_t *s, const uint8_t data[], size_t len);
+
+/*! \brief Prepare to decode a new image.
+    \param s The T.85 context.
+    \return 0 for OK. */
+SPAN_DECLARE(int) t85_decode_restart(t85_decode_state_t *s);
+
+/*! \brief Get the logging context associated with a T.85 decoder context.
+    \param s The T.85 context.
+    \return A pointer to the logging context */
+SPAN_DECLARE(logging_state_t *) t85_decode_get_logging_state(t85_decode_state_t *s);
+
+/*! \brief Initialise a T.85 decoder context.
+    \param s The T.85 context. If NULL, a context will be allocated.
+    \param handler The row write handler.
+    \param user_data An opaque pointer passed to the handler.
+    \return A pointer to the context, or NULL for failure. */
+SPAN_DECLARE(t85_decode_state_t *) t85_decode_init(t85_decode_state_t *s,
+                                                   t4_row_write_handler_t handler,
+                                                   void *user_data);
+
+/*! \brief Release a T.85 decoder context.
+    \param s The T.85 context.
+    \return 0 for OK */
+SPAN_DECLARE(int) t85_decode_release(t85_decode_state_t *s);
+
+/*! \brief Free a T.85 decoder context.
+    \param s The T.85 context.
+    \return 0 for OK */
+SPAN_DECLARE(int) t85_decode_free(t85_decode_state_t *s);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif
+/*- End of file ------------------------------------------------------------*/
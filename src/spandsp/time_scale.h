@@ -108,6 +108,17 @@ SPAN_DECLARE(int) time_scale_max_output_len(time_scale_state_t *s, int input_len
 */
 SPAN_DECLARE(int) time_scale(time_scale_state_t *s, int16_t out[], int16_t in[], int len);
 
+/*! Empty a time scale context of the samples it is holding. These are samples which have
+    been fed to time_scale(), but not yet output. After this, the context has the delay it
+    has when it is first initialised.
+    \brief Empty a time scale context.
+    \param s The time scale context.
+    \param out The output audio sample buffer. This must be large enough to accept twice
+           the number of samples in a pitch period of the lowest pitch supported.
+    \return The number of output samples.
+*/
+SPAN_DECLARE(int) time_scale_flush(time_scale_state_t *s, int16_t out[]);
+
 #if defined(__cplusplus)
 }
 #endif
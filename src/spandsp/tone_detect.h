@@ -82,7 +82,7 @@ SPAN_DECLARE(void) make_goertzel_descriptor(goertzel_descriptor_t *t,
     \param t The Goertzel descriptor.
     \return A pointer to the Goertzel state. */
 SPAN_DECLARE(goertzel_state_t *) goertzel_init(goertzel_state_t *s,
-                                               goertzel_descriptor_t *t);
+                                               const goertzel_descriptor_t *t);
 
 SPAN_DECLARE(int) goertzel_release(goertzel_state_t *s);
 
@@ -209,6 +209,10 @@ working only on the most optimal lines, and being widely usable across most phon
 TCM absolutely transformed the phone line modem business.
 */
 
+/*! The length of the training state from v17_rx_get_training_state(). This is 17
+    equalizer coefficients, and the carrier, gain and power references. */
+#define V17_RX_TRAINING_STATE_LEN   (17*8 + 16)
+
 /*!
     V.17 modem receive side descriptor. This defines the working state for a
     single instance of a V.17 modem receiver.
@@ -300,6 +304,25 @@ SPAN_DECLARE(int) v17_rx_equalizer_state(v17_rx_state_t *s, complexi_t **coeffs)
 SPAN_DECLARE(int) v17_rx_equalizer_state(v17_rx_state_t *s, complexf_t **coeffs);
 #endif
 
+/*! Get the training a V.17 modem receiver has saved for use by a short training sequence,
+    so it can be moved to another receiver. This is needed to move a FAX call between
+    pages, as the following page is normally sent with short training.
+    \brief Get the saved training of a V.17 modem receiver.
+    \param s The modem context.
+    \param buf The buffer for the training state.
+    \param max_len The length of buf.
+    \return The length of the training state, or -1 if buf is too small. */
+SPAN_DECLARE(int) v17_rx_get_training_state(v17_rx_state_t *s, uint8_t buf[], int max_len);
+
+/*! Set the training a V.17 modem receiver will use for a short training sequence, from
+    the state given by v17_rx_get_training_state().
+    \brief Set the saved training of a V.17 modem receiver.
+    \param s The modem context.
+    \param buf The training state.
+    \param len The length of the training state.
+    \return 0 for OK, else -1. */
+SPAN_DECLARE(int) v17_rx_set_training_state(v17_rx_state_t *s, const uint8_t buf[], int len);
+
 /*! Get the current received carrier frequency.
     \param s The modem context.
     \return The frequency, in Hertz. */
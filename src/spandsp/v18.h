@@ -29,6 +29,21 @@
 \section v18_page_sec_1 What does it do?
 
 \section v18_page_sec_2 How does it work?
+
+\section v18_page_sec_3 Automoding
+When V18_AUTOMODING is given to v18_init(), the receiver listens for the
+signatures of all the modes at once - the mark and space tones of the Baudot,
+V.21, Bell 103 and V.23 channels, and DTMF. A single bank of Goertzel filters,
+updated in one pass over the audio, covers all of them, so automoding costs
+about the same as one DTMF receiver, however many modes are being looked for.
+When one signature has persisted for long enough, the demodulator for that
+mode is started, and the rest of the audio goes to it. An FSK mode is
+recognised by a steady mark or space tone, such as the carrier which precedes
+the text, as 300bps modulation spreads its energy too widely to tell V.21 from
+Bell 103 in a short block. Modes whose signatures differ only in their bit
+rate are separated by the V18_AUTOMODING_BAUDOT_50 and V18_AUTOMODING_EDT
+options. Further filters at the frequencies of the common dial, ringing and
+busy tones stop those tones being taken for the V.23 backward channel.
 */
 
 #if !defined(_SPANDSP_V18_H_)
@@ -57,6 +72,19 @@ enum
     V18_MODE_V18TEXTPHONE = 8
 };
 
+/* Options which may be ORed with the mode given to v18_init(). */
+enum
+{
+    /* Listen for the signatures of all the modes, and switch to the first one heard. The
+       mode given with this option is ignored. */
+    V18_AUTOMODING = 0x200,
+    /* When automoding, take 1400Hz/1800Hz as 50bps Baudot, rather than 45.45bps Baudot.
+       The signatures of the two are the same, so this must follow the country setting. */
+    V18_AUTOMODING_BAUDOT_50 = 0x400,
+    /* When automoding, take 980Hz/1180Hz as EDT, rather than as a V.21 textphone. */
+    V18_AUTOMODING_EDT = 0x800
+};
+
 #if defined(__cplusplus)
 extern "C"
 {
@@ -64,6 +92,12 @@ extern "C"
 
 SPAN_DECLARE(logging_state_t *) v18_get_logging_state(v18_state_t *s);
 
+/*! Get the current mode of a V.18 context.
+    \brief Get the current mode of a V.18 context.
+    \param s The V.18 context.
+    \return The mode. This is V18_MODE_NONE while automoding has not yet chosen a mode. */
+SPAN_DECLARE(int) v18_get_current_mode(v18_state_t *s);
+
 /*! Initialise a V.18 context.
     \brief Initialise a V.18 context.
     \param s The V.18 context.
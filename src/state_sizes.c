@@ -0,0 +1,341 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * state_sizes.c - A register of the sizes of the spandsp state structures.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2013 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 2.1,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \file */
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#if defined(HAVE_TGMATH_H)
+#include <tgmath.h>
+#endif
+#if defined(HAVE_MATH_H)
+#include <math.h>
+#endif
+#if defined(HAVE_STDBOOL_H)
+#include <stdbool.h>
+#else
+#include "spandsp/stdbool.h"
+#endif
+#include "floating_fudge.h"
+#include <tiffio.h>
+
+#include "spandsp/telephony.h"
+#include "spandsp/alloc.h"
+#include "spandsp/fast_convert.h"
+#include "spandsp/logging.h"
+#include "spandsp/complex.h"
+#include "spandsp/bit_operations.h"
+#include "spandsp/bitstream.h"
+#include "spandsp/queue.h"
+#include "spandsp/media_tap.h"
+#include "spandsp/media_replay.h"
+#include "spandsp/channel_group.h"
+#include "spandsp/schedule.h"
+#include "spandsp/g711.h"
+#include "spandsp/timing.h"
+#include "spandsp/math_fixed.h"
+#include "spandsp/vector_float.h"
+#include "spandsp/complex_vector_float.h"
+#include "spandsp/vector_int.h"
+#include "spandsp/complex_vector_int.h"
+#include "spandsp/arctan2.h"
+#include "spandsp/biquad.h"
+#include "spandsp/fir.h"
+#include "spandsp/awgn.h"
+#include "spandsp/bert.h"
+#include "spandsp/power_meter.h"
+#include "spandsp/resampler.h"
+#include "spandsp/complex_filters.h"
+#include "spandsp/dc_restore.h"
+#include "spandsp/dds.h"
+#include "spandsp/swept_tone.h"
+#include "spandsp/echo.h"
+#include "spandsp/modem_echo.h"
+#include "spandsp/crc.h"
+#include "spandsp/async.h"
+#include "spandsp/hdlc.h"
+#include "spandsp/noise.h"
+#include "spandsp/saturated.h"
+#include "spandsp/time_scale.h"
+#include "spandsp/tone_detect.h"
+#include "spandsp/tone_generate.h"
+#include "spandsp/super_tone_rx.h"
+#include "spandsp/super_tone_tx.h"
+#include "spandsp/dtmf.h"
+#include "spandsp/bell_r2_mf.h"
+#include "spandsp/sig_tone.h"
+#include "spandsp/fsk.h"
+#include "spandsp/modem_connect_tones.h"
+#include "spandsp/silence_gen.h"
+#include "spandsp/v8.h"
+#include "spandsp/v42.h"
+#include "spandsp/v42bis.h"
+#include "spandsp/v29rx.h"
+#include "spandsp/v29tx.h"
+#include "spandsp/v17rx.h"
+#include "spandsp/v17tx.h"
+#include "spandsp/v22bis.h"
+#include "spandsp/v27ter_rx.h"
+#include "spandsp/v27ter_tx.h"
+#include "spandsp/v18.h"
+#include "spandsp/timezone.h"
+#include "spandsp/t4_rx.h"
+#include "spandsp/t4_tx.h"
+#include "spandsp/image_translate.h"
+#include "spandsp/t4_t6_decode.h"
+#include "spandsp/t4_t6_encode.h"
+#if defined(SPANDSP_SUPPORT_T85)
+#include "spandsp/t81_t82_arith_coding.h"
+#include "spandsp/t85.h"
+#endif
+#include "spandsp/t30.h"
+#include "spandsp/t30_api.h"
+#include "spandsp/t30_fcf.h"
+#include "spandsp/t30_logging.h"
+#include "spandsp/t35.h"
+#include "spandsp/at_interpreter.h"
+#include "spandsp/fax_modems.h"
+#include "spandsp/fax.h"
+#include "spandsp/t38_core.h"
+#include "spandsp/t38_non_ecm_buffer.h"
+#include "spandsp/t38_gateway.h"
+#include "spandsp/t38_terminal.h"
+#include "spandsp/t31.h"
+#include "spandsp/adsi.h"
+#include "spandsp/ademco_contactid.h"
+#include "spandsp/oki_adpcm.h"
+#include "spandsp/ima_adpcm.h"
+#include "spandsp/g722.h"
+#include "spandsp/g726.h"
+#include "spandsp/lpc10.h"
+#include "spandsp/gsm0610.h"
+#include "spandsp/plc.h"
+#include "spandsp/playout.h"
+#include "spandsp/playout_rx.h"
+#include "spandsp/expose.h"
+#include "spandsp/state_sizes.h"
+
+#include "spandsp/private/logging.h"
+#include "spandsp/private/schedule.h"
+#include "spandsp/private/bitstream.h"
+#include "spandsp/private/queue.h"
+#include "spandsp/private/media_tap.h"
+#include "spandsp/private/media_replay.h"
+#include "spandsp/private/channel_group.h"
+#include "spandsp/private/awgn.h"
+#include "spandsp/private/noise.h"
+#include "spandsp/private/bert.h"
+#include "spandsp/private/power_meter.h"
+#include "spandsp/private/resampler.h"
+#include "spandsp/private/tone_generate.h"
+#include "spandsp/private/bell_r2_mf.h"
+#include "spandsp/private/sig_tone.h"
+#include "spandsp/private/dtmf.h"
+#include "spandsp/private/g711.h"
+#include "spandsp/private/g722.h"
+#include "spandsp/private/g726.h"
+#include "spandsp/private/lpc10.h"
+#include "spandsp/private/gsm0610.h"
+#include "spandsp/private/plc.h"
+#include "spandsp/private/playout.h"
+#include "spandsp/private/oki_adpcm.h"
+#include "spandsp/private/ima_adpcm.h"
+#include "spandsp/private/hdlc.h"
+#include "spandsp/private/time_scale.h"
+#include "spandsp/private/playout_rx.h"
+#include "spandsp/private/super_tone_tx.h"
+#include "spandsp/private/super_tone_rx.h"
+#include "spandsp/private/silence_gen.h"
+#include "spandsp/private/swept_tone.h"
+#include "spandsp/private/echo.h"
+#include "spandsp/private/modem_echo.h"
+#include "spandsp/private/async.h"
+#include "spandsp/private/fsk.h"
+#include "spandsp/private/modem_connect_tones.h"
+#include "spandsp/private/v8.h"
+#include "spandsp/private/v17rx.h"
+#include "spandsp/private/v17tx.h"
+#include "spandsp/private/v22bis.h"
+#include "spandsp/private/v27ter_rx.h"
+#include "spandsp/private/v27ter_tx.h"
+#include "spandsp/private/v29rx.h"
+#include "spandsp/private/v29tx.h"
+#include "spandsp/private/v42.h"
+#include "spandsp/private/v42bis.h"
+#include "spandsp/private/at_interpreter.h"
+#include "spandsp/private/fax_modems.h"
+#include "spandsp/private/timezone.h"
+#include "spandsp/private/image_translate.h"
+#include "spandsp/private/t4_t6_decode.h"
+#include "spandsp/private/t4_t6_encode.h"
+#if defined(SPANDSP_SUPPORT_T85)
+#include "spandsp/private/t81_t82_arith_coding.h"
+#include "spandsp/private/t85.h"
+#endif
+#include "spandsp/private/t4_rx.h"
+#include "spandsp/private/t4_tx.h"
+#include "spandsp/private/t30.h"
+#include "spandsp/private/fax.h"
+#include "spandsp/private/t38_core.h"
+#include "spandsp/private/t38_non_ecm_buffer.h"
+#include "spandsp/private/t38_gateway.h"
+#include "spandsp/private/t38_terminal.h"
+#include "spandsp/private/t31.h"
+#include "spandsp/private/v18.h"
+#include "spandsp/private/adsi.h"
+#include "spandsp/private/ademco_contactid.h"
+
+#define STATE_SIZE(type)    {#type, sizeof(type)}
+
+/* Keep this in alphabetical order, as span_state_size() searches it with bsearch(). */
+static const span_state_size_t state_sizes[] =
+{
+    STATE_SIZE(ademco_contactid_receiver_bank_state_t),
+    STATE_SIZE(ademco_contactid_receiver_state_t),
+    STATE_SIZE(ademco_contactid_sender_state_t),
+    STATE_SIZE(adsi_rx_bank_state_t),
+    STATE_SIZE(adsi_rx_state_t),
+    STATE_SIZE(adsi_tx_state_t),
+    STATE_SIZE(async_rx_state_t),
+    STATE_SIZE(async_tx_state_t),
+    STATE_SIZE(at_state_t),
+    STATE_SIZE(awgn_state_t),
+    STATE_SIZE(bell_mf_rx_state_t),
+    STATE_SIZE(bell_mf_tx_state_t),
+    STATE_SIZE(bert_state_t),
+    STATE_SIZE(channel_group_state_t),
+    STATE_SIZE(dtmf_rx_state_t),
+    STATE_SIZE(dtmf_tx_state_t),
+    STATE_SIZE(echo_can_state_t),
+    STATE_SIZE(fax_modems_state_t),
+    STATE_SIZE(fax_state_t),
+    STATE_SIZE(fsk_rx_state_t),
+    STATE_SIZE(fsk_tx_state_t),
+    STATE_SIZE(g711_state_t),
+    STATE_SIZE(g722_decode_state_t),
+    STATE_SIZE(g722_encode_state_t),
+    STATE_SIZE(g726_state_t),
+    STATE_SIZE(gsm0610_state_t),
+    STATE_SIZE(hdlc_rx_state_t),
+    STATE_SIZE(hdlc_tx_state_t),
+    STATE_SIZE(ima_adpcm_state_t),
+    STATE_SIZE(image_translate_state_t),
+    STATE_SIZE(lpc10_decode_state_t),
+    STATE_SIZE(lpc10_encode_state_t),
+    STATE_SIZE(media_replay_state_t),
+    STATE_SIZE(media_tap_state_t),
+    STATE_SIZE(modem_connect_tones_rx_bank_state_t),
+    STATE_SIZE(modem_connect_tones_rx_state_t),
+    STATE_SIZE(modem_connect_tones_tx_state_t),
+    STATE_SIZE(modem_echo_can_state_t),
+    STATE_SIZE(noise_state_t),
+    STATE_SIZE(oki_adpcm_state_t),
+    STATE_SIZE(playout_rx_state_t),
+    STATE_SIZE(playout_state_t),
+    STATE_SIZE(plc_state_t),
+    STATE_SIZE(power_meter_t),
+    STATE_SIZE(power_surge_detector_state_t),
+    STATE_SIZE(r2_mf_rx_state_t),
+    STATE_SIZE(r2_mf_tx_state_t),
+    STATE_SIZE(resampler_state_t),
+    STATE_SIZE(sig_tone_rx_state_t),
+    STATE_SIZE(sig_tone_tx_state_t),
+    STATE_SIZE(silence_gen_state_t),
+    STATE_SIZE(super_tone_rx_state_t),
+    STATE_SIZE(super_tone_tx_state_t),
+    STATE_SIZE(swept_tone_state_t),
+    STATE_SIZE(t30_state_t),
+    STATE_SIZE(t31_state_t),
+    STATE_SIZE(t38_core_state_t),
+    STATE_SIZE(t38_gateway_state_t),
+    STATE_SIZE(t38_non_ecm_buffer_state_t),
+    STATE_SIZE(t38_terminal_state_t),
+    STATE_SIZE(t4_rx_state_t),
+    STATE_SIZE(t4_t6_decode_state_t),
+    STATE_SIZE(t4_t6_encode_state_t),
+    STATE_SIZE(t4_tx_state_t),
+#if defined(SPANDSP_SUPPORT_T85)
+    STATE_SIZE(t81_t82_arith_decode_state_t),
+    STATE_SIZE(t81_t82_arith_encode_state_t),
+    STATE_SIZE(t85_decode_state_t),
+    STATE_SIZE(t85_encode_state_t),
+#endif
+    STATE_SIZE(time_scale_state_t),
+    STATE_SIZE(tz_t),
+    STATE_SIZE(v17_rx_state_t),
+    STATE_SIZE(v17_tx_state_t),
+    STATE_SIZE(v18_state_t),
+    STATE_SIZE(v22bis_state_t),
+    STATE_SIZE(v27ter_rx_state_t),
+    STATE_SIZE(v27ter_tx_state_t),
+    STATE_SIZE(v29_rx_state_t),
+    STATE_SIZE(v29_tx_state_t),
+    STATE_SIZE(v42_state_t),
+    STATE_SIZE(v42bis_state_t),
+    STATE_SIZE(v8_state_t),
+};
+
+static int state_size_compare(const void *a, const void *b)
+{
+    return strcmp(((const span_state_size_t *) a)->name, ((const span_state_size_t *) b)->name);
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(const span_state_size_t *) span_state_sizes(int *entries)
+{
+    if (entries)
+        *entries = sizeof(state_sizes)/sizeof(state_sizes[0]);
+    /*endif*/
+    return state_sizes;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) span_state_size(const char *name)
+{
+    span_state_size_t key;
+    const span_state_size_t *entry;
+
+    key.name = name;
+    key.size = 0;
+    entry = (const span_state_size_t *) bsearch(&key,
+                                                state_sizes,
+                                                sizeof(state_sizes)/sizeof(state_sizes[0]),
+                                                sizeof(state_sizes[0]),
+                                                state_size_compare);
+    if (entry == NULL)
+        return -1;
+    /*endif*/
+    return (int) entry->size;
+}
+/*- End of function --------------------------------------------------------*/
+/*- End of file ------------------------------------------------------------*/
@@ -53,6 +53,7 @@
 #include "spandsp/alloc.h"
 #include "spandsp/logging.h"
 #include "spandsp/bit_operations.h"
+#include "spandsp/crc.h"
 #include "spandsp/queue.h"
 #include "spandsp/power_meter.h"
 #include "spandsp/complex.h"
@@ -489,6 +490,7 @@ static int step_fallback_entry(t30_state_t *s)
     set_min_scan_time(s);
     /* Now we need to rebuild the DCS message we will send. */
     build_dcs(s);
+    s->counters->fallbacks++;
     return s->current_fallback;
 }
 /*- End of function --------------------------------------------------------*/
@@ -514,6 +516,8 @@ static int terminate_operation_in_progress(t30_state_t *s)
 
 static int tx_start_page(t30_state_t *s)
 {
+    /* The header time may have moved on since the document was opened */
+    t4_tx_set_header_time(&s->t4.tx, s->header_time);
     if (t4_tx_start_page(&s->t4.tx))
     {
         terminate_operation_in_progress(s);
@@ -532,16 +536,15 @@ static int tx_end_page(t30_state_t *s)
     if (t4_tx_end_page(&s->t4.tx) == 0)
     {
         s->tx_page_number++;
+        s->counters->pages_tx++;
         s->ecm_block = 0;
     }
     return 0;
 }
 /*- End of function --------------------------------------------------------*/
 
-static int rx_start_page(t30_state_t *s)
+static int rx_start_t4_page(t30_state_t *s)
 {
-    int i;
-
     t4_rx_set_image_width(&s->t4.rx, s->image_width);
     t4_rx_set_sub_address(&s->t4.rx, s->rx_info.sub_address);
     t4_rx_set_dcs(&s->t4.rx, s->rx_dcs_string);
@@ -553,7 +556,15 @@ static int rx_start_page(t30_state_t *s)
     t4_rx_set_x_resolution(&s->t4.rx, s->x_resolution);
     t4_rx_set_y_resolution(&s->t4.rx, s->y_resolution);
 
-    if (t4_rx_start_page(&s->t4.rx))
+    return t4_rx_start_page(&s->t4.rx);
+}
+/*- End of function --------------------------------------------------------*/
+
+static int rx_start_page(t30_state_t *s)
+{
+    int i;
+
+    if (rx_start_t4_page(s))
         return -1;
     /* Clear the ECM buffer */
     for (i = 0;  i < 256;  i++)
@@ -571,6 +582,7 @@ static int rx_end_page(t30_state_t *s)
     if (t4_rx_end_page(&s->t4.rx) == 0)
     {
         s->rx_page_number++;
+        s->counters->pages_rx++;
         s->ecm_block = 0;
     }
     return 0;
@@ -615,6 +627,7 @@ static int copy_quality(t30_state_t *s)
     span_log(&s->logging, SPAN_LOG_FLOW, "Compressed image size = %d bytes\n", stats.line_image_size);
     span_log(&s->logging, SPAN_LOG_FLOW, "Bad rows = %d\n", stats.bad_rows);
     span_log(&s->logging, SPAN_LOG_FLOW, "Longest bad row run = %d\n", stats.longest_bad_row_run);
+    s->counters->bad_rows += stats.bad_rows;
     /* Don't treat a page as perfect because it has zero bad rows out of zero total rows. A zero row
        page has got to be some kind of total page failure. */
     if (stats.bad_rows == 0  &&  stats.length != 0)
@@ -852,6 +865,7 @@ static int send_next_ecm_frame(t30_state_t *s)
             if (s->ecm_len[i] >= 0)
             {
                 send_frame(s, s->ecm_data[i], s->ecm_len[i]);
+                s->counters->image_octets_tx += s->ecm_len[i] - 4;
                 s->ecm_current_tx_frame = i + 1;
                 s->ecm_frames_this_tx_burst++;
                 return 0;
@@ -917,9 +931,32 @@ static void shut_down_hdlc_tx(t30_state_t *s)
 }
 /*- End of function --------------------------------------------------------*/
 
+static void count_frame(t30_state_t *s, const uint8_t *msg, int len, int tx)
+{
+    /* Only final frames are of interest */
+    if (len < 3  ||  (msg[1] & 0x10) == 0)
+        return;
+    switch (msg[2] & 0xFE)
+    {
+    case T30_FTT:
+    case T30_RTN:
+    case T30_RTP:
+        s->counters->retrains++;
+        break;
+    case T30_PPR:
+        if (tx)
+            s->counters->pprs_tx++;
+        else
+            s->counters->pprs_rx++;
+        break;
+    }
+}
+/*- End of function --------------------------------------------------------*/
+
 static void send_frame(t30_state_t *s, const uint8_t *msg, int len)
 {
     print_frame(s, "Tx: ", msg, len);
+    count_frame(s, msg, len, true);
 
     if (s->real_time_frame_handler)
         s->real_time_frame_handler(s, s->real_time_frame_user_data, false, msg, len);
@@ -1955,6 +1992,12 @@ static void terminate_call(t30_state_t *s)
     s->timer_t2_t4 = 0;
     s->timer_t3 = 0;
     s->timer_t5 = 0;
+    if (s->state != T30_STATE_CALL_FINISHED)
+    {
+        s->counters->calls++;
+        if (s->current_status != T30_ERR_OK)
+            s->counters->calls_failed++;
+    }
     if (s->phase_e_handler)
         s->phase_e_handler(s, s->phase_e_user_data, s->current_status);
     set_state(s, T30_STATE_CALL_FINISHED);
@@ -2044,7 +2087,7 @@ static int set_min_scan_time(t30_state_t *s)
 }
 /*- End of function --------------------------------------------------------*/
 
-static int start_sending_document(t30_state_t *s)
+static int open_tx_document(t30_state_t *s)
 {
     if (s->tx_file[0] == '\0')
     {
@@ -2066,6 +2109,7 @@ static int start_sending_document(t30_state_t *s)
     t4_tx_set_header_info(&s->t4.tx, s->header_info);
     if (s->use_own_tz)
         t4_tx_set_header_tz(&s->t4.tx, &s->tz);
+    t4_tx_set_header_time(&s->t4.tx, s->header_time);
 
     s->x_resolution = t4_tx_get_x_resolution(&s->t4.tx);
     s->y_resolution = t4_tx_get_y_resolution(&s->t4.tx);
@@ -2077,7 +2121,14 @@ static int start_sending_document(t30_state_t *s)
         terminate_operation_in_progress(s);
         return -1;
     }
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
 
+static int start_sending_document(t30_state_t *s)
+{
+    if (open_tx_document(s))
+        return -1;
     if (tx_start_page(s))
         return -1;
     s->image_width = t4_tx_get_image_width(&s->t4.tx);
@@ -2781,6 +2832,7 @@ static void process_rx_ppr(t30_state_t *s, const uint8_t *msg, int len)
                 {
                     span_log(&s->logging, SPAN_LOG_FLOW, "Frame %d to be resent\n", frame_no);
                     s->error_correcting_mode_retries++;
+                    s->counters->ecm_frames_resent++;
                 }
 #if 0
                 /* Diagnostic: See if the other end is complaining about something we didn't even send this time. */
@@ -2798,6 +2850,7 @@ static void process_rx_ppr(t30_state_t *s, const uint8_t *msg, int len)
         if (s->ecm_progress  &&  fallback_sequence[s->current_fallback + 1].bit_rate)
         {
             s->current_fallback++;
+            s->counters->fallbacks++;
             s->ecm_progress = 0;
             queue_phase(s, T30_PHASE_D_TX);
             set_state(s, T30_STATE_IV_CTC);
@@ -2851,6 +2904,7 @@ static void process_rx_fcd(t30_state_t *s, const uint8_t *msg, int len)
             span_log(&s->logging, SPAN_LOG_FLOW, "Storing ECM frame %d, length %d\n", frame_no, len - 4);
             memcpy(&s->ecm_data[frame_no][0], &msg[4], len - 4);
             s->ecm_len[frame_no] = (int16_t) (len - 4);
+            s->counters->image_octets_rx += len - 4;
             /* In case we are just after a CTC/CTR exchange, which kicked us back to long training */
             s->short_train = true;
         }
@@ -4673,6 +4727,7 @@ static void process_rx_control_msg(t30_state_t *s, const uint8_t *msg, int len)
     else
     {
         /* This is a final frame */
+        count_frame(s, msg, len, false);
         /* Once we have any successful message from the far end, we
            cancel timer T1 */
         s->timer_t0_t1 = 0;
@@ -5515,6 +5570,11 @@ SPAN_DECLARE_NONSTD(void) t30_non_ecm_put_bit(void *user_data, int bit)
         break;
     case T30_STATE_F_DOC_NON_ECM:
         /* Image transfer */
+        if (++s->image_bits >= 8)
+        {
+            s->counters->image_octets_rx++;
+            s->image_bits = 0;
+        }
         if (t4_rx_put_bit(&s->t4.rx, bit))
         {
             /* This is the end of the image */
@@ -5556,6 +5616,7 @@ SPAN_DECLARE(void) t30_non_ecm_put_byte(void *user_data, int byte)
         break;
     case T30_STATE_F_DOC_NON_ECM:
         /* Image transfer */
+        s->counters->image_octets_rx++;
         if (t4_rx_put_byte(&s->t4.rx, (uint8_t) byte))
         {
             /* This is the end of the image */
@@ -5596,6 +5657,7 @@ SPAN_DECLARE(void) t30_non_ecm_put_chunk(void *user_data, const uint8_t buf[], i
         break;
     case T30_STATE_F_DOC_NON_ECM:
         /* Image transfer */
+        s->counters->image_octets_rx += len;
         if (t4_rx_put_chunk(&s->t4.rx, buf, len))
         {
             /* This is the end of the image */
@@ -5627,7 +5689,11 @@ SPAN_DECLARE_NONSTD(int) t30_non_ecm_get_bit(void *user_data)
         break;
     case T30_STATE_I:
         /* Transferring real data. */
-        bit = t4_tx_get_bit(&s->t4.tx);
+        if ((bit = t4_tx_get_bit(&s->t4.tx)) >= 0  &&  ++s->image_bits >= 8)
+        {
+            s->counters->image_octets_tx++;
+            s->image_bits = 0;
+        }
         break;
     case T30_STATE_D_POST_TCF:
     case T30_STATE_II_Q:
@@ -5662,7 +5728,8 @@ SPAN_DECLARE(int) t30_non_ecm_get_byte(void *user_data)
         break;
     case T30_STATE_I:
         /* Transferring real data. */
-        byte = t4_tx_get_byte(&s->t4.tx);
+        if ((byte = t4_tx_get_byte(&s->t4.tx)) < 0x100)
+            s->counters->image_octets_tx++;
         break;
     case T30_STATE_D_POST_TCF:
     case T30_STATE_II_Q:
@@ -5698,6 +5765,7 @@ SPAN_DECLARE(int) t30_non_ecm_get_chunk(void *user_data, uint8_t buf[], int max_
     case T30_STATE_I:
         /* Transferring real data. */
         len = t4_tx_get_chunk(&s->t4.tx, buf, max_len);
+        s->counters->image_octets_tx += len;
         break;
     case T30_STATE_D_POST_TCF:
     case T30_STATE_II_Q:
@@ -6201,6 +6269,9 @@ SPAN_DECLARE(void) t30_timer_update(t30_state_t *s, int samples)
 {
     int previous;
 
+    if (s->rx_trained)
+        s->counters->modem_lock_samples += samples;
+
     if (s->timer_t0_t1 > 0)
     {
         if ((s->timer_t0_t1 -= samples) <= 0)
@@ -6339,6 +6410,37 @@ SPAN_DECLARE(void) t30_get_transfer_statistics(t30_state_t *s, t30_stats_t *t)
 }
 /*- End of function --------------------------------------------------------*/
 
+SPAN_DECLARE(void) t30_set_counters(t30_state_t *s, t30_counters_t *counters)
+{
+    s->counters = (counters)  ?  counters  :  &s->local_counters;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(t30_counters_t *) t30_get_counters(t30_state_t *s)
+{
+    return s->counters;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(void) t30_counters_accumulate(t30_counters_t *total, const t30_counters_t *counters)
+{
+    total->calls += counters->calls;
+    total->calls_failed += counters->calls_failed;
+    total->pages_tx += counters->pages_tx;
+    total->pages_rx += counters->pages_rx;
+    total->pages_relayed += counters->pages_relayed;
+    total->bad_rows += counters->bad_rows;
+    total->retrains += counters->retrains;
+    total->pprs_tx += counters->pprs_tx;
+    total->pprs_rx += counters->pprs_rx;
+    total->ecm_frames_resent += counters->ecm_frames_resent;
+    total->fallbacks += counters->fallbacks;
+    total->modem_lock_samples += counters->modem_lock_samples;
+    total->image_octets_tx += counters->image_octets_tx;
+    total->image_octets_rx += counters->image_octets_rx;
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE(void) t30_local_interrupt_request(t30_state_t *s, int state)
 {
     if (s->timer_t3 > 0)
@@ -6357,6 +6459,505 @@ SPAN_DECLARE(void) t30_remote_interrupts_allowed(t30_state_t *s, int state)
 }
 /*- End of function --------------------------------------------------------*/
 
+/* The checkpoint of a T.30 context is a string of octets, in the form
+       "T30C", version, calling party
+       the integer fields listed by checkpoint_fields()
+       the received strings, and the DIS/DTC/DCS frames
+       the T.4 transmit position
+       the ECM frame map, and the ECM frames in use
+       CRC
+   Integers are sent as 4 octets, most significant first. */
+#define CHECKPOINT_VERSION          1
+
+static int checkpoint_fields(t30_state_t *s, int *fields[])
+{
+    int i;
+
+    i = 0;
+    fields[i++] = &s->operation_in_progress;
+    fields[i++] = &s->phase;
+    fields[i++] = &s->state;
+    fields[i++] = &s->step;
+    fields[i++] = &s->dis_received;
+    fields[i++] = &s->short_train;
+    fields[i++] = &s->image_carrier_attempted;
+    fields[i++] = &s->current_fallback;
+    fields[i++] = &s->current_permitted_modems;
+    fields[i++] = &s->timer_t0_t1;
+    fields[i++] = &s->timer_t2_t4;
+    fields[i++] = &s->timer_t2_t4_is;
+    fields[i++] = &s->timer_t3;
+    fields[i++] = &s->timer_t5;
+    fields[i++] = &s->timer_t6;
+    fields[i++] = &s->timer_t7;
+    fields[i++] = &s->timer_t8;
+    fields[i++] = &s->far_end_detected;
+    fields[i++] = &s->end_of_procedure_detected;
+    fields[i++] = &s->local_interrupt_pending;
+    fields[i++] = &s->line_encoding;
+    fields[i++] = &s->output_encoding;
+    fields[i++] = &s->x_resolution;
+    fields[i++] = &s->y_resolution;
+    fields[i++] = &s->retries;
+    fields[i++] = &s->error_correcting_mode;
+    fields[i++] = &s->error_correcting_mode_retries;
+    fields[i++] = &s->ppr_count;
+    fields[i++] = &s->receiver_not_ready_count;
+    fields[i++] = &s->octets_per_ecm_frame;
+    fields[i++] = &s->rx_page_number;
+    fields[i++] = &s->tx_page_number;
+    fields[i++] = &s->ecm_block;
+    fields[i++] = &s->ecm_frames;
+    fields[i++] = &s->ecm_frames_this_tx_burst;
+    fields[i++] = &s->ecm_current_tx_frame;
+    fields[i++] = &s->ecm_at_page_end;
+    fields[i++] = &s->last_rx_page_result;
+    fields[i++] = &s->next_tx_step;
+    fields[i++] = &s->tx_start_page;
+    fields[i++] = &s->current_status;
+    fields[i++] = &s->rx_ecm_block_ok;
+    fields[i++] = &s->ecm_progress;
+    fields[i++] = &s->rtp_events;
+    fields[i++] = &s->rtn_events;
+    return i;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void put_octet(uint8_t buf[], int *pos, int max_len, int value)
+{
+    if (*pos < max_len)
+        buf[*pos] = (uint8_t) value;
+    (*pos)++;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void put_int32(uint8_t buf[], int *pos, int max_len, int32_t value)
+{
+    put_octet(buf, pos, max_len, (value >> 24) & 0xFF);
+    put_octet(buf, pos, max_len, (value >> 16) & 0xFF);
+    put_octet(buf, pos, max_len, (value >> 8) & 0xFF);
+    put_octet(buf, pos, max_len, value & 0xFF);
+}
+/*- End of function --------------------------------------------------------*/
+
+static void put_octets(uint8_t buf[], int *pos, int max_len, const uint8_t data[], int len)
+{
+    int i;
+
+    for (i = 0;  i < len;  i++)
+        put_octet(buf, pos, max_len, data[i]);
+}
+/*- End of function --------------------------------------------------------*/
+
+static void put_string(uint8_t buf[], int *pos, int max_len, const char *str)
+{
+    int len;
+
+    len = strlen(str);
+    put_octet(buf, pos, max_len, len);
+    put_octets(buf, pos, max_len, (const uint8_t *) str, len);
+}
+/*- End of function --------------------------------------------------------*/
+
+static int get_octet(const uint8_t buf[], int *pos, int len)
+{
+    /* Running off the end leaves *pos beyond len, which the caller checks once at the end */
+    if (*pos >= len)
+    {
+        *pos = len + 1;
+        return 0;
+    }
+    return buf[(*pos)++];
+}
+/*- End of function --------------------------------------------------------*/
+
+static int32_t get_int32(const uint8_t buf[], int *pos, int len)
+{
+    uint32_t value;
+
+    value = get_octet(buf, pos, len) << 24;
+    value |= get_octet(buf, pos, len) << 16;
+    value |= get_octet(buf, pos, len) << 8;
+    value |= get_octet(buf, pos, len);
+    return (int32_t) value;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void get_octets(const uint8_t buf[], int *pos, int len, uint8_t data[], int data_len)
+{
+    int i;
+
+    for (i = 0;  i < data_len;  i++)
+        data[i] = (uint8_t) get_octet(buf, pos, len);
+}
+/*- End of function --------------------------------------------------------*/
+
+static void get_string(const uint8_t buf[], int *pos, int len, char *str, int max_len)
+{
+    int i;
+    int str_len;
+
+    str_len = get_octet(buf, pos, len);
+    for (i = 0;  i < str_len;  i++)
+    {
+        if (i < max_len)
+            str[i] = (char) get_octet(buf, pos, len);
+        else
+            *pos = len + 1;
+    }
+    str[(str_len < max_len)  ?  str_len  :  max_len] = '\0';
+}
+/*- End of function --------------------------------------------------------*/
+
+static int checkpoint_allowed(t30_state_t *s)
+{
+    /* We can only move a call while the T.30 engine is waiting to hear from the far end,
+       with nothing in flight in either direction. A page being received must not yet
+       have any image data, as a partly decoded page cannot be moved. */
+    switch (s->phase)
+    {
+    case T30_PHASE_B_RX:
+    case T30_PHASE_C_NON_ECM_RX:
+    case T30_PHASE_C_ECM_RX:
+    case T30_PHASE_D_RX:
+        break;
+    default:
+        return false;
+    }
+    if (s->next_phase != T30_PHASE_IDLE
+        ||
+        s->rx_signal_present
+        ||
+        s->rx_trained
+        ||
+        s->rx_frame_received)
+    {
+        return false;
+    }
+    if (s->operation_in_progress == OPERATION_IN_PROGRESS_T4_RX  &&  s->t4.rx.line_image_size != 0)
+        return false;
+    return true;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) t30_checkpoint(t30_state_t *s, uint8_t buf[], int max_len)
+{
+    int *fields[64];
+    int n;
+    int pos;
+    int i;
+
+    /* This may be polled, so failing is not logged */
+    if (!checkpoint_allowed(s))
+        return -1;
+    pos = 0;
+    put_octets(buf, &pos, max_len, (const uint8_t *) "T30C", 4);
+    put_octet(buf, &pos, max_len, CHECKPOINT_VERSION);
+    put_octet(buf, &pos, max_len, s->calling_party);
+    n = checkpoint_fields(s, fields);
+    for (i = 0;  i < n;  i++)
+        put_int32(buf, &pos, max_len, *fields[i]);
+    put_int32(buf, &pos, max_len, s->image_width);
+    put_octet(buf, &pos, max_len, s->min_scan_time_code);
+    put_octet(buf, &pos, max_len, s->local_min_scan_time_code);
+    put_octet(buf, &pos, max_len, s->next_rx_step);
+    put_octet(buf, &pos, max_len, s->last_pps_fcf2);
+
+    put_string(buf, &pos, max_len, s->rx_dcs_string);
+    put_string(buf, &pos, max_len, s->rx_info.ident);
+    put_string(buf, &pos, max_len, s->rx_info.sub_address);
+    put_string(buf, &pos, max_len, s->rx_info.selective_polling_address);
+    put_string(buf, &pos, max_len, s->rx_info.polled_sub_address);
+    put_string(buf, &pos, max_len, s->rx_info.sender_ident);
+    put_string(buf, &pos, max_len, s->rx_info.password);
+    put_octet(buf, &pos, max_len, s->dcs_len);
+    put_octets(buf, &pos, max_len, s->dcs_frame, s->dcs_len);
+    put_octet(buf, &pos, max_len, s->local_dis_dtc_len);
+    put_octets(buf, &pos, max_len, s->local_dis_dtc_frame, s->local_dis_dtc_len);
+    put_octet(buf, &pos, max_len, s->far_dis_dtc_len);
+    put_octets(buf, &pos, max_len, s->far_dis_dtc_frame, s->far_dis_dtc_len);
+
+    /* The document itself is not part of the checkpoint. The page being sent is rebuilt
+       from the file, and the position within it restored. */
+    if (s->operation_in_progress == OPERATION_IN_PROGRESS_T4_TX)
+    {
+        put_int32(buf, &pos, max_len, t4_tx_get_current_page_in_file(&s->t4.tx));
+        put_int32(buf, &pos, max_len, s->t4.tx.image_size);
+        put_int32(buf, &pos, max_len, s->t4.tx.t4_t6_tx.bit_ptr);
+        put_int32(buf, &pos, max_len, s->t4.tx.t4_t6_tx.bit_pos);
+    }
+
+    put_octets(buf, &pos, max_len, s->ecm_frame_map, sizeof(s->ecm_frame_map));
+    for (i = 0, n = 0;  i < 256;  i++)
+    {
+        if (s->ecm_len[i] >= 0)
+            n++;
+    }
+    put_int32(buf, &pos, max_len, n);
+    for (i = 0;  i < 256;  i++)
+    {
+        if (s->ecm_len[i] >= 0)
+        {
+            put_octet(buf, &pos, max_len, i);
+            put_int32(buf, &pos, max_len, s->ecm_len[i]);
+            put_octets(buf, &pos, max_len, s->ecm_data[i], s->ecm_len[i]);
+        }
+    }
+    if (pos + 2 > max_len)
+    {
+        span_log(&s->logging, SPAN_LOG_WARNING, "Checkpoint needs %d octets, but only %d are available\n", pos + 2, max_len);
+        return -1;
+    }
+    pos = crc_itu16_append(buf, pos);
+    span_log(&s->logging, SPAN_LOG_FLOW, "Checkpoint of %d octets in phase %s, state %s\n", pos, phase_names[s->phase], state_names[s->state]);
+    return pos;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int restore_tx_document(t30_state_t *s, int page, int image_size, int bit_ptr, int bit_pos)
+{
+    int x_resolution;
+    int y_resolution;
+
+    x_resolution = s->x_resolution;
+    y_resolution = s->y_resolution;
+    if (open_tx_document(s))
+        return -1;
+    s->t4.tx.current_page = page;
+    if (t4_tx_start_page(&s->t4.tx))
+        return -1;
+    s->x_resolution = x_resolution;
+    s->y_resolution = y_resolution;
+    if (set_min_scan_time(s) < 0)
+        return -1;
+    /* A restarted page must have the same image as the original, if we are part of the way
+       through it. Only a changed page header time stamp is likely to upset this, and that
+       does not matter if the page was fully sent. */
+    if (bit_ptr >= image_size)
+    {
+        bit_ptr = s->t4.tx.image_size;
+    }
+    else if (bit_ptr > 0  &&  s->t4.tx.image_size != image_size)
+    {
+        span_log(&s->logging, SPAN_LOG_WARNING, "Rebuilt page %d is %d octets, not %d\n", page, s->t4.tx.image_size, image_size);
+        return -1;
+    }
+    s->t4.tx.t4_t6_tx.bit_ptr = bit_ptr;
+    s->t4.tx.t4_t6_tx.bit_pos = bit_pos;
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int decode_checkpoint(t30_state_t *s, const uint8_t buf[], int len, int t4_position[4])
+{
+    int *fields[64];
+    int frame_len;
+    int n;
+    int pos;
+    int i;
+    int j;
+
+    /* Everything is range checked here, so a corrupt or hostile checkpoint cannot leave
+       the context with an index beyond the end of a table, or a frame beyond the end of
+       its buffer. */
+    len -= 2;
+    pos = 6;
+    n = checkpoint_fields(s, fields);
+    for (i = 0;  i < n;  i++)
+        *fields[i] = get_int32(buf, &pos, len);
+    s->image_width = (t4_image_width_t) get_int32(buf, &pos, len);
+    s->min_scan_time_code = (uint8_t) get_octet(buf, &pos, len);
+    s->local_min_scan_time_code = (uint8_t) get_octet(buf, &pos, len);
+    s->next_rx_step = (uint8_t) get_octet(buf, &pos, len);
+    s->last_pps_fcf2 = (uint8_t) get_octet(buf, &pos, len);
+    if (s->state < T30_STATE_IDLE
+        ||
+        s->state > T30_STATE_CALL_FINISHED
+        ||
+        s->operation_in_progress < OPERATION_IN_PROGRESS_NONE
+        ||
+        s->operation_in_progress > OPERATION_IN_PROGRESS_POST_T4_TX
+        ||
+        s->current_fallback < 0
+        ||
+        s->current_fallback >= (int) (sizeof(fallback_sequence)/sizeof(fallback_sequence[0]))
+        ||
+        s->min_scan_time_code > 7
+        ||
+        s->local_min_scan_time_code > 7
+        ||
+        s->octets_per_ecm_frame < 0
+        ||
+        s->octets_per_ecm_frame > 256
+        ||
+        s->ecm_frames < -1
+        ||
+        s->ecm_frames > 256
+        ||
+        s->ecm_frames_this_tx_burst < 0
+        ||
+        s->ecm_frames_this_tx_burst > 256
+        ||
+        s->ecm_current_tx_frame < 0
+        ||
+        s->ecm_current_tx_frame > 256 + 3)
+    {
+        span_log(&s->logging, SPAN_LOG_WARNING, "Checkpoint has a value out of range\n");
+        return -1;
+    }
+
+    get_string(buf, &pos, len, s->rx_dcs_string, sizeof(s->rx_dcs_string) - 1);
+    get_string(buf, &pos, len, s->rx_info.ident, T30_MAX_IDENT_LEN);
+    get_string(buf, &pos, len, s->rx_info.sub_address, T30_MAX_IDENT_LEN);
+    get_string(buf, &pos, len, s->rx_info.selective_polling_address, T30_MAX_IDENT_LEN);
+    get_string(buf, &pos, len, s->rx_info.polled_sub_address, T30_MAX_IDENT_LEN);
+    get_string(buf, &pos, len, s->rx_info.sender_ident, T30_MAX_IDENT_LEN);
+    get_string(buf, &pos, len, s->rx_info.password, T30_MAX_IDENT_LEN);
+    if ((s->dcs_len = get_octet(buf, &pos, len)) > T30_MAX_DIS_DTC_DCS_LEN)
+    {
+        span_log(&s->logging, SPAN_LOG_WARNING, "Checkpoint has a DCS frame of %d octets\n", s->dcs_len);
+        return -1;
+    }
+    get_octets(buf, &pos, len, s->dcs_frame, s->dcs_len);
+    if ((s->local_dis_dtc_len = get_octet(buf, &pos, len)) > T30_MAX_DIS_DTC_DCS_LEN)
+    {
+        span_log(&s->logging, SPAN_LOG_WARNING, "Checkpoint has a local DIS/DTC frame of %d octets\n", s->local_dis_dtc_len);
+        return -1;
+    }
+    get_octets(buf, &pos, len, s->local_dis_dtc_frame, s->local_dis_dtc_len);
+    if ((s->far_dis_dtc_len = get_octet(buf, &pos, len)) > T30_MAX_DIS_DTC_DCS_LEN)
+    {
+        span_log(&s->logging, SPAN_LOG_WARNING, "Checkpoint has a far DIS/DTC frame of %d octets\n", s->far_dis_dtc_len);
+        return -1;
+    }
+    get_octets(buf, &pos, len, s->far_dis_dtc_frame, s->far_dis_dtc_len);
+
+    if (s->operation_in_progress == OPERATION_IN_PROGRESS_T4_TX)
+    {
+        for (i = 0;  i < 4;  i++)
+            t4_position[i] = get_int32(buf, &pos, len);
+        if (t4_position[0] < 0  ||  t4_position[1] < 0  ||  t4_position[2] < 0  ||  t4_position[3] < 0  ||  t4_position[3] > 7)
+        {
+            span_log(&s->logging, SPAN_LOG_WARNING, "Checkpoint has a bad position in the document being sent\n");
+            return -1;
+        }
+    }
+
+    get_octets(buf, &pos, len, s->ecm_frame_map, sizeof(s->ecm_frame_map));
+    for (i = 0;  i < 256;  i++)
+        s->ecm_len[i] = -1;
+    n = get_int32(buf, &pos, len);
+    if (n < 0  ||  n > 256)
+    {
+        span_log(&s->logging, SPAN_LOG_WARNING, "Checkpoint has %d ECM frames\n", n);
+        return -1;
+    }
+    for (j = 0;  j < n;  j++)
+    {
+        i = get_octet(buf, &pos, len);
+        frame_len = get_int32(buf, &pos, len);
+        if (s->ecm_len[i] >= 0  ||  frame_len < 0  ||  frame_len > (int) sizeof(s->ecm_data[i]))
+        {
+            span_log(&s->logging, SPAN_LOG_WARNING, "Checkpoint has a bad ECM frame\n");
+            return -1;
+        }
+        s->ecm_len[i] = (int16_t) frame_len;
+        get_octets(buf, &pos, len, s->ecm_data[i], frame_len);
+    }
+    if (pos != len)
+    {
+        span_log(&s->logging, SPAN_LOG_WARNING, "Checkpoint has the wrong length\n");
+        return -1;
+    }
+    if (!checkpoint_allowed(s))
+    {
+        span_log(&s->logging, SPAN_LOG_WARNING, "Checkpoint is not at a point where a call can be moved\n");
+        return -1;
+    }
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) t30_restore(t30_state_t *s, const uint8_t buf[], int len)
+{
+    t30_state_t *original;
+    int t4_position[4];
+    int phase;
+
+    if (len < 8  ||  memcmp(buf, "T30C", 4) != 0  ||  buf[4] != CHECKPOINT_VERSION)
+    {
+        span_log(&s->logging, SPAN_LOG_WARNING, "Checkpoint is not a version %d T.30 checkpoint\n", CHECKPOINT_VERSION);
+        return -1;
+    }
+    if (!crc_itu16_check(buf, len))
+    {
+        span_log(&s->logging, SPAN_LOG_WARNING, "Checkpoint is corrupt\n");
+        return -1;
+    }
+    if (buf[5] != (s->calling_party  ?  1  :  0)  ||  s->operation_in_progress != OPERATION_IN_PROGRESS_NONE)
+    {
+        span_log(&s->logging, SPAN_LOG_WARNING, "Checkpoint does not match this context\n");
+        return -1;
+    }
+    /* The checkpoint is first decoded into a copy of the context, so nothing in the context
+       changes unless all of the checkpoint is good. The copy then holds the original, in
+       case the document cannot be reopened. */
+    if ((original = (t30_state_t *) span_alloc(sizeof(*original))) == NULL)
+        return -1;
+    memcpy(original, s, sizeof(*original));
+    if (decode_checkpoint(original, buf, len, t4_position))
+    {
+        span_free(original);
+        return -1;
+    }
+    memcpy(original, s, sizeof(*original));
+    decode_checkpoint(s, buf, len, t4_position);
+
+    /* Reopen the document, as the new host sees it. A page being received continues into
+       the receive file set for this context, which is a new file. */
+    switch (s->operation_in_progress)
+    {
+    case OPERATION_IN_PROGRESS_T4_TX:
+        s->operation_in_progress = OPERATION_IN_PROGRESS_NONE;
+        if (restore_tx_document(s, t4_position[0], t4_position[1], t4_position[2], t4_position[3]))
+        {
+            terminate_operation_in_progress(s);
+            memcpy(s, original, sizeof(*s));
+            span_free(original);
+            return -1;
+        }
+        break;
+    case OPERATION_IN_PROGRESS_T4_RX:
+        s->operation_in_progress = OPERATION_IN_PROGRESS_NONE;
+        if (t4_rx_init(&s->t4.rx, s->rx_file, s->output_encoding) == NULL)
+        {
+            span_log(&s->logging, SPAN_LOG_WARNING, "Cannot open target TIFF file '%s'\n", s->rx_file);
+            memcpy(s, original, sizeof(*s));
+            span_free(original);
+            return -1;
+        }
+        s->operation_in_progress = OPERATION_IN_PROGRESS_T4_RX;
+        if (rx_start_t4_page(s))
+        {
+            terminate_operation_in_progress(s);
+            memcpy(s, original, sizeof(*s));
+            span_free(original);
+            return -1;
+        }
+        break;
+    }
+    span_free(original);
+
+    /* Put the front end back into the state of the saved phase */
+    phase = s->phase;
+    s->phase = T30_PHASE_IDLE;
+    s->next_phase = T30_PHASE_IDLE;
+    set_phase(s, phase);
+    span_log(&s->logging, SPAN_LOG_FLOW, "Restored checkpoint of %d octets in phase %s, state %s\n", len, phase_names[s->phase], state_names[s->state]);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE(int) t30_restart(t30_state_t *s)
 {
     release_resources(s);
@@ -6413,6 +7014,7 @@ SPAN_DECLARE(t30_state_t *) t30_init(t30_state_t *s,
             return NULL;
     }
     memset(s, 0, sizeof(*s));
+    s->counters = &s->local_counters;
     s->calling_party = calling_party;
     s->set_rx_type_handler = set_rx_type_handler;
     s->set_rx_type_user_data = set_rx_type_user_data;
@@ -6436,6 +7038,7 @@ SPAN_DECLARE(t30_state_t *) t30_init(t30_state_t *s,
        get 1D and 2D encoding right. Quite a lot get other things wrong. */
     s->output_encoding = T4_COMPRESSION_ITU_T4_2D;
     s->local_min_scan_time_code = T30_MIN_SCAN_0MS;
+    s->header_time = -1;
     span_log_init(&s->logging, SPAN_LOG_NONE, NULL);
     span_log_set_protocol(&s->logging, "T.30");
     t30_restart(s);
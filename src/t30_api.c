@@ -658,6 +658,14 @@ SPAN_DECLARE(int) t30_set_tx_page_header_tz(t30_state_t *s, const char *tzstring
 }
 /*- End of function --------------------------------------------------------*/
 
+SPAN_DECLARE(int) t30_set_tx_page_header_time(t30_state_t *s, time_t when)
+{
+    /* This takes effect at the start of the next page sent */
+    s->header_time = when;
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE(const char *) t30_get_rx_country(t30_state_t *s)
 {
     return s->country;
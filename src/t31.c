@@ -63,6 +63,7 @@
 #include "spandsp/bitstream.h"
 #include "spandsp/dc_restore.h"
 #include "spandsp/queue.h"
+#include "spandsp/media_tap.h"
 #include "spandsp/power_meter.h"
 #include "spandsp/complex.h"
 #include "spandsp/tone_detect.h"
@@ -1075,6 +1076,9 @@ SPAN_DECLARE(int) t31_t38_send_timeout(t31_state_t *s, int samples)
     int delay;
 
     fe = &s->t38_fe;
+    if (fe->t38.tap)
+        media_tap_timer(fe->t38.tap, samples);
+    /*endif*/
     if (fe->current_rx_type == T30_MODEM_DONE  ||  fe->current_tx_type == T30_MODEM_DONE)
         return true;
     /*endif*/
@@ -2245,6 +2249,9 @@ SPAN_DECLARE(void) t31_call_event(t31_state_t *s, int event)
 
 SPAN_DECLARE(int) t31_at_rx(t31_state_t *s, const char *t, int len)
 {
+    if (s->audio.modems.tap)
+        media_tap_at(s->audio.modems.tap, t, len);
+    /*endif*/
     if (s->dte_data_timeout)
         s->dte_data_timeout = s->call_samples + ms_to_samples(5000);
     switch (s->at_state.at_rx_mode)
@@ -2334,11 +2341,8 @@ static int silence_rx(void *user_data, const int16_t amp[], int len)
 }
 /*- End of function --------------------------------------------------------*/
 
-static int cng_rx(void *user_data, const int16_t amp[], int len)
+static int cng_timeout(t31_state_t *s)
 {
-    t31_state_t *s;
-
-    s = (t31_state_t *) user_data;
     if (s->call_samples > ms_to_samples(s->at_state.p.s_regs[7]*1000))
     {
         /* After calling, S7 has elapsed... no carrier found. */
@@ -2346,11 +2350,21 @@ static int cng_rx(void *user_data, const int16_t amp[], int len)
         restart_modem(s, FAX_MODEM_SILENCE_TX);
         at_modem_control(&s->at_state, AT_MODEM_CONTROL_HANGUP, NULL);
         t31_set_at_rx_mode(s, AT_MODE_ONHOOK_COMMAND);
+        return true;
     }
-    else
-    {
+    /*endif*/
+    return false;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int cng_rx(void *user_data, const int16_t amp[], int len)
+{
+    t31_state_t *s;
+
+    s = (t31_state_t *) user_data;
+    if (!cng_timeout(s))
         fsk_rx(&s->audio.modems.v21_rx, amp, len);
-    }
+    /*endif*/
     return 0;
 }
 /*- End of function --------------------------------------------------------*/
@@ -2487,32 +2501,55 @@ static int v29_v21_rx_fillin(void *user_data, int len)
 SPAN_DECLARE_NONSTD(int) t31_rx(t31_state_t *s, int16_t amp[], int len)
 {
     int i;
+    int idle;
     int32_t power;
 
-    /* Monitor for received silence.  Maximum needed detection is AT+FRS=255 (255*10ms). */
-    /* We could probably only run this loop if (s->modem == FAX_MODEM_SILENCE_RX), however,
-       the spec says "when silence has been present on the line for the amount of
-       time specified".  That means some of the silence may have occurred before
-       the AT+FRS=n command. This condition, however, is not likely to ever be the
-       case.  (AT+FRS=n will usually be issued before the remote goes silent.) */
-    for (i = 0;  i < len;  i++)
+    if (s->audio.modems.tap)
+        media_tap_audio(s->audio.modems.tap, MEDIA_TAP_RX_AUDIO, amp, len);
+    /*endif*/
+    /* An idle line, while no signal is present and the silence monitor has settled,
+       need not be passed through the silence monitor or the receive modems. */
+    idle = fax_modems_rx_idle(&s->audio.modems, amp, len)
+           &&
+           !s->at_state.rx_signal_present
+           &&
+           power_meter_current(&s->audio.rx_power) <= s->audio.silence_threshold_power;
+    if (idle)
     {
-        /* Clean up any DC influence. */
-        power = power_meter_update(&s->audio.rx_power, amp[i] - s->audio.last_sample);
-        s->audio.last_sample = amp[i];
-        if (power > s->audio.silence_threshold_power)
-        {
-            s->audio.silence_heard = 0;
-        }
-        else
-        {
-            if (s->audio.silence_heard <= ms_to_samples(255*10))
-                s->audio.silence_heard++;
+        s->audio.last_sample = amp[len - 1];
+        s->audio.silence_heard += len;
+        if (s->audio.silence_heard > ms_to_samples(255*10) + 1)
+            s->audio.silence_heard = ms_to_samples(255*10) + 1;
+        /*endif*/
+    }
+    else
+    {
+        /* Monitor for received silence.  Maximum needed detection is AT+FRS=255 (255*10ms). */
+        /* We could probably only run this loop if (s->modem == FAX_MODEM_SILENCE_RX), however,
+           the spec says "when silence has been present on the line for the amount of
+           time specified".  That means some of the silence may have occurred before
+           the AT+FRS=n command. This condition, however, is not likely to ever be the
+           case.  (AT+FRS=n will usually be issued before the remote goes silent.) */
+        for (i = 0;  i < len;  i++)
+        {
+            /* Clean up any DC influence. */
+            power = power_meter_update(&s->audio.rx_power, amp[i] - s->audio.last_sample);
+            s->audio.last_sample = amp[i];
+            if (power > s->audio.silence_threshold_power)
+            {
+                s->audio.silence_heard = 0;
+            }
+            else
+            {
+                if (s->audio.silence_heard <= ms_to_samples(255*10))
+                    s->audio.silence_heard++;
+                /*endif*/
+            }
             /*endif*/
         }
-        /*endif*/
+        /*endfor*/
     }
-    /*endfor*/
+    /*endif*/
 
     /* Time is determined by counting the samples in audio packets coming in. */
     s->call_samples += len;
@@ -2529,7 +2566,15 @@ SPAN_DECLARE_NONSTD(int) t31_rx(t31_state_t *s, int16_t amp[], int len)
     /*endif*/
 
     if (!s->at_state.transmit  ||  s->modem == FAX_MODEM_CNG_TONE)
-        s->audio.modems.rx_handler(s->audio.modems.rx_user_data, amp, len);
+    {
+        if (!idle)
+            s->audio.modems.rx_handler(s->audio.modems.rx_user_data, amp, len);
+        else if (s->audio.modems.rx_handler == (span_rx_handler_t *) &silence_rx)
+            silence_rx(s, amp, len);
+        else if (s->audio.modems.rx_handler == (span_rx_handler_t *) &cng_rx)
+            cng_timeout(s);
+        /*endif*/
+    }
     /*endif*/
     return 0;
 }
@@ -2542,6 +2587,9 @@ SPAN_DECLARE_NONSTD(int) t31_rx_fillin(t31_state_t *s, int len)
        things that way. If there is a receive modem running, try to sustain its
        operation, without causing a phase hop, or letting its adaptive functions
        diverge. */
+    if (s->audio.modems.tap)
+        media_tap_audio_fillin(s->audio.modems.tap, MEDIA_TAP_RX_AUDIO, len);
+    /*endif*/
     /* Time is determined by counting the samples in audio packets coming in. */
     s->call_samples += len;
 
@@ -2600,6 +2648,9 @@ SPAN_DECLARE_NONSTD(int) t31_tx(t31_state_t *s, int16_t amp[], int max_len)
 {
     int len;
 
+    if (s->audio.modems.tap)
+        media_tap_tx_request(s->audio.modems.tap, max_len);
+    /*endif*/
     len = 0;
     if (s->at_state.transmit)
     {
@@ -2621,6 +2672,9 @@ SPAN_DECLARE_NONSTD(int) t31_tx(t31_state_t *s, int16_t amp[], int max_len)
         len = max_len;
     }
     /*endif*/
+    if (s->audio.modems.tap)
+        media_tap_audio(s->audio.modems.tap, MEDIA_TAP_TX_AUDIO, amp, len);
+    /*endif*/
     return len;
 }
 /*- End of function --------------------------------------------------------*/
@@ -2637,6 +2691,19 @@ SPAN_DECLARE(void) t31_set_tep_mode(t31_state_t *s, int use_tep)
 }
 /*- End of function --------------------------------------------------------*/
 
+SPAN_DECLARE(void) t31_set_rx_idle_cutoff(t31_state_t *s, float cutoff)
+{
+    fax_modems_set_rx_idle_cutoff(&s->audio.modems, cutoff);
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(void) t31_set_tap(t31_state_t *s, media_tap_state_t *tap)
+{
+    s->audio.modems.tap = tap;
+    t38_core_set_tap(&s->t38_fe.t38, tap);
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE(void) t31_set_t38_config(t31_state_t *s, int without_pacing)
 {
     if (without_pacing)
@@ -2810,6 +2877,12 @@ SPAN_DECLARE(t31_state_t *) t31_init(t31_state_t *s,
 SPAN_DECLARE(int) t31_release(t31_state_t *s)
 {
     at_reset_call_info(&s->at_state);
+    if (s->rx_queue)
+    {
+        queue_free(s->rx_queue);
+        s->rx_queue = NULL;
+    }
+    /*endif*/
     return 0;
 }
 /*- End of function --------------------------------------------------------*/
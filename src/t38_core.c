@@ -55,6 +55,7 @@
 #include "spandsp/alloc.h"
 #include "spandsp/logging.h"
 #include "spandsp/bit_operations.h"
+#include "spandsp/media_tap.h"
 #include "spandsp/t38_core.h"
 
 #include "spandsp/private/logging.h"
@@ -675,6 +676,10 @@ SPAN_DECLARE_NONSTD(int) t38_core_rx_ifp_packet(t38_core_state_t *s, const uint8
 
     log_seq_no = (s->check_sequence_numbers)  ?  seq_no  :  s->rx_expected_seq_no;
 
+    /* Capture the packets as they arrive, including any repeats and stragglers */
+    if (s->tap)
+        media_tap_ifp(s->tap, MEDIA_TAP_RX_IFP, buf, len, seq_no);
+    /*endif*/
     if (s->check_sequence_numbers)
     {
         seq_no &= 0xFFFF;
@@ -989,6 +994,9 @@ SPAN_DECLARE(int) t38_core_send_indicator(t38_core_state_t *s, int indicator)
             }
             /*endif*/
             span_log(&s->logging, SPAN_LOG_FLOW, "Tx %5d: indicator %s\n", s->tx_seq_no, t38_indicator_to_str(indicator));
+            if (s->tap)
+                media_tap_ifp(s->tap, MEDIA_TAP_TX_IFP, buf, len, s->tx_seq_no);
+            /*endif*/
             if (s->tx_packet_handler(s, s->tx_packet_user_data, buf, len, transmissions) < 0)
             {
                 span_log(&s->logging, SPAN_LOG_PROTOCOL_WARNING, "Tx packet handler failure\n");
@@ -1046,6 +1054,9 @@ SPAN_DECLARE(int) t38_core_send_data(t38_core_state_t *s, int data_type, int fie
         return len;
     }
     /*endif*/
+    if (s->tap)
+        media_tap_ifp(s->tap, MEDIA_TAP_TX_IFP, buf, len, s->tx_seq_no);
+    /*endif*/
     if (s->tx_packet_handler(s, s->tx_packet_user_data, buf, len, s->category_control[category]) < 0)
     {
         span_log(&s->logging, SPAN_LOG_PROTOCOL_WARNING, "Tx packet handler failure\n");
@@ -1068,6 +1079,9 @@ SPAN_DECLARE(int) t38_core_send_data_multi_field(t38_core_state_t *s, int data_t
         return len;
     }
     /*endif*/
+    if (s->tap)
+        media_tap_ifp(s->tap, MEDIA_TAP_TX_IFP, buf, len, s->tx_seq_no);
+    /*endif*/
     if (s->tx_packet_handler(s, s->tx_packet_user_data, buf, len, s->category_control[category]) < 0)
     {
         span_log(&s->logging, SPAN_LOG_PROTOCOL_WARNING, "Tx packet handler failure\n");
@@ -1163,6 +1177,12 @@ SPAN_DECLARE(int) t38_get_fastest_image_data_rate(t38_core_state_t *s)
 }
 /*- End of function --------------------------------------------------------*/
 
+SPAN_DECLARE(void) t38_core_set_tap(t38_core_state_t *s, media_tap_state_t *tap)
+{
+    s->tap = tap;
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE(logging_state_t *) t38_core_get_logging_state(t38_core_state_t *s)
 {
     return &s->logging;
@@ -58,6 +58,7 @@
 #include "spandsp/alloc.h"
 #include "spandsp/logging.h"
 #include "spandsp/queue.h"
+#include "spandsp/media_tap.h"
 #include "spandsp/vector_int.h"
 #include "spandsp/dc_restore.h"
 #include "spandsp/bit_operations.h"
@@ -963,6 +964,7 @@ static void monitor_control_messages(t38_gateway_state_t *s,
         if (s->core.count_page_on_mcf)
         {
             s->core.pages_confirmed++;
+            s->counters->pages_relayed++;
             span_log(&s->logging, SPAN_LOG_FLOW, "Pages confirmed = %d\n", s->core.pages_confirmed);
             s->core.count_page_on_mcf = false;
         }
@@ -2331,11 +2333,20 @@ SPAN_DECLARE_NONSTD(int) t38_gateway_rx(t38_gateway_state_t *s, int16_t amp[], i
         write(s->audio.modems.audio_rx_log, amp, len*sizeof(int16_t));
     /*endif*/
 #endif
+    if (s->audio.modems.tap)
+        media_tap_audio(s->audio.modems.tap, MEDIA_TAP_RX_AUDIO, amp, len);
+    /*endif*/
     update_rx_timing(s, len);
+    if (s->audio.modems.rx_trained)
+        s->counters->modem_lock_samples += len;
+    /*endif*/
     for (i = 0;  i < len;  i++)
         amp[i] = dc_restore(&s->audio.modems.dc_restore, amp[i]);
     /*endfor*/
-    s->audio.modems.rx_handler(s->audio.modems.rx_user_data, amp, len);
+    /* While no signal is present, an idle line need only advance the timers */
+    if (!fax_modems_rx_idle(&s->audio.modems, amp, len)  ||  s->audio.modems.rx_signal_present)
+        s->audio.modems.rx_handler(s->audio.modems.rx_user_data, amp, len);
+    /*endif*/
     return 0;
 }
 /*- End of function --------------------------------------------------------*/
@@ -2361,6 +2372,9 @@ SPAN_DECLARE_NONSTD(int) t38_gateway_rx_fillin(t38_gateway_state_t *s, int len)
         write(s->modems.audio_rx_log, amp, len*sizeof(int16_t));
     }
 #endif
+    if (s->audio.modems.tap)
+        media_tap_audio_fillin(s->audio.modems.tap, MEDIA_TAP_RX_AUDIO, len);
+    /*endif*/
     update_rx_timing(s, len);
     /* TODO: handle the modems properly */
     s->audio.modems.rx_fillin_handler(s->audio.modems.rx_user_data, len);
@@ -2376,6 +2390,9 @@ SPAN_DECLARE_NONSTD(int) t38_gateway_tx(t38_gateway_state_t *s, int16_t amp[], i
 
     required_len = max_len;
 #endif
+    if (s->audio.modems.tap)
+        media_tap_tx_request(s->audio.modems.tap, max_len);
+    /*endif*/
     if ((len = s->audio.modems.tx_handler(s->audio.modems.tx_user_data, amp, max_len)) < max_len)
     {
         if (set_next_tx_type(s))
@@ -2409,6 +2426,9 @@ SPAN_DECLARE_NONSTD(int) t38_gateway_tx(t38_gateway_state_t *s, int16_t amp[], i
     }
     /*endif*/
 #endif
+    if (s->audio.modems.tap)
+        media_tap_audio(s->audio.modems.tap, MEDIA_TAP_TX_AUDIO, amp, len);
+    /*endif*/
     return len;
 }
 /*- End of function --------------------------------------------------------*/
@@ -2422,6 +2442,18 @@ SPAN_DECLARE(void) t38_gateway_get_transfer_statistics(t38_gateway_state_t *s, t
 }
 /*- End of function --------------------------------------------------------*/
 
+SPAN_DECLARE(void) t38_gateway_set_counters(t38_gateway_state_t *s, t30_counters_t *counters)
+{
+    s->counters = (counters)  ?  counters  :  &s->local_counters;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(t30_counters_t *) t38_gateway_get_counters(t38_gateway_state_t *s)
+{
+    return s->counters;
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE(t38_core_state_t *) t38_gateway_get_t38_core_state(t38_gateway_state_t *s)
 {
     return &s->t38x.t38;
@@ -2476,6 +2508,19 @@ SPAN_DECLARE(void) t38_gateway_set_tep_mode(t38_gateway_state_t *s, int use_tep)
 }
 /*- End of function --------------------------------------------------------*/
 
+SPAN_DECLARE(void) t38_gateway_set_rx_idle_cutoff(t38_gateway_state_t *s, float cutoff)
+{
+    fax_modems_set_rx_idle_cutoff(&s->audio.modems, cutoff);
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(void) t38_gateway_set_tap(t38_gateway_state_t *s, media_tap_state_t *tap)
+{
+    s->audio.modems.tap = tap;
+    t38_core_set_tap(&s->t38x.t38, tap);
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE(void) t38_gateway_set_fill_bit_removal(t38_gateway_state_t *s, int remove)
 {
     s->core.to_t38.fill_bit_removal = remove;
@@ -2551,6 +2596,7 @@ SPAN_DECLARE(t38_gateway_state_t *) t38_gateway_init(t38_gateway_state_t *s,
     }
     /*endif*/
     memset(s, 0, sizeof(*s));
+    s->counters = &s->local_counters;
     span_log_init(&s->logging, SPAN_LOG_NONE, NULL);
     span_log_set_protocol(&s->logging, "T.38G");
 
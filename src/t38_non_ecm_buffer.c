@@ -59,6 +59,7 @@
 #include "spandsp/async.h"
 #include "spandsp/t38_non_ecm_buffer.h"
 
+#include "spandsp/private/logging.h"
 #include "spandsp/private/t38_non_ecm_buffer.h"
 
 /* Phases */
@@ -55,6 +55,7 @@
 #include "spandsp/logging.h"
 #include "spandsp/bit_operations.h"
 #include "spandsp/queue.h"
+#include "spandsp/media_tap.h"
 #include "spandsp/power_meter.h"
 #include "spandsp/complex.h"
 #include "spandsp/tone_generate.h"
@@ -209,11 +210,24 @@ static int extra_bits_in_stuffed_frame(const uint8_t buf[], int len)
 }
 /*- End of function --------------------------------------------------------*/
 
+static void header_time_from_tap(t38_terminal_state_t *s)
+{
+    time_t when;
+
+    /* A tap recording the call holds the time for the page headers, so a replay can
+       send the same headers */
+    if (s->t38_fe.t38.tap  &&  (when = media_tap_get_header_time(s->t38_fe.t38.tap)) >= 0)
+        t30_set_tx_page_header_time(&s->t30, when);
+    /*endif*/
+}
+/*- End of function --------------------------------------------------------*/
+
 static int process_rx_missing(t38_core_state_t *t, void *user_data, int rx_seq_no, int expected_seq_no)
 {
     t38_terminal_state_t *s;
 
     s = (t38_terminal_state_t *) user_data;
+    header_time_from_tap(s);
     s->t38_fe.rx_data_missing = true;
     return 0;
 }
@@ -226,6 +240,7 @@ static int process_rx_indicator(t38_core_state_t *t, void *user_data, int indica
 
     s = (t38_terminal_state_t *) user_data;
     fe = &s->t38_fe;
+    header_time_from_tap(s);
 
     /* Protect against T.38 stuff arriving after we've actually finished. */
     if (fe->current_rx_type == T30_MODEM_DONE)
@@ -345,6 +360,7 @@ static int process_rx_data(t38_core_state_t *t, void *user_data, int data_type,
 
     s = (t38_terminal_state_t *) user_data;
     fe = &s->t38_fe;
+    header_time_from_tap(s);
 
     /* Protect against T.38 stuff arriving after we've actually finished. */
     if (fe->current_rx_type == T30_MODEM_DONE)
@@ -1148,6 +1164,12 @@ SPAN_DECLARE(int) t38_terminal_send_timeout(t38_terminal_state_t *s, int samples
     int delay;
 
     fe = &s->t38_fe;
+    if (fe->t38.tap)
+    {
+        media_tap_timer(fe->t38.tap, samples);
+        header_time_from_tap(s);
+    }
+    /*endif*/
     if (fe->current_rx_type == T30_MODEM_DONE  ||  fe->current_tx_type == T30_MODEM_DONE)
         return true;
     /*endif*/
@@ -1433,6 +1455,16 @@ SPAN_DECLARE(void) t38_terminal_set_fill_bit_removal(t38_terminal_state_t *s, in
 }
 /*- End of function --------------------------------------------------------*/
 
+SPAN_DECLARE(void) t38_terminal_set_tap(t38_terminal_state_t *s, media_tap_state_t *tap)
+{
+    /* Go back to the system clock for the page headers, if the old tap was setting them */
+    if (s->t38_fe.t38.tap  &&  media_tap_get_header_time(s->t38_fe.t38.tap) >= 0)
+        t30_set_tx_page_header_time(&s->t30, -1);
+    /*endif*/
+    t38_core_set_tap(&s->t38_fe.t38, tap);
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE(t30_state_t *) t38_terminal_get_t30_state(t38_terminal_state_t *s)
 {
     return &s->t30;
@@ -1445,6 +1477,87 @@ SPAN_DECLARE(t38_core_state_t *) t38_terminal_get_t38_core_state(t38_terminal_st
 }
 /*- End of function --------------------------------------------------------*/
 
+SPAN_DECLARE(int) t38_terminal_checkpoint(t38_terminal_state_t *s, uint8_t buf[], int max_len)
+{
+    int fields[5];
+    int len;
+    int i;
+    int j;
+
+    /* Any timed transmission must be finished, except for the trailing no-signal indicator
+       which ends a modem signal. That can be owed for longer than the far end takes to
+       reply, so the new context sends it again instead. */
+    switch (s->t38_fe.timed_step)
+    {
+    case T38_TIMED_STEP_NONE:
+    case T38_TIMED_STEP_NON_ECM_MODEM_5:
+    case T38_TIMED_STEP_HDLC_MODEM_5:
+    case T38_TIMED_STEP_NO_SIGNAL:
+        break;
+    default:
+        return -1;
+    }
+    /*endswitch*/
+    if (s->t38_fe.queued_timed_step != T38_TIMED_STEP_NONE)
+        return -1;
+    /*endif*/
+    if (max_len < T38_TERMINAL_CHECKPOINT_HEADER_LEN)
+        return -1;
+    /*endif*/
+    /* The T.38 part is the IFP packet sequencing, and whether a no-signal indicator is
+       owed, as 4 octet fields, most significant first, ahead of the T.30 engine's checkpoint. */
+    fields[0] = s->t38_fe.t38.tx_seq_no;
+    fields[1] = s->t38_fe.t38.rx_expected_seq_no;
+    fields[2] = s->t38_fe.t38.current_tx_indicator;
+    fields[3] = s->t38_fe.t38.current_rx_indicator;
+    fields[4] = (s->t38_fe.timed_step != T38_TIMED_STEP_NONE);
+    memcpy(buf, "T38T", 4);
+    for (i = 0;  i < 5;  i++)
+    {
+        for (j = 0;  j < 4;  j++)
+            buf[4 + 4*i + j] = (uint8_t) (fields[i] >> (24 - 8*j));
+        /*endfor*/
+    }
+    /*endfor*/
+    if ((len = t30_checkpoint(&s->t30, &buf[T38_TERMINAL_CHECKPOINT_HEADER_LEN], max_len - T38_TERMINAL_CHECKPOINT_HEADER_LEN)) < 0)
+        return -1;
+    /*endif*/
+    return T38_TERMINAL_CHECKPOINT_HEADER_LEN + len;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) t38_terminal_restore(t38_terminal_state_t *s, const uint8_t buf[], int len)
+{
+    int fields[5];
+    int i;
+    int j;
+
+    if (len < T38_TERMINAL_CHECKPOINT_HEADER_LEN  ||  memcmp(buf, "T38T", 4) != 0)
+        return -1;
+    /*endif*/
+    for (i = 0;  i < 5;  i++)
+    {
+        fields[i] = 0;
+        for (j = 0;  j < 4;  j++)
+            fields[i] = (fields[i] << 8) | buf[4 + 4*i + j];
+        /*endfor*/
+    }
+    /*endfor*/
+    if (t30_restore(&s->t30, &buf[T38_TERMINAL_CHECKPOINT_HEADER_LEN], len - T38_TERMINAL_CHECKPOINT_HEADER_LEN))
+        return -1;
+    /*endif*/
+    s->t38_fe.t38.tx_seq_no = fields[0];
+    s->t38_fe.t38.rx_expected_seq_no = fields[1];
+    s->t38_fe.t38.current_tx_indicator = fields[2];
+    s->t38_fe.t38.current_rx_indicator = fields[3];
+    /* Send any owed no-signal indicator as soon as the context is next clocked */
+    if (fields[4])
+        s->t38_fe.timed_step = T38_TIMED_STEP_HDLC_MODEM_5;
+    /*endif*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
 static int t38_terminal_t38_fe_restart(t38_terminal_state_t *t)
 {
     t38_terminal_front_end_state_t *s;
@@ -481,7 +481,7 @@ static int put_decoded_row(t4_rx_state_t *s)
     /* Make sure there is enough room for another row */
     if (s->image_size + s->bytes_per_row >= s->image_buffer_size)
     {
-        if ((t = realloc(s->image_buffer, s->image_buffer_size + 100*s->bytes_per_row)) == NULL)
+        if ((t = span_realloc(s->image_buffer, s->image_buffer_size + 100*s->bytes_per_row)) == NULL)
             return -1;
         s->image_buffer_size += 100*s->bytes_per_row;
         s->image_buffer = t;
@@ -584,11 +584,70 @@ static int put_decoded_row(t4_rx_state_t *s)
 }
 /*- End of function --------------------------------------------------------*/
 
+#if defined(SPANDSP_SUPPORT_T85)
+static int t85_row_write_handler(void *user_data, const uint8_t buf[], size_t len)
+{
+    t4_rx_state_t *s;
+    uint8_t *t;
+
+    s = (t4_rx_state_t *) user_data;
+    if (len == 0)
+        return 0;
+    /*endif*/
+    if (s->image_length == 0  &&  (int) len != s->bytes_per_row)
+    {
+        /* The BIH is the final word on the image width */
+        span_log(&s->logging, SPAN_LOG_FLOW, "T.85 image width %" PRIu32 " replaces %d\n", t85_decode_get_image_width(&s->t85_rx), s->image_width);
+        s->image_width = t85_decode_get_image_width(&s->t85_rx);
+        s->bytes_per_row = len;
+    }
+    /*endif*/
+    if (s->image_size + s->bytes_per_row > s->image_buffer_size)
+    {
+        if ((t = span_realloc(s->image_buffer, s->image_buffer_size + 100*s->bytes_per_row)) == NULL)
+            return -1;
+        /*endif*/
+        s->image_buffer_size += 100*s->bytes_per_row;
+        s->image_buffer = t;
+    }
+    /*endif*/
+    memcpy(s->image_buffer + s->image_size, buf, s->bytes_per_row);
+    s->image_size += s->bytes_per_row;
+    s->image_length++;
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int t85_put(t4_rx_state_t *s, const uint8_t buf[], int len)
+{
+    int ret;
+
+    s->line_image_size += 8*len;
+    if ((ret = t85_decode_put(&s->t85_rx, buf, len)) == T4_DECODE_MORE_DATA)
+        return false;
+    /*endif*/
+    if (ret != T4_DECODE_OK)
+        span_log(&s->logging, SPAN_LOG_WARNING, "T.85 decode failed (%d)\n", ret);
+    /*endif*/
+    /* Either way, there is no point in pushing more data at this page */
+    return true;
+}
+/*- End of function --------------------------------------------------------*/
+#endif
+
 SPAN_DECLARE(int) t4_rx_end_page(t4_rx_state_t *s)
 {
     int row;
     int i;
 
+#if defined(SPANDSP_SUPPORT_T85)
+    if (s->line_encoding == T4_COMPRESSION_ITU_T85  ||  s->line_encoding == T4_COMPRESSION_ITU_T85_L0)
+    {
+        /* Let the decoder finish off whatever it has been given */
+        t85_decode_put(&s->t85_rx, NULL, 0);
+    }
+    /*endif*/
+#endif
     if (s->line_encoding == T4_COMPRESSION_ITU_T6)
     {
         /* Push enough zeros through the decoder to flush out any remaining codes */
@@ -1016,12 +1075,34 @@ static int rx_put_bits(t4_rx_state_t *s, uint32_t bit_string, int quantity)
 
 SPAN_DECLARE(int) t4_rx_put_bit(t4_rx_state_t *s, int bit)
 {
+#if defined(SPANDSP_SUPPORT_T85)
+    uint8_t byte;
+
+    if (s->line_encoding == T4_COMPRESSION_ITU_T85  ||  s->line_encoding == T4_COMPRESSION_ITU_T85_L0)
+    {
+        /* Gather the bits into bytes, LSB first, for the byte oriented T.85 decoder */
+        s->t4_t6_rx.rx_bitstream |= ((bit & 1) << s->t4_t6_rx.rx_bits);
+        if (++s->t4_t6_rx.rx_bits < 8)
+            return false;
+        /*endif*/
+        byte = (uint8_t) s->t4_t6_rx.rx_bitstream;
+        s->t4_t6_rx.rx_bitstream = 0;
+        s->t4_t6_rx.rx_bits = 0;
+        return t85_put(s, &byte, 1);
+    }
+    /*endif*/
+#endif
     return rx_put_bits(s, bit & 1, 1);
 }
 /*- End of function --------------------------------------------------------*/
 
 SPAN_DECLARE(int) t4_rx_put_byte(t4_rx_state_t *s, uint8_t byte)
 {
+#if defined(SPANDSP_SUPPORT_T85)
+    if (s->line_encoding == T4_COMPRESSION_ITU_T85  ||  s->line_encoding == T4_COMPRESSION_ITU_T85_L0)
+        return t85_put(s, &byte, 1);
+    /*endif*/
+#endif
     return rx_put_bits(s, byte & 0xFF, 8);
 }
 /*- End of function --------------------------------------------------------*/
@@ -1031,6 +1112,11 @@ SPAN_DECLARE(int) t4_rx_put_chunk(t4_rx_state_t *s, const uint8_t buf[], int len
     int i;
     uint8_t byte;
 
+#if defined(SPANDSP_SUPPORT_T85)
+    if (s->line_encoding == T4_COMPRESSION_ITU_T85  ||  s->line_encoding == T4_COMPRESSION_ITU_T85_L0)
+        return t85_put(s, buf, len);
+    /*endif*/
+#endif
     for (i = 0;  i < len;  i++)
     {
         byte = buf[i];
@@ -1069,11 +1155,11 @@ SPAN_DECLARE(int) t4_rx_start_page(t4_rx_state_t *s)
     {
         /* Allocate the space required for decoding the new row length. */
         s->bytes_per_row = bytes_per_row;
-        if ((bufptr = (uint32_t *) realloc(s->cur_runs, run_space)) == NULL)
+        if ((bufptr = (uint32_t *) span_realloc(s->cur_runs, run_space)) == NULL)
             return -1;
         /*endif*/
         s->cur_runs = bufptr;
-        if ((bufptr = (uint32_t *) realloc(s->ref_runs, run_space)) == NULL)
+        if ((bufptr = (uint32_t *) span_realloc(s->ref_runs, run_space)) == NULL)
             return -1;
         /*endif*/
         s->ref_runs = bufptr;
@@ -1118,6 +1204,15 @@ SPAN_DECLARE(int) t4_rx_start_page(t4_rx_state_t *s)
 
     s->t4_t6_rx.run_length = 0;
 
+#if defined(SPANDSP_SUPPORT_T85)
+    if (s->line_encoding == T4_COMPRESSION_ITU_T85  ||  s->line_encoding == T4_COMPRESSION_ITU_T85_L0)
+    {
+        if (t85_decode_restart(&s->t85_rx))
+            return -1;
+        /*endif*/
+    }
+    /*endif*/
+#endif
     time (&s->page_start_time);
 
     return 0;
@@ -1281,6 +1376,9 @@ SPAN_DECLARE(t4_rx_state_t *) t4_rx_init(t4_rx_state_t *s, const char *file, int
     s->y_resolution = T4_Y_RESOLUTION_FINE;
     s->image_width = T4_WIDTH_R8_A4;
 
+#if defined(SPANDSP_SUPPORT_T85)
+    t85_decode_init(&s->t85_rx, t85_row_write_handler, s);
+#endif
     return s;
 }
 /*- End of function --------------------------------------------------------*/
@@ -1294,6 +1392,9 @@ SPAN_DECLARE(int) t4_rx_release(t4_rx_state_t *s)
         close_tiff_output_file(s);
     /*endif*/
     free_buffers(s);
+#if defined(SPANDSP_SUPPORT_T85)
+    t85_decode_release(&s->t85_rx);
+#endif
     return 0;
 }
 /*- End of function --------------------------------------------------------*/
@@ -386,11 +386,25 @@ static void make_header(t4_tx_state_t *s, char *header)
         "Dec"
     };
 
-    time(&now);
-    if (s->tz)
-        tz_localtime(s->tz, &tm, now);
+    /* The header only shows the time to the minute, so only work out the local time
+       once a minute. */
+    if (s->header_time >= 0)
+        now = s->header_time;
     else
-        tm = *localtime(&now);
+        time(&now);
+    /*endif*/
+    if (now/60 != s->header_minute)
+    {
+        if (s->tz)
+            tz_localtime(s->tz, &s->header_tm, now);
+        else
+            s->header_tm = *localtime(&now);
+        /*endif*/
+        s->header_minute = now/60;
+    }
+    /*endif*/
+    tm = s->header_tm;
+    memset(header, 0, 132 + 1);
     snprintf(header,
              132,
              "  %2d-%s-%d  %02d:%02d    %-50s %-21s   p.%d",
@@ -405,18 +419,11 @@ static void make_header(t4_tx_state_t *s, char *header)
 }
 /*- End of function --------------------------------------------------------*/
 
-static int t4_tx_put_fax_header(t4_tx_state_t *s)
+static int header_repeats(t4_tx_state_t *s)
 {
-    int row;
-    int i;
     int repeats;
-    int pattern;
-    int row_bufptr;
-    char *t;
-    char header[132 + 1];
 
-    /* Modify the resulting image to include a header line, typical of hardware FAX machines */
-    make_header(s, header);
+    /* Each row of the header font is repeated to keep the text roughly square */
     switch (s->y_resolution)
     {
     case T4_Y_RESOLUTION_1200:
@@ -442,20 +449,72 @@ static int t4_tx_put_fax_header(t4_tx_state_t *s)
         break;
     }
     /*endswitch*/
-    for (row = 0;  row < 16;  row++)
+    return repeats;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int render_header(t4_tx_state_t *s, const char *header)
+{
+    uint8_t *bitmap;
+    int chars;
+    int pattern;
+    int row;
+    int i;
+
+    /* Most pages of a job have the same header, apart from the page number, and
+       perhaps the time. Keep the header rendered, and only redraw the characters
+       which have changed since the last page. */
+    if (s->header_bytes_per_row != s->bytes_per_row)
     {
-        t = header;
-        row_bufptr = 0;
-        for (t = header;  *t  &&  row_bufptr <= s->bytes_per_row - 2;  t++)
+        if ((bitmap = (uint8_t *) span_realloc(s->header_bitmap, 16*s->bytes_per_row)) == NULL)
+            return -1;
+        /*endif*/
+        s->header_bitmap = bitmap;
+        s->header_bytes_per_row = s->bytes_per_row;
+        memset(s->header_bitmap, 0, 16*s->bytes_per_row);
+        memset(s->header_text, 0, sizeof(s->header_text));
+    }
+    /*endif*/
+    /* Each character is 16 pixels wide, and only whole characters fit in the row */
+    chars = s->bytes_per_row/2;
+    if (chars > 132)
+        chars = 132;
+    /*endif*/
+    for (i = 0;  i < chars;  i++)
+    {
+        if (header[i] == s->header_text[i])
+            continue;
+        /*endif*/
+        for (row = 0;  row < 16;  row++)
         {
-            pattern = header_font[(uint8_t) *t][row];
-            s->row_buf[row_bufptr++] = (uint8_t) (pattern >> 8);
-            s->row_buf[row_bufptr++] = (uint8_t) (pattern & 0xFF);
+            pattern = (header[i])  ?  header_font[(uint8_t) header[i]][row]  :  0;
+            s->header_bitmap[row*s->bytes_per_row + 2*i] = (uint8_t) (pattern >> 8);
+            s->header_bitmap[row*s->bytes_per_row + 2*i + 1] = (uint8_t) (pattern & 0xFF);
         }
         /*endfor*/
-        for (  ;  row_bufptr < s->bytes_per_row;  )
-            s->row_buf[row_bufptr++] = 0;
-        /*endfor*/
+        s->header_text[i] = header[i];
+    }
+    /*endfor*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int t4_tx_put_fax_header(t4_tx_state_t *s)
+{
+    int row;
+    int i;
+    int repeats;
+    char header[132 + 1];
+
+    /* Modify the resulting image to include a header line, typical of hardware FAX machines */
+    make_header(s, header);
+    if (render_header(s, header))
+        return -1;
+    /*endif*/
+    repeats = header_repeats(s);
+    for (row = 0;  row < 16;  row++)
+    {
+        memcpy(s->row_buf, &s->header_bitmap[row*s->bytes_per_row], s->bytes_per_row);
         for (i = 0;  i < repeats;  i++)
         {
             if (encode_row(s))
@@ -788,6 +847,13 @@ static int free_buffers(t4_tx_state_t *s)
         s->row_buf = NULL;
     }
     /*endif*/
+    if (s->header_bitmap)
+    {
+        span_free(s->header_bitmap);
+        s->header_bitmap = NULL;
+        s->header_bytes_per_row = 0;
+    }
+    /*endif*/
     return 0;
 }
 /*- End of function --------------------------------------------------------*/
@@ -920,7 +986,7 @@ static __inline__ int put_encoded_bits(t4_tx_state_t *s, uint32_t bits, int leng
     s->row_bits += length;
     if ((s->image_size + (s->tx_bits + 7)/8) >= s->image_buffer_size)
     {
-        if ((t = realloc(s->image_buffer, s->image_buffer_size + 100*s->bytes_per_row)) == NULL)
+        if ((t = span_realloc(s->image_buffer, s->image_buffer_size + 100*s->bytes_per_row)) == NULL)
             return -1;
         /*endif*/
         s->image_buffer = t;
@@ -1249,10 +1315,48 @@ static void encode_1d_row(t4_tx_state_t *s)
 }
 /*- End of function --------------------------------------------------------*/
 
+#if defined(SPANDSP_SUPPORT_T85)
+static int put_t85_output(t4_tx_state_t *s)
+{
+    uint8_t *t;
+    int len;
+
+    /* Move whatever the T.85 encoder has produced into the image buffer */
+    do
+    {
+        if (s->image_size + s->bytes_per_row >= s->image_buffer_size)
+        {
+            if ((t = span_realloc(s->image_buffer, s->image_buffer_size + 100*s->bytes_per_row)) == NULL)
+                return -1;
+            /*endif*/
+            s->image_buffer = t;
+            s->image_buffer_size += 100*s->bytes_per_row;
+        }
+        /*endif*/
+        len = t85_encode_get(&s->t85_tx, s->image_buffer + s->image_size, s->image_buffer_size - s->image_size);
+        s->image_size += len;
+    }
+    while (len > 0);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+#endif
+
 static int encode_row(t4_tx_state_t *s)
 {
     switch (s->line_encoding)
     {
+#if defined(SPANDSP_SUPPORT_T85)
+    case T4_COMPRESSION_ITU_T85:
+    case T4_COMPRESSION_ITU_T85_L0:
+        if (t85_encode_put_row(&s->t85_tx, s->row_buf))
+            return -1;
+        /*endif*/
+        if (put_t85_output(s))
+            return -1;
+        /*endif*/
+        break;
+#endif
     case T4_COMPRESSION_ITU_T6:
         /* T.6 compression is a trivial step up from T.4 2D, so we just
            throw it in here. T.6 is only used with error correction,
@@ -1344,15 +1448,15 @@ SPAN_DECLARE(int) t4_tx_start_page(t4_tx_state_t *s)
     {
         s->bytes_per_row = (s->image_width + 7)/8;
 
-        if ((bufptr = (uint32_t *) realloc(s->cur_runs, run_space)) == NULL)
+        if ((bufptr = (uint32_t *) span_realloc(s->cur_runs, run_space)) == NULL)
             return -1;
         /*endif*/
         s->cur_runs = bufptr;
-        if ((bufptr = (uint32_t *) realloc(s->ref_runs, run_space)) == NULL)
+        if ((bufptr = (uint32_t *) span_realloc(s->ref_runs, run_space)) == NULL)
             return -1;
         /*endif*/
         s->ref_runs = bufptr;
-        if ((bufptr8 = realloc(s->row_buf, s->bytes_per_row)) == NULL)
+        if ((bufptr8 = span_realloc(s->row_buf, s->bytes_per_row)) == NULL)
             return -1;
         /*endif*/
         s->row_buf = bufptr8;
@@ -1368,6 +1472,26 @@ SPAN_DECLARE(int) t4_tx_start_page(t4_tx_state_t *s)
     s->min_row_bits = INT_MAX;
     s->max_row_bits = 0;
 
+#if defined(SPANDSP_SUPPORT_T85)
+    if (s->line_encoding == T4_COMPRESSION_ITU_T85  ||  s->line_encoding == T4_COMPRESSION_ITU_T85_L0)
+    {
+        /* The length goes in the T.85 header, so work it out now if we can. If rows come
+           from a row read handler we can't, and the encoder will send a NEWLEN at the end. */
+        len = 0;
+        if (s->t4_t6_tx.row_read_handler == NULL)
+        {
+            len = s->image_length;
+            if (s->header_info  &&  s->header_info[0])
+                len += 16*header_repeats(s);
+            /*endif*/
+        }
+        /*endif*/
+        if (t85_encode_restart(&s->t85_tx, s->image_width, len))
+            return -1;
+        /*endif*/
+    }
+    /*endif*/
+#endif
     if (s->header_info  &&  s->header_info[0])
     {
         if (t4_tx_put_fax_header(s))
@@ -1402,6 +1526,21 @@ SPAN_DECLARE(int) t4_tx_start_page(t4_tx_state_t *s)
         /*endif*/
     }
     /*endif*/
+#if defined(SPANDSP_SUPPORT_T85)
+    if (s->line_encoding == T4_COMPRESSION_ITU_T85  ||  s->line_encoding == T4_COMPRESSION_ITU_T85_L0)
+    {
+        /* T.85 has no EOLs. The encoder terminates the image itself. */
+        t85_encode_image_complete(&s->t85_tx);
+        if (put_t85_output(s))
+            return -1;
+        /*endif*/
+        s->t4_t6_tx.bit_pos = 7;
+        s->t4_t6_tx.bit_ptr = 0;
+        s->line_image_size = s->image_size*8;
+        return 0;
+    }
+    /*endif*/
+#endif
     if (s->line_encoding == T4_COMPRESSION_ITU_T6)
     {
         /* Attach an EOFB (end of facsimile block == 2 x EOLs) to the end of the page */
@@ -1550,6 +1689,13 @@ SPAN_DECLARE(void) t4_tx_set_header_info(t4_tx_state_t *s, const char *info)
 SPAN_DECLARE(void) t4_tx_set_header_tz(t4_tx_state_t *s, struct tz_s *tz)
 {
     s->tz = tz;
+    s->header_minute = -1;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(void) t4_tx_set_header_time(t4_tx_state_t *s, time_t when)
+{
+    s->header_time = when;
 }
 /*- End of function --------------------------------------------------------*/
 
@@ -1625,6 +1771,8 @@ SPAN_DECLARE(t4_tx_state_t *) t4_tx_init(t4_tx_state_t *s, const char *file, int
     span_log_init(&s->logging, SPAN_LOG_NONE, NULL);
     span_log_set_protocol(&s->logging, "T.4");
     s->rx = false;
+    s->header_time = -1;
+    s->header_minute = -1;
 
     span_log(&s->logging, SPAN_LOG_FLOW, "Start tx document\n");
 
@@ -1698,6 +1846,18 @@ SPAN_DECLARE(t4_tx_state_t *) t4_tx_init(t4_tx_state_t *s, const char *file, int
     s->ref_runs[3] = s->image_width;
     s->t4_t6_tx.ref_steps = 1;
     s->image_buffer_size = 0;
+#if defined(SPANDSP_SUPPORT_T85)
+    if (t85_encode_init(&s->t85_tx, s->image_width, s->image_length, NULL, NULL) == NULL)
+    {
+        free_buffers(s);
+        close_tiff_input_file(s);
+        if (allocated)
+            span_free(s);
+        /*endif*/
+        return NULL;
+    }
+    /*endif*/
+#endif
     return s;
 }
 /*- End of function --------------------------------------------------------*/
@@ -1711,6 +1871,9 @@ SPAN_DECLARE(int) t4_tx_release(t4_tx_state_t *s)
         close_tiff_input_file(s);
     /*endif*/
     free_buffers(s);
+#if defined(SPANDSP_SUPPORT_T85)
+    t85_encode_release(&s->t85_tx);
+#endif
     return 0;
 }
 /*- End of function --------------------------------------------------------*/
@@ -0,0 +1,495 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * t81_t82_arith_coding.c - ITU T.81 and T.82 QM-coder arithmetic encoding
+ *                          and decoding
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2009 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 2.1,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \file */
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(HAVE_STDBOOL_H)
+#include <stdbool.h>
+#else
+#include "spandsp/stdbool.h"
+#endif
+
+#include "spandsp/telephony.h"
+#include "spandsp/alloc.h"
+#include "spandsp/t81_t82_arith_coding.h"
+
+#include "spandsp/private/t81_t82_arith_coding.h"
+
+/* T.82 table 24 - Probability estimation table. The LPS interval size for
+   each state. */
+static const uint16_t lsztab[113] =
+{
+    0x5A1D, 0x2586, 0x1114, 0x080B, 0x03D8, 0x01DA, 0x00E5, 0x006F,
+    0x0036, 0x001A, 0x000D, 0x0006, 0x0003, 0x0001, 0x5A7F, 0x3F25,
+    0x2CF2, 0x207C, 0x17B9, 0x1182, 0x0CEF, 0x09A1, 0x072F, 0x055C,
+    0x0406, 0x0303, 0x0240, 0x01B1, 0x0144, 0x00F5, 0x00B7, 0x008A,
+    0x0068, 0x004E, 0x003B, 0x002C, 0x5AE1, 0x484C, 0x3A0D, 0x2EF1,
+    0x261F, 0x1F33, 0x19A8, 0x1518, 0x1177, 0x0E74, 0x0BFB, 0x09F8,
+    0x0861, 0x0706, 0x05CD, 0x04DE, 0x040F, 0x0363, 0x02D4, 0x025C,
+    0x01F8, 0x01A4, 0x0160, 0x0125, 0x00F6, 0x00CB, 0x00AB, 0x008F,
+    0x5B12, 0x4D04, 0x412C, 0x37D8, 0x2FE8, 0x293C, 0x2379, 0x1EDF,
+    0x1AA9, 0x174E, 0x1424, 0x119C, 0x0F6B, 0x0D51, 0x0BB6, 0x0A40,
+    0x5832, 0x4D1C, 0x438E, 0x3BDD, 0x34EE, 0x2EAE, 0x299A, 0x2516,
+    0x5570, 0x4CA9, 0x44D9, 0x3E22, 0x3824, 0x32B4, 0x2E17, 0x56A8,
+    0x4F46, 0x47E5, 0x41CF, 0x3C3D, 0x375E, 0x5231, 0x4C0F, 0x4639,
+    0x415E, 0x5627, 0x50E7, 0x4B85, 0x5597, 0x504F, 0x5A10, 0x5522,
+    0x59EB
+};
+
+/* The next state after coding a more probable symbol */
+static const uint8_t nmpstab[113] =
+{
+      1,   2,   3,   4,   5,   6,   7,   8,
+      9,  10,  11,  12,  13,  13,  15,  16,
+     17,  18,  19,  20,  21,  22,  23,  24,
+     25,  26,  27,  28,  29,  30,  31,  32,
+     33,  34,  35,   9,  37,  38,  39,  40,
+     41,  42,  43,  44,  45,  46,  47,  48,
+     49,  50,  51,  52,  53,  54,  55,  56,
+     57,  58,  59,  60,  61,  62,  63,  32,
+     65,  66,  67,  68,  69,  70,  71,  72,
+     73,  74,  75,  76,  77,  78,  79,  48,
+     81,  82,  83,  84,  85,  86,  87,  71,
+     89,  90,  91,  92,  93,  94,  86,  96,
+     97,  98,  99, 100,  93, 102, 103, 104,
+     99, 106, 107, 103, 109, 107, 111, 109,
+    111
+};
+
+/* The next state after coding a less probable symbol. The least significant 7 bits
+   are the new state. The most significant bit is the SWTCH flag, saying the more
+   probable symbol must be inverted. */
+static const uint8_t nlpstab[113] =
+{
+    129,  14,  16,  18,  20,  23,  25,  28,
+     30,  33,  35,   9,  10,  12, 143,  36,
+     38,  39,  40,  42,  43,  45,  46,  48,
+     49,  51,  52,  54,  56,  57,  59,  60,
+     62,  63,  32,  33, 165,  64,  65,  67,
+     68,  69,  70,  72,  73,  74,  75,  77,
+     78,  79,  48,  50,  50,  51,  52,  53,
+     54,  55,  56,  57,  58,  59,  61,  61,
+    193,  80,  81,  82,  83,  84,  86,  87,
+     87,  72,  72,  74,  74,  75,  77,  77,
+    208,  88,  89,  90,  91,  92,  93,  86,
+    216,  95,  96,  97,  99,  99,  93, 223,
+    101, 102, 103, 104,  99, 105, 106, 107,
+    103, 233, 108, 109, 110, 111, 238, 112,
+    240
+};
+
+static __inline__ void output_stuffed_byte(t81_t82_arith_encode_state_t *s, int byte)
+{
+    s->output_byte_handler(s->user_data, byte);
+    if (byte == T81_T82_ARITH_MARKER_ESC)
+        s->output_byte_handler(s->user_data, T81_T82_ARITH_MARKER_STUFF);
+    /*endif*/
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(void) t81_t82_arith_encode(t81_t82_arith_encode_state_t *s, int cx, int bit)
+{
+    uint32_t temp;
+    uint32_t lsz;
+    int ss;
+    uint8_t *st;
+
+    st = &s->st[cx];
+    ss = *st & 0x7F;
+    lsz = lsztab[ss];
+    if (((bit << 7) ^ *st) & 0x80)
+    {
+        /* Encode the less probable symbol */
+        if ((s->a -= lsz) >= lsz)
+        {
+            /* If the interval size for the LPS is larger than the interval size for
+               the MPS, exchange the two symbols (conditional exchange). */
+            s->c += s->a;
+            s->a = lsz;
+        }
+        /*endif*/
+        /* Check whether an MPS/LPS exchange is needed, and choose the next
+           probability estimator status */
+        *st &= 0x80;
+        *st ^= nlpstab[ss];
+    }
+    else
+    {
+        /* Encode the more probable symbol */
+        if ((s->a -= lsz) & 0xFFFF8000)
+            return;   /* A >= 0x8000, so no renormalisation is needed */
+        /*endif*/
+        if (s->a < lsz)
+        {
+            /* Conditional exchange */
+            s->c += s->a;
+            s->a = lsz;
+        }
+        /*endif*/
+        *st &= 0x80;
+        *st |= nmpstab[ss];
+    }
+    /*endif*/
+
+    /* Renormalise the coding interval */
+    do
+    {
+        s->a <<= 1;
+        s->c <<= 1;
+        if (--s->ct == 0)
+        {
+            /* Another byte is ready for output */
+            temp = s->c >> 19;
+            if (temp & 0xFFFFFF00)
+            {
+                /* Handle an overflow over all the buffered 0xFF bytes */
+                if (s->buffer >= 0)
+                    output_stuffed_byte(s, s->buffer + 1);
+                /*endif*/
+                for (  ;  s->sc;  s->sc--)
+                    s->output_byte_handler(s->user_data, 0x00);
+                /*endfor*/
+                /* The new output byte might overflow later */
+                s->buffer = temp & 0xFF;
+            }
+            else if (temp == 0xFF)
+            {
+                /* Buffer the 0xFF byte, as it might overflow later */
+                s->sc++;
+            }
+            else
+            {
+                /* Output all the buffered 0xFF bytes, as they can no longer overflow */
+                if (s->buffer >= 0)
+                    s->output_byte_handler(s->user_data, s->buffer);
+                /*endif*/
+                for (  ;  s->sc;  s->sc--)
+                {
+                    s->output_byte_handler(s->user_data, 0xFF);
+                    s->output_byte_handler(s->user_data, T81_T82_ARITH_MARKER_STUFF);
+                }
+                /*endfor*/
+                /* Buffer the new output byte, as it might still overflow */
+                s->buffer = temp;
+            }
+            /*endif*/
+            s->c &= 0x7FFFF;
+            s->ct = 8;
+        }
+        /*endif*/
+    }
+    while (s->a < 0x8000);
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(void) t81_t82_arith_encode_flush(t81_t82_arith_encode_state_t *s)
+{
+    uint32_t temp;
+
+    /* Find the value of C within the coding interval which has the largest
+       number of trailing zero bits */
+    if ((temp = (s->a - 1 + s->c) & 0xFFFF0000) < s->c)
+        s->c = temp + 0x8000;
+    else
+        s->c = temp;
+    /*endif*/
+    /* Send the remaining bytes to the output */
+    s->c <<= s->ct;
+    if (s->c & 0xF8000000)
+    {
+        /* One final overflow has to be handled */
+        if (s->buffer >= 0)
+            output_stuffed_byte(s, s->buffer + 1);
+        /*endif*/
+        /* Only output 0x00 bytes if more non-0x00 bytes will follow */
+        if (s->c & 0x7FFF800)
+        {
+            for (  ;  s->sc;  s->sc--)
+                s->output_byte_handler(s->user_data, 0x00);
+            /*endfor*/
+        }
+        /*endif*/
+    }
+    else
+    {
+        if (s->buffer >= 0)
+            s->output_byte_handler(s->user_data, s->buffer);
+        /*endif*/
+        for (  ;  s->sc;  s->sc--)
+        {
+            s->output_byte_handler(s->user_data, 0xFF);
+            s->output_byte_handler(s->user_data, T81_T82_ARITH_MARKER_STUFF);
+        }
+        /*endfor*/
+    }
+    /*endif*/
+    /* Only output the final bytes if they are not 0x00 */
+    if (s->c & 0x7FFF800)
+    {
+        output_stuffed_byte(s, (s->c >> 19) & 0xFF);
+        if (s->c & 0x7F800)
+            output_stuffed_byte(s, (s->c >> 11) & 0xFF);
+        /*endif*/
+    }
+    /*endif*/
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) t81_t82_arith_encode_restart(t81_t82_arith_encode_state_t *s, int reuse_st)
+{
+    if (!reuse_st)
+        memset(s->st, 0, sizeof(s->st));
+    /*endif*/
+    s->c = 0;
+    s->a = 0x10000;
+    s->sc = 0;
+    s->ct = 11;
+    s->buffer = -1;
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(t81_t82_arith_encode_state_t *) t81_t82_arith_encode_init(t81_t82_arith_encode_state_t *s,
+                                                                       void (*output_byte_handler)(void *, int),
+                                                                       void *user_data)
+{
+    if (s == NULL)
+    {
+        if ((s = (t81_t82_arith_encode_state_t *) span_alloc(sizeof(*s))) == NULL)
+            return NULL;
+        /*endif*/
+    }
+    /*endif*/
+    memset(s, 0, sizeof(*s));
+    s->output_byte_handler = output_byte_handler;
+    s->user_data = user_data;
+    t81_t82_arith_encode_restart(s, false);
+    return s;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) t81_t82_arith_encode_release(t81_t82_arith_encode_state_t *s)
+{
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) t81_t82_arith_encode_free(t81_t82_arith_encode_state_t *s)
+{
+    int ret;
+
+    ret = t81_t82_arith_encode_release(s);
+    span_free(s);
+    return ret;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) t81_t82_arith_decode(t81_t82_arith_decode_state_t *s, int cx)
+{
+    uint32_t lsz;
+    int ss;
+    int bit;
+    uint8_t *st;
+
+    /* Renormalisation, which is deferred until the next decision, so the decoder
+       does not wait for bytes it may never need. */
+    while (s->a < 0x8000  ||  s->startup)
+    {
+        while (s->ct <= 8  &&  s->ct >= 0)
+        {
+            /* We can move a new byte into C */
+            if (s->pscd_ptr >= s->pscd_end)
+                return -1;
+            /*endif*/
+            if (*s->pscd_ptr == T81_T82_ARITH_MARKER_ESC)
+            {
+                if (s->pscd_ptr + 1 >= s->pscd_end)
+                    return -1;
+                /*endif*/
+                if (s->pscd_ptr[1] == T81_T82_ARITH_MARKER_STUFF)
+                {
+                    s->c |= 0xFFU << (8 - s->ct);
+                    s->ct += 8;
+                    s->pscd_ptr += 2;
+                }
+                else
+                {
+                    /* We have hit a marker. Continue by padding with zero bytes. */
+                    s->ct = -1;
+                    if (s->nopadding)
+                    {
+                        s->nopadding = false;
+                        return -2;
+                    }
+                    /*endif*/
+                }
+                /*endif*/
+            }
+            else
+            {
+                s->c |= (uint32_t) *s->pscd_ptr++ << (8 - s->ct);
+                s->ct += 8;
+            }
+            /*endif*/
+        }
+        /*endwhile*/
+        s->c <<= 1;
+        s->a <<= 1;
+        if (s->ct >= 0)
+            s->ct--;
+        /*endif*/
+        if (s->a == 0x10000)
+            s->startup = false;
+        /*endif*/
+    }
+    /*endwhile*/
+
+    st = &s->st[cx];
+    ss = *st & 0x7F;
+    lsz = lsztab[ss];
+    if ((s->c >> 16) < (s->a -= lsz))
+    {
+        if (s->a & 0xFFFF8000)
+            return *st >> 7;
+        /*endif*/
+        /* MPS exchange */
+        if (s->a < lsz)
+        {
+            bit = 1 - (*st >> 7);
+            *st &= 0x80;
+            *st ^= nlpstab[ss];
+        }
+        else
+        {
+            bit = *st >> 7;
+            *st &= 0x80;
+            *st |= nmpstab[ss];
+        }
+        /*endif*/
+    }
+    else
+    {
+        /* LPS exchange */
+        s->c -= s->a << 16;
+        if (s->a < lsz)
+        {
+            s->a = lsz;
+            bit = *st >> 7;
+            *st &= 0x80;
+            *st |= nmpstab[ss];
+        }
+        else
+        {
+            s->a = lsz;
+            bit = 1 - (*st >> 7);
+            *st &= 0x80;
+            *st ^= nlpstab[ss];
+        }
+        /*endif*/
+    }
+    /*endif*/
+    return bit;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(void) t81_t82_arith_decode_set_data(t81_t82_arith_decode_state_t *s, const uint8_t data[], size_t len)
+{
+    s->pscd_start =
+    s->pscd_ptr = data;
+    s->pscd_end = data + len;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(size_t) t81_t82_arith_decode_get_consumed(t81_t82_arith_decode_state_t *s)
+{
+    return s->pscd_ptr - s->pscd_start;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(void) t81_t82_arith_decode_set_nopadding(t81_t82_arith_decode_state_t *s)
+{
+    s->nopadding = true;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) t81_t82_arith_decode_padding(t81_t82_arith_decode_state_t *s)
+{
+    return (s->ct < 0);
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) t81_t82_arith_decode_restart(t81_t82_arith_decode_state_t *s, int reuse_st)
+{
+    if (!reuse_st)
+        memset(s->st, 0, sizeof(s->st));
+    /*endif*/
+    s->c = 0;
+    s->a = 1;
+    s->ct = 0;
+    s->startup = true;
+    s->nopadding = false;
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(t81_t82_arith_decode_state_t *) t81_t82_arith_decode_init(t81_t82_arith_decode_state_t *s)
+{
+    if (s == NULL)
+    {
+        if ((s = (t81_t82_arith_decode_state_t *) span_alloc(sizeof(*s))) == NULL)
+            return NULL;
+        /*endif*/
+    }
+    /*endif*/
+    memset(s, 0, sizeof(*s));
+    t81_t82_arith_decode_restart(s, false);
+    return s;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) t81_t82_arith_decode_release(t81_t82_arith_decode_state_t *s)
+{
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) t81_t82_arith_decode_free(t81_t82_arith_decode_state_t *s)
+{
+    int ret;
+
+    ret = t81_t82_arith_decode_release(s);
+    span_free(s);
+    return ret;
+}
+/*- End of function --------------------------------------------------------*/
+/*- End of file ------------------------------------------------------------*/
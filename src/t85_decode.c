@@ -0,0 +1,738 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * t85_decode.c - ITU T.85 JBIG for FAX image decompression
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2008, 2009 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 2.1,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \file */
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#if defined(HAVE_STDBOOL_H)
+#include <stdbool.h>
+#else
+#include "spandsp/stdbool.h"
+#endif
+
+#include "spandsp/telephony.h"
+#include "spandsp/alloc.h"
+#include "spandsp/logging.h"
+#include "spandsp/async.h"
+#include "spandsp/timezone.h"
+#include "spandsp/t4_rx.h"
+#include "spandsp/t4_tx.h"
+#include "spandsp/t81_t82_arith_coding.h"
+#include "spandsp/t85.h"
+
+#include "spandsp/private/logging.h"
+#include "spandsp/private/t81_t82_arith_coding.h"
+#include "spandsp/private/t85.h"
+
+/* The contexts used to code the TPB pseudo pixels, for the 2 and 3 line templates */
+#define TPB2CX                      0x195
+#define TPB3CX                      0x0E5
+
+/* BIH order and option bits which T.85 does not allow */
+#define T85_BAD_ORDER_BITS          0x0F
+#define T85_BAD_OPTION_BITS         0x97
+
+enum
+{
+    T85_STATE_BIH = 0,
+    T85_STATE_MARKERS,
+    T85_STATE_COMMENT,
+    T85_STATE_PSCD,
+    T85_STATE_SDE_END,
+    T85_STATE_DONE,
+    T85_STATE_FAILED
+};
+
+/* Outcomes of decoding some of the PSCD of a stripe */
+enum
+{
+    PSCD_MORE_DATA = 0,
+    PSCD_STRIPE_DONE
+};
+
+static __inline__ uint32_t pack_32(const uint8_t *s)
+{
+    return ((uint32_t) s[0] << 24) | ((uint32_t) s[1] << 16) | ((uint32_t) s[2] << 8) | (uint32_t) s[3];
+}
+/*- End of function --------------------------------------------------------*/
+
+static int fail(t85_decode_state_t *s, int reason, const char *why)
+{
+    span_log(&s->logging, SPAN_LOG_WARNING, "%s\n", why);
+    s->state = T85_STATE_FAILED;
+    s->failure = reason;
+    return reason;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int parse_bih(t85_decode_state_t *s, const uint8_t bih[])
+{
+    uint8_t *t;
+    int bytes_per_row;
+
+    /* T.85 only allows a single layer, with a single bit plane */
+    if (bih[0] != 0  ||  bih[1] != 0  ||  bih[2] != 1  ||  bih[3] != 0)
+        return fail(s, T4_DECODE_INVALID_DATA, "BIH describes more than one layer or plane");
+    /*endif*/
+    s->xd = pack_32(&bih[4]);
+    s->yd = pack_32(&bih[8]);
+    s->l0 = pack_32(&bih[12]);
+    s->mx = bih[16];
+    s->options = bih[19];
+    span_log(&s->logging,
+             SPAN_LOG_FLOW,
+             "BIH: XD %" PRIu32 ", YD %" PRIu32 ", L0 %" PRIu32 ", MX %d, MY %d, order 0x%02X, options 0x%02X\n",
+             s->xd,
+             s->yd,
+             s->l0,
+             s->mx,
+             bih[17],
+             bih[18],
+             s->options);
+    if (s->xd == 0  ||  s->yd == 0  ||  s->l0 == 0)
+        return fail(s, T4_DECODE_INVALID_DATA, "BIH has a zero dimension");
+    /*endif*/
+    if (s->mx > 127  ||  bih[17] != 0  ||  (bih[18] & T85_BAD_ORDER_BITS)  ||  (s->options & T85_BAD_OPTION_BITS))
+        return fail(s, T4_DECODE_INVALID_DATA, "BIH uses features T.85 does not allow");
+    /*endif*/
+    if ((s->max_xd  &&  s->xd > s->max_xd)
+        ||
+        (s->max_yd  &&  s->yd > s->max_yd  &&  !(s->options & T85_VLENGTH)))
+    {
+        return fail(s, T4_DECODE_INVALID_DATA, "BIH image size exceeds the limits");
+    }
+    /*endif*/
+    bytes_per_row = (s->xd + 7)/8;
+    if (bytes_per_row != s->bytes_per_row  ||  s->row_buf == NULL)
+    {
+        if ((t = (uint8_t *) span_realloc(s->row_buf, 3*bytes_per_row)) == NULL)
+            return fail(s, T4_DECODE_NOMEM, "Out of memory for the image rows");
+        /*endif*/
+        s->row_buf = t;
+        s->bytes_per_row = bytes_per_row;
+    }
+    /*endif*/
+    /* The rows above the first row are white */
+    memset(s->row_buf, 0, 3*bytes_per_row);
+    s->row_h1 = s->row_buf;
+    s->row_h2 = s->row_buf + bytes_per_row;
+    s->row_h3 = s->row_buf + 2*bytes_per_row;
+    s->y = 0;
+    s->tx = 0;
+    s->at_moves = 0;
+    s->reset = true;
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int row_complete(t85_decode_state_t *s)
+{
+    uint8_t *t;
+
+    if (s->row_write_handler)
+        s->row_write_handler(s->row_write_user_data, s->row_h1, s->bytes_per_row);
+    /*endif*/
+    /* Rotate the rows */
+    t = s->row_h3;
+    s->row_h3 = s->row_h2;
+    s->row_h2 = s->row_h1;
+    s->row_h1 = t;
+    s->y++;
+    s->i++;
+    s->x = 0;
+    s->pseudo = true;
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int check_newlen(t85_decode_state_t *s, int end_of_data)
+{
+    const uint8_t *p;
+    size_t avail;
+    uint32_t newlen;
+
+    /* The arithmetic decoder has stopped at a marker. If it is the end of the stripe,
+       followed by a NEWLEN, the image may end before the decoder would otherwise
+       think. We need to know that before padding out a row which may not exist. */
+    p = s->s.pscd_ptr;
+    avail = s->s.pscd_end - p;
+    if (avail < 2  ||  ((p[1] == T82_SDNORM  ||  p[1] == T82_SDRST)  &&  avail < 8))
+        return (end_of_data)  ?  0  :  -1;
+    /*endif*/
+    if ((p[1] == T82_SDNORM  ||  p[1] == T82_SDRST)
+        &&
+        p[2] == T81_T82_ARITH_MARKER_ESC
+        &&
+        p[3] == T82_NEWLEN)
+    {
+        newlen = pack_32(&p[4]);
+        if (newlen >= s->y  &&  newlen < s->yd)
+        {
+            span_log(&s->logging, SPAN_LOG_FLOW, "NEWLEN %" PRIu32 "\n", newlen);
+            s->yd = newlen;
+        }
+        /*endif*/
+    }
+    /*endif*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int decode_pscd(t85_decode_state_t *s, int end_of_data)
+{
+    uint32_t line_h1;
+    uint32_t line_h2;
+    uint32_t line_h3;
+    uint32_t x;
+    uint32_t pos;
+    int cx;
+    int pix;
+    int j;
+    int last;
+
+    last = s->bytes_per_row - 1;
+    for (;;)
+    {
+        if (s->marker_check)
+        {
+            if (check_newlen(s, end_of_data))
+                return PSCD_MORE_DATA;
+            /*endif*/
+            s->marker_check = false;
+        }
+        /*endif*/
+        if (s->i >= s->l0  ||  s->y >= s->yd)
+            return PSCD_STRIPE_DONE;
+        /*endif*/
+        if (s->pseudo)
+        {
+            /* Start of a row */
+            while (s->at_moves > 0  &&  s->at_row[0] <= s->i)
+            {
+                s->tx = s->at_tx[0];
+                span_log(&s->logging, SPAN_LOG_FLOW, "AT moved to %d at row %" PRIu32 "\n", s->tx, s->y);
+                s->at_moves--;
+                memmove(&s->at_row[0], &s->at_row[1], s->at_moves*sizeof(s->at_row[0]));
+                memmove(&s->at_tx[0], &s->at_tx[1], s->at_moves*sizeof(s->at_tx[0]));
+            }
+            /*endwhile*/
+            /* If we hit a marker in this row, stop and check for a NEWLEN before
+               padding with zeros. */
+            t81_t82_arith_decode_set_nopadding(&s->s);
+            if ((s->options & T85_TPBON))
+            {
+                pix = t81_t82_arith_decode(&s->s, (s->options & T85_LRLTWO)  ?  TPB2CX  :  TPB3CX);
+                if (pix < 0)
+                {
+                    if (pix == -2)
+                    {
+                        s->marker_check = true;
+                        continue;
+                    }
+                    /*endif*/
+                    return PSCD_MORE_DATA;
+                }
+                /*endif*/
+                s->prev_ltp ^= !pix;
+                if (s->prev_ltp)
+                {
+                    /* A typical row, which is a copy of the row above */
+                    memcpy(s->row_h1, s->row_h2, s->bytes_per_row);
+                    row_complete(s);
+                    continue;
+                }
+                /*endif*/
+            }
+            /*endif*/
+            s->pseudo = false;
+            s->x = 0;
+            s->line_h1 = 0;
+            s->line_h2 = (uint32_t) s->row_h2[0] << 8;
+            s->line_h3 = (uint32_t) s->row_h3[0] << 8;
+        }
+        /*endif*/
+
+        /* The context registers are aligned as in the encoder. See t85_encode.c. */
+        line_h1 = s->line_h1;
+        line_h2 = s->line_h2;
+        line_h3 = s->line_h3;
+        for (x = s->x;  x < s->xd;  x++)
+        {
+            if ((x & 7) == 0)
+            {
+                /* Load the next byte of the rows above. If we are resuming at a byte
+                   boundary this repeats an OR already done, which is harmless. */
+                j = x >> 3;
+                if (j < last)
+                {
+                    line_h2 |= s->row_h2[j + 1];
+                    line_h3 |= s->row_h3[j + 1];
+                }
+                /*endif*/
+            }
+            /*endif*/
+            if (s->tx == 0)
+            {
+                if ((s->options & T85_LRLTWO))
+                    cx = ((line_h2 >> 9) & 0x3F0) | (line_h1 & 0x00F);
+                else
+                    cx = ((line_h3 >> 7) & 0x380) | ((line_h2 >> 11) & 0x07C) | (line_h1 & 0x003);
+                /*endif*/
+            }
+            else
+            {
+                /* The AT pixel has been moved somewhere along the current row */
+                if (s->tx < 32)
+                {
+                    pix = (line_h1 >> (s->tx - 1)) & 1;
+                }
+                else if (x >= (uint32_t) s->tx)
+                {
+                    pos = x - s->tx;
+                    pix = (s->row_h1[pos >> 3] >> (7 - (pos & 7))) & 1;
+                }
+                else
+                {
+                    pix = 0;
+                }
+                /*endif*/
+                if ((s->options & T85_LRLTWO))
+                    cx = ((line_h2 >> 9) & 0x3E0) | (pix << 4) | (line_h1 & 0x00F);
+                else
+                    cx = ((line_h3 >> 7) & 0x380) | ((line_h2 >> 11) & 0x078) | (pix << 2) | (line_h1 & 0x003);
+                /*endif*/
+            }
+            /*endif*/
+            if ((pix = t81_t82_arith_decode(&s->s, cx)) < 0)
+            {
+                s->x = x;
+                s->line_h1 = line_h1;
+                s->line_h2 = line_h2;
+                s->line_h3 = line_h3;
+                if (pix == -2)
+                {
+                    s->marker_check = true;
+                    break;
+                }
+                /*endif*/
+                return PSCD_MORE_DATA;
+            }
+            /*endif*/
+            line_h1 = (line_h1 << 1) | pix;
+            line_h2 <<= 1;
+            line_h3 <<= 1;
+            if (((x + 1) & 7) == 0)
+                s->row_h1[x >> 3] = (uint8_t) line_h1;
+            /*endif*/
+        }
+        /*endfor*/
+        if (s->marker_check)
+            continue;
+        /*endif*/
+        if ((s->xd & 7))
+            s->row_h1[last] = (uint8_t) (line_h1 << (8 - (s->xd & 7)));
+        /*endif*/
+        row_complete(s);
+    }
+    /*endfor*/
+    return PSCD_MORE_DATA;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int start_stripe(t85_decode_state_t *s)
+{
+    /* Typical prediction carries on from the previous stripe, unless it ended with an
+       SDRST, which puts everything back as it was at the start of the image. */
+    t81_t82_arith_decode_restart(&s->s, !s->reset);
+    if (s->reset)
+        s->prev_ltp = false;
+    /*endif*/
+    s->reset = false;
+    s->i = 0;
+    s->x = 0;
+    s->pseudo = true;
+    s->marker_check = false;
+    s->state = T85_STATE_PSCD;
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int parse_marker_segment(t85_decode_state_t *s, const uint8_t *p, size_t avail)
+{
+    uint32_t newlen;
+    uint32_t yat;
+    int tx;
+
+    /* Returns the length of the marker segment, or 0 if more data is needed */
+    switch (p[1])
+    {
+    case T82_ATMOVE:
+        if (avail < 8)
+            return 0;
+        /*endif*/
+        yat = pack_32(&p[2]);
+        tx = p[6];
+        if (p[7] != 0  ||  tx > s->mx  ||  s->at_moves >= T85_ATMOVES_MAX)
+            return fail(s, T4_DECODE_INVALID_DATA, "Bad ATMOVE");
+        /*endif*/
+        s->at_row[s->at_moves] = yat;
+        s->at_tx[s->at_moves] = tx;
+        s->at_moves++;
+        return 8;
+    case T82_NEWLEN:
+        if (avail < 6)
+            return 0;
+        /*endif*/
+        newlen = pack_32(&p[2]);
+        if (newlen < s->y  ||  newlen > s->yd)
+            return fail(s, T4_DECODE_INVALID_DATA, "Bad NEWLEN");
+        /*endif*/
+        span_log(&s->logging, SPAN_LOG_FLOW, "NEWLEN %" PRIu32 "\n", newlen);
+        s->yd = newlen;
+        return 6;
+    case T82_COMMENT:
+        if (avail < 6)
+            return 0;
+        /*endif*/
+        s->comment_len = pack_32(&p[2]);
+        span_log(&s->logging, SPAN_LOG_FLOW, "Comment of %" PRIu32 " bytes\n", s->comment_len);
+        s->state = T85_STATE_COMMENT;
+        return 6;
+    case T82_ABORT:
+        return fail(s, T4_DECODE_ABORTED, "Image aborted by the sender");
+    }
+    /*endswitch*/
+    return fail(s, T4_DECODE_INVALID_DATA, "Unexpected marker");
+}
+/*- End of function --------------------------------------------------------*/
+
+static int process(t85_decode_state_t *s, size_t *pos, int end_of_data)
+{
+    const uint8_t *p;
+    size_t avail;
+    size_t n;
+    int ret;
+
+    for (;;)
+    {
+        p = s->buffer + *pos;
+        avail = s->buffer_fill - *pos;
+        switch (s->state)
+        {
+        case T85_STATE_BIH:
+            if (avail < T85_BIH_LEN)
+                return T4_DECODE_MORE_DATA;
+            /*endif*/
+            if ((ret = parse_bih(s, p)) < 0)
+                return ret;
+            /*endif*/
+            *pos += T85_BIH_LEN;
+            s->state = T85_STATE_MARKERS;
+            break;
+        case T85_STATE_MARKERS:
+            if (s->y >= s->yd)
+            {
+                s->state = T85_STATE_DONE;
+                break;
+            }
+            /*endif*/
+            if (avail < 1)
+                return T4_DECODE_MORE_DATA;
+            /*endif*/
+            if (p[0] != T81_T82_ARITH_MARKER_ESC)
+            {
+                start_stripe(s);
+                break;
+            }
+            /*endif*/
+            if (avail < 2)
+                return T4_DECODE_MORE_DATA;
+            /*endif*/
+            /* A stripe of typical rows, carried over from the last stripe, can code to
+               nothing, so its SDNORM or SDRST comes straight away. */
+            if (p[1] == T81_T82_ARITH_MARKER_STUFF  ||  p[1] == T82_SDNORM  ||  p[1] == T82_SDRST)
+            {
+                start_stripe(s);
+                break;
+            }
+            /*endif*/
+            if ((ret = parse_marker_segment(s, p, avail)) < 0)
+                return ret;
+            /*endif*/
+            if (ret == 0)
+                return T4_DECODE_MORE_DATA;
+            /*endif*/
+            *pos += ret;
+            break;
+        case T85_STATE_COMMENT:
+            n = (avail < s->comment_len)  ?  avail  :  s->comment_len;
+            *pos += n;
+            s->comment_len -= n;
+            if (s->comment_len > 0)
+                return T4_DECODE_MORE_DATA;
+            /*endif*/
+            s->state = T85_STATE_MARKERS;
+            break;
+        case T85_STATE_PSCD:
+            t81_t82_arith_decode_set_data(&s->s, p, avail);
+            ret = decode_pscd(s, end_of_data);
+            *pos += t81_t82_arith_decode_get_consumed(&s->s);
+            if (ret == PSCD_MORE_DATA)
+                return T4_DECODE_MORE_DATA;
+            /*endif*/
+            s->state = T85_STATE_SDE_END;
+            break;
+        case T85_STATE_SDE_END:
+            /* Skip any remaining coded data, up to the marker which ends the stripe */
+            for (n = 0;  n < avail;  n++)
+            {
+                if (p[n] == T81_T82_ARITH_MARKER_ESC)
+                {
+                    if (n + 1 >= avail)
+                        break;
+                    /*endif*/
+                    if (p[n + 1] == T81_T82_ARITH_MARKER_STUFF)
+                    {
+                        n++;
+                        continue;
+                    }
+                    /*endif*/
+                    if (p[n + 1] == T82_SDNORM  ||  p[n + 1] == T82_SDRST)
+                    {
+                        s->reset = (p[n + 1] == T82_SDRST);
+                        s->state = T85_STATE_MARKERS;
+                        n += 2;
+                        break;
+                    }
+                    /*endif*/
+                    if (p[n + 1] == T82_ABORT)
+                        return fail(s, T4_DECODE_ABORTED, "Image aborted by the sender");
+                    /*endif*/
+                    return fail(s, T4_DECODE_INVALID_DATA, "Unexpected marker at the end of a stripe");
+                }
+                /*endif*/
+            }
+            /*endfor*/
+            *pos += n;
+            if (s->state == T85_STATE_SDE_END)
+                return T4_DECODE_MORE_DATA;
+            /*endif*/
+            break;
+        case T85_STATE_DONE:
+            span_log(&s->logging, SPAN_LOG_FLOW, "Image complete - %" PRIu32 " rows\n", s->y);
+            return T4_DECODE_OK;
+        default:
+            return s->failure;
+        }
+        /*endswitch*/
+    }
+    /*endfor*/
+    return T4_DECODE_MORE_DATA;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) t85_decode_put(t85_decode_state_t *s, const uint8_t data[], size_t len)
+{
+    uint8_t *t;
+    size_t pos;
+    int ret;
+
+    if (s->state == T85_STATE_DONE)
+        return T4_DECODE_OK;
+    /*endif*/
+    if (s->state == T85_STATE_FAILED)
+        return s->failure;
+    /*endif*/
+    if (len == 0)
+    {
+        /* The end of the data. Finish off anything we can, without making up rows
+           which were never sent. */
+        pos = 0;
+        ret = process(s, &pos, true);
+        if (ret == T4_DECODE_MORE_DATA)
+        {
+            if (s->y == 0)
+                return fail(s, T4_DECODE_INVALID_DATA, "Data ended before any rows were decoded");
+            /*endif*/
+            span_log(&s->logging, SPAN_LOG_WARNING, "Data ended at row %" PRIu32 " of %" PRIu32 "\n", s->y, s->yd);
+            s->state = T85_STATE_DONE;
+            ret = T4_DECODE_OK;
+        }
+        /*endif*/
+        s->buffer_fill = 0;
+        return ret;
+    }
+    /*endif*/
+    s->compressed_image_size += len;
+    /* Only the few bytes of an incomplete marker, or a trailing 0xFF, are ever held
+       over between calls, so this buffer stays about the size of the caller's chunks. */
+    if (s->buffer_fill + len > s->buffer_len)
+    {
+        if ((t = (uint8_t *) span_realloc(s->buffer, s->buffer_fill + len)) == NULL)
+            return fail(s, T4_DECODE_NOMEM, "Out of memory for the data buffer");
+        /*endif*/
+        s->buffer = t;
+        s->buffer_len = s->buffer_fill + len;
+    }
+    /*endif*/
+    memcpy(s->buffer + s->buffer_fill, data, len);
+    s->buffer_fill += len;
+    pos = 0;
+    ret = process(s, &pos, false);
+    if (pos < s->buffer_fill)
+        memmove(s->buffer, s->buffer + pos, s->buffer_fill - pos);
+    /*endif*/
+    s->buffer_fill -= pos;
+    return ret;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) t85_decode_set_row_write_handler(t85_decode_state_t *s,
+                                                   t4_row_write_handler_t handler,
+                                                   void *user_data)
+{
+    s->row_write_handler = handler;
+    s->row_write_user_data = user_data;
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) t85_decode_set_image_size_constraints(t85_decode_state_t *s,
+                                                        uint32_t max_xd,
+                                                        uint32_t max_yd)
+{
+    s->max_xd = max_xd;
+    s->max_yd = max_yd;
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(uint32_t) t85_decode_get_image_width(t85_decode_state_t *s)
+{
+    return s->xd;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(uint32_t) t85_decode_get_image_length(t85_decode_state_t *s)
+{
+    return s->y;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) t85_decode_get_compressed_image_size(t85_decode_state_t *s)
+{
+    return s->compressed_image_size;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) t85_decode_restart(t85_decode_state_t *s)
+{
+    s->state = T85_STATE_BIH;
+    s->xd = 0;
+    s->yd = 0;
+    s->y = 0;
+    s->i = 0;
+    s->x = 0;
+    s->tx = 0;
+    s->at_moves = 0;
+    s->comment_len = 0;
+    s->failure = T4_DECODE_MORE_DATA;
+    s->prev_ltp = false;
+    s->marker_check = false;
+    s->buffer_fill = 0;
+    s->compressed_image_size = 0;
+    t81_t82_arith_decode_restart(&s->s, false);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(logging_state_t *) t85_decode_get_logging_state(t85_decode_state_t *s)
+{
+    return &s->logging;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(t85_decode_state_t *) t85_decode_init(t85_decode_state_t *s,
+                                                   t4_row_write_handler_t handler,
+                                                   void *user_data)
+{
+    if (s == NULL)
+    {
+        if ((s = (t85_decode_state_t *) span_alloc(sizeof(*s))) == NULL)
+            return NULL;
+        /*endif*/
+    }
+    /*endif*/
+    memset(s, 0, sizeof(*s));
+    span_log_init(&s->logging, SPAN_LOG_NONE, NULL);
+    span_log_set_protocol(&s->logging, "T.85");
+
+    s->row_write_handler = handler;
+    s->row_write_user_data = user_data;
+
+    t81_t82_arith_decode_init(&s->s);
+    t85_decode_restart(s);
+    return s;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) t85_decode_release(t85_decode_state_t *s)
+{
+    if (s->row_buf)
+    {
+        span_free(s->row_buf);
+        s->row_buf = NULL;
+    }
+    /*endif*/
+    if (s->buffer)
+    {
+        span_free(s->buffer);
+        s->buffer = NULL;
+    }
+    /*endif*/
+    s->bytes_per_row = 0;
+    s->buffer_len = 0;
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) t85_decode_free(t85_decode_state_t *s)
+{
+    int ret;
+
+    ret = t85_decode_release(s);
+    span_free(s);
+    return ret;
+}
+/*- End of function --------------------------------------------------------*/
+/*- End of file ------------------------------------------------------------*/
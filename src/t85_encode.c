@@ -0,0 +1,577 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * t85_encode.c - ITU T.85 JBIG for FAX image compression
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2008, 2009 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License version 2.1,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \file */
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#if defined(HAVE_STDBOOL_H)
+#include <stdbool.h>
+#else
+#include "spandsp/stdbool.h"
+#endif
+
+#include "spandsp/telephony.h"
+#include "spandsp/alloc.h"
+#include "spandsp/logging.h"
+#include "spandsp/async.h"
+#include "spandsp/timezone.h"
+#include "spandsp/t4_rx.h"
+#include "spandsp/t4_tx.h"
+#include "spandsp/t81_t82_arith_coding.h"
+#include "spandsp/t85.h"
+
+#include "spandsp/private/logging.h"
+#include "spandsp/private/t81_t82_arith_coding.h"
+#include "spandsp/private/t85.h"
+
+/* Image length used in the BIH when the real length is not known in advance.
+   The real length is sent in a NEWLEN marker segment at the end of the image. */
+#define T85_YD_UNKNOWN              0xFFFFFFFF
+
+/* The contexts used to code the TPB pseudo pixels, for the 2 and 3 line templates */
+#define TPB2CX                      0x195
+#define TPB3CX                      0x0E5
+
+static void output_byte(void *user_data, int byte)
+{
+    t85_encode_state_t *s;
+    uint8_t *buf;
+    int len;
+
+    s = (t85_encode_state_t *) user_data;
+    if (s->bitstream_iptr >= s->bitstream_len)
+    {
+        if (s->bitstream_optr > 0)
+        {
+            /* Reclaim the space of the data which has already been collected */
+            memmove(s->bitstream, s->bitstream + s->bitstream_optr, s->bitstream_iptr - s->bitstream_optr);
+            s->bitstream_iptr -= s->bitstream_optr;
+            s->bitstream_optr = 0;
+        }
+        /*endif*/
+        if (s->bitstream_iptr >= s->bitstream_len)
+        {
+            len = s->bitstream_len + s->bytes_per_row + 256;
+            if ((buf = (uint8_t *) span_realloc(s->bitstream, len)) == NULL)
+            {
+                span_log(&s->logging, SPAN_LOG_WARNING, "Out of memory for the compressed image\n");
+                return;
+            }
+            /*endif*/
+            s->bitstream = buf;
+            s->bitstream_len = len;
+        }
+        /*endif*/
+    }
+    /*endif*/
+    s->bitstream[s->bitstream_iptr++] = (uint8_t) byte;
+    s->compressed_image_size++;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void output_esc_code(t85_encode_state_t *s, int code)
+{
+    output_byte(s, T81_T82_ARITH_MARKER_ESC);
+    output_byte(s, code);
+}
+/*- End of function --------------------------------------------------------*/
+
+static void output_32(t85_encode_state_t *s, uint32_t value)
+{
+    output_byte(s, (value >> 24) & 0xFF);
+    output_byte(s, (value >> 16) & 0xFF);
+    output_byte(s, (value >> 8) & 0xFF);
+    output_byte(s, value & 0xFF);
+}
+/*- End of function --------------------------------------------------------*/
+
+static void output_bih(t85_encode_state_t *s)
+{
+    if (s->yd == T85_YD_UNKNOWN)
+        s->options |= T85_VLENGTH;
+    /*endif*/
+    /* DL, D and P - the lowest resolution layer, with no differential layers,
+       and one bit plane */
+    output_byte(s, 0);
+    output_byte(s, 0);
+    output_byte(s, 1);
+    /* Fill */
+    output_byte(s, 0);
+    output_32(s, s->xd);
+    output_32(s, s->yd);
+    output_32(s, s->l0);
+    output_byte(s, s->mx);
+    /* MY */
+    output_byte(s, 0);
+    /* Order */
+    output_byte(s, 0);
+    output_byte(s, s->options);
+    s->bih_sent = true;
+    span_log(&s->logging,
+             SPAN_LOG_FLOW,
+             "BIH: XD %" PRIu32 ", YD %" PRIu32 ", L0 %" PRIu32 ", MX %d, options 0x%02X\n",
+             s->xd,
+             s->yd,
+             s->l0,
+             s->mx,
+             s->options);
+}
+/*- End of function --------------------------------------------------------*/
+
+static void end_image(t85_encode_state_t *s)
+{
+    if (!s->bih_sent)
+    {
+        if (s->yd == T85_YD_UNKNOWN)
+            s->yd = s->y;
+        /*endif*/
+        output_bih(s);
+    }
+    /*endif*/
+    if (s->i > 0)
+    {
+        /* Terminate the final, short, stripe */
+        t81_t82_arith_encode_flush(&s->s);
+        output_esc_code(s, T82_SDNORM);
+        s->i = 0;
+    }
+    /*endif*/
+    if (s->y != s->yd)
+    {
+        /* Tell the decoder the real length of the image */
+        if (!(s->options & T85_VLENGTH))
+            span_log(&s->logging, SPAN_LOG_WARNING, "Image length changed without VLENGTH set\n");
+        /*endif*/
+        output_esc_code(s, T82_NEWLEN);
+        output_32(s, s->y);
+        s->yd = s->y;
+    }
+    /*endif*/
+    s->completed = true;
+    span_log(&s->logging, SPAN_LOG_FLOW, "Image complete - %" PRIu32 " rows, %d bytes\n", s->y, s->compressed_image_size);
+}
+/*- End of function --------------------------------------------------------*/
+
+static void encode_pixels(t85_encode_state_t *s)
+{
+    const uint8_t *hp1;
+    const uint8_t *hp2;
+    const uint8_t *hp3;
+    uint32_t line_h1;
+    uint32_t line_h2;
+    uint32_t line_h3;
+    uint32_t x;
+    int byte;
+    int bits;
+    int pix;
+    int j;
+    int last;
+
+    hp1 = s->row_h1;
+    hp2 = s->row_h2;
+    hp3 = s->row_h3;
+    last = s->bytes_per_row - 1;
+    /* The context registers are aligned so that, when coding pixel x, pixel x + d of
+       the rows above is at bit 15 - d, and pixel x - d of the current row is at bit
+       d - 1. Each register is shifted left one place per pixel, and the next byte of
+       each row above is loaded at each byte boundary. */
+    line_h1 = 0;
+    line_h2 = (uint32_t) hp2[0] << 8;
+    line_h3 = (uint32_t) hp3[0] << 8;
+    x = 0;
+    for (j = 0;  j <= last;  j++)
+    {
+        if (j < last)
+        {
+            line_h2 |= hp2[j + 1];
+            line_h3 |= hp3[j + 1];
+        }
+        /*endif*/
+        byte = hp1[j];
+        bits = (s->xd - x < 8)  ?  (int) (s->xd - x)  :  8;
+        x += bits;
+        if ((s->options & T85_LRLTWO))
+        {
+            for (  ;  bits > 0;  bits--)
+            {
+                pix = (byte >> 7) & 1;
+                byte <<= 1;
+                t81_t82_arith_encode(&s->s, ((line_h2 >> 9) & 0x3F0) | (line_h1 & 0x00F), pix);
+                line_h1 = (line_h1 << 1) | pix;
+                line_h2 <<= 1;
+            }
+            /*endfor*/
+        }
+        else
+        {
+            for (  ;  bits > 0;  bits--)
+            {
+                pix = (byte >> 7) & 1;
+                byte <<= 1;
+                t81_t82_arith_encode(&s->s,
+                                     ((line_h3 >> 7) & 0x380)
+                                   | ((line_h2 >> 11) & 0x07C)
+                                   | (line_h1 & 0x003),
+                                     pix);
+                line_h1 = (line_h1 << 1) | pix;
+                line_h2 <<= 1;
+                line_h3 <<= 1;
+            }
+            /*endfor*/
+        }
+        /*endif*/
+    }
+    /*endfor*/
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) t85_encode_put_row(t85_encode_state_t *s, const uint8_t row[])
+{
+    uint8_t *t;
+    int ltp;
+
+    if (s->completed)
+        return -1;
+    /*endif*/
+    if (!s->bih_sent)
+        output_bih(s);
+    /*endif*/
+    if (row != s->row_h1)
+        memcpy(s->row_h1, row, s->bytes_per_row);
+    /*endif*/
+    /* Pixels beyond the edge of the image must be seen as white */
+    if ((s->xd & 7))
+        s->row_h1[s->bytes_per_row - 1] &= 0xFF << (8 - (s->xd & 7));
+    /*endif*/
+    if (s->i == 0)
+    {
+        /* Start a new stripe. The probabilities carry over from the previous stripe. */
+        t81_t82_arith_encode_restart(&s->s, s->y > 0);
+    }
+    /*endif*/
+    ltp = false;
+    if ((s->options & T85_TPBON))
+    {
+        /* Typical prediction - a row which is the same as the one above is flagged
+           with a single pseudo pixel, instead of being coded. */
+        ltp = (memcmp(s->row_h1, s->row_h2, s->bytes_per_row) == 0);
+        t81_t82_arith_encode(&s->s, (s->options & T85_LRLTWO)  ?  TPB2CX  :  TPB3CX, ltp == s->prev_ltp);
+        s->prev_ltp = ltp;
+    }
+    /*endif*/
+    if (!ltp)
+        encode_pixels(s);
+    /*endif*/
+
+    /* Rotate the rows */
+    t = s->row_h3;
+    s->row_h3 = s->row_h2;
+    s->row_h2 = s->row_h1;
+    s->row_h1 = t;
+
+    s->y++;
+    if (++s->i >= s->l0  ||  s->y >= s->yd_new)
+    {
+        t81_t82_arith_encode_flush(&s->s);
+        output_esc_code(s, T82_SDNORM);
+        s->i = 0;
+    }
+    /*endif*/
+    if (s->y >= s->yd_new)
+        end_image(s);
+    /*endif*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) t85_encode_image_complete(t85_encode_state_t *s)
+{
+    if (!s->completed)
+        end_image(s);
+    /*endif*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(void) t85_encode_abort(t85_encode_state_t *s)
+{
+    if (s->completed)
+        return;
+    /*endif*/
+    if (!s->bih_sent)
+        output_bih(s);
+    /*endif*/
+    output_esc_code(s, T82_ABORT);
+    s->completed = true;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) t85_encode_get(t85_encode_state_t *s, uint8_t buf[], size_t max_len)
+{
+    int len;
+    int n;
+
+    /* Only pull as many rows as we need to fill the caller's buffer, so the amount
+       of compressed data held here is never much more than one row's worth. */
+    while (s->bitstream_iptr - s->bitstream_optr < (int) max_len
+           &&
+           !s->completed
+           &&
+           s->row_read_handler)
+    {
+        len = s->row_read_handler(s->row_read_user_data, s->row_h1, s->bytes_per_row);
+        if (len < 0)
+        {
+            span_log(&s->logging, SPAN_LOG_WARNING, "Read error at row %" PRIu32 "\n", s->y);
+            t85_encode_abort(s);
+            break;
+        }
+        /*endif*/
+        if (len == 0)
+        {
+            end_image(s);
+            break;
+        }
+        /*endif*/
+        t85_encode_put_row(s, s->row_h1);
+    }
+    /*endwhile*/
+    n = s->bitstream_iptr - s->bitstream_optr;
+    if (n > (int) max_len)
+        n = (int) max_len;
+    /*endif*/
+    memcpy(buf, s->bitstream + s->bitstream_optr, n);
+    s->bitstream_optr += n;
+    if (s->bitstream_optr >= s->bitstream_iptr)
+    {
+        s->bitstream_optr = 0;
+        s->bitstream_iptr = 0;
+    }
+    /*endif*/
+    return n;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) t85_encode_image_finished(t85_encode_state_t *s)
+{
+    return (s->completed  &&  s->bitstream_iptr == s->bitstream_optr);
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(void) t85_encode_set_options(t85_encode_state_t *s, uint32_t l0, int mx, int options)
+{
+    s->l0 = (l0 > 0)  ?  l0  :  T85_DEFAULT_L0;
+    if (mx >= 0  &&  mx <= 127)
+        s->mx = mx;
+    /*endif*/
+    if (options >= 0)
+        s->options = options & (T85_LRLTWO | T85_TPBON | T85_VLENGTH);
+    /*endif*/
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) t85_encode_set_image_width(t85_encode_state_t *s, uint32_t image_width)
+{
+    int bytes_per_row;
+    uint8_t *t;
+
+    if (s->bih_sent)
+        return -1;
+    /*endif*/
+    if (image_width == 0)
+        return -1;
+    /*endif*/
+    s->xd = image_width;
+    bytes_per_row = (image_width + 7)/8;
+    if (bytes_per_row != s->bytes_per_row  ||  s->row_buf == NULL)
+    {
+        if ((t = (uint8_t *) span_realloc(s->row_buf, 3*bytes_per_row)) == NULL)
+            return -1;
+        /*endif*/
+        s->row_buf = t;
+        s->bytes_per_row = bytes_per_row;
+    }
+    /*endif*/
+    /* The rows above the first row are white */
+    memset(s->row_buf, 0, 3*bytes_per_row);
+    s->row_h1 = s->row_buf;
+    s->row_h2 = s->row_buf + bytes_per_row;
+    s->row_h3 = s->row_buf + 2*bytes_per_row;
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) t85_encode_set_image_length(t85_encode_state_t *s, uint32_t image_length)
+{
+    if (image_length == 0)
+        image_length = T85_YD_UNKNOWN;
+    /*endif*/
+    if (!s->bih_sent)
+    {
+        s->yd =
+        s->yd_new = image_length;
+        return 0;
+    }
+    /*endif*/
+    /* Once the header has gone, we can only shorten the image */
+    if (s->completed  ||  image_length > s->yd  ||  image_length < s->y)
+        return -1;
+    /*endif*/
+    s->yd_new = image_length;
+    if (s->y >= s->yd_new)
+        end_image(s);
+    /*endif*/
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(uint32_t) t85_encode_get_image_width(t85_encode_state_t *s)
+{
+    return s->xd;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(uint32_t) t85_encode_get_image_length(t85_encode_state_t *s)
+{
+    return s->y;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) t85_encode_get_compressed_image_size(t85_encode_state_t *s)
+{
+    return s->compressed_image_size;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) t85_encode_set_row_read_handler(t85_encode_state_t *s,
+                                                  t4_row_read_handler_t handler,
+                                                  void *user_data)
+{
+    s->row_read_handler = handler;
+    s->row_read_user_data = user_data;
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) t85_encode_restart(t85_encode_state_t *s, uint32_t image_width, uint32_t image_length)
+{
+    s->bih_sent = false;
+    s->completed = false;
+    s->y = 0;
+    s->i = 0;
+    s->prev_ltp = false;
+    s->bitstream_iptr = 0;
+    s->bitstream_optr = 0;
+    s->compressed_image_size = 0;
+    if (t85_encode_set_image_width(s, image_width))
+        return -1;
+    /*endif*/
+    t85_encode_set_image_length(s, image_length);
+    t81_t82_arith_encode_restart(&s->s, false);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(logging_state_t *) t85_encode_get_logging_state(t85_encode_state_t *s)
+{
+    return &s->logging;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(t85_encode_state_t *) t85_encode_init(t85_encode_state_t *s,
+                                                   uint32_t image_width,
+                                                   uint32_t image_length,
+                                                   t4_row_read_handler_t handler,
+                                                   void *user_data)
+{
+    if (s == NULL)
+    {
+        if ((s = (t85_encode_state_t *) span_alloc(sizeof(*s))) == NULL)
+            return NULL;
+        /*endif*/
+    }
+    /*endif*/
+    memset(s, 0, sizeof(*s));
+    span_log_init(&s->logging, SPAN_LOG_NONE, NULL);
+    span_log_set_protocol(&s->logging, "T.85");
+
+    s->row_read_handler = handler;
+    s->row_read_user_data = user_data;
+
+    /* The three line template, with typical prediction, gives the best compression
+       for the kind of images FAX deals with. */
+    s->l0 = T85_DEFAULT_L0;
+    s->mx = 0;
+    s->options = T85_TPBON;
+
+    t81_t82_arith_encode_init(&s->s, output_byte, s);
+    if (t85_encode_restart(s, image_width, image_length))
+    {
+        t85_encode_release(s);
+        return NULL;
+    }
+    /*endif*/
+    return s;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) t85_encode_release(t85_encode_state_t *s)
+{
+    if (s->row_buf)
+    {
+        span_free(s->row_buf);
+        s->row_buf = NULL;
+    }
+    /*endif*/
+    if (s->bitstream)
+    {
+        span_free(s->bitstream);
+        s->bitstream = NULL;
+    }
+    /*endif*/
+    s->bytes_per_row = 0;
+    s->bitstream_len = 0;
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) t85_encode_free(t85_encode_state_t *s)
+{
+    int ret;
+
+    ret = t85_encode_release(s);
+    span_free(s);
+    return ret;
+}
+/*- End of function --------------------------------------------------------*/
+/*- End of file ------------------------------------------------------------*/
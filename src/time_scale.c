@@ -284,6 +284,20 @@ SPAN_DECLARE(int) time_scale(time_scale_state_t *s, int16_t out[], int16_t in[],
 }
 /*- End of function --------------------------------------------------------*/
 
+SPAN_DECLARE(int) time_scale_flush(time_scale_state_t *s, int16_t out[])
+{
+    int out_len;
+
+    /* The buffer holds the samples not yet output, whatever the state of the overlap
+       and add process, so they can just be copied out. */
+    out_len = s->fill;
+    vec_copyi16(out, s->buf, out_len);
+    s->fill = 0;
+    s->lcp = 0;
+    return out_len;
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE(int) time_scale_max_output_len(time_scale_state_t *s, int input_len)
 {
     return (int) (input_len*s->playout_rate + s->min_pitch + 1);
@@ -69,7 +69,7 @@ SPAN_DECLARE(void) make_goertzel_descriptor(goertzel_descriptor_t *t, float freq
 /*- End of function --------------------------------------------------------*/
 
 SPAN_DECLARE(goertzel_state_t *) goertzel_init(goertzel_state_t *s,
-                                               goertzel_descriptor_t *t)
+                                               const goertzel_descriptor_t *t)
 {
     if (s == NULL)
     {
@@ -86,6 +86,7 @@
 #define FP_SCALE(x)                     (x)
 #include "v17_v32bis_rx_floating_rrc.h"
 #endif
+#include "fir_kernels.h"
 
 #include "v17_v32bis_tx_constellation_maps.h"
 #include "v17_v32bis_rx_constellation_maps.h"
@@ -220,6 +221,102 @@ SPAN_DECLARE(int) v17_rx_equalizer_state(v17_rx_state_t *s, complexf_t **coeffs)
 }
 /*- End of function --------------------------------------------------------*/
 
+#if V17_RX_TRAINING_STATE_LEN != V17_EQUALIZER_LEN*8 + 16
+#error V17_RX_TRAINING_STATE_LEN does not match the equalizer length
+#endif
+
+static int put_int32(uint8_t buf[], int pos, int32_t value)
+{
+    buf[pos++] = (uint8_t) (value >> 24);
+    buf[pos++] = (uint8_t) (value >> 16);
+    buf[pos++] = (uint8_t) (value >> 8);
+    buf[pos++] = (uint8_t) value;
+    return pos;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int32_t get_int32(const uint8_t buf[], int pos)
+{
+    return (int32_t) (((uint32_t) buf[pos] << 24) | ((uint32_t) buf[pos + 1] << 16) | ((uint32_t) buf[pos + 2] << 8) | buf[pos + 3]);
+}
+/*- End of function --------------------------------------------------------*/
+
+static int32_t float_bits(float x)
+{
+    int32_t i;
+
+    memcpy(&i, &x, sizeof(i));
+    return i;
+}
+/*- End of function --------------------------------------------------------*/
+
+static float bits_float(int32_t i)
+{
+    float x;
+
+    memcpy(&x, &i, sizeof(x));
+    return x;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) v17_rx_get_training_state(v17_rx_state_t *s, uint8_t buf[], int max_len)
+{
+    int pos;
+    int i;
+
+    /* The saved training is the equalizer, carrier frequency and gain which a short training
+       sequence starts from. Floats are stored as their IEEE 754 bit patterns. */
+    if (max_len < V17_RX_TRAINING_STATE_LEN)
+        return -1;
+    /*endif*/
+    pos = 0;
+    for (i = 0;  i < V17_EQUALIZER_LEN;  i++)
+    {
+#if defined(SPANDSP_USE_FIXED_POINTx)
+        pos = put_int32(buf, pos, s->eq_coeff_save[i].re);
+        pos = put_int32(buf, pos, s->eq_coeff_save[i].im);
+#else
+        pos = put_int32(buf, pos, float_bits(s->eq_coeff_save[i].re));
+        pos = put_int32(buf, pos, float_bits(s->eq_coeff_save[i].im));
+#endif
+    }
+    /*endfor*/
+    pos = put_int32(buf, pos, s->carrier_phase_rate_save);
+    pos = put_int32(buf, pos, float_bits(s->agc_scaling_save));
+    pos = put_int32(buf, pos, (int32_t) (s->window_power_save >> 32));
+    pos = put_int32(buf, pos, (int32_t) s->window_power_save);
+    return pos;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE(int) v17_rx_set_training_state(v17_rx_state_t *s, const uint8_t buf[], int len)
+{
+    int pos;
+    int i;
+
+    if (len != V17_RX_TRAINING_STATE_LEN)
+        return -1;
+    /*endif*/
+    pos = 0;
+    for (i = 0;  i < V17_EQUALIZER_LEN;  i++)
+    {
+#if defined(SPANDSP_USE_FIXED_POINTx)
+        s->eq_coeff_save[i].re = (int16_t) get_int32(buf, pos);
+        s->eq_coeff_save[i].im = (int16_t) get_int32(buf, pos + 4);
+#else
+        s->eq_coeff_save[i].re = bits_float(get_int32(buf, pos));
+        s->eq_coeff_save[i].im = bits_float(get_int32(buf, pos + 4));
+#endif
+        pos += 8;
+    }
+    /*endfor*/
+    s->carrier_phase_rate_save = get_int32(buf, pos);
+    s->agc_scaling_save = bits_float(get_int32(buf, pos + 4));
+    s->window_power_save = ((int64_t) get_int32(buf, pos + 8) << 32) | (uint32_t) get_int32(buf, pos + 12);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
 static void equalizer_save(v17_rx_state_t *s)
 {
 #if defined(SPANDSP_USE_FIXED_POINTx)
@@ -1251,6 +1348,7 @@ SPAN_DECLARE_NONSTD(int) v17_rx(v17_rx_state_t *s, const int16_t amp[], int len)
 #endif
 
         s->rrc_filter[s->rrc_filter_step] = amp[i];
+        s->rrc_filter[s->rrc_filter_step + V17_RX_FILTER_STEPS] = amp[i];
         if (++s->rrc_filter_step >= V17_RX_FILTER_STEPS)
             s->rrc_filter_step = 0;
 
@@ -1269,7 +1367,7 @@ SPAN_DECLARE_NONSTD(int) v17_rx(v17_rx_state_t *s, const int16_t amp[], int len)
         else if (step > RX_PULSESHAPER_COEFF_SETS - 1)
             step = RX_PULSESHAPER_COEFF_SETS - 1;
 #if defined(SPANDSP_USE_FIXED_POINT)
-        vi = vec_circular_dot_prodi16(s->rrc_filter, rx_pulseshaper_re[step], V17_RX_FILTER_STEPS, s->rrc_filter_step);
+        vi = FIR_KERNEL_DOT_PRODI16(V17_RX_FILTER_STEPS)(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_re[step]);
         //sample.re = (vi*(int32_t) s->agc_scaling) >> 15;
         sample.re = vi*s->agc_scaling;
         /* Symbol timing synchronisation band edge filters */
@@ -1282,7 +1380,7 @@ SPAN_DECLARE_NONSTD(int) v17_rx(v17_rx_state_t *s, const int16_t amp[], int len)
         s->symbol_sync_high[1] = s->symbol_sync_high[0];
         s->symbol_sync_high[0] = v;
 #else
-        v = vec_circular_dot_prodf(s->rrc_filter, rx_pulseshaper_re[step], V17_RX_FILTER_STEPS, s->rrc_filter_step);
+        v = FIR_KERNEL_DOT_PRODF(V17_RX_FILTER_STEPS)(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_re[step]);
         sample.re = v*s->agc_scaling;
         /* Symbol timing synchronisation band edge filters */
         /* Low Nyquist band edge filter */
@@ -1310,14 +1408,14 @@ SPAN_DECLARE_NONSTD(int) v17_rx(v17_rx_state_t *s, const int16_t amp[], int len)
             if (step > RX_PULSESHAPER_COEFF_SETS - 1)
                 step = RX_PULSESHAPER_COEFF_SETS - 1;
 #if defined(SPANDSP_USE_FIXED_POINT)
-            vi = vec_circular_dot_prodi16(s->rrc_filter, rx_pulseshaper_im[step], V17_RX_FILTER_STEPS, s->rrc_filter_step);
+            vi = FIR_KERNEL_DOT_PRODI16(V17_RX_FILTER_STEPS)(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_im[step]);
             //sample.im = (vi*(int32_t) s->agc_scaling) >> 15;
             sample.im = vi*s->agc_scaling;
             z = dds_lookup_complexf(s->carrier_phase);
             zz.re = sample.re*z.re - sample.im*z.im;
             zz.im = -sample.re*z.im - sample.im*z.re;
 #else
-            v = vec_circular_dot_prodf(s->rrc_filter, rx_pulseshaper_im[step], V17_RX_FILTER_STEPS, s->rrc_filter_step);
+            v = FIR_KERNEL_DOT_PRODF(V17_RX_FILTER_STEPS)(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_im[step]);
             sample.im = v*s->agc_scaling;
             z = dds_lookup_complexf(s->carrier_phase);
             zz.re = sample.re*z.re - sample.im*z.im;
@@ -290,16 +290,55 @@ static __inline__ complexf_t getbaud(v17_tx_state_t *s)
 }
 /*- End of function --------------------------------------------------------*/
 
+#if !defined(SPANDSP_USE_FIXED_POINT)
+static void make_tx_pulses(v17_tx_state_t *s)
+{
+    complexf_t z;
+    float coeff;
+    int start;
+    int phase;
+    int step;
+    int i;
+
+    /* A symbol enters the pulse shaper when the baud phase wraps, and passes along
+       it one step per baud. Follow that path, sample by sample, from each possible
+       starting baud phase, and fold in the carrier's progress since the symbol's
+       first sample. The transmitted signal is then just the sum of these pulses,
+       each scaled by its symbol rotated to the carrier phase of its first sample. */
+    for (start = 0;  start < 3;  start++)
+    {
+        phase = start;
+        step = V17_TX_FILTER_STEPS - 1;
+        for (i = 0;  i < V17_TX_PULSE_LEN;  i++)
+        {
+            coeff = (step >= 0)  ?  tx_pulseshaper[TX_PULSESHAPER_COEFF_SETS - 1 - phase][step]  :  0.0f;
+            z = dds_lookup_complexf((uint32_t) i*(uint32_t) s->carrier_phase_rate);
+            s->pulse_re[start][i] = coeff*z.re;
+            s->pulse_im[start][i] = -coeff*z.im;
+            if ((phase += 3) >= 10)
+            {
+                phase -= 10;
+                step--;
+            }
+        }
+    }
+}
+/*- End of function --------------------------------------------------------*/
+#endif
+
 SPAN_DECLARE_NONSTD(int) v17_tx(v17_tx_state_t *s, int16_t amp[], int len)
 {
 #if defined(SPANDSP_USE_FIXED_POINT)
     complexi_t x;
     complexi_t z;
+    int i;
 #else
-    complexf_t x;
+    complexf_t v;
     complexf_t z;
+    uint32_t phase;
+    int chunk;
+    int k;
 #endif
-    int i;
     int sample;
 
     if (s->training_step >= V17_TRAINING_SHUTDOWN_END)
@@ -307,6 +346,7 @@ SPAN_DECLARE_NONSTD(int) v17_tx(v17_tx_state_t *s, int16_t amp[], int len)
         /* Once we have sent the shutdown sequence, we stop sending completely. */
         return 0;
     }
+#if defined(SPANDSP_USE_FIXED_POINT)
     for (sample = 0;  sample < len;  sample++)
     {
         if ((s->baud_phase += 3) >= 10)
@@ -318,7 +358,6 @@ SPAN_DECLARE_NONSTD(int) v17_tx(v17_tx_state_t *s, int16_t amp[], int len)
                 s->rrc_filter_step = 0;
         }
         /* Root raised cosine pulse shaping at baseband */
-#if defined(SPANDSP_USE_FIXED_POINT)
         x = complex_seti(0, 0);
         for (i = 0;  i < V17_TX_FILTER_STEPS;  i++)
         {
@@ -332,19 +371,35 @@ SPAN_DECLARE_NONSTD(int) v17_tx(v17_tx_state_t *s, int16_t amp[], int len)
         /* Don't bother saturating. We should never clip. */
         i = (x.re*z.re - x.im*z.im) >> 15;
         amp[sample] = (int16_t) ((i*s->gain) >> 15);
+    }
 #else
-        x = complex_setf(0.0f, 0.0f);
-        for (i = 0;  i < V17_TX_FILTER_STEPS;  i++)
+    /* Rather than filtering and modulating every sample, add the precomputed modulated
+       pulse of each symbol into a block of output, as the symbol arrives. */
+    for (sample = 0;  sample < len;  sample += chunk)
+    {
+        chunk = (len - sample < V17_TX_BLOCK_LEN)  ?  (len - sample)  :  V17_TX_BLOCK_LEN;
+        phase = s->carrier_phase;
+        for (k = 0;  k < chunk;  k++)
         {
-            x.re += tx_pulseshaper[TX_PULSESHAPER_COEFF_SETS - 1 - s->baud_phase][i]*s->rrc_filter[i + s->rrc_filter_step].re;
-            x.im += tx_pulseshaper[TX_PULSESHAPER_COEFF_SETS - 1 - s->baud_phase][i]*s->rrc_filter[i + s->rrc_filter_step].im;
+            if ((s->baud_phase += 3) >= 10)
+            {
+                s->baud_phase -= 10;
+                v = getbaud(s);
+                z = dds_lookup_complexf(phase);
+                z = complex_mulf(&v, &z);
+                vec_scaledy_addf(&s->synth[k], &s->synth[k], s->pulse_re[s->baud_phase], z.re, V17_TX_PULSE_LEN);
+                vec_scaledy_addf(&s->synth[k], &s->synth[k], s->pulse_im[s->baud_phase], z.im, V17_TX_PULSE_LEN);
+            }
+            phase += s->carrier_phase_rate;
         }
-        /* Now create and modulate the carrier */
-        z = dds_complexf(&s->carrier_phase, s->carrier_phase_rate);
+        s->carrier_phase = phase;
         /* Don't bother saturating. We should never clip. */
-        amp[sample] = (int16_t) lfastrintf((x.re*z.re - x.im*z.im)*s->gain);
-#endif
+        for (k = 0;  k < chunk;  k++)
+            amp[sample + k] = (int16_t) lfastrintf(s->synth[k]*s->gain);
+        memmove(s->synth, &s->synth[chunk], V17_TX_PULSE_LEN*sizeof(s->synth[0]));
+        vec_zerof(&s->synth[V17_TX_PULSE_LEN], chunk);
     }
+#endif
     return sample;
 }
 /*- End of function --------------------------------------------------------*/
@@ -418,7 +473,8 @@ SPAN_DECLARE(int) v17_tx_restart(v17_tx_state_t *s, int bit_rate, int tep, int s
 #if defined(SPANDSP_USE_FIXED_POINT)
     cvec_zeroi16(s->rrc_filter, sizeof(s->rrc_filter)/sizeof(s->rrc_filter[0]));
 #else
-    cvec_zerof(s->rrc_filter, sizeof(s->rrc_filter)/sizeof(s->rrc_filter[0]));
+    make_tx_pulses(s);
+    vec_zerof(s->synth, sizeof(s->synth)/sizeof(s->synth[0]));
 #endif
     s->rrc_filter_step = 0;
     s->convolution = 0;
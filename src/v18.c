@@ -380,6 +380,48 @@ static const uint8_t txp[] = "1111111111000101011100001101110000010101";
     100 ms mark. */
 static const uint8_t xci[] = "01111111110111111111";
 
+/* The automoding probe works in blocks of 20ms, giving Goertzel bins 50Hz wide */
+#define V18_PROBE_SAMPLES_PER_BLOCK     160
+/* The number of FSK channels the probe looks for */
+#define V18_PROBE_FSK_CHANNELS          4
+#if defined(SPANDSP_USE_FIXED_POINT)
+#define V18_PROBE_THRESHOLD             256             /* About -40dBm0 [V18_PROBE_SAMPLES_PER_BLOCK*((32768.0/128.0)*10^((-40 - DBM0_MAX_SINE_POWER)/20.0))^2/2.0] */
+#else
+#define V18_PROBE_THRESHOLD             4173620.0f      /* -40dBm0 [V18_PROBE_SAMPLES_PER_BLOCK*(32768.0*10^((-40 - DBM0_MAX_SINE_POWER)/20.0))^2/2.0] */
+#endif
+#define V18_PROBE_FSK_TO_TOTAL_ENERGY   100.95f         /* -2dB [V18_PROBE_SAMPLES_PER_BLOCK*10^(-2.0/10.0)] */
+#define V18_PROBE_FSK_RELATIVE_PEAK     3.981f          /* 6dB [10.0^(6.0/10.0)] */
+#define V18_PROBE_DTMF_TO_TOTAL_ENERGY  127.09f         /* -1dB [V18_PROBE_SAMPLES_PER_BLOCK*10^(-1.0/10.0)] */
+#define V18_PROBE_DTMF_TWIST            6.309f          /* 8dB [10.0^(8.0/10.0)] */
+#define V18_PROBE_V23_GUARD             1.995f          /* 3dB [10.0^(3.0/10.0)] */
+/* The number of consecutive blocks in which a signature must be seen. A DTMF digit may
+   be as short as 40ms, so it may only fill one block. */
+#define V18_PROBE_FSK_PERSISTENCE       3
+#define V18_PROBE_DTMF_PERSISTENCE      1
+
+/* The FSK receive channels of the modes, as set up in v18_set_mode(), in the order of the
+   mark and space pairs in the probe's Goertzel bank. */
+static const int probe_fsk_channels[V18_PROBE_FSK_CHANNELS] =
+{
+    FSK_WEITBRECHT,
+    FSK_V21CH1,
+    FSK_BELL103CH2,
+    FSK_V23CH2
+};
+
+static const float probe_dtmf_freqs[8] =
+{
+    697.0f, 770.0f, 852.0f, 941.0f, 1209.0f, 1336.0f, 1477.0f, 1633.0f
+};
+
+/* Dial, ringing and busy tones are made from 350Hz, 425Hz, 440Hz and 480Hz, which fall
+   within a bin's width of the 390Hz and 450Hz V.23 backward channel tones. A V.23 tone
+   must stand clear of these guard frequencies. */
+static const float probe_guard_freqs[3] =
+{
+    350.0f, 425.0f, 480.0f
+};
+
 SPAN_DECLARE(const char *) v18_mode_to_str(int mode)
 {
     switch ((mode & 0xFF))
@@ -763,6 +805,270 @@ static void v18_textphone_put_async_byte(void *user_data, int byte)
 }
 /*- End of function --------------------------------------------------------*/
 
+static void v18_set_mode(v18_state_t *s, int mode)
+{
+    s->mode = mode;
+    switch (s->mode)
+    {
+    case V18_MODE_5BIT_45:
+        fsk_tx_init(&s->fsk_tx, &preset_fsk_specs[FSK_WEITBRECHT], async_tx_get_bit, &s->async_tx);
+        async_tx_init(&s->async_tx, 5, ASYNC_PARITY_NONE, 2, false, v18_tdd_get_async_byte, s);
+        /* Schedule an explicit shift at the start of baudot transmission */
+        s->baudot_tx_shift = 2;
+        /* TDD uses 5 bit data, no parity and 1.5 stop bits. We scan for the first stop bit, and
+           ride over the fraction. */
+        fsk_rx_init(&s->fsk_rx, &preset_fsk_specs[FSK_WEITBRECHT], FSK_FRAME_MODE_5N1_FRAMES, v18_tdd_put_async_byte, s);
+        s->baudot_rx_shift = 0;
+        //s->repeat_shifts = mode & 0x100;
+        break;
+    case V18_MODE_5BIT_50:
+        fsk_tx_init(&s->fsk_tx, &preset_fsk_specs[FSK_WEITBRECHT50], async_tx_get_bit, &s->async_tx);
+        async_tx_init(&s->async_tx, 5, ASYNC_PARITY_NONE, 2, false, v18_tdd_get_async_byte, s);
+        /* Schedule an explicit shift at the start of baudot transmission */
+        s->baudot_tx_shift = 2;
+        /* TDD uses 5 bit data, no parity and 1.5 stop bits. We scan for the first stop bit, and
+           ride over the fraction. */
+        fsk_rx_init(&s->fsk_rx, &preset_fsk_specs[FSK_WEITBRECHT50], FSK_FRAME_MODE_5N1_FRAMES, v18_tdd_put_async_byte, s);
+        s->baudot_rx_shift = 0;
+        //s->repeat_shifts = mode & 0x100;
+        break;
+    case V18_MODE_DTMF:
+        dtmf_tx_init(&s->dtmf_tx);
+        dtmf_rx_init(&s->dtmf_rx, v18_rx_dtmf, s);
+        break;
+    case V18_MODE_EDT:
+        fsk_tx_init(&s->fsk_tx, &preset_fsk_specs[FSK_V21CH1_110], async_tx_get_bit, &s->async_tx);
+        async_tx_init(&s->async_tx, 7, ASYNC_PARITY_EVEN, 2, false, v18_edt_get_async_byte, s);
+        fsk_rx_init(&s->fsk_rx, &preset_fsk_specs[FSK_V21CH1_110], FSK_FRAME_MODE_7E2_FRAMES, v18_edt_put_async_byte, s);
+        break;
+    case V18_MODE_BELL103:
+        fsk_tx_init(&s->fsk_tx, &preset_fsk_specs[FSK_BELL103CH1], async_tx_get_bit, &s->async_tx);
+        async_tx_init(&s->async_tx, 7, ASYNC_PARITY_EVEN, 1, false, v18_edt_get_async_byte, s);
+        fsk_rx_init(&s->fsk_rx, &preset_fsk_specs[FSK_BELL103CH2], FSK_FRAME_MODE_7E1_FRAMES, v18_bell103_put_async_byte, s);
+        break;
+    case V18_MODE_V23VIDEOTEX:
+        fsk_tx_init(&s->fsk_tx, &preset_fsk_specs[FSK_V23CH1], async_tx_get_bit, &s->async_tx);
+        async_tx_init(&s->async_tx, 7, ASYNC_PARITY_EVEN, 1, false, v18_edt_get_async_byte, s);
+        fsk_rx_init(&s->fsk_rx, &preset_fsk_specs[FSK_V23CH2], FSK_FRAME_MODE_7E1_FRAMES, v18_videotex_put_async_byte, s);
+        break;
+    case V18_MODE_V21TEXTPHONE:
+        fsk_tx_init(&s->fsk_tx, &preset_fsk_specs[FSK_V21CH1], async_tx_get_bit, &s->async_tx);
+        async_tx_init(&s->async_tx, 7, ASYNC_PARITY_EVEN, 1, false, v18_edt_get_async_byte, s);
+        fsk_rx_init(&s->fsk_rx, &preset_fsk_specs[FSK_V21CH1], FSK_FRAME_MODE_7E1_FRAMES, v18_textphone_put_async_byte, s);
+        break;
+    case V18_MODE_V18TEXTPHONE:
+        fsk_tx_init(&s->fsk_tx, &preset_fsk_specs[FSK_V21CH1], async_tx_get_bit, &s->async_tx);
+        async_tx_init(&s->async_tx, 7, ASYNC_PARITY_EVEN, 1, false, v18_edt_get_async_byte, s);
+        fsk_rx_init(&s->fsk_rx, &preset_fsk_specs[FSK_V21CH1], FSK_FRAME_MODE_7E1_FRAMES, v18_textphone_put_async_byte, s);
+        break;
+    }
+}
+/*- End of function --------------------------------------------------------*/
+
+static void probe_init(v18_probe_state_t *s)
+{
+    goertzel_descriptor_t desc;
+    int i;
+
+    for (i = 0;  i < V18_PROBE_FSK_CHANNELS;  i++)
+    {
+        make_goertzel_descriptor(&desc, preset_fsk_specs[probe_fsk_channels[i]].freq_one, V18_PROBE_SAMPLES_PER_BLOCK);
+        goertzel_init(&s->bins[2*i], &desc);
+        make_goertzel_descriptor(&desc, preset_fsk_specs[probe_fsk_channels[i]].freq_zero, V18_PROBE_SAMPLES_PER_BLOCK);
+        goertzel_init(&s->bins[2*i + 1], &desc);
+    }
+    /*endfor*/
+    for (i = 0;  i < 8;  i++)
+    {
+        make_goertzel_descriptor(&desc, probe_dtmf_freqs[i], V18_PROBE_SAMPLES_PER_BLOCK);
+        goertzel_init(&s->bins[2*V18_PROBE_FSK_CHANNELS + i], &desc);
+    }
+    /*endfor*/
+    for (i = 0;  i < 3;  i++)
+    {
+        make_goertzel_descriptor(&desc, probe_guard_freqs[i], V18_PROBE_SAMPLES_PER_BLOCK);
+        goertzel_init(&s->bins[2*V18_PROBE_FSK_CHANNELS + 8 + i], &desc);
+    }
+    /*endfor*/
+    s->energy = 0;
+    s->current_sample = 0;
+    s->candidate = V18_MODE_NONE;
+    s->hits = 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int probe_block(v18_state_t *s)
+{
+#if defined(SPANDSP_USE_FIXED_POINT)
+    int32_t energy[V18_PROBE_BINS];
+#else
+    float energy[V18_PROBE_BINS];
+#endif
+    int next;
+    int guard;
+    int best_row;
+    int best_col;
+    int best;
+    int mode;
+    int i;
+
+    for (i = 0;  i < V18_PROBE_BINS;  i++)
+        energy[i] = goertzel_result(&s->probe.bins[i]);
+    /*endfor*/
+    mode = V18_MODE_NONE;
+    if (s->probe.energy >= V18_PROBE_THRESHOLD)
+    {
+        /* DTMF first, as a DTMF column tone can look like one of the FSK tones */
+        best_row = 2*V18_PROBE_FSK_CHANNELS;
+        best_col = 2*V18_PROBE_FSK_CHANNELS + 4;
+        for (i = 1;  i < 4;  i++)
+        {
+            if (energy[2*V18_PROBE_FSK_CHANNELS + i] > energy[best_row])
+                best_row = 2*V18_PROBE_FSK_CHANNELS + i;
+            /*endif*/
+            if (energy[2*V18_PROBE_FSK_CHANNELS + 4 + i] > energy[best_col])
+                best_col = 2*V18_PROBE_FSK_CHANNELS + 4 + i;
+            /*endif*/
+        }
+        /*endfor*/
+        if (energy[best_row] < energy[best_col]*V18_PROBE_DTMF_TWIST
+            &&
+            energy[best_col] < energy[best_row]*V18_PROBE_DTMF_TWIST
+            &&
+            (energy[best_row] + energy[best_col]) > V18_PROBE_DTMF_TO_TOTAL_ENERGY*s->probe.energy)
+        {
+            mode = V18_MODE_DTMF;
+        }
+        else
+        {
+            /* An FSK signature is the steady mark or space tone of a channel, so find the
+               strongest FSK tone, and check it holds most of the energy, and stands clear
+               of the tones of the other channels. When the line is modulated, particularly
+               at 300bps, a block's energy is spread over both tones, and over the tones of
+               the neighbouring channels, so it would not be a reliable signature. */
+            best = 0;
+            for (i = 1;  i < 2*V18_PROBE_FSK_CHANNELS;  i++)
+            {
+                if (energy[i] > energy[best])
+                    best = i;
+                /*endif*/
+            }
+            /*endfor*/
+            next = -1;
+            for (i = 0;  i < 2*V18_PROBE_FSK_CHANNELS;  i++)
+            {
+                if ((i >> 1) != (best >> 1)  &&  (next < 0  ||  energy[i] > energy[next]))
+                    next = i;
+                /*endif*/
+            }
+            /*endfor*/
+            if (energy[best] > V18_PROBE_FSK_TO_TOTAL_ENERGY*s->probe.energy
+                &&
+                energy[best] > energy[next]*V18_PROBE_FSK_RELATIVE_PEAK)
+            {
+                switch (probe_fsk_channels[best >> 1])
+                {
+                case FSK_WEITBRECHT:
+                    mode = (s->automoding & V18_AUTOMODING_BAUDOT_50)  ?  V18_MODE_5BIT_50  :  V18_MODE_5BIT_45;
+                    break;
+                case FSK_V21CH1:
+                    mode = (s->automoding & V18_AUTOMODING_EDT)  ?  V18_MODE_EDT  :  V18_MODE_V21TEXTPHONE;
+                    break;
+                case FSK_BELL103CH2:
+                    mode = V18_MODE_BELL103;
+                    break;
+                case FSK_V23CH2:
+                    guard = 2*V18_PROBE_FSK_CHANNELS + 8;
+                    for (i = 2*V18_PROBE_FSK_CHANNELS + 9;  i < V18_PROBE_BINS;  i++)
+                    {
+                        if (energy[i] > energy[guard])
+                            guard = i;
+                        /*endif*/
+                    }
+                    /*endfor*/
+                    if (energy[best] > energy[guard]*V18_PROBE_V23_GUARD)
+                        mode = V18_MODE_V23VIDEOTEX;
+                    /*endif*/
+                    break;
+                }
+                /*endswitch*/
+            }
+            /*endif*/
+        }
+        /*endif*/
+    }
+    /*endif*/
+    s->probe.energy = 0;
+    s->probe.current_sample = 0;
+    if (mode != s->probe.candidate)
+    {
+        s->probe.candidate = mode;
+        s->probe.hits = 0;
+    }
+    /*endif*/
+    if (mode == V18_MODE_NONE)
+        return V18_MODE_NONE;
+    /*endif*/
+    if (++s->probe.hits < ((mode == V18_MODE_DTMF)  ?  V18_PROBE_DTMF_PERSISTENCE  :  V18_PROBE_FSK_PERSISTENCE))
+        return V18_MODE_NONE;
+    /*endif*/
+    return mode;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int probe_rx(v18_state_t *s, const int16_t amp[], int len)
+{
+#if defined(SPANDSP_USE_FIXED_POINT)
+    int16_t xamp;
+#else
+    float xamp;
+#endif
+    int sample;
+    int limit;
+    int mode;
+    int i;
+    int j;
+
+    for (sample = 0;  sample < len;  sample = limit)
+    {
+        if ((len - sample) < (V18_PROBE_SAMPLES_PER_BLOCK - s->probe.current_sample))
+            limit = len;
+        else
+            limit = sample + (V18_PROBE_SAMPLES_PER_BLOCK - s->probe.current_sample);
+        /*endif*/
+        /* One pass over the audio updates every bin */
+        for (j = sample;  j < limit;  j++)
+        {
+            xamp = goertzel_preadjust_amp(amp[j]);
+#if defined(SPANDSP_USE_FIXED_POINT)
+            s->probe.energy += ((int32_t) xamp*xamp);
+#else
+            s->probe.energy += xamp*xamp;
+#endif
+            for (i = 0;  i < V18_PROBE_BINS;  i++)
+                goertzel_samplex(&s->probe.bins[i], xamp);
+            /*endfor*/
+        }
+        /*endfor*/
+        s->probe.current_sample += (limit - sample);
+        if (s->probe.current_sample < V18_PROBE_SAMPLES_PER_BLOCK)
+            continue;
+        /*endif*/
+        if ((mode = probe_block(s)) != V18_MODE_NONE)
+        {
+            span_log(&s->logging, SPAN_LOG_FLOW, "Automoding selected %s\n", v18_mode_to_str(mode));
+            s->automoding = 0;
+            v18_set_mode(s, mode);
+            /* Any remaining audio belongs to the new mode */
+            return limit;
+        }
+        /*endif*/
+    }
+    /*endfor*/
+    return len;
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE_NONSTD(int) v18_tx(v18_state_t *s, int16_t *amp, int max_len)
 {
     int len;
@@ -793,6 +1099,17 @@ SPAN_DECLARE_NONSTD(int) v18_tx(v18_state_t *s, int16_t *amp, int max_len)
 
 SPAN_DECLARE_NONSTD(int) v18_rx(v18_state_t *s, const int16_t amp[], int len)
 {
+    int i;
+
+    if (s->automoding)
+    {
+        if ((i = probe_rx(s, amp, len)) >= len)
+            return 0;
+        /*endif*/
+        amp += i;
+        len -= i;
+    }
+    /*endif*/
     switch (s->mode)
     {
     case V18_MODE_DTMF:
@@ -802,6 +1119,8 @@ SPAN_DECLARE_NONSTD(int) v18_rx(v18_state_t *s, const int16_t amp[], int len)
             s->rx_msg_len = 0;
         dtmf_rx(&s->dtmf_rx, amp, len);
         break;
+    case V18_MODE_NONE:
+        break;
     default:
         fsk_rx(&s->fsk_rx, amp, len);
         break;
@@ -857,6 +1176,12 @@ SPAN_DECLARE(logging_state_t *) v18_get_logging_state(v18_state_t *s)
 }
 /*- End of function --------------------------------------------------------*/
 
+SPAN_DECLARE(int) v18_get_current_mode(v18_state_t *s)
+{
+    return s->mode;
+}
+/*- End of function --------------------------------------------------------*/
+
 SPAN_DECLARE(v18_state_t *) v18_init(v18_state_t *s,
                                      int calling_party,
                                      int mode,
@@ -870,64 +1195,19 @@ SPAN_DECLARE(v18_state_t *) v18_init(v18_state_t *s,
     }
     memset(s, 0, sizeof(*s));
     s->calling_party = calling_party;
-    s->mode = mode & 0xFF;
     s->put_msg = put_msg;
     s->user_data = user_data;
 
-    switch (s->mode)
+    if ((mode & V18_AUTOMODING))
     {
-    case V18_MODE_5BIT_45:
-        fsk_tx_init(&s->fsk_tx, &preset_fsk_specs[FSK_WEITBRECHT], async_tx_get_bit, &s->async_tx);
-        async_tx_init(&s->async_tx, 5, ASYNC_PARITY_NONE, 2, false, v18_tdd_get_async_byte, s);
-        /* Schedule an explicit shift at the start of baudot transmission */
-        s->baudot_tx_shift = 2;
-        /* TDD uses 5 bit data, no parity and 1.5 stop bits. We scan for the first stop bit, and
-           ride over the fraction. */
-        fsk_rx_init(&s->fsk_rx, &preset_fsk_specs[FSK_WEITBRECHT], FSK_FRAME_MODE_5N1_FRAMES, v18_tdd_put_async_byte, s);
-        s->baudot_rx_shift = 0;
-        //s->repeat_shifts = mode & 0x100;
-        break;
-    case V18_MODE_5BIT_50:
-        fsk_tx_init(&s->fsk_tx, &preset_fsk_specs[FSK_WEITBRECHT50], async_tx_get_bit, &s->async_tx);
-        async_tx_init(&s->async_tx, 5, ASYNC_PARITY_NONE, 2, false, v18_tdd_get_async_byte, s);
-        /* Schedule an explicit shift at the start of baudot transmission */
-        s->baudot_tx_shift = 2;
-        /* TDD uses 5 bit data, no parity and 1.5 stop bits. We scan for the first stop bit, and
-           ride over the fraction. */
-        fsk_rx_init(&s->fsk_rx, &preset_fsk_specs[FSK_WEITBRECHT50], FSK_FRAME_MODE_5N1_FRAMES, v18_tdd_put_async_byte, s);
-        s->baudot_rx_shift = 0;
-        //s->repeat_shifts = mode & 0x100;
-        break;
-    case V18_MODE_DTMF:
-        dtmf_tx_init(&s->dtmf_tx);
-        dtmf_rx_init(&s->dtmf_rx, v18_rx_dtmf, s);
-        break;
-    case V18_MODE_EDT:
-        fsk_tx_init(&s->fsk_tx, &preset_fsk_specs[FSK_V21CH1_110], async_tx_get_bit, &s->async_tx);
-        async_tx_init(&s->async_tx, 7, ASYNC_PARITY_EVEN, 2, false, v18_edt_get_async_byte, s);
-        fsk_rx_init(&s->fsk_rx, &preset_fsk_specs[FSK_V21CH1_110], FSK_FRAME_MODE_7E2_FRAMES, v18_edt_put_async_byte, s);
-        break;
-    case V18_MODE_BELL103:
-        fsk_tx_init(&s->fsk_tx, &preset_fsk_specs[FSK_BELL103CH1], async_tx_get_bit, &s->async_tx);
-        async_tx_init(&s->async_tx, 7, ASYNC_PARITY_EVEN, 1, false, v18_edt_get_async_byte, s);
-        fsk_rx_init(&s->fsk_rx, &preset_fsk_specs[FSK_BELL103CH2], FSK_FRAME_MODE_7E1_FRAMES, v18_bell103_put_async_byte, s);
-        break;
-    case V18_MODE_V23VIDEOTEX:
-        fsk_tx_init(&s->fsk_tx, &preset_fsk_specs[FSK_V23CH1], async_tx_get_bit, &s->async_tx);
-        async_tx_init(&s->async_tx, 7, ASYNC_PARITY_EVEN, 1, false, v18_edt_get_async_byte, s);
-        fsk_rx_init(&s->fsk_rx, &preset_fsk_specs[FSK_V23CH2], FSK_FRAME_MODE_7E1_FRAMES, v18_videotex_put_async_byte, s);
-        break;
-    case V18_MODE_V21TEXTPHONE:
-        fsk_tx_init(&s->fsk_tx, &preset_fsk_specs[FSK_V21CH1], async_tx_get_bit, &s->async_tx);
-        async_tx_init(&s->async_tx, 7, ASYNC_PARITY_EVEN, 1, false, v18_edt_get_async_byte, s);
-        fsk_rx_init(&s->fsk_rx, &preset_fsk_specs[FSK_V21CH1], FSK_FRAME_MODE_7E1_FRAMES, v18_textphone_put_async_byte, s);
-        break;
-    case V18_MODE_V18TEXTPHONE:
-        fsk_tx_init(&s->fsk_tx, &preset_fsk_specs[FSK_V21CH1], async_tx_get_bit, &s->async_tx);
-        async_tx_init(&s->async_tx, 7, ASYNC_PARITY_EVEN, 1, false, v18_edt_get_async_byte, s);
-        fsk_rx_init(&s->fsk_rx, &preset_fsk_specs[FSK_V21CH1], FSK_FRAME_MODE_7E1_FRAMES, v18_textphone_put_async_byte, s);
-        break;
+        s->automoding = mode & (V18_AUTOMODING | V18_AUTOMODING_BAUDOT_50 | V18_AUTOMODING_EDT);
+        probe_init(&s->probe);
+    }
+    else
+    {
+        v18_set_mode(s, mode & 0xFF);
     }
+    /*endif*/
     queue_init(&s->queue.queue, 128, QUEUE_READ_ATOMIC | QUEUE_WRITE_ATOMIC);
     return s;
 }
@@ -78,16 +78,16 @@
 #include "spandsp/private/power_meter.h"
 #include "spandsp/private/v22bis.h"
 
-#if defined(SPANDSP_USE_FIXED_POINTx)
-#define FP_SHIFT_FACTOR                 10
-#define FP_SCALE                        FP_Q_6_10
+#if defined(SPANDSP_USE_FIXED_POINT)
+#define FP_FACTOR                       4096
+#define FP_SHIFT_FACTOR                 12
 #include "v22bis_rx_1200_fixed_rrc.h"
 #include "v22bis_rx_2400_fixed_rrc.h"
 #else
-#define FP_SCALE(x)                     (x)
 #include "v22bis_rx_1200_floating_rrc.h"
 #include "v22bis_rx_2400_floating_rrc.h"
 #endif
+#include "fir_kernels.h"
 
 #define ms_to_symbols(t)                (((t)*600)/1000)
 
@@ -96,6 +96,22 @@
 /*! The number of phase shifted coefficient set for the pulse shaping/bandpass filter */
 #define PULSESHAPER_COEFF_SETS          12
 
+#if defined(SPANDSP_USE_FIXED_POINT)
+/*! The number of bits the pulse shaping filter outputs are shifted down before the AGC
+    gain is applied. This lets the AGC gain have a useful resolution, without the products
+    overflowing 32 bits. */
+#define AGC_PRESHIFT                    10
+/*! Convert a floating point AGC gain to the fixed point scaling used by the receiver */
+#define AGC_SCALE(x)                    ((int32_t) ((x)*FP_FACTOR*(float) (1 << AGC_PRESHIFT)*(32768.0f/RX_PULSESHAPER_1200_GAIN)))
+/*! Convert the floating point carrier tracking gains to the pre-scaled values used by the
+    receiver, which keep the tracking products within 32 bits. */
+#define CARRIER_TRACK_I(x)              ((int32_t) ((x)/16.0f))
+#define CARRIER_TRACK_P(x)              ((int32_t) ((x)/FP_FACTOR))
+#else
+#define CARRIER_TRACK_I(x)              (x)
+#define CARRIER_TRACK_P(x)              (x)
+#endif
+
 /*
 The basic method used by the V.22bis receiver is:
 
@@ -132,11 +148,43 @@ static const uint8_t space_map_v22bis[6][6] =
     {15, 14, 14,  1,  1,  3}
 };
 
+#if defined(SPANDSP_USE_FIXED_POINT)
+#define CONSTELLATION                   v22bis_constellation_q4_12
+#else
+#define CONSTELLATION                   v22bis_constellation
+#endif
+
 static const uint8_t phase_steps[4] =
 {
     1, 0, 2, 3
 };
 
+#if defined(SPANDSP_USE_FIXED_POINT)
+/* The same as v22bis_constellation, in Q4.12 format */
+static const complexi16_t v22bis_constellation_q4_12[16] =
+{
+    { 1*FP_FACTOR,  1*FP_FACTOR},
+    { 3*FP_FACTOR,  1*FP_FACTOR},   /* 1200bps 00 */
+    { 1*FP_FACTOR,  3*FP_FACTOR},
+    { 3*FP_FACTOR,  3*FP_FACTOR},
+    {-1*FP_FACTOR,  1*FP_FACTOR},
+    {-1*FP_FACTOR,  3*FP_FACTOR},   /* 1200bps 01 */
+    {-3*FP_FACTOR,  1*FP_FACTOR},
+    {-3*FP_FACTOR,  3*FP_FACTOR},
+    {-1*FP_FACTOR, -1*FP_FACTOR},
+    {-3*FP_FACTOR, -1*FP_FACTOR},   /* 1200bps 10 */
+    {-1*FP_FACTOR, -3*FP_FACTOR},
+    {-3*FP_FACTOR, -3*FP_FACTOR},
+    { 1*FP_FACTOR, -1*FP_FACTOR},
+    { 1*FP_FACTOR, -3*FP_FACTOR},   /* 1200bps 11 */
+    { 3*FP_FACTOR, -1*FP_FACTOR},
+    { 3*FP_FACTOR, -3*FP_FACTOR}
+};
+
+/* The rotation which moves the 1200bps constellation points to the 45 degree positions */
+static const complexi16_t rotate_45 = {FP_Q4_12(0.894427f), FP_Q4_12(0.44721f)};
+#endif
+
 SPAN_DECLARE(float) v22bis_rx_carrier_frequency(v22bis_state_t *s)
 {
     return dds_frequencyf(s->rx.carrier_phase_rate);
@@ -171,7 +219,7 @@ void v22bis_report_status_change(v22bis_state_t *s, int status)
 }
 /*- End of function --------------------------------------------------------*/
 
-#if defined(SPANDSP_USE_FIXED_POINTx)
+#if defined(SPANDSP_USE_FIXED_POINT)
 SPAN_DECLARE(int) v22bis_rx_equalizer_state(v22bis_state_t *s, complexi16_t **coeffs)
 #else
 SPAN_DECLARE(int) v22bis_rx_equalizer_state(v22bis_state_t *s, complexf_t **coeffs)
@@ -185,8 +233,8 @@ SPAN_DECLARE(int) v22bis_rx_equalizer_state(v22bis_state_t *s, complexf_t **coef
 void v22bis_equalizer_coefficient_reset(v22bis_state_t *s)
 {
     /* Start with an equalizer based on everything being perfect */
-#if defined(SPANDSP_USE_FIXED_POINTx)
-    static const complexi16_t x = {FP_Q_6_10(3.0f), FP_Q_6_10(0.0f)};
+#if defined(SPANDSP_USE_FIXED_POINT)
+    static const complexi16_t x = {3*FP_FACTOR, 0*FP_FACTOR};
 
     cvec_zeroi16(s->rx.eq_coeff, 2*V22BIS_EQUALIZER_LEN + 1);
     s->rx.eq_coeff[V22BIS_EQUALIZER_LEN] = x;
@@ -204,7 +252,7 @@ void v22bis_equalizer_coefficient_reset(v22bis_state_t *s)
 static void equalizer_reset(v22bis_state_t *s)
 {
     v22bis_equalizer_coefficient_reset(s);
-#if defined(SPANDSP_USE_FIXED_POINTx)
+#if defined(SPANDSP_USE_FIXED_POINT)
     cvec_zeroi16(s->rx.eq_buf, V22BIS_EQUALIZER_MASK + 1);
 #else
     cvec_zerof(s->rx.eq_buf, V22BIS_EQUALIZER_MASK + 1);
@@ -214,64 +262,122 @@ static void equalizer_reset(v22bis_state_t *s)
 }
 /*- End of function --------------------------------------------------------*/
 
-static complexf_t equalizer_get(v22bis_state_t *s)
+static __inline__ int equalizer_first_span(v22bis_state_t *s)
 {
-    int i;
-    int p;
+    int n;
+
+    /* The equalizer taps span the 2*V22BIS_EQUALIZER_LEN + 1 oldest entries in the
+       circular buffer, starting at the current step. Find how many of them lie before
+       the point where the buffer wraps around, so the vector routines can work on
+       two contiguous spans. The first coefficient goes with the oldest entry. */
+    n = V22BIS_EQUALIZER_MASK + 1 - s->rx.eq_step;
+    if (n > 2*V22BIS_EQUALIZER_LEN + 1)
+        n = 2*V22BIS_EQUALIZER_LEN + 1;
+    return n;
+}
+/*- End of function --------------------------------------------------------*/
+
+#if defined(SPANDSP_USE_FIXED_POINT)
+static __inline__ complexi16_t complex_mul_q4_12(const complexi16_t *x, const complexi16_t *y)
+{
+    complexi16_t z;
+
+    z.re = ((int32_t) x->re*(int32_t) y->re - (int32_t) x->im*(int32_t) y->im) >> FP_SHIFT_FACTOR;
+    z.im = ((int32_t) x->re*(int32_t) y->im + (int32_t) x->im*(int32_t) y->re) >> FP_SHIFT_FACTOR;
+    return z;
+}
+/*- End of function --------------------------------------------------------*/
+
+static __inline__ complexi16_t equalizer_get(v22bis_state_t *s)
+{
+    int n;
+    complexi32_t zz;
+    complexi32_t zz1;
+    complexi16_t z;
+
+    /* Get the next equalized value. */
+    n = equalizer_first_span(s);
+    zz = cvec_dot_prodi16(&s->rx.eq_buf[s->rx.eq_step], s->rx.eq_coeff, n);
+    zz1 = cvec_dot_prodi16(s->rx.eq_buf, &s->rx.eq_coeff[n], 2*V22BIS_EQUALIZER_LEN + 1 - n);
+    z.re = (zz.re + zz1.re) >> FP_SHIFT_FACTOR;
+    z.im = (zz.im + zz1.im) >> FP_SHIFT_FACTOR;
+    return z;
+}
+#else
+static __inline__ complexf_t equalizer_get(v22bis_state_t *s)
+{
+    int n;
     complexf_t z;
     complexf_t z1;
 
     /* Get the next equalized value. */
-    z = complex_setf(0.0f, 0.0f);
-    p = s->rx.eq_step - 1;
-    for (i = 0;  i < 2*V22BIS_EQUALIZER_LEN + 1;  i++)
-    {
-        p = (p - 1) & V22BIS_EQUALIZER_MASK;
-        z1 = complex_mulf(&s->rx.eq_coeff[i], &s->rx.eq_buf[p]);
-        z = complex_addf(&z, &z1);
-    }
-    return z;
+    n = equalizer_first_span(s);
+    z = cvec_dot_prodf(&s->rx.eq_buf[s->rx.eq_step], s->rx.eq_coeff, n);
+    z1 = cvec_dot_prodf(s->rx.eq_buf, &s->rx.eq_coeff[n], 2*V22BIS_EQUALIZER_LEN + 1 - n);
+    return complex_addf(&z, &z1);
 }
+#endif
 /*- End of function --------------------------------------------------------*/
 
-static void tune_equalizer(v22bis_state_t *s, const complexf_t *z, const complexf_t *target)
+#if defined(SPANDSP_USE_FIXED_POINT)
+static void tune_equalizer(v22bis_state_t *s, const complexi16_t *z, const complexi16_t *target)
 {
-    int i;
-    int p;
-    complexf_t ez;
-    complexf_t z1;
+    int n;
+    complexi16_t err;
 
     /* Find the x and y mismatch from the exact constellation position. */
-    ez = complex_subf(target, z);
-    ez.re *= s->rx.eq_delta;
-    ez.im *= s->rx.eq_delta;
+    err.re = target->re - z->re;
+    err.im = target->im - z->im;
+    err.re = ((int32_t) err.re*(int32_t) s->rx.eq_delta) >> 15;
+    err.im = ((int32_t) err.im*(int32_t) s->rx.eq_delta) >> 15;
+    n = equalizer_first_span(s);
+    cvec_lmsi16(&s->rx.eq_buf[s->rx.eq_step], s->rx.eq_coeff, n, &err);
+    cvec_lmsi16(s->rx.eq_buf, &s->rx.eq_coeff[n], 2*V22BIS_EQUALIZER_LEN + 1 - n, &err);
+}
+#else
+static void tune_equalizer(v22bis_state_t *s, const complexf_t *z, const complexf_t *target)
+{
+    int n;
+    complexf_t err;
 
-    p = s->rx.eq_step - 1;
-    for (i = 0;  i < 2*V22BIS_EQUALIZER_LEN + 1;  i++)
-    {
-        p = (p - 1) & V22BIS_EQUALIZER_MASK;
-        z1 = complex_conjf(&s->rx.eq_buf[p]);
-        z1 = complex_mulf(&ez, &z1);
-        s->rx.eq_coeff[i] = complex_addf(&s->rx.eq_coeff[i], &z1);
-        /* If we don't leak a little bit we seem to get some wandering adaption */
-        s->rx.eq_coeff[i].re *= 0.9999f;
-        s->rx.eq_coeff[i].im *= 0.9999f;
-    }
+    /* Find the x and y mismatch from the exact constellation position. */
+    err = complex_subf(target, z);
+    err.re *= s->rx.eq_delta;
+    err.im *= s->rx.eq_delta;
+    /* The LMS routine leaks a little, as if we don't we seem to get some wandering adaption */
+    n = equalizer_first_span(s);
+    cvec_lmsf(&s->rx.eq_buf[s->rx.eq_step], s->rx.eq_coeff, n, &err);
+    cvec_lmsf(s->rx.eq_buf, &s->rx.eq_coeff[n], 2*V22BIS_EQUALIZER_LEN + 1 - n, &err);
 }
+#endif
 /*- End of function --------------------------------------------------------*/
 
+#if defined(SPANDSP_USE_FIXED_POINT)
+static __inline__ void track_carrier(v22bis_state_t *s, const complexi16_t *z, const complexi16_t *target)
+#else
 static __inline__ void track_carrier(v22bis_state_t *s, const complexf_t *z, const complexf_t *target)
+#endif
 {
+#if defined(SPANDSP_USE_FIXED_POINT)
+    int32_t error;
+#else
     float error;
+#endif
 
     /* For small errors the imaginary part of the difference between the actual and the target
        positions is proportional to the phase error, for any particular target. However, the
        different amplitudes of the various target positions scale things. */
+#if defined(SPANDSP_USE_FIXED_POINT)
+    error = ((int32_t) z->im*target->re - (int32_t) z->re*target->im) >> FP_SHIFT_FACTOR;
+    s->rx.carrier_phase_rate += (s->rx.carrier_track_i*error) >> (FP_SHIFT_FACTOR - 4);
+    s->rx.carrier_phase += s->rx.carrier_track_p*error;
+#else
     error = z->im*target->re - z->re*target->im;
 
     s->rx.carrier_phase_rate += (int32_t) (s->rx.carrier_track_i*error);
     s->rx.carrier_phase += (int32_t) (s->rx.carrier_track_p*error);
     //span_log(&s->logging, SPAN_LOG_FLOW, "Im = %15.5f   f = %15.5f\n", error, dds_frequencyf(s->rx.carrier_phase_rate));
+#endif
 }
 /*- End of function --------------------------------------------------------*/
 
@@ -348,12 +454,20 @@ static int decode_baudx(v22bis_state_t *s, int nearest)
 
 static __inline__ void symbol_sync(v22bis_state_t *s)
 {
+#if defined(SPANDSP_USE_FIXED_POINT)
+    int32_t p;
+    int32_t q;
+    complexi16_t a;
+    complexi16_t b;
+    complexi16_t c;
+#else
     float p;
     float q;
     complexf_t zz;
     complexf_t a;
     complexf_t b;
     complexf_t c;
+#endif
 
     /* This routine adapts the position of the half baud samples entering the equalizer. */
 
@@ -365,7 +479,7 @@ static __inline__ void symbol_sync(v22bis_state_t *s)
         p *= s->rx.eq_buf[(s->rx.eq_step - 2) & V22BIS_EQUALIZER_MASK].re;
 
         q = s->rx.eq_buf[(s->rx.eq_step - 3) & V22BIS_EQUALIZER_MASK].im
-        - s->rx.eq_buf[(s->rx.eq_step - 1) & V22BIS_EQUALIZER_MASK].im;
+          - s->rx.eq_buf[(s->rx.eq_step - 1) & V22BIS_EQUALIZER_MASK].im;
         q *= s->rx.eq_buf[(s->rx.eq_step - 2) & V22BIS_EQUALIZER_MASK].im;
     }
     else
@@ -373,15 +487,23 @@ static __inline__ void symbol_sync(v22bis_state_t *s)
         /* Rotate the points to the 45 degree positions, to maximise the effectiveness of
            the Gardner algorithm. This is particularly significant at the start of operation
            to pull things in quickly. */
+#if defined(SPANDSP_USE_FIXED_POINT)
+        a = complex_mul_q4_12(&s->rx.eq_buf[(s->rx.eq_step - 3) & V22BIS_EQUALIZER_MASK], &rotate_45);
+        b = complex_mul_q4_12(&s->rx.eq_buf[(s->rx.eq_step - 2) & V22BIS_EQUALIZER_MASK], &rotate_45);
+        c = complex_mul_q4_12(&s->rx.eq_buf[(s->rx.eq_step - 1) & V22BIS_EQUALIZER_MASK], &rotate_45);
+        p = (int32_t) (a.re - c.re)*b.re;
+        q = (int32_t) (a.im - c.im)*b.im;
+#else
         zz = complex_setf(0.894427, 0.44721f);
         a = complex_mulf(&s->rx.eq_buf[(s->rx.eq_step - 3) & V22BIS_EQUALIZER_MASK], &zz);
         b = complex_mulf(&s->rx.eq_buf[(s->rx.eq_step - 2) & V22BIS_EQUALIZER_MASK], &zz);
         c = complex_mulf(&s->rx.eq_buf[(s->rx.eq_step - 1) & V22BIS_EQUALIZER_MASK], &zz);
         p = (a.re - c.re)*b.re;
         q = (a.im - c.im)*b.im;
+#endif
     }
 
-    s->rx.gardner_integrate += (p + q > 0.0f)  ?  s->rx.gardner_step  :  -s->rx.gardner_step;
+    s->rx.gardner_integrate += (p + q > 0)  ?  s->rx.gardner_step  :  -s->rx.gardner_step;
 
     if (abs(s->rx.gardner_integrate) >= 16)
     {
@@ -398,11 +520,23 @@ static __inline__ void symbol_sync(v22bis_state_t *s)
 }
 /*- End of function --------------------------------------------------------*/
 
+#if defined(SPANDSP_USE_FIXED_POINT)
+static void process_half_baud(v22bis_state_t *s, const complexi16_t *sample)
+#else
 static void process_half_baud(v22bis_state_t *s, const complexf_t *sample)
+#endif
 {
+#if defined(SPANDSP_USE_FIXED_POINT)
+    complexi16_t z;
+    complexi16_t zz;
+    const complexi16_t *target;
+    complexf_t z1;
+    complexf_t z2;
+#else
     complexf_t z;
     complexf_t zz;
     const complexf_t *target;
+#endif
     int re;
     int im;
     int nearest;
@@ -428,8 +562,13 @@ static void process_half_baud(v22bis_state_t *s, const complexf_t *sample)
     /* Find the constellation point */
     if (s->rx.sixteen_way_decisions)
     {
+#if defined(SPANDSP_USE_FIXED_POINT)
+        re = (z.re + 3*FP_FACTOR) >> FP_SHIFT_FACTOR;
+        im = (z.im + 3*FP_FACTOR) >> FP_SHIFT_FACTOR;
+#else
         re = (int) (z.re + 3.0f);
         im = (int) (z.im + 3.0f);
+#endif
         if (re > 5)
             re = 5;
         else if (re < 0)
@@ -443,8 +582,12 @@ static void process_half_baud(v22bis_state_t *s, const complexf_t *sample)
     else
     {
         /* Rotate to 45 degrees, to make the slicing trivial. */
+#if defined(SPANDSP_USE_FIXED_POINT)
+        zz = complex_mul_q4_12(&z, &rotate_45);
+#else
         zz = complex_setf(0.894427, 0.44721f);
         zz = complex_mulf(&z, &zz);
+#endif
         nearest = 0x01;
         if (zz.re < 0)
             nearest |= 0x04;
@@ -460,7 +603,7 @@ static void process_half_baud(v22bis_state_t *s, const complexf_t *sample)
     {
     case V22BIS_RX_TRAINING_STAGE_NORMAL_OPERATION:
         /* Normal operation. */
-        target = &v22bis_constellation[nearest];
+        target = &CONSTELLATION[nearest];
         track_carrier(s, &z, target);
         tune_equalizer(s, &z, target);
         raw_bits = phase_steps[((nearest >> 2) - (s->rx.constellation_state >> 2)) & 3];
@@ -515,7 +658,7 @@ static void process_half_baud(v22bis_state_t *s, const complexf_t *sample)
     case V22BIS_RX_TRAINING_STAGE_UNSCRAMBLED_ONES:
         /* Calling modem only. */
         /* The calling modem should initially receive unscrambled ones at 1200bps */
-        target = &v22bis_constellation[nearest];
+        target = &CONSTELLATION[nearest];
         track_carrier(s, &z, target);
         raw_bits = phase_steps[((nearest >> 2) - (s->rx.constellation_state >> 2)) & 3];
         s->rx.constellation_state = nearest;
@@ -557,7 +700,7 @@ static void process_half_baud(v22bis_state_t *s, const complexf_t *sample)
     case V22BIS_RX_TRAINING_STAGE_UNSCRAMBLED_ONES_SUSTAINING:
         /* Calling modem only. */
         /* Wait for the end of the unscrambled ones at 1200bps. */
-        target = &v22bis_constellation[nearest];
+        target = &CONSTELLATION[nearest];
         track_carrier(s, &z, target);
         raw_bits = phase_steps[((nearest >> 2) - (s->rx.constellation_state >> 2)) & 3];
         s->rx.constellation_state = nearest;
@@ -572,7 +715,7 @@ static void process_half_baud(v22bis_state_t *s, const complexf_t *sample)
         }
         break;
     case V22BIS_RX_TRAINING_STAGE_SCRAMBLED_ONES_AT_1200:
-        target = &v22bis_constellation[nearest];
+        target = &CONSTELLATION[nearest];
         track_carrier(s, &z, target);
         tune_equalizer(s, &z, target);
         raw_bits = phase_steps[((nearest >> 2) - (s->rx.constellation_state >> 2)) & 3];
@@ -618,7 +761,7 @@ static void process_half_baud(v22bis_state_t *s, const complexf_t *sample)
                     s->tx.training = V22BIS_TX_TRAINING_STAGE_TIMED_S11;
                     /* Normal reception starts immediately. */
                     s->rx.training = V22BIS_RX_TRAINING_STAGE_NORMAL_OPERATION;
-                    s->rx.carrier_track_i = 8000.0f;
+                    s->rx.carrier_track_i = CARRIER_TRACK_I(8000.0f);
                 }
                 else
                 {
@@ -642,7 +785,7 @@ static void process_half_baud(v22bis_state_t *s, const complexf_t *sample)
                     s->rx.sixteen_way_decisions = true;
                     s->rx.training = V22BIS_RX_TRAINING_STAGE_WAIT_FOR_SCRAMBLED_ONES_AT_2400;
                     s->rx.pattern_repeats = 0;
-                    s->rx.carrier_track_i = 8000.0f;
+                    s->rx.carrier_track_i = CARRIER_TRACK_I(8000.0f);
                 }
             }
             else
@@ -658,7 +801,7 @@ static void process_half_baud(v22bis_state_t *s, const complexf_t *sample)
         }
         break;
     case V22BIS_RX_TRAINING_STAGE_SCRAMBLED_ONES_AT_1200_SUSTAINING:
-        target = &v22bis_constellation[nearest];
+        target = &CONSTELLATION[nearest];
         track_carrier(s, &z, target);
         tune_equalizer(s, &z, target);
         bitstream = decode_baudx(s, nearest);
@@ -669,7 +812,7 @@ static void process_half_baud(v22bis_state_t *s, const complexf_t *sample)
         }
         break;
     case V22BIS_RX_TRAINING_STAGE_WAIT_FOR_SCRAMBLED_ONES_AT_2400:
-        target = &v22bis_constellation[nearest];
+        target = &CONSTELLATION[nearest];
         track_carrier(s, &z, target);
         tune_equalizer(s, &z, target);
         bitstream = decode_baudx(s, nearest);
@@ -696,58 +839,94 @@ static void process_half_baud(v22bis_state_t *s, const complexf_t *sample)
     }
     s->rx.last_raw_bits = raw_bits;
     if (s->rx.qam_report)
+    {
+#if defined(SPANDSP_USE_FIXED_POINT)
+        z1.re = z.re/(float) FP_FACTOR;
+        z1.im = z.im/(float) FP_FACTOR;
+        z2.re = target->re/(float) FP_FACTOR;
+        z2.im = target->im/(float) FP_FACTOR;
+        s->rx.qam_report(s->rx.qam_user_data, &z1, &z2, s->rx.constellation_state);
+#else
         s->rx.qam_report(s->rx.qam_user_data, &z, target, s->rx.constellation_state);
+#endif
+    }
 }
 /*- End of function --------------------------------------------------------*/
 
-SPAN_DECLARE_NONSTD(int) v22bis_rx(v22bis_state_t *s, const int16_t amp[], int len)
+static int rx_block(v22bis_state_t *s, const int16_t amp[], int len)
 {
     int i;
     int step;
+    int32_t power;
+#if defined(SPANDSP_USE_FIXED_POINT)
+    const int16_t (*pulseshaper_re)[V22BIS_RX_FILTER_STEPS];
+    const int16_t (*pulseshaper_im)[V22BIS_RX_FILTER_STEPS];
+    int16_t *buf;
+    complexi16_t z;
+    complexi16_t zz;
+    complexi16_t sample;
+    int32_t ii[V22BIS_RX_BLOCK_LEN];
+    int32_t iii;
+    int32_t qqq;
+#else
+    const float (*pulseshaper_re)[V22BIS_RX_FILTER_STEPS];
+    const float (*pulseshaper_im)[V22BIS_RX_FILTER_STEPS];
+    float *buf;
     complexf_t z;
     complexf_t zz;
-    int32_t power;
     complexf_t sample;
-    float ii;
-    float qq;
+    float ii[V22BIS_RX_BLOCK_LEN];
+    float iii;
+    float qqq;
+#endif
 
-    for (i = 0;  i < len;  i++)
+    if (s->calling_party)
     {
-        /* Complex bandpass filter the signal, using a pair of FIRs, and RRC coeffs shifted
-           to centre at 1200Hz or 2400Hz. The filters support 12 fractional phase shifts, to
-           permit signal extraction very close to the middle of a symbol. */
-        s->rx.rrc_filter[s->rx.rrc_filter_step] = amp[i];
-        if (++s->rx.rrc_filter_step >= V22BIS_RX_FILTER_STEPS)
-            s->rx.rrc_filter_step = 0;
-
-        /* Calculate the I filter, with an arbitrary phase step, just so we can calculate
-           the signal power of the required carrier, with any guard tone or spillback of our
-           own transmitted signal suppressed. */
-        if (s->calling_party)
-        {
+        pulseshaper_re = rx_pulseshaper_2400_re;
+        pulseshaper_im = rx_pulseshaper_2400_im;
+    }
+    else
+    {
+        pulseshaper_re = rx_pulseshaper_1200_re;
+        pulseshaper_im = rx_pulseshaper_1200_im;
+    }
+
+    /* Append the new samples to the tail of the previous block, so the filter history
+       for every sample in the block is one contiguous run of memory. */
+    buf = s->rx.rrc_filter;
 #if defined(SPANDSP_USE_FIXED_POINT)
-            ii = vec_circular_dot_prodi16(s->rx.rrc_filter, rx_pulseshaper_2400_re[6], V22BIS_RX_FILTER_STEPS, s->rx.rrc_filter_step);
+    vec_copyi16(&buf[V22BIS_RX_FILTER_STEPS - 1], amp, len);
 #else
-            ii = vec_circular_dot_prodf(s->rx.rrc_filter, rx_pulseshaper_2400_re[6], V22BIS_RX_FILTER_STEPS, s->rx.rrc_filter_step);
+    for (i = 0;  i < len;  i++)
+        buf[V22BIS_RX_FILTER_STEPS - 1 + i] = amp[i];
 #endif
-        }
-        else
-        {
+
+    /* Calculate the I filter, with an arbitrary phase step, just so we can calculate
+       the signal power of the required carrier, with any guard tone or spillback of our
+       own transmitted signal suppressed. This is needed for every sample, so do the whole
+       block in one pass. */
+    for (i = 0;  i < len;  i++)
+    {
 #if defined(SPANDSP_USE_FIXED_POINT)
-            ii = vec_circular_dot_prodi16(s->rx.rrc_filter, rx_pulseshaper_1200_re[6], V22BIS_RX_FILTER_STEPS, s->rx.rrc_filter_step);
+        ii[i] = FIR_KERNEL_DOT_PRODI16(V22BIS_RX_FILTER_STEPS)(&buf[i], pulseshaper_re[6]) >> 15;
 #else
-            ii = vec_circular_dot_prodf(s->rx.rrc_filter, rx_pulseshaper_1200_re[6], V22BIS_RX_FILTER_STEPS, s->rx.rrc_filter_step);
+        ii[i] = FIR_KERNEL_DOT_PRODF(V22BIS_RX_FILTER_STEPS)(&buf[i], pulseshaper_re[6]);
 #endif
-        }
-        power = power_meter_update(&s->rx.rx_power, (int16_t) ii);
+    }
+
+    for (i = 0;  i < len;  i++)
+    {
+        power = power_meter_update(&s->rx.rx_power, (int16_t) ii[i]);
         if (s->rx.signal_present)
         {
             /* Look for power below the carrier off point */
             if (power < s->rx.carrier_off_power)
             {
+                /* The restart clears the filter history, so the rest of the block must
+                   be processed afresh. */
                 v22bis_restart(s, s->bit_rate);
                 v22bis_report_status_change(s, SIG_STATUS_CARRIER_DOWN);
-                continue;
+                return i + 1;
             }
         }
         else
@@ -762,12 +941,21 @@ SPAN_DECLARE_NONSTD(int) v22bis_rx(v22bis_state_t *s, const int16_t amp[], int l
         {
             /* Only spend effort processing this data if the modem is not
                parked, after a training failure. */
+#if defined(SPANDSP_USE_FIXED_POINT)
+            z = dds_complexi16(&s->rx.carrier_phase, s->rx.carrier_phase_rate);
+            if (s->rx.training == V22BIS_RX_TRAINING_STAGE_SYMBOL_ACQUISITION)
+            {
+                /* Only AGC during the initial symbol acquisition, and then lock the gain. */
+                s->rx.agc_scaling = AGC_SCALE(0.18f*3.60f)/fixed_sqrt32(power);
+            }
+#else
             z = dds_complexf(&s->rx.carrier_phase, s->rx.carrier_phase_rate);
             if (s->rx.training == V22BIS_RX_TRAINING_STAGE_SYMBOL_ACQUISITION)
             {
                 /* Only AGC during the initial symbol acquisition, and then lock the gain. */
                 s->rx.agc_scaling = 0.18f*3.60f/sqrtf(power);
             }
+#endif
             /* Put things into the equalization buffer at T/2 rate. The Gardner algorithm
                will fiddle the step to align this with the symbols. */
             if ((s->rx.eq_put_step -= PULSESHAPER_COEFF_SETS) <= 0)
@@ -775,42 +963,59 @@ SPAN_DECLARE_NONSTD(int) v22bis_rx(v22bis_state_t *s, const int16_t amp[], int l
                 /* Pulse shape while still at the carrier frequency, using a quadrature
                    pair of filters. This results in a properly bandpass filtered complex
                    signal, which can be brought directly to bandband by complex mixing.
-                   No further filtering, to remove mixer harmonics, is needed. */
+                   No further filtering, to remove mixer harmonics, is needed. The filters
+                   support 12 fractional phase shifts, to permit signal extraction very
+                   close to the middle of a symbol. */
                 step = -s->rx.eq_put_step;
                 if (step > PULSESHAPER_COEFF_SETS - 1)
                     step = PULSESHAPER_COEFF_SETS - 1;
                 s->rx.eq_put_step += PULSESHAPER_COEFF_SETS*40/(3*2);
-                if (s->calling_party)
-                {
 #if defined(SPANDSP_USE_FIXED_POINT)
-                    ii = vec_circular_dot_prodi16(s->rx.rrc_filter, rx_pulseshaper_2400_re[step], V22BIS_RX_FILTER_STEPS, s->rx.rrc_filter_step);
-                    qq = vec_circular_dot_prodi16(s->rx.rrc_filter, rx_pulseshaper_2400_im[step], V22BIS_RX_FILTER_STEPS, s->rx.rrc_filter_step);
-#else
-                    ii = vec_circular_dot_prodf(s->rx.rrc_filter, rx_pulseshaper_2400_re[step], V22BIS_RX_FILTER_STEPS, s->rx.rrc_filter_step);
-                    qq = vec_circular_dot_prodf(s->rx.rrc_filter, rx_pulseshaper_2400_im[step], V22BIS_RX_FILTER_STEPS, s->rx.rrc_filter_step);
-#endif
-                }
-                else
-                {
-#if defined(SPANDSP_USE_FIXED_POINT)
-                    ii = vec_circular_dot_prodi16(s->rx.rrc_filter, rx_pulseshaper_1200_re[step], V22BIS_RX_FILTER_STEPS, s->rx.rrc_filter_step);
-                    qq = vec_circular_dot_prodi16(s->rx.rrc_filter, rx_pulseshaper_1200_im[step], V22BIS_RX_FILTER_STEPS, s->rx.rrc_filter_step);
+                iii = FIR_KERNEL_DOT_PRODI16(V22BIS_RX_FILTER_STEPS)(&buf[i], pulseshaper_re[step]) >> AGC_PRESHIFT;
+                qqq = FIR_KERNEL_DOT_PRODI16(V22BIS_RX_FILTER_STEPS)(&buf[i], pulseshaper_im[step]) >> AGC_PRESHIFT;
+                sample.re = (iii*s->rx.agc_scaling) >> 15;
+                sample.im = (qqq*s->rx.agc_scaling) >> 15;
+                /* Shift to baseband - since this is done in a full complex form, the
+                   result is clean, and requires no further filtering apart from the
+                   equalizer. */
+                zz.re = ((int32_t) sample.re*z.re - (int32_t) sample.im*z.im) >> 15;
+                zz.im = ((int32_t) -sample.re*z.im - (int32_t) sample.im*z.re) >> 15;
 #else
-                    ii = vec_circular_dot_prodf(s->rx.rrc_filter, rx_pulseshaper_1200_re[step], V22BIS_RX_FILTER_STEPS, s->rx.rrc_filter_step);
-                    qq = vec_circular_dot_prodf(s->rx.rrc_filter, rx_pulseshaper_1200_im[step], V22BIS_RX_FILTER_STEPS, s->rx.rrc_filter_step);
-#endif
-                }
-                sample.re = ii*s->rx.agc_scaling;
-                sample.im = qq*s->rx.agc_scaling;
+                iii = FIR_KERNEL_DOT_PRODF(V22BIS_RX_FILTER_STEPS)(&buf[i], pulseshaper_re[step]);
+                qqq = FIR_KERNEL_DOT_PRODF(V22BIS_RX_FILTER_STEPS)(&buf[i], pulseshaper_im[step]);
+                sample.re = iii*s->rx.agc_scaling;
+                sample.im = qqq*s->rx.agc_scaling;
                 /* Shift to baseband - since this is done in a full complex form, the
                    result is clean, and requires no further filtering apart from the
                    equalizer. */
                 zz.re = sample.re*z.re - sample.im*z.im;
                 zz.im = -sample.re*z.im - sample.im*z.re;
+#endif
                 process_half_baud(s, &zz);
             }
         }
     }
+    /* Keep the tail of this block, as the filter history for the next one. */
+    memmove(buf, &buf[len], (V22BIS_RX_FILTER_STEPS - 1)*sizeof(buf[0]));
+    return len;
+}
+/*- End of function --------------------------------------------------------*/
+
+SPAN_DECLARE_NONSTD(int) v22bis_rx(v22bis_state_t *s, const int16_t amp[], int len)
+{
+    int i;
+    int n;
+
+    /* Complex bandpass filter the signal, using a pair of FIRs, and RRC coeffs shifted
+       to centre at 1200Hz or 2400Hz. This is done in blocks, so the filtering can run
+       over linear stretches of the signal, rather than a circular buffer. */
+    for (i = 0;  i < len;  i += n)
+    {
+        n = len - i;
+        if (n > V22BIS_RX_BLOCK_LEN)
+            n = V22BIS_RX_BLOCK_LEN;
+        n = rx_block(s, &amp[i], n);
+    }
     return 0;
 }
 /*- End of function --------------------------------------------------------*/
@@ -826,7 +1031,7 @@ SPAN_DECLARE_NONSTD(int) v22bis_rx_fillin(v22bis_state_t *s, int len)
         return 0;
     for (i = 0;  i < len;  i++)
     {
-#if defined(SPANDSP_USE_FIXED_POINTx)
+#if defined(SPANDSP_USE_FIXED_POINT)
         dds_advance(&s->rx.carrier_phase, s->rx.carrier_phase_rate);
 #else
         dds_advancef(&s->rx.carrier_phase, s->rx.carrier_phase_rate);
@@ -839,12 +1044,11 @@ SPAN_DECLARE_NONSTD(int) v22bis_rx_fillin(v22bis_state_t *s, int len)
 
 int v22bis_rx_restart(v22bis_state_t *s)
 {
-#if defined(SPANDSP_USE_FIXED_POINTx)
+#if defined(SPANDSP_USE_FIXED_POINT)
     vec_zeroi16(s->rx.rrc_filter, sizeof(s->rx.rrc_filter)/sizeof(s->rx.rrc_filter[0]));
 #else
     vec_zerof(s->rx.rrc_filter, sizeof(s->rx.rrc_filter)/sizeof(s->rx.rrc_filter[0]));
 #endif
-    s->rx.rrc_filter_step = 0;
     s->rx.scramble_reg = 0;
     s->rx.scrambler_pattern_count = 0;
     s->rx.training = V22BIS_RX_TRAINING_STAGE_SYMBOL_ACQUISITION;
@@ -855,7 +1059,11 @@ int v22bis_rx_restart(v22bis_state_t *s)
     s->rx.carrier_phase = 0;
     power_meter_init(&s->rx.rx_power, 5);
     v22bis_rx_signal_cutoff(s, -45.5f);
+#if defined(SPANDSP_USE_FIXED_POINT)
+    s->rx.agc_scaling = AGC_SCALE(0.0005f*0.025f);
+#else
     s->rx.agc_scaling = 0.0005f*0.025f;
+#endif
 
     s->rx.constellation_state = 0;
     s->rx.sixteen_way_decisions = false;
@@ -870,8 +1078,8 @@ int v22bis_rx_restart(v22bis_state_t *s)
     s->rx.training_error = 0.0f;
     s->rx.total_baud_timing_correction = 0;
     /* We want the carrier to pull in faster on the answerer side, as it has very little time to adapt. */
-    s->rx.carrier_track_i = (s->calling_party)  ?  8000.0f  :  40000.0f;
-    s->rx.carrier_track_p = 8000000.0f;
+    s->rx.carrier_track_i = (s->calling_party)  ?  CARRIER_TRACK_I(8000.0f)  :  CARRIER_TRACK_I(40000.0f);
+    s->rx.carrier_track_p = CARRIER_TRACK_P(8000000.0f);
 
     s->negotiated_bit_rate = 1200;
 
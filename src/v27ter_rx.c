@@ -78,6 +78,7 @@
 #include "v27ter_rx_4800_floating_rrc.h"
 #include "v27ter_rx_2400_floating_rrc.h"
 #endif
+#include "fir_kernels.h"
 
 /* V.27ter is a DPSK modem, but this code treats it like QAM. It nails down the
    signal to a static constellation, even though dealing with differences is all
@@ -865,6 +866,7 @@ SPAN_DECLARE_NONSTD(int) v27ter_rx(v27ter_rx_state_t *s, const int16_t amp[], in
         for (i = 0;  i < len;  i++)
         {
             s->rrc_filter[s->rrc_filter_step] = amp[i];
+            s->rrc_filter[s->rrc_filter_step + V27TER_RX_4800_FILTER_STEPS] = amp[i];
             if (++s->rrc_filter_step >= V27TER_RX_4800_FILTER_STEPS)
                 s->rrc_filter_step = 0;
 
@@ -896,17 +898,17 @@ SPAN_DECLARE_NONSTD(int) v27ter_rx(v27ter_rx_state_t *s, const int16_t amp[], in
                 if (step > RX_PULSESHAPER_4800_COEFF_SETS - 1)
                     step = RX_PULSESHAPER_4800_COEFF_SETS - 1;
 #if defined(SPANDSP_USE_FIXED_POINT)
-                v = vec_circular_dot_prodi16(s->rrc_filter, rx_pulseshaper_4800_re[step], V27TER_RX_FILTER_STEPS, s->rrc_filter_step);
+                v = FIR_KERNEL_DOT_PRODI16(V27TER_RX_4800_FILTER_STEPS)(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_4800_re[step]);
                 sample.re = (v*(int32_t) s->agc_scaling) >> 15;
-                v = vec_circular_dot_prodi16(s->rrc_filter, rx_pulseshaper_4800_im[step], V27TER_RX_FILTER_STEPS, s->rrc_filter_step);
+                v = FIR_KERNEL_DOT_PRODI16(V27TER_RX_4800_FILTER_STEPS)(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_4800_im[step]);
                 sample.im = (v*(int32_t) s->agc_scaling) >> 15;
                 z = dds_lookup_complexi16(s->carrier_phase);
                 zz.re = ((int32_t) sample.re*z.re - (int32_t) sample.im*z.im) >> 15;
                 zz.im = ((int32_t) -sample.re*z.im - (int32_t) sample.im*z.re) >> 15;
 #else
-                v = vec_circular_dot_prodf(s->rrc_filter, rx_pulseshaper_4800_re[step], V27TER_RX_FILTER_STEPS, s->rrc_filter_step);
+                v = FIR_KERNEL_DOT_PRODF(V27TER_RX_4800_FILTER_STEPS)(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_4800_re[step]);
                 sample.re = v*s->agc_scaling;
-                v = vec_circular_dot_prodf(s->rrc_filter, rx_pulseshaper_4800_im[step], V27TER_RX_FILTER_STEPS, s->rrc_filter_step);
+                v = FIR_KERNEL_DOT_PRODF(V27TER_RX_4800_FILTER_STEPS)(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_4800_im[step]);
                 sample.im = v*s->agc_scaling;
                 z = dds_lookup_complexf(s->carrier_phase);
                 zz.re = sample.re*z.re - sample.im*z.im;
@@ -927,6 +929,7 @@ SPAN_DECLARE_NONSTD(int) v27ter_rx(v27ter_rx_state_t *s, const int16_t amp[], in
         for (i = 0;  i < len;  i++)
         {
             s->rrc_filter[s->rrc_filter_step] = amp[i];
+            s->rrc_filter[s->rrc_filter_step + V27TER_RX_2400_FILTER_STEPS] = amp[i];
             if (++s->rrc_filter_step >= V27TER_RX_2400_FILTER_STEPS)
                 s->rrc_filter_step = 0;
 
@@ -958,17 +961,17 @@ SPAN_DECLARE_NONSTD(int) v27ter_rx(v27ter_rx_state_t *s, const int16_t amp[], in
                 if (step > RX_PULSESHAPER_2400_COEFF_SETS - 1)
                     step = RX_PULSESHAPER_2400_COEFF_SETS - 1;
 #if defined(SPANDSP_USE_FIXED_POINT)
-                v = vec_circular_dot_prodi16(s->rrc_filter, rx_pulseshaper_2400_re[step], V27TER_RX_FILTER_STEPS, s->rrc_filter_step);
+                v = FIR_KERNEL_DOT_PRODI16(V27TER_RX_2400_FILTER_STEPS)(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_2400_re[step]);
                 sample.re = (v*(int32_t) s->agc_scaling) >> 15;
-                v = vec_circular_dot_prodi16(s->rrc_filter, rx_pulseshaper_2400_im[step], V27TER_RX_FILTER_STEPS, s->rrc_filter_step);
+                v = FIR_KERNEL_DOT_PRODI16(V27TER_RX_2400_FILTER_STEPS)(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_2400_im[step]);
                 sample.im = (v*(int32_t) s->agc_scaling) >> 15;
                 z = dds_lookup_complexi16(s->carrier_phase);
                 zz.re = ((int32_t) sample.re*z.re - (int32_t) sample.im*(int32_t) z.im) >> 15;
                 zz.im = ((int32_t) -sample.re*z.im - (int32_t) sample.im*(int32_t) z.re) >> 15;
 #else
-                v = vec_circular_dot_prodf(s->rrc_filter, rx_pulseshaper_2400_re[step], V27TER_RX_FILTER_STEPS, s->rrc_filter_step);
+                v = FIR_KERNEL_DOT_PRODF(V27TER_RX_2400_FILTER_STEPS)(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_2400_re[step]);
                 sample.re = v*s->agc_scaling;
-                v = vec_circular_dot_prodf(s->rrc_filter, rx_pulseshaper_2400_im[step], V27TER_RX_FILTER_STEPS, s->rrc_filter_step);
+                v = FIR_KERNEL_DOT_PRODF(V27TER_RX_2400_FILTER_STEPS)(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_2400_im[step]);
                 sample.im = v*s->agc_scaling;
                 z = dds_lookup_complexf(s->carrier_phase);
                 zz.re = sample.re*z.re - sample.im*z.im;
@@ -250,16 +250,70 @@ static complexf_t getbaud(v27ter_tx_state_t *s)
 }
 /*- End of function --------------------------------------------------------*/
 
+#if !defined(SPANDSP_USE_FIXED_POINT)
+static void make_tx_pulses(v27ter_tx_state_t *s)
+{
+    complexf_t z;
+    float coeff;
+    int baud_inc;
+    int baud_den;
+    int start;
+    int phase;
+    int step;
+    int i;
+
+    /* A symbol enters the pulse shaper when the baud phase wraps, and passes along
+       it one step per baud. Follow that path, sample by sample, from each possible
+       starting baud phase, and fold in the carrier's progress since the symbol's
+       first sample. The transmitted signal is then just the sum of these pulses,
+       each scaled by its symbol rotated to the carrier phase of its first sample.
+       At 4800bps a symbol always starts at baud phase 0. At 2400bps it may start at
+       phase 0, 1 or 2. */
+    baud_inc = (s->bit_rate == 4800)  ?  1  :  3;
+    baud_den = (s->bit_rate == 4800)  ?  5  :  20;
+    for (start = 0;  start < baud_inc;  start++)
+    {
+        phase = start;
+        step = V27TER_TX_FILTER_STEPS - 1;
+        for (i = 0;  i < V27TER_TX_PULSE_LEN_2400;  i++)
+        {
+            if (step < 0)
+                coeff = 0.0f;
+            else if (s->bit_rate == 4800)
+                coeff = tx_pulseshaper_4800[TX_PULSESHAPER_4800_COEFF_SETS - 1 - phase][step];
+            else
+                coeff = tx_pulseshaper_2400[TX_PULSESHAPER_2400_COEFF_SETS - 1 - phase][step];
+            z = dds_lookup_complexf((uint32_t) i*(uint32_t) s->carrier_phase_rate);
+            s->pulse_re[start][i] = coeff*z.re;
+            s->pulse_im[start][i] = -coeff*z.im;
+            if ((phase += baud_inc) >= baud_den)
+            {
+                phase -= baud_den;
+                step--;
+            }
+        }
+    }
+}
+/*- End of function --------------------------------------------------------*/
+#endif
+
 SPAN_DECLARE_NONSTD(int) v27ter_tx(v27ter_tx_state_t *s, int16_t amp[], int len)
 {
 #if defined(SPANDSP_USE_FIXED_POINT)
     complexi_t x;
     complexi_t z;
+    int i;
 #else
-    complexf_t x;
+    complexf_t v;
     complexf_t z;
+    uint32_t phase;
+    float gain;
+    int baud_inc;
+    int baud_den;
+    int pulse_len;
+    int chunk;
+    int k;
 #endif
-    int i;
     int sample;
 
     if (s->training_step >= V27TER_TRAINING_SHUTDOWN_END)
@@ -267,6 +321,7 @@ SPAN_DECLARE_NONSTD(int) v27ter_tx(v27ter_tx_state_t *s, int16_t amp[], int len)
         /* Once we have sent the shutdown symbols, we stop sending completely. */
         return 0;
     }
+#if defined(SPANDSP_USE_FIXED_POINT)
     /* The symbol rates for the two bit rates are different. This makes it difficult to
        merge both generation procedures into a single efficient loop. We do not bother
        trying. We use two independent loops, filter coefficients, etc. */
@@ -283,7 +338,6 @@ SPAN_DECLARE_NONSTD(int) v27ter_tx(v27ter_tx_state_t *s, int16_t amp[], int len)
                     s->rrc_filter_step = 0;
             }
             /* Root raised cosine pulse shaping at baseband */
-#if defined(SPANDSP_USE_FIXED_POINT)
             x = complex_seti(0, 0);
             for (i = 0;  i < V27TER_TX_FILTER_STEPS;  i++)
             {
@@ -297,18 +351,6 @@ SPAN_DECLARE_NONSTD(int) v27ter_tx(v27ter_tx_state_t *s, int16_t amp[], int len)
             /* Don't bother saturating. We should never clip. */
             i = (x.re*z.re - x.im*z.im) >> 15;
             amp[sample] = (int16_t) ((i*s->gain_4800) >> 15);
-#else
-            x = complex_setf(0.0f, 0.0f);
-            for (i = 0;  i < V27TER_TX_FILTER_STEPS;  i++)
-            {
-                x.re += tx_pulseshaper_4800[TX_PULSESHAPER_4800_COEFF_SETS - 1 - s->baud_phase][i]*s->rrc_filter[i + s->rrc_filter_step].re;
-                x.im += tx_pulseshaper_4800[TX_PULSESHAPER_4800_COEFF_SETS - 1 - s->baud_phase][i]*s->rrc_filter[i + s->rrc_filter_step].im;
-            }
-            /* Now create and modulate the carrier */
-            z = dds_complexf(&s->carrier_phase, s->carrier_phase_rate);
-            /* Don't bother saturating. We should never clip. */
-            amp[sample] = (int16_t) lfastrintf((x.re*z.re - x.im*z.im)*s->gain_4800);
-#endif
         }
     }
     else
@@ -324,7 +366,6 @@ SPAN_DECLARE_NONSTD(int) v27ter_tx(v27ter_tx_state_t *s, int16_t amp[], int len)
                     s->rrc_filter_step = 0;
             }
             /* Root raised cosine pulse shaping at baseband */
-#if defined(SPANDSP_USE_FIXED_POINT)
             x = complex_seti(0, 0);
             for (i = 0;  i < V27TER_TX_FILTER_STEPS;  i++)
             {
@@ -338,20 +379,51 @@ SPAN_DECLARE_NONSTD(int) v27ter_tx(v27ter_tx_state_t *s, int16_t amp[], int len)
             /* Don't bother saturating. We should never clip. */
             i = (x.re*z.re - x.im*z.im) >> 15;
             amp[sample] = (int16_t) ((i*s->gain_2400) >> 15);
+        }
+    }
 #else
-            x = complex_setf(0.0f, 0.0f);
-            for (i = 0;  i < V27TER_TX_FILTER_STEPS;  i++)
+    /* Rather than filtering and modulating every sample, add the precomputed modulated
+       pulse of each symbol into a block of output, as the symbol arrives. The symbol
+       rates for the two bit rates differ, but this only affects the baud timing. */
+    if (s->bit_rate == 4800)
+    {
+        baud_inc = 1;
+        baud_den = 5;
+        pulse_len = V27TER_TX_PULSE_LEN_4800;
+        gain = s->gain_4800;
+    }
+    else
+    {
+        baud_inc = 3;
+        baud_den = 20;
+        pulse_len = V27TER_TX_PULSE_LEN_2400;
+        gain = s->gain_2400;
+    }
+    for (sample = 0;  sample < len;  sample += chunk)
+    {
+        chunk = (len - sample < V27TER_TX_BLOCK_LEN)  ?  (len - sample)  :  V27TER_TX_BLOCK_LEN;
+        phase = s->carrier_phase;
+        for (k = 0;  k < chunk;  k++)
+        {
+            if ((s->baud_phase += baud_inc) >= baud_den)
             {
-                x.re += tx_pulseshaper_2400[TX_PULSESHAPER_2400_COEFF_SETS - 1 - s->baud_phase][i]*s->rrc_filter[i + s->rrc_filter_step].re;
-                x.im += tx_pulseshaper_2400[TX_PULSESHAPER_2400_COEFF_SETS - 1 - s->baud_phase][i]*s->rrc_filter[i + s->rrc_filter_step].im;
+                s->baud_phase -= baud_den;
+                v = getbaud(s);
+                z = dds_lookup_complexf(phase);
+                z = complex_mulf(&v, &z);
+                vec_scaledy_addf(&s->synth[k], &s->synth[k], s->pulse_re[s->baud_phase], z.re, pulse_len);
+                vec_scaledy_addf(&s->synth[k], &s->synth[k], s->pulse_im[s->baud_phase], z.im, pulse_len);
             }
-            /* Now create and modulate the carrier */
-            z = dds_complexf(&s->carrier_phase, s->carrier_phase_rate);
-            /* Don't bother saturating. We should never clip. */
-            amp[sample] = (int16_t) lfastrintf((x.re*z.re - x.im*z.im)*s->gain_2400);
-#endif
+            phase += s->carrier_phase_rate;
         }
+        s->carrier_phase = phase;
+        /* Don't bother saturating. We should never clip. */
+        for (k = 0;  k < chunk;  k++)
+            amp[sample + k] = (int16_t) lfastrintf(s->synth[k]*gain);
+        memmove(s->synth, &s->synth[chunk], pulse_len*sizeof(s->synth[0]));
+        vec_zerof(&s->synth[pulse_len], chunk);
     }
+#endif
     return sample;
 }
 /*- End of function --------------------------------------------------------*/
@@ -401,7 +473,8 @@ SPAN_DECLARE(int) v27ter_tx_restart(v27ter_tx_state_t *s, int bit_rate, int tep)
 #if defined(SPANDSP_USE_FIXED_POINT)
     cvec_zeroi16(s->rrc_filter, sizeof(s->rrc_filter)/sizeof(s->rrc_filter[0]));
 #else
-    cvec_zerof(s->rrc_filter, sizeof(s->rrc_filter)/sizeof(s->rrc_filter[0]));
+    make_tx_pulses(s);
+    vec_zerof(s->synth, sizeof(s->synth)/sizeof(s->synth[0]));
 #endif
     s->rrc_filter_step = 0;
     s->scramble_reg = 0x3C;
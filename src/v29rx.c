@@ -76,6 +76,7 @@
 #else
 #include "v29rx_floating_rrc.h"
 #endif
+#include "fir_kernels.h"
 
 /*! The nominal frequency of the carrier, in Hertz */
 #define CARRIER_NOMINAL_FREQ            1700.0f
@@ -947,6 +948,7 @@ SPAN_DECLARE_NONSTD(int) v29_rx(v29_rx_state_t *s, const int16_t amp[], int len)
     for (i = 0;  i < len;  i++)
     {
         s->rrc_filter[s->rrc_filter_step] = amp[i];
+        s->rrc_filter[s->rrc_filter_step + V29_RX_FILTER_STEPS] = amp[i];
         if (++s->rrc_filter_step >= V29_RX_FILTER_STEPS)
             s->rrc_filter_step = 0;
 
@@ -963,10 +965,10 @@ SPAN_DECLARE_NONSTD(int) v29_rx(v29_rx_state_t *s, const int16_t amp[], int len)
         if (step < 0)
             step += RX_PULSESHAPER_COEFF_SETS;
 #if defined(SPANDSP_USE_FIXED_POINT)
-        v = vec_circular_dot_prodi16(s->rrc_filter, rx_pulseshaper_re[step], V29_RX_FILTER_STEPS, s->rrc_filter_step);
+        v = FIR_KERNEL_DOT_PRODI16(V29_RX_FILTER_STEPS)(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_re[step]);
         sample.re = (v*s->agc_scaling) >> 15;
 #else
-        v = vec_circular_dot_prodf(s->rrc_filter, rx_pulseshaper_re[step], V29_RX_FILTER_STEPS, s->rrc_filter_step);
+        v = FIR_KERNEL_DOT_PRODF(V29_RX_FILTER_STEPS)(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_re[step]);
         sample.re = v*s->agc_scaling;
 #endif
 
@@ -1016,13 +1018,13 @@ SPAN_DECLARE_NONSTD(int) v29_rx(v29_rx_state_t *s, const int16_t amp[], int len)
                No further filtering, to remove mixer harmonics, is needed. */
             s->eq_put_step += RX_PULSESHAPER_COEFF_SETS*10/(3*2);
 #if defined(SPANDSP_USE_FIXED_POINT)
-            v = vec_circular_dot_prodi16(s->rrc_filter, rx_pulseshaper_im[step], V29_RX_FILTER_STEPS, s->rrc_filter_step);
+            v = FIR_KERNEL_DOT_PRODI16(V29_RX_FILTER_STEPS)(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_im[step]);
             sample.im = (v*s->agc_scaling) >> 15;
             z = dds_lookup_complexi16(s->carrier_phase);
             zz.re = ((int32_t) sample.re*z.re - (int32_t) sample.im*z.im) >> 15;
             zz.im = ((int32_t) -sample.re*z.im - (int32_t) sample.im*z.re) >> 15;
 #else
-            v = vec_circular_dot_prodf(s->rrc_filter, rx_pulseshaper_im[step], V29_RX_FILTER_STEPS, s->rrc_filter_step);
+            v = FIR_KERNEL_DOT_PRODF(V29_RX_FILTER_STEPS)(&s->rrc_filter[s->rrc_filter_step], rx_pulseshaper_im[step]);
             sample.im = v*s->agc_scaling;
             z = dds_lookup_complexf(s->carrier_phase);
             zz.re = sample.re*z.re - sample.im*z.im;
@@ -42,45 +42,23 @@
 #include <assert.h>
 
 #include "floating_fudge.h"
-#include "mmx_sse_decs.h"
+#include "simd.h"
 
 #include "spandsp/telephony.h"
 #include "spandsp/vector_float.h"
 
-#if defined(__GNUC__)  &&  defined(SPANDSP_USE_SSE2)
-SPAN_DECLARE(void) vec_copyf(float z[], const float x[], int n)
-{
-    int i;
-    __m128 n1;
-
-    if ((i = n & ~3))
-    {
-        for (i -= 4;  i >= 0;  i -= 4)
-        {
-            n1 = _mm_loadu_ps(x + i);
-            _mm_storeu_ps(z + i, n1);
-        }
-    }
-    /* Now deal with the last 1 to 3 elements, which don't fill an SSE2 register */
-    switch (n & 3)
-    {
-    case 3:
-        z[n - 3] = x[n - 3];
-    case 2:
-        z[n - 2] = x[n - 2];
-    case 1:
-        z[n - 1] = x[n - 1];
-    }
-}
-#else
 SPAN_DECLARE(void) vec_copyf(float z[], const float x[], int n)
 {
     int i;
 
-    for (i = 0;  i < n;  i++)
+    for (i = 0;  i <= n - SIMD_F32_LANES;  i += SIMD_F32_LANES)
+        simd_storeu_f32(&z[i], simd_loadu_f32(&x[i]));
+    /*endfor*/
+    /* Now deal with any elements which don't fill a register */
+    for (  ;  i < n;  i++)
         z[i] = x[i];
+    /*endfor*/
 }
-#endif
 /*- End of function --------------------------------------------------------*/
 
 SPAN_DECLARE(void) vec_copy(double z[], const double x[], int n)
@@ -103,45 +81,18 @@ SPAN_DECLARE(void) vec_copyl(long double z[], const long double x[], int n)
 /*- End of function --------------------------------------------------------*/
 #endif
 
-#if defined(__GNUC__)  &&  defined(SPANDSP_USE_SSE2)
-SPAN_DECLARE(void) vec_negatef(float z[], const float x[], int n)
-{
-    int i;
-    static const uint32_t mask = 0x80000000;
-    static const float *fmask = (float *) &mask;
-    __m128 n1;
-    __m128 n2;
-
-    if ((i = n & ~3))
-    {
-        n2 = _mm_set1_ps(*fmask);
-        for (i -= 4;  i >= 0;  i -= 4)
-        {
-            n1 = _mm_loadu_ps(x + i);
-            n1 = _mm_xor_ps(n1, n2);
-            _mm_storeu_ps(z + i, n1);
-        }
-    }
-    /* Now deal with the last 1 to 3 elements, which don't fill an SSE2 register */
-    switch (n & 3)
-    {
-    case 3:
-        z[n - 3] = -x[n - 3];
-    case 2:
-        z[n - 2] = -x[n - 2];
-    case 1:
-        z[n - 1] = -x[n - 1];
-    }
-}
-#else
 SPAN_DECLARE(void) vec_negatef(float z[], const float x[], int n)
 {
     int i;
 
-    for (i = 0;  i < n;  i++)
+    for (i = 0;  i <= n - SIMD_F32_LANES;  i += SIMD_F32_LANES)
+        simd_storeu_f32(&z[i], simd_neg_f32(simd_loadu_f32(&x[i])));
+    /*endfor*/
+    /* Now deal with any elements which don't fill a register */
+    for (  ;  i < n;  i++)
         z[i] = -x[i];
+    /*endfor*/
 }
-#endif
 /*- End of function --------------------------------------------------------*/
 
 SPAN_DECLARE(void) vec_negate(double z[], const double x[], int n)
@@ -164,38 +115,20 @@ SPAN_DECLARE(void) vec_negatel(long double z[], const long double x[], int n)
 /*- End of function --------------------------------------------------------*/
 #endif
 
-#if defined(__GNUC__)  &&  defined(SPANDSP_USE_SSE2)
-SPAN_DECLARE(void) vec_zerof(float z[], int n)
-{
-    int i;
-    __m128 n1;
-
-    if ((i = n & ~3))
-    {
-        n1 = _mm_setzero_ps();
-        for (i -= 4;  i >= 0;  i -= 4)
-            _mm_storeu_ps(z + i, n1);
-    }
-    /* Now deal with the last 1 to 3 elements, which don't fill an SSE2 register */
-    switch (n & 3)
-    {
-    case 3:
-        z[n - 3] = 0;
-    case 2:
-        z[n - 2] = 0;
-    case 1:
-        z[n - 1] = 0;
-    }
-}
-#else
 SPAN_DECLARE(void) vec_zerof(float z[], int n)
 {
     int i;
+    simd_f32_t zero;
 
-    for (i = 0;  i < n;  i++)
+    zero = simd_zero_f32();
+    for (i = 0;  i <= n - SIMD_F32_LANES;  i += SIMD_F32_LANES)
+        simd_storeu_f32(&z[i], zero);
+    /*endfor*/
+    /* Now deal with any elements which don't fill a register */
+    for (  ;  i < n;  i++)
         z[i] = 0.0f;
+    /*endfor*/
 }
-#endif
 /*- End of function --------------------------------------------------------*/
 
 SPAN_DECLARE(void) vec_zero(double z[], int n)
@@ -218,38 +151,20 @@ SPAN_DECLARE(void) vec_zerol(long double z[], int n)
 /*- End of function --------------------------------------------------------*/
 #endif
 
-#if defined(__GNUC__)  &&  defined(SPANDSP_USE_SSE2)
-SPAN_DECLARE(void) vec_setf(float z[], float x, int n)
-{
-    int i;
-    __m128 n1;
-
-    if ((i = n & ~3))
-    {
-        n1 = _mm_set1_ps(x);
-        for (i -= 4;  i >= 0;  i -= 4)
-            _mm_storeu_ps(z + i, n1);
-    }
-    /* Now deal with the last 1 to 3 elements, which don't fill an SSE2 register */
-    switch (n & 3)
-    {
-    case 3:
-        z[n - 3] = x;
-    case 2:
-        z[n - 2] = x;
-    case 1:
-        z[n - 1] = x;
-    }
-}
-#else
 SPAN_DECLARE(void) vec_setf(float z[], float x, int n)
 {
     int i;
+    simd_f32_t xx;
 
-    for (i = 0;  i < n;  i++)
+    xx = simd_set1_f32(x);
+    for (i = 0;  i <= n - SIMD_F32_LANES;  i += SIMD_F32_LANES)
+        simd_storeu_f32(&z[i], xx);
+    /*endfor*/
+    /* Now deal with any elements which don't fill a register */
+    for (  ;  i < n;  i++)
         z[i] = x;
+    /*endfor*/
 }
-#endif
 /*- End of function --------------------------------------------------------*/
 
 SPAN_DECLARE(void) vec_set(double z[], double x, int n)
@@ -272,43 +187,18 @@ SPAN_DECLARE(void) vec_setl(long double z[], long double x, int n)
 /*- End of function --------------------------------------------------------*/
 #endif
 
-#if defined(__GNUC__)  &&  defined(SPANDSP_USE_SSE2)
-SPAN_DECLARE(void) vec_addf(float z[], const float x[], const float y[], int n)
-{
-    int i;
-    __m128 n1;
-    __m128 n2;
-
-    if ((i = n & ~3))
-    {
-        for (i -= 4;  i >= 0;  i -= 4)
-        {
-            n1 = _mm_loadu_ps(x + i);
-            n2 = _mm_loadu_ps(y + i);
-            n2 = _mm_add_ps(n1, n2);
-            _mm_storeu_ps(z + i, n2);
-        }
-    }
-    /* Now deal with the last 1 to 3 elements, which don't fill an SSE2 register */
-    switch (n & 3)
-    {
-    case 3:
-        z[n - 3] = x[n - 3] + y[n - 3];
-    case 2:
-        z[n - 2] = x[n - 2] + y[n - 2];
-    case 1:
-        z[n - 1] = x[n - 1] + y[n - 1];
-    }
-}
-#else
 SPAN_DECLARE(void) vec_addf(float z[], const float x[], const float y[], int n)
 {
     int i;
 
-    for (i = 0;  i < n;  i++)
+    for (i = 0;  i <= n - SIMD_F32_LANES;  i += SIMD_F32_LANES)
+        simd_storeu_f32(&z[i], simd_add_f32(simd_loadu_f32(&x[i]), simd_loadu_f32(&y[i])));
+    /*endfor*/
+    /* Now deal with any elements which don't fill a register */
+    for (  ;  i < n;  i++)
         z[i] = x[i] + y[i];
+    /*endfor*/
 }
-#endif
 /*- End of function --------------------------------------------------------*/
 
 SPAN_DECLARE(void) vec_add(double z[], const double x[], const double y[], int n)
@@ -331,49 +221,22 @@ SPAN_DECLARE(void) vec_addl(long double z[], const long double x[], const long d
 /*- End of function --------------------------------------------------------*/
 #endif
 
-#if defined(__GNUC__)  &&  defined(SPANDSP_USE_SSE2)
-SPAN_DECLARE(void) vec_scaledxy_addf(float z[], const float x[], float x_scale, const float y[], float y_scale, int n)
-{
-    int i;
-    __m128 n1;
-    __m128 n2;
-    __m128 n3;
-    __m128 n4;
-
-    if ((i = n & ~3))
-    {
-        n3 = _mm_set1_ps(x_scale);
-        n4 = _mm_set1_ps(y_scale);
-        for (i -= 4;  i >= 0;  i -= 4)
-        {
-            n1 = _mm_loadu_ps(x + i);
-            n2 = _mm_loadu_ps(y + i);
-            n1 = _mm_mul_ps(n1, n3);
-            n2 = _mm_mul_ps(n2, n4);
-            n2 = _mm_add_ps(n1, n2);
-            _mm_storeu_ps(z + i, n2);
-        }
-    }
-    /* Now deal with the last 1 to 3 elements, which don't fill an SSE2 register */
-    switch (n & 3)
-    {
-    case 3:
-        z[n - 3] = x[n - 3]*x_scale + y[n - 3]*y_scale;
-    case 2:
-        z[n - 2] = x[n - 2]*x_scale + y[n - 2]*y_scale;
-    case 1:
-        z[n - 1] = x[n - 1]*x_scale + y[n - 1]*y_scale;
-    }
-}
-#else
 SPAN_DECLARE(void) vec_scaledxy_addf(float z[], const float x[], float x_scale, const float y[], float y_scale, int n)
 {
     int i;
+    simd_f32_t xs;
+    simd_f32_t ys;
 
-    for (i = 0;  i < n;  i++)
+    xs = simd_set1_f32(x_scale);
+    ys = simd_set1_f32(y_scale);
+    for (i = 0;  i <= n - SIMD_F32_LANES;  i += SIMD_F32_LANES)
+        simd_storeu_f32(&z[i], simd_add_f32(simd_mul_f32(simd_loadu_f32(&x[i]), xs), simd_mul_f32(simd_loadu_f32(&y[i]), ys)));
+    /*endfor*/
+    /* Now deal with any elements which don't fill a register */
+    for (  ;  i < n;  i++)
         z[i] = x[i]*x_scale + y[i]*y_scale;
+    /*endfor*/
 }
-#endif
 /*- End of function --------------------------------------------------------*/
 
 SPAN_DECLARE(void) vec_scaledxy_add(double z[], const double x[], double x_scale, const double y[], double y_scale, int n)
@@ -396,46 +259,20 @@ SPAN_DECLARE(void) vec_scaledxy_addl(long double z[], const long double x[], lon
 /*- End of function --------------------------------------------------------*/
 #endif
 
-#if defined(__GNUC__)  &&  defined(SPANDSP_USE_SSE2)
-SPAN_DECLARE(void) vec_scaledy_addf(float z[], const float x[], const float y[], float y_scale, int n)
-{
-    int i;
-    __m128 n1;
-    __m128 n2;
-    __m128 n3;
-
-    if ((i = n & ~3))
-    {
-        n3 = _mm_set1_ps(y_scale);
-        for (i -= 4;  i >= 0;  i -= 4)
-        {
-            n1 = _mm_loadu_ps(x + i);
-            n2 = _mm_loadu_ps(y + i);
-            n2 = _mm_mul_ps(n2, n3);
-            n2 = _mm_add_ps(n1, n2);
-            _mm_storeu_ps(z + i, n2);
-        }
-    }
-    /* Now deal with the last 1 to 3 elements, which don't fill an SSE2 register */
-    switch (n & 3)
-    {
-    case 3:
-        z[n - 3] = x[n - 3] + y[n - 3]*y_scale;
-    case 2:
-        z[n - 2] = x[n - 2] + y[n - 2]*y_scale;
-    case 1:
-        z[n - 1] = x[n - 1] + y[n - 1]*y_scale;
-    }
-}
-#else
 SPAN_DECLARE(void) vec_scaledy_addf(float z[], const float x[], const float y[], float y_scale, int n)
 {
     int i;
+    simd_f32_t ys;
 
-    for (i = 0;  i < n;  i++)
+    ys = simd_set1_f32(y_scale);
+    for (i = 0;  i <= n - SIMD_F32_LANES;  i += SIMD_F32_LANES)
+        simd_storeu_f32(&z[i], simd_add_f32(simd_loadu_f32(&x[i]), simd_mul_f32(simd_loadu_f32(&y[i]), ys)));
+    /*endfor*/
+    /* Now deal with any elements which don't fill a register */
+    for (  ;  i < n;  i++)
         z[i] = x[i] + y[i]*y_scale;
+    /*endfor*/
 }
-#endif
 /*- End of function --------------------------------------------------------*/
 
 SPAN_DECLARE(void) vec_scaledy_add(double z[], const double x[], const double y[], double y_scale, int n)
@@ -458,43 +295,18 @@ SPAN_DECLARE(void) vec_scaledy_addl(long double z[], const long double x[], cons
 /*- End of function --------------------------------------------------------*/
 #endif
 
-#if defined(__GNUC__)  &&  defined(SPANDSP_USE_SSE2)
-SPAN_DECLARE(void) vec_subf(float z[], const float x[], const float y[], int n)
-{
-    int i;
-    __m128 n1;
-    __m128 n2;
-
-    if ((i = n & ~3))
-    {
-        for (i -= 4;  i >= 0;  i -= 4)
-        {
-            n1 = _mm_loadu_ps(x + i);
-            n2 = _mm_loadu_ps(y + i);
-            n2 = _mm_sub_ps(n1, n2);
-            _mm_storeu_ps(z + i, n2);
-        }
-    }
-    /* Now deal with the last 1 to 3 elements, which don't fill an SSE2 register */
-    switch (n & 3)
-    {
-    case 3:
-        z[n - 3] = x[n - 3] - y[n - 3];
-    case 2:
-        z[n - 2] = x[n - 2] - y[n - 2];
-    case 1:
-        z[n - 1] = x[n - 1] - y[n - 1];
-    }
-}
-#else
 SPAN_DECLARE(void) vec_subf(float z[], const float x[], const float y[], int n)
 {
     int i;
 
-    for (i = 0;  i < n;  i++)
+    for (i = 0;  i <= n - SIMD_F32_LANES;  i += SIMD_F32_LANES)
+        simd_storeu_f32(&z[i], simd_sub_f32(simd_loadu_f32(&x[i]), simd_loadu_f32(&y[i])));
+    /*endfor*/
+    /* Now deal with any elements which don't fill a register */
+    for (  ;  i < n;  i++)
         z[i] = x[i] - y[i];
+    /*endfor*/
 }
-#endif
 /*- End of function --------------------------------------------------------*/
 
 SPAN_DECLARE(void) vec_sub(double z[], const double x[], const double y[], int n)
@@ -546,43 +358,20 @@ SPAN_DECLARE(void) vec_scaledxy_subl(long double z[], const long double x[], lon
 /*- End of function --------------------------------------------------------*/
 #endif
 
-#if defined(__GNUC__)  &&  defined(SPANDSP_USE_SSE2)
-SPAN_DECLARE(void) vec_scalar_mulf(float z[], const float x[], float y, int n)
-{
-    int i;
-    __m128 n1;
-    __m128 n2;
-
-    if ((i = n & ~3))
-    {
-        n2 = _mm_set1_ps(y);
-        for (i -= 4;  i >= 0;  i -= 4)
-        {
-            n1 = _mm_loadu_ps(x + i);
-            n1 = _mm_mul_ps(n1, n2);
-            _mm_storeu_ps(z + i, n1);
-        }
-    }
-    /* Now deal with the last 1 to 3 elements, which don't fill an SSE2 register */
-    switch (n & 3)
-    {
-    case 3:
-        z[n - 3] = x[n - 3]*y;
-    case 2:
-        z[n - 2] = x[n - 2]*y;
-    case 1:
-        z[n - 1] = x[n - 1]*y;
-    }
-}
-#else
 SPAN_DECLARE(void) vec_scalar_mulf(float z[], const float x[], float y, int n)
 {
     int i;
+    simd_f32_t yy;
 
-    for (i = 0;  i < n;  i++)
+    yy = simd_set1_f32(y);
+    for (i = 0;  i <= n - SIMD_F32_LANES;  i += SIMD_F32_LANES)
+        simd_storeu_f32(&z[i], simd_mul_f32(simd_loadu_f32(&x[i]), yy));
+    /*endfor*/
+    /* Now deal with any elements which don't fill a register */
+    for (  ;  i < n;  i++)
         z[i] = x[i]*y;
+    /*endfor*/
 }
-#endif
 /*- End of function --------------------------------------------------------*/
 
 SPAN_DECLARE(void) vec_scalar_mul(double z[], const double x[], double y, int n)
@@ -594,43 +383,20 @@ SPAN_DECLARE(void) vec_scalar_mul(double z[], const double x[], double y, int n)
 }
 /*- End of function --------------------------------------------------------*/
 
-#if defined(__GNUC__)  &&  defined(SPANDSP_USE_SSE2)
-SPAN_DECLARE(void) vec_scalar_addf(float z[], const float x[], float y, int n)
-{
-    int i;
-    __m128 n1;
-    __m128 n2;
-
-    if ((i = n & ~3))
-    {
-        n2 = _mm_set1_ps(y);
-        for (i -= 4;  i >= 0;  i -= 4)
-        {
-            n1 = _mm_loadu_ps(x + i);
-            n1 = _mm_add_ps(n1, n2);
-            _mm_storeu_ps(z + i, n1);
-        }
-    }
-    /* Now deal with the last 1 to 3 elements, which don't fill an SSE2 register */
-    switch (n & 3)
-    {
-    case 3:
-        z[n - 3] = x[n - 3] + y;
-    case 2:
-        z[n - 2] = x[n - 2] + y;
-    case 1:
-        z[n - 1] = x[n - 1] + y;
-    }
-}
-#else
 SPAN_DECLARE(void) vec_scalar_addf(float z[], const float x[], float y, int n)
 {
     int i;
+    simd_f32_t yy;
 
-    for (i = 0;  i < n;  i++)
+    yy = simd_set1_f32(y);
+    for (i = 0;  i <= n - SIMD_F32_LANES;  i += SIMD_F32_LANES)
+        simd_storeu_f32(&z[i], simd_add_f32(simd_loadu_f32(&x[i]), yy));
+    /*endfor*/
+    /* Now deal with any elements which don't fill a register */
+    for (  ;  i < n;  i++)
         z[i] = x[i] + y;
+    /*endfor*/
 }
-#endif
 /*- End of function --------------------------------------------------------*/
 
 SPAN_DECLARE(void) vec_scalar_add(double z[], const double x[], double y, int n)
@@ -653,43 +419,20 @@ SPAN_DECLARE(void) vec_scalar_addl(long double z[], const long double x[], long
 /*- End of function --------------------------------------------------------*/
 #endif
 
-#if defined(__GNUC__)  &&  defined(SPANDSP_USE_SSE2)
-SPAN_DECLARE(void) vec_scalar_subf(float z[], const float x[], float y, int n)
-{
-    int i;
-    __m128 n1;
-    __m128 n2;
-
-    if ((i = n & ~3))
-    {
-        n2 = _mm_set1_ps(y);
-        for (i -= 4;  i >= 0;  i -= 4)
-        {
-            n1 = _mm_loadu_ps(x + i);
-            n1 = _mm_sub_ps(n1, n2);
-            _mm_storeu_ps(z + i, n1);
-        }
-    }
-    /* Now deal with the last 1 to 3 elements, which don't fill an SSE2 register */
-    switch (n & 3)
-    {
-    case 3:
-        z[n - 3] = x[n - 3] - y;
-    case 2:
-        z[n - 2] = x[n - 2] - y;
-    case 1:
-        z[n - 1] = x[n - 1] - y;
-    }
-}
-#else
 SPAN_DECLARE(void) vec_scalar_subf(float z[], const float x[], float y, int n)
 {
     int i;
+    simd_f32_t yy;
 
-    for (i = 0;  i < n;  i++)
+    yy = simd_set1_f32(y);
+    for (i = 0;  i <= n - SIMD_F32_LANES;  i += SIMD_F32_LANES)
+        simd_storeu_f32(&z[i], simd_sub_f32(simd_loadu_f32(&x[i]), yy));
+    /*endfor*/
+    /* Now deal with any elements which don't fill a register */
+    for (  ;  i < n;  i++)
         z[i] = x[i] - y;
+    /*endfor*/
 }
-#endif
 /*- End of function --------------------------------------------------------*/
 
 SPAN_DECLARE(void) vec_scalar_sub(double z[], const double x[], double y, int n)
@@ -712,45 +455,19 @@ SPAN_DECLARE(void) vec_scalar_subl(long double z[], const long double x[], long
 /*- End of function --------------------------------------------------------*/
 #endif
 
-#if defined(__GNUC__)  &&  defined(SPANDSP_USE_SSE2)
-SPAN_DECLARE(void) vec_mulf(float z[], const float x[], const float y[], int n)
-{
-    int i;
-    __m128 n1;
-    __m128 n2;
-    __m128 n3;
-
-    if ((i = n & ~3))
-    {
-        for (i -= 4;  i >= 0;  i -= 4)
-        {
-            n1 = _mm_loadu_ps(x + i);
-            n2 = _mm_loadu_ps(y + i);
-            n3 = _mm_mul_ps(n1, n2);
-            _mm_storeu_ps(z + i, n3);
-        }
-    }
-    /* Now deal with the last 1 to 3 elements, which don't fill an SSE2 register */
-    switch (n & 3)
-    {
-    case 3:
-        z[n - 3] = x[n - 3]*y[n - 3];
-    case 2:
-        z[n - 2] = x[n - 2]*y[n - 2];
-    case 1:
-        z[n - 1] = x[n - 1]*y[n - 1];
-    }
-}
-#else
 SPAN_DECLARE(void) vec_mulf(float z[], const float x[], const float y[], int n)
 {
     int i;
 
-    for (i = 0;  i < n;  i++)
+    for (i = 0;  i <= n - SIMD_F32_LANES;  i += SIMD_F32_LANES)
+        simd_storeu_f32(&z[i], simd_mul_f32(simd_loadu_f32(&x[i]), simd_loadu_f32(&y[i])));
+    /*endfor*/
+    /* Now deal with any elements which don't fill a register */
+    for (  ;  i < n;  i++)
         z[i] = x[i]*y[i];
+    /*endfor*/
 }
 /*- End of function --------------------------------------------------------*/
-#endif
 
 SPAN_DECLARE(void) vec_mul(double z[], const double x[], const double y[], int n)
 {
@@ -772,56 +489,24 @@ SPAN_DECLARE(void) vec_mull(long double z[], const long double x[], const long d
 /*- End of function --------------------------------------------------------*/
 #endif
 
-#if defined(__GNUC__)  &&  defined(SPANDSP_USE_SSE2)
-SPAN_DECLARE(float) vec_dot_prodf(const float x[], const float y[], int n)
-{
-    int i;
-    float z;
-    __m128 n1;
-    __m128 n2;
-    __m128 n3;
-    __m128 n4;
-
-    z = 0.0f;
-    if ((i = n & ~3))
-    {
-        n4 = _mm_setzero_ps();  //sets sum to zero
-        for (i -= 4;  i >= 0;  i -= 4)
-        {
-            n1 = _mm_loadu_ps(x + i);
-            n2 = _mm_loadu_ps(y + i);
-            n3 = _mm_mul_ps(n1, n2);
-            n4 = _mm_add_ps(n4, n3);
-        }
-        n4 = _mm_add_ps(_mm_movehl_ps(n4, n4), n4);
-        n4 = _mm_add_ss(_mm_shuffle_ps(n4, n4, 1), n4);
-        _mm_store_ss(&z, n4);
-    }
-    /* Now deal with the last 1 to 3 elements, which don't fill an SSE2 register */
-    switch (n & 3)
-    {
-    case 3:
-        z += x[n - 3]*y[n - 3];
-    case 2:
-        z += x[n - 2]*y[n - 2];
-    case 1:
-        z += x[n - 1]*y[n - 1];
-    }
-    return z;
-}
-#else
 SPAN_DECLARE(float) vec_dot_prodf(const float x[], const float y[], int n)
 {
     int i;
     float z;
-
-    z = 0.0f;
-    for (i = 0;  i < n;  i++)
+    simd_f32_t acc;
+
+    acc = simd_zero_f32();
+    for (i = 0;  i <= n - SIMD_F32_LANES;  i += SIMD_F32_LANES)
+        acc = simd_add_f32(acc, simd_mul_f32(simd_loadu_f32(&x[i]), simd_loadu_f32(&y[i])));
+    /*endfor*/
+    z = simd_hsum_f32(acc);
+    /* Now deal with any elements which don't fill a register */
+    for (  ;  i < n;  i++)
         z += x[i]*y[i];
+    /*endfor*/
     return z;
 }
 /*- End of function --------------------------------------------------------*/
-#endif
 
 SPAN_DECLARE(double) vec_dot_prod(const double x[], const double y[], int n)
 {
@@ -861,52 +546,23 @@ SPAN_DECLARE(float) vec_circular_dot_prodf(const float x[], const float y[], int
 
 #define LMS_LEAK_RATE   0.9999f
 
-#if defined(__GNUC__)  &&  defined(SPANDSP_USE_SSE2)
-SPAN_DECLARE(void) vec_lmsf(const float x[], float y[], int n, float error)
-{
-    int i;
-    __m128 n1;
-    __m128 n2;
-    __m128 n3;
-    __m128 n4;
-
-    if ((i = n & ~3))
-    {
-        n3 = _mm_set1_ps(error);
-        n4 = _mm_set1_ps(LMS_LEAK_RATE);
-        for (i -= 4;  i >= 0;  i -= 4)
-        {
-            n1 = _mm_loadu_ps(x + i);
-            n2 = _mm_loadu_ps(y + i);
-            n1 = _mm_mul_ps(n1, n3);
-            n2 = _mm_mul_ps(n2, n4);
-            n1 = _mm_add_ps(n1, n2);
-            _mm_storeu_ps(y + i, n1);
-        }
-    }
-    /* Now deal with the last 1 to 3 elements, which don't fill an SSE2 register */
-    switch (n & 3)
-    {
-    case 3:
-        y[n - 3] = y[n - 3]*LMS_LEAK_RATE + x[n - 3]*error;
-    case 2:
-        y[n - 2] = y[n - 2]*LMS_LEAK_RATE + x[n - 2]*error;
-    case 1:
-        y[n - 1] = y[n - 1]*LMS_LEAK_RATE + x[n - 1]*error;
-    }
-}
-#else
 SPAN_DECLARE(void) vec_lmsf(const float x[], float y[], int n, float error)
 {
     int i;
+    simd_f32_t err;
+    simd_f32_t leak;
 
-    for (i = 0;  i < n;  i++)
-    {
-        /* Leak a little to tame uncontrolled wandering */
+    err = simd_set1_f32(error);
+    leak = simd_set1_f32(LMS_LEAK_RATE);
+    /* Leak a little to tame uncontrolled wandering */
+    for (i = 0;  i <= n - SIMD_F32_LANES;  i += SIMD_F32_LANES)
+        simd_storeu_f32(&y[i], simd_add_f32(simd_mul_f32(simd_loadu_f32(&y[i]), leak), simd_mul_f32(simd_loadu_f32(&x[i]), err)));
+    /*endfor*/
+    /* Now deal with any elements which don't fill a register */
+    for (  ;  i < n;  i++)
         y[i] = y[i]*LMS_LEAK_RATE + x[i]*error;
-    }
+    /*endfor*/
 }
-#endif
 /*- End of function --------------------------------------------------------*/
 
 SPAN_DECLARE(void) vec_circular_lmsf(const float x[], float y[], int n, int pos, float error)
@@ -40,11 +40,17 @@
 #include <assert.h>
 #include <sndfile.h>
 
+//#if defined(WITH_SPANDSP_INTERNALS)
+#define SPANDSP_EXPOSE_INTERNAL_STRUCTURES
+//#endif
+
 #include "spandsp.h"
 #include "spandsp-sim.h"
 
 #define SAMPLES_PER_CHUNK           160
 
+#define BANK_LINES                  6
+
 #define OUTPUT_FILE_NAME            "ademco_contactid.wav"
 
 #define MITEL_DIR                   "../test-data/mitel/"
@@ -82,6 +88,16 @@ int sending_complete = false;
 
 SNDFILE *outhandle;
 
+typedef struct
+{
+    ademco_contactid_sender_state_t *sender;
+    int tx_entry;
+    int rx_entry;
+    int sending_complete;
+} bank_line_t;
+
+static bank_line_t bank_line[BANK_LINES];
+
 static void talkoff_tx_callback(void *user_data, int tone, int level, int duration)
 {
     printf("Ademco sender report %d\n", tone);
@@ -274,6 +290,157 @@ static int end_to_end_tests(void)
 }
 /*- End of function --------------------------------------------------------*/
 
+static void bank_rx_callback(void *user_data, const ademco_contactid_report_t *report)
+{
+    bank_line_t *line;
+
+    line = (bank_line_t *) user_data;
+    if (line->rx_entry >= 5  ||  memcmp(&reports[line->rx_entry], report, sizeof (*report)))
+    {
+        printf("Report mismatch on line %d\n", (int) (line - bank_line));
+        exit(2);
+    }
+    line->rx_entry++;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void bank_tx_callback(void *user_data, int tone, int level, int duration)
+{
+    bank_line_t *line;
+
+    line = (bank_line_t *) user_data;
+    switch (tone)
+    {
+    case -1:
+        /* We are connected and ready to send */
+        ademco_contactid_sender_put(line->sender, &reports[line->tx_entry]);
+        break;
+    case 1:
+        /* We have succeeded in sending, and are ready to send another message. */
+        if (++line->tx_entry < 5)
+            ademco_contactid_sender_put(line->sender, &reports[line->tx_entry]);
+        else
+            line->sending_complete = true;
+        break;
+    case 0:
+        /* Sending failed after retries */
+        line->sending_complete = true;
+        break;
+    }
+}
+/*- End of function --------------------------------------------------------*/
+
+static int bank_tests(void)
+{
+    ademco_contactid_receiver_bank_state_t *bank;
+    ademco_contactid_receiver_stats_t stats;
+    ademco_contactid_receiver_state_t *receiver;
+    awgn_state_t noise_source;
+    int16_t tx_amp[BANK_LINES][SAMPLES_PER_CHUNK];
+    int16_t rx_amp[SAMPLES_PER_CHUNK];
+    const int16_t *amp[BANK_LINES];
+    void *user_data[BANK_LINES];
+    int samples;
+    int i;
+    int j;
+    int k;
+
+    printf("Receiver bank tests\n");
+
+    for (k = 0;  k < BANK_LINES;  k++)
+    {
+        memset(&bank_line[k], 0, sizeof(bank_line[k]));
+        if ((bank_line[k].sender = ademco_contactid_sender_init(NULL, bank_tx_callback, &bank_line[k])) == NULL)
+            return -1;
+        user_data[k] = &bank_line[k];
+        amp[k] = tx_amp[k];
+    }
+    if ((bank = ademco_contactid_receiver_bank_init(NULL, BANK_LINES, bank_rx_callback, user_data)) == NULL)
+        return -1;
+
+    awgn_init_dbm0(&noise_source, 1234567, -50);
+
+    for (i = 0;  i < 1000;  i++)
+    {
+        for (k = 0;  k < BANK_LINES;  k++)
+        {
+            samples = ademco_contactid_sender_tx(bank_line[k].sender, tx_amp[k], SAMPLES_PER_CHUNK);
+            for (j = samples;  j < SAMPLES_PER_CHUNK;  j++)
+                tx_amp[k][j] = 0;
+        }
+        ademco_contactid_receiver_bank_rx(bank, amp, SAMPLES_PER_CHUNK);
+
+        for (k = 0;  k < BANK_LINES;  k++)
+        {
+            receiver = ademco_contactid_receiver_bank_get_line(bank, k);
+            samples = ademco_contactid_receiver_tx(receiver, rx_amp, SAMPLES_PER_CHUNK);
+            for (j = samples;  j < SAMPLES_PER_CHUNK;  j++)
+                rx_amp[j] = 0;
+            for (j = 0;  j < SAMPLES_PER_CHUNK;  j++)
+                rx_amp[j] += awgn(&noise_source);
+            ademco_contactid_sender_rx(bank_line[k].sender, rx_amp, SAMPLES_PER_CHUNK);
+        }
+    }
+
+    for (k = 0;  k < BANK_LINES;  k++)
+    {
+        if (!bank_line[k].sending_complete  ||  bank_line[k].tx_entry != 5  ||  bank_line[k].rx_entry != 5)
+        {
+            printf("    Line %d sent %d and received %d reports\n", k, bank_line[k].tx_entry, bank_line[k].rx_entry);
+            printf("    Failed\n");
+            return -1;
+        }
+    }
+    ademco_contactid_receiver_bank_get_stats(bank, &stats);
+    printf("    %d messages, latency min %dms, max %dms, mean %dms\n",
+           stats.messages,
+           stats.min_latency/(SAMPLE_RATE/1000),
+           stats.max_latency/(SAMPLE_RATE/1000),
+           (stats.messages)  ?  (int) (stats.total_latency/stats.messages/(SAMPLE_RATE/1000))  :  0);
+    if (stats.messages != 5*BANK_LINES  ||  stats.min_latency <= 0  ||  stats.min_latency > stats.max_latency)
+    {
+        printf("    Failed\n");
+        return -1;
+    }
+    printf("    Passed\n");
+    ademco_contactid_receiver_bank_free(bank);
+    for (k = 0;  k < BANK_LINES;  k++)
+        ademco_contactid_sender_free(bank_line[k].sender);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int descriptor_tests(void)
+{
+    ademco_contactid_sender_state_t *sender;
+    goertzel_descriptor_t desc;
+
+    /* The sender's Goertzel filters are built from fixed tables, which must match what
+       make_goertzel_descriptor() gives */
+    printf("Goertzel descriptor tests\n");
+    if ((sender = ademco_contactid_sender_init(NULL, NULL, NULL)) == NULL)
+    {
+        printf("    Cannot create sender\n");
+        return -1;
+    }
+    make_goertzel_descriptor(&desc, 1400.0f, sender->tone_1400.samples);
+    if (sender->tone_1400.fac != desc.fac)
+    {
+        printf("    The 1400Hz descriptor is %.9g, rather than %.9g\n", (double) sender->tone_1400.fac, (double) desc.fac);
+        return -1;
+    }
+    make_goertzel_descriptor(&desc, 2300.0f, sender->tone_2300.samples);
+    if (sender->tone_2300.fac != desc.fac)
+    {
+        printf("    The 2300Hz descriptor is %.9g, rather than %.9g\n", (double) sender->tone_2300.fac, (double) desc.fac);
+        return -1;
+    }
+    ademco_contactid_sender_free(sender);
+    printf("    Passed\n");
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
 static int encode_decode_tests(void)
 {
     char buf[100];
@@ -365,6 +532,12 @@ int main(int argc, char *argv[])
         return 0;
     }
 
+    if (descriptor_tests())
+    {
+        printf("Tests failed\n");
+        return 2;
+    }
+
     if (encode_decode_tests())
     {
         printf("Tests failed\n");
@@ -383,6 +556,12 @@ int main(int argc, char *argv[])
         return 2;
     }
 
+    if (bank_tests())
+    {
+        printf("Tests failed\n");
+        return 2;
+    }
+
     printf("Tests passed\n");
     return 0;
 }
@@ -52,6 +52,8 @@ tests, these tests do not include line modelling.
 
 #define BLOCK_LEN                   160
 
+#define BANK_CHANNELS               8
+
 #define MITEL_DIR                   "../test-data/mitel/"
 #define BELLCORE_DIR                "../test-data/bellcore/"
 
@@ -682,6 +684,70 @@ static void basic_tests(int standard)
 }
 /*- End of function --------------------------------------------------------*/
 
+static void put_bank_adsi_msg(void *user_data, const uint8_t *msg, int len)
+{
+    (*((int *) user_data))++;
+    put_adsi_msg(NULL, msg, len);
+}
+/*- End of function --------------------------------------------------------*/
+
+static void bank_tests(int standard)
+{
+    adsi_tx_state_t *tx[BANK_CHANNELS];
+    adsi_rx_bank_state_t *rx_bank;
+    int16_t amp[BANK_CHANNELS][BLOCK_LEN];
+    const int16_t *amps[BANK_CHANNELS];
+    void *user_data[BANK_CHANNELS];
+    int messages[BANK_CHANNELS];
+    uint8_t adsi_msg[256 + 42];
+    int adsi_msg_len;
+    int len;
+    int i;
+    int j;
+
+    printf("Testing a bank of %d %s receivers\n", BANK_CHANNELS, adsi_standard_to_str(standard));
+    for (j = 0;  j < BANK_CHANNELS;  j++)
+    {
+        tx[j] = adsi_tx_init(NULL, standard);
+        messages[j] = 0;
+        user_data[j] = &messages[j];
+        amps[j] = amp[j];
+    }
+    rx_bank = adsi_rx_bank_init(NULL, standard, BANK_CHANNELS, put_bank_adsi_msg, user_data);
+    /* The message breakdown only depends on the standard, so any channel will do */
+    rx_adsi = adsi_rx_bank_get_channel(rx_bank, 0);
+    for (i = 0;  i < 2000;  i++)
+    {
+        for (j = 0;  j < BANK_CHANNELS;  j++)
+        {
+            /* Stagger the messages, so the channels are at different points in their
+               signals at any instant. */
+            if (i == 10 + 3*j)
+            {
+                adsi_msg_len = adsi_create_message(tx[j], adsi_msg);
+                adsi_tx_put_message(tx[j], adsi_msg, adsi_msg_len);
+            }
+            len = adsi_tx(tx[j], amp[j], BLOCK_LEN);
+            if (len < BLOCK_LEN)
+                memset(&amp[j][len], 0, sizeof(int16_t)*(BLOCK_LEN - len));
+        }
+        adsi_rx_bank(rx_bank, amps, BLOCK_LEN);
+    }
+    for (j = 0;  j < BANK_CHANNELS;  j++)
+    {
+        if (messages[j] != 1)
+        {
+            printf("    Channel %d received %d messages\n", j, messages[j]);
+            printf("    Failed\n");
+            exit(2);
+        }
+        adsi_tx_free(tx[j]);
+    }
+    adsi_rx_bank_free(rx_bank);
+    printf("    Passed\n");
+}
+/*- End of function --------------------------------------------------------*/
+
 static void mitel_cm7291_side_2_and_bellcore_tests(int standard)
 {
     int j;
@@ -844,7 +910,10 @@ int main(int argc, char *argv[])
         for (current_standard = first_standard;  current_standard <= last_standard;  current_standard++)
         {
             if (enable_basic_tests)
+            {
                 basic_tests(current_standard);
+                bank_tests(current_standard);
+            }
             if (enable_talkoff_tests)
                 mitel_cm7291_side_2_and_bellcore_tests(current_standard);
         }
@@ -0,0 +1,646 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * alloc_tests.c - Tests for the memory allocation functions.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2013 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \file */
+
+/*! \page alloc_tests_page Memory allocation tests
+\section alloc_tests_page_sec_1 What does it do?
+These tests allocate, resize and free many blocks of random sizes and alignments,
+with an allocation context set for part of the time, and check every block keeps
+its contents and alignment. Blocks allocated under a context must be freeable after
+the context is cleared, and the other way around.
+
+On Linux, the placement of memory allocated under a context is also checked. Many
+small blocks must not multiply the mappings in the process, as they would if each
+block were placed separately. The memory must have the preferred NUMA node policy,
+and be marked for huge pages, where the kernel supports these. Memory from the
+normal allocator must not pick up the policy.
+
+Two pages of different widths are also sent with a context set, through the T.4
+coder and decoder alone, and in a FAX call. The buffers resized for the second page
+must be resized by the allocator which allocated them.
+*/
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <tiffio.h>
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+#include "spandsp.h"
+
+#define BLOCKS              2000
+#define ROUNDS              20000
+#define SMALL_BLOCKS        1000
+
+#define SAMPLES_PER_CHUNK   160
+#define PAGE_ROWS           200
+
+#define INPUT_TIFF_FILE_NAME    "alloc_tests.tif"
+#define OUTPUT_TIFF_FILE_NAME   "alloc_tests_rx.tif"
+
+/* The kernel's get_mempolicy() parameters */
+#define MPOL_DEFAULT_MODE   0
+#define MPOL_PREFERRED_MODE 1
+#define MPOL_F_ADDR_FLAG    (1 << 1)
+
+static struct
+{
+    uint8_t *ptr;
+    size_t size;
+    size_t alignment;
+    uint8_t fill;
+} blocks[BLOCKS];
+
+static const int page_widths[2] =
+{
+    T4_WIDTH_R8_A4,
+    T4_WIDTH_R8_B4
+};
+
+static int phase_e_result[2];
+
+static void fill_block(int i)
+{
+    blocks[i].fill = (uint8_t) rand();
+    memset(blocks[i].ptr, blocks[i].fill, blocks[i].size);
+}
+/*- End of function --------------------------------------------------------*/
+
+static int check_block(int i)
+{
+    size_t j;
+
+    if (((uintptr_t) blocks[i].ptr & (blocks[i].alignment - 1)))
+    {
+        printf("    Block %d at %p is not aligned to %d\n", i, (void *) blocks[i].ptr, (int) blocks[i].alignment);
+        return -1;
+    }
+    for (j = 0;  j < blocks[i].size;  j++)
+    {
+        if (blocks[i].ptr[j] != blocks[i].fill)
+        {
+            printf("    Block %d has been overwritten at %d\n", i, (int) j);
+            return -1;
+        }
+    }
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void free_block(int i)
+{
+    if (blocks[i].alignment > 1)
+        span_aligned_free(blocks[i].ptr);
+    else
+        span_free(blocks[i].ptr);
+    blocks[i].ptr = NULL;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int new_block(int i)
+{
+    size_t size;
+
+    /* Mostly channel state sized blocks, with an occasional one bigger than a pool
+       chunk */
+    size = (rand()%100 == 0)  ?  (3*1024*1024 + rand()%100000)  :  (rand()%100000);
+    switch (rand()%3)
+    {
+    case 0:
+        blocks[i].ptr = (uint8_t *) span_alloc(size);
+        blocks[i].alignment = 1;
+        break;
+    case 1:
+        /* Without a context, this may be C11's aligned_alloc(), which needs the size to
+           be a multiple of the alignment */
+        blocks[i].alignment = (size_t) 16 << (rand()%9);
+        size = (size + blocks[i].alignment - 1) & ~(blocks[i].alignment - 1);
+        blocks[i].ptr = (uint8_t *) span_aligned_alloc(blocks[i].alignment, size);
+        break;
+    default:
+        blocks[i].ptr = (uint8_t *) span_realloc(NULL, size);
+        blocks[i].alignment = 1;
+        break;
+    }
+    if (blocks[i].ptr == NULL)
+    {
+        printf("    Allocating %d bytes failed\n", (int) size);
+        return -1;
+    }
+    blocks[i].size = size;
+    fill_block(i);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int resize_block(int i)
+{
+    uint8_t *ptr;
+    size_t size;
+
+    if (blocks[i].alignment > 1)
+        return 0;
+    size = rand()%100000 + 1;
+    if ((ptr = (uint8_t *) span_realloc(blocks[i].ptr, size)) == NULL)
+    {
+        printf("    Resizing to %d bytes failed\n", (int) size);
+        return -1;
+    }
+    blocks[i].ptr = ptr;
+    if (size < blocks[i].size)
+        blocks[i].size = size;
+    if (check_block(i))
+        return -1;
+    blocks[i].size = size;
+    fill_block(i);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int test_blocks(void)
+{
+    span_alloc_context_t context;
+    int round;
+    int i;
+
+    printf("Testing allocation, with and without a context\n");
+    context.numa_node = 0;
+    context.huge_pages = true;
+    for (round = 0;  round < ROUNDS;  round++)
+    {
+        /* Keep changing the context, so blocks are freed and resized under a different
+           context to the one they were allocated under */
+        if (round%1000 == 0)
+            span_mem_set_context((round%2000)  ?  NULL  :  &context);
+        i = rand()%BLOCKS;
+        if (blocks[i].ptr == NULL)
+        {
+            if (new_block(i))
+                return -1;
+            continue;
+        }
+        if (check_block(i))
+            return -1;
+        if (rand()%2)
+        {
+            if (resize_block(i))
+                return -1;
+        }
+        else
+        {
+            free_block(i);
+        }
+    }
+    for (i = 0;  i < BLOCKS;  i++)
+    {
+        if (blocks[i].ptr)
+        {
+            if (check_block(i))
+                return -1;
+            free_block(i);
+        }
+    }
+    span_mem_set_context(NULL);
+    printf("    OK\n");
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void phase_e_handler(t30_state_t *s, void *user_data, int result)
+{
+    phase_e_result[(int) (intptr_t) user_data] = result;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int write_pages(void)
+{
+    TIFF *tiff;
+    uint8_t row[T4_WIDTH_R8_B4/8];
+    int page;
+    int y;
+
+    if ((tiff = TIFFOpen(INPUT_TIFF_FILE_NAME, "w")) == NULL)
+        return -1;
+    for (page = 0;  page < 2;  page++)
+    {
+        TIFFSetField(tiff, TIFFTAG_IMAGEWIDTH, page_widths[page]);
+        TIFFSetField(tiff, TIFFTAG_IMAGELENGTH, PAGE_ROWS);
+        TIFFSetField(tiff, TIFFTAG_BITSPERSAMPLE, 1);
+        TIFFSetField(tiff, TIFFTAG_SAMPLESPERPIXEL, 1);
+        TIFFSetField(tiff, TIFFTAG_COMPRESSION, COMPRESSION_CCITT_T4);
+        TIFFSetField(tiff, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_MINISWHITE);
+        TIFFSetField(tiff, TIFFTAG_FILLORDER, FILLORDER_LSB2MSB);
+        TIFFSetField(tiff, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
+        TIFFSetField(tiff, TIFFTAG_XRESOLUTION, 204.0f);
+        TIFFSetField(tiff, TIFFTAG_YRESOLUTION, 98.0f);
+        TIFFSetField(tiff, TIFFTAG_RESOLUTIONUNIT, RESUNIT_INCH);
+        TIFFSetField(tiff, TIFFTAG_ROWSPERSTRIP, PAGE_ROWS);
+        TIFFSetField(tiff, TIFFTAG_PAGENUMBER, page, 2);
+        for (y = 0;  y < PAGE_ROWS;  y++)
+        {
+            /* A diagonal stripe, so the rows differ */
+            memset(row, 0, sizeof(row));
+            memset(&row[(y*page_widths[page]/8)/PAGE_ROWS/2], 0xFF, 16);
+            if (TIFFWriteScanline(tiff, row, y, 0) < 0)
+                return -1;
+        }
+        TIFFWriteDirectory(tiff);
+    }
+    TIFFClose(tiff);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static fax_state_t *new_fax(int calling_party)
+{
+    fax_state_t *fax;
+    t30_state_t *t30;
+
+    if ((fax = fax_init(NULL, calling_party)) == NULL)
+        return NULL;
+    t30 = fax_get_t30_state(fax);
+    if (calling_party)
+    {
+        t30_set_tx_ident(t30, "11111111");
+        t30_set_tx_file(t30, INPUT_TIFF_FILE_NAME, -1, -1);
+    }
+    else
+    {
+        t30_set_tx_ident(t30, "22222222");
+        t30_set_rx_file(t30, OUTPUT_TIFF_FILE_NAME, -1);
+    }
+    /* V.17 is not needed to test the allocator, and is not yet right in fixed point builds */
+    t30_set_supported_modems(t30, T30_SUPPORT_V27TER | T30_SUPPORT_V29);
+    t30_set_supported_image_sizes(t30,
+                                  T30_SUPPORT_US_LETTER_LENGTH
+                                | T30_SUPPORT_US_LEGAL_LENGTH
+                                | T30_SUPPORT_UNLIMITED_LENGTH
+                                | T30_SUPPORT_215MM_WIDTH
+                                | T30_SUPPORT_255MM_WIDTH
+                                | T30_SUPPORT_303MM_WIDTH);
+    t30_set_phase_e_handler(t30, phase_e_handler, (void *) (intptr_t) (calling_party  ?  0  :  1));
+    return fax;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int check_pages(void)
+{
+    TIFF *tiff;
+    uint32_t width;
+    int page;
+
+    if ((tiff = TIFFOpen(OUTPUT_TIFF_FILE_NAME, "r")) == NULL)
+        return -1;
+    for (page = 0;  page < 2;  page++)
+    {
+        width = 0;
+        TIFFGetField(tiff, TIFFTAG_IMAGEWIDTH, &width);
+        printf("    Page %d is %d pixels wide\n", page + 1, (int) width);
+        if ((int) width != page_widths[page]  ||  (page == 0  &&  !TIFFReadDirectory(tiff)))
+        {
+            printf("    The pages were not received as sent\n");
+            TIFFClose(tiff);
+            return -1;
+        }
+    }
+    TIFFClose(tiff);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int test_t4(void)
+{
+    span_alloc_context_t context;
+    t4_tx_state_t *tx;
+    t4_rx_state_t *rx;
+    uint8_t chunk[256];
+    int page;
+    int len;
+
+    /* T.30 reopens the T.4 coder when the page width changes, but used directly the
+       coder and decoder resize their buffers for each new width */
+    printf("Testing the T.4 coder and decoder, with a context, on two pages of different widths\n");
+    context.numa_node = 0;
+    context.huge_pages = true;
+    span_mem_set_context(&context);
+    if ((tx = t4_tx_init(NULL, INPUT_TIFF_FILE_NAME, -1, -1)) == NULL)
+    {
+        printf("    Cannot open %s\n", INPUT_TIFF_FILE_NAME);
+        return -1;
+    }
+    if ((rx = t4_rx_init(NULL, OUTPUT_TIFF_FILE_NAME, T4_COMPRESSION_ITU_T4_2D)) == NULL)
+    {
+        printf("    Cannot create %s\n", OUTPUT_TIFF_FILE_NAME);
+        return -1;
+    }
+    t4_tx_set_tx_encoding(tx, T4_COMPRESSION_ITU_T4_2D);
+    t4_rx_set_rx_encoding(rx, T4_COMPRESSION_ITU_T4_2D);
+    for (page = 0;  page < 2;  page++)
+    {
+        if (t4_tx_start_page(tx))
+        {
+            printf("    Cannot start page %d\n", page + 1);
+            return -1;
+        }
+        t4_rx_set_x_resolution(rx, t4_tx_get_x_resolution(tx));
+        t4_rx_set_y_resolution(rx, t4_tx_get_y_resolution(tx));
+        t4_rx_set_image_width(rx, t4_tx_get_image_width(tx));
+        if (t4_rx_start_page(rx))
+        {
+            printf("    Cannot start page %d\n", page + 1);
+            return -1;
+        }
+        while ((len = t4_tx_get_chunk(tx, chunk, sizeof(chunk))) > 0)
+        {
+            if (t4_rx_put_chunk(rx, chunk, len))
+                break;
+        }
+        t4_tx_end_page(tx);
+        t4_rx_end_page(rx);
+    }
+    t4_tx_free(tx);
+    t4_rx_free(rx);
+    span_mem_set_context(NULL);
+    if (check_pages())
+        return -1;
+    printf("    OK\n");
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int test_fax(void)
+{
+    span_alloc_context_t context;
+    fax_state_t *fax[2];
+    int16_t amp[2][SAMPLES_PER_CHUNK];
+    int len;
+    int i;
+    int j;
+
+    printf("Testing a FAX call, with a context, of two pages of different widths\n");
+    context.numa_node = 0;
+    context.huge_pages = true;
+    span_mem_set_context(&context);
+    phase_e_result[0] =
+    phase_e_result[1] = -1;
+    if ((fax[0] = new_fax(true)) == NULL  ||  (fax[1] = new_fax(false)) == NULL)
+    {
+        printf("    Cannot start FAX\n");
+        return -1;
+    }
+    for (i = 0;  i < 8000*300/SAMPLES_PER_CHUNK;  i++)
+    {
+        for (j = 0;  j < 2;  j++)
+        {
+            if ((len = fax_tx(fax[j], amp[j], SAMPLES_PER_CHUNK)) < SAMPLES_PER_CHUNK)
+                memset(&amp[j][len], 0, sizeof(int16_t)*(SAMPLES_PER_CHUNK - len));
+        }
+        fax_rx(fax[1], amp[0], SAMPLES_PER_CHUNK);
+        fax_rx(fax[0], amp[1], SAMPLES_PER_CHUNK);
+        if (phase_e_result[0] >= 0  &&  phase_e_result[1] >= 0)
+            break;
+    }
+    fax_free(fax[0]);
+    fax_free(fax[1]);
+    span_mem_set_context(NULL);
+    printf("    Results %d/%d\n", phase_e_result[0], phase_e_result[1]);
+    if (phase_e_result[0] != T30_ERR_OK  ||  phase_e_result[1] != T30_ERR_OK)
+        return -1;
+    if (check_pages())
+        return -1;
+    printf("    OK\n");
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+#if defined(__linux__)
+static int count_mappings(void)
+{
+    FILE *file;
+    char line[1024];
+    int n;
+
+    if ((file = fopen("/proc/self/maps", "r")) == NULL)
+        return -1;
+    n = 0;
+    while (fgets(line, sizeof(line), file))
+        n++;
+    fclose(file);
+    return n;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int huge_page_flag(const void *ptr)
+{
+    FILE *file;
+    char line[1024];
+    uintptr_t start;
+    uintptr_t end;
+    int in_mapping;
+    int res;
+
+    /* Find the VmFlags line of the mapping holding ptr. "hg" means MADV_HUGEPAGE. */
+    if ((file = fopen("/proc/self/smaps", "r")) == NULL)
+        return -1;
+    res = -1;
+    in_mapping = false;
+    while (fgets(line, sizeof(line), file))
+    {
+        if (sscanf(line, "%" SCNxPTR "-%" SCNxPTR " ", &start, &end) == 2  &&  strchr(line, '-') < strchr(line, ' '))
+        {
+            in_mapping = ((uintptr_t) ptr >= start  &&  (uintptr_t) ptr < end);
+        }
+        else if (in_mapping  &&  strncmp(line, "VmFlags:", 8) == 0)
+        {
+            res = (strstr(line, " hg") != NULL);
+            break;
+        }
+    }
+    fclose(file);
+    return res;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int huge_pages_enabled(void)
+{
+    FILE *file;
+    char line[256];
+    int res;
+
+    if ((file = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r")) == NULL)
+        return false;
+    res = (fgets(line, sizeof(line), file)  &&  strstr(line, "[never]") == NULL);
+    fclose(file);
+    return res;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int memory_policy(void *ptr, int *node)
+{
+#if defined(SYS_get_mempolicy)
+    unsigned long int node_mask[1024/(8*sizeof(unsigned long int))];
+    int mode;
+    int i;
+
+    memset(node_mask, 0, sizeof(node_mask));
+    if (syscall(SYS_get_mempolicy, &mode, node_mask, 1024, ptr, MPOL_F_ADDR_FLAG))
+        return -1;
+    *node = -1;
+    for (i = 0;  i < 1024;  i++)
+    {
+        if ((node_mask[i/(8*sizeof(node_mask[0]))] >> (i%(8*sizeof(node_mask[0])))) & 1)
+        {
+            *node = i;
+            break;
+        }
+    }
+    return mode;
+#else
+    return -1;
+#endif
+}
+/*- End of function --------------------------------------------------------*/
+
+static int test_placement(void)
+{
+    span_alloc_context_t context;
+    uint8_t *small[SMALL_BLOCKS];
+    uint8_t *plain;
+    int before;
+    int after;
+    int mode;
+    int node;
+    int i;
+
+    printf("Testing placement\n");
+    context.numa_node = 0;
+    context.huge_pages = true;
+    span_mem_set_context(&context);
+    before = count_mappings();
+    for (i = 0;  i < SMALL_BLOCKS;  i++)
+    {
+        if ((small[i] = (uint8_t *) span_alloc(5000)) == NULL)
+        {
+            printf("    Allocating a small block failed\n");
+            return -1;
+        }
+        memset(small[i], i, 5000);
+    }
+    after = count_mappings();
+    printf("    %d blocks changed the number of mappings from %d to %d\n", SMALL_BLOCKS, before, after);
+    /* The blocks fit in three pool chunks, each of which is one mapping. Placing each
+       block separately splits the heap into hundreds of mappings. */
+    if (after - before > 16)
+    {
+        printf("    The blocks were placed separately\n");
+        return -1;
+    }
+    if ((mode = memory_policy(small[SMALL_BLOCKS/2], &node)) < 0)
+    {
+        printf("    NUMA policies are not supported (%s) - skipped\n", strerror(errno));
+    }
+    else
+    {
+        printf("    Memory from a pool has policy %d, node %d\n", mode, node);
+        if (mode != MPOL_PREFERRED_MODE  ||  node != 0)
+        {
+            printf("    Memory from a pool is not on the preferred node\n");
+            return -1;
+        }
+    }
+    if (huge_pages_enabled())
+    {
+        if (huge_page_flag(small[SMALL_BLOCKS/2]) != true)
+        {
+            printf("    Memory from a pool is not marked for huge pages\n");
+            return -1;
+        }
+        printf("    Memory from a pool is marked for huge pages\n");
+    }
+    else
+    {
+        printf("    Huge pages are not enabled - skipped\n");
+    }
+    for (i = 0;  i < SMALL_BLOCKS;  i++)
+        span_free(small[i]);
+    span_mem_set_context(NULL);
+
+    /* Memory the normal allocator hands out must not pick up the policy, even with
+       the pool's memory freed */
+    if ((plain = (uint8_t *) span_alloc(5000)) == NULL)
+        return -1;
+    if ((mode = memory_policy(plain, &node)) >= 0  &&  mode != MPOL_DEFAULT_MODE)
+    {
+        printf("    Memory from the normal allocator has policy %d\n", mode);
+        return -1;
+    }
+    span_free(plain);
+    printf("    OK\n");
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+#endif
+
+int main(int argc, char *argv[])
+{
+#if defined(__linux__)
+    /* This goes first, while the heap has not yet been split up */
+    if (test_placement())
+    {
+        printf("Tests failed\n");
+        exit(2);
+    }
+#endif
+    if (test_blocks())
+    {
+        printf("Tests failed\n");
+        exit(2);
+    }
+    if (write_pages())
+    {
+        printf("Cannot write %s\n", INPUT_TIFF_FILE_NAME);
+        printf("Tests failed\n");
+        exit(2);
+    }
+    if (test_t4()  ||  test_fax())
+    {
+        printf("Tests failed\n");
+        exit(2);
+    }
+    printf("Tests passed\n");
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+/*- End of file ------------------------------------------------------------*/
@@ -125,6 +125,192 @@ static void test_put_async_byte(void *user_data, int byte)
 }
 /*- End of function --------------------------------------------------------*/
 
+#define BLOCK_TEST_BITS     20000
+
+static uint8_t ref_bits[BLOCK_TEST_BITS];
+static uint8_t packed_bits[BLOCK_TEST_BITS/8 + 1];
+static int ref_chars[BLOCK_TEST_BITS];
+static int ref_char_count;
+static int block_chars[BLOCK_TEST_BITS];
+static int block_char_count;
+static int block_tx_limit;
+
+static void ref_put_async_byte(void *user_data, int byte)
+{
+    ref_chars[ref_char_count++] = byte;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void block_put_async_byte(void *user_data, int byte)
+{
+    block_chars[block_char_count++] = byte;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int block_get_async_byte(void *user_data)
+{
+    if (tx_async_chars >= block_tx_limit)
+        return -1;
+    return test_get_async_byte(user_data);
+}
+/*- End of function --------------------------------------------------------*/
+
+static void pack_bits(uint8_t packed[], const uint8_t bits[], int len)
+{
+    int i;
+
+    memset(packed, 0, (len + 7)/8);
+    for (i = 0;  i < len;  i++)
+        packed[i >> 3] |= bits[i] << (i & 7);
+}
+/*- End of function --------------------------------------------------------*/
+
+static int test_block_rx(int data_bits, int parity, int stop_bits, int use_v14)
+{
+    int parity_errors;
+    int framing_errors;
+    int chunk;
+    int bit;
+    int i;
+    int j;
+
+    /* Make a bit stream with some idle periods and some bit errors, and check
+       deframing it in blocks gives exactly the same as deframing it a bit at a time. */
+    async_tx_init(&tx_async, data_bits, parity, stop_bits, use_v14, test_get_async_byte, NULL);
+    tx_async_chars = 0;
+    for (i = 0;  i < BLOCK_TEST_BITS;  i++)
+    {
+        if ((rand() & 0x3FF) == 0)
+        {
+            /* A burst of idle marking, between characters */
+            for (j = rand() & 0x3F;  j > 0  &&  i < BLOCK_TEST_BITS;  j--)
+                ref_bits[i++] = 1;
+            if (i >= BLOCK_TEST_BITS)
+                break;
+        }
+        bit = (use_v14)  ?  v14_test_async_tx_get_bit(&tx_async)  :  async_tx_get_bit(&tx_async);
+        if ((rand() & 0x1FF) == 0)
+            bit ^= 1;
+        ref_bits[i] = (uint8_t) bit;
+    }
+    ref_char_count = 0;
+    async_rx_init(&rx_async, data_bits, parity, stop_bits, use_v14, ref_put_async_byte, NULL);
+    for (i = 0;  i < BLOCK_TEST_BITS;  i++)
+        async_rx_put_bit(&rx_async, ref_bits[i]);
+    parity_errors = rx_async.parity_errors;
+    framing_errors = rx_async.framing_errors;
+
+    pack_bits(packed_bits, ref_bits, BLOCK_TEST_BITS);
+    block_char_count = 0;
+    async_rx_init(&rx_async, data_bits, parity, stop_bits, use_v14, block_put_async_byte, NULL);
+    for (i = 0;  i < BLOCK_TEST_BITS;  i += chunk)
+    {
+        /* Blocks of all sizes, and not aligned to bytes */
+        chunk = (rand() & 1)  ?  (rand() & 0x7F)  :  (rand() & 0x7);
+        if (chunk > BLOCK_TEST_BITS - i)
+            chunk = BLOCK_TEST_BITS - i;
+        if ((i & 7) == 0)
+        {
+            async_rx_put_bits(&rx_async, &packed_bits[i >> 3], chunk);
+        }
+        else
+        {
+            for (j = 0;  j < chunk;  j++)
+                async_rx_put_bit(&rx_async, ref_bits[i + j]);
+        }
+    }
+    printf("Chars=%d/%d, PE=%d/%d, FE=%d/%d\n",
+           ref_char_count,
+           block_char_count,
+           parity_errors,
+           rx_async.parity_errors,
+           framing_errors,
+           rx_async.framing_errors);
+    if (block_char_count != ref_char_count
+        ||
+        memcmp(block_chars, ref_chars, ref_char_count*sizeof(int))
+        ||
+        rx_async.parity_errors != parity_errors
+        ||
+        rx_async.framing_errors != framing_errors
+        ||
+        (parity  &&  parity_errors == 0)
+        ||
+        (!use_v14  &&  framing_errors == 0))
+    {
+        return -1;
+    }
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int test_block_tx(int data_bits, int parity, int stop_bits)
+{
+    static uint8_t block_bits[BLOCK_TEST_BITS];
+    uint8_t buf[256];
+    int ref_len;
+    int len;
+    int chunk;
+    int n;
+    int i;
+
+    /* Get a stream which ends part way through, a bit at a time */
+    block_tx_limit = 1000;
+    async_tx_init(&tx_async, data_bits, parity, stop_bits, false, block_get_async_byte, NULL);
+    tx_async_chars = 0;
+    for (ref_len = 0;  ref_len < BLOCK_TEST_BITS;  ref_len++)
+    {
+        if ((n = async_tx_get_bit(&tx_async)) < 0)
+            break;
+        ref_bits[ref_len] = (uint8_t) n;
+    }
+    pack_bits(packed_bits, ref_bits, ref_len);
+
+    /* Get the same stream in blocks, with some bits got singly between them */
+    async_tx_init(&tx_async, data_bits, parity, stop_bits, false, block_get_async_byte, NULL);
+    tx_async_chars = 0;
+    memset(block_bits, 0, sizeof(block_bits));
+    for (len = 0;  len < ref_len;  len += n)
+    {
+        if ((len & 7) == 0)
+        {
+            chunk = rand() & 0x7F;
+            n = async_tx_get_bits(&tx_async, &block_bits[len >> 3], chunk);
+            if (n < chunk)
+            {
+                len += n;
+                break;
+            }
+        }
+        else
+        {
+            n = 1;
+            block_bits[len >> 3] |= async_tx_get_bit(&tx_async) << (len & 7);
+        }
+    }
+    printf("Bits=%d/%d\n", ref_len, len);
+    if (len != ref_len  ||  memcmp(block_bits, packed_bits, (ref_len + 7)/8))
+        return -1;
+
+    /* Frame a buffer in one go */
+    for (i = 0;  i < 256;  i++)
+        buf[i] = (uint8_t) i;
+    block_tx_limit = 256;
+    async_tx_init(&tx_async, data_bits, parity, stop_bits, false, block_get_async_byte, NULL);
+    tx_async_chars = 0;
+    for (ref_len = 0;  (n = async_tx_get_bit(&tx_async)) >= 0;  ref_len++)
+        ref_bits[ref_len] = (uint8_t) n;
+    pack_bits(packed_bits, ref_bits, ref_len);
+    len = async_tx_frame_bytes(&tx_async, block_bits, buf, 256);
+    if (len != ref_len  ||  memcmp(block_bits, packed_bits, (ref_len + 7)/8))
+    {
+        printf("Framed buffer is wrong\n");
+        return -1;
+    }
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
 int main(int argc, char *argv[])
 {
     int bit;
@@ -239,6 +425,34 @@ int main(int argc, char *argv[])
         exit(2);
     }
 
+    printf("Test block processing with async 8N1\n");
+    if (test_block_tx(8, ASYNC_PARITY_NONE, 1)  ||  test_block_rx(8, ASYNC_PARITY_NONE, 1, false))
+    {
+        printf("Test failed.\n");
+        exit(2);
+    }
+
+    printf("Test block processing with async 7E1\n");
+    if (test_block_tx(7, ASYNC_PARITY_EVEN, 1)  ||  test_block_rx(7, ASYNC_PARITY_EVEN, 1, false))
+    {
+        printf("Test failed.\n");
+        exit(2);
+    }
+
+    printf("Test block processing with async 8O1 and V.14\n");
+    if (test_block_tx(8, ASYNC_PARITY_ODD, 1)  ||  test_block_rx(8, ASYNC_PARITY_ODD, 1, true))
+    {
+        printf("Test failed.\n");
+        exit(2);
+    }
+
+    printf("Test block processing with async 5N2\n");
+    if (test_block_tx(5, ASYNC_PARITY_NONE, 2)  ||  test_block_rx(5, ASYNC_PARITY_NONE, 2, false))
+    {
+        printf("Test failed.\n");
+        exit(2);
+    }
+
     printf("Tests passed.\n");
     return 0;
 }
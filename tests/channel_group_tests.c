@@ -0,0 +1,287 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * channel_group_tests.c - Tests for the channel group processing.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2013 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \file */
+
+/*! \page channel_group_tests_page Channel group tests
+\section channel_group_tests_page_sec_1 What does it do
+These tests check that a channel group calls each channel's handlers once per
+tick, with the right context and buffers, in the order of the contexts'
+addresses, and that channels can be added and removed. A group of DTMF
+generators and receivers is then run, checking every receiver gets its digits,
+and the time taken is compared with calling the same handlers channel by
+channel, in a scattered order.
+*/
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "spandsp.h"
+
+#define DTMF_CHANNELS       256
+#define TICK_LEN            160
+
+typedef struct
+{
+    int id;
+    int rx_calls;
+    int tx_calls;
+    const int16_t *last_rx_buf;
+} dummy_state_t;
+
+static int call_log[10];
+static int call_log_len;
+
+static int16_t rx_bufs[DTMF_CHANNELS][TICK_LEN];
+static int16_t tx_bufs[DTMF_CHANNELS][TICK_LEN];
+static char rx_digits[DTMF_CHANNELS][32];
+static int rx_digits_len[DTMF_CHANNELS];
+
+static int dummy_rx(void *user_data, const int16_t amp[], int len)
+{
+    dummy_state_t *s;
+
+    s = (dummy_state_t *) user_data;
+    s->rx_calls++;
+    s->last_rx_buf = amp;
+    if (call_log_len < 10)
+        call_log[call_log_len++] = s->id;
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int dummy_tx(void *user_data, int16_t amp[], int max_len)
+{
+    dummy_state_t *s;
+
+    s = (dummy_state_t *) user_data;
+    s->tx_calls++;
+    amp[0] = (int16_t) s->id;
+    if (call_log_len < 10)
+        call_log[call_log_len++] = -s->id;
+    return max_len/2;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int test_basics(void)
+{
+    channel_group_state_t *group;
+    dummy_state_t dummies[3];
+    int handles[3];
+    int i;
+
+    if ((group = channel_group_init(NULL, 3)) == NULL)
+        return -1;
+    memset(dummies, 0, sizeof(dummies));
+    for (i = 0;  i < 3;  i++)
+        dummies[i].id = i + 1;
+    /* Add them out of address order */
+    handles[2] = channel_group_add(group, dummy_rx, dummy_tx, &dummies[2], sizeof(dummies[2]), rx_bufs[2], tx_bufs[2]);
+    handles[0] = channel_group_add(group, dummy_rx, dummy_tx, &dummies[0], sizeof(dummies[0]), rx_bufs[0], tx_bufs[0]);
+    handles[1] = channel_group_add(group, NULL, dummy_tx, &dummies[1], sizeof(dummies[1]), rx_bufs[1], tx_bufs[1]);
+    if (handles[0] < 0  ||  handles[1] < 0  ||  handles[2] < 0)
+        return -1;
+    if (channel_group_add(group, dummy_rx, dummy_tx, &dummies[0], 0, rx_bufs[0], tx_bufs[0]) >= 0)
+    {
+        printf("A full group accepted another channel\n");
+        return -1;
+    }
+    call_log_len = 0;
+    if (channel_group_process(group, TICK_LEN) != 3)
+        return -1;
+    /* Address order, with each receive handler followed by its transmit handler */
+    if (call_log_len != 5
+        ||
+        call_log[0] != 1  ||  call_log[1] != -1
+        ||
+        call_log[2] != -2
+        ||
+        call_log[3] != 3  ||  call_log[4] != -3)
+    {
+        printf("Handlers called in the wrong order\n");
+        return -1;
+    }
+    for (i = 0;  i < 3;  i++)
+    {
+        if (tx_bufs[i][0] != dummies[i].id  ||  channel_group_get_tx_len(group, handles[i]) != TICK_LEN/2)
+        {
+            printf("Channel %d has the wrong transmit buffer\n", i);
+            return -1;
+        }
+    }
+    if (dummies[0].last_rx_buf != rx_bufs[0]  ||  dummies[2].last_rx_buf != rx_bufs[2]  ||  dummies[1].rx_calls != 0)
+    {
+        printf("Receive handlers called wrongly\n");
+        return -1;
+    }
+
+    /* Take out the middle one, and put it back */
+    if (channel_group_remove(group, handles[1])  ||  channel_group_remove(group, handles[1]) == 0)
+        return -1;
+    if (channel_group_get_tx_len(group, handles[1]) != -1
+        ||
+        channel_group_get_tx_len(group, -1) != -1
+        ||
+        channel_group_get_tx_len(group, 3) != -1)
+    {
+        printf("A bad handle gave a transmit length\n");
+        return -1;
+    }
+    call_log_len = 0;
+    channel_group_process(group, TICK_LEN);
+    if (call_log_len != 4  ||  call_log[2] != 3)
+        return -1;
+    if (channel_group_add(group, dummy_rx, NULL, &dummies[1], sizeof(dummies[1]), rx_bufs[1], tx_bufs[1]) != handles[1])
+        return -1;
+    call_log_len = 0;
+    channel_group_process(group, TICK_LEN);
+    if (call_log_len != 5  ||  call_log[2] != 2  ||  call_log[3] != 3)
+        return -1;
+    channel_group_free(group);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void digits_rx(void *user_data, const char *digits, int len)
+{
+    int chan;
+
+    chan = (int) (intptr_t) user_data;
+    if (rx_digits_len[chan] + len < 32)
+    {
+        memcpy(&rx_digits[chan][rx_digits_len[chan]], digits, len);
+        rx_digits_len[chan] += len;
+    }
+}
+/*- End of function --------------------------------------------------------*/
+
+static double run_dtmf(int grouped)
+{
+    static const char *digit_sets[] =
+    {
+        "1234567890",
+        "*#ABCD",
+        "9876543210"
+    };
+    channel_group_state_t *group;
+    dtmf_tx_state_t *tx[DTMF_CHANNELS];
+    dtmf_rx_state_t *rx[DTMF_CHANNELS];
+    int order[DTMF_CHANNELS];
+    struct timespec start;
+    struct timespec end;
+    double elapsed;
+    int tx_size;
+    int rx_size;
+    int ticks;
+    int i;
+    int j;
+
+    tx_size = span_state_size("dtmf_tx_state_t");
+    rx_size = span_state_size("dtmf_rx_state_t");
+    group = channel_group_init(NULL, 2*DTMF_CHANNELS);
+    for (i = 0;  i < DTMF_CHANNELS;  i++)
+    {
+        tx[i] = dtmf_tx_init(NULL);
+        dtmf_tx_put(tx[i], digit_sets[i%3], -1);
+        rx[i] = dtmf_rx_init(NULL, digits_rx, (void *) (intptr_t) i);
+        rx_digits_len[i] = 0;
+        memset(rx_bufs[i], 0, sizeof(rx_bufs[i]));
+        channel_group_add(group, NULL, (span_tx_handler_t *) dtmf_tx, tx[i], tx_size, NULL, tx_bufs[i]);
+        channel_group_add(group, (span_rx_handler_t *) dtmf_rx, NULL, rx[i], rx_size, rx_bufs[i], NULL);
+        order[i] = (i*97)%DTMF_CHANNELS;
+    }
+    elapsed = 0.0;
+    for (ticks = 0;  ticks < 200;  ticks++)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        if (grouped)
+        {
+            channel_group_process(group, TICK_LEN);
+        }
+        else
+        {
+            /* Channel by channel, in the scattered order packets might arrive */
+            for (i = 0;  i < DTMF_CHANNELS;  i++)
+            {
+                j = order[i];
+                dtmf_rx(rx[j], rx_bufs[j], TICK_LEN);
+            }
+            for (i = 0;  i < DTMF_CHANNELS;  i++)
+            {
+                j = order[i];
+                vec_zeroi16(tx_bufs[j], TICK_LEN);
+                dtmf_tx(tx[j], tx_bufs[j], TICK_LEN);
+            }
+        }
+        clock_gettime(CLOCK_MONOTONIC, &end);
+        elapsed += (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec)*1.0e-9;
+        /* Loop each generator's output back to its receiver, for the next tick */
+        for (i = 0;  i < DTMF_CHANNELS;  i++)
+            memcpy(rx_bufs[i], tx_bufs[i], sizeof(rx_bufs[i]));
+    }
+    for (i = 0;  i < DTMF_CHANNELS;  i++)
+    {
+        if (rx_digits_len[i] != (int) strlen(digit_sets[i%3])  ||  memcmp(rx_digits[i], digit_sets[i%3], rx_digits_len[i]))
+        {
+            printf("Channel %d received '%.*s'\n", i, rx_digits_len[i], rx_digits[i]);
+            return -1.0;
+        }
+        dtmf_tx_free(tx[i]);
+        dtmf_rx_free(rx[i]);
+    }
+    channel_group_free(group);
+    return elapsed;
+}
+/*- End of function --------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    double scattered;
+    double grouped;
+
+    printf("Basic operations\n");
+    if (test_basics())
+    {
+        printf("Tests failed\n");
+        exit(2);
+    }
+    printf("DTMF channels\n");
+    if ((scattered = run_dtmf(false)) < 0.0  ||  (grouped = run_dtmf(true)) < 0.0)
+    {
+        printf("Tests failed\n");
+        exit(2);
+    }
+    printf("  %d channels, channel by channel %.2fms, as a group %.2fms\n", DTMF_CHANNELS, scattered*1000.0, grouped*1000.0);
+    printf("Tests passed\n");
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+/*- End of file ------------------------------------------------------------*/
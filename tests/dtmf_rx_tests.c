@@ -157,6 +157,13 @@ int step;
 int max_forward_twist;
 int max_reverse_twist;
 
+int early_digit;
+int early_step;
+int early_reports;
+int early_withdrawals;
+int confirmed_digit;
+int confirmed_step;
+
 int use_dialtone_filter = false;
 
 char *decode_test_file = NULL;
@@ -306,6 +313,21 @@ static void digit_status(void *data, int signal, int level, int delay)
 }
 /*- End of function --------------------------------------------------------*/
 
+static void early_digit_status(void *data, int signal, int level, int delay)
+{
+    if (signal)
+    {
+        early_digit = signal;
+        early_step = step;
+        early_reports++;
+    }
+    else
+    {
+        early_withdrawals++;
+    }
+}
+/*- End of function --------------------------------------------------------*/
+
 static void mitel_cm7291_side_1_tests(void)
 {
     int i;
@@ -627,6 +649,7 @@ static void mitel_cm7291_side_2_and_bellcore_tests(void)
     int j;
     int len;
     int hits;
+    int early_hits;
     int hit_types[256];
     char buf[128 + 1];
     SNDFILE *inhandle;
@@ -640,6 +663,10 @@ static void mitel_cm7291_side_2_and_bellcore_tests(void)
     logging = dtmf_rx_get_logging_state(dtmf_state);
     span_log_set_level(logging, SPAN_LOG_SHOW_SEVERITY | SPAN_LOG_SHOW_PROTOCOL | SPAN_LOG_FLOW);
     span_log_set_tag(logging, "DTMF-rx");
+    /* Early reports may be used to suppress the audio, so talk-off matters for them
+       too. They are held to the same limit as the confirmed digits. */
+    dtmf_rx_set_early_callback(dtmf_state, early_digit_status, NULL);
+    early_reports = 0;
 
     /* The remainder of the Mitel tape is the talk-off test */
     /* Here we use the Bellcore test tapes (much tougher), in six
@@ -657,6 +684,7 @@ static void mitel_cm7291_side_2_and_bellcore_tests(void)
             exit(2);
         }
         hits = 0;
+        early_hits = early_reports;
         while ((frames = sf_readf_short(inhandle, amp, SAMPLE_RATE)))
         {
             dtmf_rx(dtmf_state, amp, frames);
@@ -673,7 +701,7 @@ static void mitel_cm7291_side_2_and_bellcore_tests(void)
             printf("    Cannot close speech file '%s'\n", bellcore_files[j]);
             exit(2);
         }
-        printf("    File %d gave %d false hits.\n", j + 1, hits);
+        printf("    File %d gave %d false hits, and %d false early reports.\n", j + 1, hits, early_reports - early_hits);
     }
     for (i = 0, j = 0;  i < 256;  i++)
     {
@@ -683,8 +711,8 @@ static void mitel_cm7291_side_2_and_bellcore_tests(void)
             j += hit_types[i];
         }
     }
-    printf("    %d hits in total\n", j);
-    if (j > 470)
+    printf("    %d hits in total, and %d early reports\n", j, early_reports);
+    if (j > 470  ||  early_reports > 470)
     {
         printf("    Failed\n");
         exit(2);
@@ -693,6 +721,46 @@ static void mitel_cm7291_side_2_and_bellcore_tests(void)
 }
 /*- End of function --------------------------------------------------------*/
 
+static void descriptor_tests(void)
+{
+    static const float row_freqs[4] =
+    {
+         697.0f,  770.0f,  852.0f,  941.0f
+    };
+    static const float col_freqs[4] =
+    {
+        1209.0f, 1336.0f, 1477.0f, 1633.0f
+    };
+    dtmf_rx_state_t *dtmf_state;
+    goertzel_descriptor_t desc;
+    int i;
+
+    /* The receiver's Goertzel filters are built from fixed tables, which must match what
+       make_goertzel_descriptor() gives */
+    printf("Test: Goertzel descriptors.\n");
+    dtmf_state = dtmf_rx_init(NULL, NULL, NULL);
+    for (i = 0;  i < 4;  i++)
+    {
+        make_goertzel_descriptor(&desc, row_freqs[i], dtmf_state->row_out[i].samples);
+        if (dtmf_state->row_out[i].fac != desc.fac)
+        {
+            printf("    The %.0fHz descriptor is %.9g, rather than %.9g\n", row_freqs[i], (double) dtmf_state->row_out[i].fac, (double) desc.fac);
+            printf("    Failed\n");
+            exit(2);
+        }
+        make_goertzel_descriptor(&desc, col_freqs[i], dtmf_state->col_out[i].samples);
+        if (dtmf_state->col_out[i].fac != desc.fac)
+        {
+            printf("    The %.0fHz descriptor is %.9g, rather than %.9g\n", col_freqs[i], (double) dtmf_state->col_out[i].fac, (double) desc.fac);
+            printf("    Failed\n");
+            exit(2);
+        }
+    }
+    dtmf_rx_free(dtmf_state);
+    printf("    Passed\n");
+}
+/*- End of function --------------------------------------------------------*/
+
 static void dial_tone_tolerance_tests(void)
 {
     int i;
@@ -824,6 +892,154 @@ static void callback_function_tests(void)
 }
 /*- End of function --------------------------------------------------------*/
 
+static void confirmed_digit_status(void *data, int signal, int level, int delay)
+{
+    if (signal  &&  confirmed_digit == 0)
+    {
+        confirmed_digit = signal;
+        confirmed_step = step;
+    }
+}
+/*- End of function --------------------------------------------------------*/
+
+static void early_reporting_tests(void)
+{
+    int i;
+    int len;
+    int offset;
+    int sample;
+    int worst_early;
+    int worst_confirmed;
+    char buf[128 + 1];
+    char buf2[128 + 1];
+    dtmf_rx_state_t *dtmf_state;
+    dtmf_rx_state_t *dtmf_state2;
+    awgn_state_t *noise;
+
+    printf("Test: Early reporting of digits.\n");
+    /* Start a digit at each point in the detection blocks, and feed the audio to the
+       receiver a sample at a time, to find the worst case delays to the early and the
+       confirmed reports. */
+    my_dtmf_gen_init(0.0f, DEFAULT_DTMF_TX_LEVEL, 0.0f, DEFAULT_DTMF_TX_LEVEL, DEFAULT_DTMF_TX_ON_TIME, DEFAULT_DTMF_TX_OFF_TIME);
+    dtmf_state = dtmf_rx_init(NULL, NULL, NULL);
+    worst_early = 0;
+    worst_confirmed = 0;
+    for (offset = 0;  offset < 128;  offset++)
+    {
+        dtmf_rx_init(dtmf_state, NULL, NULL);
+        dtmf_rx_set_realtime_callback(dtmf_state, confirmed_digit_status, NULL);
+        dtmf_rx_set_early_callback(dtmf_state, early_digit_status, NULL);
+        memset(amp, 0, sizeof(int16_t)*offset);
+        len = offset + my_dtmf_generate(amp + offset, "5");
+        early_digit = 0;
+        early_reports = 0;
+        early_withdrawals = 0;
+        confirmed_digit = 0;
+        for (step = 0;  step < len;  )
+        {
+            step++;
+            dtmf_rx(dtmf_state, &amp[step - 1], 1);
+        }
+        if (early_digit != '5'
+            ||
+            early_reports != 1
+            ||
+            early_withdrawals
+            ||
+            confirmed_digit != '5'
+            ||
+            early_step > confirmed_step)
+        {
+            printf("    Failed for a digit starting at %d\n", offset);
+            printf("    Failed\n");
+            exit(2);
+        }
+        if (early_step - offset > worst_early)
+            worst_early = early_step - offset;
+        if (confirmed_step - offset > worst_confirmed)
+            worst_confirmed = confirmed_step - offset;
+    }
+    printf("    Worst case delays - early report %.2fms, confirmed report %.2fms\n", worst_early/8.0f, worst_confirmed/8.0f);
+    if (worst_early > 20*8  ||  worst_early >= worst_confirmed)
+    {
+        printf("    Failed\n");
+        exit(2);
+    }
+
+    /* Blips of tone too short to be digits may be reported early, but must then be
+       withdrawn, and never confirmed. */
+    my_dtmf_gen_init(0.0f, DEFAULT_DTMF_TX_LEVEL, 0.0f, DEFAULT_DTMF_TX_LEVEL, 20, 80);
+    dtmf_rx_init(dtmf_state, NULL, NULL);
+    dtmf_rx_set_early_callback(dtmf_state, early_digit_status, NULL);
+    early_reports = 0;
+    early_withdrawals = 0;
+    for (i = 0;  i < 10;  i++)
+    {
+        len = my_dtmf_generate(amp, ALL_POSSIBLE_DIGITS);
+        for (sample = 0;  sample < len;  sample += SAMPLES_PER_CHUNK)
+            dtmf_rx(dtmf_state, &amp[sample], ((len - sample) >= SAMPLES_PER_CHUNK)  ?  SAMPLES_PER_CHUNK  :  (len - sample));
+        if (dtmf_rx_get(dtmf_state, buf, 128) != 0)
+        {
+            printf("    Failed - blips confirmed as digits\n");
+            exit(2);
+        }
+    }
+    printf("    %d of %d blips reported early, %d withdrawn\n", early_reports, i*16, early_withdrawals);
+    if (early_reports != early_withdrawals)
+    {
+        printf("    Failed\n");
+        exit(2);
+    }
+
+    /* Stopping early reporting while a report is pending must withdraw the report, but
+       not stop the digit being confirmed */
+    my_dtmf_gen_init(0.0f, DEFAULT_DTMF_TX_LEVEL, 0.0f, DEFAULT_DTMF_TX_LEVEL, DEFAULT_DTMF_TX_ON_TIME, DEFAULT_DTMF_TX_OFF_TIME);
+    dtmf_rx_init(dtmf_state, NULL, NULL);
+    dtmf_rx_set_early_callback(dtmf_state, early_digit_status, NULL);
+    early_reports = 0;
+    early_withdrawals = 0;
+    len = my_dtmf_generate(amp, "5");
+    for (sample = 0;  sample < len  &&  early_reports == 0;  sample++)
+        dtmf_rx(dtmf_state, &amp[sample], 1);
+    dtmf_rx_set_early_callback(dtmf_state, NULL, NULL);
+    dtmf_rx(dtmf_state, &amp[sample], len - sample);
+    dtmf_rx_get(dtmf_state, buf, 128);
+    printf("    Early reporting stopped with a report pending - %d reported, %d withdrawn, '%s' confirmed\n", early_reports, early_withdrawals, buf);
+    if (early_reports != 1  ||  early_withdrawals != 1  ||  strcmp(buf, "5"))
+    {
+        printf("    Failed\n");
+        exit(2);
+    }
+
+    /* The confirmed digits must be the same with, and without, early reporting */
+    my_dtmf_gen_init(0.0f, -20, 0.0f, -20, DEFAULT_DTMF_TX_ON_TIME, DEFAULT_DTMF_TX_OFF_TIME);
+    noise = awgn_init_dbm0(NULL, 1234567, -36.0f);
+    dtmf_rx_init(dtmf_state, NULL, NULL);
+    dtmf_rx_set_early_callback(dtmf_state, early_digit_status, NULL);
+    dtmf_state2 = dtmf_rx_init(NULL, NULL, NULL);
+    for (i = 0;  i < 10;  i++)
+    {
+        len = my_dtmf_generate(amp, ALL_POSSIBLE_DIGITS);
+        for (sample = 0;  sample < len;  sample++)
+            amp[sample] = saturate(amp[sample] + awgn(noise));
+        codec_munge(munge, amp, len);
+        dtmf_rx(dtmf_state, amp, len);
+        dtmf_rx(dtmf_state2, amp, len);
+        dtmf_rx_get(dtmf_state, buf, 128);
+        dtmf_rx_get(dtmf_state2, buf2, 128);
+        if (strcmp(buf, buf2)  ||  strcmp(buf, ALL_POSSIBLE_DIGITS))
+        {
+            printf("    Failed - '%s' with early reporting, '%s' without\n", buf, buf2);
+            exit(2);
+        }
+    }
+    awgn_free(noise);
+    dtmf_rx_free(dtmf_state);
+    dtmf_rx_free(dtmf_state2);
+    printf("    Passed\n");
+}
+/*- End of function --------------------------------------------------------*/
+
 static void decode_test(const char *test_file)
 {
     int16_t amp[SAMPLES_PER_CHUNK];
@@ -910,11 +1126,13 @@ int main(int argc, char *argv[])
     else
     {
         time(&now);
+        descriptor_tests();
         mitel_cm7291_side_1_tests();
         mitel_cm7291_side_2_and_bellcore_tests();
         dial_tone_tolerance_tests();
         callback_function_tests();
         printf("    Passed\n");
+        early_reporting_tests();
         duration = time(NULL) - now;
         printf("Tests passed in %ds\n", duration);
     }
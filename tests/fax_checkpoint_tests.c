@@ -0,0 +1,466 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * fax_checkpoint_tests.c - Tests for moving FAX calls between contexts.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2013 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \file */
+
+/*! \page fax_checkpoint_tests_page FAX checkpoint tests
+\section fax_checkpoint_tests_page_sec_1 What does it do
+These tests send a FAX between two FAX contexts, and between two T.38 terminal
+contexts, in non-ECM and ECM modes. While the call is in progress, the sending end
+is repeatedly checkpointed, and moved to a new context, and the receiving end is
+moved once. The call must complete normally, with
+all the pages received across the two receive files. Damaged and unusable checkpoints
+must be rejected.
+*/
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <tiffio.h>
+
+#define SPANDSP_EXPOSE_INTERNAL_STRUCTURES
+
+#include "spandsp.h"
+
+#define INPUT_TIFF_FILE_NAME    "../test-data/itu/fax/itutests.tif"
+#define OUTPUT_TIFF_FILE_NAME_1 "fax_checkpoint_tests_1.tif"
+#define OUTPUT_TIFF_FILE_NAME_2 "fax_checkpoint_tests_2.tif"
+
+#define SAMPLES_PER_CHUNK       160
+#define MAX_QUEUED_PACKETS      100
+
+static int phase_e_result[2];
+static int pages_received;
+/* This is big enough for both FAX and T.38 terminal checkpoints */
+static uint8_t checkpoint[FAX_MAX_CHECKPOINT_LEN];
+
+static struct
+{
+    uint8_t buf[512];
+    int len;
+    int seq_no;
+} packet_queue[2][MAX_QUEUED_PACKETS];
+static int queued[2];
+
+static void phase_e_handler(t30_state_t *s, void *user_data, int result)
+{
+    phase_e_result[(int) (intptr_t) user_data] = result;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int phase_d_handler(t30_state_t *s, void *user_data, int result)
+{
+    if ((int) (intptr_t) user_data == 1)
+        pages_received++;
+    return T30_ERR_OK;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void configure_t30(t30_state_t *t30, int calling_party, int ecm, const char *rx_file)
+{
+    if (calling_party)
+    {
+        t30_set_tx_ident(t30, "11111111");
+        t30_set_tx_file(t30, INPUT_TIFF_FILE_NAME, -1, -1);
+    }
+    else
+    {
+        t30_set_tx_ident(t30, "22222222");
+        t30_set_rx_file(t30, rx_file, -1);
+    }
+    t30_set_ecm_capability(t30, ecm);
+    t30_set_supported_compressions(t30, T30_SUPPORT_T4_1D_COMPRESSION | T30_SUPPORT_T4_2D_COMPRESSION | T30_SUPPORT_T6_COMPRESSION);
+    t30_set_phase_d_handler(t30, phase_d_handler, (void *) (intptr_t) (calling_party  ?  0  :  1));
+    t30_set_phase_e_handler(t30, phase_e_handler, (void *) (intptr_t) (calling_party  ?  0  :  1));
+}
+/*- End of function --------------------------------------------------------*/
+
+static fax_state_t *new_fax(int calling_party, int ecm, const char *rx_file)
+{
+    fax_state_t *fax;
+
+    if ((fax = fax_init(NULL, calling_party)) == NULL)
+    {
+        printf("Cannot start FAX\n");
+        exit(2);
+    }
+    configure_t30(fax_get_t30_state(fax), calling_party, ecm, rx_file);
+    return fax;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int tx_packet_handler(t38_core_state_t *s, void *user_data, const uint8_t *buf, int len, int count)
+{
+    int dir;
+    int i;
+
+    /* Queue the packets, with their sequence numbers, for delivery on the next tick */
+    dir = (int) (intptr_t) user_data;
+    for (i = 0;  i < count  &&  queued[dir] < MAX_QUEUED_PACKETS;  i++)
+    {
+        memcpy(packet_queue[dir][queued[dir]].buf, buf, len);
+        packet_queue[dir][queued[dir]].len = len;
+        packet_queue[dir][queued[dir]].seq_no = s->tx_seq_no;
+        queued[dir]++;
+    }
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static t38_terminal_state_t *new_t38(int calling_party, int ecm, const char *rx_file)
+{
+    t38_terminal_state_t *t38;
+
+    if ((t38 = t38_terminal_init(NULL, calling_party, tx_packet_handler, (void *) (intptr_t) (calling_party  ?  0  :  1))) == NULL)
+    {
+        printf("Cannot start T.38 terminal\n");
+        exit(2);
+    }
+    configure_t30(t38_terminal_get_t30_state(t38), calling_party, ecm, rx_file);
+    return t38;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void deliver_packets(int dir, t38_terminal_state_t *t38)
+{
+    int i;
+
+    for (i = 0;  i < queued[dir];  i++)
+        t38_core_rx_ifp_packet(t38_terminal_get_t38_core_state(t38), packet_queue[dir][i].buf, packet_queue[dir][i].len, packet_queue[dir][i].seq_no);
+    queued[dir] = 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int pages_in_file(const char *file)
+{
+    TIFF *tiff;
+    int pages;
+
+    if ((tiff = TIFFOpen(file, "r")) == NULL)
+        return 0;
+    pages = TIFFNumberOfDirectories(tiff);
+    TIFFClose(tiff);
+    return pages;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void exchange_audio(fax_state_t *tx, fax_state_t *rx)
+{
+    int16_t tx_amp[SAMPLES_PER_CHUNK];
+    int16_t rx_amp[SAMPLES_PER_CHUNK];
+    int len;
+
+    if ((len = fax_tx(tx, tx_amp, SAMPLES_PER_CHUNK)) < SAMPLES_PER_CHUNK)
+        memset(&tx_amp[len], 0, sizeof(int16_t)*(SAMPLES_PER_CHUNK - len));
+    if ((len = fax_tx(rx, rx_amp, SAMPLES_PER_CHUNK)) < SAMPLES_PER_CHUNK)
+        memset(&rx_amp[len], 0, sizeof(int16_t)*(SAMPLES_PER_CHUNK - len));
+    fax_rx(rx, tx_amp, SAMPLES_PER_CHUNK);
+    fax_rx(tx, rx_amp, SAMPLES_PER_CHUNK);
+}
+/*- End of function --------------------------------------------------------*/
+
+static int check_results(int tx_moves, int rx_moves, int pages_tx, int pages_rx)
+{
+    int rx_pages;
+
+    rx_pages = pages_in_file(OUTPUT_TIFF_FILE_NAME_1) + pages_in_file(OUTPUT_TIFF_FILE_NAME_2);
+    printf("Sender moved %d times, receiver moved %d times\n", tx_moves, rx_moves);
+    printf("Results %d/%d, %d pages sent, %d received, %d in the receive files\n",
+           phase_e_result[0],
+           phase_e_result[1],
+           pages_tx,
+           pages_rx,
+           rx_pages);
+    if (phase_e_result[0] != T30_ERR_OK  ||  phase_e_result[1] != T30_ERR_OK)
+        return -1;
+    if (tx_moves < 2  ||  rx_moves != 1)
+        return -1;
+    if (pages_tx < 2  ||  pages_rx != pages_tx  ||  rx_pages != pages_tx)
+        return -1;
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int test_call(int ecm)
+{
+    fax_state_t *tx;
+    fax_state_t *rx;
+    t30_stats_t tx_stats;
+    t30_stats_t rx_stats;
+    int tx_moves;
+    int rx_moves;
+    int last_move;
+    int len;
+    int i;
+
+    printf("Moving a %s call\n", (ecm)  ?  "ECM"  :  "non-ECM");
+    remove(OUTPUT_TIFF_FILE_NAME_2);
+    tx = new_fax(true, ecm, NULL);
+    rx = new_fax(false, ecm, OUTPUT_TIFF_FILE_NAME_1);
+    phase_e_result[0] =
+    phase_e_result[1] = -1;
+    pages_received = 0;
+    tx_moves = 0;
+    rx_moves = 0;
+    last_move = 0;
+    for (i = 0;  i < 8000*600/SAMPLES_PER_CHUNK;  i++)
+    {
+        exchange_audio(tx, rx);
+        if (phase_e_result[0] >= 0  &&  phase_e_result[1] >= 0)
+            break;
+        /* Move the sender whenever we can, but not more than twice a second */
+        if (i - last_move >= 25  &&  (len = fax_checkpoint(tx, checkpoint, sizeof(checkpoint))) > 0)
+        {
+            fax_free(tx);
+            tx = new_fax(true, ecm, NULL);
+            if (fax_restore(tx, checkpoint, len))
+            {
+                printf("Sender restore failed\n");
+                return -1;
+            }
+            tx_moves++;
+            last_move = i;
+        }
+        /* Move the receiver once, after the first page */
+        if (rx_moves == 0  &&  pages_received >= 1  &&  (len = fax_checkpoint(rx, checkpoint, sizeof(checkpoint))) > 0)
+        {
+            fax_free(rx);
+            rx = new_fax(false, ecm, OUTPUT_TIFF_FILE_NAME_2);
+            if (fax_restore(rx, checkpoint, len))
+            {
+                printf("Receiver restore failed\n");
+                return -1;
+            }
+            rx_moves++;
+        }
+    }
+    t30_get_transfer_statistics(fax_get_t30_state(tx), &tx_stats);
+    t30_get_transfer_statistics(fax_get_t30_state(rx), &rx_stats);
+    fax_free(tx);
+    fax_free(rx);
+    return check_results(tx_moves, rx_moves, tx_stats.pages_tx, rx_stats.pages_rx);
+}
+/*- End of function --------------------------------------------------------*/
+
+static int test_t38_call(int ecm)
+{
+    t38_terminal_state_t *tx;
+    t38_terminal_state_t *rx;
+    t30_stats_t tx_stats;
+    t30_stats_t rx_stats;
+    int tx_moves;
+    int rx_moves;
+    int last_move;
+    int len;
+    int i;
+
+    printf("Moving a %s T.38 call\n", (ecm)  ?  "ECM"  :  "non-ECM");
+    remove(OUTPUT_TIFF_FILE_NAME_2);
+    tx = new_t38(true, ecm, NULL);
+    rx = new_t38(false, ecm, OUTPUT_TIFF_FILE_NAME_1);
+    phase_e_result[0] =
+    phase_e_result[1] = -1;
+    pages_received = 0;
+    queued[0] =
+    queued[1] = 0;
+    tx_moves = 0;
+    rx_moves = 0;
+    last_move = 0;
+    for (i = 0;  i < 8000*600/SAMPLES_PER_CHUNK;  i++)
+    {
+        t38_terminal_send_timeout(tx, SAMPLES_PER_CHUNK);
+        t38_terminal_send_timeout(rx, SAMPLES_PER_CHUNK);
+        deliver_packets(0, rx);
+        deliver_packets(1, tx);
+        if (phase_e_result[0] >= 0  &&  phase_e_result[1] >= 0)
+            break;
+        if (i - last_move >= 25  &&  (len = t38_terminal_checkpoint(tx, checkpoint, sizeof(checkpoint))) > 0)
+        {
+            t38_terminal_free(tx);
+            tx = new_t38(true, ecm, NULL);
+            if (t38_terminal_restore(tx, checkpoint, len))
+            {
+                printf("Sender restore failed\n");
+                return -1;
+            }
+            tx_moves++;
+            last_move = i;
+        }
+        if (rx_moves == 0  &&  pages_received >= 1  &&  (len = t38_terminal_checkpoint(rx, checkpoint, sizeof(checkpoint))) > 0)
+        {
+            t38_terminal_free(rx);
+            rx = new_t38(false, ecm, OUTPUT_TIFF_FILE_NAME_2);
+            if (t38_terminal_restore(rx, checkpoint, len))
+            {
+                printf("Receiver restore failed\n");
+                return -1;
+            }
+            rx_moves++;
+        }
+    }
+    t30_get_transfer_statistics(t38_terminal_get_t30_state(tx), &tx_stats);
+    t30_get_transfer_statistics(t38_terminal_get_t30_state(rx), &rx_stats);
+    t38_terminal_free(tx);
+    t38_terminal_free(rx);
+    return check_results(tx_moves, rx_moves, tx_stats.pages_tx, rx_stats.pages_rx);
+}
+/*- End of function --------------------------------------------------------*/
+
+static int restore_is_rejected(fax_state_t *s, int len)
+{
+    static fax_state_t before;
+
+    /* A checkpoint which is rejected must leave the context exactly as it was */
+    memcpy(&before, s, sizeof(before));
+    if (fax_restore(s, checkpoint, len) == 0)
+        return false;
+    return (memcmp(&before, s, sizeof(before)) == 0);
+}
+/*- End of function --------------------------------------------------------*/
+
+static int field_is_rejected(fax_state_t *s, int len, int field, int32_t value)
+{
+    uint8_t saved[4];
+    uint8_t *t30;
+    int t30_len;
+    int pos;
+    int ok;
+
+    /* Put a bad value in one of the T.30 integer fields, which follow the 6 octet header,
+       and give the T.30 part a good CRC, so the value itself must be checked. */
+    t30 = &checkpoint[4 + V17_RX_TRAINING_STATE_LEN];
+    t30_len = len - 4 - V17_RX_TRAINING_STATE_LEN;
+    pos = 6 + 4*field;
+    memcpy(saved, &t30[pos], 4);
+    t30[pos] = (uint8_t) (value >> 24);
+    t30[pos + 1] = (uint8_t) (value >> 16);
+    t30[pos + 2] = (uint8_t) (value >> 8);
+    t30[pos + 3] = (uint8_t) value;
+    crc_itu16_append(t30, t30_len - 2);
+    ok = restore_is_rejected(s, len);
+    memcpy(&t30[pos], saved, 4);
+    crc_itu16_append(t30, t30_len - 2);
+    return ok;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int test_bad_checkpoints(void)
+{
+    fax_state_t *tx;
+    fax_state_t *rx;
+    int len;
+    int i;
+
+    printf("Testing unusable checkpoints\n");
+    tx = new_fax(true, false, NULL);
+    rx = new_fax(false, false, OUTPUT_TIFF_FILE_NAME_1);
+    /* A call which has not started cannot be checkpointed */
+    if (fax_checkpoint(tx, checkpoint, sizeof(checkpoint)) >= 0)
+        return -1;
+    len = -1;
+    for (i = 0;  i < 8000*60/SAMPLES_PER_CHUNK;  i++)
+    {
+        exchange_audio(tx, rx);
+        if ((len = fax_checkpoint(tx, checkpoint, sizeof(checkpoint))) > 0)
+            break;
+    }
+    if (len <= 0)
+    {
+        printf("No checkpoint could be made\n");
+        return -1;
+    }
+    /* Too small a buffer */
+    if (fax_checkpoint(tx, checkpoint, len - 1) >= 0)
+        return -1;
+    fax_free(tx);
+
+    /* The wrong role */
+    tx = new_fax(false, false, OUTPUT_TIFF_FILE_NAME_2);
+    if (fax_restore(tx, checkpoint, len) == 0)
+        return -1;
+    fax_free(tx);
+
+    /* Damaged, and truncated */
+    tx = new_fax(true, false, NULL);
+    checkpoint[len/2] ^= 0x01;
+    if (!restore_is_rejected(tx, len))
+        return -1;
+    checkpoint[len/2] ^= 0x01;
+    if (!restore_is_rejected(tx, len - 1))
+        return -1;
+    /* Intact, but holding a phase where a call cannot be moved, a state beyond the
+       last one, and a modem fallback step beyond the end of the fallback table. These
+       are the second, third and eighth fields. */
+    if (!field_is_rejected(tx, len, 1, 0)  ||  !field_is_rejected(tx, len, 1, 1000))
+        return -1;
+    if (!field_is_rejected(tx, len, 2, -1)  ||  !field_is_rejected(tx, len, 2, 1000))
+        return -1;
+    if (!field_is_rejected(tx, len, 7, 1000))
+        return -1;
+    /* Intact */
+    if (fax_restore(tx, checkpoint, len))
+        return -1;
+    fax_free(tx);
+    fax_free(rx);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    if (test_bad_checkpoints())
+    {
+        printf("Tests failed\n");
+        exit(2);
+    }
+    if (test_call(false))
+    {
+        printf("Tests failed\n");
+        exit(2);
+    }
+    if (test_call(true))
+    {
+        printf("Tests failed\n");
+        exit(2);
+    }
+    if (test_t38_call(false))
+    {
+        printf("Tests failed\n");
+        exit(2);
+    }
+    if (test_t38_call(true))
+    {
+        printf("Tests failed\n");
+        exit(2);
+    }
+    printf("Tests passed\n");
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+/*- End of file ------------------------------------------------------------*/
@@ -0,0 +1,315 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * fax_idle_tests.c - Tests for skipping the FAX receivers on an idle line.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2013 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \file */
+
+/*! \page fax_idle_tests_page FAX idle line tests
+\section fax_idle_tests_page_sec_1 What does it do
+These tests send a FAX between two FAX contexts, over a silent line, and over a
+line with noise below the idle cutoff. The answering end only answers after
+several seconds, so the calling end spends that time waiting on an idle line.
+Each call is made twice - once with the receivers skipped on an idle line, and
+once with every block of audio passed to them. The calling end must be seen to
+skip the receivers while it waits, and the two calls must otherwise be the same,
+with the same T.30 timers at every step, the same results, and the same pages.
+*/
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#define SPANDSP_EXPOSE_INTERNAL_STRUCTURES
+
+#include "spandsp.h"
+
+#define INPUT_TIFF_FILE_NAME    "../test-data/itu/fax/itutests.tif"
+#define OUTPUT_TIFF_FILE_NAME   "fax_idle_tests.tif"
+
+#define SAMPLES_PER_CHUNK       160
+/* The time the answering end takes to answer the call */
+#define ANSWER_DELAY            (5*SAMPLE_RATE)
+#define NOISE_LEVEL             -65.0f
+
+typedef struct
+{
+    /*! The receive handler the context really set, and its user data */
+    span_rx_handler_t *handler;
+    void *user_data;
+    /*! The number of blocks the context passed to its receivers */
+    int blocks;
+} rx_counter_t;
+
+typedef struct
+{
+    int result[2];
+    int result_time[2];
+    int pages;
+    /*! A checksum of both ends' T.30 timers, after every block */
+    uint32_t timers;
+    /*! The number of blocks each end received, and passed to its receivers */
+    int blocks[2];
+    int processed[2];
+} call_t;
+
+static call_t *current_call;
+static int now;
+
+static void phase_e_handler(t30_state_t *s, void *user_data, int result)
+{
+    int which;
+
+    which = (int) (intptr_t) user_data;
+    current_call->result[which] = result;
+    current_call->result_time[which] = now;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int counting_rx(void *user_data, const int16_t amp[], int len)
+{
+    rx_counter_t *counter;
+
+    counter = (rx_counter_t *) user_data;
+    counter->blocks++;
+    return counter->handler(counter->user_data, amp, len);
+}
+/*- End of function --------------------------------------------------------*/
+
+static void counted_fax_rx(fax_state_t *s, rx_counter_t *counter, int16_t amp[], int len)
+{
+    /* Slip the counter in front of whichever receive handler is current. If the
+       block changes the handler, the new one is left in place. */
+    counter->handler = s->modems.rx_handler;
+    counter->user_data = s->modems.rx_user_data;
+    s->modems.rx_handler = counting_rx;
+    s->modems.rx_user_data = counter;
+    fax_rx(s, amp, len);
+    if (s->modems.rx_handler == counting_rx)
+    {
+        s->modems.rx_handler = counter->handler;
+        s->modems.rx_user_data = counter->user_data;
+    }
+}
+/*- End of function --------------------------------------------------------*/
+
+static uint32_t add_timers(uint32_t sum, t30_state_t *t30)
+{
+    int timers[6];
+    int i;
+
+    timers[0] = t30->timer_t0_t1;
+    timers[1] = t30->timer_t2_t4;
+    timers[2] = t30->timer_t2_t4_is;
+    timers[3] = t30->timer_t3;
+    timers[4] = t30->timer_t5;
+    timers[5] = t30->state;
+    for (i = 0;  i < 6;  i++)
+        sum = (sum ^ (uint32_t) timers[i])*16777619U;
+    return sum;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void configure_t30(t30_state_t *t30, int calling_party, int ecm)
+{
+    if (calling_party)
+    {
+        t30_set_tx_ident(t30, "11111111");
+        t30_set_tx_file(t30, INPUT_TIFF_FILE_NAME, -1, -1);
+    }
+    else
+    {
+        t30_set_tx_ident(t30, "22222222");
+        t30_set_rx_file(t30, OUTPUT_TIFF_FILE_NAME, -1);
+    }
+    t30_set_ecm_capability(t30, ecm);
+    t30_set_supported_compressions(t30, T30_SUPPORT_T4_1D_COMPRESSION | T30_SUPPORT_T4_2D_COMPRESSION | T30_SUPPORT_T6_COMPRESSION);
+    t30_set_supported_modems(t30, T30_SUPPORT_V27TER | T30_SUPPORT_V29);
+    t30_set_phase_e_handler(t30, phase_e_handler, (void *) (intptr_t) (calling_party  ?  0  :  1));
+}
+/*- End of function --------------------------------------------------------*/
+
+static void line(awgn_state_t *noise, int16_t amp[], int len, int chunk)
+{
+    int i;
+
+    if (len < chunk)
+        memset(&amp[len], 0, sizeof(int16_t)*(chunk - len));
+    if (noise)
+    {
+        for (i = 0;  i < chunk;  i++)
+            amp[i] = saturate(amp[i] + awgn(noise));
+    }
+}
+/*- End of function --------------------------------------------------------*/
+
+static int run_call(call_t *call, int ecm, int noisy, int gated)
+{
+    fax_state_t *fax[2];
+    awgn_state_t *noise[2];
+    rx_counter_t counter[2];
+    int16_t amp[2][SAMPLES_PER_CHUNK];
+    t30_stats_t stats;
+    int answered;
+    int len;
+    int i;
+
+    memset(call, 0, sizeof(*call));
+    call->result[0] =
+    call->result[1] = -1;
+    current_call = call;
+    now = 0;
+    noise[0] =
+    noise[1] = NULL;
+    if (noisy)
+    {
+        noise[0] = awgn_init_dbm0(NULL, 1234567, NOISE_LEVEL);
+        noise[1] = awgn_init_dbm0(NULL, 7654321, NOISE_LEVEL);
+    }
+    for (i = 0;  i < 2;  i++)
+    {
+        fax[i] = fax_init(NULL, (i == 0));
+        configure_t30(fax_get_t30_state(fax[i]), (i == 0), ecm);
+        /* No block has a peak at or below -1, so nothing is ever idle line */
+        if (!gated)
+            fax[i]->modems.rx_idle_peak = -1;
+        memset(&counter[i], 0, sizeof(counter[i]));
+    }
+    for (now = 0;  now < 600*SAMPLE_RATE;  now += SAMPLES_PER_CHUNK)
+    {
+        answered = (now >= ANSWER_DELAY);
+        len = fax_tx(fax[0], amp[0], SAMPLES_PER_CHUNK);
+        line(noise[0], amp[0], len, SAMPLES_PER_CHUNK);
+        if (answered)
+        {
+            len = fax_tx(fax[1], amp[1], SAMPLES_PER_CHUNK);
+            line(noise[1], amp[1], len, SAMPLES_PER_CHUNK);
+            counted_fax_rx(fax[1], &counter[1], amp[0], SAMPLES_PER_CHUNK);
+            call->blocks[1]++;
+        }
+        else
+        {
+            /* The calling end hears the idle line until the call is answered */
+            line(noise[1], amp[1], 0, SAMPLES_PER_CHUNK);
+        }
+        counted_fax_rx(fax[0], &counter[0], amp[1], SAMPLES_PER_CHUNK);
+        call->blocks[0]++;
+        call->timers = add_timers(call->timers, fax_get_t30_state(fax[0]));
+        call->timers = add_timers(call->timers, fax_get_t30_state(fax[1]));
+        if (call->result[0] >= 0  &&  call->result[1] >= 0)
+            break;
+    }
+    t30_get_transfer_statistics(fax_get_t30_state(fax[1]), &stats);
+    call->pages = stats.pages_rx;
+    for (i = 0;  i < 2;  i++)
+    {
+        call->processed[i] = counter[i].blocks;
+        fax_free(fax[i]);
+        if (noise[i])
+            awgn_free(noise[i]);
+    }
+    printf("    %s: result %d/%d at %d/%d, %d pages, blocks processed %d of %d and %d of %d, timers %08X\n",
+           (gated)  ?  "Gated  "  :  "Ungated",
+           call->result[0],
+           call->result[1],
+           call->result_time[0],
+           call->result_time[1],
+           call->pages,
+           call->processed[0],
+           call->blocks[0],
+           call->processed[1],
+           call->blocks[1],
+           call->timers);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int test_idle_call(int ecm, int noisy)
+{
+    call_t gated;
+    call_t ungated;
+
+    printf("Testing a %s call on a %s line\n", (ecm)  ?  "ECM"  :  "non-ECM", (noisy)  ?  "noisy"  :  "silent");
+    run_call(&ungated, ecm, noisy, false);
+    run_call(&gated, ecm, noisy, true);
+    if (ungated.result[0] != T30_ERR_OK  ||  ungated.result[1] != T30_ERR_OK  ||  ungated.pages < 2)
+    {
+        printf("    The call failed\n");
+        return -1;
+    }
+    if (ungated.processed[0] != ungated.blocks[0]  ||  ungated.processed[1] != ungated.blocks[1])
+    {
+        printf("    Blocks were skipped with no gating\n");
+        return -1;
+    }
+    /* The calling end waits for the answer on an idle line, less the time its
+       receivers need to settle, so most of that wait must be skipped */
+    if (gated.blocks[0] - gated.processed[0] < (ANSWER_DELAY - SAMPLE_RATE)/SAMPLES_PER_CHUNK)
+    {
+        printf("    Too few idle blocks were skipped\n");
+        return -1;
+    }
+    if (gated.result[0] != ungated.result[0]
+        ||
+        gated.result[1] != ungated.result[1]
+        ||
+        gated.result_time[0] != ungated.result_time[0]
+        ||
+        gated.result_time[1] != ungated.result_time[1]
+        ||
+        gated.pages != ungated.pages)
+    {
+        printf("    The gated call ended differently\n");
+        return -1;
+    }
+    if (gated.timers != ungated.timers)
+    {
+        printf("    The T.30 timers differed\n");
+        return -1;
+    }
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    if (test_idle_call(false, false)
+        ||
+        test_idle_call(false, true)
+        ||
+        test_idle_call(true, false)
+        ||
+        test_idle_call(true, true))
+    {
+        printf("Tests failed\n");
+        exit(2);
+    }
+    printf("Tests passed\n");
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+/*- End of file ------------------------------------------------------------*/
@@ -0,0 +1,467 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * media_replay_tests.c - Tests for replaying calls recorded by a media tap.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2013 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \file */
+
+/*! \page media_replay_tests_page Media replay tests
+\section media_replay_tests_page_sec_1 What does it do
+These tests record one end of a FAX call between two FAX contexts, and one end of
+a FAX call between two T.38 terminal contexts, with a media tap, into a capture
+file. Each capture is then replayed through a fresh context, which must send
+exactly what the original sent, and complete the call in the same way. The pages
+are sent with headers, so the time in them must be taken from the recording. A
+replay through a context set up differently from the original, or at a different
+time, must be seen to depart from the recording.
+*/
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define SPANDSP_EXPOSE_INTERNAL_STRUCTURES
+
+#include "spandsp.h"
+
+#define INPUT_TIFF_FILE_NAME    "../test-data/itu/fax/itutests.tif"
+#define OUTPUT_TIFF_FILE_NAME   "media_replay_tests.tif"
+#define REPLAY_TIFF_FILE_NAME   "media_replay_tests_replay.tif"
+#define CAPTURE_FILE_NAME       "media_replay_tests.cap"
+
+#define SAMPLES_PER_CHUNK       160
+#define MAX_QUEUED_PACKETS      100
+
+static int phase_e_result[2];
+
+static struct
+{
+    uint8_t buf[512];
+    int len;
+    int seq_no;
+} packet_queue[2][MAX_QUEUED_PACKETS];
+static int queued[2];
+static int header_times;
+
+static void phase_e_handler(t30_state_t *s, void *user_data, int result)
+{
+    phase_e_result[(int) (intptr_t) user_data] = result;
+}
+/*- End of function --------------------------------------------------------*/
+
+/* Apply a T.30 setting, in the form "name=value". The recorded end of each call
+   is set up through this, with each setting recorded as a note, so the replay can
+   set up its context in the same way. */
+static int apply_setting(t30_state_t *t30, const char *setting)
+{
+    const char *value;
+
+    if ((value = strchr(setting, '=')) == NULL)
+        return -1;
+    value++;
+    if (strncmp(setting, "ident=", 6) == 0)
+        t30_set_tx_ident(t30, value);
+    else if (strncmp(setting, "tx_file=", 8) == 0)
+        t30_set_tx_file(t30, value, -1, -1);
+    else if (strncmp(setting, "rx_file=", 8) == 0)
+        t30_set_rx_file(t30, value, -1);
+    else if (strncmp(setting, "ecm=", 4) == 0)
+        t30_set_ecm_capability(t30, atoi(value));
+    else if (strncmp(setting, "header=", 7) == 0)
+        t30_set_tx_page_header_info(t30, value);
+    else if (strncmp(setting, "tz=", 3) == 0)
+        t30_set_tx_page_header_tz(t30, value);
+    else
+        return -1;
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void set_and_note(t30_state_t *t30, media_tap_state_t *tap, const char *setting)
+{
+    apply_setting(t30, setting);
+    if (tap)
+        media_tap_note(tap, (const uint8_t *) setting, strlen(setting) + 1);
+}
+/*- End of function --------------------------------------------------------*/
+
+static void configure_t30(t30_state_t *t30, media_tap_state_t *tap, int calling_party, int ecm, const char *rx_file)
+{
+    char setting[128];
+
+    if (calling_party)
+    {
+        set_and_note(t30, tap, "ident=11111111");
+        set_and_note(t30, tap, "tx_file=" INPUT_TIFF_FILE_NAME);
+        set_and_note(t30, tap, "header=Media replay tests");
+        set_and_note(t30, tap, "tz=UTC0");
+    }
+    else
+    {
+        set_and_note(t30, tap, "ident=22222222");
+        snprintf(setting, sizeof(setting), "rx_file=%s", rx_file);
+        set_and_note(t30, tap, setting);
+    }
+    snprintf(setting, sizeof(setting), "ecm=%d", ecm);
+    set_and_note(t30, tap, setting);
+    t30_set_supported_compressions(t30, T30_SUPPORT_T4_1D_COMPRESSION | T30_SUPPORT_T4_2D_COMPRESSION | T30_SUPPORT_T6_COMPRESSION);
+    t30_set_phase_e_handler(t30, phase_e_handler, (void *) (intptr_t) (calling_party  ?  0  :  1));
+}
+/*- End of function --------------------------------------------------------*/
+
+/* The replay's version of the note handling, which redirects any received image
+   away from the original call's file */
+static int note_handler(void *user_data, const uint8_t buf[], int len)
+{
+    if (len < 1  ||  buf[len - 1] != '\0')
+        return -1;
+    if (strncmp((const char *) buf, "rx_file=", 8) == 0)
+        return apply_setting((t30_state_t *) user_data, "rx_file=" REPLAY_TIFF_FILE_NAME);
+    return apply_setting((t30_state_t *) user_data, (const char *) buf);
+}
+/*- End of function --------------------------------------------------------*/
+
+static int wrong_note_handler(void *user_data, const uint8_t buf[], int len)
+{
+    /* Set up the replay with the wrong identity */
+    if (strncmp((const char *) buf, "ident=", 6) == 0)
+        return apply_setting((t30_state_t *) user_data, "ident=33333333");
+    return note_handler(user_data, buf, len);
+}
+/*- End of function --------------------------------------------------------*/
+
+static int write_records(media_tap_state_t *tap, FILE *file)
+{
+    media_tap_record_t rec;
+    uint8_t hdr[MEDIA_TAP_PACKED_HEADER_LEN];
+    uint8_t buf[MEDIA_TAP_MAX_PAYLOAD];
+    int records;
+    int len;
+
+    records = 0;
+    while ((len = media_tap_read(tap, &rec, buf, sizeof(buf))) >= 0)
+    {
+        media_tap_pack_header(hdr, &rec, len);
+        fwrite(hdr, 1, MEDIA_TAP_PACKED_HEADER_LEN, file);
+        fwrite(buf, 1, len, file);
+        records++;
+    }
+    return records;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int replay_file(media_replay_state_t *replay, int *tx_records, int shift_time)
+{
+    media_tap_record_t rec;
+    uint8_t hdr[MEDIA_TAP_PACKED_HEADER_LEN];
+    uint8_t buf[MEDIA_TAP_MAX_PAYLOAD];
+    FILE *file;
+    int64_t when;
+    int records;
+    int len;
+
+    if ((file = fopen(CAPTURE_FILE_NAME, "rb")) == NULL)
+        return -1;
+    records = 0;
+    *tx_records = 0;
+    while (fread(hdr, 1, MEDIA_TAP_PACKED_HEADER_LEN, file) == MEDIA_TAP_PACKED_HEADER_LEN)
+    {
+        if ((len = media_tap_unpack_header(&rec, hdr)) < 0  ||  (int) fread(buf, 1, len, file) != len)
+        {
+            printf("Bad capture file\n");
+            fclose(file);
+            return -1;
+        }
+        if (rec.type == MEDIA_TAP_HEADER_TIME  &&  len == sizeof(when))
+        {
+            /* Replay as though the call was made a day later */
+            memcpy(&when, buf, sizeof(when));
+            when += shift_time;
+            memcpy(buf, &when, sizeof(when));
+            header_times++;
+        }
+        media_replay_record(replay, &rec, buf, len);
+        if (rec.type == MEDIA_TAP_TX_AUDIO  ||  rec.type == MEDIA_TAP_TX_IFP)
+            (*tx_records)++;
+        records++;
+    }
+    fclose(file);
+    return records;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int check_replay(media_replay_state_t *replay, int records, int tx_records, int expect_mismatches)
+{
+    printf("  %d records replayed, %d of them checked, %d mismatches, %d missing\n",
+           records,
+           tx_records,
+           media_replay_get_mismatches(replay),
+           media_replay_get_missing(replay));
+    if (records <= 0  ||  tx_records == 0  ||  media_replay_get_missing(replay))
+        return -1;
+    if (expect_mismatches)
+        return (media_replay_get_mismatches(replay) > 0)  ?  0  :  -1;
+    return (media_replay_get_mismatches(replay) == 0)  ?  0  :  -1;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int exchange_audio(fax_state_t *tx, fax_state_t *rx, int chunk, int fillin)
+{
+    int16_t tx_amp[2000];
+    int16_t rx_amp[2000];
+    int len;
+
+    if ((len = fax_tx(tx, tx_amp, chunk)) < chunk)
+        memset(&tx_amp[len], 0, sizeof(int16_t)*(chunk - len));
+    if ((len = fax_tx(rx, rx_amp, chunk)) < chunk)
+        memset(&rx_amp[len], 0, sizeof(int16_t)*(chunk - len));
+    if (fillin)
+        fax_rx_fillin(rx, chunk);
+    else
+        fax_rx(rx, tx_amp, chunk);
+    fax_rx(tx, rx_amp, chunk);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int test_fax_replay(int ecm)
+{
+    media_tap_state_t *tap;
+    media_replay_state_t *replay;
+    fax_state_t *tx;
+    fax_state_t *rx;
+    t30_stats_t stats;
+    FILE *file;
+    int records;
+    int tx_records;
+    int pages;
+    int wrong;
+    int chunk;
+    int i;
+
+    printf("Replaying a %s FAX call\n", (ecm)  ?  "ECM"  :  "non-ECM");
+    if ((tap = media_tap_init(NULL, 1000000)) == NULL)
+        return -1;
+    media_tap_set_mask(tap, MEDIA_TAP_MASK_RECORD);
+    if ((file = fopen(CAPTURE_FILE_NAME, "wb")) == NULL)
+        return -1;
+    /* Record the receiving end. The recording must start with the context. */
+    tx = fax_init(NULL, true);
+    configure_t30(fax_get_t30_state(tx), NULL, true, ecm, NULL);
+    rx = fax_init(NULL, false);
+    fax_set_tap(rx, tap);
+    configure_t30(fax_get_t30_state(rx), tap, false, ecm, OUTPUT_TIFF_FILE_NAME);
+    phase_e_result[0] =
+    phase_e_result[1] = -1;
+    records = 0;
+    for (i = 0;  i < 8000*600/SAMPLES_PER_CHUNK;  i++)
+    {
+        /* Use some long blocks, which the tap must split, and a fill-in */
+        chunk = ((i%50) == 49)  ?  1500  :  SAMPLES_PER_CHUNK;
+        exchange_audio(tx, rx, chunk, (i == 10));
+        records += write_records(tap, file);
+        if (phase_e_result[0] >= 0  &&  phase_e_result[1] >= 0)
+            break;
+    }
+    fclose(file);
+    t30_get_transfer_statistics(fax_get_t30_state(rx), &stats);
+    pages = stats.pages_rx;
+    printf("  Call result %d/%d, %d pages received, %d records captured, %d dropped\n",
+           phase_e_result[0],
+           phase_e_result[1],
+           pages,
+           records,
+           media_tap_get_dropped(tap));
+    fax_free(tx);
+    fax_free(rx);
+    media_tap_free(tap);
+    if (phase_e_result[0] != T30_ERR_OK  ||  phase_e_result[1] != T30_ERR_OK  ||  pages < 2)
+        return -1;
+
+    for (wrong = false;  wrong <= true;  wrong++)
+    {
+        printf("  Replay%s\n", (wrong)  ?  " with the wrong identity"  :  "");
+        phase_e_result[1] = -1;
+        rx = fax_init(NULL, false);
+        replay = media_replay_init(NULL, MEDIA_REPLAY_FAX, rx);
+        t30_set_supported_compressions(fax_get_t30_state(rx), T30_SUPPORT_T4_1D_COMPRESSION | T30_SUPPORT_T4_2D_COMPRESSION | T30_SUPPORT_T6_COMPRESSION);
+        t30_set_phase_e_handler(fax_get_t30_state(rx), phase_e_handler, (void *) (intptr_t) 1);
+        media_replay_set_note_handler(replay, (wrong)  ?  wrong_note_handler  :  note_handler, fax_get_t30_state(rx));
+        records = replay_file(replay, &tx_records, 0);
+        t30_get_transfer_statistics(fax_get_t30_state(rx), &stats);
+        if (check_replay(replay, records, tx_records, wrong))
+            return -1;
+        if (!wrong  &&  (phase_e_result[1] != T30_ERR_OK  ||  stats.pages_rx != pages))
+        {
+            printf("  Replay result %d, %d pages received\n", phase_e_result[1], stats.pages_rx);
+            return -1;
+        }
+        media_replay_free(replay);
+        fax_free(rx);
+    }
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int tx_packet_handler(t38_core_state_t *s, void *user_data, const uint8_t *buf, int len, int count)
+{
+    int dir;
+    int i;
+
+    dir = (int) (intptr_t) user_data;
+    if (dir < 0)
+        return 0;
+    for (i = 0;  i < count  &&  queued[dir] < MAX_QUEUED_PACKETS;  i++)
+    {
+        memcpy(packet_queue[dir][queued[dir]].buf, buf, len);
+        packet_queue[dir][queued[dir]].len = len;
+        packet_queue[dir][queued[dir]].seq_no = s->tx_seq_no;
+        queued[dir]++;
+    }
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void deliver_packets(int dir, t38_terminal_state_t *t38)
+{
+    int i;
+
+    for (i = 0;  i < queued[dir];  i++)
+        t38_core_rx_ifp_packet(t38_terminal_get_t38_core_state(t38), packet_queue[dir][i].buf, packet_queue[dir][i].len, packet_queue[dir][i].seq_no);
+    queued[dir] = 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int test_t38_replay(int ecm)
+{
+    media_tap_state_t *tap;
+    media_replay_state_t *replay;
+    t38_terminal_state_t *tx;
+    t38_terminal_state_t *rx;
+    t30_stats_t stats;
+    FILE *file;
+    clock_t start;
+    int records;
+    int tx_records;
+    int pages;
+    int later;
+    int i;
+
+    printf("Replaying a %s T.38 call\n", (ecm)  ?  "ECM"  :  "non-ECM");
+    if ((tap = media_tap_init(NULL, 1000000)) == NULL)
+        return -1;
+    media_tap_set_mask(tap, MEDIA_TAP_MASK_RECORD);
+    if ((file = fopen(CAPTURE_FILE_NAME, "wb")) == NULL)
+        return -1;
+    /* Record the sending end */
+    tx = t38_terminal_init(NULL, true, tx_packet_handler, (void *) (intptr_t) 0);
+    t38_terminal_set_tap(tx, tap);
+    configure_t30(t38_terminal_get_t30_state(tx), tap, true, ecm, NULL);
+    rx = t38_terminal_init(NULL, false, tx_packet_handler, (void *) (intptr_t) 1);
+    configure_t30(t38_terminal_get_t30_state(rx), NULL, false, ecm, OUTPUT_TIFF_FILE_NAME);
+    phase_e_result[0] =
+    phase_e_result[1] = -1;
+    queued[0] =
+    queued[1] = 0;
+    records = 0;
+    for (i = 0;  i < 8000*600/SAMPLES_PER_CHUNK;  i++)
+    {
+        t38_terminal_send_timeout(tx, SAMPLES_PER_CHUNK);
+        t38_terminal_send_timeout(rx, SAMPLES_PER_CHUNK);
+        deliver_packets(0, rx);
+        deliver_packets(1, tx);
+        records += write_records(tap, file);
+        if (phase_e_result[0] >= 0  &&  phase_e_result[1] >= 0)
+            break;
+    }
+    fclose(file);
+    t30_get_transfer_statistics(t38_terminal_get_t30_state(tx), &stats);
+    pages = stats.pages_tx;
+    printf("  Call result %d/%d, %d pages sent, %d records captured, %d dropped\n",
+           phase_e_result[0],
+           phase_e_result[1],
+           pages,
+           records,
+           media_tap_get_dropped(tap));
+    t38_terminal_free(tx);
+    t38_terminal_free(rx);
+    media_tap_free(tap);
+    if (phase_e_result[0] != T30_ERR_OK  ||  phase_e_result[1] != T30_ERR_OK  ||  pages < 2)
+        return -1;
+
+    for (later = false;  later <= true;  later++)
+    {
+        printf("  Replay%s\n", (later)  ?  " with the header time a day later"  :  "");
+        phase_e_result[0] = -1;
+        header_times = 0;
+        tx = t38_terminal_init(NULL, true, tx_packet_handler, (void *) (intptr_t) -1);
+        replay = media_replay_init(NULL, MEDIA_REPLAY_T38_TERMINAL, tx);
+        t30_set_supported_compressions(t38_terminal_get_t30_state(tx), T30_SUPPORT_T4_1D_COMPRESSION | T30_SUPPORT_T4_2D_COMPRESSION | T30_SUPPORT_T6_COMPRESSION);
+        t30_set_phase_e_handler(t38_terminal_get_t30_state(tx), phase_e_handler, (void *) (intptr_t) 0);
+        media_replay_set_note_handler(replay, note_handler, t38_terminal_get_t30_state(tx));
+        start = clock();
+        records = replay_file(replay, &tx_records, (later)  ?  86400  :  0);
+        printf("  Replayed in %.3fs of CPU time\n", (double) (clock() - start)/CLOCKS_PER_SEC);
+        t30_get_transfer_statistics(t38_terminal_get_t30_state(tx), &stats);
+        /* The pages have headers, so the time for them must be in the recording */
+        if (header_times == 0)
+        {
+            printf("  No header time recorded\n");
+            return -1;
+        }
+        if (check_replay(replay, records, tx_records, later))
+            return -1;
+        if (!later  &&  (phase_e_result[0] != T30_ERR_OK  ||  stats.pages_tx != pages))
+        {
+            printf("  Replay result %d, %d pages sent\n", phase_e_result[0], stats.pages_tx);
+            return -1;
+        }
+        media_replay_free(replay);
+        t38_terminal_free(tx);
+    }
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    if (test_fax_replay(false)  ||  test_fax_replay(true))
+    {
+        printf("Tests failed\n");
+        exit(2);
+    }
+    if (test_t38_replay(false)  ||  test_t38_replay(true))
+    {
+        printf("Tests failed\n");
+        exit(2);
+    }
+    printf("Tests passed\n");
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+/*- End of file ------------------------------------------------------------*/
@@ -0,0 +1,299 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * media_tap_tests.c - Tests for the media capture taps.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2013 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \file */
+
+/*! \page media_tap_tests_page Media tap tests
+\section media_tap_tests_page_sec_1 What does it do
+These tests check that audio and IFP packets offered to a media tap come out
+intact, in order, and correctly labelled; that long blocks of audio are split
+across records without losing their timing; that a full tap drops and counts
+records, rather than blocking; and that the FAX and T.38 contexts feed a tap
+attached to them.
+*/
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "spandsp.h"
+
+static uint8_t rec_buf[MEDIA_TAP_MAX_PAYLOAD];
+
+static int check_record(media_tap_state_t *tap, int type, uint32_t seq_no, uint32_t sample_time, const void *payload, int len)
+{
+    media_tap_record_t rec;
+    int rec_len;
+
+    if ((rec_len = media_tap_read(tap, &rec, rec_buf, sizeof(rec_buf))) < 0)
+    {
+        printf("Record %u missing\n", seq_no);
+        return -1;
+    }
+    if (rec.type != type  ||  rec.seq_no != seq_no  ||  rec.sample_time != sample_time)
+    {
+        printf("Record %u: got type %d, seq %u, time %u - expected type %d, time %u\n",
+               seq_no,
+               rec.type,
+               rec.seq_no,
+               rec.sample_time,
+               type,
+               sample_time);
+        return -1;
+    }
+    if (payload  &&  (rec_len != len  ||  memcmp(rec_buf, payload, len)))
+    {
+        printf("Record %u: bad payload\n", seq_no);
+        return -1;
+    }
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int test_records(void)
+{
+    media_tap_state_t *tap;
+    media_tap_record_t rec;
+    int16_t amp[3000];
+    uint8_t ifp[3];
+    int i;
+
+    if ((tap = media_tap_init(NULL, 20000)) == NULL)
+        return -1;
+    for (i = 0;  i < 3000;  i++)
+        amp[i] = (int16_t) (i*7);
+    ifp[0] = 0x00;
+    ifp[1] = 0x12;
+    ifp[2] = 0x34;
+
+    media_tap_audio(tap, MEDIA_TAP_RX_AUDIO, amp, 160);
+    media_tap_audio(tap, MEDIA_TAP_TX_AUDIO, amp, 80);
+    media_tap_ifp(tap, MEDIA_TAP_RX_IFP, ifp, 3, 42);
+    media_tap_audio_fillin(tap, MEDIA_TAP_RX_AUDIO, 160);
+    /* This should be split over several records */
+    media_tap_audio(tap, MEDIA_TAP_RX_AUDIO, amp, 3000);
+    media_tap_ifp(tap, MEDIA_TAP_TX_IFP, ifp, 3, 7);
+
+    if (check_record(tap, MEDIA_TAP_RX_AUDIO, 0, 0, amp, 160*sizeof(int16_t)))
+        return -1;
+    if (check_record(tap, MEDIA_TAP_TX_AUDIO, 1, 0, amp, 80*sizeof(int16_t)))
+        return -1;
+    if (check_record(tap, MEDIA_TAP_RX_IFP, 2, 160, ifp, 3))
+        return -1;
+    if (check_record(tap, MEDIA_TAP_RX_AUDIO, 3, 320, amp, 1024*sizeof(int16_t)))
+        return -1;
+    if (check_record(tap, MEDIA_TAP_RX_AUDIO, 4, 320 + 1024, &amp[1024], 1024*sizeof(int16_t)))
+        return -1;
+    if (check_record(tap, MEDIA_TAP_RX_AUDIO, 5, 320 + 2048, &amp[2048], 952*sizeof(int16_t)))
+        return -1;
+    if (check_record(tap, MEDIA_TAP_TX_IFP, 6, 3320, ifp, 3))
+        return -1;
+    if (media_tap_read(tap, &rec, rec_buf, sizeof(rec_buf)) >= 0)
+    {
+        printf("Unexpected extra record\n");
+        return -1;
+    }
+
+    /* Only IFP packets should now be captured, although the audio still keeps time */
+    media_tap_set_mask(tap, (1 << MEDIA_TAP_RX_IFP) | (1 << MEDIA_TAP_TX_IFP));
+    media_tap_audio(tap, MEDIA_TAP_RX_AUDIO, amp, 160);
+    media_tap_ifp(tap, MEDIA_TAP_RX_IFP, ifp, 3, 43);
+    if (check_record(tap, MEDIA_TAP_RX_IFP, 7, 3480, ifp, 3))
+        return -1;
+    if (media_tap_get_dropped(tap) != 0)
+    {
+        printf("Records dropped\n");
+        return -1;
+    }
+    media_tap_free(tap);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int test_overflow(void)
+{
+    media_tap_state_t *tap;
+    media_tap_record_t rec;
+    int16_t amp[160];
+    uint32_t seq_no;
+    int records;
+    int i;
+
+    /* A tap with room for only a few blocks of audio */
+    if ((tap = media_tap_init(NULL, 4000)) == NULL)
+        return -1;
+    memset(amp, 0, sizeof(amp));
+    records = 0;
+    for (i = 0;  i < 100;  i++)
+    {
+        if (media_tap_audio(tap, MEDIA_TAP_RX_AUDIO, amp, 160) < 0  &&  (i%25) < 10)
+        {
+            printf("Record %d dropped too soon\n", i);
+            return -1;
+        }
+        /* Drain the tap now and then, as a slow writer thread would */
+        if ((i%25) == 24  &&  i < 75)
+        {
+            while (media_tap_read(tap, &rec, rec_buf, sizeof(rec_buf)) >= 0)
+                records++;
+        }
+    }
+    /* What is left should be the oldest records since the last drain, as the
+       tap drops new records, rather than overwriting old ones */
+    seq_no = 75;
+    while (media_tap_read(tap, &rec, rec_buf, sizeof(rec_buf)) >= 0)
+    {
+        if (rec.seq_no != seq_no  ||  rec.sample_time != rec.seq_no*160)
+        {
+            printf("Record %u has sequence number %u, and time %u\n", seq_no, rec.seq_no, rec.sample_time);
+            return -1;
+        }
+        seq_no++;
+        records++;
+    }
+    printf("  %d records read, %d records dropped\n", records, media_tap_get_dropped(tap));
+    if (media_tap_get_dropped(tap) == 0  ||  records + media_tap_get_dropped(tap) != 100)
+        return -1;
+    media_tap_free(tap);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int tx_packet_handler(t38_core_state_t *s, void *user_data, const uint8_t *buf, int len, int count)
+{
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int rx_indicator_handler(t38_core_state_t *s, void *user_data, int indicator)
+{
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int rx_data_handler(t38_core_state_t *s, void *user_data, int data_type, int field_type, const uint8_t *buf, int len)
+{
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int rx_missing_handler(t38_core_state_t *s, void *user_data, int rx_seq_no, int expected_seq_no)
+{
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int test_attached(void)
+{
+    media_tap_state_t *tap;
+    media_tap_record_t rec;
+    fax_state_t *fax;
+    t38_core_state_t *t38;
+    int16_t amp[160];
+    uint8_t ifp[2];
+    int counts[MEDIA_TAP_TX_IFP + 1];
+    int i;
+
+    if ((tap = media_tap_init(NULL, 100000)) == NULL)
+        return -1;
+    if ((fax = fax_init(NULL, true)) == NULL)
+        return -1;
+    fax_set_transmit_on_idle(fax, true);
+    memset(amp, 0, sizeof(amp));
+    /* Nothing should be captured until the tap is attached */
+    fax_tx(fax, amp, 160);
+    fax_rx(fax, amp, 160);
+    fax_set_tap(fax, tap);
+    for (i = 0;  i < 10;  i++)
+    {
+        fax_tx(fax, amp, 160);
+        fax_rx(fax, amp, 160);
+    }
+    fax_set_tap(fax, NULL);
+    fax_tx(fax, amp, 160);
+    fax_rx(fax, amp, 160);
+    fax_free(fax);
+
+    if ((t38 = t38_core_init(NULL, rx_indicator_handler, rx_data_handler, rx_missing_handler, NULL, tx_packet_handler, NULL)) == NULL)
+        return -1;
+    t38_core_set_tap(t38, tap);
+    t38_core_send_indicator(t38, T38_IND_CNG);
+    ifp[0] = 0x00;
+    ifp[1] = 0x00;
+    t38_core_rx_ifp_packet(t38, ifp, 1, 0);
+    t38_core_free(t38);
+
+    memset(counts, 0, sizeof(counts));
+    while (media_tap_read(tap, &rec, rec_buf, sizeof(rec_buf)) >= 0)
+        counts[rec.type]++;
+    printf("  %d rx audio, %d tx audio, %d rx IFP, %d tx IFP\n",
+           counts[MEDIA_TAP_RX_AUDIO],
+           counts[MEDIA_TAP_TX_AUDIO],
+           counts[MEDIA_TAP_RX_IFP],
+           counts[MEDIA_TAP_TX_IFP]);
+    if (counts[MEDIA_TAP_RX_AUDIO] != 10
+        ||
+        counts[MEDIA_TAP_TX_AUDIO] != 10
+        ||
+        counts[MEDIA_TAP_RX_IFP] != 1
+        ||
+        counts[MEDIA_TAP_TX_IFP] != 1)
+    {
+        return -1;
+    }
+    media_tap_free(tap);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    printf("Records\n");
+    if (test_records())
+    {
+        printf("Tests failed\n");
+        exit(2);
+    }
+    printf("Overflow\n");
+    if (test_overflow())
+    {
+        printf("Tests failed\n");
+        exit(2);
+    }
+    printf("Attached to FAX and T.38 contexts\n");
+    if (test_attached())
+    {
+        printf("Tests failed\n");
+        exit(2);
+    }
+    printf("Tests passed\n");
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+/*- End of file ------------------------------------------------------------*/
@@ -0,0 +1,292 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * memory_footprint.c - report the memory used by spandsp instances.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2013 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \page memory_footprint_page Memory footprint report
+\section memory_footprint_page_sec_1 What does it do?
+This program prints the size of every state structure in the register kept by
+the library, and then the memory used by an instance of some typical
+configurations - FAX over audio, a T.38 terminal, a T.38 gateway, a T.31
+modem, and echo cancellers of various lengths. It is intended for capacity
+planning, and for checking the effect of work to reduce memory use.
+
+\section memory_footprint_page_sec_2 How does it work?
+Counting allocators are installed with span_mem_allocators(). Each configuration
+is then created with a NULL state pointer, so everything it needs is allocated
+through the counters. The static part is the size of the main state structure,
+from the register. The dynamic part is everything else the init function
+allocated. The instance is then freed, and any memory not returned is reported.
+*/
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "spandsp.h"
+
+#define MAX_BLOCKS          4096
+
+/* The live blocks, so frees can be matched to the sizes allocated */
+static struct
+{
+    void *ptr;
+    size_t size;
+} blocks[MAX_BLOCKS];
+static size_t live_bytes = 0;
+
+static int find_block(void *ptr)
+{
+    int i;
+
+    for (i = 0;  i < MAX_BLOCKS;  i++)
+    {
+        if (blocks[i].ptr == ptr)
+            return i;
+    }
+    return -1;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void add_block(void *ptr, size_t size)
+{
+    int i;
+
+    if (ptr == NULL)
+        return;
+    if ((i = find_block(NULL)) < 0)
+    {
+        fprintf(stderr, "Too many blocks to track\n");
+        exit(2);
+    }
+    blocks[i].ptr = ptr;
+    blocks[i].size = size;
+    live_bytes += size;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void remove_block(int i)
+{
+    /* Memory from strdup(), and the like, is freed through span_free(). We didn't
+       see it allocated, so just ignore it. */
+    if (i < 0)
+        return;
+    live_bytes -= blocks[i].size;
+    blocks[i].ptr = NULL;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void *counting_alloc(size_t size)
+{
+    void *ptr;
+
+    ptr = malloc(size);
+    add_block(ptr, size);
+    return ptr;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void *counting_realloc(void *ptr, size_t size)
+{
+    void *new_ptr;
+    int i;
+
+    i = (ptr)  ?  find_block(ptr)  :  -1;
+    if ((new_ptr = realloc(ptr, size)) == NULL)
+        return NULL;
+    remove_block(i);
+    add_block(new_ptr, size);
+    return new_ptr;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void counting_free(void *ptr)
+{
+    if (ptr)
+        remove_block(find_block(ptr));
+    free(ptr);
+}
+/*- End of function --------------------------------------------------------*/
+
+static void *counting_aligned_alloc(size_t alignment, size_t size)
+{
+    void *ptr;
+
+    if (posix_memalign(&ptr, alignment, size))
+        return NULL;
+    add_block(ptr, size);
+    return ptr;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int at_tx_handler(at_state_t *s, void *user_data, const uint8_t *buf, size_t len)
+{
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int modem_control_handler(t31_state_t *s, void *user_data, int op, const char *num)
+{
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int t38_tx_packet_handler(t38_core_state_t *s, void *user_data, const uint8_t *buf, int len, int count)
+{
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void report(const char *config, const char *state_type, size_t before, size_t after)
+{
+    int size;
+
+    size = span_state_size(state_type);
+    printf("%-40s %10d %10d %10d\n", config, size, (int) (after - before) - size, (int) (after - before));
+}
+/*- End of function --------------------------------------------------------*/
+
+static void check_leaks(const char *config, size_t before)
+{
+    if (live_bytes != before)
+        printf("    %s did not free %d bytes\n", config, (int) (live_bytes - before));
+}
+/*- End of function --------------------------------------------------------*/
+
+static void configuration_footprints(void)
+{
+    static const int echo_taps[] =
+    {
+        128, 256, 512, 1024, 0
+    };
+    fax_state_t *fax;
+    t38_terminal_state_t *t38_terminal;
+    t38_gateway_state_t *t38_gateway;
+    t31_state_t *t31;
+    echo_can_state_t *ec;
+    modem_echo_can_state_t *mec;
+    char config[80];
+    size_t before;
+    int i;
+
+    printf("%-40s %10s %10s %10s\n", "Configuration", "Static", "Dynamic", "Total");
+
+    before = live_bytes;
+    fax = fax_init(NULL, true);
+    report("FAX over audio", "fax_state_t", before, live_bytes);
+    fax_free(fax);
+    check_leaks("FAX over audio", before);
+
+    before = live_bytes;
+    t38_terminal = t38_terminal_init(NULL, true, t38_tx_packet_handler, NULL);
+    report("T.38 terminal", "t38_terminal_state_t", before, live_bytes);
+    t38_terminal_free(t38_terminal);
+    check_leaks("T.38 terminal", before);
+
+    before = live_bytes;
+    t38_gateway = t38_gateway_init(NULL, t38_tx_packet_handler, NULL);
+    report("T.38 gateway", "t38_gateway_state_t", before, live_bytes);
+    t38_gateway_free(t38_gateway);
+    check_leaks("T.38 gateway", before);
+
+    before = live_bytes;
+    t31 = t31_init(NULL, at_tx_handler, NULL, modem_control_handler, NULL, t38_tx_packet_handler, NULL);
+    report("T.31 modem", "t31_state_t", before, live_bytes);
+    t31_free(t31);
+    check_leaks("T.31 modem", before);
+
+    for (i = 0;  echo_taps[i];  i++)
+    {
+        snprintf(config, sizeof(config), "Echo canceller, %d taps", echo_taps[i]);
+        before = live_bytes;
+        ec = echo_can_init(echo_taps[i], ECHO_CAN_USE_ADAPTION | ECHO_CAN_USE_NLP | ECHO_CAN_USE_CNG);
+        report(config, "echo_can_state_t", before, live_bytes);
+        echo_can_free(ec);
+        check_leaks(config, before);
+    }
+    for (i = 0;  echo_taps[i];  i++)
+    {
+        snprintf(config, sizeof(config), "Modem echo canceller, %d taps", echo_taps[i]);
+        before = live_bytes;
+        mec = modem_echo_can_init(echo_taps[i]);
+        report(config, "modem_echo_can_state_t", before, live_bytes);
+        modem_echo_can_free(mec);
+        check_leaks(config, before);
+    }
+}
+/*- End of function --------------------------------------------------------*/
+
+static void state_sizes(void)
+{
+    const span_state_size_t *sizes;
+    int entries;
+    int i;
+
+    printf("%-40s %10s\n", "State type", "Size");
+    sizes = span_state_sizes(&entries);
+    for (i = 0;  i < entries;  i++)
+        printf("%-40s %10d\n", sizes[i].name, (int) sizes[i].size);
+    /*endfor*/
+}
+/*- End of function --------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    int show_register;
+    int opt;
+
+    show_register = true;
+    while ((opt = getopt(argc, argv, "c")) != -1)
+    {
+        switch (opt)
+        {
+        case 'c':
+            /* Only show the configurations */
+            show_register = false;
+            break;
+        default:
+            //usage();
+            exit(2);
+            break;
+        }
+    }
+    span_mem_allocators(counting_alloc,
+                        counting_realloc,
+                        counting_free,
+                        counting_aligned_alloc,
+                        counting_free);
+    if (show_register)
+    {
+        state_sizes();
+        printf("\n");
+    }
+    configuration_footprints();
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+/*- End of file ------------------------------------------------------------*/
@@ -107,9 +107,32 @@ enum
     PERFORM_TEST_6B = (1 << 20),
     PERFORM_TEST_7A = (1 << 21),
     PERFORM_TEST_7B = (1 << 22),
-    PERFORM_TEST_8 = (1 << 23)
+    PERFORM_TEST_8 = (1 << 23),
+    PERFORM_TEST_9 = (1 << 24)
 };
 
+#define BANK_CHANNELS               9
+
+/* The signal sent on each channel of the receiver bank test, and the classification expected for it */
+static const struct
+{
+    int tx_tone;
+    int rx_tone;
+} bank_signals[BANK_CHANNELS] =
+{
+    {MODEM_CONNECT_TONES_FAX_CNG, MODEM_CONNECT_TONES_FAX_CNG},
+    {MODEM_CONNECT_TONES_FAX_CED, MODEM_CONNECT_TONES_ANS},
+    {MODEM_CONNECT_TONES_ANS_PR, MODEM_CONNECT_TONES_ANS_PR},
+    {MODEM_CONNECT_TONES_ANSAM, MODEM_CONNECT_TONES_ANSAM},
+    {MODEM_CONNECT_TONES_ANSAM_PR, MODEM_CONNECT_TONES_ANSAM_PR},
+    {MODEM_CONNECT_TONES_FAX_PREAMBLE, MODEM_CONNECT_TONES_FAX_PREAMBLE},
+    {MODEM_CONNECT_TONES_NONE, MODEM_CONNECT_TONES_NONE},
+    {MODEM_CONNECT_TONES_FAX_CNG, MODEM_CONNECT_TONES_FAX_CNG},
+    {MODEM_CONNECT_TONES_ANSAM_PR, MODEM_CONNECT_TONES_ANSAM_PR}
+};
+
+static int bank_hits[BANK_CHANNELS];
+
 int preamble_count = 0;
 int preamble_on_at = -1;
 int preamble_off_at = -1;
@@ -181,6 +204,32 @@ static void ans_pr_detected(void *user_data, int tone, int level, int delay)
 }
 /*- End of function --------------------------------------------------------*/
 
+static int flags_get_bit(void *user_data)
+{
+    int *bit_no;
+    int bit;
+
+    /* Generate continuous HDLC flag octet preamble */
+    bit_no = (int *) user_data;
+    bit = (*bit_no < 2)  ?  0  :  1;
+    if (++(*bit_no) >= 8)
+        *bit_no = 0;
+    return bit;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void bank_detected(void *user_data, int channel, int tone, int level)
+{
+    printf("Channel %d classified as %s (%d) at %fs (%ddBm0)\n", channel, modem_connect_tone_to_str(tone), tone, (float) when/SAMPLE_RATE, level);
+    if (bank_hits[channel] != MODEM_CONNECT_TONES_NONE)
+    {
+        printf("Channel %d classified twice\n", channel);
+        exit(2);
+    }
+    bank_hits[channel] = tone;
+}
+/*- End of function --------------------------------------------------------*/
+
 int main(int argc, char *argv[])
 {
     int i;
@@ -214,6 +263,12 @@ int main(int argc, char *argv[])
     int opt;
     char *decode_test_file;
     fsk_tx_state_t preamble_tx;
+    modem_connect_tones_rx_bank_state_t *bank;
+    modem_connect_tones_tx_state_t bank_tx[BANK_CHANNELS];
+    fsk_tx_state_t bank_preamble_tx;
+    int bank_preamble_bit_no;
+    int16_t bank_amp[BANK_CHANNELS][SAMPLES_PER_CHUNK];
+    const int16_t *bank_amps[BANK_CHANNELS];
 
     test_list = 0;
     decode_test_file = NULL;
@@ -280,6 +335,8 @@ int main(int argc, char *argv[])
             test_list |= PERFORM_TEST_7B;
         else if (strcasecmp(argv[i], "8") == 0)
             test_list |= PERFORM_TEST_8;
+        else if (strcasecmp(argv[i], "9") == 0)
+            test_list |= PERFORM_TEST_9;
         else
         {
             fprintf(stderr, "Unknown test '%s' specified\n", argv[i]);
@@ -1390,6 +1447,81 @@ int main(int argc, char *argv[])
     }
     /*endif*/
 
+    if ((test_list & PERFORM_TEST_9))
+    {
+        printf("Test 9: Classification of many channels with a receiver bank\n");
+        awgn_init_dbm0(&chan_noise_source, 7162534, -50.0f);
+        if ((bank = modem_connect_tones_rx_bank_init(NULL, BANK_CHANNELS, bank_detected, NULL)) == NULL)
+        {
+            printf("    Cannot create receiver bank\n");
+            exit(2);
+        }
+        /*endif*/
+        for (j = 0;  j < BANK_CHANNELS;  j++)
+        {
+            bank_hits[j] = MODEM_CONNECT_TONES_NONE;
+            bank_amps[j] = bank_amp[j];
+            if (bank_signals[j].tx_tone != MODEM_CONNECT_TONES_NONE  &&  bank_signals[j].tx_tone != MODEM_CONNECT_TONES_FAX_PREAMBLE)
+                modem_connect_tones_tx_init(&bank_tx[j], bank_signals[j].tx_tone);
+            /*endif*/
+        }
+        /*endfor*/
+        bank_preamble_bit_no = 0;
+        fsk_tx_init(&bank_preamble_tx, &preset_fsk_specs[FSK_V21CH2], flags_get_bit, &bank_preamble_bit_no);
+        for (when = 0;  when < 5*SAMPLE_RATE;  when += SAMPLES_PER_CHUNK)
+        {
+            for (j = 0;  j < BANK_CHANNELS;  j++)
+            {
+                switch (bank_signals[j].tx_tone)
+                {
+                case MODEM_CONNECT_TONES_NONE:
+                    samples = 0;
+                    break;
+                case MODEM_CONNECT_TONES_FAX_PREAMBLE:
+                    samples = fsk_tx(&bank_preamble_tx, bank_amp[j], SAMPLES_PER_CHUNK);
+                    break;
+                default:
+                    samples = modem_connect_tones_tx(&bank_tx[j], bank_amp[j], SAMPLES_PER_CHUNK);
+                    break;
+                }
+                /*endswitch*/
+                for (i = samples;  i < SAMPLES_PER_CHUNK;  i++)
+                    bank_amp[j][i] = 0;
+                /*endfor*/
+                for (i = 0;  i < SAMPLES_PER_CHUNK;  i++)
+                    bank_amp[j][i] += awgn(&chan_noise_source);
+                /*endfor*/
+            }
+            /*endfor*/
+            modem_connect_tones_rx_bank(bank, bank_amps, SAMPLES_PER_CHUNK);
+        }
+        /*endfor*/
+        for (j = 0;  j < BANK_CHANNELS;  j++)
+        {
+            if (bank_hits[j] != bank_signals[j].rx_tone  ||  modem_connect_tones_rx_bank_get(bank, j) != bank_signals[j].rx_tone)
+            {
+                printf("Channel %d classified as %s, rather than %s\n",
+                       j,
+                       modem_connect_tone_to_str(bank_hits[j]),
+                       modem_connect_tone_to_str(bank_signals[j].rx_tone));
+                printf("Test failed.\n");
+                exit(2);
+            }
+            /*endif*/
+        }
+        /*endfor*/
+        modem_connect_tones_rx_bank_restart(bank, 0);
+        if (modem_connect_tones_rx_bank_get(bank, 0) != MODEM_CONNECT_TONES_NONE)
+        {
+            printf("Test failed.\n");
+            exit(2);
+        }
+        /*endif*/
+        modem_connect_tones_rx_bank_free(bank);
+        printf("Test passed.\n");
+    }
+    /*endif*/
+
     if (decode_test_file)
     {
         printf("Decode file '%s'\n", decode_test_file);
@@ -267,6 +267,10 @@ int main(int argc, char *argv[])
     float unadapted_echo_power;
     float adapted_output_power;
     float adapted_echo_power;
+    int16_t tx_block[160];
+    int16_t rx_block[160];
+    int16_t clean_block[160];
+    int j;
 #if defined(ENABLE_GUI)
     int16_t amp[2];
 #endif
@@ -377,6 +381,51 @@ int main(int argc, char *argv[])
         exit(2);
     }
 
+    /* Repeat the convergence test, using the block processing path. Use an odd block
+       size, so the canceller's internal blocks do not line up with ours. */
+    printf("Block processing\n");
+    modem_echo_can_flush(ctx);
+    signal_restart(&local_css);
+    modem_echo_can_adaption_mode(ctx, true);
+    for (i = 0;  i < 8000*50;  i += 150)
+    {
+        for (j = 0;  j < 150;  j++)
+        {
+            tx_block[j] = signal_amp(&local_css);
+            rx_block[j] = channel_model(tx_block[j], 0);
+        }
+        modem_echo_can_update_block(ctx, clean_block, tx_block, rx_block, 150);
+        for (j = 0;  j < 150;  j++)
+            put_residue(tx_block[j], clean_block[j]);
+    }
+
+    modem_echo_can_adaption_mode(ctx, false);
+    for (i = 0;  i < 8000*5;  i += 150)
+    {
+        for (j = 0;  j < 150;  j++)
+        {
+            tx_block[j] = tone_1khz[(i + j) & 7];
+            rx_block[j] = channel_model(tx_block[j], 0);
+        }
+        modem_echo_can_update_block(ctx, clean_block, tx_block, rx_block, 150);
+        for (j = 0;  j < 150;  j++)
+        {
+            power_meter_update(&power_before, rx_block[j]);
+            power_meter_update(&power_after, clean_block[j]);
+        }
+    }
+    adapted_output_power = power_meter_current_dbm0(&power_before);
+    adapted_echo_power = power_meter_current_dbm0(&power_after);
+    printf("Post-adaption: output power %10.5fdBm0, echo power %10.5fdBm0\n", adapted_output_power, adapted_echo_power);
+
+    if (fabsf(adapted_output_power - unadapted_output_power) > 0.1f
+        ||
+        adapted_echo_power > unadapted_echo_power - 30.0f)
+    {
+        printf("Tests failed.\n");
+        exit(2);
+    }
+
     modem_echo_can_free(ctx);
     signal_free(&local_css);
 
@@ -0,0 +1,337 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * playout_rx_tests.c - Tests for the play-out receive pipeline.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2013 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \file */
+
+/*! \page playout_rx_tests_page Play-out receive pipeline tests
+\section playout_rx_tests_page_sec_1 What does it do?
+These tests pass a stream of coded frames through a simulated network, with
+jitter, loss, and the occasional control frame, into two play-out buffers. One
+is played out by a play-out receive pipeline, and the other by chaining the
+play-out, decoder and concealer calls by hand. Without time scaling, the two
+must produce exactly the same audio. A period of time scaling is then checked
+for the expected change in the amount of audio, and for a clean return to
+normal play-out. Every frame put in the buffer must be handed back exactly once.
+*/
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#define SPANDSP_EXPOSE_INTERNAL_STRUCTURES
+
+#include "spandsp.h"
+
+#define FRAME_LEN           160
+#define FRAMES              1000
+#define CONTROL_FRAMES      10
+
+typedef struct
+{
+    uint8_t data[2*FRAME_LEN];
+    int type;
+    timestamp_t sender_stamp;
+    timestamp_t arrival;
+    int delivered;
+    int handed_back;
+} test_frame_t;
+
+static test_frame_t frames[FRAMES + CONTROL_FRAMES];
+static int total_frames;
+
+static void frame_handler(void *user_data, void *data, int type)
+{
+    test_frame_t *frame;
+
+    frame = (test_frame_t *) ((uint8_t *) data - offsetof(test_frame_t, data));
+    frame->handed_back++;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void make_frames(int coding, int bit_rate)
+{
+    int16_t amp[FRAME_LEN];
+    g726_state_t *g726;
+    int i;
+    int j;
+    int k;
+
+    /* A vowel-like signal, with a 125Hz pitch and a wobbling level */
+    g726 = g726_init(NULL, bit_rate, G726_ENCODING_LINEAR, G726_PACKING_LEFT);
+    srand(1234);
+    k = 0;
+    for (i = 0;  i < FRAMES;  i++)
+    {
+        for (j = 0;  j < FRAME_LEN;  j++, k++)
+        {
+            amp[j] = (int16_t) ((3000.0 + 2000.0*sin(2.0*3.14159*k/4000.0))
+                                *(sin(2.0*3.14159*125.0*k/SAMPLE_RATE)
+                                  + 0.5*sin(2.0*3.14159*375.0*k/SAMPLE_RATE)
+                                  + 0.3*sin(2.0*3.14159*875.0*k/SAMPLE_RATE)));
+        }
+        switch (coding)
+        {
+        case PLAYOUT_RX_LINEAR:
+            memcpy(frames[i].data, amp, sizeof(amp));
+            break;
+        case PLAYOUT_RX_ALAW:
+            for (j = 0;  j < FRAME_LEN;  j++)
+                frames[i].data[j] = linear_to_alaw(amp[j]);
+            break;
+        case PLAYOUT_RX_ULAW:
+            for (j = 0;  j < FRAME_LEN;  j++)
+                frames[i].data[j] = linear_to_ulaw(amp[j]);
+            break;
+        case PLAYOUT_RX_G726:
+            g726_encode(g726, frames[i].data, amp, FRAME_LEN);
+            break;
+        }
+        frames[i].type = PLAYOUT_TYPE_SPEECH;
+        frames[i].sender_stamp = i*FRAME_LEN;
+        /* Jitter of up to 3 frames, with some frames lost */
+        frames[i].arrival = frames[i].sender_stamp + (rand()%(3*FRAME_LEN));
+        if (i > 10  &&  (rand()%100) < 3)
+            frames[i].arrival = 0x7FFFFFFF;
+        frames[i].delivered = false;
+        frames[i].handed_back = 0;
+    }
+    for (i = 0;  i < CONTROL_FRAMES;  i++)
+    {
+        frames[FRAMES + i].type = PLAYOUT_TYPE_CONTROL;
+        frames[FRAMES + i].sender_stamp = (50 + 90*i)*FRAME_LEN;
+        frames[FRAMES + i].arrival = frames[FRAMES + i].sender_stamp;
+        frames[FRAMES + i].delivered = false;
+        frames[FRAMES + i].handed_back = 0;
+    }
+    total_frames = FRAMES + CONTROL_FRAMES;
+    g726_free(g726);
+}
+/*- End of function --------------------------------------------------------*/
+
+static void deliver_frames(playout_state_t *p[2], timestamp_t now)
+{
+    int i;
+
+    for (i = 0;  i < total_frames;  i++)
+    {
+        if (!frames[i].delivered  &&  frames[i].arrival <= now)
+        {
+            if (p[0])
+                playout_put(p[0], frames[i].data, frames[i].type, (frames[i].type == PLAYOUT_TYPE_SPEECH)  ?  FRAME_LEN  :  0, frames[i].sender_stamp, now);
+            if (p[1])
+                playout_put(p[1], frames[i].data, frames[i].type, (frames[i].type == PLAYOUT_TYPE_SPEECH)  ?  FRAME_LEN  :  0, frames[i].sender_stamp, now);
+            frames[i].delivered = true;
+        }
+    }
+}
+/*- End of function --------------------------------------------------------*/
+
+static int by_hand(playout_state_t *p, plc_state_t *plc, g711_state_t *g711, g726_state_t *g726, int coding, int16_t amp[], timestamp_t now)
+{
+    playout_frame_t frame;
+    int ret;
+
+    while ((ret = playout_get(p, &frame, now)) == PLAYOUT_DROP
+           ||
+           (ret == PLAYOUT_OK  &&  frame.type != PLAYOUT_TYPE_SPEECH))
+        ;
+    if (ret != PLAYOUT_OK)
+        return plc_fillin(plc, amp, p->last_speech_sender_len);
+    switch (coding)
+    {
+    case PLAYOUT_RX_LINEAR:
+        memcpy(amp, frame.data, frame.sender_len*sizeof(int16_t));
+        break;
+    case PLAYOUT_RX_ALAW:
+    case PLAYOUT_RX_ULAW:
+        g711_decode(g711, amp, frame.data, frame.sender_len);
+        break;
+    case PLAYOUT_RX_G726:
+        g726_decode(g726, amp, frame.data, frame.sender_len*4/8);
+        break;
+    }
+    return plc_rx(plc, amp, frame.sender_len);
+}
+/*- End of function --------------------------------------------------------*/
+
+static int check_handed_back(void)
+{
+    int i;
+
+    for (i = 0;  i < total_frames;  i++)
+    {
+        if (frames[i].handed_back != ((frames[i].delivered)  ?  1  :  0))
+        {
+            printf("    Frame %d handed back %d times\n", i, frames[i].handed_back);
+            return -1;
+        }
+    }
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int test_matches_by_hand(int coding)
+{
+    static const char *names[] =
+    {
+        "linear", "A-law", "u-law", "G.726"
+    };
+    playout_state_t *p[2];
+    playout_rx_state_t *rx;
+    playout_frame_t *frame;
+    plc_state_t plc;
+    g711_state_t *g711;
+    g726_state_t *g726;
+    int16_t amp[PLAYOUT_RX_MAX_OUTPUT];
+    int16_t ref[PLAYOUT_RX_MAX_OUTPUT];
+    timestamp_t now;
+    int len;
+    int ref_len;
+    int total;
+
+    printf("Testing %s frames against the stages chained by hand\n", names[coding]);
+    make_frames(coding, 32000);
+    p[0] = playout_init(2*FRAME_LEN, 10*FRAME_LEN);
+    p[1] = playout_init(2*FRAME_LEN, 10*FRAME_LEN);
+    rx = playout_rx_init(NULL, p[0], coding, 32000, G726_PACKING_LEFT);
+    playout_rx_set_frame_handler(rx, frame_handler, NULL);
+    plc_init(&plc);
+    g711 = g711_init(NULL, (coding == PLAYOUT_RX_ALAW)  ?  G711_ALAW  :  G711_ULAW);
+    g726 = g726_init(NULL, 32000, G726_ENCODING_LINEAR, G726_PACKING_LEFT);
+    total = 0;
+    for (now = 0;  now < (FRAMES + 20)*FRAME_LEN;  now += FRAME_LEN)
+    {
+        deliver_frames(p, now);
+        len = playout_rx(rx, amp, now);
+        ref_len = by_hand(p[1], &plc, g711, g726, coding, ref, now);
+        if (len != ref_len  ||  memcmp(amp, ref, len*sizeof(int16_t)))
+        {
+            printf("    Mismatch at %d - %d samples, against %d\n", now, len, ref_len);
+            return -1;
+        }
+        total += len;
+    }
+    printf("    %d samples - %d frames played, %d concealed, %d discarded\n", total, rx->frames_played, rx->frames_concealed, rx->frames_discarded);
+    if (rx->frames_concealed == 0  ||  rx->frames_discarded < CONTROL_FRAMES  ||  check_handed_back())
+        return -1;
+    playout_rx_free(rx);
+    while ((frame = playout_get_unconditional(p[0])))
+        ;
+    while ((frame = playout_get_unconditional(p[1])))
+        ;
+    playout_free(p[0]);
+    playout_free(p[1]);
+    g711_free(g711);
+    g726_free(g726);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int test_time_scaling(float rate)
+{
+    playout_state_t *p[2];
+    playout_rx_state_t *rx;
+    int16_t amp[PLAYOUT_RX_MAX_OUTPUT];
+    timestamp_t now;
+    int len;
+    int scaled;
+    int ticks;
+    int expected;
+
+    printf("Testing time scaling at a rate of %.2f\n", rate);
+    make_frames(PLAYOUT_RX_ALAW, 32000);
+    p[0] = playout_init(2*FRAME_LEN, 2*FRAME_LEN);
+    p[1] = NULL;
+    rx = playout_rx_init(NULL, p[0], PLAYOUT_RX_ALAW, 0, 0);
+    playout_rx_set_frame_handler(rx, frame_handler, NULL);
+    scaled = 0;
+    ticks = 0;
+    for (now = 0;  now < 600*FRAME_LEN;  now += FRAME_LEN)
+    {
+        deliver_frames(p, now);
+        if (now == 100*FRAME_LEN)
+            playout_rx_set_rate(rx, rate);
+        else if (now == 300*FRAME_LEN)
+            playout_rx_set_rate(rx, 1.0f);
+        len = playout_rx(rx, amp, now);
+        if (len > PLAYOUT_RX_MAX_OUTPUT)
+        {
+            printf("    %d samples from one call\n", len);
+            return -1;
+        }
+        if (now >= 100*FRAME_LEN  &&  now <= 300*FRAME_LEN)
+        {
+            /* This includes the call which empties the time scaler */
+            scaled += len;
+            ticks++;
+        }
+        else if (now > 300*FRAME_LEN  &&  len != FRAME_LEN)
+        {
+            printf("    %d samples at %d, after time scaling stopped\n", len, now);
+            return -1;
+        }
+    }
+    /* The time scaler makes about rate times as much audio as it is given */
+    expected = (ticks - 1)*FRAME_LEN*rate + FRAME_LEN;
+    printf("    %d samples in %d frame periods, against %d expected\n", scaled, ticks, expected);
+    if (abs(scaled - expected) > FRAME_LEN)
+        return -1;
+    playout_rx_free(rx);
+    while (playout_get_unconditional(p[0]))
+        ;
+    playout_free(p[0]);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    if (test_matches_by_hand(PLAYOUT_RX_LINEAR)
+        ||
+        test_matches_by_hand(PLAYOUT_RX_ALAW)
+        ||
+        test_matches_by_hand(PLAYOUT_RX_ULAW)
+        ||
+        test_matches_by_hand(PLAYOUT_RX_G726))
+    {
+        printf("Tests failed\n");
+        exit(2);
+    }
+    if (test_time_scaling(0.8f)  ||  test_time_scaling(1.25f))
+    {
+        printf("Tests failed\n");
+        exit(2);
+    }
+    printf("Tests passed\n");
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+/*- End of file ------------------------------------------------------------*/
@@ -43,6 +43,15 @@ then
 fi
 echo adsi_tests completed OK
 
+./alloc_tests >$STDOUT_DEST 2>$STDERR_DEST
+RETVAL=$?
+if [ $RETVAL != 0 ]
+then
+    echo alloc_tests failed!
+    exit $RETVAL
+fi
+echo alloc_tests completed OK
+
 ./async_tests >$STDOUT_DEST 2>$STDERR_DEST
 RETVAL=$?
 if [ $RETVAL != 0 ]
@@ -106,6 +115,15 @@ then
 fi
 echo bit_operations_tests completed OK
 
+./channel_group_tests >$STDOUT_DEST 2>$STDERR_DEST
+RETVAL=$?
+if [ $RETVAL != 0 ]
+then
+    echo channel_group_tests failed!
+    exit $RETVAL
+fi
+echo channel_group_tests completed OK
+
 ./complex_tests >$STDOUT_DEST 2>$STDERR_DEST
 RETVAL=$?
 if [ $RETVAL != 0 ]
@@ -244,6 +262,24 @@ then
 fi
 echo fax_tests completed OK
 
+./fax_checkpoint_tests >$STDOUT_DEST 2>$STDERR_DEST
+RETVAL=$?
+if [ $RETVAL != 0 ]
+then
+    echo fax_checkpoint_tests failed!
+    exit $RETVAL
+fi
+echo fax_checkpoint_tests completed OK
+
+./fax_idle_tests >$STDOUT_DEST 2>$STDERR_DEST
+RETVAL=$?
+if [ $RETVAL != 0 ]
+then
+    echo fax_idle_tests failed!
+    exit $RETVAL
+fi
+echo fax_idle_tests completed OK
+
 ./fsk_tests >$STDOUT_DEST 2>$STDERR_DEST
 RETVAL=$?
 if [ $RETVAL != 0 ]
@@ -352,6 +388,24 @@ then
 fi
 echo math_fixed_tests completed OK
 
+./media_tap_tests >$STDOUT_DEST 2>$STDERR_DEST
+RETVAL=$?
+if [ $RETVAL != 0 ]
+then
+    echo media_tap_tests failed!
+    exit $RETVAL
+fi
+echo media_tap_tests completed OK
+
+./media_replay_tests >$STDOUT_DEST 2>$STDERR_DEST
+RETVAL=$?
+if [ $RETVAL != 0 ]
+then
+    echo media_replay_tests failed!
+    exit $RETVAL
+fi
+echo media_replay_tests completed OK
+
 ./modem_echo_tests >$STDOUT_DEST 2>$STDERR_DEST
 RETVAL=$?
 if [ $RETVAL != 0 ]
@@ -398,6 +452,15 @@ echo oki_adpcm_tests completed OK
 #echo playout_tests completed OK
 echo playout_tests not enabled
 
+./playout_rx_tests >$STDOUT_DEST 2>$STDERR_DEST
+RETVAL=$?
+if [ $RETVAL != 0 ]
+then
+    echo playout_rx_tests failed!
+    exit $RETVAL
+fi
+echo playout_rx_tests completed OK
+
 #./plc_tests >$STDOUT_DEST 2>$STDERR_DEST
 #RETVAL=$?
 #if [ $RETVAL != 0 ]
@@ -426,6 +489,15 @@ then
 fi
 echo queue_tests completed OK
 
+./resampler_tests >$STDOUT_DEST 2>$STDERR_DEST
+RETVAL=$?
+if [ $RETVAL != 0 ]
+then
+    echo resampler_tests failed!
+    exit $RETVAL
+fi
+echo resampler_tests completed OK
+
 ./r2_mf_rx_tests >$STDOUT_DEST 2>$STDERR_DEST
 RETVAL=$?
 if [ $RETVAL != 0 ]
@@ -481,6 +553,15 @@ echo schedule_tests completed OK
 #echo sig_tone_tests completed OK
 echo sig_tone_tests not enabled
 
+./state_sizes_tests >$STDOUT_DEST 2>$STDERR_DEST
+RETVAL=$?
+if [ $RETVAL != 0 ]
+then
+    echo state_sizes_tests failed!
+    exit $RETVAL
+fi
+echo state_sizes_tests completed OK
+
 #./super_tone_rx_tests >$STDOUT_DEST 2>$STDERR_DEST
 #RETVAL=$?
 #if [ $RETVAL != 0 ]
@@ -527,6 +608,15 @@ then
 fi
 echo t31_tests completed OK
 
+./t30_counters_tests >$STDOUT_DEST 2>$STDERR_DEST
+RETVAL=$?
+if [ $RETVAL != 0 ]
+then
+    echo t30_counters_tests failed!
+    exit $RETVAL
+fi
+echo t30_counters_tests completed OK
+
 ./t38_core_tests >$STDOUT_DEST 2>$STDERR_DEST
 RETVAL=$?
 if [ $RETVAL != 0 ]
@@ -719,16 +809,14 @@ echo t4_tests completed OK
 #echo t81_t82_arith_coding_tests completed OK
 echo t81_t82_arith_coding_tests not enabled
 
-#rm -f t85_tests_receive.tif
-#./t4_tests >$STDOUT_DEST 2>$STDERR_DEST
-#RETVAL=$?
-#if [ $RETVAL != 0 ]
-#then
-#    echo t85_tests failed!
-#    exit $RETVAL
-#fi
-#echo t85_tests completed OK
-echo t85_tests not enabled
+./t85_tests >$STDOUT_DEST 2>$STDERR_DEST
+RETVAL=$?
+if [ $RETVAL != 0 ]
+then
+    echo t85_tests failed!
+    exit $RETVAL
+fi
+echo t85_tests completed OK
 
 #./time_scale_tests >$STDOUT_DEST 2>$STDERR_DEST
 #RETVAL=$?
@@ -0,0 +1,285 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * resampler_tests.c - Tests for the polyphase sample rate converter.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2013 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \file */
+
+/*! \page resampler_tests_page Resampler tests
+\section resampler_tests_page_sec_1 What does it do
+These tests convert tones between each pair of 8000, 16000 and 48000
+samples/second. Tones in the passband must come through at the right level, and
+with little noise or distortion. Tones which would alias on decimation must be
+rejected. The output must not depend on the block sizes used to feed the
+resampler, and unsupported rate pairs must be refused.
+*/
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "spandsp.h"
+
+#define MAX_RATE                48000
+#define TONE_AMPLITUDE          10000.0
+
+static int16_t in_buf[MAX_RATE*2];
+static int16_t out_buf[MAX_RATE*2];
+static int16_t ref_buf[MAX_RATE*2];
+static int rx_samples;
+
+static const int rates[] =
+{
+    8000, 16000, 48000
+};
+
+static void make_tone(int16_t amp[], int len, int rate, double freq)
+{
+    int i;
+
+    for (i = 0;  i < len;  i++)
+        amp[i] = (int16_t) lrint(TONE_AMPLITUDE*sin(2.0*3.1415926535897932*freq*i/rate));
+}
+/*- End of function --------------------------------------------------------*/
+
+static double tone_analysis(const int16_t amp[], int len, int rate, double freq, double *sinad)
+{
+    double re;
+    double im;
+    double total;
+    double tone;
+    double noise;
+    double phase;
+    int i;
+
+    /* Split the power into the tone's part, and everything else */
+    re = 0.0;
+    im = 0.0;
+    total = 0.0;
+    for (i = 0;  i < len;  i++)
+    {
+        phase = 2.0*3.1415926535897932*freq*i/rate;
+        re += amp[i]*cos(phase);
+        im += amp[i]*sin(phase);
+        total += (double) amp[i]*amp[i];
+    }
+    tone = 2.0*(re*re + im*im)/((double) len*len);
+    total /= len;
+    /* Stop rounding making the noise negative, when there is almost none */
+    noise = (total - tone > 1.0e-9)  ?  (total - tone)  :  1.0e-9;
+    *sinad = 10.0*log10(tone/noise);
+    /* A tone rejected completely gives no output at all */
+    if (total < 1.0e-9)
+        total = 1.0e-9;
+    return 10.0*log10(total/(TONE_AMPLITUDE*TONE_AMPLITUDE/2.0));
+}
+/*- End of function --------------------------------------------------------*/
+
+static int convert(int in_rate, int out_rate, double freq, double *gain, double *sinad)
+{
+    resampler_state_t *s;
+    int outputs;
+    int skip;
+
+    if ((s = resampler_init(NULL, in_rate, out_rate)) == NULL)
+    {
+        printf("Failed to create a %d to %d resampler\n", in_rate, out_rate);
+        return -1;
+    }
+    /* Two seconds of tone in, and analyse the second second of the output, which is a
+       whole number of cycles, well clear of the filter's start up. */
+    make_tone(in_buf, 2*in_rate, in_rate, freq);
+    outputs = resampler(s, out_buf, in_buf, 2*in_rate);
+    if (outputs != 2*out_rate)
+    {
+        printf("%d to %d produced %d samples, instead of %d\n", in_rate, out_rate, outputs, 2*out_rate);
+        return -1;
+    }
+    skip = out_rate;
+    *gain = tone_analysis(&out_buf[skip], out_rate, out_rate, freq, sinad);
+    resampler_free(s);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int test_passband(int in_rate, int out_rate)
+{
+    static const double fractions[] =
+    {
+        0.04, 0.125, 0.25, 0.375, 0.42
+    };
+    double freq;
+    double gain;
+    double sinad;
+    int min_rate;
+    int i;
+
+    min_rate = (in_rate < out_rate)  ?  in_rate  :  out_rate;
+    for (i = 0;  i < (int) (sizeof(fractions)/sizeof(fractions[0]));  i++)
+    {
+        freq = floor(fractions[i]*min_rate);
+        if (convert(in_rate, out_rate, freq, &gain, &sinad))
+            return -1;
+        printf("    %5.0fHz: gain %6.2fdB, SINAD %6.2fdB\n", freq, gain, sinad);
+        if (fabs(gain) > 0.3  ||  sinad < 70.0)
+        {
+            printf("Test failed.\n");
+            return -1;
+        }
+    }
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int test_stopband(int in_rate, int out_rate)
+{
+    static const double fractions[] =
+    {
+        0.53, 0.6, 0.8, 1.0, 1.5, 2.5
+    };
+    double freq;
+    double gain;
+    double sinad;
+    int min_rate;
+    int i;
+
+    min_rate = (in_rate < out_rate)  ?  in_rate  :  out_rate;
+    for (i = 0;  i < (int) (sizeof(fractions)/sizeof(fractions[0]));  i++)
+    {
+        freq = floor(fractions[i]*min_rate);
+        if (freq >= in_rate/2)
+            break;
+        if (convert(in_rate, out_rate, freq, &gain, &sinad))
+            return -1;
+        printf("    %5.0fHz: gain %6.2fdB\n", freq, gain);
+        if (gain > -70.0)
+        {
+            printf("Test failed.\n");
+            return -1;
+        }
+    }
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int rx_handler(void *user_data, const int16_t amp[], int len)
+{
+    if (memcmp(amp, &ref_buf[rx_samples], len*sizeof(int16_t)))
+    {
+        printf("resampler_rx() output differs at %d\n", rx_samples);
+        exit(2);
+    }
+    rx_samples += len;
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int test_block_sizes(int in_rate, int out_rate)
+{
+    static const int block_sizes[] =
+    {
+        1, 7, 160, 1000, 0
+    };
+    resampler_state_t *s;
+    int ref_len;
+    int len;
+    int chunk;
+    int i;
+    int j;
+
+    make_tone(in_buf, in_rate, in_rate, 1000.0);
+    s = resampler_init(NULL, in_rate, out_rate);
+    ref_len = resampler(s, ref_buf, in_buf, in_rate);
+    printf("    Delay %d samples\n", resampler_get_delay(s));
+    for (j = 0;  block_sizes[j];  j++)
+    {
+        resampler_restart(s);
+        len = 0;
+        for (i = 0;  i < in_rate;  i += chunk)
+        {
+            chunk = (in_rate - i < block_sizes[j])  ?  (in_rate - i)  :  block_sizes[j];
+            if (resampler_max_output(s, chunk) < (chunk*out_rate + in_rate - 1)/in_rate)
+            {
+                printf("Bad maximum output size\n");
+                return -1;
+            }
+            len += resampler(s, &out_buf[len], &in_buf[i], chunk);
+        }
+        if (len != ref_len  ||  memcmp(out_buf, ref_buf, len*sizeof(int16_t)))
+        {
+            printf("Output differs with blocks of %d samples\n", block_sizes[j]);
+            return -1;
+        }
+    }
+    resampler_restart(s);
+    rx_samples = 0;
+    resampler_rx(s, rx_handler, NULL, in_buf, in_rate);
+    if (rx_samples != ref_len)
+    {
+        printf("resampler_rx() delivered %d samples, instead of %d\n", rx_samples, ref_len);
+        return -1;
+    }
+    resampler_free(s);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    int i;
+    int j;
+
+    for (i = 0;  i < (int) (sizeof(rates)/sizeof(rates[0]));  i++)
+    {
+        for (j = 0;  j < (int) (sizeof(rates)/sizeof(rates[0]));  j++)
+        {
+            printf("%d to %d samples/second\n", rates[i], rates[j]);
+            printf("  Passband\n");
+            if (test_passband(rates[i], rates[j]))
+                exit(2);
+            if (rates[i] > rates[j])
+            {
+                printf("  Stopband\n");
+                if (test_stopband(rates[i], rates[j]))
+                    exit(2);
+            }
+            printf("  Block sizes\n");
+            if (test_block_sizes(rates[i], rates[j]))
+                exit(2);
+        }
+    }
+    if (resampler_init(NULL, 8000, 44100))
+    {
+        printf("An unsupported rate pair was accepted\n");
+        exit(2);
+    }
+    printf("Tests passed\n");
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+/*- End of file ------------------------------------------------------------*/
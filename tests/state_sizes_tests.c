@@ -0,0 +1,85 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * state_sizes_tests.c - Tests for the state size register.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2013 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \file */
+
+/*! \page state_sizes_tests_page State size register tests
+\section state_sizes_tests_page_sec_1 What does it do?
+These tests look up every entry in the state size register by name, through
+span_state_size(), and check the size found is the one in the register. The
+lookup is a binary search, so an entry added out of alphabetical order makes
+some names impossible to find. The order of the whole register is also checked
+directly, and a name which is not in the register must not be found.
+*/
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "spandsp.h"
+
+int main(int argc, char *argv[])
+{
+    const span_state_size_t *sizes;
+    int entries;
+    int failures;
+    int size;
+    int i;
+
+    failures = 0;
+    sizes = span_state_sizes(&entries);
+    printf("Checking the %d entries in the state size register\n", entries);
+    for (i = 0;  i < entries;  i++)
+    {
+        if (i > 0  &&  strcmp(sizes[i - 1].name, sizes[i].name) >= 0)
+        {
+            printf("    %s is out of order, after %s\n", sizes[i].name, sizes[i - 1].name);
+            failures++;
+        }
+        if ((size = span_state_size(sizes[i].name)) != (int) sizes[i].size)
+        {
+            printf("    Looking up %s gave %d, rather than %d\n", sizes[i].name, size, (int) sizes[i].size);
+            failures++;
+        }
+    }
+    if (span_state_size("no_such_state_t") != -1)
+    {
+        printf("    A name which is not in the register was found\n");
+        failures++;
+    }
+    if (failures)
+    {
+        printf("Tests failed\n");
+        exit(2);
+    }
+    printf("Tests passed\n");
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+/*- End of file ------------------------------------------------------------*/
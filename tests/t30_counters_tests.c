@@ -0,0 +1,332 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * t30_counters_tests.c - Tests for the T.30 counter blocks.
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2013 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \file */
+
+/*! \page t30_counters_tests_page T.30 counter tests
+\section t30_counters_tests_page_sec_1 What does it do
+These tests send FAXes between pairs of FAX contexts, over clean audio paths and
+paths with regular bursts of noise, and between pairs of T.38 terminal contexts.
+Each context updates its own block in an array of counter blocks, which is
+totalled on every tick while the calls are in progress, as a monitoring thread
+would. The totals must only ever grow, and at the end of the calls must agree
+with the calls' own statistics.
+*/
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#define SPANDSP_EXPOSE_INTERNAL_STRUCTURES
+
+#include "spandsp.h"
+
+#define INPUT_TIFF_FILE_NAME    "../test-data/itu/fax/itutests.tif"
+#define OUTPUT_TIFF_FILE_NAME   "t30_counters_tests.tif"
+
+#define SAMPLES_PER_CHUNK       160
+#define MAX_QUEUED_PACKETS      100
+
+/* The longest a call may take, in seconds. A non-ECM call over a line which is
+   regularly hit falls back to low bit rates, and takes about 20 minutes. */
+#define MAX_CALL_TIME           7200
+
+/* The level of the bursts of noise which hit the line */
+#define HIT_LEVEL               -20.0f
+
+static t30_counters_t counters[2];
+static t30_counters_t last_total;
+static int phase_e_result[2];
+
+static struct
+{
+    uint8_t buf[512];
+    int len;
+    int seq_no;
+} packet_queue[2][MAX_QUEUED_PACKETS];
+static int queued[2];
+
+static void phase_e_handler(t30_state_t *s, void *user_data, int result)
+{
+    phase_e_result[(int) (intptr_t) user_data] = result;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void configure_t30(t30_state_t *t30, int calling_party, int ecm)
+{
+    if (calling_party)
+    {
+        t30_set_tx_ident(t30, "11111111");
+        t30_set_tx_file(t30, INPUT_TIFF_FILE_NAME, -1, -1);
+    }
+    else
+    {
+        t30_set_tx_ident(t30, "22222222");
+        t30_set_rx_file(t30, OUTPUT_TIFF_FILE_NAME, -1);
+    }
+    t30_set_ecm_capability(t30, ecm);
+    t30_set_supported_compressions(t30, T30_SUPPORT_T4_1D_COMPRESSION | T30_SUPPORT_T4_2D_COMPRESSION | T30_SUPPORT_T6_COMPRESSION);
+    t30_set_phase_e_handler(t30, phase_e_handler, (void *) (intptr_t) (calling_party  ?  0  :  1));
+    t30_set_counters(t30, &counters[(calling_party)  ?  0  :  1]);
+}
+/*- End of function --------------------------------------------------------*/
+
+static int check_totals(void)
+{
+    t30_counters_t total;
+    const volatile uint32_t *now;
+    const volatile uint32_t *before;
+    int i;
+
+    /* Total the blocks, as a monitoring thread would, and check nothing goes backwards */
+    memset(&total, 0, sizeof(total));
+    for (i = 0;  i < 2;  i++)
+        t30_counters_accumulate(&total, &counters[i]);
+    now = (const volatile uint32_t *) &total;
+    before = (const volatile uint32_t *) &last_total;
+    for (i = 0;  i < (int) (sizeof(total)/sizeof(uint32_t));  i++)
+    {
+        if (now[i] < before[i])
+        {
+            printf("Counter %d went backwards\n", i);
+            return -1;
+        }
+    }
+    last_total = total;
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void print_totals(void)
+{
+    printf("  %u calls (%u failed), %u pages sent, %u received, %u bad rows, %u retrains, %u fallbacks\n",
+           last_total.calls,
+           last_total.calls_failed,
+           last_total.pages_tx,
+           last_total.pages_rx,
+           last_total.bad_rows,
+           last_total.retrains,
+           last_total.fallbacks);
+    printf("  %u PPRs sent, %u received, %u ECM frames resent, %u octets sent, %u received, %.1fs of modem lock\n",
+           last_total.pprs_tx,
+           last_total.pprs_rx,
+           last_total.ecm_frames_resent,
+           last_total.image_octets_tx,
+           last_total.image_octets_rx,
+           last_total.modem_lock_samples/(float) SAMPLE_RATE);
+}
+/*- End of function --------------------------------------------------------*/
+
+static int check_final_totals(int pages_tx, int pages_rx, int ecm, int hits)
+{
+    print_totals();
+    if (last_total.calls != 2  ||  last_total.calls_failed != 0)
+        return -1;
+    if (last_total.pages_tx != (uint32_t) pages_tx  ||  last_total.pages_rx != (uint32_t) pages_rx  ||  pages_tx < 2)
+        return -1;
+    if (last_total.image_octets_tx == 0  ||  last_total.image_octets_rx < last_total.image_octets_tx/2)
+        return -1;
+    if (last_total.pprs_tx != last_total.pprs_rx)
+        return -1;
+    if (hits)
+    {
+        /* Errors in ECM mode should be corrected. Errors in non-ECM mode should make
+           the receiver ask for retrains, and then lower bit rates. */
+        if (ecm)
+        {
+            if (last_total.pprs_tx == 0  ||  last_total.ecm_frames_resent == 0  ||  last_total.image_octets_tx <= last_total.image_octets_rx)
+                return -1;
+        }
+        else
+        {
+            if (last_total.retrains == 0  ||  last_total.fallbacks == 0)
+                return -1;
+        }
+    }
+    else
+    {
+        if (last_total.retrains  ||  last_total.fallbacks  ||  last_total.pprs_tx  ||  last_total.bad_rows)
+            return -1;
+    }
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void start_test(void)
+{
+    memset(counters, 0, sizeof(counters));
+    memset(&last_total, 0, sizeof(last_total));
+    phase_e_result[0] =
+    phase_e_result[1] = -1;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int test_fax_call(int ecm, int hit_interval)
+{
+    fax_state_t *fax[2];
+    awgn_state_t *noise;
+    t30_stats_t stats[2];
+    int16_t amp[2][SAMPLES_PER_CHUNK];
+    int len;
+    int i;
+    int j;
+    int k;
+
+    if (hit_interval)
+        printf("Counting a %s FAX call, over a line hit every %dms\n", (ecm)  ?  "ECM"  :  "non-ECM", hit_interval*SAMPLES_PER_CHUNK/8);
+    else
+        printf("Counting a %s FAX call, over a clean line\n", (ecm)  ?  "ECM"  :  "non-ECM");
+    start_test();
+    noise = awgn_init_dbm0(NULL, 1234567, HIT_LEVEL);
+    for (j = 0;  j < 2;  j++)
+    {
+        fax[j] = fax_init(NULL, (j == 0));
+        configure_t30(fax_get_t30_state(fax[j]), (j == 0), ecm);
+    }
+    for (i = 0;  i < SAMPLE_RATE*MAX_CALL_TIME/SAMPLES_PER_CHUNK;  i++)
+    {
+        for (j = 0;  j < 2;  j++)
+        {
+            if ((len = fax_tx(fax[j], amp[j], SAMPLES_PER_CHUNK)) < SAMPLES_PER_CHUNK)
+                memset(&amp[j][len], 0, sizeof(int16_t)*(SAMPLES_PER_CHUNK - len));
+            /* Only the image direction is hit */
+            if (j == 0  &&  hit_interval  &&  (i%hit_interval) == 0)
+            {
+                for (k = 0;  k < SAMPLES_PER_CHUNK;  k++)
+                    amp[j][k] = saturate(amp[j][k] + awgn(noise));
+            }
+        }
+        fax_rx(fax[1], amp[0], SAMPLES_PER_CHUNK);
+        fax_rx(fax[0], amp[1], SAMPLES_PER_CHUNK);
+        if (check_totals())
+            return -1;
+        if (phase_e_result[0] >= 0  &&  phase_e_result[1] >= 0)
+            break;
+    }
+    for (j = 0;  j < 2;  j++)
+    {
+        t30_get_transfer_statistics(fax_get_t30_state(fax[j]), &stats[j]);
+        fax_free(fax[j]);
+    }
+    awgn_free(noise);
+    if (phase_e_result[0] < 0  ||  phase_e_result[1] < 0)
+    {
+        printf("  The calls did not finish within %ds\n", MAX_CALL_TIME);
+        return -1;
+    }
+    return check_final_totals(stats[0].pages_tx, stats[1].pages_rx, ecm, hit_interval);
+}
+/*- End of function --------------------------------------------------------*/
+
+static int tx_packet_handler(t38_core_state_t *s, void *user_data, const uint8_t *buf, int len, int count)
+{
+    int dir;
+    int i;
+
+    dir = (int) (intptr_t) user_data;
+    for (i = 0;  i < count  &&  queued[dir] < MAX_QUEUED_PACKETS;  i++)
+    {
+        memcpy(packet_queue[dir][queued[dir]].buf, buf, len);
+        packet_queue[dir][queued[dir]].len = len;
+        packet_queue[dir][queued[dir]].seq_no = s->tx_seq_no;
+        queued[dir]++;
+    }
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int test_t38_call(int ecm)
+{
+    t38_terminal_state_t *t38[2];
+    t30_stats_t stats[2];
+    int i;
+    int j;
+    int k;
+
+    printf("Counting a %s T.38 call\n", (ecm)  ?  "ECM"  :  "non-ECM");
+    start_test();
+    queued[0] =
+    queued[1] = 0;
+    for (j = 0;  j < 2;  j++)
+    {
+        t38[j] = t38_terminal_init(NULL, (j == 0), tx_packet_handler, (void *) (intptr_t) j);
+        configure_t30(t38_terminal_get_t30_state(t38[j]), (j == 0), ecm);
+    }
+    for (i = 0;  i < SAMPLE_RATE*MAX_CALL_TIME/SAMPLES_PER_CHUNK;  i++)
+    {
+        for (j = 0;  j < 2;  j++)
+            t38_terminal_send_timeout(t38[j], SAMPLES_PER_CHUNK);
+        for (j = 0;  j < 2;  j++)
+        {
+            for (k = 0;  k < queued[j];  k++)
+                t38_core_rx_ifp_packet(t38_terminal_get_t38_core_state(t38[j ^ 1]), packet_queue[j][k].buf, packet_queue[j][k].len, packet_queue[j][k].seq_no);
+            queued[j] = 0;
+        }
+        if (check_totals())
+            return -1;
+        if (phase_e_result[0] >= 0  &&  phase_e_result[1] >= 0)
+            break;
+    }
+    for (j = 0;  j < 2;  j++)
+    {
+        t30_get_transfer_statistics(t38_terminal_get_t30_state(t38[j]), &stats[j]);
+        t38_terminal_free(t38[j]);
+    }
+    if (phase_e_result[0] < 0  ||  phase_e_result[1] < 0)
+    {
+        printf("  The calls did not finish within %ds\n", MAX_CALL_TIME);
+        return -1;
+    }
+    return check_final_totals(stats[0].pages_tx, stats[1].pages_rx, ecm, 0);
+}
+/*- End of function --------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    if (test_fax_call(false, 0)
+        ||
+        test_fax_call(true, 0)
+        ||
+        test_fax_call(false, 50)
+        ||
+        test_fax_call(true, 100))
+    {
+        printf("Tests failed\n");
+        exit(2);
+    }
+    if (test_t38_call(false)  ||  test_t38_call(true))
+    {
+        printf("Tests failed\n");
+        exit(2);
+    }
+    printf("Tests passed\n");
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+/*- End of file ------------------------------------------------------------*/
@@ -0,0 +1,378 @@
+/*
+ * SpanDSP - a series of DSP components for telephony
+ *
+ * t85_tests.c - ITU T.85 JBIG for FAX image encode and decode tests
+ *
+ * Written by Steve Underwood <steveu@coppice.org>
+ *
+ * Copyright (C) 2009 Steve Underwood
+ *
+ * All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2, as
+ * published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+/*! \file */
+
+/*! \page t85_tests_page T.85 tests
+\section t85_tests_page_sec_1 What does it do
+These tests exercise the image compression and decompression methods defined
+in ITU specification T.85. Synthetic pages are encoded and decoded with the
+various options, with the compressed data fed to the decoder in chunks of
+several sizes, and the decoded rows are checked against the originals.
+
+A BIE produced by jbigkit, with typical prediction and several stripes, is also
+decoded, and the decoded image encoded again, which must give the same BIE bit for
+bit.
+*/
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+//#if defined(WITH_SPANDSP_INTERNALS)
+#define SPANDSP_EXPOSE_INTERNAL_STRUCTURES
+//#endif
+
+#include "spandsp.h"
+
+#define TEST_IMAGE_WIDTH        3456
+#define TEST_IMAGE_LENGTH       4700
+#define TEST_BYTES_PER_ROW      ((TEST_IMAGE_WIDTH + 7)/8)
+
+#define KNOWN_IMAGE_WIDTH       64
+#define KNOWN_IMAGE_LENGTH      40
+#define KNOWN_IMAGE_L0          8
+
+/* The image from create_known_image(), coded by jbigkit 2.1 with TPBON, 8 row
+   stripes and no AT moves. Typical rows run across several stripe boundaries, and
+   rows 24 to 31 are a whole stripe of them, which codes to nothing. */
+static const uint8_t known_bie[] =
+{
+    0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x40, 0x00, 0x00, 0x00, 0x28,
+    0x00, 0x00, 0x00, 0x08, 0x00, 0x00, 0x00, 0x08, 0xDC, 0xBD, 0xEF, 0x16,
+    0xF0, 0x69, 0x24, 0xDF, 0x6D, 0x39, 0xF4, 0xCC, 0xA0, 0xE3, 0xB5, 0x7C,
+    0xEB, 0x9B, 0xB3, 0x1D, 0x51, 0x5E, 0xC0, 0xFF, 0x02, 0x7F, 0x08, 0x57,
+    0x94, 0x06, 0x3F, 0x79, 0xD1, 0x4A, 0x19, 0x88, 0x2E, 0xD8, 0xFF, 0x02,
+    0x88, 0x08, 0x33, 0x77, 0xA7, 0xED, 0x5E, 0xBC, 0xA1, 0x02, 0x13, 0xFF,
+    0x02, 0xFF, 0x02, 0x3E, 0xA5, 0x61, 0x30, 0xFC, 0x79, 0x7D, 0x29, 0xE7,
+    0x69, 0xF7, 0x70, 0xFF, 0x02
+};
+
+static uint8_t known_image[KNOWN_IMAGE_LENGTH][KNOWN_IMAGE_WIDTH/8];
+static int known_rows;
+static int known_bad_rows;
+
+static uint8_t test_image[TEST_IMAGE_LENGTH][TEST_BYTES_PER_ROW];
+static uint8_t bie[4*TEST_IMAGE_LENGTH*TEST_BYTES_PER_ROW];
+
+static int rows_read;
+static int rows_to_read;
+static int rows_written;
+static int bad_rows;
+
+static int row_read_handler(void *user_data, uint8_t buf[], size_t len)
+{
+    if (rows_read >= rows_to_read)
+        return 0;
+    memcpy(buf, test_image[rows_read++], len);
+    return len;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int row_write_handler(void *user_data, const uint8_t buf[], size_t len)
+{
+    if (len == 0)
+        return 0;
+    if (rows_written >= TEST_IMAGE_LENGTH  ||  memcmp(buf, test_image[rows_written], len))
+        bad_rows++;
+    rows_written++;
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void create_test_image(void)
+{
+    int x;
+    int y;
+    int black;
+
+    /* Text like blocks, a white band to exercise typical prediction, and some noise
+       to make the coder work hard. */
+    memset(test_image, 0, sizeof(test_image));
+    for (y = 0;  y < TEST_IMAGE_LENGTH;  y++)
+    {
+        for (x = 0;  x < TEST_IMAGE_WIDTH;  x++)
+        {
+            black = ((x/40 + y/60) & 1)  &&  ((x*7 + y*3)%23 < 5);
+            if (y > 3000  &&  (rand()%50) == 0)
+                black = true;
+            if (y >= 1000  &&  y < 1200)
+                black = false;
+            if (black)
+                test_image[y][x >> 3] |= (0x80 >> (x & 7));
+        }
+    }
+}
+/*- End of function --------------------------------------------------------*/
+
+static int test_round_trip(int length, int length_known, int options, int chunk)
+{
+    t85_encode_state_t *t85_enc;
+    t85_decode_state_t *t85_dec;
+    clock_t start;
+    clock_t end;
+    int total;
+    int len;
+    int i;
+    int result;
+
+    printf("Length %d%s, options 0x%02x, chunks of %d bytes\n",
+           length,
+           (length_known)  ?  ""  :  " (NEWLEN)",
+           options,
+           chunk);
+    rows_read = 0;
+    rows_to_read = length;
+    rows_written = 0;
+    bad_rows = 0;
+    start = clock();
+    if ((t85_enc = t85_encode_init(NULL, TEST_IMAGE_WIDTH, (length_known)  ?  length  :  0, row_read_handler, NULL)) == NULL)
+    {
+        printf("Failed to create T.85 encoder\n");
+        return -1;
+    }
+    t85_encode_set_options(t85_enc, T85_DEFAULT_L0, -1, options);
+    total = 0;
+    while ((len = t85_encode_get(t85_enc, &bie[total], 4096)) > 0)
+        total += len;
+    if (t85_encode_get_compressed_image_size(t85_enc) != total)
+    {
+        printf("Encoder reports %d bytes, but produced %d bytes\n", t85_encode_get_compressed_image_size(t85_enc), total);
+        return -1;
+    }
+    if ((t85_dec = t85_decode_init(NULL, row_write_handler, NULL)) == NULL)
+    {
+        printf("Failed to create T.85 decoder\n");
+        return -1;
+    }
+    t85_decode_set_image_size_constraints(t85_dec, TEST_IMAGE_WIDTH, TEST_IMAGE_LENGTH);
+    result = T4_DECODE_MORE_DATA;
+    for (i = 0;  i < total  &&  result == T4_DECODE_MORE_DATA;  i += chunk)
+    {
+        len = (total - i < chunk)  ?  (total - i)  :  chunk;
+        result = t85_decode_put(t85_dec, &bie[i], len);
+    }
+    if (result == T4_DECODE_MORE_DATA)
+        result = t85_decode_put(t85_dec, NULL, 0);
+    end = clock();
+    printf("    %d bytes, %d rows decoded, %.3fs\n", total, rows_written, (double) (end - start)/CLOCKS_PER_SEC);
+    if (result != T4_DECODE_OK
+        ||
+        rows_written != length
+        ||
+        bad_rows
+        ||
+        t85_decode_get_image_width(t85_dec) != TEST_IMAGE_WIDTH
+        ||
+        t85_decode_get_image_length(t85_dec) != length)
+    {
+        printf("Test failed - result %d, %d rows, %d bad rows\n", result, rows_written, bad_rows);
+        return -1;
+    }
+    t85_encode_free(t85_enc);
+    t85_decode_free(t85_dec);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int known_row_read_handler(void *user_data, uint8_t buf[], size_t len)
+{
+    if (known_rows >= KNOWN_IMAGE_LENGTH)
+        return 0;
+    memcpy(buf, known_image[known_rows++], len);
+    return len;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int known_row_write_handler(void *user_data, const uint8_t buf[], size_t len)
+{
+    if (len == 0)
+        return 0;
+    if (known_rows >= KNOWN_IMAGE_LENGTH  ||  memcmp(buf, known_image[known_rows], len))
+        known_bad_rows++;
+    known_rows++;
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static void create_known_image(void)
+{
+    int x;
+    int y;
+    int yy;
+
+    /* Diagonal hatching, with runs of repeated rows */
+    memset(known_image, 0, sizeof(known_image));
+    for (y = 0;  y < KNOWN_IMAGE_LENGTH;  y++)
+    {
+        yy = y;
+        if (y >= 6  &&  y <= 10)
+            yy = 6;
+        else if (y >= 14  &&  y <= 17)
+            yy = 14;
+        else if (y >= 20  &&  y <= 36)
+            yy = 20;
+        for (x = 0;  x < KNOWN_IMAGE_WIDTH;  x++)
+        {
+            if ((x*5 + yy*3)%11 < 4  ||  x == yy)
+                known_image[y][x >> 3] |= (0x80 >> (x & 7));
+        }
+    }
+}
+/*- End of function --------------------------------------------------------*/
+
+static int test_known_answer(void)
+{
+    t85_encode_state_t *t85_enc;
+    t85_decode_state_t *t85_dec;
+    uint8_t buf[sizeof(known_bie) + 100];
+    int result;
+    int total;
+    int len;
+    int i;
+
+    printf("Decoding and encoding a BIE from jbigkit\n");
+    create_known_image();
+    known_rows = 0;
+    known_bad_rows = 0;
+    if ((t85_dec = t85_decode_init(NULL, known_row_write_handler, NULL)) == NULL)
+    {
+        printf("Failed to create T.85 decoder\n");
+        return -1;
+    }
+    if ((result = t85_decode_put(t85_dec, known_bie, sizeof(known_bie))) == T4_DECODE_MORE_DATA)
+        result = t85_decode_put(t85_dec, NULL, 0);
+    if (result != T4_DECODE_OK  ||  known_rows != KNOWN_IMAGE_LENGTH  ||  known_bad_rows)
+    {
+        printf("Test failed - result %d, %d rows, %d bad rows\n", result, known_rows, known_bad_rows);
+        return -1;
+    }
+    t85_decode_free(t85_dec);
+
+    known_rows = 0;
+    if ((t85_enc = t85_encode_init(NULL, KNOWN_IMAGE_WIDTH, KNOWN_IMAGE_LENGTH, known_row_read_handler, NULL)) == NULL)
+    {
+        printf("Failed to create T.85 encoder\n");
+        return -1;
+    }
+    t85_encode_set_options(t85_enc, KNOWN_IMAGE_L0, 0, T85_TPBON);
+    total = 0;
+    while ((len = t85_encode_get(t85_enc, &buf[total], sizeof(buf) - total)) > 0)
+        total += len;
+    t85_encode_free(t85_enc);
+    if (total != (int) sizeof(known_bie)  ||  memcmp(buf, known_bie, total))
+    {
+        for (i = 0;  i < total  &&  i < (int) sizeof(known_bie)  &&  buf[i] == known_bie[i];  i++)
+            ;
+        printf("Test failed - %d bytes, rather than %d, differing from byte %d\n", total, (int) sizeof(known_bie), i);
+        return -1;
+    }
+    printf("    %d bytes, matching jbigkit\n", total);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int test_corrupt_data(void)
+{
+    t85_decode_state_t *t85_dec;
+    uint8_t buf[20];
+    int result;
+
+    printf("Bad header and abort handling\n");
+    memset(buf, 0, sizeof(buf));
+    /* A P of zero planes is not valid */
+    t85_dec = t85_decode_init(NULL, row_write_handler, NULL);
+    result = t85_decode_put(t85_dec, buf, sizeof(buf));
+    if (result != T4_DECODE_INVALID_DATA)
+    {
+        printf("Test failed - bad header gave %d\n", result);
+        return -1;
+    }
+    t85_decode_free(t85_dec);
+
+    /* A valid start, followed by an ABORT marker */
+    rows_written = 0;
+    bad_rows = 0;
+    t85_dec = t85_decode_init(NULL, row_write_handler, NULL);
+    memcpy(buf, bie, sizeof(buf));
+    t85_decode_put(t85_dec, buf, sizeof(buf));
+    buf[0] = T81_T82_ARITH_MARKER_ESC;
+    buf[1] = T82_ABORT;
+    result = t85_decode_put(t85_dec, buf, 2);
+    if (result != T4_DECODE_ABORTED)
+    {
+        printf("Test failed - abort gave %d\n", result);
+        return -1;
+    }
+    t85_decode_free(t85_dec);
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
+int main(int argc, char *argv[])
+{
+    static const int chunks[] =
+    {
+        1, 7, 333, 4096, sizeof(bie)
+    };
+    int i;
+
+    create_test_image();
+
+    for (i = 0;  i < (int) (sizeof(chunks)/sizeof(chunks[0]));  i++)
+    {
+        if (test_round_trip(TEST_IMAGE_LENGTH, true, T85_TPBON, chunks[i]))
+            exit(2);
+    }
+    if (test_round_trip(TEST_IMAGE_LENGTH, true, 0, 4096))
+        exit(2);
+    if (test_round_trip(TEST_IMAGE_LENGTH, true, T85_TPBON | T85_LRLTWO, 4096))
+        exit(2);
+    /* Unknown length, terminated with a NEWLEN marker */
+    if (test_round_trip(TEST_IMAGE_LENGTH, false, T85_TPBON, 4096))
+        exit(2);
+    if (test_round_trip(1000, false, T85_TPBON | T85_LRLTWO, 256))
+        exit(2);
+    /* Lengths around the stripe size */
+    if (test_round_trip(T85_DEFAULT_L0 + 1, true, T85_TPBON, 64))
+        exit(2);
+    if (test_round_trip(T85_DEFAULT_L0, false, T85_TPBON, 64))
+        exit(2);
+    if (test_round_trip(1, true, T85_TPBON, 64))
+        exit(2);
+    if (test_corrupt_data())
+        exit(2);
+    if (test_known_answer())
+        exit(2);
+    printf("Tests passed\n");
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+/*- End of file ------------------------------------------------------------*/
@@ -157,6 +157,75 @@ static void basic_tests(int mode)
 }
 /*- End of function --------------------------------------------------------*/
 
+static int automoding_tone_test(int options, int f1, int f2, int on_time, int off_time, int duration, int expected_mode)
+{
+    int16_t amp[SAMPLES_PER_CHUNK];
+    tone_gen_descriptor_t tone_desc;
+    tone_gen_state_t tone_state;
+    v18_state_t *v18_state;
+    logging_state_t *logging;
+    int mode;
+    int len;
+    int i;
+
+    tone_gen_descriptor_init(&tone_desc, f1, -15, f2, -15, on_time, off_time, 0, 0, true);
+    tone_gen_init(&tone_state, &tone_desc);
+    v18_state = v18_init(NULL, false, V18_AUTOMODING | options, put_text_msg, NULL);
+    logging = v18_get_logging_state(v18_state);
+    span_log_set_level(logging, SPAN_LOG_SHOW_SEVERITY | SPAN_LOG_SHOW_PROTOCOL | SPAN_LOG_FLOW);
+    span_log_set_tag(logging, "TUT");
+    for (i = 0;  i < duration*SAMPLE_RATE/1000;  i += SAMPLES_PER_CHUNK)
+    {
+        len = tone_gen(&tone_state, amp, SAMPLES_PER_CHUNK);
+        if (len < SAMPLES_PER_CHUNK)
+            memset(&amp[len], 0, sizeof(int16_t)*(SAMPLES_PER_CHUNK - len));
+        v18_rx(v18_state, amp, SAMPLES_PER_CHUNK);
+    }
+    mode = v18_get_current_mode(v18_state);
+    v18_free(v18_state);
+    printf("    Selected %s\n", v18_mode_to_str(mode));
+    return (mode == expected_mode)  ?  0  :  -1;
+}
+/*- End of function --------------------------------------------------------*/
+
+static int automoding_text_test(int tx_mode, int options)
+{
+    int16_t amp[SAMPLES_PER_CHUNK];
+    v18_state_t *v18_tester;
+    v18_state_t *v18_tut;
+    logging_state_t *logging;
+    int mode;
+    int len;
+    int i;
+
+    v18_tester = v18_init(NULL, true, tx_mode, NULL, NULL);
+    v18_tut = v18_init(NULL, false, V18_AUTOMODING | options, put_text_msg, NULL);
+    logging = v18_get_logging_state(v18_tut);
+    span_log_set_level(logging, SPAN_LOG_SHOW_SEVERITY | SPAN_LOG_SHOW_PROTOCOL | SPAN_LOG_FLOW);
+    span_log_set_tag(logging, "TUT");
+    good_message_received = false;
+    if (v18_put(v18_tester, qbf_tx, -1) != strlen(qbf_tx))
+    {
+        printf("V.18 put failed\n");
+        exit(2);
+    }
+    for (i = 0;  i < 20*SAMPLE_RATE;  i += SAMPLES_PER_CHUNK)
+    {
+        len = v18_tx(v18_tester, amp, SAMPLES_PER_CHUNK);
+        if (len < SAMPLES_PER_CHUNK)
+            memset(&amp[len], 0, sizeof(int16_t)*(SAMPLES_PER_CHUNK - len));
+        v18_rx(v18_tut, amp, SAMPLES_PER_CHUNK);
+    }
+    mode = v18_get_current_mode(v18_tut);
+    v18_free(v18_tester);
+    v18_free(v18_tut);
+    printf("    Selected %s\n", v18_mode_to_str(mode));
+    if (mode != (tx_mode & 0xFF)  ||  !good_message_received)
+        return -1;
+    return 0;
+}
+/*- End of function --------------------------------------------------------*/
+
 static int test_misc_01(void)
 {
     /*
@@ -986,8 +1055,9 @@ static int test_ans_10(void)
         Pass criteria:  The TUT should respond with a 1650 Hz tone in 1.5±0.1 seconds.
         Comments:       The TUT should indicate that V.21 mode has been selected.
      */
-    printf("Test not yet implemented\n");
-    return 1;
+    /* The timer, and the 1650Hz response, are not implemented. This only checks that
+       980Hz selects V.21. */
+    return automoding_tone_test(0, 980, 0, 2000, 0, 2000, V18_MODE_V21TEXTPHONE);
 }
 /*- End of function --------------------------------------------------------*/
 
@@ -1091,8 +1161,13 @@ static int test_ans_15(void)
                         automode answer state. The TUT may then select either 45.45 or 50 bit/s for the
                         transmission.
      */
-    printf("Test not yet implemented\n");
-    return 1;
+    /* Only 45.45 and 50 bits per second are supported. The two cannot be told apart by
+       their tones, so the rate follows the country setting. */
+    if (automoding_text_test(V18_MODE_5BIT_45, 0))
+        return -1;
+    if (automoding_text_test(V18_MODE_5BIT_50, V18_AUTOMODING_BAUDOT_50))
+        return -1;
+    return 0;
 }
 /*- End of function --------------------------------------------------------*/
 
@@ -1109,8 +1184,7 @@ static int test_ans_16(void)
         Comments:       The TUT should indicate that it has selected DTMF mode. The DTMF capabilities
                         of the TUT should comply with ITU-T Q.24 for the Danish Administration.
      */
-    printf("Test not yet implemented\n");
-    return 1;
+    return automoding_tone_test(0, 770, 1336, 40, 2000, 1000, V18_MODE_DTMF);
 }
 /*- End of function --------------------------------------------------------*/
 
@@ -1124,8 +1198,9 @@ static int test_ans_17(void)
         Pass criteria:  TUT should respond with 2225 Hz tone after 0.7±0.1 s.
         Comments:       The TUT should indicate that Bell 103 mode has been selected.
      */
-    printf("Test not yet implemented\n");
-    return 1;
+    /* The 2225Hz response is not implemented. This only checks that 1270Hz selects
+       Bell 103. */
+    return automoding_tone_test(0, 1270, 0, 5000, 0, 5000, V18_MODE_BELL103);
 }
 /*- End of function --------------------------------------------------------*/
 
@@ -1297,8 +1372,8 @@ static int test_ans_27(void)
                            10 seconds total.
         Comments:
      */
-    printf("Test not yet implemented\n");
-    return 1;
+    /* The 1300Hz probe is not implemented. This only checks that 390Hz selects V.23. */
+    return automoding_tone_test(0, 390, 0, 11000, 0, 11000, V18_MODE_V23VIDEOTEX);
 }
 /*- End of function --------------------------------------------------------*/
 
@@ -1360,8 +1435,19 @@ static int test_ans_30(void)
                         tones may be ignored. Some devices may only provide a visual indication of the
                         presence and cadence of the tones for instance by a flashing light.
      */
-    printf("Test not yet implemented\n");
-    return 1;
+    /* Some of the dial, ringing and busy tones close to the V.23 backward channel. They
+       should select nothing. */
+    if (automoding_tone_test(0, 350, 440, 5000, 0, 5000, V18_MODE_NONE))
+        return -1;
+    if (automoding_tone_test(0, 440, 480, 2000, 4000, 6000, V18_MODE_NONE))
+        return -1;
+    if (automoding_tone_test(0, 480, 620, 500, 500, 5000, V18_MODE_NONE))
+        return -1;
+    if (automoding_tone_test(0, 425, 0, 500, 500, 5000, V18_MODE_NONE))
+        return -1;
+    if (automoding_tone_test(0, 400, 450, 400, 200, 5000, V18_MODE_NONE))
+        return -1;
+    return 0;
 }
 /*- End of function --------------------------------------------------------*/
 
@@ -1378,8 +1464,7 @@ static int test_ans_31(void)
         Comments:       This is an optional test as detection of the fax calling tone is not required by
                         ITU-T V.18.
      */
-    printf("Test not yet implemented\n");
-    return 1;
+    return automoding_tone_test(0, 1100, 0, 500, 3000, 7000, V18_MODE_NONE);
 }
 /*- End of function --------------------------------------------------------*/
 
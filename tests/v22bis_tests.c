@@ -115,7 +115,7 @@ static void v22bis_rx_status(void *user_data, int status)
     int bit_rate;
     int i;
     int len;
-#if defined(SPANDSP_USE_FIXED_POINTx)
+#if defined(SPANDSP_USE_FIXED_POINT)
     complexi16_t *coeffs;
 #else
     complexf_t *coeffs;
@@ -132,8 +132,8 @@ static void v22bis_rx_status(void *user_data, int status)
         len = v22bis_rx_equalizer_state(s->v22bis, &coeffs);
         printf("Equalizer:\n");
         for (i = 0;  i < len;  i++)
-#if defined(SPANDSP_USE_FIXED_POINTx)
-            printf("%3d (%15.5f, %15.5f)\n", i, coeffs[i].re/1024.0f, coeffs[i].im/1024.0f);
+#if defined(SPANDSP_USE_FIXED_POINT)
+            printf("%3d (%15.5f, %15.5f)\n", i, coeffs[i].re/4096.0f, coeffs[i].im/4096.0f);
 #else
             printf("%3d (%15.5f, %15.5f) -> %15.5f\n", i, coeffs[i].re, coeffs[i].im, powerf(&coeffs[i]));
 #endif
@@ -179,11 +179,13 @@ static void qam_report(void *user_data, const complexf_t *constel, const complex
 {
     int i;
     int len;
-#if defined(SPANDSP_USE_FIXED_POINTx)
+#if defined(SPANDSP_USE_FIXED_POINT)
     complexi16_t *coeffs;
-    complexf_t constel_point;
 #else
     complexf_t *coeffs;
+#endif
+#if defined(SPANDSP_USE_FIXED_POINTx)
+    complexf_t constel_point;
 #endif
     float fpower;
     endpoint_t *s;
@@ -234,15 +236,15 @@ static void qam_report(void *user_data, const complexf_t *constel, const complex
         len = v22bis_rx_equalizer_state(s->v22bis, &coeffs);
         printf("Equalizer A:\n");
         for (i = 0;  i < len;  i++)
-#if defined(SPANDSP_USE_FIXED_POINTx)
-            printf("%3d (%15.5f, %15.5f)\n", i, coeffs[i].re/1024.0f, coeffs[i].im/1024.0f);
+#if defined(SPANDSP_USE_FIXED_POINT)
+            printf("%3d (%15.5f, %15.5f)\n", i, coeffs[i].re/4096.0f, coeffs[i].im/4096.0f);
 #else
             printf("%3d (%15.5f, %15.5f) -> %15.5f\n", i, coeffs[i].re, coeffs[i].im, powerf(&coeffs[i]));
 #endif
 #if defined(ENABLE_GUI)
         if (use_gui)
         {
-#if defined(SPANDSP_USE_FIXED_POINTx)
+#if defined(SPANDSP_USE_FIXED_POINT)
             qam_monitor_update_int_equalizer(s->qam_monitor, coeffs, len);
 #else
             qam_monitor_update_equalizer(s->qam_monitor, coeffs, len);